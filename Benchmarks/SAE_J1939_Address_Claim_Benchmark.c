@@ -0,0 +1,265 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Address_Claim_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Simulation of the SAE J1939-81 address claim. The ECU claims its
+  * 		 address on the virtual CAN bus against peers which defend their
+  * 		 addresses by the NAMEs. The time until the ECU can send messages,
+  * 		 the claimed address and the frames on the bus are reported.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Port_Host.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_PEERS							(6U)
+#define BENCHMARK_SIMULATION_TIME				(1000U)	// ms
+#define BENCHMARK_ARBITRARY_NAME				(J1939_NAME_ARBITRARY_ADDRESS_CAPABLE | 0x0012345600000001ULL)
+#define BENCHMARK_FIXED_NAME					(0x0012345600000001ULL)
+#define BENCHMARK_HIGH_PRIORITY_NAME			(0x0000000000000002ULL)
+#define BENCHMARK_LOW_PRIORITY_NAME				(0xA000000000000002ULL)
+
+#define BENCHMARK_GET_PDU_FORMAT(canId)			((uint8_t)((canId) >> 16U))
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A peer ECU on the virtual bus. It answers the requests and defends its address.
+ */
+typedef struct
+{
+	uint64_t NAME;
+	uint8_t address;
+	uint8_t node;
+	uint8_t active;
+} benchmarkPeer;
+
+/**
+ * @brief A benchmark case.
+ */
+typedef struct
+{
+	const char* name;
+	uint64_t NAME;							/* The NAME of the ECU */
+	uint8_t preferred_address;				/* The address claimed by the ECU */
+	uint64_t peer_NAME;						/* The NAME of the peer at the preferred address. 0 - no peer */
+	J1939_addressClaimState state;			/* The expected state */
+	uint8_t address;						/* The expected address */
+} benchmarkCase;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static benchmarkPeer peers[BENCHMARK_PEERS];
+static J1939_instance ecu;
+static uint64_t stateTime = 0U;
+static uint64_t cannotClaimTime = 0U;
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to send the address claimed message of the peer.
+ * @param	peer - A pointer to the peer.
+ * @retval	None.
+ */
+static void benchmarkSendPeerClaim(const benchmarkPeer* peer)
+{
+	uint8_t data[8];
+
+	for(uint8_t i = 0U; i < 8U; i++) data[i] = (uint8_t)(peer->NAME >> (8U * i));
+
+	J1939_portSendFrame(peer->node, (6UL << 26U) | ((uint32_t)J1939_ADDRESS_CLAIM << 16U) | (0xFFUL << 8U) | peer->address, data, 8U);
+}
+
+/**
+ * @brief 	This function is the RX interrupt of the peer.
+ * @retval	None.
+ */
+static void benchmarkPeerReceive(void* context, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	benchmarkPeer* peer = context;
+	uint64_t NAME = 0U;
+
+	(void)dlc;
+
+	if(peer->active == 0U) return;
+
+	if(BENCHMARK_GET_PDU_FORMAT(canId) == J1939_REQUEST)
+	{
+		benchmarkSendPeerClaim(peer);
+		return;
+	}
+
+	if(BENCHMARK_GET_PDU_FORMAT(canId) != J1939_ADDRESS_CLAIM) return;
+
+	if((uint8_t)canId == J1939_NULL_ADDRESS)
+	{
+		if(cannotClaimTime == 0U) cannotClaimTime = J1939_hostGetTime();
+		return;
+	}
+
+	if((uint8_t)canId != peer->address) return;
+
+	for(uint8_t i = 0U; i < 8U; i++) NAME |= (uint64_t)data[i] << (8U * i);
+
+	// The peer defends its address or gives it up
+	if(peer->NAME < NAME)
+	{
+		benchmarkSendPeerClaim(peer);
+	} else
+	{
+		peer->active = 0U;
+	}
+}
+
+/**
+ * @brief 	This function is called when the address claim state of the ECU is changed.
+ * @retval	None.
+ */
+static void benchmarkStateChanged(J1939_instance* instance, J1939_addressClaimState state, uint8_t address)
+{
+	(void)instance;
+	(void)address;
+
+	if((state == J1939_ADDRESS_CLAIMED) || (state == J1939_ADDRESS_CANNOT_CLAIM)) stateTime = J1939_hostGetTime();
+}
+
+/**
+ * @brief 	This function is used to run the virtual bus and the timers of the ECU.
+ * @param	time - The simulation time, ms.
+ * @retval	None.
+ */
+static void benchmarkSimulate(uint32_t time)
+{
+	for(uint32_t i = 0U; i < time; i++)
+	{
+		J1939_hostProcessBus();
+		J1939_processTimers(&ecu);
+		J1939_hostProcessBus();
+		J1939_hostAdvanceTime(1000U);
+	}
+}
+
+/**
+ * @brief 	This function is used to run and report one benchmark case.
+ * @param	benchmark - A pointer to the case.
+ * @retval	0 if the ECU is in the expected state with the expected address, 1 otherwise.
+ */
+static int benchmarkRun(const benchmarkCase* benchmark)
+{
+	benchmarkMeasurement measurement;
+	uint64_t startTime;
+	uint8_t address;
+	J1939_addressClaimState state;
+
+	for(uint8_t i = 0U; i < BENCHMARK_PEERS; i++) peers[i].active = 0U;
+
+	peers[0].NAME		= benchmark->peer_NAME;
+	peers[0].address	= benchmark->preferred_address;
+	peers[0].active		= (benchmark->peer_NAME != 0U) ? 1U : 0U;
+
+	stateTime		= 0U;
+	cannotClaimTime	= 0U;
+
+	benchmarkStartMeasurement(&measurement);
+	startTime = J1939_hostGetTime();
+	J1939_startAddressClaim(&ecu, benchmark->NAME, benchmark->preferred_address);
+	benchmarkSimulate(BENCHMARK_SIMULATION_TIME);
+	benchmarkStopMeasurement(&measurement);
+
+	state	= J1939_getAddressClaimState(&ecu);
+	address	= J1939_getCurrentECUAddress(&ecu);
+
+	printf("%-20s %#9x %#9x %-13s %10.1f %12.1f %8llu\n",
+		   benchmark->name, benchmark->preferred_address, address,
+		   (state == J1939_ADDRESS_CLAIMED) ? "claimed" : ((state == J1939_ADDRESS_CANNOT_CLAIM) ? "cannot claim" : "claiming"),
+		   (stateTime >= startTime) ? (double)(stateTime - startTime) / 1000.0 : 0.0,
+		   (cannotClaimTime >= startTime) ? (double)(cannotClaimTime - startTime) / 1000.0 : 0.0,
+		   (unsigned long long)measurement.counters.frames);
+
+	if((state == J1939_ADDRESS_CANNOT_CLAIM) && (cannotClaimTime == 0U)) return 1;
+
+	return ((state == benchmark->state) && (address == benchmark->address)) ? 0 : 1;
+}
+
+/**
+ * @brief 	This function is used to fill the address table by the request for the address claimed
+ * 			messages and to check it.
+ * @retval	0 if the table holds the NAMEs of all peers, 1 otherwise.
+ */
+static int benchmarkRunTable(void)
+{
+	uint8_t foundPeers = 0U;
+	uint64_t NAME;
+
+	for(uint8_t i = 0U; i < BENCHMARK_PEERS; i++)
+	{
+		peers[i].NAME		= 0x0000000100000000ULL + i;
+		peers[i].address	= 0x30U + i;
+		peers[i].active		= 1U;
+	}
+
+	J1939_requestAddressClaims(&ecu);
+	benchmarkSimulate(1U);
+
+	for(uint8_t i = 0U; i < BENCHMARK_PEERS; i++)
+	{
+		if((J1939_getNameOfAddress(&ecu, peers[i].address, &NAME) == 1U) && (NAME == peers[i].NAME)) foundPeers++;
+	}
+
+	printf("\naddress table: %u/%u peers found after the request for the address claimed\n", foundPeers, BENCHMARK_PEERS);
+
+	return (foundPeers == BENCHMARK_PEERS) ? 0 : 1;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(void)
+{
+	static const benchmarkCase cases[] =
+	{
+		{"fixed range",		BENCHMARK_ARBITRARY_NAME,	0x20U,	0U,								J1939_ADDRESS_CLAIMED,		0x20U},
+		{"arbitrary range",	BENCHMARK_ARBITRARY_NAME,	0x90U,	0U,								J1939_ADDRESS_CLAIMED,		0x90U},
+		{"contention won",	BENCHMARK_ARBITRARY_NAME,	0x90U,	BENCHMARK_LOW_PRIORITY_NAME,	J1939_ADDRESS_CLAIMED,		0x90U},
+		{"contention lost",	BENCHMARK_ARBITRARY_NAME,	0x90U,	BENCHMARK_HIGH_PRIORITY_NAME,	J1939_ADDRESS_CLAIMED,		0x91U},
+		{"fixed lost",		BENCHMARK_FIXED_NAME,		0x20U,	BENCHMARK_HIGH_PRIORITY_NAME,	J1939_ADDRESS_CANNOT_CLAIM,	J1939_NULL_ADDRESS},
+	};
+	int failures = 0;
+
+	J1939_hostInit(J1939_HOST_DEFAULT_BITRATE);
+	benchmarkAddNode(&ecu);
+	J1939_setAddressClaimCallback(&ecu, benchmarkStateChanged);
+
+	for(uint8_t i = 0U; i < BENCHMARK_PEERS; i++) peers[i].node = J1939_hostAddNode(benchmarkPeerReceive, &peers[i]);
+
+	printf("SAE J1939-81 address claim simulation, virtual bus %u bit/s\n", J1939_HOST_DEFAULT_BITRATE);
+	printf("%-20s %9s %9s %-13s %10s %12s %8s\n",
+		   "case", "preferred", "address", "state", "online ms", "cannot ms", "frames");
+
+	for(uint8_t i = 0U; i < (sizeof(cases) / sizeof(cases[0])); i++)
+	{
+		failures += benchmarkRun(&cases[i]);
+	}
+
+	failures += benchmarkRunTable();
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
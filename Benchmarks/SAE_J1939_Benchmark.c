@@ -0,0 +1,124 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the helpers shared by
+  * 		 the benchmarks.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_Benchmark.h"
+
+#include <time.h>
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to get the monotonic wall clock time.
+ * @retval	The time in seconds.
+ */
+double benchmarkGetWallTime(void)
+{
+	struct timespec time;
+
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (double)time.tv_sec + ((double)time.tv_nsec * 1e-9);
+}
+
+/**
+ * @brief 	This function is used to get the monotonic wall clock time.
+ * @retval	The time in nanoseconds.
+ */
+uint64_t benchmarkGetNanoseconds(void)
+{
+	struct timespec time;
+
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return ((uint64_t)time.tv_sec * 1000000000ULL) + (uint64_t)time.tv_nsec;
+}
+
+/**
+ * @brief 	This function is used to add a measured time to the latency results.
+ * @param	latency - A pointer to the latency results.
+ * @param	time - The measured time.
+ * @retval	None.
+ */
+void benchmarkAddLatency(benchmarkLatency* latency, uint64_t time)
+{
+	latency->samples++;
+	latency->total += time;
+	if(time > latency->max) latency->max = time;
+}
+
+/**
+ * @brief 	This function is used to get the average of the measured times.
+ * @param	latency - A pointer to the latency results.
+ * @retval	The average time. 0 if no time is measured.
+ */
+double benchmarkGetAverageLatency(const benchmarkLatency* latency)
+{
+	return (latency->samples > 0U) ? (double)latency->total / latency->samples : 0.0;
+}
+
+#if defined(J1939_PORT_HOST)
+/**
+ * @brief 	This function is the receive callback of the virtual bus which passes the frames on to the dispatcher.
+ * @param	context - A pointer to the J1939 instance of the node.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The data length of the frame.
+ * @retval	None.
+ */
+void benchmarkDispatch(void* context, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	J1939_dispatchFrame((J1939_instance*)context, canId, data, dlc);
+}
+
+/**
+ * @brief 	This function is used to initialize a J1939 instance on a new node of the virtual bus.
+ * 			The frames of the other nodes are passed on to its dispatcher.
+ * @param	instance - A pointer to the J1939 instance.
+ * @retval	None.
+ */
+void benchmarkAddNode(J1939_instance* instance)
+{
+	J1939_initInstance(instance, J1939_hostAddNode(benchmarkDispatch, instance));
+}
+
+/**
+ * @brief 	This function is used to start the measurement of a benchmark case. The counters of the host are reset.
+ * @param	measurement - A pointer to the measurement.
+ * @retval	None.
+ */
+void benchmarkStartMeasurement(benchmarkMeasurement* measurement)
+{
+	J1939_hostResetCounters();
+
+	measurement->wall_time	= benchmarkGetWallTime();
+	measurement->bus_time	= J1939_hostGetTime();
+}
+
+/**
+ * @brief 	This function is used to stop the measurement of a benchmark case. The times of the case and
+ * 			the counters of the host are stored.
+ * @param	measurement - A pointer to the measurement.
+ * @retval	None.
+ */
+void benchmarkStopMeasurement(benchmarkMeasurement* measurement)
+{
+	measurement->wall_time	= benchmarkGetWallTime() - measurement->wall_time;
+	measurement->bus_time	= J1939_hostGetTime() - measurement->bus_time;
+
+	J1939_hostGetCounters(&measurement->counters);
+}
+#endif
@@ -0,0 +1,121 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Benchmark.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the helpers shared by the benchmarks: the wall
+  * 		 clock, the latency results and, on the host platform, the nodes
+  * 		 of the virtual bus and the measurement of a benchmark case.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_BENCHMARK_H
+#define __SAE_J1939_BENCHMARK_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+#if defined(J1939_PORT_HOST)
+#include "SAE_J1939_Port_Host.h"
+#endif
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief The latency results of a benchmark case.
+ */
+typedef struct
+{
+	uint32_t samples;						/* The number of measured times */
+	uint64_t total;							/* Sum of the measured times */
+	uint64_t max;							/* The longest measured time */
+} benchmarkLatency;
+
+#if defined(J1939_PORT_HOST)
+/**
+ * @brief The measurement of a benchmark case on the virtual bus.
+ */
+typedef struct
+{
+	double wall_time;						/* The wall clock time of the case, s */
+	uint64_t bus_time;						/* The virtual time of the case, us */
+	J1939_hostCounters counters;			/* The counters of the host platform collected during the case */
+} benchmarkMeasurement;
+#endif
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to get the monotonic wall clock time.
+ * @retval	The time in seconds.
+ */
+double benchmarkGetWallTime(void);
+
+/**
+ * @brief 	This function is used to get the monotonic wall clock time.
+ * @retval	The time in nanoseconds.
+ */
+uint64_t benchmarkGetNanoseconds(void);
+
+/**
+ * @brief 	This function is used to add a measured time to the latency results.
+ * @param	latency - A pointer to the latency results.
+ * @param	time - The measured time.
+ * @retval	None.
+ */
+void benchmarkAddLatency(benchmarkLatency* latency, uint64_t time);
+
+/**
+ * @brief 	This function is used to get the average of the measured times.
+ * @param	latency - A pointer to the latency results.
+ * @retval	The average time. 0 if no time is measured.
+ */
+double benchmarkGetAverageLatency(const benchmarkLatency* latency);
+
+#if defined(J1939_PORT_HOST)
+/**
+ * @brief 	This function is the receive callback of the virtual bus which passes the frames on to the dispatcher.
+ * @param	context - A pointer to the J1939 instance of the node.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The data length of the frame.
+ * @retval	None.
+ */
+void benchmarkDispatch(void* context, uint32_t canId, const uint8_t* data, uint8_t dlc);
+
+/**
+ * @brief 	This function is used to initialize a J1939 instance on a new node of the virtual bus.
+ * 			The frames of the other nodes are passed on to its dispatcher.
+ * @param	instance - A pointer to the J1939 instance.
+ * @retval	None.
+ */
+void benchmarkAddNode(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to start the measurement of a benchmark case. The counters of the host are reset.
+ * @param	measurement - A pointer to the measurement.
+ * @retval	None.
+ */
+void benchmarkStartMeasurement(benchmarkMeasurement* measurement);
+
+/**
+ * @brief 	This function is used to stop the measurement of a benchmark case. The times of the case and
+ * 			the counters of the host are stored.
+ * @param	measurement - A pointer to the measurement.
+ * @retval	None.
+ */
+void benchmarkStopMeasurement(benchmarkMeasurement* measurement);
+#endif
+
+#endif /* __SAE_J1939_BENCHMARK_H */
@@ -0,0 +1,303 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Cyclic_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Simulation of the cyclic PGN transmission. The ECU broadcasts
+  * 		 32 PGNs with periods from 10 ms to 5 s, two of them above 8
+  * 		 bytes by BAM, and a listener receives them over the virtual CAN
+  * 		 bus. The bursts, the peak bus load and the time the frames wait
+  * 		 for the bus are reported with all phases at 0, as separate
+  * 		 application timers started together give, and with the phases
+  * 		 chosen by the library. The last case runs across the wrap of the
+  * 		 32-bit platform time.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Port_Host.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_ECU_ADDRESS					(0x10U)
+#define BENCHMARK_LISTENER_ADDRESS				(0x20U)
+#define BENCHMARK_NUMBER_OF_PGNS				(32U)
+#define BENCHMARK_MAX_PAYLOAD					(40U)
+#define BENCHMARK_LOAD_WINDOW					(10000U)	// us
+#define BENCHMARK_SEND_TIMES					(1024U)		// As the bus queue of the host port
+#define BENCHMARK_DEFAULT_TIME					(10000U)	// ms
+#define BENCHMARK_TIME_WRAP						(0x100000000ULL)	// ms, the 32-bit platform time wraps
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A cyclic PGN of the ECU.
+ */
+typedef struct
+{
+	uint32_t PGN;
+	uint8_t priority;
+	uint16_t period;						/* ms */
+	uint16_t size;							/* Payload size, above 8 - BAM */
+	uint8_t provider;						/* 1 - the payload is written by the provider, 0 - set once */
+} benchmarkPGN;
+
+/**
+ * @brief Results of a benchmark run.
+ */
+typedef struct
+{
+	benchmarkLatency latency;				/* The times from sending to reception of the frames received by the listener, us */
+	uint32_t window_frames;					/* Frames received in the current load window */
+	uint32_t max_window_frames;				/* The most frames received in a load window */
+	uint64_t window;						/* The current load window */
+	uint32_t messages[BENCHMARK_NUMBER_OF_PGNS];	/* Messages received by the listener per PGN */
+	uint32_t corrupted;						/* Messages of a wrong size */
+} benchmarkResults;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static const benchmarkPGN PGNs[BENCHMARK_NUMBER_OF_PGNS] =
+{
+	{0x00FF00UL, 3U,   10U,  8U, 1U}, {0x00FF01UL, 3U,   10U,  8U, 1U}, {0x00FF02UL, 3U,   10U,  8U, 0U}, {0x00FF03UL, 3U,   10U,  8U, 0U},
+	{0x00FF04UL, 4U,   20U,  8U, 1U}, {0x00FF05UL, 4U,   20U,  8U, 1U}, {0x00FF06UL, 4U,   20U,  8U, 0U}, {0x00FF07UL, 4U,   20U,  8U, 0U},
+	{0x00FF08UL, 5U,   50U,  8U, 1U}, {0x00FF09UL, 5U,   50U,  8U, 1U}, {0x00FF0AUL, 5U,   50U,  8U, 0U}, {0x00FF0BUL, 5U,   50U,  8U, 0U},
+	{0x00FF0CUL, 6U,  100U,  8U, 1U}, {0x00FF0DUL, 6U,  100U,  8U, 1U}, {0x00FF0EUL, 6U,  100U,  8U, 0U}, {0x00FF0FUL, 6U,  100U,  8U, 0U},
+	{0x00FF10UL, 6U,  100U,  8U, 1U}, {0x00EF00UL, 6U,  100U,  8U, 1U}, {0x00FF12UL, 6U,  200U,  8U, 1U}, {0x00FF13UL, 6U,  200U,  8U, 0U},
+	{0x00FF14UL, 6U,  200U,  8U, 1U}, {0x00FF15UL, 6U,  200U,  8U, 0U}, {0x00FF16UL, 6U,  500U,  8U, 1U}, {0x00FF17UL, 6U,  500U,  8U, 0U},
+	{0x00FF18UL, 6U,  500U,  8U, 1U}, {0x00FF19UL, 6U,  500U,  8U, 0U}, {0x00FF1AUL, 6U, 1000U,  8U, 1U}, {0x00FF1BUL, 6U, 1000U,  8U, 0U},
+	{0x00FF1CUL, 6U, 1000U,  8U, 1U}, {0x00FF1DUL, 6U, 1000U, 20U, 1U}, {0x00FF1EUL, 6U, 5000U,  8U, 0U}, {0x00FF1FUL, 6U, 5000U, 40U, 1U}
+};
+
+static J1939_instance ecu;
+static J1939_instance listener;
+static uint8_t buffers[BENCHMARK_NUMBER_OF_PGNS][BENCHMARK_MAX_PAYLOAD];
+static uint64_t sendTimes[BENCHMARK_SEND_TIMES];
+static uint32_t sendHead = 0U;
+static uint32_t sendTail = 0U;
+static benchmarkResults results;
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is the TX hook of the ECU: the time the frame is queued is kept to measure its wait.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+static uint8_t benchmarkSend(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	uint8_t status = J1939_portSendFrame(channel, canId, data, dlc);
+
+	if(status == J1939_PORT_FRAME_QUEUED)
+	{
+		sendTimes[sendHead] = J1939_hostGetTime();
+		sendHead = (sendHead + 1U) % BENCHMARK_SEND_TIMES;
+	}
+
+	return status;
+}
+
+/**
+ * @brief 	This function is the RX interrupt of the listener: the wait and the bus load are measured
+ * 			and the frame is passed to the dispatcher.
+ * @retval	None.
+ */
+static void benchmarkReceive(void* context, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	uint64_t now = J1939_hostGetTime();
+	uint64_t latency;
+
+	// The bus is a FIFO, the frames come in the order they are sent
+	latency = now - sendTimes[sendTail];
+	sendTail = (sendTail + 1U) % BENCHMARK_SEND_TIMES;
+
+	benchmarkAddLatency(&results.latency, latency);
+
+	if((now / BENCHMARK_LOAD_WINDOW) != results.window)
+	{
+		results.window			= now / BENCHMARK_LOAD_WINDOW;
+		results.window_frames	= 0U;
+	}
+
+	if(++results.window_frames > results.max_window_frames) results.max_window_frames = results.window_frames;
+
+	benchmarkDispatch(context, canId, data, dlc);
+}
+
+/**
+ * @brief 	This function is the provider of the ECU: the payload is a counter of the transmissions.
+ * @retval	The payload size.
+ */
+static uint16_t benchmarkProvider(void* context, uint32_t PGN, uint8_t* data, uint16_t maxSize)
+{
+	const benchmarkPGN* cyclicPGN = (const benchmarkPGN*)context;
+	static uint8_t counter = 0U;
+
+	(void)PGN;
+
+	if(cyclicPGN->size > maxSize) return 0U;
+
+	counter++;
+	for(uint16_t i = 0U; i < cyclicPGN->size; i++) data[i] = (uint8_t)(counter + i);
+
+	return cyclicPGN->size;
+}
+
+/**
+ * @brief 	This function is the handler of the cyclic PGNs of the listener.
+ * @retval	None.
+ */
+static void benchmarkHandler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+							 const uint8_t* data, uint16_t size)
+{
+	const benchmarkPGN* cyclicPGN = (const benchmarkPGN*)context;
+
+	(void)PGN;
+	(void)destinationAddress;
+	(void)data;
+
+	if((sourceAddress != BENCHMARK_ECU_ADDRESS) || (size != cyclicPGN->size))
+	{
+		results.corrupted++;
+		return;
+	}
+
+	results.messages[cyclicPGN - PGNs]++;
+}
+
+/**
+ * @brief 	This function is used to run and report one benchmark case.
+ * @param	mode - The name of the case.
+ * @param	phase - The phase of all PGNs or J1939_CYCLIC_AUTO_PHASE.
+ * @param	startTime - The platform time at the start, ms.
+ * @param	time - The simulation time, ms.
+ * @param	statistics - A pointer to store the statistics of the cyclic transmission.
+ * @retval	1 - all messages are received, 0 - aren't.
+ */
+static uint8_t benchmarkRun(const char* mode, uint32_t phase, uint64_t startTime, uint32_t time, J1939_cyclicStatistics* statistics)
+{
+	uint64_t endTime;
+	uint32_t sleepTime;
+	uint8_t passed = 1U;
+
+	memset(&results, 0, sizeof(results));
+	sendHead = 0U;
+	sendTail = 0U;
+
+	J1939_hostInit(J1939_HOST_DEFAULT_BITRATE);
+	J1939_hostAdvanceTime(startTime * 1000U);
+	J1939_initInstance(&ecu, J1939_hostAddNode(NULL, NULL));
+	J1939_initInstance(&listener, J1939_hostAddNode(benchmarkReceive, &listener));
+	J1939_setTxHooks(&ecu, benchmarkSend, NULL);
+	J1939_setCurrentECUAddress(&ecu, BENCHMARK_ECU_ADDRESS);
+	J1939_setCurrentECUAddress(&listener, BENCHMARK_LISTENER_ADDRESS);
+
+	for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_PGNS; i++)
+	{
+		const benchmarkPGN* cyclicPGN = &PGNs[i];
+
+		J1939_registerPGNhandler(&listener, cyclicPGN->PGN, BENCHMARK_ECU_ADDRESS, J1939_ANY_ADDRESS, benchmarkHandler, (void*)cyclicPGN);
+
+		J1939_registerCyclicPGN(&ecu, cyclicPGN->PGN, cyclicPGN->priority, cyclicPGN->period, phase,
+								(cyclicPGN->provider != 0U) ? benchmarkProvider : NULL, (void*)cyclicPGN);
+
+		if(cyclicPGN->size > 8U) J1939_setCyclicBuffer(&ecu, cyclicPGN->PGN, buffers[i], BENCHMARK_MAX_PAYLOAD);
+
+		// The payload of the PGNs without a provider is set once and sent as it is
+		if(cyclicPGN->provider == 0U)
+		{
+			memset(buffers[i], i, cyclicPGN->size);
+			J1939_setCyclicData(&ecu, cyclicPGN->PGN, buffers[i], cyclicPGN->size);
+		}
+	}
+
+	// The task sleeps until the next deadline of the ECU or the listener
+	endTime = J1939_hostGetTime() + ((uint64_t)time * 1000U);
+	while(J1939_hostGetTime() < endTime)
+	{
+		uint32_t listenerSleepTime;
+
+		sleepTime			= J1939_processTimers(&ecu);
+		listenerSleepTime	= J1939_processTimers(&listener);
+		if(listenerSleepTime < sleepTime) sleepTime = listenerSleepTime;
+
+		if((J1939_hostProcessBus() > 0U) || (sleepTime == 0U)) continue;
+		if(sleepTime == J1939_TIMER_NO_DEADLINE) break;
+
+		J1939_hostAdvanceTime(((uint64_t)sleepTime * 1000U) - (J1939_hostGetTime() % 1000U));
+	}
+
+	J1939_getCyclicStatistics(&ecu, statistics);
+
+	printf("%-10s %7u %10.0f %9llu %9u %7u %9.2f %8u %8u %8u\n",
+		   mode, results.latency.samples, benchmarkGetAverageLatency(&results.latency),
+		   (unsigned long long)results.latency.max, results.max_window_frames, statistics->max_batch,
+		   (statistics->frames + statistics->BAM_messages > 0U) ? \
+				   (double)statistics->total_lateness / (statistics->frames + statistics->BAM_messages) : 0.0,
+		   statistics->max_lateness, statistics->deferred, statistics->missed_cycles);
+
+	// Every PGN must be received once per period
+	for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_PGNS; i++)
+	{
+		uint32_t expected = time / PGNs[i].period;
+
+		if((results.messages[i] + 1U < expected) || (results.messages[i] > expected + 1U))
+		{
+			printf("  PGN 0x%05X: %u messages, %u expected\n", PGNs[i].PGN, results.messages[i], expected);
+			passed = 0U;
+		}
+	}
+
+	if(results.corrupted > 0U)
+	{
+		printf("  %u corrupted messages\n", results.corrupted);
+		passed = 0U;
+	}
+
+	return passed;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	uint32_t time = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_TIME;
+	J1939_cyclicStatistics zeroStatistics, autoStatistics, wrapStatistics;
+	uint64_t zeroLatency;
+	uint8_t passed;
+
+	if(time == 0U) time = BENCHMARK_DEFAULT_TIME;
+
+	printf("SAE J1939-21 cyclic transmission simulation, %u PGNs, %u ms per case, virtual bus %u bit/s\n",
+		   BENCHMARK_NUMBER_OF_PGNS, time, J1939_HOST_DEFAULT_BITRATE);
+	printf("%-10s %7s %10s %9s %9s %7s %9s %8s %8s %8s\n", "phases", "frames", "mean us", "max us",
+		   "per 10ms", "burst", "late ms", "max ms", "deferred", "missed");
+
+	passed		= benchmarkRun("zero", 0U, 0U, time, &zeroStatistics);
+	zeroLatency	= results.latency.max;
+	passed		&= benchmarkRun("auto", J1939_CYCLIC_AUTO_PHASE, 0U, time, &autoStatistics);
+
+	// The phases chosen by the library must make the bursts and the waits shorter
+	if((autoStatistics.max_batch >= zeroStatistics.max_batch) || (results.latency.max >= zeroLatency)) passed = 0U;
+
+	// The platform time wraps in the middle of the case, the timers must go on
+	passed		&= benchmarkRun("wrap", J1939_CYCLIC_AUTO_PHASE, BENCHMARK_TIME_WRAP - (time / 2U), time, &wrapStatistics);
+
+	return (passed != 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
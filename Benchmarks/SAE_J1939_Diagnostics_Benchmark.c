@@ -0,0 +1,448 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Diagnostics_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Simulation of the SAE J1939-73 diagnostic messages. The fault
+  * 		 monitors of an engine ECU come and go, DM1 is broadcast every
+  * 		 second and read by a service tool over the virtual CAN bus. DM1
+  * 		 is rebuilt by the application every second, as the applications
+  * 		 did, and sent by the diagnostic module, which encodes it only
+  * 		 after a change. The encodings and the DM1s which changed the
+  * 		 table of the tool are reported, the table of the tool and DM2
+  * 		 are checked against the monitors. A DM1 with more DTCs than the
+  * 		 tool keeps per ECU must be cut to the first ones.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Port_Host.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_ECU_ADDRESS					(0x00U)
+#define BENCHMARK_TOOL_ADDRESS					(0xF9U)
+#define BENCHMARK_NUMBER_OF_MONITORS			(24U)
+#define BENCHMARK_DM1_PERIOD					(1000U)		// ms
+#define BENCHMARK_MONITOR_PERIOD				(100U)		// ms
+#define BENCHMARK_SETTLE_TIME					(2500U)		// ms
+#define BENCHMARK_REQUEST_PGN					(0x00EA00UL)
+#define BENCHMARK_DEFAULT_TIME					(120000U)	// ms
+#define BENCHMARK_OVERSIZED_ADDRESS				(0x30U)
+#define BENCHMARK_OVERSIZED_DTCS				(J1939_MAX_SOURCE_DTCS + 4U)
+#define BENCHMARK_OVERSIZED_SPN					(100U)		// The SPN of the first DTC, the next ones follow
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A fault monitor of the ECU.
+ */
+typedef struct
+{
+	uint32_t SPN;
+	uint8_t FMI;
+	uint8_t active;							/* 1 - the fault is present */
+	uint8_t occurrence_count;				/* Transitions to active */
+} benchmarkMonitor;
+
+/**
+ * @brief Results of a benchmark run.
+ */
+typedef struct
+{
+	uint32_t fault_changes;					/* Transitions of the monitors */
+	uint32_t encodings;						/* DM1s and DM2s encoded */
+	uint32_t DM2_size;						/* The size of the DM2 received by the tool */
+	uint32_t reported_changes;				/* DTC changes reported to the tool */
+} benchmarkResults;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static benchmarkMonitor monitors[BENCHMARK_NUMBER_OF_MONITORS] =
+{
+	{100U, 1U, 0U, 0U},	{110U, 0U, 0U, 0U},	{190U, 2U, 0U, 0U},	{91U, 3U, 0U, 0U},
+	{94U, 1U, 0U, 0U},	{97U, 16U, 0U, 0U},	{102U, 4U, 0U, 0U},	{105U, 0U, 0U, 0U},
+	{157U, 18U, 0U, 0U},	{168U, 4U, 0U, 0U},	{171U, 2U, 0U, 0U},	{175U, 0U, 0U, 0U},
+	{513U, 31U, 0U, 0U},	{629U, 12U, 0U, 0U},	{639U, 14U, 0U, 0U},	{651U, 5U, 0U, 0U},
+	{652U, 5U, 0U, 0U},	{653U, 6U, 0U, 0U},	{1569U, 31U, 0U, 0U},	{3031U, 9U, 0U, 0U},
+	{3216U, 2U, 0U, 0U},	{4364U, 18U, 0U, 0U},	{520372U, 7U, 0U, 0U},	{524287U, 30U, 0U, 0U}
+};
+
+static J1939_instance ecu;
+static J1939_instance tool;
+static benchmarkResults results;
+static uint8_t applicationBuffer[J1939_DM_MAX_SIZE];
+static uint32_t randomState;
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to get the next pseudo-random number, the same sequence in each case.
+ * @retval	The number from 0 to 65535.
+ */
+static uint32_t benchmarkRandom(void)
+{
+	randomState = (randomState * 1103515245UL) + 12345UL;
+
+	return (randomState >> 16U) & 0xFFFFU;
+}
+
+/**
+ * @brief 	This function is used to get the lamp status of the monitors: the amber warning lamp
+ * 			with any fault, the malfunction indicator flashing with the first one.
+ * @param	flashStatus - A pointer to store the flash status.
+ * @retval	The lamp status.
+ */
+static uint8_t benchmarkGetLamps(uint8_t* flashStatus)
+{
+	uint8_t anyActive = 0U;
+
+	for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_MONITORS; i++) anyActive |= monitors[i].active;
+
+	*flashStatus = J1939_LAMP_MIL((monitors[0].active == 1U) ? J1939_FLASH_FAST : J1939_FLASH_OFF) | \
+				   J1939_LAMP_RSL(J1939_FLASH_OFF) | J1939_LAMP_AWL(J1939_FLASH_OFF) | J1939_LAMP_PL(J1939_FLASH_OFF);
+
+	return J1939_LAMP_MIL(monitors[0].active) | J1939_LAMP_AWL(anyActive);
+}
+
+/**
+ * @brief 	This function is the DM1 of the application: the whole DTC list is built from the monitors.
+ * @param	data - A pointer to store the DM1.
+ * @retval	The DM1 size.
+ */
+static uint16_t benchmarkBuildDM1(uint8_t* data)
+{
+	uint16_t size = 2U;
+
+	data[0] = benchmarkGetLamps(&data[1]);
+
+	for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_MONITORS; i++)
+	{
+		const benchmarkMonitor* monitor = &monitors[i];
+
+		if(monitor->active == 0U) continue;
+
+		data[size]		= (uint8_t)monitor->SPN;
+		data[size + 1U]	= (uint8_t)(monitor->SPN >> 8U);
+		data[size + 2U]	= (uint8_t)(((monitor->SPN >> 16U) << 5U) | monitor->FMI);
+		data[size + 3U]	= monitor->occurrence_count;
+		size += 4U;
+	}
+
+	if(size == 2U)
+	{
+		memset(&data[size], 0, 4U);
+		size += 4U;
+	}
+
+	if(size < 8U)
+	{
+		memset(&data[size], 0xFF, 8U - size);
+		size = 8U;
+	}
+
+	results.encodings++;
+
+	return size;
+}
+
+/**
+ * @brief 	This function is used to change the monitors: one of 16 draws changes a fault, a fault which
+ * 			is present goes away more often than a new one comes, so a few faults are active at a time.
+ * @param	module - 1 - the changes are passed to the diagnostic module.
+ * @retval	None.
+ */
+static void benchmarkUpdateMonitors(uint8_t module)
+{
+	benchmarkMonitor* monitor = &monitors[benchmarkRandom() % BENCHMARK_NUMBER_OF_MONITORS];
+	uint8_t flashStatus;
+	uint8_t lampStatus;
+
+	if((benchmarkRandom() % 16U) != 0U) return;
+	if((monitor->active == 0U) && ((benchmarkRandom() % 4U) != 0U)) return;
+
+	monitor->active ^= 1U;
+	if((monitor->active == 1U) && (monitor->occurrence_count < 126U)) monitor->occurrence_count++;
+	results.fault_changes++;
+
+	if(module == 0U) return;
+
+	J1939_setDTC(&ecu, monitor->SPN, monitor->FMI, monitor->active);
+	lampStatus = benchmarkGetLamps(&flashStatus);
+	J1939_setLampStatus(&ecu, lampStatus, flashStatus);
+}
+
+/**
+ * @brief 	This function is used to send the DM1 of the application by a single frame or BAM.
+ * @retval	None.
+ */
+static void benchmarkSendApplicationDM1(void)
+{
+	J1939_TP_session* session;
+	uint16_t size;
+
+	// The buffer of a DM1 being sent can't be built again
+	if(J1939_isTXdataInUse(&ecu, applicationBuffer) == 1U) return;
+
+	size = benchmarkBuildDM1(applicationBuffer);
+
+	if(size <= 8U)
+	{
+		J1939_sendFrame(&ecu, (6UL << 26U) | (J1939_DM1_PGN << 8U) | BENCHMARK_ECU_ADDRESS, applicationBuffer, (uint8_t)size);
+	} else
+	{
+		session = J1939_fillTPstructures(&ecu, applicationBuffer, size, J1939_DM1_PGN, J1939_BROADCAST_ADDRESS);
+		if(session != NULL) J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_BAM);
+	}
+}
+
+/**
+ * @brief 	This function is the callback of the tool with the changes of the DTCs of the ECU.
+ * @retval	None.
+ */
+static void benchmarkDTCchanged(void* context, uint8_t sourceAddress, const J1939_DTC* DTC, uint8_t active)
+{
+	(void)context;
+	(void)DTC;
+	(void)active;
+
+	if(sourceAddress == BENCHMARK_ECU_ADDRESS) results.reported_changes++;
+}
+
+/**
+ * @brief 	This function is the handler of the DM2 of the tool.
+ * @retval	None.
+ */
+static void benchmarkDM2handler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+								const uint8_t* data, uint16_t size)
+{
+	(void)context;
+	(void)PGN;
+	(void)destinationAddress;
+	(void)data;
+
+	if(sourceAddress == BENCHMARK_ECU_ADDRESS) results.DM2_size = size;
+}
+
+/**
+ * @brief 	This function is used to check the DM1 table of the tool against the monitors.
+ * @retval	1 - the table has all active faults with their occurrence counts and the lamps, 0 - hasn't.
+ */
+static uint8_t benchmarkCheckTable(void)
+{
+	const J1939_DM1source* source = J1939_getDM1source(&tool, BENCHMARK_ECU_ADDRESS);
+	uint8_t numberOfActive = 0U;
+	uint8_t flashStatus;
+
+	if((source == NULL) || (source->lamp_status != benchmarkGetLamps(&flashStatus)) || (source->flash_status != flashStatus)) return 0U;
+
+	for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_MONITORS; i++)
+	{
+		uint8_t found = 0U;
+
+		if(monitors[i].active == 0U) continue;
+		numberOfActive++;
+
+		for(uint8_t j = 0U; j < source->number_of_DTCs; j++)
+		{
+			if((source->DTCs[j].SPN == monitors[i].SPN) && (source->DTCs[j].FMI == monitors[i].FMI) && \
+			   (source->DTCs[j].occurrence_count == monitors[i].occurrence_count)) found = 1U;
+		}
+
+		if(found == 0U) return 0U;
+	}
+
+	return (numberOfActive == source->number_of_DTCs) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is used to run and report one benchmark case.
+ * @param	mode - The name of the case.
+ * @param	module - 1 - DM1 and DM2 are sent by the diagnostic module, 0 - DM1 by the application.
+ * @param	time - The simulation time with the faults changing, ms.
+ * @retval	1 - the tool has got the faults of the ECU, 0 - hasn't.
+ */
+static uint8_t benchmarkRun(const char* mode, uint8_t module, uint32_t time)
+{
+	J1939_hostCounters counters;
+	J1939_diagnosticsStatistics ecuStatistics, toolStatistics;
+	uint32_t nextMonitor = 0U, nextDM1 = 0U;
+	uint32_t sleepTime, now;
+	uint32_t expectedDM2 = 0U;
+	uint8_t requested = 0U;
+	uint8_t passed;
+
+	memset(&results, 0, sizeof(results));
+	randomState = 1939U;
+
+	for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_MONITORS; i++)
+	{
+		monitors[i].active				= 0U;
+		monitors[i].occurrence_count	= 0U;
+	}
+
+	J1939_hostInit(J1939_HOST_DEFAULT_BITRATE);
+	benchmarkAddNode(&ecu);
+	J1939_setCurrentECUAddress(&ecu, BENCHMARK_ECU_ADDRESS);
+	benchmarkAddNode(&tool);
+	J1939_setCurrentECUAddress(&tool, BENCHMARK_TOOL_ADDRESS);
+
+	J1939_enableDM1reception(&tool, benchmarkDTCchanged, NULL);
+	J1939_registerPGNhandler(&tool, J1939_DM2_PGN, BENCHMARK_ECU_ADDRESS, J1939_ANY_ADDRESS, benchmarkDM2handler, NULL);
+
+	if(module != 0U) J1939_enableDiagnosticMessages(&ecu, BENCHMARK_DM1_PERIOD);
+
+	// The faults change for the given time, then the last DM1s and DM2 are waited
+	while((now = (uint32_t)(J1939_hostGetTime() / 1000U)) < time + BENCHMARK_SETTLE_TIME)
+	{
+		if((now >= nextMonitor) && (now < time))
+		{
+			benchmarkUpdateMonitors(module);
+			nextMonitor += BENCHMARK_MONITOR_PERIOD;
+		}
+
+		if((module == 0U) && (now >= nextDM1))
+		{
+			benchmarkSendApplicationDM1();
+			nextDM1 += BENCHMARK_DM1_PERIOD;
+		}
+
+		sleepTime = J1939_processTimers(&ecu);
+
+		// The tool requests DM2 once the faults have settled
+		if((module != 0U) && (requested == 0U) && (now >= time + BENCHMARK_DM1_PERIOD))
+		{
+			uint8_t request[3] = {(uint8_t)J1939_DM2_PGN, (uint8_t)(J1939_DM2_PGN >> 8U), (uint8_t)(J1939_DM2_PGN >> 16U)};
+
+			J1939_sendFrame(&tool, (6UL << 26U) | (BENCHMARK_REQUEST_PGN << 8U) | ((uint32_t)BENCHMARK_ECU_ADDRESS << 8U) | \
+							BENCHMARK_TOOL_ADDRESS, request, sizeof(request));
+			requested = 1U;
+		}
+
+		{
+			uint32_t toolSleepTime = J1939_processTimers(&tool);
+
+			if(toolSleepTime < sleepTime) sleepTime = toolSleepTime;
+		}
+
+		if((J1939_hostProcessBus() > 0U) || (sleepTime == 0U)) continue;
+
+		// The tasks sleep until the next deadline, at most 1 ms
+		if(sleepTime > 1U) sleepTime = 1U;
+		J1939_hostAdvanceTime(((uint64_t)sleepTime * 1000U) - (J1939_hostGetTime() % 1000U));
+	}
+
+	J1939_hostGetCounters(&counters);
+	J1939_getDiagnosticsStatistics(&ecu, &ecuStatistics);
+	J1939_getDiagnosticsStatistics(&tool, &toolStatistics);
+
+	if(module != 0U) results.encodings = ecuStatistics.encodings;
+
+	printf("%-12s %8u %8u %10u %10u %10u %10llu\n",
+		   mode, results.fault_changes, toolStatistics.DM1_received, results.encodings,
+		   toolStatistics.DM1_unchanged, results.reported_changes,
+		   (unsigned long long)counters.frames);
+
+	passed = benchmarkCheckTable();
+
+	if(module != 0U)
+	{
+		// DM2 carries the faults which have been present and are gone, a short one is padded to 8 bytes
+		for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_MONITORS; i++)
+		{
+			if((monitors[i].active == 0U) && (monitors[i].occurrence_count > 0U)) expectedDM2++;
+		}
+		expectedDM2 = (expectedDM2 < 2U) ? 8U : 2U + (expectedDM2 * 4U);
+
+		printf("  module: %u encodings, DM2 %u bytes (expected %u)\n", ecuStatistics.encodings, results.DM2_size, expectedDM2);
+
+		if(results.DM2_size != expectedDM2) passed = 0U;
+	}
+
+	if(passed == 0U) printf("  the table of the tool doesn't match the faults of the ECU\n");
+
+	return passed;
+}
+
+/**
+ * @brief 	This function is used to pass a DM1 with BENCHMARK_OVERSIZED_DTCS DTCs to the tool.
+ * @retval	1 - the tool has kept the first J1939_MAX_SOURCE_DTCS DTCs and counted the rest as dropped, 0 - hasn't.
+ */
+static uint8_t benchmarkRunOversized(void)
+{
+	uint8_t data[2U + (BENCHMARK_OVERSIZED_DTCS * 4U)] = {0};
+	const J1939_DM1source* source;
+	J1939_diagnosticsStatistics statistics;
+	uint32_t dropped;
+	uint8_t passed = 1U;
+
+	J1939_getDiagnosticsStatistics(&tool, &statistics);
+	dropped = statistics.dropped;
+
+	for(uint8_t i = 0U; i < BENCHMARK_OVERSIZED_DTCS; i++)
+	{
+		uint32_t SPN = BENCHMARK_OVERSIZED_SPN + i;
+
+		data[2U + (i * 4U)]	= (uint8_t)SPN;
+		data[3U + (i * 4U)]	= (uint8_t)(SPN >> 8U);
+		data[4U + (i * 4U)]	= (uint8_t)(((SPN >> 16U) << 5U) | 3U);
+		data[5U + (i * 4U)]	= 1U;
+	}
+
+	J1939_dispatchMessage(&tool, J1939_DM1_PGN, BENCHMARK_OVERSIZED_ADDRESS, J1939_BROADCAST_ADDRESS, data, sizeof(data));
+
+	J1939_getDiagnosticsStatistics(&tool, &statistics);
+	source = J1939_getDM1source(&tool, BENCHMARK_OVERSIZED_ADDRESS);
+
+	if((source == NULL) || (source->number_of_DTCs != J1939_MAX_SOURCE_DTCS) || (statistics.dropped != dropped + 1U)) passed = 0U;
+
+	for(uint8_t i = 0U; (passed == 1U) && (i < J1939_MAX_SOURCE_DTCS); i++)
+	{
+		if((source->DTCs[i].SPN != BENCHMARK_OVERSIZED_SPN + i) || (source->DTCs[i].FMI != 3U)) passed = 0U;
+	}
+
+	printf("oversized DM1: %u DTCs, %u kept\n", BENCHMARK_OVERSIZED_DTCS, (source != NULL) ? source->number_of_DTCs : 0U);
+
+	return passed;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	uint32_t time = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_TIME;
+	uint32_t applicationEncodings;
+	uint8_t passed;
+
+	if(time == 0U) time = BENCHMARK_DEFAULT_TIME;
+
+	printf("SAE J1939-73 DM1/DM2 simulation, %u monitors, DM1 every %u ms, %u ms, virtual bus %u bit/s\n",
+		   BENCHMARK_NUMBER_OF_MONITORS, BENCHMARK_DM1_PERIOD, time, J1939_HOST_DEFAULT_BITRATE);
+	printf("%-12s %8s %8s %10s %10s %10s %10s\n", "mode", "changes", "DM1s", "encodings",
+		   "unchanged", "reported", "bus frames");
+
+	passed = benchmarkRun("application", 0U, time);
+	applicationEncodings = results.encodings;
+	passed &= benchmarkRun("module", 1U, time);
+	passed &= benchmarkRunOversized();
+
+	// Both must deliver the faults, the module with fewer encodings
+	return ((passed == 1U) && (results.encodings < applicationEncodings)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
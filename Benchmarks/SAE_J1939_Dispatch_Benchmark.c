@@ -0,0 +1,206 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Dispatch_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Benchmark of the SAE J1939-21 receive dispatcher. The time per
+  * 		 frame of the PGN table is compared with a chain of PGN comparisons
+  * 		 for a growing number of handled PGNs. The PDU2 groups must be
+  * 		 reused when handlers of all PDU formats come and go.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_ECU_ADDRESS					(0x20U)
+#define BENCHMARK_DEFAULT_FRAMES				(10000000U)
+#define BENCHMARK_FRAME_PATTERN					(1024U)
+#define BENCHMARK_PDU2_FORMATS					(16U)		// PDU format from 240 to 255
+#define BENCHMARK_CHURN_ROUNDS					(4U)
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static J1939_instance ecu;
+static uint32_t PGNs[J1939_MAX_PGN_HANDLERS];
+static J1939_PGNhandler chainHandlers[J1939_MAX_PGN_HANDLERS];
+static uint32_t frameIds[BENCHMARK_FRAME_PATTERN];
+static volatile uint32_t handledFrames = 0U;
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is the handler of all benchmark PGNs.
+ * @retval	None.
+ */
+static void benchmarkHandler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+							 const uint8_t* data, uint16_t size)
+{
+	(void)context;
+	(void)PGN;
+	(void)sourceAddress;
+	(void)destinationAddress;
+	(void)data;
+	(void)size;
+
+	handledFrames++;
+}
+
+/**
+ * @brief 	This function is used to make the n-th benchmark PGN: PDU1 and PDU2 PGNs take turns.
+ * @param	n - The PGN number.
+ * @retval	The PGN.
+ */
+static uint32_t benchmarkGetPGN(uint32_t n)
+{
+	return ((n & 1U) == 0U) ? ((0x10U + n) << 8U) : (0xFE00U | (uint8_t)(0x10U + n));
+}
+
+/**
+ * @brief 	This function is used to dispatch the frame by comparing its PGN with every handled PGN,
+ * 			as the applications did without the dispatcher. The handlers are called by pointers,
+ * 			as they are in other modules of the application.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	numberOfPGNs - The number of handled PGNs.
+ * @retval	None.
+ */
+static void benchmarkDispatchByChain(uint32_t canId, const uint8_t* data, uint32_t numberOfPGNs)
+{
+	uint8_t PDUformat = (uint8_t)(canId >> 16U);
+	uint32_t PGN = (canId >> 8U) & 0x3FFFFU;
+
+	if(PDUformat < 240U) PGN &= 0x3FF00U;
+
+	for(uint32_t i = 0U; i < numberOfPGNs; i++)
+	{
+		if(PGN == PGNs[i])
+		{
+			chainHandlers[i](NULL, PGN, (uint8_t)canId, 0xFFU, data, 8U);
+			break;
+		}
+	}
+}
+
+/**
+ * @brief 	This function is used to run and report one benchmark case.
+ * @param	numberOfPGNs - The number of handled PGNs.
+ * @param	frames - The number of dispatched frames.
+ * @retval	0 if all frames have been handled by both methods, 1 otherwise.
+ */
+static int benchmarkRun(uint32_t numberOfPGNs, uint32_t frames)
+{
+	static const uint8_t data[8] = {0};
+	double startTime, tableTime, chainTime;
+	uint32_t tableFrames, chainFrames;
+
+	for(uint32_t i = 0U; i < numberOfPGNs; i++)
+	{
+		PGNs[i]				= benchmarkGetPGN(i);
+		chainHandlers[i]	= benchmarkHandler;
+		J1939_registerPGNhandler(&ecu, PGNs[i], J1939_ANY_ADDRESS, J1939_ANY_ADDRESS, benchmarkHandler, NULL);
+	}
+
+	// The frames hit the handled PGNs in turn, so the chain is scanned to its middle on average
+	for(uint32_t i = 0U; i < BENCHMARK_FRAME_PATTERN; i++)
+	{
+		uint32_t PGN = PGNs[(i * 7U) % numberOfPGNs];
+		uint32_t destination = (((PGN >> 8U) & 0xFFU) < 240U) ? ((uint32_t)BENCHMARK_ECU_ADDRESS << 8U) : 0U;
+
+		frameIds[i] = (6UL << 26U) | (PGN << 8U) | destination | 0x10U;
+	}
+
+	handledFrames = 0U;
+	startTime = benchmarkGetWallTime();
+	for(uint32_t i = 0U; i < frames; i++) J1939_dispatchFrame(&ecu, frameIds[i & (BENCHMARK_FRAME_PATTERN - 1U)], data, 8U);
+	tableTime = benchmarkGetWallTime() - startTime;
+	tableFrames = handledFrames;
+
+	handledFrames = 0U;
+	startTime = benchmarkGetWallTime();
+	for(uint32_t i = 0U; i < frames; i++) benchmarkDispatchByChain(frameIds[i & (BENCHMARK_FRAME_PATTERN - 1U)], data, numberOfPGNs);
+	chainTime = benchmarkGetWallTime() - startTime;
+	chainFrames = handledFrames;
+
+	printf("%6u %14.2f %14.2f %10u/%u\n", numberOfPGNs, (tableTime * 1e9) / frames, (chainTime * 1e9) / frames,
+		   tableFrames, frames);
+
+	for(uint32_t i = 0U; i < numberOfPGNs; i++) J1939_unregisterPGNhandler(&ecu, PGNs[i], benchmarkHandler);
+
+	return ((tableFrames == frames) && (chainFrames == frames)) ? 0 : 1;
+}
+
+/**
+ * @brief 	This function is used to register and unregister a handler of every PDU2 format in turn, more
+ * 			formats than J1939_MAX_PDU2_GROUPS. The group of a format must be freed for the next one.
+ * @retval	0 if the handler of every format has been registered and called, 1 otherwise.
+ */
+static int benchmarkRunGroupChurn(void)
+{
+	static const uint8_t data[8] = {0};
+	uint32_t registered = 0U;
+
+	handledFrames = 0U;
+
+	for(uint32_t round = 0U; round < BENCHMARK_CHURN_ROUNDS; round++)
+	{
+		for(uint32_t i = 0U; i < BENCHMARK_PDU2_FORMATS; i++)
+		{
+			uint32_t PGN = ((240U + i) << 8U) | 0x10U;
+
+			if(J1939_registerPGNhandler(&ecu, PGN, J1939_ANY_ADDRESS, J1939_ANY_ADDRESS, benchmarkHandler, NULL) == J1939_DISPATCH_OK)
+			{
+				registered++;
+			}
+
+			J1939_dispatchFrame(&ecu, (6UL << 26U) | (PGN << 8U) | 0x10U, data, 8U);
+			J1939_unregisterPGNhandler(&ecu, PGN, benchmarkHandler);
+		}
+	}
+
+	printf("\nPDU2 groups of %u: %u/%u handlers registered, %u called\n", J1939_MAX_PDU2_GROUPS, registered,
+		   BENCHMARK_CHURN_ROUNDS * BENCHMARK_PDU2_FORMATS, handledFrames);
+
+	return ((registered == (BENCHMARK_CHURN_ROUNDS * BENCHMARK_PDU2_FORMATS)) && (handledFrames == registered)) ? 0 : 1;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	static const uint32_t numbersOfPGNs[] = {1U, 4U, 8U, 16U, J1939_MAX_PGN_HANDLERS};
+	uint32_t frames = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_FRAMES;
+	int failures = 0;
+
+	if(frames == 0U) frames = BENCHMARK_DEFAULT_FRAMES;
+
+	J1939_initInstance(&ecu, 0U);
+	J1939_setCurrentECUAddress(&ecu, BENCHMARK_ECU_ADDRESS);
+
+	printf("SAE J1939-21 dispatcher benchmark, %u frames per case\n", frames);
+	printf("%6s %14s %14s %12s\n", "PGNs", "table ns/frame", "chain ns/frame", "handled");
+
+	for(uint8_t i = 0U; i < (sizeof(numbersOfPGNs) / sizeof(numbersOfPGNs[0])); i++)
+	{
+		failures += benchmarkRun(numbersOfPGNs[i], frames);
+	}
+
+	failures += benchmarkRunGroupChurn();
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
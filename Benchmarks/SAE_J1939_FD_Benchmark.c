@@ -0,0 +1,355 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_FD_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Simulation of the CAN FD data link (SAE J1939-22). The same
+  * 		 messages are sent by J1939_sendPGN between two nodes on a
+  * 		 500 kbit/s bus, by classic CAN with TP and by CAN FD with a
+  * 		 2 Mbit/s data phase with multi-PG and FD.TP. The frames, the bus
+  * 		 time and the latency of every message are compared and every
+  * 		 message received is checked against the message sent. The CAN FD
+  * 		 messages are also sent to a receiver with the acceptance filters.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Port_Host.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_SENDER_ADDRESS				(0x10U)
+#define BENCHMARK_RECEIVER_ADDRESS				(0x20U)
+#define BENCHMARK_PTP_PGN						(0x00EF00UL)	// Proprietary A, PDU1
+#define BENCHMARK_BAM_PGN						(0x00FF10UL)
+#define BENCHMARK_SMALL_PGN						(0x00FF20UL)	// The first of the PGNs sent every cycle
+#define BENCHMARK_SMALL_PGNS					(8U)
+#define BENCHMARK_SMALL_SIZE					(8U)
+#define BENCHMARK_SMALL_PRIORITY				(6U)
+#define BENCHMARK_CYCLE							(10U)		// ms
+#define BENCHMARK_BITRATE						(500000U)
+#define BENCHMARK_DATA_BITRATE					(2000000U)
+#define BENCHMARK_MAX_MESSAGE_SIZE				(1785U)
+#define BENCHMARK_MESSAGE_TIMEOUT				(20000U)	// ms, a classic BAM of 1785 bytes takes 12.75 s
+#define BENCHMARK_DRAIN_TIME					(100U)		// ms after a message to close the sessions
+#define BENCHMARK_DEFAULT_MESSAGES				(5U)
+#define BENCHMARK_DEFAULT_CYCLES				(100U)
+#define BENCHMARK_LOST_SEGMENT_PERIOD			(25U)
+
+#define BENCHMARK_GET_PDU_FORMAT(canId)			((uint8_t)((canId) >> 16U))
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A benchmark node on the virtual bus.
+ */
+typedef struct
+{
+	uint8_t address;
+	J1939_instance instance;				/* The stack of the node, its channel is the node */
+} benchmarkNode;
+
+/**
+ * @brief The results of a case.
+ */
+typedef struct
+{
+	uint32_t messages;						/* Messages received */
+	uint32_t wrong_messages;				/* Messages received with wrong data or size */
+	uint64_t frames;						/* Bus frames */
+	benchmarkLatency latency;				/* The times from sending to receiving the messages, us */
+} benchmarkResults;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static benchmarkNode sender		= {.address = BENCHMARK_SENDER_ADDRESS};
+static benchmarkNode receiver	= {.address = BENCHMARK_RECEIVER_ADDRESS};
+static uint8_t message[BENCHMARK_MAX_MESSAGE_SIZE];
+static uint16_t messageSize = 0U;
+static uint64_t receiveTime = 0U;
+static uint64_t busTime = 0U;
+static uint32_t dataSegments = 0U;
+static uint8_t filtersEnabled = 0U;
+static benchmarkResults results;
+
+static const uint16_t messageSizes[] = {9U, 60U, 100U, 300U, 1000U, 1785U};
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to lose every BENCHMARK_LOST_SEGMENT_PERIOD FD.TP data transfer segment.
+ * @retval	1 if the frame is lost, 0 otherwise.
+ */
+static uint8_t benchmarkLoseSegment(uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	(void)data;
+	(void)dlc;
+
+	if(BENCHMARK_GET_PDU_FORMAT(canId) != J1939_FD_DATA_TRANSFER) return 0U;
+
+	return ((++dataSegments % BENCHMARK_LOST_SEGMENT_PERIOD) == 0U) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is the handler of the multi-packet messages of the receiver: the data is checked.
+ * @retval	None.
+ */
+static void benchmarkMessageHandler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+									const uint8_t* data, uint16_t size)
+{
+	(void)context;
+	(void)PGN;
+	(void)sourceAddress;
+	(void)destinationAddress;
+
+	if((size != messageSize) || (memcmp(data, message, size) != 0)) results.wrong_messages++;
+
+	results.messages++;
+	receiveTime = J1939_hostGetTime();
+}
+
+/**
+ * @brief 	This function is the handler of the small PGNs of the receiver: the data is checked.
+ * @retval	None.
+ */
+static void benchmarkSmallHandler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+								  const uint8_t* data, uint16_t size)
+{
+	(void)context;
+	(void)sourceAddress;
+	(void)destinationAddress;
+
+	if((size != BENCHMARK_SMALL_SIZE) || (memcmp(data, &message[PGN - BENCHMARK_SMALL_PGN], size) != 0)) results.wrong_messages++;
+
+	results.messages++;
+}
+
+/**
+ * @brief 	This function is used to start a case: the bus and the nodes are initialized.
+ * @param	dataLink - The data link of the sender.
+ * @retval	None.
+ */
+static void benchmarkSetup(J1939_dataLinks dataLink)
+{
+	J1939_hostInit(BENCHMARK_BITRATE);
+	J1939_hostSetDataBitrate(BENCHMARK_DATA_BITRATE);
+
+	benchmarkAddNode(&sender.instance);
+	benchmarkAddNode(&receiver.instance);
+	J1939_setCurrentECUAddress(&sender.instance, sender.address);
+	J1939_setCurrentECUAddress(&receiver.instance, receiver.address);
+
+	// The filters are made again when the data link is selected and the handlers are registered
+	if(filtersEnabled == 1U) J1939_enableAcceptanceFilters(&receiver.instance);
+
+	J1939_setDataLink(&sender.instance, dataLink);
+	J1939_setDataLink(&receiver.instance, dataLink);
+
+	J1939_registerPGNhandler(&receiver.instance, BENCHMARK_PTP_PGN, sender.address, J1939_ANY_ADDRESS, benchmarkMessageHandler, NULL);
+	J1939_registerPGNhandler(&receiver.instance, BENCHMARK_BAM_PGN, sender.address, J1939_ANY_ADDRESS, benchmarkMessageHandler, NULL);
+
+	for(uint32_t i = 0U; i < BENCHMARK_SMALL_PGNS; i++)
+	{
+		J1939_registerPGNhandler(&receiver.instance, BENCHMARK_SMALL_PGN + i, sender.address, J1939_ANY_ADDRESS,
+								 benchmarkSmallHandler, NULL);
+	}
+
+	memset(&results, 0, sizeof(results));
+	busTime = 0U;
+}
+
+/**
+ * @brief 	This function is used to run the nodes and the bus until the given virtual time.
+ * @param	endTime - The virtual time to stop at, us.
+ * @param	stopOnMessage - 1 - stop when a multi-packet message is received, 0 - run until the end time.
+ * @retval	None.
+ */
+static void benchmarkRun(uint64_t endTime, uint8_t stopOnMessage)
+{
+	uint32_t messages = results.messages;
+	uint32_t sleepTime, nodeSleepTime;
+	uint64_t startTime;
+	uint32_t frames;
+
+	while(J1939_hostGetTime() < endTime)
+	{
+		if((stopOnMessage == 1U) && (results.messages != messages)) return;
+
+		sleepTime		= J1939_processTimers(&sender.instance);
+		nodeSleepTime	= J1939_processTimers(&receiver.instance);
+		if(nodeSleepTime < sleepTime) sleepTime = nodeSleepTime;
+
+		J1939_sendTPpendingPackages(&sender.instance);
+		J1939_sendFDTPpendingSegments(&sender.instance);
+
+		startTime	= J1939_hostGetTime();
+		frames		= J1939_hostProcessBus();
+		busTime		+= J1939_hostGetTime() - startTime;
+
+		if((frames > 0U) || (sleepTime == 0U)) continue;
+
+		// The task sleeps until the next deadline, at most 1 ms
+		if(sleepTime > 1U) sleepTime = 1U;
+		J1939_hostAdvanceTime(((uint64_t)sleepTime * 1000U) - (J1939_hostGetTime() % 1000U));
+	}
+}
+
+/**
+ * @brief 	This function is used to send messages of the given size one after another and to measure them.
+ * @param	dataLink - The data link of the nodes.
+ * @param	size - The size of the messages.
+ * @param	destinationAddress - The receiver or the global address for BAM.
+ * @param	numberOfMessages - The number of messages.
+ * @param	lossFilter - The loss filter of the bus or NULL.
+ * @retval	1 - every message has been received, 0 - not.
+ */
+static uint8_t benchmarkMessages(J1939_dataLinks dataLink, uint16_t size, uint8_t destinationAddress, uint32_t numberOfMessages,
+								 J1939_hostLossFilter lossFilter)
+{
+	uint32_t PGN = (destinationAddress == J1939_BROADCAST_ADDRESS) ? BENCHMARK_BAM_PGN : BENCHMARK_PTP_PGN;
+	J1939_hostCounters counters;
+	uint64_t sendTime;
+
+	benchmarkSetup(dataLink);
+	J1939_hostSetLossFilter(lossFilter);
+	messageSize = size;
+
+	for(uint32_t i = 0U; i < numberOfMessages; i++)
+	{
+		for(uint16_t j = 0U; j < size; j++) message[j] = (uint8_t)rand();
+
+		sendTime = J1939_hostGetTime();
+		if(J1939_sendPGN(&sender.instance, PGN, J1939_LOWEST_PRIORITY, destinationAddress, message, size) != J1939_SEND_OK) break;
+
+		benchmarkRun(sendTime + ((uint64_t)BENCHMARK_MESSAGE_TIMEOUT * 1000U), 1U);
+		if(results.messages != (i + 1U)) break;
+
+		benchmarkAddLatency(&results.latency, receiveTime - sendTime);
+
+		// The sessions are closed before the next message
+		benchmarkRun(J1939_hostGetTime() + ((uint64_t)BENCHMARK_DRAIN_TIME * 1000U), 0U);
+	}
+
+	J1939_hostGetCounters(&counters);
+	results.frames = counters.frames;
+
+	printf("  %-7s %s%-5s %5u bytes: %7.1f frames/msg %9.1f us bus/msg %10.1f us latency (max %llu us)%s\n",
+		   (dataLink == J1939_DATA_LINK_FD) ? "CAN FD" : "classic", (destinationAddress == J1939_BROADCAST_ADDRESS) ? "BAM" : "RTS",
+		   (lossFilter != NULL) ? " lost" : "", size, (double)results.frames / numberOfMessages, (double)busTime / numberOfMessages,
+		   benchmarkGetAverageLatency(&results.latency), (unsigned long long)results.latency.max,
+		   (results.wrong_messages > 0U) ? " WRONG DATA" : "");
+
+	return ((results.messages == numberOfMessages) && (results.wrong_messages == 0U)) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is used to send BENCHMARK_SMALL_PGNS PGNs every BENCHMARK_CYCLE ms.
+ * @param	dataLink - The data link of the nodes.
+ * @param	numberOfCycles - The number of cycles.
+ * @param	result - A pointer to the results of the case.
+ * @retval	1 - every PGN has been received, 0 - not.
+ */
+static uint8_t benchmarkSmallPGNs(J1939_dataLinks dataLink, uint32_t numberOfCycles, benchmarkResults* result)
+{
+	J1939_hostCounters counters;
+	uint8_t sent = 1U;
+
+	benchmarkSetup(dataLink);
+
+	for(uint16_t j = 0U; j < (BENCHMARK_SMALL_PGNS + BENCHMARK_SMALL_SIZE); j++) message[j] = (uint8_t)rand();
+
+	for(uint32_t cycle = 0U; cycle < numberOfCycles; cycle++)
+	{
+		for(uint32_t i = 0U; i < BENCHMARK_SMALL_PGNS; i++)
+		{
+			if(J1939_sendPGN(&sender.instance, BENCHMARK_SMALL_PGN + i, BENCHMARK_SMALL_PRIORITY, J1939_BROADCAST_ADDRESS, &message[i],
+							 BENCHMARK_SMALL_SIZE) != J1939_SEND_OK) sent = 0U;
+		}
+
+		benchmarkRun((uint64_t)(cycle + 1U) * BENCHMARK_CYCLE * 1000U, 0U);
+	}
+
+	J1939_hostGetCounters(&counters);
+	results.frames = counters.frames;
+	*result = results;
+
+	printf("  %-7s %u PGNs of %u bytes every %u ms: %llu frames, %llu FD, %.1f us bus per cycle, %.2f %% bus load\n",
+		   (dataLink == J1939_DATA_LINK_FD) ? "CAN FD" : "classic", BENCHMARK_SMALL_PGNS, BENCHMARK_SMALL_SIZE, BENCHMARK_CYCLE,
+		   (unsigned long long)counters.frames, (unsigned long long)counters.fd_frames, (double)busTime / numberOfCycles,
+		   (100.0 * (double)busTime) / ((double)numberOfCycles * BENCHMARK_CYCLE * 1000.0));
+
+	return ((sent == 1U) && (results.messages == (numberOfCycles * BENCHMARK_SMALL_PGNS)) && (results.wrong_messages == 0U)) ? 1U : 0U;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	uint32_t numberOfMessages = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_MESSAGES;
+	benchmarkResults classicSmall, FDsmall;
+	uint64_t classicFrames, FDframes;
+	uint8_t passed = 1U;
+
+	if(numberOfMessages == 0U) numberOfMessages = BENCHMARK_DEFAULT_MESSAGES;
+
+	srand(1939U);
+
+	printf("SAE J1939-22 CAN FD simulation, %u kbit/s, data phase %u kbit/s, %u messages per case\n",
+		   BENCHMARK_BITRATE / 1000U, BENCHMARK_DATA_BITRATE / 1000U, numberOfMessages);
+
+	for(uint8_t destination = 0U; destination < 2U; destination++)
+	{
+		uint8_t destinationAddress = (destination == 0U) ? BENCHMARK_RECEIVER_ADDRESS : J1939_BROADCAST_ADDRESS;
+
+		for(uint8_t i = 0U; i < (sizeof(messageSizes) / sizeof(messageSizes[0])); i++)
+		{
+			passed &= benchmarkMessages(J1939_DATA_LINK_CLASSIC, messageSizes[i], destinationAddress, numberOfMessages, NULL);
+			classicFrames = results.frames;
+			passed &= benchmarkMessages(J1939_DATA_LINK_FD, messageSizes[i], destinationAddress, numberOfMessages, NULL);
+			FDframes = results.frames;
+
+			// A message longer than a frame takes fewer frames on CAN FD
+			passed &= (FDframes < classicFrames);
+		}
+	}
+
+	// The lost segments of RTS/CTS messages are requested again
+	passed &= benchmarkMessages(J1939_DATA_LINK_FD, BENCHMARK_MAX_MESSAGE_SIZE, BENCHMARK_RECEIVER_ADDRESS, numberOfMessages,
+								benchmarkLoseSegment);
+	passed &= (receiver.instance.statistics.sessions[J1939_STATISTICS_FD_TP_RX].retransmitted_packages > 0U);
+
+	printf("multi-PG:\n");
+	passed &= benchmarkSmallPGNs(J1939_DATA_LINK_CLASSIC, BENCHMARK_DEFAULT_CYCLES, &classicSmall);
+	passed &= benchmarkSmallPGNs(J1939_DATA_LINK_FD, BENCHMARK_DEFAULT_CYCLES, &FDsmall);
+	passed &= (FDsmall.frames < classicSmall.frames);
+	printf("  %u C-PGs packed into %u multi-PG frames\n", sender.instance.multi_PG.packed_PGs, sender.instance.multi_PG.frames);
+
+	// The multi-PG and FD.TP frames must pass the acceptance filters of the receiver
+	printf("acceptance filters:\n");
+	filtersEnabled = 1U;
+	passed &= benchmarkMessages(J1939_DATA_LINK_FD, BENCHMARK_MAX_MESSAGE_SIZE, BENCHMARK_RECEIVER_ADDRESS, numberOfMessages, NULL);
+	passed &= benchmarkMessages(J1939_DATA_LINK_FD, BENCHMARK_MAX_MESSAGE_SIZE, J1939_BROADCAST_ADDRESS, numberOfMessages, NULL);
+	passed &= benchmarkSmallPGNs(J1939_DATA_LINK_FD, BENCHMARK_DEFAULT_CYCLES, &FDsmall);
+	filtersEnabled = 0U;
+
+	printf("%s\n", (passed == 1U) ? "PASSED" : "FAILED");
+
+	return (passed == 1U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
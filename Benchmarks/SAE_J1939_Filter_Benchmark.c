@@ -0,0 +1,285 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Filter_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Simulation of the hardware acceptance filters. Busy 500 kbit/s
+  * 		 traffic of many ECUs is sent over the virtual CAN bus to an ECU
+  * 		 with a growing number of registered PGNs. The share of frames
+  * 		 rejected by the filters and the RX interrupt rate are reported,
+  * 		 the handled frames are checked against the run without filters.
+  * 		 The filters of a CAN FD ECU with the most PDU1 handlers are made
+  * 		 without being merged.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Port_Host.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_ECU_ADDRESS					(0x20U)
+#define BENCHMARK_NEW_ECU_ADDRESS				(0x21U)
+#define BENCHMARK_BITRATE						(500000U)
+#define BENCHMARK_DEFAULT_FRAMES				(200000U)
+#define BENCHMARK_TRAFFIC_MESSAGES				(192U)
+#define BENCHMARK_TP_SHARE						(10U)	// Percent of frames which are TP.DT between other ECUs
+#define BENCHMARK_BUS_BATCH						(256U)
+#define BENCHMARK_MAKE_ITERATIONS				(1000U)
+#define BENCHMARK_FD_ECU_ADDRESS				(0x40U)
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static uint32_t randomState = 1U;
+static uint8_t ecuAddress = BENCHMARK_ECU_ADDRESS;
+static J1939_instance ecu;
+static J1939_instance FDecu;
+static uint8_t trafficNode;
+static uint32_t handledFrames = 0U;
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to get a pseudo-random number, the traffic is repeated for every run.
+ * @retval	The number.
+ */
+static uint32_t benchmarkRandom(void)
+{
+	randomState = (randomState * 1103515245U) + 12345U;
+
+	return randomState >> 8U;
+}
+
+/**
+ * @brief 	This function is the handler of all registered PGNs.
+ * @retval	None.
+ */
+static void benchmarkHandler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+							 const uint8_t* data, uint16_t size)
+{
+	(void)context;
+	(void)PGN;
+	(void)sourceAddress;
+	(void)destinationAddress;
+	(void)data;
+	(void)size;
+
+	handledFrames++;
+}
+
+/**
+ * @brief 	This function is used to get the PGN of the n-th traffic message. Every third message is PDU1.
+ * @param	n - The message number.
+ * @retval	The PGN.
+ */
+static uint32_t benchmarkGetPGN(uint32_t n)
+{
+	if((n % 3U) == 0U) return (0x80U + (n % 0x40U)) << 8U;
+
+	return 0xF000U | ((n * 0x2F3U) & 0x0FFFU);
+}
+
+/**
+ * @brief 	This function is used to get the source address of the n-th traffic message.
+ * @param	n - The message number.
+ * @retval	The source address.
+ */
+static uint8_t benchmarkGetSourceAddress(uint32_t n)
+{
+	return (uint8_t)(0x80U + (n % 16U));
+}
+
+/**
+ * @brief 	This function is used to make the CAN ID of the next traffic frame. PDU1 messages are sent
+ * 			to the ECU, to all ECUs or to other ECUs.
+ * @retval	The CAN ID.
+ */
+static uint32_t benchmarkGetTrafficId(void)
+{
+	uint32_t n = benchmarkRandom() % BENCHMARK_TRAFFIC_MESSAGES;
+	uint32_t priority = ((benchmarkRandom() & 1U) == 0U) ? 3U : 6U;
+	uint32_t PGN = benchmarkGetPGN(n);
+	uint32_t destination;
+
+	if((benchmarkRandom() % 100U) < BENCHMARK_TP_SHARE)
+	{
+		// TP.DT of a session between other ECUs
+		return (7UL << 26U) | ((uint32_t)J1939_DATA_TRANSFER << 16U) | (0x31UL << 8U) | 0x90U;
+	}
+
+	if(((PGN >> 8U) & 0xFFU) < 240U)
+	{
+		switch(n % 5U)
+		{
+			case 0U:  destination = ecuAddress;				break;
+			case 1U:  destination = J1939_BROADCAST_ADDRESS;	break;
+			default:  destination = 0x30U + (n % 8U);			break;
+		}
+
+		PGN |= destination;
+	}
+
+	return (priority << 26U) | (PGN << 8U) | benchmarkGetSourceAddress(n);
+}
+
+/**
+ * @brief 	This function is used to send the traffic over the virtual bus.
+ * @param	frames - The number of frames.
+ * @retval	The number of frames handled by the ECU.
+ */
+static uint32_t benchmarkSendTraffic(uint32_t frames)
+{
+	static const uint8_t data[8] = {0};
+
+	randomState		= 1U;
+	handledFrames	= 0U;
+
+	for(uint32_t i = 0U; i < frames; i++)
+	{
+		J1939_portSendFrame(trafficNode, benchmarkGetTrafficId(), data, 8U);
+
+		if((i % BENCHMARK_BUS_BATCH) == (BENCHMARK_BUS_BATCH - 1U)) J1939_hostProcessBus();
+	}
+
+	J1939_hostProcessBus();
+
+	return handledFrames;
+}
+
+/**
+ * @brief 	This function is used to run and report one benchmark case.
+ * @param	numberOfPGNs - The number of registered PGNs.
+ * @param	frames - The number of sent frames.
+ * @retval	0 if the filters haven't rejected handled frames, 1 otherwise.
+ */
+static int benchmarkRun(uint32_t numberOfPGNs, uint32_t frames)
+{
+	J1939_acceptanceFilter filters[J1939_MAX_FILTER_BANKS];
+	benchmarkMeasurement filtered, unfiltered;
+	uint32_t unfilteredFrames, filteredFrames;
+	uint8_t numberOfFilters = 0U;
+	double startTime, makeTime;
+
+	// The filters loaded on the registration and the address change are used first
+	benchmarkStartMeasurement(&filtered);
+	filteredFrames = benchmarkSendTraffic(frames);
+	benchmarkStopMeasurement(&filtered);
+
+	J1939_disableAcceptanceFilters(&ecu);
+	benchmarkStartMeasurement(&unfiltered);
+	unfilteredFrames = benchmarkSendTraffic(frames);
+	benchmarkStopMeasurement(&unfiltered);
+
+	J1939_enableAcceptanceFilters(&ecu);
+
+	startTime = benchmarkGetWallTime();
+	for(uint32_t i = 0U; i < BENCHMARK_MAKE_ITERATIONS; i++)
+	{
+		numberOfFilters = J1939_makeAcceptanceFilters(&ecu, filters, J1939_portGetFilterBanks(ecu.channel), ecuAddress);
+	}
+	makeTime = benchmarkGetWallTime() - startTime;
+
+	printf("%6u %#6x %6u %10llu %10.1f %12.0f %12.0f %10.2f %8u/%u\n",
+		   numberOfPGNs, ecuAddress, numberOfFilters,
+		   (unsigned long long)filtered.counters.filter_accepted_frames,
+		   (100.0 * (double)(frames - filtered.counters.filter_accepted_frames)) / (double)frames,
+		   ((double)unfiltered.counters.filter_accepted_frames * 1e6) / (double)filtered.bus_time,
+		   ((double)filtered.counters.filter_accepted_frames * 1e6) / (double)filtered.bus_time,
+		   (makeTime * 1e6) / BENCHMARK_MAKE_ITERATIONS,
+		   filteredFrames, unfilteredFrames);
+
+	return (filteredFrames == unfilteredFrames) ? 0 : 1;
+}
+
+/**
+ * @brief 	This function is used to make the filters of a CAN FD ECU with J1939_MAX_PGN_HANDLERS PDU1 PGNs
+ * 			sent by different ECUs to any address, each of them takes two filters besides the fixed ones.
+ * @retval	0 if every filter has been made and the loaded filters are intact, 1 otherwise.
+ */
+static int benchmarkRunWorstCase(void)
+{
+	static J1939_acceptanceFilter filters[J1939_FILTER_MAX_PATTERNS];
+	J1939_acceptanceFilter loadedFilters[J1939_MAX_FILTER_BANKS];
+	uint32_t expected = (J1939_MAX_PGN_HANDLERS * 2U) + J1939_FILTER_FIXED_PATTERNS;
+	uint8_t numberOfFilters;
+
+	benchmarkAddNode(&FDecu);
+	J1939_setCurrentECUAddress(&FDecu, BENCHMARK_FD_ECU_ADDRESS);
+	J1939_enableAcceptanceFilters(&FDecu);
+	J1939_setDataLink(&FDecu, J1939_DATA_LINK_FD);
+
+	for(uint32_t i = 0U; i < J1939_MAX_PGN_HANDLERS; i++)
+	{
+		J1939_registerPGNhandler(&FDecu, (0x80U + i) << 8U, (uint16_t)(0x80U + i), J1939_ANY_ADDRESS, benchmarkHandler, NULL);
+	}
+
+	// The filters being made mustn't run into the loaded ones
+	memcpy(loadedFilters, FDecu.filters.loaded_filters, sizeof(loadedFilters));
+	numberOfFilters = J1939_makeAcceptanceFilters(&FDecu, filters, J1939_FILTER_MAX_PATTERNS, BENCHMARK_FD_ECU_ADDRESS);
+
+	printf("\nCAN FD ECU with %u PDU1 PGNs: %u/%u filters\n", J1939_MAX_PGN_HANDLERS, numberOfFilters, expected);
+
+	return ((numberOfFilters == expected) && \
+			(memcmp(loadedFilters, FDecu.filters.loaded_filters, sizeof(loadedFilters)) == 0)) ? 0 : 1;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	static const uint32_t numbersOfPGNs[] = {0U, 4U, 8U, 16U, J1939_MAX_PGN_HANDLERS};
+	uint32_t frames = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_FRAMES;
+	uint32_t registeredPGNs = 0U;
+	int failures = 0;
+
+	if(frames == 0U) frames = BENCHMARK_DEFAULT_FRAMES;
+
+	J1939_hostInit(BENCHMARK_BITRATE);
+	benchmarkAddNode(&ecu);
+	trafficNode	= J1939_hostAddNode(NULL, NULL);
+
+	J1939_setCurrentECUAddress(&ecu, ecuAddress);
+	J1939_enableAcceptanceFilters(&ecu);
+
+	printf("SAE J1939-21 acceptance filter simulation, %u frames per case, virtual bus %u bit/s, %u filter banks\n",
+		   frames, BENCHMARK_BITRATE, J1939_portGetFilterBanks(ecu.channel));
+	printf("%6s %6s %6s %10s %10s %12s %12s %10s %10s\n",
+		   "PGNs", "SA", "banks", "ISR frames", "rejected %", "ISR/s off", "ISR/s on", "make us", "handled");
+
+	for(uint8_t i = 0U; i < (sizeof(numbersOfPGNs) / sizeof(numbersOfPGNs[0])); i++)
+	{
+		// Every fourth traffic message is registered, some of them with the source address filter
+		for(; registeredPGNs < numbersOfPGNs[i]; registeredPGNs++)
+		{
+			uint32_t n = registeredPGNs * 4U;
+			uint16_t sourceAddress = ((registeredPGNs % 4U) == 3U) ? benchmarkGetSourceAddress(n) : J1939_ANY_ADDRESS;
+
+			J1939_registerPGNhandler(&ecu, benchmarkGetPGN(n), sourceAddress, J1939_ANY_ADDRESS, benchmarkHandler, NULL);
+		}
+
+		failures += benchmarkRun(registeredPGNs, frames);
+	}
+
+	// The filters follow the new address, the traffic to the ECU is sent to it
+	ecuAddress = BENCHMARK_NEW_ECU_ADDRESS;
+	J1939_setCurrentECUAddress(&ecu, ecuAddress);
+	failures += benchmarkRun(registeredPGNs, frames);
+	failures += benchmarkRunWorstCase();
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
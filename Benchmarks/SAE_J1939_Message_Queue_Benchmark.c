@@ -0,0 +1,286 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Message_Queue_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Simulation of the queue of completed messages. Four ECUs send
+  * 		 BAMs and two ECUs RTS/CTS messages to a receiver over the virtual
+  * 		 CAN bus, the consumer task of the receiver runs every 50 ms. The
+  * 		 receiver holds one message at a time, as with the single pointer
+  * 		 of J1939_getReceivedMessage, and then queues the messages with
+  * 		 their buffers. The messages sent, consumed and dropped, the time
+  * 		 from the completion to the consumer and the buffers held are
+  * 		 reported, every consumed message is checked.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Port_Host.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_RECEIVER_ADDRESS				(0x20U)
+#define BENCHMARK_NUMBER_OF_BAM_SENDERS			(4U)
+#define BENCHMARK_NUMBER_OF_SENDERS				(6U)
+#define BENCHMARK_PGN							(0x00FF10UL)
+#define BENCHMARK_MAX_MESSAGE_SIZE				(60U)
+#define BENCHMARK_BAM_MIN_SIZE					(20U)
+#define BENCHMARK_RTS_PERIOD					(20U)		// ms
+#define BENCHMARK_CONSUMER_PERIOD				(50U)		// ms
+#define BENCHMARK_SETTLE_TIME					(1000U)		// ms
+#define BENCHMARK_DEFAULT_TIME					(60000U)	// ms
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A sending ECU.
+ */
+typedef struct
+{
+	J1939_instance instance;
+	uint8_t address;
+	uint8_t broadcast;						/* 1 - BAM, 0 - RTS/CTS to the receiver */
+	uint16_t sequence;						/* The number of the next message */
+	uint32_t next_time;						/* The time of the next message, ms */
+	uint8_t buffer[BENCHMARK_MAX_MESSAGE_SIZE];
+} benchmarkSender;
+
+/**
+ * @brief Results of a benchmark run.
+ */
+typedef struct
+{
+	uint32_t sent;							/* Sessions opened by the senders */
+	uint32_t consumed;						/* Messages taken by the consumer and verified */
+	uint32_t corrupted;						/* Messages taken with wrong data */
+	uint32_t dropped;						/* Messages dropped by the queue */
+	benchmarkLatency latency;				/* The times from the completion to the consumer of the messages taken, ms */
+} benchmarkResults;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static J1939_instance receiver;
+static benchmarkSender senders[BENCHMARK_NUMBER_OF_SENDERS] =
+{
+	{.address = 0x30U, .broadcast = 1U},
+	{.address = 0x31U, .broadcast = 1U},
+	{.address = 0x32U, .broadcast = 1U},
+	{.address = 0x33U, .broadcast = 1U},
+	{.address = 0x40U, .broadcast = 0U},
+	{.address = 0x41U, .broadcast = 0U}
+};
+static benchmarkResults results;
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to get the size of a message: the BAMs of 20 to 60 bytes, the RTS/CTS
+ * 			messages of 60 bytes.
+ * @param	sender - A pointer to the sender.
+ * @param	sequence - The number of the message.
+ * @retval	The message size.
+ */
+static uint16_t benchmarkGetMessageSize(const benchmarkSender* sender, uint16_t sequence)
+{
+	if(sender->broadcast == 0U) return BENCHMARK_MAX_MESSAGE_SIZE;
+
+	return (uint16_t)(BENCHMARK_BAM_MIN_SIZE + (((uint32_t)sequence * 7U + sender->address) % \
+												(BENCHMARK_MAX_MESSAGE_SIZE - BENCHMARK_BAM_MIN_SIZE + 1U)));
+}
+
+/**
+ * @brief 	This function is used to fill a message: the sender address, the sequence number and a pattern.
+ * @param	data - A pointer to the message.
+ * @param	size - The message size.
+ * @param	address - The sender address.
+ * @param	sequence - The number of the message.
+ * @retval	None.
+ */
+static void benchmarkFillMessage(uint8_t* data, uint16_t size, uint8_t address, uint16_t sequence)
+{
+	data[0] = address;
+	data[1] = (uint8_t)sequence;
+	data[2] = (uint8_t)(sequence >> 8U);
+
+	for(uint16_t i = 3U; i < size; i++) data[i] = (uint8_t)(sequence + i);
+}
+
+/**
+ * @brief 	This function is used to start the next message of a sender if the previous one has been sent.
+ * @param	sender - A pointer to the sender.
+ * @param	now - The current time, ms.
+ * @retval	None.
+ */
+static void benchmarkSendMessage(benchmarkSender* sender, uint32_t now)
+{
+	uint16_t size = benchmarkGetMessageSize(sender, sender->sequence);
+	J1939_TP_session* session;
+
+	if((now < sender->next_time) || (J1939_isTXdataInUse(&sender->instance, sender->buffer) == 1U)) return;
+
+	benchmarkFillMessage(sender->buffer, size, sender->address, sender->sequence);
+
+	session = J1939_fillTPstructures(&sender->instance, sender->buffer, size, BENCHMARK_PGN,
+									 (sender->broadcast != 0U) ? J1939_BROADCAST_ADDRESS : BENCHMARK_RECEIVER_ADDRESS);
+	if(session == NULL) return;
+
+	J1939_sendTP_connectionManagement(session, (sender->broadcast != 0U) ? J1939_TP_TYPE_BAM : J1939_TP_TYPE_RTS);
+
+	sender->sequence++;
+	sender->next_time = (sender->broadcast != 0U) ? now : now + BENCHMARK_RTS_PERIOD;
+	results.sent++;
+}
+
+/**
+ * @brief 	This function is the consumer task of the receiver: the queued messages are checked and released.
+ * @retval	None.
+ */
+static void benchmarkConsume(void)
+{
+	J1939_receivedMessage message;
+	uint8_t expected[BENCHMARK_MAX_MESSAGE_SIZE];
+
+	while(J1939_getQueuedMessage(&receiver, &message) == 1U)
+	{
+		uint16_t sequence = (uint16_t)(message.data[1] | ((uint16_t)message.data[2] << 8U));
+		benchmarkSender* sender = NULL;
+
+		for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_SENDERS; i++)
+		{
+			if(senders[i].address == message.source_address) sender = &senders[i];
+		}
+
+		if((sender != NULL) && (message.PGN == BENCHMARK_PGN) && (message.data[0] == message.source_address) && \
+		   (message.size == benchmarkGetMessageSize(sender, sequence)))
+		{
+			benchmarkFillMessage(expected, message.size, message.source_address, sequence);
+			(memcmp(message.data, expected, message.size) == 0) ? results.consumed++ : results.corrupted++;
+		} else
+		{
+			results.corrupted++;
+		}
+
+		benchmarkAddLatency(&results.latency, J1939_portGetTime() - message.time);
+
+		J1939_releaseMessage(&receiver, &message);
+	}
+}
+
+/**
+ * @brief 	This function is used to run and report one benchmark case.
+ * @param	mode - The name of the case.
+ * @param	depth - The depth of the message queue of the receiver.
+ * @param	time - The simulation time with the messages sent, ms.
+ * @retval	None.
+ */
+static void benchmarkRun(const char* mode, uint8_t depth, uint32_t time)
+{
+	J1939_messageQueueStatistics queueStatistics;
+	J1939_statistics statistics;
+	uint32_t nextConsumer = BENCHMARK_CONSUMER_PERIOD;
+	uint32_t sleepTime, now;
+
+	memset(&results, 0, sizeof(results));
+
+	J1939_hostInit(J1939_HOST_DEFAULT_BITRATE);
+	benchmarkAddNode(&receiver);
+	J1939_setCurrentECUAddress(&receiver, BENCHMARK_RECEIVER_ADDRESS);
+	J1939_enableMessageQueue(&receiver, depth);
+
+	for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_SENDERS; i++)
+	{
+		benchmarkSender* sender = &senders[i];
+
+		sender->sequence	= 0U;
+		sender->next_time	= i;
+		benchmarkAddNode(&sender->instance);
+		J1939_setCurrentECUAddress(&sender->instance, sender->address);
+	}
+
+	// The messages are sent for the given time, then the last ones are consumed
+	while((now = (uint32_t)(J1939_hostGetTime() / 1000U)) < time + BENCHMARK_SETTLE_TIME)
+	{
+		if(now >= nextConsumer)
+		{
+			benchmarkConsume();
+			nextConsumer += BENCHMARK_CONSUMER_PERIOD;
+		}
+
+		sleepTime = J1939_processTimers(&receiver);
+
+		for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_SENDERS; i++)
+		{
+			uint32_t senderSleepTime;
+
+			if(now < time) benchmarkSendMessage(&senders[i], now);
+
+			senderSleepTime = J1939_processTimers(&senders[i].instance);
+			J1939_sendTPpendingPackages(&senders[i].instance);
+
+			if(senderSleepTime < sleepTime) sleepTime = senderSleepTime;
+		}
+
+		J1939_sendTPpendingPackages(&receiver);
+
+		if((J1939_hostProcessBus() > 0U) || (sleepTime == 0U)) continue;
+
+		// The tasks sleep until the next deadline, at most 1 ms
+		if(sleepTime > 1U) sleepTime = 1U;
+		J1939_hostAdvanceTime(((uint64_t)sleepTime * 1000U) - (J1939_hostGetTime() % 1000U));
+	}
+
+	benchmarkConsume();
+
+	J1939_getMessageQueueStatistics(&receiver, &queueStatistics);
+	J1939_getStatistics(&receiver, &statistics);
+	results.dropped = queueStatistics.dropped;
+
+	printf("%-8s %6u %6u %9u %8u %9u %8.1f %7llu %8u %10u\n",
+		   mode, depth, results.sent, results.consumed, queueStatistics.dropped,
+		   statistics.sessions[J1939_STATISTICS_TP_BAM_RX].allocation_failures + \
+		   statistics.sessions[J1939_STATISTICS_TP_PTP_RX].allocation_failures,
+		   benchmarkGetAverageLatency(&results.latency),
+		   (unsigned long long)results.latency.max, queueStatistics.max_pending, statistics.max_buffer_bytes);
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	uint32_t time = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_TIME;
+	uint32_t singleConsumed;
+
+	if(time == 0U) time = BENCHMARK_DEFAULT_TIME;
+
+	printf("SAE J1939-21 completed message queue simulation, %u BAM and %u RTS/CTS senders, consumer every %u ms, "
+		   "%u ms, virtual bus %u bit/s\n", BENCHMARK_NUMBER_OF_BAM_SENDERS,
+		   BENCHMARK_NUMBER_OF_SENDERS - BENCHMARK_NUMBER_OF_BAM_SENDERS, BENCHMARK_CONSUMER_PERIOD, time,
+		   J1939_HOST_DEFAULT_BITRATE);
+	printf("%-8s %6s %6s %9s %8s %9s %8s %7s %8s %10s\n", "mode", "depth", "sent", "consumed", "dropped",
+		   "no buffer", "mean ms", "max ms", "held", "buffer B");
+
+	benchmarkRun("single", 1U, time);
+	singleConsumed = results.consumed;
+	benchmarkRun("queue", J1939_MESSAGE_QUEUE_SIZE, time);
+
+	// Every message sent must be consumed intact or counted as dropped, the queue must deliver more
+	return ((results.corrupted == 0U) && ((results.consumed + results.dropped) == results.sent) && \
+			(results.consumed > singleConsumed)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,399 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Request_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Simulation of the request responder. A gateway and two service
+  * 		 tools request the identification and the diagnostic PGNs of the
+  * 		 ECU every second over the virtual CAN bus, one tool repeats its
+  * 		 requests. The requests are answered by a handler of the Request
+  * 		 PGN which encodes every response, as the applications did, and
+  * 		 by the request responder. The encodings, the frames on the bus
+  * 		 and the time until the requesters get their responses are
+  * 		 reported.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Port_Host.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_ECU_ADDRESS					(0x10U)
+#define BENCHMARK_NUMBER_OF_TOOLS				(3U)
+#define BENCHMARK_NUMBER_OF_PGNS				(6U)
+#define BENCHMARK_MAX_RESPONSE					(64U)
+#define BENCHMARK_ROUND_PERIOD					(1000U)		// ms
+#define BENCHMARK_REPEAT_DELAY					(3U)		// ms
+#define BENCHMARK_CHANGE_PERIOD					(500U)		// ms
+#define BENCHMARK_REQUEST_PGN					(0x00EA00UL)
+#define BENCHMARK_DEFAULT_TIME					(10000U)	// ms
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A PGN of the ECU answered to the requests.
+ */
+typedef struct
+{
+	uint32_t PGN;
+	uint8_t changing;						/* 1 - the data changes every BENCHMARK_CHANGE_PERIOD */
+	uint8_t buffer[BENCHMARK_MAX_RESPONSE];	/* The encoded response */
+	uint16_t size;							/* The size of the last encoded response */
+} benchmarkPGN;
+
+/**
+ * @brief A requester.
+ */
+typedef struct
+{
+	J1939_instance instance;
+	uint8_t address;
+	uint8_t global;							/* 1 - the requests are sent to all ECUs */
+	uint8_t repeats;						/* 1 - every request is sent twice */
+	uint8_t requested;						/* The mask of the PGNs requested */
+	uint8_t waiting[BENCHMARK_NUMBER_OF_PGNS];			/* 1 - the response is waited */
+	uint64_t request_times[BENCHMARK_NUMBER_OF_PGNS];	/* The time of the first waiting request, us */
+} benchmarkTool;
+
+/**
+ * @brief Results of a benchmark run.
+ */
+typedef struct
+{
+	uint32_t requests;						/* Requests sent by the tools */
+	uint32_t unanswered;					/* Requests not answered until the next round */
+	benchmarkLatency latency;				/* The times from the request to the response of the requests answered, us */
+	uint32_t encodings;						/* Responses encoded */
+	uint64_t encoding_time;					/* Time spent encoding, ns */
+	uint32_t wrong_size;					/* Responses of a wrong size */
+} benchmarkResults;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static benchmarkPGN PGNs[BENCHMARK_NUMBER_OF_PGNS] =
+{
+	{0x00FEEBUL, 0U, {0}, 0U},				// Component identification
+	{0x00FEDAUL, 0U, {0}, 0U},				// Software identification
+	{0x00FDC5UL, 0U, {0}, 0U},				// ECU identification
+	{0x00FEECUL, 0U, {0}, 0U},				// Vehicle identification
+	{0x00FEE5UL, 1U, {0}, 0U},				// Engine hours
+	{0x00FECAUL, 1U, {0}, 0U}				// DM1
+};
+
+static J1939_instance ecu;
+static benchmarkTool tools[BENCHMARK_NUMBER_OF_TOOLS] =
+{
+	{.address = 0x31U, .global = 1U, .repeats = 0U, .requested = 0x38U},	// Gateway, the VIN and the single frame PGNs
+	{.address = 0xF9U, .global = 0U, .repeats = 0U, .requested = 0x3FU},	// Service tool
+	{.address = 0xFAU, .global = 0U, .repeats = 1U, .requested = 0x3FU}	// Service tool repeating the requests
+};
+static benchmarkResults results;
+static uint32_t engineHours = 123456U;
+static uint8_t activeFaults = 0U;
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is the provider of the ECU: the response is encoded from the application data.
+ * @retval	The response size.
+ */
+static uint16_t benchmarkEncode(void* context, uint32_t PGN, uint8_t* data, uint16_t maxSize)
+{
+	benchmarkPGN* requestedPGN = (benchmarkPGN*)context;
+	uint64_t startTime = benchmarkGetNanoseconds();
+	char text[BENCHMARK_MAX_RESPONSE + 1U];
+	int size = 0;
+
+	switch(PGN)
+	{
+		case 0x00FEEBUL: size = snprintf(text, sizeof(text), "%s*%s*%s*%s*", "ACME", "ECU-4000", "SN0012345678", "U1"); break;
+		case 0x00FEDAUL: size = snprintf(text, sizeof(text), "%u*%s %u.%u.%u*%s %u.%u*", 2U, "APP", 3U, 14U, 159U, "BOOT", 1U, 2U); break;
+		case 0x00FDC5UL: size = snprintf(text, sizeof(text), "%s*%s*%s*%s*%s*", "PN-77001", "SN0012345678", "CAB", "ACME", "HW-B"); break;
+		case 0x00FEECUL: size = snprintf(text, sizeof(text), "%s*", "1FUJGLDR5CLBP8834"); break;
+		case 0x00FEE5UL:
+			size = 8;
+			text[0] = (char)engineHours;
+			text[1] = (char)(engineHours >> 8U);
+			text[2] = (char)(engineHours >> 16U);
+			text[3] = (char)(engineHours >> 24U);
+			memset(&text[4], 0xFF, 4U);
+			break;
+		case 0x00FECAUL:
+			size = 8;
+			text[0] = (activeFaults != 0U) ? 0x04 : 0x00;		// Amber warning lamp
+			text[1] = (char)0xFF;
+			text[2] = 0x64;									// SPN 100
+			text[3] = 0x00;
+			text[4] = (activeFaults != 0U) ? 0x01 : 0x00;		// FMI 1
+			text[5] = 0x01;
+			memset(&text[6], 0xFF, 2U);
+			break;
+		default: break;
+	}
+
+	if((size <= 0) || (size > (int)maxSize)) size = 0;
+
+	memcpy(data, text, (size_t)size);
+	requestedPGN->size = (uint16_t)size;
+
+	results.encodings++;
+	results.encoding_time += benchmarkGetNanoseconds() - startTime;
+
+	return (uint16_t)size;
+}
+
+/**
+ * @brief 	This function is the handler of the Request PGN of the ECU without the responder: every request
+ * 			is answered at once with a response encoded again. A response which can't be sent is lost.
+ * @retval	None.
+ */
+static void benchmarkApplicationRequestHandler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+											   const uint8_t* data, uint16_t size)
+{
+	uint32_t requestedPGN = ((uint32_t)data[2] << 16U) | ((uint32_t)data[1] << 8U) | data[0];
+	J1939_TP_session* session;
+
+	(void)context;
+	(void)PGN;
+
+	if(size < 3U) return;
+
+	for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_PGNS; i++)
+	{
+		benchmarkPGN* responsePGN = &PGNs[i];
+
+		if(responsePGN->PGN != requestedPGN) continue;
+
+		// The buffer of a response being sent can't be encoded again
+		if(J1939_isTXdataInUse(&ecu, responsePGN->buffer) == 1U) return;
+
+		benchmarkEncode(responsePGN, responsePGN->PGN, responsePGN->buffer, BENCHMARK_MAX_RESPONSE);
+
+		if(responsePGN->size <= 8U)
+		{
+			J1939_sendFrame(&ecu, (6UL << 26U) | (responsePGN->PGN << 8U) | BENCHMARK_ECU_ADDRESS, responsePGN->buffer, (uint8_t)responsePGN->size);
+			return;
+		}
+
+		session = J1939_fillTPstructures(&ecu, responsePGN->buffer, responsePGN->size, responsePGN->PGN, \
+										 (destinationAddress == J1939_BROADCAST_ADDRESS) ? J1939_BROADCAST_ADDRESS : sourceAddress);
+		if(session != NULL) J1939_sendTP_connectionManagement(session, (destinationAddress == J1939_BROADCAST_ADDRESS) ? \
+																		   J1939_TP_TYPE_BAM : J1939_TP_TYPE_RTS);
+		return;
+	}
+}
+
+/**
+ * @brief 	This function is the handler of the responses of a tool: the waiting request is answered.
+ * @retval	None.
+ */
+static void benchmarkResponseHandler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+									 const uint8_t* data, uint16_t size)
+{
+	benchmarkTool* tool = (benchmarkTool*)context;
+
+	(void)destinationAddress;
+	(void)data;
+
+	if(sourceAddress != BENCHMARK_ECU_ADDRESS) return;
+
+	for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_PGNS; i++)
+	{
+		if((PGNs[i].PGN != PGN) || (tool->waiting[i] == 0U)) continue;
+
+		if(size != PGNs[i].size) results.wrong_size++;
+
+		benchmarkAddLatency(&results.latency, J1939_hostGetTime() - tool->request_times[i]);
+
+		tool->waiting[i] = 0U;
+	}
+}
+
+/**
+ * @brief 	This function is used to send the requests of a tool for all PGNs.
+ * @param	tool - A pointer to the tool.
+ * @param	repeated - 1 - the requests are repeated, the first ones are still waited.
+ * @retval	None.
+ */
+static void benchmarkSendRequests(benchmarkTool* tool, uint8_t repeated)
+{
+	uint8_t destinationAddress = (tool->global != 0U) ? J1939_BROADCAST_ADDRESS : BENCHMARK_ECU_ADDRESS;
+	uint32_t canId = (6UL << 26U) | (BENCHMARK_REQUEST_PGN << 8U) | ((uint32_t)destinationAddress << 8U) | tool->address;
+
+	for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_PGNS; i++)
+	{
+		uint8_t data[3] = {(uint8_t)PGNs[i].PGN, (uint8_t)(PGNs[i].PGN >> 8U), (uint8_t)(PGNs[i].PGN >> 16U)};
+
+		if((tool->requested & (1U << i)) == 0U) continue;
+
+		J1939_sendFrame(&tool->instance, canId, data, sizeof(data));
+		results.requests++;
+
+		if(repeated != 0U) continue;
+
+		if(tool->waiting[i] != 0U) results.unanswered++;
+
+		tool->waiting[i]		= 1U;
+		tool->request_times[i]	= J1939_hostGetTime();
+	}
+}
+
+/**
+ * @brief 	This function is used to run and report one benchmark case.
+ * @param	mode - The name of the case.
+ * @param	responder - 1 - the requests are answered by the responder, 0 - by the application handler.
+ * @param	time - The simulation time, ms.
+ * @retval	The number of frames on the bus. 0 if a request is unanswered or a response is wrong.
+ */
+static uint64_t benchmarkRun(const char* mode, uint8_t responder, uint32_t time)
+{
+	J1939_hostCounters counters;
+	J1939_requestStatistics statistics;
+	uint32_t nextRound = 0U, nextRepeat = BENCHMARK_REPEAT_DELAY, nextChange = BENCHMARK_CHANGE_PERIOD;
+	uint32_t sleepTime, now;
+
+	memset(&results, 0, sizeof(results));
+
+	J1939_hostInit(J1939_HOST_DEFAULT_BITRATE);
+	benchmarkAddNode(&ecu);
+	J1939_setCurrentECUAddress(&ecu, BENCHMARK_ECU_ADDRESS);
+
+	for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_TOOLS; i++)
+	{
+		benchmarkTool* tool = &tools[i];
+
+		memset(tool->waiting, 0, sizeof(tool->waiting));
+		benchmarkAddNode(&tool->instance);
+		J1939_setCurrentECUAddress(&tool->instance, tool->address);
+
+		for(uint8_t j = 0U; j < BENCHMARK_NUMBER_OF_PGNS; j++)
+		{
+			J1939_registerPGNhandler(&tool->instance, PGNs[j].PGN, BENCHMARK_ECU_ADDRESS, J1939_ANY_ADDRESS, benchmarkResponseHandler, tool);
+		}
+	}
+
+	for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_PGNS; i++)
+	{
+		if(responder != 0U)
+		{
+			J1939_registerRequestedPGN(&ecu, PGNs[i].PGN, 6U, benchmarkEncode, &PGNs[i]);
+			J1939_setResponseBuffer(&ecu, PGNs[i].PGN, PGNs[i].buffer, BENCHMARK_MAX_RESPONSE);
+		}
+	}
+
+	if(responder == 0U) J1939_registerPGNhandler(&ecu, BENCHMARK_REQUEST_PGN, J1939_ANY_ADDRESS, J1939_ANY_ADDRESS,
+												 benchmarkApplicationRequestHandler, NULL);
+
+	// The requests are sent for the given time, the last responses are waited one more round
+	while((now = (uint32_t)(J1939_hostGetTime() / 1000U)) < time + BENCHMARK_ROUND_PERIOD)
+	{
+		if((now >= nextRound) && (now < time))
+		{
+			for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_TOOLS; i++) benchmarkSendRequests(&tools[i], 0U);
+			nextRepeat	= now + BENCHMARK_REPEAT_DELAY;
+			nextRound	+= BENCHMARK_ROUND_PERIOD;
+		}
+
+		if((nextRepeat != 0U) && (now >= nextRepeat))
+		{
+			for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_TOOLS; i++)
+			{
+				if(tools[i].repeats != 0U) benchmarkSendRequests(&tools[i], 1U);
+			}
+			nextRepeat = 0U;
+		}
+
+		// The engine hours and the faults change, their responses are encoded again
+		if(now >= nextChange)
+		{
+			engineHours++;
+			activeFaults ^= 1U;
+			nextChange += BENCHMARK_CHANGE_PERIOD;
+
+			for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_PGNS; i++)
+			{
+				if(PGNs[i].changing != 0U) J1939_markResponseDirty(&ecu, PGNs[i].PGN);
+			}
+		}
+
+		sleepTime = J1939_processTimers(&ecu);
+		for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_TOOLS; i++)
+		{
+			uint32_t toolSleepTime = J1939_processTimers(&tools[i].instance);
+
+			if(toolSleepTime < sleepTime) sleepTime = toolSleepTime;
+		}
+
+		if((J1939_hostProcessBus() > 0U) || (sleepTime == 0U)) continue;
+
+		// The task sleeps until the next deadline or the next event of the tools, at most 1 ms
+		if(sleepTime > 1U) sleepTime = 1U;
+		J1939_hostAdvanceTime(((uint64_t)sleepTime * 1000U) - (J1939_hostGetTime() % 1000U));
+	}
+
+	for(uint8_t i = 0U; i < BENCHMARK_NUMBER_OF_TOOLS; i++)
+	{
+		for(uint8_t j = 0U; j < BENCHMARK_NUMBER_OF_PGNS; j++) results.unanswered += tools[i].waiting[j];
+	}
+
+	J1939_hostGetCounters(&counters);
+
+	printf("%-10s %8u %8u %10u %9.2f %9.2f %9u %11.2f %10llu\n",
+		   mode, results.requests, results.latency.samples, results.unanswered,
+		   benchmarkGetAverageLatency(&results.latency) / 1000.0,
+		   (double)results.latency.max / 1000.0, results.encodings,
+		   (double)results.encoding_time / 1000.0, (unsigned long long)counters.frames);
+
+	if(responder != 0U)
+	{
+		J1939_getRequestStatistics(&ecu, &statistics);
+		printf("  responder: %u requests, %u coalesced, %u responses, %u encodings, %u cache hits, %u deferred\n",
+			   statistics.requests, statistics.coalesced, statistics.responses, statistics.encodings,
+			   statistics.cache_hits, statistics.deferred);
+	}
+
+	if((results.unanswered > 0U) || (results.wrong_size > 0U)) return 0U;
+
+	return counters.frames;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	uint32_t time = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_TIME;
+	uint32_t applicationEncodings;
+	uint64_t responderFrames;
+
+	if(time == 0U) time = BENCHMARK_DEFAULT_TIME;
+
+	printf("SAE J1939-21 request responder simulation, %u requesters, %u PGNs, %u ms, virtual bus %u bit/s\n",
+		   BENCHMARK_NUMBER_OF_TOOLS, BENCHMARK_NUMBER_OF_PGNS, time, J1939_HOST_DEFAULT_BITRATE);
+	printf("%-10s %8s %8s %10s %9s %9s %9s %11s %10s\n", "mode", "requests", "answered", "unanswered",
+		   "mean ms", "max ms", "encodings", "encode us", "bus frames");
+
+	benchmarkRun("handler", 0U, time);
+	applicationEncodings = results.encodings;
+	responderFrames = benchmarkRun("responder", 1U, time);
+
+	// The responder must answer every request with fewer encodings
+	return ((responderFrames != 0U) && (results.encodings < applicationEncodings)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,352 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Signal_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Benchmark of the SAE J1939-71 signal decoder and encoder. The
+  * 		 signals/s of the extraction plans are compared with the
+  * 		 extraction of every SPN on its own, as the applications did by
+  * 		 hand, for EEC1, ET1, CCVS and a long proprietary message. The
+  * 		 values of both are checked against each other and the encoded
+  * 		 payloads are decoded back.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_71_Signals.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_DEFAULT_SIGNALS				(50000000U)
+#define BENCHMARK_PAYLOADS						(64U)
+#define BENCHMARK_LONG_PGN						(0x00FF30UL)
+#define BENCHMARK_LONG_SIGNALS					(96U)
+#define BENCHMARK_LONG_SIZE						(142U)		// 8 times the 142 bits of the lengths
+#define BENCHMARK_MAX_SIGNALS					(BENCHMARK_LONG_SIGNALS)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A benchmark PGN with its signals.
+ */
+typedef struct
+{
+	const char* name;
+	uint32_t PGN;
+	const J1939_signalDefinition* definitions;
+	uint8_t number_of_signals;
+	uint16_t size;
+} benchmarkPGN;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+
+// Electronic engine controller 1
+static const J1939_signalDefinition EEC1[] =
+{
+	{899U,	J1939_SIGNAL_POSITION(1U, 1U),	4U,		J1939_SIGNAL_NO_VALIDITY,	1.0f,		0.0f},
+	{4154U,	J1939_SIGNAL_POSITION(1U, 5U),	4U,		0U,							0.125f,		0.0f},
+	{512U,	J1939_SIGNAL_POSITION(2U, 1U),	8U,		0U,							1.0f,		-125.0f},
+	{513U,	J1939_SIGNAL_POSITION(3U, 1U),	8U,		0U,							1.0f,		-125.0f},
+	{190U,	J1939_SIGNAL_POSITION(4U, 1U),	16U,	0U,							0.125f,		0.0f},
+	{1483U,	J1939_SIGNAL_POSITION(6U, 1U),	8U,		J1939_SIGNAL_NO_VALIDITY,	1.0f,		0.0f},
+	{1675U,	J1939_SIGNAL_POSITION(7U, 1U),	4U,		0U,							1.0f,		0.0f},
+	{2432U,	J1939_SIGNAL_POSITION(8U, 1U),	8U,		0U,							1.0f,		-125.0f},
+};
+
+// Engine temperature 1
+static const J1939_signalDefinition ET1[] =
+{
+	{110U,	J1939_SIGNAL_POSITION(1U, 1U),	8U,		0U,							1.0f,		-40.0f},
+	{174U,	J1939_SIGNAL_POSITION(2U, 1U),	8U,		0U,							1.0f,		-40.0f},
+	{175U,	J1939_SIGNAL_POSITION(3U, 1U),	16U,	0U,							0.03125f,	-273.0f},
+	{176U,	J1939_SIGNAL_POSITION(5U, 1U),	16U,	0U,							0.03125f,	-273.0f},
+	{52U,	J1939_SIGNAL_POSITION(7U, 1U),	8U,		0U,							1.0f,		-40.0f},
+	{1134U,	J1939_SIGNAL_POSITION(8U, 1U),	8U,		0U,							0.4f,		0.0f},
+};
+
+// Cruise control/vehicle speed 1
+static const J1939_signalDefinition CCVS1[] =
+{
+	{69U,	J1939_SIGNAL_POSITION(1U, 1U),	2U,		0U,							1.0f,		0.0f},
+	{70U,	J1939_SIGNAL_POSITION(1U, 3U),	2U,		0U,							1.0f,		0.0f},
+	{1633U,	J1939_SIGNAL_POSITION(1U, 5U),	2U,		0U,							1.0f,		0.0f},
+	{3807U,	J1939_SIGNAL_POSITION(1U, 7U),	2U,		0U,							1.0f,		0.0f},
+	{84U,	J1939_SIGNAL_POSITION(2U, 1U),	16U,	0U,							0.00390625f, 0.0f},
+	{595U,	J1939_SIGNAL_POSITION(4U, 1U),	2U,		0U,							1.0f,		0.0f},
+	{596U,	J1939_SIGNAL_POSITION(4U, 3U),	2U,		0U,							1.0f,		0.0f},
+	{597U,	J1939_SIGNAL_POSITION(4U, 5U),	2U,		0U,							1.0f,		0.0f},
+	{598U,	J1939_SIGNAL_POSITION(4U, 7U),	2U,		0U,							1.0f,		0.0f},
+	{599U,	J1939_SIGNAL_POSITION(5U, 1U),	2U,		0U,							1.0f,		0.0f},
+	{600U,	J1939_SIGNAL_POSITION(5U, 3U),	2U,		0U,							1.0f,		0.0f},
+	{601U,	J1939_SIGNAL_POSITION(5U, 5U),	2U,		0U,							1.0f,		0.0f},
+	{602U,	J1939_SIGNAL_POSITION(5U, 7U),	2U,		0U,							1.0f,		0.0f},
+	{86U,	J1939_SIGNAL_POSITION(6U, 1U),	8U,		0U,							1.0f,		0.0f},
+	{976U,	J1939_SIGNAL_POSITION(7U, 1U),	5U,		0U,							1.0f,		0.0f},
+	{527U,	J1939_SIGNAL_POSITION(7U, 6U),	3U,		0U,							1.0f,		0.0f},
+	{968U,	J1939_SIGNAL_POSITION(8U, 1U),	2U,		0U,							1.0f,		0.0f},
+	{967U,	J1939_SIGNAL_POSITION(8U, 3U),	2U,		0U,							1.0f,		0.0f},
+	{966U,	J1939_SIGNAL_POSITION(8U, 5U),	2U,		0U,							1.0f,		0.0f},
+	{1237U,	J1939_SIGNAL_POSITION(8U, 7U),	2U,		0U,							1.0f,		0.0f},
+};
+
+// A long proprietary message received by TP, made by benchmarkMakeLongPGN
+static J1939_signalDefinition longPGN[BENCHMARK_LONG_SIGNALS];
+
+static benchmarkPGN PGNs[] =
+{
+	{"EEC1",	0x00F004UL,			EEC1,		sizeof(EEC1) / sizeof(EEC1[0]),		8U},
+	{"ET1",		0x00FEEEUL,			ET1,		sizeof(ET1) / sizeof(ET1[0]),		8U},
+	{"CCVS1",	0x00FEF1UL,			CCVS1,		sizeof(CCVS1) / sizeof(CCVS1[0]),	8U},
+	{"long",	BENCHMARK_LONG_PGN,	longPGN,	BENCHMARK_LONG_SIGNALS,				BENCHMARK_LONG_SIZE},
+};
+
+static uint8_t payloads[BENCHMARK_PAYLOADS][BENCHMARK_LONG_SIZE];
+static J1939_compiledSignal compiledSignals[BENCHMARK_MAX_SIGNALS];
+static J1939_signalValue planValues[BENCHMARK_MAX_SIGNALS];
+static J1939_signalValue naiveValues[BENCHMARK_MAX_SIGNALS];
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to make the signals of the long PGN: bit fields, bytes, words and
+ * 			double words one after another, in the order of the SPNs and not of the positions.
+ * @retval	None.
+ */
+static void benchmarkMakeLongPGN(void)
+{
+	static const uint8_t lengths[] = {2U, 8U, 16U, 4U, 12U, 32U, 8U, 2U, 24U, 10U, 16U, 8U};
+	uint16_t startBit = 0U;
+
+	for(uint8_t i = 0U; i < BENCHMARK_LONG_SIGNALS; i++)
+	{
+		uint8_t slot = (uint8_t)((i * 37U) % BENCHMARK_LONG_SIGNALS);
+
+		longPGN[slot].SPN		= 520000U + slot;
+		longPGN[slot].start_bit	= startBit;
+		longPGN[slot].length	= lengths[i % sizeof(lengths)];
+		longPGN[slot].flags		= 0U;
+		longPGN[slot].scale		= (i & 1U) ? 0.5f : 0.05f;
+		longPGN[slot].offset	= (i & 2U) ? -100.0f : 0.0f;
+
+		startBit += longPGN[slot].length;
+	}
+}
+
+/**
+ * @brief 	This function is used to extract one SPN from the payload byte by byte, as an application
+ * 			does for every SPN with hand-written shifts.
+ * @param	definition - A pointer to the definition of the SPN.
+ * @param	data - A pointer to the payload.
+ * @param	size - The payload size.
+ * @param	value - A pointer to store the value.
+ * @retval	1 if the value is valid, 0 otherwise.
+ */
+static uint8_t benchmarkExtractSPN(const J1939_signalDefinition* definition, const uint8_t* data, uint16_t size,
+								   J1939_signalValue* value)
+{
+	uint16_t firstByte = definition->start_bit / 8U;
+	uint16_t lastByte = (definition->start_bit + definition->length - 1U) / 8U;
+	uint32_t mask = (definition->length == 32U) ? 0xFFFFFFFFUL : ((1UL << definition->length) - 1U);
+	uint64_t bits = 0U;
+	uint32_t raw, top;
+
+	if(lastByte >= size)
+	{
+		value->value	= 0.0f;
+		value->raw		= 0U;
+		value->status	= J1939_SIGNAL_MISSING;
+		return 0U;
+	}
+
+	for(uint16_t byte = lastByte + 1U; byte > firstByte; byte--) bits = (bits << 8U) | data[byte - 1U];
+
+	raw = (uint32_t)(bits >> (definition->start_bit % 8U)) & mask;
+	value->raw		= raw;
+	value->value	= ((float)raw * definition->scale) + definition->offset;
+	value->status	= J1939_SIGNAL_VALID;
+
+	if((definition->length == 1U) || ((definition->flags & J1939_SIGNAL_NO_VALIDITY) != 0U)) return 1U;
+
+	if(definition->length >= 8U)
+	{
+		top = raw >> (definition->length - 8U);
+		if(top == 0xFFU) value->status = J1939_SIGNAL_NOT_AVAILABLE;
+		else if(top == 0xFEU) value->status = J1939_SIGNAL_ERROR;
+		else if(top > 0xFAU) value->status = J1939_SIGNAL_RESERVED;
+	} else
+	{
+		if(raw == mask) value->status = J1939_SIGNAL_NOT_AVAILABLE;
+		else if(raw == (mask - 1U)) value->status = J1939_SIGNAL_ERROR;
+	}
+
+	return (value->status == J1939_SIGNAL_VALID) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is used to compare the values of the plan with the values extracted by SPN.
+ * @param	numberOfSignals - The number of signals.
+ * @retval	1 - the values are the same, 0 - aren't.
+ */
+static uint8_t benchmarkCompareValues(uint8_t numberOfSignals)
+{
+	for(uint8_t i = 0U; i < numberOfSignals; i++)
+	{
+		if((planValues[i].raw != naiveValues[i].raw) || (planValues[i].status != naiveValues[i].status) || \
+		   (planValues[i].value != naiveValues[i].value)) return 0U;
+	}
+
+	return 1U;
+}
+
+/**
+ * @brief 	This function is used to compare the decoded values with the values encoded into the payload.
+ * 			A float keeps 24 bits, so the values of longer signals may differ by the rounding of the float.
+ * @param	definitions - A pointer to the signal definitions.
+ * @param	numberOfSignals - The number of signals.
+ * @retval	1 - the values are the same, 0 - aren't.
+ */
+static uint8_t benchmarkCompareRoundTrip(const J1939_signalDefinition* definitions, uint8_t numberOfSignals)
+{
+	for(uint8_t i = 0U; i < numberOfSignals; i++)
+	{
+		float difference = planValues[i].value - naiveValues[i].value;
+		float magnitude = (planValues[i].value < 0.0f) ? -planValues[i].value : planValues[i].value;
+
+		if(difference < 0.0f) difference = -difference;
+
+		if((planValues[i].status != naiveValues[i].status) || \
+		   (difference > ((magnitude / 4194304.0f) + (definitions[i].scale / 2.0f)))) return 0U;
+	}
+
+	return 1U;
+}
+
+/**
+ * @brief 	This function is used to run and report the benchmark of a PGN.
+ * @param	PGN - A pointer to the PGN.
+ * @param	signals - The number of signals to decode by each method.
+ * @retval	1 if the checks have passed, 0 otherwise.
+ */
+static uint8_t benchmarkRun(const benchmarkPGN* PGN, uint32_t signals)
+{
+	uint32_t payloadsPerRun = signals / PGN->number_of_signals;
+	double startTime, planTime, naiveTime, encodeTime;
+	volatile uint32_t planValid = 0U, naiveValid = 0U;
+	J1939_signalPlan plan;
+	uint8_t passed = 1U;
+
+	if(J1939_compileSignalPlan(&plan, PGN->PGN, PGN->definitions, compiledSignals, PGN->number_of_signals) != J1939_SIGNALS_OK) return 0U;
+	if(plan.size != PGN->size) passed = 0U;
+
+	// The payloads are encoded from random values, a few of them not available or erroneous
+	for(uint32_t i = 0U; i < BENCHMARK_PAYLOADS; i++)
+	{
+		for(uint8_t j = 0U; j < PGN->number_of_signals; j++)
+		{
+			const J1939_signalDefinition* definition = &PGN->definitions[j];
+			uint32_t range = (definition->length >= 8U) ? (0xFBUL << (definition->length - 8U)) : (1UL << definition->length);
+
+			planValues[j].raw		= (uint32_t)rand() % range;
+			planValues[j].value		= ((float)planValues[j].raw * definition->scale) + definition->offset;
+			planValues[j].status	= ((rand() % 16) == 0) ? J1939_SIGNAL_NOT_AVAILABLE : ((rand() % 16) == 0) ? J1939_SIGNAL_ERROR : \
+									  J1939_SIGNAL_VALID;
+		}
+
+		J1939_encodeSignals(&plan, planValues, payloads[i], PGN->size);
+	}
+
+	// Both methods agree on every payload, and decoding an encoded payload gives the encoded values
+	for(uint32_t i = 0U; i < BENCHMARK_PAYLOADS; i++)
+	{
+		J1939_decodeSignals(&plan, payloads[i], PGN->size, planValues);
+		for(uint8_t j = 0U; j < PGN->number_of_signals; j++) benchmarkExtractSPN(&PGN->definitions[j], payloads[i], PGN->size, &naiveValues[j]);
+		passed &= benchmarkCompareValues(PGN->number_of_signals);
+
+		J1939_encodeSignals(&plan, planValues, payloads[BENCHMARK_PAYLOADS - 1U], PGN->size);
+		J1939_decodeSignals(&plan, payloads[BENCHMARK_PAYLOADS - 1U], PGN->size, naiveValues);
+		passed &= benchmarkCompareRoundTrip(PGN->definitions, PGN->number_of_signals);
+		J1939_encodeSignals(&plan, planValues, payloads[i], PGN->size);
+	}
+
+	// A short payload leaves the signals beyond it missing
+	J1939_decodeSignals(&plan, payloads[0], (uint16_t)(PGN->size - 1U), planValues);
+	for(uint8_t j = 0U; j < PGN->number_of_signals; j++) benchmarkExtractSPN(&PGN->definitions[j], payloads[0], PGN->size - 1U, &naiveValues[j]);
+	passed &= benchmarkCompareValues(PGN->number_of_signals);
+
+	startTime = benchmarkGetWallTime();
+	for(uint32_t i = 0U; i < payloadsPerRun; i++)
+	{
+		planValid += J1939_decodeSignals(&plan, payloads[i & (BENCHMARK_PAYLOADS - 1U)], PGN->size, planValues);
+	}
+	planTime = benchmarkGetWallTime() - startTime;
+
+	startTime = benchmarkGetWallTime();
+	for(uint32_t i = 0U; i < payloadsPerRun; i++)
+	{
+		const uint8_t* payload = payloads[i & (BENCHMARK_PAYLOADS - 1U)];
+
+		for(uint8_t j = 0U; j < PGN->number_of_signals; j++) naiveValid += benchmarkExtractSPN(&PGN->definitions[j], payload, PGN->size, &naiveValues[j]);
+	}
+	naiveTime = benchmarkGetWallTime() - startTime;
+
+	startTime = benchmarkGetWallTime();
+	for(uint32_t i = 0U; i < payloadsPerRun; i++)
+	{
+		J1939_encodeSignals(&plan, planValues, payloads[i & (BENCHMARK_PAYLOADS - 1U)], PGN->size);
+	}
+	encodeTime = benchmarkGetWallTime() - startTime;
+
+	passed &= (planValid == naiveValid);
+
+	printf("%-6s %5u %7u %14.1f %14.1f %8.2f %14.1f %s\n", PGN->name, PGN->size, PGN->number_of_signals,
+		   (payloadsPerRun * PGN->number_of_signals) / planTime / 1e6, (payloadsPerRun * PGN->number_of_signals) / naiveTime / 1e6,
+		   naiveTime / planTime, (payloadsPerRun * PGN->number_of_signals) / encodeTime / 1e6, (passed == 1U) ? "ok" : "FAILED");
+
+	return passed;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	uint32_t signals = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_SIGNALS;
+	J1939_signalDefinition wrong = {1U, 0U, 33U, 0U, 1.0f, 0.0f};
+	J1939_signalPlan plan;
+	uint8_t passed = 1U;
+
+	if(signals == 0U) signals = BENCHMARK_DEFAULT_SIGNALS;
+
+	srand(1939U);
+	benchmarkMakeLongPGN();
+
+	printf("SAE J1939-71 signal benchmark, %u signals per case\n", signals);
+	printf("%-6s %5s %7s %14s %14s %8s %14s\n", "PGN", "bytes", "signals", "plan Msig/s", "by SPN Msig/s", "speedup", "encode Msig/s");
+
+	for(uint8_t i = 0U; i < (sizeof(PGNs) / sizeof(PGNs[0])); i++) passed &= benchmarkRun(&PGNs[i], signals);
+
+	// Wrong definitions are refused
+	passed &= (J1939_compileSignalPlan(&plan, 0U, &wrong, compiledSignals, 1U) == J1939_SIGNALS_INVALID);
+	wrong.length	= 8U;
+	wrong.scale		= 0.0f;
+	passed &= (J1939_compileSignalPlan(&plan, 0U, &wrong, compiledSignals, 1U) == J1939_SIGNALS_INVALID);
+
+	printf("%s\n", (passed == 1U) ? "PASSED" : "FAILED");
+
+	return (passed == 1U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,352 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_SocketCAN_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Benchmark of the SocketCAN port. A sender ECU streams single
+  * 		 frames of 16 PGNs to a receiver ECU which handles 8 of them behind
+  * 		 its acceptance filters, then sends 1785-byte RTS/CTS messages.
+  * 		 The frames are read and written one per system call and in
+  * 		 batches. The frames per second, the time and the system calls
+  * 		 per frame and the age of the frames from the kernel timestamp to
+  * 		 the dispatcher are reported, every frame and message is checked.
+  * 		 The ECUs share a socketpair which stands in for the CAN bus or
+  * 		 two CAN_RAW sockets of the interface given, e.g. vcan0.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Port_SocketCAN.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_SENDER_ADDRESS				(0x30U)
+#define BENCHMARK_RECEIVER_ADDRESS				(0x20U)
+#define BENCHMARK_DEFAULT_FRAMES				(200000U)
+#define BENCHMARK_PGNS							(16U)
+#define BENCHMARK_HANDLED_PGNS					(8U)		// The first PGNs are handled, the others are filtered
+#define BENCHMARK_FIRST_PGN						(0x00FF10UL)
+#define BENCHMARK_FRAME_PRIORITY				(6U)
+#define BENCHMARK_CHUNK							(128U)		// Frames sent before the receiver reads them
+#define BENCHMARK_TP_PGN						(0x00EF00UL)	// Proprietary A, PDU1
+#define BENCHMARK_TP_MESSAGES					(50U)
+#define BENCHMARK_TP_SIZE						(1785U)
+#define BENCHMARK_TIMEOUT						(20.0)		// s
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief An ECU on its channel of the port.
+ */
+typedef struct
+{
+	J1939_instance instance;
+	uint8_t channel;
+	uint64_t frames;						/* Frames received from the port */
+	uint64_t total_age;						/* Sum of the times from the kernel timestamp to the dispatcher, us */
+} benchmarkNode;
+
+/**
+ * @brief Results of a benchmark case.
+ */
+typedef struct
+{
+	uint32_t handled_frames;				/* Frames of the handled PGNs passed to the handler */
+	uint32_t expected_frames;				/* Frames of the handled PGNs sent */
+	uint32_t wrong_frames;					/* Frames passed to the handler with wrong data or out of order */
+	uint32_t next_sequence[BENCHMARK_HANDLED_PGNS];
+	uint32_t tp_messages;					/* RTS/CTS messages received and checked */
+	uint32_t wrong_messages;				/* RTS/CTS messages received with wrong data */
+} benchmarkResults;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static benchmarkNode sender;
+static benchmarkNode receiver;
+static benchmarkResults results;
+static uint8_t tpBuffer[BENCHMARK_TP_SIZE];
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to fill an RTS/CTS message: the message number and a pattern.
+ * @param	data - A pointer to the message.
+ * @param	number - The number of the message.
+ * @retval	None.
+ */
+static void benchmarkFillMessage(uint8_t* data, uint16_t number)
+{
+	data[0] = (uint8_t)number;
+	data[1] = (uint8_t)(number >> 8U);
+
+	for(uint16_t i = 2U; i < BENCHMARK_TP_SIZE; i++) data[i] = (uint8_t)((number * 31U) + i);
+}
+
+/**
+ * @brief 	This function is the handler of the single frames: each PGN carries its own sequence.
+ * @retval	None.
+ */
+static void benchmarkFrameHandler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+								  const uint8_t* data, uint16_t size)
+{
+	uint32_t index = PGN - BENCHMARK_FIRST_PGN;
+	uint32_t sequence;
+
+	(void)context;
+	(void)destinationAddress;
+
+	results.handled_frames++;
+
+	if((index >= BENCHMARK_HANDLED_PGNS) || (size != 8U) || (sourceAddress != BENCHMARK_SENDER_ADDRESS))
+	{
+		results.wrong_frames++;
+		return;
+	}
+
+	sequence = (uint32_t)data[0] | ((uint32_t)data[1] << 8U) | ((uint32_t)data[2] << 16U) | ((uint32_t)data[3] << 24U);
+	if((sequence != results.next_sequence[index]) || (data[4] != (uint8_t)PGN) || ((uint8_t)(data[0] ^ data[7]) != 0xFFU))
+	{
+		results.wrong_frames++;
+	}
+
+	results.next_sequence[index] = sequence + 1U;
+}
+
+/**
+ * @brief 	This function is the handler of the RTS/CTS messages.
+ * @retval	None.
+ */
+static void benchmarkMessageHandler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+									const uint8_t* data, uint16_t size)
+{
+	static uint8_t expected[BENCHMARK_TP_SIZE];
+
+	(void)context;
+	(void)PGN;
+	(void)sourceAddress;
+	(void)destinationAddress;
+
+	if((data == NULL) || (size != BENCHMARK_TP_SIZE))
+	{
+		results.wrong_messages++;
+		return;
+	}
+
+	benchmarkFillMessage(expected, (uint16_t)(data[0] | ((uint16_t)data[1] << 8U)));
+	(memcmp(data, expected, BENCHMARK_TP_SIZE) == 0) ? results.tp_messages++ : results.wrong_messages++;
+}
+
+/**
+ * @brief 	This function is the receive callback of the port: the frame is passed to the dispatcher.
+ * @retval	None.
+ */
+static void benchmarkReceive(void* context, uint32_t canId, const uint8_t* data, uint8_t length, uint32_t timestamp)
+{
+	benchmarkNode* node = (benchmarkNode*)context;
+
+	node->frames++;
+	node->total_age += (uint32_t)(J1939_portGetTraceTime() - timestamp);
+
+	J1939_dispatchFrame(&node->instance, canId, data, length);
+}
+
+/**
+ * @brief 	This function is used to open the channels of the ECUs on the interface or on a socketpair.
+ * @param	interfaceName - The CAN interface. NULL - a socketpair.
+ * @retval	1 if the channels are open, 0 otherwise.
+ */
+static uint8_t benchmarkOpenChannels(const char* interfaceName)
+{
+	int sockets[2];
+
+	if(interfaceName != NULL)
+	{
+		sender.channel		= J1939_socketCANopen(interfaceName, benchmarkReceive, &sender);
+		receiver.channel	= J1939_socketCANopen(interfaceName, benchmarkReceive, &receiver);
+	} else
+	{
+		if(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) < 0) return 0U;
+
+		sender.channel		= J1939_socketCANattach(sockets[0], benchmarkReceive, &sender);
+		receiver.channel	= J1939_socketCANattach(sockets[1], benchmarkReceive, &receiver);
+	}
+
+	return ((sender.channel != J1939_SOCKETCAN_NO_CHANNEL) && (receiver.channel != J1939_SOCKETCAN_NO_CHANNEL)) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is used to run and report one benchmark case.
+ * @param	mode - The name of the case.
+ * @param	batchSize - The batch size of the channels.
+ * @param	numberOfFrames - The number of single frames to send.
+ * @param	interfaceName - The CAN interface. NULL - a socketpair.
+ * @param	callsPerFrame - A pointer to store the system calls per frame.
+ * @retval	1 if every frame and message is received and correct, 0 otherwise.
+ */
+static uint8_t benchmarkRun(const char* mode, uint8_t batchSize, uint32_t numberOfFrames, const char* interfaceName,
+							double* callsPerFrame)
+{
+	J1939_socketCANcounters senderCounters, receiverCounters;
+	uint32_t sentFrames = 0U, sentMessages = 0U;
+	double start, frameTime, tpTime;
+	uint8_t data[8];
+
+	memset(&results, 0, sizeof(results));
+	memset(&receiverCounters, 0, sizeof(receiverCounters));
+	memset(&sender, 0, sizeof(sender));
+	memset(&receiver, 0, sizeof(receiver));
+
+	if(benchmarkOpenChannels(interfaceName) == 0U)
+	{
+		printf("%-8s the channels can't be opened\n", mode);
+		return 0U;
+	}
+
+	J1939_socketCANsetBatchSize(sender.channel, batchSize);
+	J1939_socketCANsetBatchSize(receiver.channel, batchSize);
+
+	J1939_initInstance(&sender.instance, sender.channel);
+	J1939_setCurrentECUAddress(&sender.instance, BENCHMARK_SENDER_ADDRESS);
+	J1939_initInstance(&receiver.instance, receiver.channel);
+	J1939_setCurrentECUAddress(&receiver.instance, BENCHMARK_RECEIVER_ADDRESS);
+
+	for(uint32_t i = 0U; i < BENCHMARK_HANDLED_PGNS; i++)
+	{
+		J1939_registerPGNhandler(&receiver.instance, BENCHMARK_FIRST_PGN + i, J1939_ANY_ADDRESS, J1939_ANY_ADDRESS,
+								 benchmarkFrameHandler, NULL);
+	}
+
+	J1939_registerPGNhandler(&receiver.instance, BENCHMARK_TP_PGN, J1939_ANY_ADDRESS, J1939_ANY_ADDRESS,
+							 benchmarkMessageHandler, NULL);
+	J1939_enableAcceptanceFilters(&receiver.instance);
+
+	// The single frames are sent in chunks the socket can take, each chunk is read by the receiver
+	start = benchmarkGetWallTime();
+
+	while(((sentFrames < numberOfFrames) || (receiver.frames + receiverCounters.rx_filtered_frames < sentFrames)) && \
+		  ((benchmarkGetWallTime() - start) < BENCHMARK_TIMEOUT))
+	{
+		for(uint32_t i = 0U; (i < BENCHMARK_CHUNK) && (sentFrames < numberOfFrames); i++)
+		{
+			uint32_t PGN = BENCHMARK_FIRST_PGN + (sentFrames % BENCHMARK_PGNS);
+			uint32_t sequence = sentFrames / BENCHMARK_PGNS;
+
+			if(J1939_getFreeTxSlots(&sender.instance) == 0U) break;
+
+			data[0] = (uint8_t)sequence;
+			data[1] = (uint8_t)(sequence >> 8U);
+			data[2] = (uint8_t)(sequence >> 16U);
+			data[3] = (uint8_t)(sequence >> 24U);
+			data[4] = (uint8_t)PGN;
+			data[5] = 0xFFU;
+			data[6] = 0xFFU;
+			data[7] = (uint8_t)~data[0];
+
+			if(J1939_sendFrame(&sender.instance, (BENCHMARK_FRAME_PRIORITY << 26U) | (PGN << 8U) | BENCHMARK_SENDER_ADDRESS,
+							   data, 8U) != J1939_PORT_FRAME_QUEUED) break;
+
+			if((sentFrames % BENCHMARK_PGNS) < BENCHMARK_HANDLED_PGNS) results.expected_frames++;
+			sentFrames++;
+		}
+
+		J1939_socketCANflush(sender.channel);
+		J1939_socketCANreceive(receiver.channel, 0U);
+		J1939_socketCANgetCounters(receiver.channel, &receiverCounters);
+	}
+
+	frameTime = benchmarkGetWallTime() - start;
+
+	J1939_socketCANgetCounters(sender.channel, &senderCounters);
+	J1939_socketCANgetCounters(receiver.channel, &receiverCounters);
+	*callsPerFrame = (sentFrames > 0U) ? (double)(senderCounters.tx_calls + receiverCounters.rx_calls) / sentFrames : 0.0;
+
+	printf("%-8s %5u %9u %9u %9llu %11.0f %9.0f %10.2f %9.1f",
+		   mode, batchSize, sentFrames, results.handled_frames, (unsigned long long)receiverCounters.rx_filtered_frames,
+		   sentFrames / frameTime, (frameTime * 1e9) / sentFrames, *callsPerFrame,
+		   (receiver.frames > 0U) ? (double)receiver.total_age / receiver.frames : 0.0);
+
+	// The RTS/CTS messages go both ways: RTS and data to the receiver, CTS and EndOfMsgAck back
+	J1939_socketCANresetCounters(sender.channel);
+	J1939_socketCANresetCounters(receiver.channel);
+	start = benchmarkGetWallTime();
+
+	while((results.tp_messages + results.wrong_messages < BENCHMARK_TP_MESSAGES) && \
+		  ((benchmarkGetWallTime() - start) < BENCHMARK_TIMEOUT))
+	{
+		// One RTS/CTS session at a time is allowed between two ECUs
+		if((sentMessages < BENCHMARK_TP_MESSAGES) && (J1939_isTXdataInUse(&sender.instance, tpBuffer) == 0U))
+		{
+			benchmarkFillMessage(tpBuffer, (uint16_t)sentMessages);
+			if(J1939_sendPGN(&sender.instance, BENCHMARK_TP_PGN, BENCHMARK_FRAME_PRIORITY, BENCHMARK_RECEIVER_ADDRESS,
+							 tpBuffer, BENCHMARK_TP_SIZE) == J1939_SEND_OK) sentMessages++;
+		}
+
+		J1939_processTimers(&sender.instance);
+		J1939_processTimers(&receiver.instance);
+		J1939_sendTPpendingPackages(&sender.instance);
+		J1939_sendTPpendingPackages(&receiver.instance);
+
+		J1939_socketCANflush(sender.channel);
+		J1939_socketCANflush(receiver.channel);
+		J1939_socketCANreceive(receiver.channel, 0U);
+		J1939_socketCANreceive(sender.channel, 0U);
+	}
+
+	tpTime = benchmarkGetWallTime() - start;
+
+	J1939_socketCANgetCounters(sender.channel, &senderCounters);
+	J1939_socketCANgetCounters(receiver.channel, &receiverCounters);
+
+	printf(" %8u %10.0f %9.1f\n", results.tp_messages, results.tp_messages / tpTime,
+		   (results.tp_messages > 0U) ? (double)(senderCounters.tx_calls + senderCounters.rx_calls + \
+												  receiverCounters.tx_calls + receiverCounters.rx_calls) / results.tp_messages : 0.0);
+
+	J1939_socketCANclose(sender.channel);
+	J1939_socketCANclose(receiver.channel);
+
+	return ((results.handled_frames == results.expected_frames) && (results.wrong_frames == 0U) && \
+			(sentFrames == numberOfFrames) && (results.tp_messages == BENCHMARK_TP_MESSAGES) && \
+			(results.wrong_messages == 0U)) ? 1U : 0U;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	uint32_t numberOfFrames = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_FRAMES;
+	const char* interfaceName = (argc > 2) ? argv[2] : NULL;
+	double singleCalls, batchedCalls;
+	uint8_t passed;
+
+	if(numberOfFrames == 0U) numberOfFrames = BENCHMARK_DEFAULT_FRAMES;
+
+	printf("SAE J1939 SocketCAN port, %u single frames of %u PGNs (%u handled) and %u RTS/CTS messages of %u bytes "
+		   "per case, %s\n", numberOfFrames, BENCHMARK_PGNS, BENCHMARK_HANDLED_PGNS, BENCHMARK_TP_MESSAGES,
+		   BENCHMARK_TP_SIZE, (interfaceName != NULL) ? interfaceName : "socketpair");
+	printf("%-8s %5s %9s %9s %9s %11s %9s %10s %9s %8s %10s %9s\n", "mode", "batch", "frames", "handled", "filtered",
+		   "frames/s", "ns/frame", "calls/frm", "age us", "messages", "messages/s", "calls/msg");
+
+	passed = benchmarkRun("single", 1U, numberOfFrames, interfaceName, &singleCalls);
+	passed &= benchmarkRun("batched", J1939_SOCKETCAN_BATCH_SIZE, numberOfFrames, interfaceName, &batchedCalls);
+
+	// Both cases must deliver everything intact, the batches must take fewer system calls
+	return ((passed == 1U) && (batchedCalls < singleCalls)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,418 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Statistics_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Simulation of the runtime statistics. An ECU sends RTS/CTS, BAM
+  * 		 and ETP messages to a receiver over the virtual CAN bus with lost
+  * 		 data transfer packages, and publishes its counters
+  * 		 on a proprietary PGN read by a monitor. The counters of both
+  * 		 sides are checked against each other, against the messages
+  * 		 received and against the frames of the bus.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Port_Host.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_SENDER_ADDRESS				(0x10U)
+#define BENCHMARK_RECEIVER_ADDRESS				(0x20U)
+#define BENCHMARK_MONITOR_ADDRESS				(0x30U)
+#define BENCHMARK_PTP_PGN						(0x00FF10UL)
+#define BENCHMARK_BAM_PGN						(0x00FF11UL)
+#define BENCHMARK_ETP_PGN						(0x00FF12UL)
+#define BENCHMARK_STATISTICS_PGN				(0x00FF77UL)
+#define BENCHMARK_MAX_MESSAGE_SIZE				(1785U)
+#define BENCHMARK_BAM_SIZE						(100U)
+#define BENCHMARK_ETP_SIZE						(4096U)
+#define BENCHMARK_PTP_PERIOD					(20U)		// ms
+#define BENCHMARK_BAM_PERIOD					(3000U)		// ms, a BAM takes 50 ms per package
+#define BENCHMARK_ETP_PERIOD					(5000U)		// ms
+#define BENCHMARK_PUBLISH_PERIOD				(5000U)		// ms
+#define BENCHMARK_DRAIN_TIME					(2000U)		// ms
+#define BENCHMARK_LOST_PACKAGE_PERIOD			(40U)
+#define BENCHMARK_DEFAULT_TIME					(20000U)	// ms
+#define BENCHMARK_COPIES						(100000U)
+
+#define BENCHMARK_GET_PDU_FORMAT(canId)			((uint8_t)((canId) >> 16U))
+#define BENCHMARK_GET_ETP_BYTE(offset)			((uint8_t)((offset) * 7U + 1U))
+#define BENCHMARK_GET_COUNTER(data)				(((uint32_t)(data)[3] << 24U) | ((uint32_t)(data)[2] << 16U) | \
+												 ((uint32_t)(data)[1] << 8U) | (data)[0])
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A benchmark node on the virtual bus.
+ */
+typedef struct
+{
+	uint8_t address;
+	J1939_instance instance;				/* The stack of the node, its channel is the node */
+	uint32_t frames;						/* Frames delivered to the node */
+} benchmarkNode;
+
+/**
+ * @brief Results of the simulation.
+ */
+typedef struct
+{
+	uint32_t PTP_messages;					/* RTS/CTS messages received by the receiver */
+	uint32_t BAM_messages;					/* BAM messages received by the receiver, the statistics included */
+	uint32_t ETP_messages;					/* ETP messages passed on to the sink of the receiver in order */
+	uint32_t ETP_received_bytes;			/* Bytes of the current ETP message passed on in order */
+	uint32_t ETP_corrupted;					/* ETP messages passed on with wrong or out-of-order data */
+	uint32_t publications;					/* Statistics messages received by the monitor */
+	uint32_t wrong_publications;			/* Statistics messages of a wrong layout */
+	uint32_t published_PTP_completed;		/* The completed RTS/CTS sessions of the last statistics message */
+} benchmarkResults;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static benchmarkNode sender		= {.address = BENCHMARK_SENDER_ADDRESS};
+static benchmarkNode receiver	= {.address = BENCHMARK_RECEIVER_ADDRESS};
+static benchmarkNode monitor	= {.address = BENCHMARK_MONITOR_ADDRESS};
+static benchmarkResults results;
+static uint8_t PTPmessage[BENCHMARK_MAX_MESSAGE_SIZE];
+static uint8_t BAMmessage[BENCHMARK_BAM_SIZE];
+static uint32_t dataPackages = 0U;
+
+static const char* sessionNames[J1939_STATISTICS_SESSION_TYPES] =
+{
+	"TP BAM RX", "TP PTP RX", "TP BAM TX", "TP PTP TX", "ETP RX", "ETP TX", "FD.TP RX", "FD.TP TX"
+};
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is the RX interrupt of the nodes: the frame is passed to the dispatcher.
+ * @retval	None.
+ */
+static void benchmarkReceive(void* context, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	benchmarkNode* node = (benchmarkNode*)context;
+
+	node->frames++;
+	benchmarkDispatch(&node->instance, canId, data, dlc);
+}
+
+/**
+ * @brief 	This function is used to lose every BENCHMARK_LOST_PACKAGE_PERIOD data transfer package.
+ * @retval	1 if the frame is lost, 0 otherwise.
+ */
+static uint8_t benchmarkLoseFrame(uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	(void)data;
+	(void)dlc;
+
+	if((BENCHMARK_GET_PDU_FORMAT(canId) != J1939_DATA_TRANSFER) && \
+	   (BENCHMARK_GET_PDU_FORMAT(canId) != J1939_ETP_DATA_TRANSFER)) return 0U;
+
+	return ((++dataPackages % BENCHMARK_LOST_PACKAGE_PERIOD) == 0U) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is the handler of the messages of the receiver.
+ * @retval	None.
+ */
+static void benchmarkMessageHandler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+									const uint8_t* data, uint16_t size)
+{
+	(void)context;
+	(void)sourceAddress;
+	(void)destinationAddress;
+	(void)data;
+	(void)size;
+
+	(PGN == BENCHMARK_PTP_PGN) ? results.PTP_messages++ : results.BAM_messages++;
+}
+
+/**
+ * @brief 	This function is called by ETP of the sender to read the sent message, it is generated on the fly.
+ * @retval	None.
+ */
+static void benchmarkETPsource(void* context, uint32_t offset, uint8_t* data, uint16_t size)
+{
+	(void)context;
+
+	for(uint16_t i = 0U; i < size; i++) data[i] = BENCHMARK_GET_ETP_BYTE(offset + i);
+}
+
+/**
+ * @brief 	This function is the ETP sink of the receiver registered for the dispatcher, the message
+ * 			is verified on the fly.
+ * @retval	None.
+ */
+static void benchmarkETPsink(void* context, uint32_t offset, const uint8_t* data, uint16_t size)
+{
+	uint8_t corrupted = 0U;
+
+	(void)context;
+
+	// A new message starts at the offset 0
+	if(offset == 0U) results.ETP_received_bytes = 0U;
+
+	if(offset != results.ETP_received_bytes) corrupted = 1U;
+
+	for(uint16_t i = 0U; i < size; i++)
+	{
+		if(data[i] != BENCHMARK_GET_ETP_BYTE(offset + i)) corrupted = 1U;
+	}
+
+	results.ETP_received_bytes = offset + size;
+
+	if(corrupted == 1U)
+	{
+		results.ETP_corrupted++;
+	} else if(results.ETP_received_bytes == BENCHMARK_ETP_SIZE)
+	{
+		results.ETP_messages++;
+	}
+}
+
+/**
+ * @brief 	This function is the handler of the statistics messages of the monitor: the layout is checked and
+ * 			the completed RTS/CTS sessions of the sender are read.
+ * @retval	None.
+ */
+static void benchmarkStatisticsHandler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+									   const uint8_t* data, uint16_t size)
+{
+	const uint8_t* record = &data[18U + (J1939_STATISTICS_TP_PTP_TX * J1939_STATISTICS_SESSION_RECORD_SIZE)];
+
+	(void)context;
+	(void)PGN;
+	(void)sourceAddress;
+	(void)destinationAddress;
+
+	if((size != J1939_STATISTICS_MESSAGE_SIZE) || (data[0] != J1939_STATISTICS_LAYOUT_VERSION) || \
+	   (data[1] != J1939_STATISTICS_SESSION_TYPES))
+	{
+		results.wrong_publications++;
+		return;
+	}
+
+	results.publications++;
+	results.published_PTP_completed = BENCHMARK_GET_COUNTER(&record[4]);
+}
+
+/**
+ * @brief 	This function is used to print the session counters of a node.
+ * @param	name - The name of the node.
+ * @param	statistics - A pointer to the statistics of the node.
+ * @retval	None.
+ */
+static void benchmarkPrintSessions(const char* name, const J1939_statistics* statistics)
+{
+	printf("%s: %u frames received, %u sent, %u not sent, receive buffers peak %u bytes\n", name,
+		   statistics->frames_received, statistics->frames_sent, statistics->frames_not_sent, statistics->max_buffer_bytes);
+	printf("  %-10s %7s %9s %7s %7s %7s %10s %5s %8s %6s %8s\n", "session", "opened", "completed", "timeout", "lost",
+		   "peer", "busy", "alloc", "resent", "max", "active");
+
+	for(uint8_t type = 0U; type < J1939_STATISTICS_SESSION_TYPES; type++)
+	{
+		const J1939_sessionStatistics* sessions = &statistics->sessions[type];
+
+		printf("  %-10s %7u %9u %7u %7u %7u %10u %5u %8u %6u %8u\n", sessionNames[type], sessions->opened,
+			   sessions->completed, sessions->aborts[J1939_ABORT_SLOT_TIMEOUT], sessions->aborts[J1939_ABORT_SLOT_RETRANSMIT_LIMIT],
+			   sessions->peer_aborts, sessions->busy, sessions->allocation_failures, sessions->retransmitted_packages,
+			   sessions->max_active, sessions->active);
+	}
+}
+
+/**
+ * @brief 	This function is used to print a histogram of times.
+ * @param	name - The name of the histogram.
+ * @param	histogram - A pointer to the bins.
+ * @retval	None.
+ */
+static void benchmarkPrintHistogram(const char* name, const uint32_t* histogram)
+{
+	printf("  %-24s", name);
+
+	for(uint8_t bin = 0U; bin < J1939_STATISTICS_HISTOGRAM_BINS; bin++)
+	{
+		if(histogram[bin] > 0U) printf(" <%ums:%u", 1U << bin, histogram[bin]);
+	}
+
+	printf("\n");
+}
+
+/**
+ * @brief 	This function is used to check that every session of the node is completed, aborted or open.
+ * @param	statistics - A pointer to the statistics of the node.
+ * @retval	1 - the counters agree, 0 - don't.
+ */
+static uint8_t benchmarkCheckSessions(const J1939_statistics* statistics)
+{
+	for(uint8_t type = 0U; type < J1939_STATISTICS_SESSION_TYPES; type++)
+	{
+		const J1939_sessionStatistics* sessions = &statistics->sessions[type];
+		uint32_t closed = sessions->completed;
+
+		for(uint8_t slot = 0U; slot < J1939_ABORT_SLOTS; slot++) closed += sessions->aborts[slot];
+
+		if((sessions->opened != (closed + sessions->active)) || (sessions->active != 0U)) return 0U;
+	}
+
+	return 1U;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	uint32_t time = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_TIME;
+	J1939_statistics senderStatistics, receiverStatistics, copy;
+	J1939_hostCounters counters;
+	J1939_TP_session* session;
+	J1939_ETP_session* ETPsession;
+	uint32_t nextPTP = 0U, nextBAM = 0U, nextETP = 0U, now;
+	uint32_t sleepTime, nodeSleepTime;
+	uint64_t startTime, copyTime;
+	uint8_t passed = 1U, publishing = 1U;
+
+	if(time == 0U) time = BENCHMARK_DEFAULT_TIME;
+
+	srand(1939U);
+	for(uint16_t i = 0U; i < BENCHMARK_MAX_MESSAGE_SIZE; i++) PTPmessage[i] = (uint8_t)rand();
+	for(uint16_t i = 0U; i < BENCHMARK_BAM_SIZE; i++) BAMmessage[i] = (uint8_t)rand();
+
+	printf("SAE J1939-21 runtime statistics simulation, %u ms, every %u-th data transfer package lost\n",
+		   time, BENCHMARK_LOST_PACKAGE_PERIOD);
+
+	J1939_hostInit(J1939_HOST_DEFAULT_BITRATE);
+	J1939_hostSetLossFilter(benchmarkLoseFrame);
+
+	J1939_initInstance(&sender.instance, J1939_hostAddNode(benchmarkReceive, &sender));
+	J1939_initInstance(&receiver.instance, J1939_hostAddNode(benchmarkReceive, &receiver));
+	J1939_initInstance(&monitor.instance, J1939_hostAddNode(benchmarkReceive, &monitor));
+	J1939_setCurrentECUAddress(&sender.instance, sender.address);
+	J1939_setCurrentECUAddress(&receiver.instance, receiver.address);
+	J1939_setCurrentECUAddress(&monitor.instance, monitor.address);
+
+	J1939_registerPGNhandler(&receiver.instance, BENCHMARK_PTP_PGN, sender.address, J1939_ANY_ADDRESS, benchmarkMessageHandler, NULL);
+	J1939_registerPGNhandler(&receiver.instance, BENCHMARK_BAM_PGN, sender.address, J1939_ANY_ADDRESS, benchmarkMessageHandler, NULL);
+	J1939_registerPGNhandler(&receiver.instance, BENCHMARK_STATISTICS_PGN, sender.address, J1939_ANY_ADDRESS, benchmarkMessageHandler, NULL);
+	J1939_registerETPsink(&receiver.instance, BENCHMARK_ETP_PGN, benchmarkETPsink, NULL);
+	J1939_registerPGNhandler(&monitor.instance, BENCHMARK_STATISTICS_PGN, sender.address, J1939_ANY_ADDRESS,
+							 benchmarkStatisticsHandler, NULL);
+
+	if(J1939_publishStatistics(&sender.instance, BENCHMARK_STATISTICS_PGN, BENCHMARK_PUBLISH_PERIOD) != J1939_STATISTICS_OK) passed = 0U;
+
+	// The messages are sent for the given time, then the sessions are finished
+	while((now = (uint32_t)(J1939_hostGetTime() / 1000U)) < (time + BENCHMARK_DRAIN_TIME))
+	{
+		if((now >= nextPTP) && (now < time))
+		{
+			// A new message is rejected while the previous one to the receiver is sent
+			session = J1939_fillTPstructures(&sender.instance, PTPmessage, (uint16_t)(9U + (rand() % (BENCHMARK_MAX_MESSAGE_SIZE - 8U))),
+											 BENCHMARK_PTP_PGN, receiver.address);
+			if(session != NULL) J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_RTS);
+			nextPTP += BENCHMARK_PTP_PERIOD;
+		}
+
+		if((now >= nextBAM) && (now < time))
+		{
+			session = J1939_fillTPstructures(&sender.instance, BAMmessage, BENCHMARK_BAM_SIZE, BENCHMARK_BAM_PGN, J1939_BROADCAST_ADDRESS);
+			if(session != NULL) J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_BAM);
+			nextBAM += BENCHMARK_BAM_PERIOD;
+		}
+
+		if((now >= nextETP) && (now < time))
+		{
+			ETPsession = J1939_fillETPstructures(&sender.instance, BENCHMARK_ETP_SIZE, BENCHMARK_ETP_PGN, receiver.address,
+												 benchmarkETPsource, NULL);
+			if(ETPsession != NULL) J1939_sendETP_connectionManagement(ETPsession, J1939_TP_TYPE_RTS);
+			nextETP += BENCHMARK_ETP_PERIOD;
+		}
+
+		// The publication is stopped before the drain, so all sessions are closed at the end
+		if((now >= time) && (publishing == 1U))
+		{
+			J1939_publishStatistics(&sender.instance, BENCHMARK_STATISTICS_PGN, 0U);
+			publishing = 0U;
+		}
+
+		sleepTime		= J1939_processTimers(&sender.instance);
+		nodeSleepTime	= J1939_processTimers(&receiver.instance);
+		if(nodeSleepTime < sleepTime) sleepTime = nodeSleepTime;
+		nodeSleepTime	= J1939_processTimers(&monitor.instance);
+		if(nodeSleepTime < sleepTime) sleepTime = nodeSleepTime;
+
+		J1939_sendTPpendingPackages(&sender.instance);
+		J1939_sendETPpendingPackages(&sender.instance);
+
+		if((J1939_hostProcessBus() > 0U) || (sleepTime == 0U)) continue;
+
+		// The task sleeps until the next deadline, at most until the next message
+		if(sleepTime > 1U) sleepTime = 1U;
+		J1939_hostAdvanceTime(((uint64_t)sleepTime * 1000U) - (J1939_hostGetTime() % 1000U));
+	}
+
+	J1939_getStatistics(&sender.instance, &senderStatistics);
+	J1939_getStatistics(&receiver.instance, &receiverStatistics);
+	J1939_hostGetCounters(&counters);
+
+	benchmarkPrintSessions("sender", &senderStatistics);
+	benchmarkPrintHistogram("RTS/CTS round trip", senderStatistics.sessions[J1939_STATISTICS_TP_PTP_TX].CTS_round_trip);
+	benchmarkPrintHistogram("RTS/CTS transfer time", senderStatistics.sessions[J1939_STATISTICS_TP_PTP_TX].transfer_time);
+	benchmarkPrintHistogram("BAM transfer time", senderStatistics.sessions[J1939_STATISTICS_TP_BAM_TX].transfer_time);
+	benchmarkPrintSessions("receiver", &receiverStatistics);
+	benchmarkPrintHistogram("CTS round trip", receiverStatistics.sessions[J1939_STATISTICS_TP_PTP_RX].CTS_round_trip);
+	benchmarkPrintHistogram("RTS/CTS transfer time", receiverStatistics.sessions[J1939_STATISTICS_TP_PTP_RX].transfer_time);
+
+	// Reading the statistics from another task is a copy of the block
+	startTime = benchmarkGetNanoseconds();
+	for(uint32_t i = 0U; i < BENCHMARK_COPIES; i++)
+	{
+		J1939_getStatistics(&sender.instance, &copy);
+		__asm__ volatile("" : : "r"(&copy) : "memory");
+	}
+	copyTime = benchmarkGetNanoseconds() - startTime;
+
+	printf("messages received: %u RTS/CTS, %u BAM, %u ETP (%u corrupted); statistics published %u times (%u wrong), "
+		   "last %u RTS/CTS completed\n", results.PTP_messages, results.BAM_messages, results.ETP_messages, results.ETP_corrupted,
+		   results.publications, results.wrong_publications, results.published_PTP_completed);
+	printf("bus frames %llu, %u bytes of statistics copied in %.1f ns\n", (unsigned long long)counters.frames,
+		   (unsigned)sizeof(J1939_statistics), (double)copyTime / BENCHMARK_COPIES);
+
+	// Every session is closed and counted once, both sides agree with the messages and the bus
+	passed &= benchmarkCheckSessions(&senderStatistics) & benchmarkCheckSessions(&receiverStatistics);
+	passed &= (receiverStatistics.sessions[J1939_STATISTICS_TP_PTP_RX].completed == results.PTP_messages);
+	passed &= (receiverStatistics.sessions[J1939_STATISTICS_TP_BAM_RX].completed == results.BAM_messages);
+	passed &= (senderStatistics.sessions[J1939_STATISTICS_TP_PTP_TX].completed == results.PTP_messages);
+	passed &= (receiverStatistics.sessions[J1939_STATISTICS_TP_PTP_RX].retransmitted_packages > 0U);
+	passed &= (receiverStatistics.sessions[J1939_STATISTICS_ETP_RX].completed == results.ETP_messages);
+	passed &= (senderStatistics.sessions[J1939_STATISTICS_ETP_TX].completed == results.ETP_messages);
+	passed &= (results.ETP_messages > 0U) && (results.ETP_corrupted == 0U);
+	passed &= (receiverStatistics.sessions[J1939_STATISTICS_ETP_RX].retransmitted_packages > 0U);
+	passed &= (senderStatistics.sessions[J1939_STATISTICS_TP_PTP_TX].busy > 0U);
+	passed &= ((uint64_t)senderStatistics.frames_sent + receiverStatistics.frames_sent + monitor.instance.statistics.frames_sent == \
+			   counters.frames);
+	passed &= (receiverStatistics.frames_received == receiver.frames);
+	passed &= ((results.publications + 1U) >= (time / BENCHMARK_PUBLISH_PERIOD)) && (results.wrong_publications == 0U);
+	passed &= (results.published_PTP_completed <= results.PTP_messages);
+
+	printf("%s\n", (passed == 1U) ? "PASSED" : "FAILED");
+
+	return (passed == 1U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
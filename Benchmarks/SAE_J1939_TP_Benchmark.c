@@ -0,0 +1,915 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_TP_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Throughput benchmark of the SAE J1939-21 transport protocol. Two
+  * 		 nodes exchange BAM and RTS/CTS messages over the virtual CAN bus
+  * 		 of the host platform, also with lost data transfer packages, and
+  * 		 stream messages above 1785 bytes by ETP. Announcements whose size
+  * 		 doesn't fit the number of packages must be rejected, a broken off
+  * 		 broadcast message must be replaced by the next one.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Port_Host.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_SENDER_ADDRESS				(0x10U)
+#define BENCHMARK_RECEIVER_ADDRESS				(0x20U)
+#define BENCHMARK_PGN							(0x00FF00U)
+#define BENCHMARK_DEFAULT_ITERATIONS			(2000U)
+#define BENCHMARK_MAX_MESSAGE_SIZE				(1785U)
+#define BENCHMARK_LOST_PACKAGE_PERIOD			(50U)
+#define BENCHMARK_CAN_DLC						(8U)
+#define BENCHMARK_TX_SLOTS						(3U)		// The TX mailboxes of a bxCAN controller
+#define BENCHMARK_ETP_LIMIT_SIZE				(4096U)		// The last package holds 1 byte and 6 padding bytes
+
+#define BENCHMARK_GET_ETP_BYTE(offset)			((uint8_t)(((offset) * 7U + 1U) ^ ((offset) >> 11U)))
+
+#define BENCHMARK_GET_PDU_FORMAT(canId)			((uint8_t)((canId) >> 16U))
+#define BENCHMARK_GET_PDU_SPECIFIC(canId)		((uint8_t)((canId) >> 8U))
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A benchmark node on the virtual bus.
+ */
+typedef struct
+{
+	uint8_t address;
+	uint8_t node;
+	J1939_instance instance;				/* The stack of the node, its channel is the node */
+} benchmarkNode;
+
+/**
+ * @brief Results of a benchmark run.
+ */
+typedef struct
+{
+	uint32_t completed;						/* Messages received and verified */
+	uint32_t corrupted;						/* Messages received with wrong data */
+	uint32_t aborted;						/* Sessions closed by the abort message */
+	uint32_t errors;						/* Sessions rejected by the receiver */
+	uint32_t pending_tx;					/* A TX session is waiting for the end of message acknowledgment */
+	uint32_t tx_calls;						/* Calls of the data transfer sending function or the timer tick */
+	uint32_t streamed_bytes;				/* Bytes of the TP message passed on by the sink */
+	uint8_t stream_corrupted;				/* 1 - the TP sink got wrong data */
+	uint32_t etp_received_bytes;			/* Bytes of the ETP message passed on by the sink in order */
+	uint8_t etp_corrupted;					/* 1 - the sink got wrong or out-of-order data */
+} benchmarkResults;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static benchmarkNode sender		= {.address = BENCHMARK_SENDER_ADDRESS};
+static benchmarkNode receiver	= {.address = BENCHMARK_RECEIVER_ADDRESS};
+static benchmarkResults results	= {0};
+static uint8_t message[BENCHMARK_MAX_MESSAGE_SIZE];
+static uint16_t messageSize		= 0U;
+static uint32_t dataPackages	= 0U;
+static uint8_t refuseDPO		= 0U;
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to close the receive session and to verify the received message.
+ * @param	session - A pointer to the TP session.
+ * @retval	None.
+ */
+static void benchmarkFinishReceiving(J1939_TP_session* session)
+{
+	if(session->dataTransfer.sink != NULL)
+	{
+		((results.stream_corrupted == 0U) && (results.streamed_bytes == messageSize)) ? results.completed++ : \
+																						 results.corrupted++;
+	} else
+	{
+		(memcmp(J1939_getReceivedMessage(session), message, messageSize) == 0) ? results.completed++ : results.corrupted++;
+	}
+
+	J1939_freeAllocatedMemory(session);
+	J1939_clearTPstructures(session);
+}
+
+/**
+ * @brief 	This function is called by TP with each package of the streamed message, it is verified on the fly.
+ * @param	context - Not used.
+ * @param	sourceAddress - The originator of the message.
+ * @param	offset - The offset of the package in the message.
+ * @param	data - A pointer to the package data.
+ * @param	size - The number of bytes.
+ * @retval	None.
+ */
+static void benchmarkTPsink(void* context, uint8_t sourceAddress, uint16_t offset, const uint8_t* data, uint8_t size)
+{
+	(void)context;
+
+	if((sourceAddress != sender.address) || (memcmp(&message[offset], data, size) != 0)) results.stream_corrupted = 1U;
+
+	results.streamed_bytes += size;
+}
+
+/**
+ * @brief 	This function is called when the library closes a session itself.
+ * @param	session - A pointer to the TP session.
+ * @param	status - J1939_ERROR_TIMEOUT, J1939_ERROR_MISSING_PACKAGES or J1939_STATUS_DATA_FINISHED.
+ * @retval	None.
+ */
+static void benchmarkSessionClosed(J1939_TP_session* session, J1939_status status)
+{
+	if(session->type == J1939_TP_SESSION_TX) results.pending_tx = 0U;
+	if(status != J1939_STATUS_DATA_FINISHED) results.aborted++;
+}
+
+/**
+ * @brief 	This function is called by ETP to read the sent message, it is generated on the fly.
+ * @param	context - Not used.
+ * @param	offset - The offset of the bytes in the message.
+ * @param	data - A pointer to store the bytes.
+ * @param	size - The number of bytes.
+ * @retval	None.
+ */
+static void benchmarkETPsource(void* context, uint32_t offset, uint8_t* data, uint16_t size)
+{
+	(void)context;
+
+	for(uint16_t i = 0U; i < size; i++) data[i] = BENCHMARK_GET_ETP_BYTE(offset + i);
+}
+
+/**
+ * @brief 	This function is called by ETP to pass on the received message, it is verified on the fly.
+ * @param	context - Not used.
+ * @param	offset - The offset of the bytes in the message.
+ * @param	data - A pointer to the bytes.
+ * @param	size - The number of bytes.
+ * @retval	None.
+ */
+static void benchmarkETPsink(void* context, uint32_t offset, const uint8_t* data, uint16_t size)
+{
+	(void)context;
+
+	if(offset != results.etp_received_bytes) results.etp_corrupted = 1U;
+
+	for(uint16_t i = 0U; i < size; i++)
+	{
+		if(data[i] != BENCHMARK_GET_ETP_BYTE(offset + i)) results.etp_corrupted = 1U;
+	}
+
+	results.etp_received_bytes += size;
+}
+
+/**
+ * @brief 	This function is the TX hook of the sender with few TX slots: every second DPO isn't queued
+ * 			as if the mailbox had been taken in the meantime.
+ * @param	channel - The node which sends the frame.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+static uint8_t benchmarkSendFrame(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	if((BENCHMARK_GET_PDU_FORMAT(canId) == J1939_ETP_CONNECTION_MANAGEMENT) && (data[0] == J1939_CONTROL_BYTE_ETP_CM_DPO))
+	{
+		refuseDPO ^= 1U;
+		if(refuseDPO == 1U) return J1939_PORT_FRAME_NOT_QUEUED;
+	}
+
+	return J1939_portSendFrame(channel, canId, data, dlc);
+}
+
+/**
+ * @brief 	This function is used to get the free TX slots of the sender with few TX slots.
+ * @param	channel - Not used.
+ * @retval	BENCHMARK_TX_SLOTS.
+ */
+static uint8_t benchmarkGetFreeTxSlots(uint8_t channel)
+{
+	(void)channel;
+
+	return BENCHMARK_TX_SLOTS;
+}
+
+/**
+ * @brief 	This function is called when the library closes an ETP session itself.
+ * @param	session - A pointer to the ETP session.
+ * @param	status - J1939_ERROR_TIMEOUT or J1939_ERROR_MISSING_PACKAGES.
+ * @retval	None.
+ */
+static void benchmarkETPsessionClosed(J1939_ETP_session* session, J1939_status status)
+{
+	(void)status;
+
+	if(session->type == J1939_ETP_SESSION_TX) results.pending_tx = 0U;
+	results.aborted++;
+}
+
+/**
+ * @brief 	This function is used to process ETP frames, as the application does.
+ * @param	instance - A pointer to the instance of the node.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @retval	None.
+ */
+static void benchmarkReceiveETP(J1939_instance* instance, uint32_t canId, const uint8_t* data)
+{
+	J1939_ETP_session* session = NULL;
+	J1939_status status;
+	uint8_t sentPackages;
+
+	if(BENCHMARK_GET_PDU_FORMAT(canId) == J1939_ETP_CONNECTION_MANAGEMENT)
+	{
+		status = J1939_readETP_connectionManagement(instance, canId, data, &session);
+
+		switch(status)
+		{
+			case J1939_STATUS_GOT_RTS_MESSAGE:
+				J1939_setETPsink(session, benchmarkETPsink, NULL);
+				J1939_sendETP_connectionManagement(session, J1939_TP_TYPE_CTS);
+				break;
+
+			case J1939_STATUS_GOT_CTS_MESSAGE:
+				J1939_sendETP_dataTransferBurst(session, &sentPackages);
+				results.tx_calls++;
+				break;
+
+			case J1939_STATUS_GOT_EOM_MESSAGE:
+				J1939_clearETPstructures(session);
+				results.pending_tx = 0U;
+				break;
+
+			case J1939_STATUS_GOT_ABORT_SESSION:
+				if(session->type == J1939_ETP_SESSION_TX) results.pending_tx = 0U;
+				J1939_clearETPstructures(session);
+				results.aborted++;
+				break;
+
+			case J1939_ERROR_BUSY:
+			case J1939_ERROR_TOO_BIG_MESSAGE:
+				if(session != NULL) J1939_clearETPstructures(session);
+				results.errors++;
+				break;
+
+			default:
+				break;
+		}
+	} else
+	{
+		status = J1939_readETP_dataTransfer(instance, canId, data, &session);
+
+		if(status == J1939_STATUS_CTS)
+		{
+			J1939_sendETP_connectionManagement(session, J1939_TP_TYPE_CTS);
+		} else if(status == J1939_STATUS_DATA_FINISHED)
+		{
+			J1939_sendETP_connectionManagement(session, J1939_TP_TYPE_END_OF_MSG);
+			(results.etp_corrupted == 0U) ? results.completed++ : results.corrupted++;
+			J1939_clearETPstructures(session);
+		} else if(status == J1939_ERROR_MISSING_PACKAGES)
+		{
+			J1939_setETPabortReason(session, J1939_REASON_RETRANSMIT_LIMIT);
+			J1939_sendETP_connectionManagement(session, J1939_TP_TYPE_ABORT);
+			J1939_clearETPstructures(session);
+			results.errors++;
+		}
+	}
+}
+
+/**
+ * @brief 	This function is used to process frames delivered by the virtual bus, as the application does.
+ * @param	context - A pointer to the benchmark node.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	None.
+ */
+static void benchmarkReceive(void* context, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	benchmarkNode* node = (benchmarkNode*)context;
+	J1939_TP_session* session = NULL;
+	J1939_status status;
+	uint8_t sentPackages;
+
+	(void)dlc;
+
+	if((BENCHMARK_GET_PDU_SPECIFIC(canId) != J1939_BROADCAST_ADDRESS) && \
+	   (BENCHMARK_GET_PDU_SPECIFIC(canId) != node->address)) return;
+
+	switch(BENCHMARK_GET_PDU_FORMAT(canId))
+	{
+		case J1939_CONNECTION_MANAGEMENT:
+			status = J1939_readTP_connectionManagement(&node->instance, canId, data, &session);
+
+			switch(status)
+			{
+				case J1939_STATUS_GOT_RTS_MESSAGE:
+					J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_CTS);
+					break;
+
+				case J1939_STATUS_GOT_CTS_MESSAGE:
+					// The whole window is sent in one call
+					J1939_sendTP_dataTransferBurst(session, &sentPackages);
+					results.tx_calls++;
+					break;
+
+				case J1939_STATUS_GOT_EOM_MESSAGE:
+					J1939_clearTPstructures(session);
+					results.pending_tx = 0U;
+					break;
+
+				case J1939_STATUS_GOT_ABORT_SESSION:
+					if(session->type == J1939_TP_SESSION_TX) results.pending_tx = 0U;
+					J1939_freeAllocatedMemory(session);
+					J1939_clearTPstructures(session);
+					results.aborted++;
+					break;
+
+				case J1939_ERROR_BUSY:
+				case J1939_ERROR_MEMORY_ALLOCATION:
+				case J1939_ERROR_TOO_BIG_MESSAGE:
+					if((session != NULL) && (session->type == J1939_TP_SESSION_PTP_RX))
+					{
+						J1939_setAbortReason(session, J1939_REASON_MEMORY_ALLOCATION_ERROR, J1939_USE_CURRENT_DA);
+						J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_ABORT);
+					}
+
+					if(session != NULL) J1939_clearTPstructures(session);
+					results.errors++;
+					break;
+
+				default:
+					break;
+			}
+			break;
+
+		case J1939_ETP_CONNECTION_MANAGEMENT:
+		case J1939_ETP_DATA_TRANSFER:
+			benchmarkReceiveETP(&node->instance, canId, data);
+			break;
+
+		case J1939_DATA_TRANSFER:
+			status = J1939_readTP_dataTransfer(&node->instance, canId, data, &session);
+
+			if(status == J1939_STATUS_CTS)
+			{
+				J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_CTS);
+			} else if(status == J1939_STATUS_DATA_FINISHED)
+			{
+				if(session->type == J1939_TP_SESSION_PTP_RX)
+				{
+					J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_END_OF_MSG);
+				}
+
+				benchmarkFinishReceiving(session);
+			} else if(status == J1939_ERROR_MISSING_PACKAGES)
+			{
+				if(session->type == J1939_TP_SESSION_PTP_RX)
+				{
+					J1939_setAbortReason(session, J1939_REASON_RETRANSMIT_LIMIT, J1939_USE_CURRENT_DA);
+					J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_ABORT);
+				}
+
+				J1939_freeAllocatedMemory(session);
+				J1939_clearTPstructures(session);
+				results.errors++;
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief 	This function is used to lose every BENCHMARK_LOST_PACKAGE_PERIOD data transfer package.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	1 if the frame is lost, 0 otherwise.
+ */
+static uint8_t benchmarkLoseFrame(uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	(void)data;
+	(void)dlc;
+
+	if((BENCHMARK_GET_PDU_FORMAT(canId) != J1939_DATA_TRANSFER) && \
+	   (BENCHMARK_GET_PDU_FORMAT(canId) != J1939_ETP_DATA_TRANSFER)) return 0U;
+
+	return ((++dataPackages % BENCHMARK_LOST_PACKAGE_PERIOD) == 0U) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is used to lose every copy of the last data transfer package of the message.
+ * 			The last ETP package of BENCHMARK_ETP_LIMIT_SIZE bytes is told by its padding.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	1 if the frame is lost, 0 otherwise.
+ */
+static uint8_t benchmarkLoseLastPackage(uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	static const uint8_t padding[6] = {0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU};
+
+	(void)dlc;
+
+	if(BENCHMARK_GET_PDU_FORMAT(canId) == J1939_ETP_DATA_TRANSFER) return (memcmp(&data[2], padding, sizeof(padding)) == 0) ? 1U : 0U;
+
+	return ((BENCHMARK_GET_PDU_FORMAT(canId) == J1939_DATA_TRANSFER) && \
+			(data[0] == ((messageSize + 6U) / 7U))) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is used to process the timers of both nodes.
+ * @retval	The time until the nearest deadline of the nodes, ms. J1939_TIMER_NO_DEADLINE if no timer is armed.
+ */
+static uint32_t benchmarkProcessTimers(void)
+{
+	uint32_t senderSleepTime	= J1939_processTimers(&sender.instance);
+	uint32_t receiverSleepTime	= J1939_processTimers(&receiver.instance);
+
+	return (senderSleepTime < receiverSleepTime) ? senderSleepTime : receiverSleepTime;
+}
+
+/**
+ * @brief 	This function is used to send one multi-packet message and to deliver all frames it causes.
+ * @param	destinationAddress - The receiver address or the broadcast address.
+ * @retval	None.
+ */
+static void benchmarkSendMessage(uint8_t destinationAddress)
+{
+	J1939_TP_session* session;
+	uint32_t sleepTime;
+
+	results.streamed_bytes		= 0U;
+	results.stream_corrupted	= 0U;
+
+	session = J1939_fillTPstructures(&sender.instance, message, messageSize, BENCHMARK_PGN, destinationAddress);
+	if(session == NULL)
+	{
+		results.errors++;
+		return;
+	}
+
+	results.pending_tx = 1U;
+
+	J1939_sendTP_connectionManagement(session, (destinationAddress == J1939_BROADCAST_ADDRESS) ? \
+											   J1939_TP_TYPE_BAM : J1939_TP_TYPE_RTS);
+	J1939_hostProcessBus();
+
+	// BAM packages and requests of lost packages are sent by the timer wheel, the task sleeps until the next deadline
+	while(results.pending_tx != 0U)
+	{
+		sleepTime = benchmarkProcessTimers();
+		results.tx_calls++;
+		J1939_hostProcessBus();
+
+		if((results.pending_tx == 0U) || (sleepTime == J1939_TIMER_NO_DEADLINE)) break;
+		J1939_hostAdvanceTime((uint64_t)sleepTime * 1000U);
+	}
+
+	// The session must be closed by the end of message acknowledgment
+	if(results.pending_tx != 0U)
+	{
+		J1939_clearTPstructures(session);
+		results.pending_tx = 0U;
+		results.errors++;
+	}
+}
+
+/**
+ * @brief 	This function is used to stream one ETP message and to deliver all frames it causes.
+ * @param	size - The message size.
+ * @retval	None.
+ */
+static void benchmarkStreamMessage(uint32_t size)
+{
+	J1939_ETP_session* session;
+	uint32_t sleepTime;
+	uint16_t packages;
+
+	results.etp_received_bytes	= 0U;
+	results.etp_corrupted		= 0U;
+
+	session = J1939_fillETPstructures(&sender.instance, size, BENCHMARK_PGN, receiver.address, benchmarkETPsource, NULL);
+	if(session == NULL)
+	{
+		results.errors++;
+		return;
+	}
+
+	results.pending_tx = 1U;
+
+	J1939_sendETP_connectionManagement(session, J1939_TP_TYPE_RTS);
+	J1939_hostProcessBus();
+
+	// Requests of lost packages are sent by the receiver's timers, the windows limited by the TX slots are continued
+	while(results.pending_tx != 0U)
+	{
+		sleepTime	= benchmarkProcessTimers();
+		packages	= J1939_sendETPpendingPackages(&sender.instance);
+		J1939_hostProcessBus();
+
+		if(results.pending_tx == 0U) break;
+		if(packages > 0U) continue;
+		if(sleepTime == J1939_TIMER_NO_DEADLINE) break;
+		J1939_hostAdvanceTime((uint64_t)sleepTime * 1000U);
+	}
+
+	if(results.pending_tx != 0U)
+	{
+		J1939_clearETPstructures(session);
+		results.pending_tx = 0U;
+		results.errors++;
+	}
+}
+
+/**
+ * @brief 	This function is used to run and report one ETP benchmark case.
+ * @param	mode - The name of the case.
+ * @param	size - The message size.
+ * @param	iterations - The number of messages.
+ * @param	lossy - 1 if data transfer packages are lost, 0 - no package may be requested again.
+ * @retval	0 if all messages have been received correctly, 1 otherwise.
+ */
+static int benchmarkRunETP(const char* mode, uint32_t size, uint32_t iterations, uint8_t lossy)
+{
+	uint32_t retransmissions = receiver.instance.statistics.sessions[J1939_STATISTICS_ETP_RX].retransmitted_packages;
+	benchmarkMeasurement measurement;
+	uint64_t payloadBytes = (uint64_t)size * iterations;
+
+	memset(&results, 0, sizeof(results));
+
+	benchmarkStartMeasurement(&measurement);
+
+	for(uint32_t i = 0U; i < iterations; i++) benchmarkStreamMessage(size);
+
+	benchmarkStopMeasurement(&measurement);
+
+	printf("%-8s %8u %8u %12.2f %12.0f %12.1f %10zu %8llu %6u/%u\n",
+		   mode,
+		   size,
+		   iterations,
+		   (double)payloadBytes / (measurement.wall_time * 1e6),
+		   (double)measurement.bus_time / (1000.0 * iterations),
+		   (100.0 * 8.0 * (double)payloadBytes) / (double)measurement.counters.bus_bits,
+		   (size_t)(J1939_MAX_ETP_RX_SESSIONS + J1939_MAX_ETP_TX_SESSIONS) * sizeof(J1939_ETP_session),
+		   (unsigned long long)measurement.counters.lost_frames,
+		   results.completed, iterations);
+
+	// Without lost packages every window must be sent at once
+	retransmissions = receiver.instance.statistics.sessions[J1939_STATISTICS_ETP_RX].retransmitted_packages - retransmissions;
+
+	return ((results.completed == iterations) && (results.corrupted == 0U) && ((lossy == 1U) || (retransmissions == 0U))) ? 0 : 1;
+}
+
+/**
+ * @brief 	This function is used to get the peak memory used for receive buffers.
+ * @param	counters - A pointer to the host counters.
+ * @retval	The peak in bytes.
+ */
+static size_t benchmarkGetPeakMemory(const J1939_hostCounters* counters)
+{
+	size_t peak = counters->heap_peak;
+	J1939_poolStatistics statistics;
+
+	for(uint8_t i = 0U; i < J1939_POOL_CLASS_HEAP; i++)
+	{
+		J1939_getPoolStatistics(&receiver.instance, (J1939_poolClasses)i, &statistics);
+		peak += (size_t)statistics.max_used_blocks * statistics.block_size;
+	}
+
+	return peak;
+}
+
+/**
+ * @brief 	This function is used to run and report one benchmark case.
+ * @param	mode - The name of the case.
+ * @param	destinationAddress - The receiver address or the broadcast address.
+ * @param	size - The message size.
+ * @param	iterations - The number of messages.
+ * @retval	0 if all messages have been received correctly, 1 otherwise.
+ */
+static int benchmarkRun(const char* mode, uint8_t destinationAddress, uint16_t size, uint32_t iterations)
+{
+	benchmarkMeasurement measurement;
+	uint64_t payloadBytes = (uint64_t)size * iterations;
+
+	memset(&results, 0, sizeof(results));
+	messageSize = size;
+
+	J1939_resetPoolStatistics(&sender.instance);
+	J1939_resetPoolStatistics(&receiver.instance);
+
+	benchmarkStartMeasurement(&measurement);
+
+	for(uint32_t i = 0U; i < iterations; i++)
+	{
+		message[0] = (uint8_t)i;
+		benchmarkSendMessage(destinationAddress);
+	}
+
+	benchmarkStopMeasurement(&measurement);
+
+	printf("%-8s %5u %12.0f %12.0f %10.2f %10.2f %12.2f %10.2f %10zu %8llu %6u/%u\n",
+		   mode,
+		   size,
+		   (double)iterations / measurement.wall_time,
+		   (double)measurement.counters.frames / measurement.wall_time,
+		   (double)measurement.counters.copied_bytes / (double)payloadBytes,
+		   (double)measurement.counters.bus_copied_bytes / (double)payloadBytes,
+		   (double)measurement.bus_time / (1000.0 * iterations),
+		   (double)results.tx_calls / (double)iterations,
+		   benchmarkGetPeakMemory(&measurement.counters),
+		   (unsigned long long)measurement.counters.lost_frames,
+		   results.completed, iterations);
+
+	return ((results.completed == iterations) && (results.corrupted == 0U)) ? 0 : 1;
+}
+
+/**
+ * @brief 	This function is used to deliver a made-up announcement and the first data transfer packages
+ * 			of the sender to the receiver.
+ * @param	destinationAddress - The receiver address for RTS or the broadcast address for BAM.
+ * @param	size - The announced message size.
+ * @param	numberOfPackages - The announced number of packages.
+ * @param	sentPackages - The number of data transfer packages delivered after the announcement.
+ * @retval	None.
+ */
+static void benchmarkInjectMessage(uint8_t destinationAddress, uint16_t size, uint8_t numberOfPackages, uint8_t sentPackages)
+{
+	uint8_t data[BENCHMARK_CAN_DLC];
+
+	data[0] = (destinationAddress == J1939_BROADCAST_ADDRESS) ? J1939_CONTROL_BYTE_TP_CM_BAM : J1939_CONTROL_BYTE_TP_CM_RTS;
+	data[1] = (uint8_t)size;
+	data[2] = (uint8_t)(size >> 8U);
+	data[3] = numberOfPackages;
+	data[4] = 0xFFU;
+	data[5] = (uint8_t)BENCHMARK_PGN;
+	data[6] = (uint8_t)(BENCHMARK_PGN >> 8U);
+	data[7] = (uint8_t)(BENCHMARK_PGN >> 16U);
+	benchmarkReceive(&receiver, ((uint32_t)J1939_CONNECTION_MANAGEMENT << 16U) | ((uint32_t)destinationAddress << 8U) | \
+								sender.address, data, BENCHMARK_CAN_DLC);
+
+	memset(data, 0xAAU, sizeof(data));
+	for(uint8_t sequenceNumber = 1U; sequenceNumber <= sentPackages; sequenceNumber++)
+	{
+		data[0] = sequenceNumber;
+		benchmarkReceive(&receiver, ((uint32_t)J1939_DATA_TRANSFER << 16U) | ((uint32_t)destinationAddress << 8U) | \
+									sender.address, data, BENCHMARK_CAN_DLC);
+	}
+}
+
+/**
+ * @brief 	This function is used to announce messages whose size doesn't fit the number of packages and to
+ * 			send their data transfer packages anyway. The receiver must reject them without writing a byte.
+ * @retval	0 if all announcements have been rejected, 1 otherwise.
+ */
+static int benchmarkRunMalformed(void)
+{
+	// Size, number of packages and destination of each announcement
+	static const uint16_t announcements[][3] = {{64U, 255U, J1939_BROADCAST_ADDRESS}, {64U, 5U, J1939_BROADCAST_ADDRESS},
+												{8U, 2U, J1939_BROADCAST_ADDRESS}, {64U, 255U, BENCHMARK_RECEIVER_ADDRESS}};
+	uint32_t allocations = 0U;
+	uint8_t count = sizeof(announcements) / sizeof(announcements[0]);
+	J1939_poolStatistics statistics;
+
+	memset(&results, 0, sizeof(results));
+	J1939_resetPoolStatistics(&receiver.instance);
+	J1939_hostSetLossFilter(NULL);
+
+	// The messages would be received to the buffers
+	J1939_registerTPsink(&receiver.instance, BENCHMARK_PGN, NULL, NULL);
+
+	// The packages past the announced size would be written past the buffer
+	for(uint8_t i = 0U; i < count; i++)
+	{
+		benchmarkInjectMessage((uint8_t)announcements[i][2], announcements[i][0], (uint8_t)announcements[i][1], 40U);
+	}
+
+	// The abort of the RTS session goes to the sender
+	J1939_hostProcessBus();
+
+	for(uint8_t i = 0U; i < J1939_POOL_CLASS_HEAP; i++)
+	{
+		J1939_getPoolStatistics(&receiver.instance, (J1939_poolClasses)i, &statistics);
+		allocations += statistics.allocations;
+	}
+
+	printf("\n%-8s %u/%u rejected, %u completed, %u buffers allocated\n", "invalid", results.errors, count,
+		   results.completed + results.corrupted, allocations);
+
+	return ((results.errors == count) && (results.completed == 0U) && (results.corrupted == 0U) && (allocations == 0U)) ? 0 : 1;
+}
+
+/**
+ * @brief 	This function is used to send and to announce ETP messages of the largest TP size and of the
+ * 			smallest ETP size. The messages which fit TP must be rejected on both sides.
+ * @retval	0 if only the messages above 1785 bytes have been accepted, 1 otherwise.
+ */
+static int benchmarkRunETPsizes(void)
+{
+	static const uint32_t sizes[] = {J1939_ETP_MIN_LENGTH_MESSAGE - 1U, J1939_ETP_MIN_LENGTH_MESSAGE};
+	uint8_t data[BENCHMARK_CAN_DLC] = {J1939_CONTROL_BYTE_ETP_CM_RTS, 0U, 0U, 0U, 0U, (uint8_t)BENCHMARK_PGN,
+									   (uint8_t)(BENCHMARK_PGN >> 8U), (uint8_t)(BENCHMARK_PGN >> 16U)};
+	J1939_ETP_session* session;
+	uint8_t sent = 0U, received = 0U;
+
+	memset(&results, 0, sizeof(results));
+
+	for(uint8_t i = 0U; i < (sizeof(sizes) / sizeof(sizes[0])); i++)
+	{
+		// The sender opens a session for the message
+		session = J1939_fillETPstructures(&sender.instance, sizes[i], BENCHMARK_PGN, receiver.address, benchmarkETPsource, NULL);
+
+		if(session != NULL)
+		{
+			J1939_clearETPstructures(session);
+			sent++;
+		}
+
+		// The receiver gets RTS of the message
+		data[1] = (uint8_t)sizes[i];
+		data[2] = (uint8_t)(sizes[i] >> 8U);
+		benchmarkReceive(&receiver, ((uint32_t)J1939_ETP_CONNECTION_MANAGEMENT << 16U) | ((uint32_t)receiver.address << 8U) | \
+						 sender.address, data, BENCHMARK_CAN_DLC);
+
+		// The accepted session is aborted by the sender
+		if(receiver.instance.statistics.sessions[J1939_STATISTICS_ETP_RX].active > 0U)
+		{
+			received++;
+			J1939_sendETP_abort(&sender.instance, receiver.address, BENCHMARK_PGN, J1939_REASON_TIMEOUT);
+		}
+
+		J1939_hostProcessBus();
+	}
+
+	printf("%-8s %u/1 sent, %u/1 announced, %u/1 rejected\n", "ETP size", sent, received, results.errors);
+
+	return ((sent == 1U) && (received == 1U) && (results.errors == 1U)) ? 0 : 1;
+}
+
+/**
+ * @brief 	This function is used to break off a broadcast message and to broadcast the message again.
+ * 			The new message must replace the unfinished one of the same sender.
+ * @retval	0 if the new message has been received, 1 otherwise.
+ */
+static int benchmarkRunRestarted(void)
+{
+	J1939_sessionStatistics* statistics = &receiver.instance.statistics.sessions[J1939_STATISTICS_TP_BAM_RX];
+	uint32_t replaced = statistics->aborts[J1939_ABORT_SLOT_OTHER];
+
+	memset(&results, 0, sizeof(results));
+	messageSize = 64U;
+
+	benchmarkInjectMessage(J1939_BROADCAST_ADDRESS, messageSize, (uint8_t)((messageSize + 6U) / 7U), 3U);
+	benchmarkSendMessage(J1939_BROADCAST_ADDRESS);
+
+	replaced = statistics->aborts[J1939_ABORT_SLOT_OTHER] - replaced;
+
+	printf("%-8s %u/1 completed, %u replaced\n", "restart", results.completed, replaced);
+
+	return ((results.completed == 1U) && (results.corrupted == 0U) && (replaced == 1U)) ? 0 : 1;
+}
+
+/**
+ * @brief 	This function is used to send a TP and an ETP message whose last package is always lost. The receiver
+ * 			must abort the session by the retransmit limit, not by the timeout.
+ * @retval	0 if the sessions have been aborted by the retransmit limit on both sides, 1 otherwise.
+ */
+static int benchmarkRunRetransmitLimit(void)
+{
+	static const char* const modeNames[] = {"limit", "ETP lim"};
+	int failures = 0;
+
+	J1939_hostSetLossFilter(benchmarkLoseLastPackage);
+
+	for(uint8_t mode = 0U; mode < 2U; mode++)
+	{
+		J1939_sessionStatistics* receiverStatistics = &receiver.instance.statistics.sessions[(mode == 0U) ? J1939_STATISTICS_TP_PTP_RX : \
+																										   J1939_STATISTICS_ETP_RX];
+		J1939_sessionStatistics* senderStatistics = &sender.instance.statistics.sessions[(mode == 0U) ? J1939_STATISTICS_TP_PTP_TX : \
+																									   J1939_STATISTICS_ETP_TX];
+		uint32_t limits = receiverStatistics->aborts[J1939_ABORT_SLOT_RETRANSMIT_LIMIT];
+		uint32_t timeouts = receiverStatistics->aborts[J1939_ABORT_SLOT_TIMEOUT];
+		uint32_t peerLimits = senderStatistics->aborts[J1939_ABORT_SLOT_RETRANSMIT_LIMIT];
+
+		memset(&results, 0, sizeof(results));
+		messageSize = 64U;
+
+		(mode == 0U) ? benchmarkSendMessage(receiver.address) : benchmarkStreamMessage(BENCHMARK_ETP_LIMIT_SIZE);
+
+		limits		= receiverStatistics->aborts[J1939_ABORT_SLOT_RETRANSMIT_LIMIT] - limits;
+		timeouts	= receiverStatistics->aborts[J1939_ABORT_SLOT_TIMEOUT] - timeouts;
+		peerLimits	= senderStatistics->aborts[J1939_ABORT_SLOT_RETRANSMIT_LIMIT] - peerLimits;
+
+		printf("%-8s %u/1 aborted by the retransmit limit, %u by the timeout, %u/1 received by the sender\n", modeNames[mode],
+			   limits, timeouts, peerLimits);
+
+		if((limits != 1U) || (timeouts != 0U) || (peerLimits != 1U) || (results.completed != 0U)) failures++;
+	}
+
+	J1939_hostSetLossFilter(NULL);
+
+	return (failures == 0) ? 0 : 1;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	static const uint16_t sizes[] = {9U, 16U, 64U, 256U, 512U, 1024U, 1785U};
+	static const uint32_t etpSizes[] = {4096U, 65536U, 1048576U};
+	uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_ITERATIONS;
+	int failures = 0;
+
+	if(iterations == 0U) iterations = BENCHMARK_DEFAULT_ITERATIONS;
+
+	for(uint16_t i = 0U; i < BENCHMARK_MAX_MESSAGE_SIZE; i++) message[i] = (uint8_t)(i * 7U + 1U);
+
+	J1939_hostInit(J1939_HOST_DEFAULT_BITRATE);
+	sender.node		= J1939_hostAddNode(benchmarkReceive, &sender);
+	receiver.node	= J1939_hostAddNode(benchmarkReceive, &receiver);
+
+	// Every node runs its own stack on its channel
+	for(uint8_t i = 0U; i < 2U; i++)
+	{
+		benchmarkNode* node = (i == 0U) ? &sender : &receiver;
+
+		J1939_initInstance(&node->instance, node->node);
+		J1939_setCurrentECUAddress(&node->instance, node->address);
+		J1939_setTPcallback(&node->instance, benchmarkSessionClosed);
+		J1939_setETPcallback(&node->instance, benchmarkETPsessionClosed);
+	}
+
+	printf("SAE J1939-21 transport protocol benchmark, %u messages per case, virtual bus %u bit/s\n",
+		   iterations, J1939_HOST_DEFAULT_BITRATE);
+	printf("%-8s %5s %12s %12s %10s %10s %12s %10s %10s %8s %8s\n",
+		   "mode", "bytes", "sessions/s", "frames/s", "copy/B", "bus copy/B", "bus ms/msg", "tx calls", "peak RAM",
+		   "lost", "done");
+
+	for(uint8_t mode = 0U; mode < 5U; mode++)
+	{
+		static const char* const modeNames[] = {"BAM", "RTS/CTS", "RTS lost", "BAM sink", "RTS sink"};
+		uint8_t destinationAddress = ((mode == 0U) || (mode == 3U)) ? J1939_BROADCAST_ADDRESS : receiver.address;
+
+		// Every BENCHMARK_LOST_PACKAGE_PERIOD data transfer package is lost in the third case
+		J1939_hostSetLossFilter((mode == 2U) ? benchmarkLoseFrame : NULL);
+
+		// The last cases stream the packages to the sink instead of the receive buffer
+		J1939_registerTPsink(&receiver.instance, BENCHMARK_PGN, (mode >= 3U) ? benchmarkTPsink : NULL, NULL);
+
+		for(uint8_t i = 0U; i < (sizeof(sizes) / sizeof(sizes[0])); i++)
+		{
+			failures += benchmarkRun(modeNames[mode], destinationAddress, sizes[i], iterations);
+		}
+	}
+
+	// ETP messages are streamed with constant RAM, the number of messages is reduced in proportion to the size
+	printf("\n%-8s %8s %8s %12s %12s %12s %10s %8s %8s\n",
+		   "mode", "bytes", "messages", "MB/s", "bus ms/msg", "payload %", "ETP RAM", "lost", "done");
+
+	for(uint8_t mode = 0U; mode < 3U; mode++)
+	{
+		static const char* const etpModeNames[] = {"ETP", "ETP lost", "ETP slot"};
+
+		J1939_hostSetLossFilter((mode == 1U) ? benchmarkLoseFrame : NULL);
+
+		// The sender of the last case has BENCHMARK_TX_SLOTS TX slots and loses every second DPO
+		if(mode == 2U) J1939_setTxHooks(&sender.instance, benchmarkSendFrame, benchmarkGetFreeTxSlots);
+
+		for(uint8_t i = 0U; i < (sizeof(etpSizes) / sizeof(etpSizes[0])); i++)
+		{
+			uint32_t etpIterations = (uint32_t)(((uint64_t)iterations * BENCHMARK_MAX_MESSAGE_SIZE) / etpSizes[i]);
+
+			failures += benchmarkRunETP(etpModeNames[mode], etpSizes[i], (etpIterations > 0U) ? etpIterations : 1U, (mode == 1U) ? 1U : 0U);
+		}
+	}
+
+	J1939_setTxHooks(&sender.instance, NULL, NULL);
+
+	failures += benchmarkRunMalformed();
+	failures += benchmarkRunETPsizes();
+	failures += benchmarkRunRestarted();
+	failures += benchmarkRunRetransmitLimit();
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,291 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_TX_Scheduler_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Simulation of the priority-aware TX scheduler. The ECU sends
+  * 		 RTS/CTS messages to a peer back to back and a priority 3 control
+  * 		 message every 10 ms through a CAN controller with three TX
+  * 		 mailboxes. The time from sending the control message to its
+  * 		 reception is reported with the frames going to the mailboxes in
+  * 		 the order they are sent and with the TX scheduler.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Port_Host.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_ECU_ADDRESS					(0x10U)
+#define BENCHMARK_PEER_ADDRESS					(0x20U)
+#define BENCHMARK_TP_PGN						(0x00FF00UL)
+#define BENCHMARK_CONTROL_PGN					(0x00FF10UL)
+#define BENCHMARK_CONTROL_PRIORITY				(3U)
+#define BENCHMARK_CONTROL_PERIOD				(10000U)	// us
+#define BENCHMARK_MESSAGE_SIZE					(1785U)
+#define BENCHMARK_MAILBOXES						(3U)		// As bxCAN of STM32F4
+#define BENCHMARK_IDLE_STEP						(100U)		// us
+#define BENCHMARK_DEFAULT_TIME					(2000U)		// ms
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A TX mailbox of the CAN controller of the ECU.
+ */
+typedef struct
+{
+	uint32_t can_id;
+	uint32_t sequence;						/* The order of queuing */
+	uint8_t dlc;
+	uint8_t data[8];
+	uint8_t full;
+} benchmarkMailbox;
+
+/**
+ * @brief Results of a benchmark run.
+ */
+typedef struct
+{
+	uint32_t control_sent;					/* Control messages sent by the application */
+	benchmarkLatency latency;				/* The times from sending to reception of the control messages received by the peer, us */
+	uint32_t messages;						/* TP messages received by the peer */
+} benchmarkResults;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static J1939_instance ecu;
+static J1939_instance peer;
+static uint8_t ecuNode;
+static benchmarkMailbox mailboxes[BENCHMARK_MAILBOXES];
+static uint32_t mailboxSequence = 0U;
+static benchmarkResults results;
+static uint64_t controlSendTime = 0U;
+static uint8_t message[BENCHMARK_MESSAGE_SIZE];
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is the TX hook of the ECU: the frame is put into a free TX mailbox.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+static uint8_t benchmarkMailboxSend(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	(void)channel;
+
+	for(uint8_t i = 0U; i < BENCHMARK_MAILBOXES; i++)
+	{
+		if(mailboxes[i].full != 0U) continue;
+
+		mailboxes[i].can_id		= canId;
+		mailboxes[i].sequence	= mailboxSequence++;
+		mailboxes[i].dlc		= dlc;
+		mailboxes[i].full		= 1U;
+		memcpy(mailboxes[i].data, data, dlc);
+
+		return J1939_PORT_FRAME_QUEUED;
+	}
+
+	return J1939_PORT_FRAME_NOT_QUEUED;
+}
+
+/**
+ * @brief 	This function is the TX hook of the ECU: the number of free TX mailboxes.
+ * @retval	The number of free mailboxes.
+ */
+static uint8_t benchmarkMailboxGetFree(uint8_t channel)
+{
+	uint8_t freeMailboxes = 0U;
+
+	(void)channel;
+
+	for(uint8_t i = 0U; i < BENCHMARK_MAILBOXES; i++) freeMailboxes += (mailboxes[i].full == 0U) ? 1U : 0U;
+
+	return freeMailboxes;
+}
+
+/**
+ * @brief 	This function is used to transmit the mailbox with the lowest CAN ID, as the controller does.
+ * 			Frames with the same CAN ID are transmitted in the order of queuing.
+ * @retval	1 if a frame is put on the bus, 0 if the mailboxes are empty.
+ */
+static uint8_t benchmarkMailboxTransmit(void)
+{
+	benchmarkMailbox* next = NULL;
+
+	for(uint8_t i = 0U; i < BENCHMARK_MAILBOXES; i++)
+	{
+		if(mailboxes[i].full == 0U) continue;
+
+		if((next == NULL) || (mailboxes[i].can_id < next->can_id) || \
+		   ((mailboxes[i].can_id == next->can_id) && (mailboxes[i].sequence < next->sequence))) next = &mailboxes[i];
+	}
+
+	if(next == NULL) return 0U;
+
+	J1939_portSendFrame(ecuNode, next->can_id, next->data, next->dlc);
+	next->full = 0U;
+
+	return 1U;
+}
+
+/**
+ * @brief 	This function is the handler of the control message of the peer.
+ * @retval	None.
+ */
+static void benchmarkControlHandler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+									const uint8_t* data, uint16_t size)
+{
+	(void)context;
+	(void)PGN;
+	(void)sourceAddress;
+	(void)destinationAddress;
+	(void)data;
+	(void)size;
+
+	benchmarkAddLatency(&results.latency, J1939_hostGetTime() - controlSendTime);
+}
+
+/**
+ * @brief 	This function is the handler of the TP messages of the peer.
+ * @retval	None.
+ */
+static void benchmarkMessageHandler(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+									const uint8_t* data, uint16_t size)
+{
+	(void)context;
+	(void)PGN;
+	(void)sourceAddress;
+	(void)destinationAddress;
+
+	if((size == BENCHMARK_MESSAGE_SIZE) && (memcmp(data, message, size) == 0)) results.messages++;
+}
+
+/**
+ * @brief 	This function is used to run and report one benchmark case.
+ * @param	mode - The name of the case.
+ * @param	scheduler - 1 - the TX scheduler is enabled, 0 - the frames go to the mailboxes.
+ * @param	time - The simulation time, ms.
+ * @retval	The longest latency of the control message, us. 0 if a control message is lost.
+ */
+static uint64_t benchmarkRun(const char* mode, uint8_t scheduler, uint32_t time)
+{
+	static const uint8_t controlData[8] = {0x11U, 0x22U, 0x33U, 0x44U, 0x55U, 0x66U, 0x77U, 0x88U};
+	uint32_t controlId = ((uint32_t)BENCHMARK_CONTROL_PRIORITY << 26U) | (BENCHMARK_CONTROL_PGN << 8U) | BENCHMARK_ECU_ADDRESS;
+	uint64_t endTime = J1939_hostGetTime() + ((uint64_t)time * 1000U);
+	uint64_t nextControlTime = J1939_hostGetTime();
+	uint8_t controlPending = 0U;
+	J1939_TP_session* session;
+	J1939_txStatistics statistics;
+
+	memset(&results, 0, sizeof(results));
+	(scheduler != 0U) ? J1939_enableTxScheduler(&ecu) : J1939_disableTxScheduler(&ecu);
+	J1939_resetTxStatistics(&ecu);
+
+	while(J1939_hostGetTime() < endTime)
+	{
+		// The application sends the control message on time and retries it while it isn't queued
+		if((controlPending == 0U) && (J1939_hostGetTime() >= nextControlTime))
+		{
+			controlPending	= 1U;
+			controlSendTime	= J1939_hostGetTime();
+			nextControlTime	+= BENCHMARK_CONTROL_PERIOD;
+			results.control_sent++;
+		}
+
+		if((controlPending != 0U) && (J1939_sendFrame(&ecu, controlId, controlData, 8U) == J1939_PORT_FRAME_QUEUED))
+		{
+			controlPending = 0U;
+		}
+
+		// The next message is sent as soon as the previous session is closed and RTS can be queued
+		if(J1939_getFreeTxSlots(&ecu) > 0U)
+		{
+			session = J1939_fillTPstructures(&ecu, message, BENCHMARK_MESSAGE_SIZE, BENCHMARK_TP_PGN, BENCHMARK_PEER_ADDRESS);
+			if(session != NULL) J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_RTS);
+		}
+
+		if(benchmarkMailboxTransmit() == 0U) J1939_hostAdvanceTime(BENCHMARK_IDLE_STEP);
+		J1939_hostProcessBus();
+
+		// The TX mailbox empty interrupt
+		J1939_processTxQueue(&ecu);
+		J1939_sendTPpendingPackages(&ecu);
+
+		J1939_processTimers(&ecu);
+		J1939_processTimers(&peer);
+	}
+
+	printf("%-10s %8u %8u %12.0f %12llu %10u\n",
+		   mode, results.control_sent, results.latency.samples, benchmarkGetAverageLatency(&results.latency),
+		   (unsigned long long)results.latency.max, results.messages);
+
+	if(scheduler != 0U)
+	{
+		for(uint8_t priority = 0U; priority < J1939_NUMBER_OF_PRIORITIES; priority++)
+		{
+			J1939_getTxStatistics(&ecu, priority, &statistics);
+			if(statistics.frames == 0U) continue;
+
+			printf("  priority %u: %8u frames %6u dropped %4u max queued %8.2f ms mean %6u ms max\n",
+				   priority, statistics.frames, statistics.dropped, statistics.max_queued,
+				   (double)statistics.total_latency / statistics.frames, statistics.max_latency);
+		}
+	}
+
+	// Every control message but the last one must be received
+	if((results.latency.samples + 1U < results.control_sent) || (results.messages == 0U)) return 0U;
+
+	return (results.latency.max > 0U) ? results.latency.max : 1U;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	uint32_t time = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_TIME;
+	uint64_t fifoLatency, schedulerLatency;
+
+	if(time == 0U) time = BENCHMARK_DEFAULT_TIME;
+
+	for(uint16_t i = 0U; i < BENCHMARK_MESSAGE_SIZE; i++) message[i] = (uint8_t)(i * 7U + 1U);
+
+	J1939_hostInit(J1939_HOST_DEFAULT_BITRATE);
+	ecuNode = J1939_hostAddNode(benchmarkDispatch, &ecu);
+	J1939_initInstance(&ecu, ecuNode);
+	benchmarkAddNode(&peer);
+
+	// The frames of the ECU go to the TX mailboxes of the simulated controller
+	J1939_setTxHooks(&ecu, benchmarkMailboxSend, benchmarkMailboxGetFree);
+	J1939_setCurrentECUAddress(&ecu, BENCHMARK_ECU_ADDRESS);
+	J1939_setCurrentECUAddress(&peer, BENCHMARK_PEER_ADDRESS);
+
+	J1939_registerPGNhandler(&peer, BENCHMARK_CONTROL_PGN, BENCHMARK_ECU_ADDRESS, J1939_ANY_ADDRESS, benchmarkControlHandler, NULL);
+	J1939_registerPGNhandler(&peer, BENCHMARK_TP_PGN, BENCHMARK_ECU_ADDRESS, J1939_ANY_ADDRESS, benchmarkMessageHandler, NULL);
+
+	printf("SAE J1939-21 TX scheduler simulation, %u ms per case, virtual bus %u bit/s, %u TX mailboxes\n",
+		   time, J1939_HOST_DEFAULT_BITRATE, BENCHMARK_MAILBOXES);
+	printf("%-10s %8s %8s %12s %12s %10s\n", "mode", "control", "received", "mean us", "max us", "TP msgs");
+
+	fifoLatency			= benchmarkRun("mailboxes", 0U, time);
+	schedulerLatency	= benchmarkRun("scheduler", 1U, time);
+
+	return ((fifoLatency != 0U) && (schedulerLatency != 0U) && (schedulerLatency < fifoLatency)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
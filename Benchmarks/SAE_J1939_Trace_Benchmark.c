@@ -0,0 +1,259 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Trace_Benchmark.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Benchmark of the binary trace. It measures the time to record an
+  * 		 event, then sends RTS/CTS and BAM messages between two nodes of
+  * 		 the virtual CAN bus with lost data transfer packages and dumps
+  * 		 the traces of both nodes to files for j1939_trace_decoder. The
+  * 		 records are checked against the statistics of the nodes.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Port_Host.h"
+#include "SAE_J1939_Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define BENCHMARK_SENDER_ADDRESS				(0x10U)
+#define BENCHMARK_RECEIVER_ADDRESS				(0x20U)
+#define BENCHMARK_PTP_PGN						(0x00FF10UL)
+#define BENCHMARK_BAM_PGN						(0x00FF11UL)
+#define BENCHMARK_MAX_MESSAGE_SIZE				(300U)
+#define BENCHMARK_BAM_SIZE						(40U)
+#define BENCHMARK_PTP_PERIOD					(50U)		// ms
+#define BENCHMARK_BAM_PERIOD					(500U)		// ms
+#define BENCHMARK_DRAIN_TIME					(1000U)		// ms
+#define BENCHMARK_LOST_PACKAGE_PERIOD			(25U)
+#define BENCHMARK_DEFAULT_TIME					(1000U)		// ms
+#define BENCHMARK_EVENTS						(10000000U)
+#define BENCHMARK_TAIL_RECORDS					(16U)
+
+#define BENCHMARK_GET_PDU_FORMAT(canId)			((uint8_t)((canId) >> 16U))
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A benchmark node on the virtual bus.
+ */
+typedef struct
+{
+	uint8_t address;
+	const char* name;
+	J1939_instance instance;				/* The stack of the node, its channel is the node */
+} benchmarkNode;
+
+/**
+ * @brief Records of a dump by event.
+ */
+typedef struct
+{
+	uint32_t events[J1939_TRACE_EVENTS];
+	uint8_t ordered;						/* 1 - the timestamps don't decrease */
+} benchmarkDumpCounters;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static benchmarkNode sender		= {.address = BENCHMARK_SENDER_ADDRESS, .name = "sender"};
+static benchmarkNode receiver	= {.address = BENCHMARK_RECEIVER_ADDRESS, .name = "receiver"};
+static J1939_traceRing ring;
+static uint8_t message[BENCHMARK_MAX_MESSAGE_SIZE];
+static uint8_t dump[J1939_TRACE_DUMP_SIZE];
+static uint8_t tailDump[sizeof(J1939_traceDumpHeader) + (BENCHMARK_TAIL_RECORDS * sizeof(J1939_traceRecord))];
+static uint32_t dataPackages = 0U;
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to lose every BENCHMARK_LOST_PACKAGE_PERIOD data transfer package.
+ * @retval	1 if the frame is lost, 0 otherwise.
+ */
+static uint8_t benchmarkLoseFrame(uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	(void)data;
+	(void)dlc;
+
+	if(BENCHMARK_GET_PDU_FORMAT(canId) != J1939_DATA_TRANSFER) return 0U;
+
+	return ((++dataPackages % BENCHMARK_LOST_PACKAGE_PERIOD) == 0U) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is used to count the records of a dump by event.
+ * @param	buffer - A pointer to the dump.
+ * @param	counters - A pointer to store the counters.
+ * @retval	None.
+ */
+static void benchmarkCountRecords(const uint8_t* buffer, benchmarkDumpCounters* counters)
+{
+	J1939_traceDumpHeader header;
+	J1939_traceRecord record, previous = {0};
+
+	memcpy(&header, buffer, sizeof(header));
+	memset(counters, 0, sizeof(benchmarkDumpCounters));
+	counters->ordered = 1U;
+
+	for(uint32_t i = 0U; i < header.records; i++)
+	{
+		memcpy(&record, &buffer[sizeof(header) + (i * sizeof(record))], sizeof(record));
+
+		if(record.event < J1939_TRACE_EVENTS) counters->events[record.event]++;
+		if((i > 0U) && ((int32_t)(record.timestamp - previous.timestamp) < 0)) counters->ordered = 0U;
+
+		previous = record;
+	}
+}
+
+/**
+ * @brief 	This function is used to dump the trace of the node to a file and to check the dump.
+ * @param	node - A pointer to the node.
+ * @retval	1 - the dump agrees with the statistics of the node, 0 - doesn't.
+ */
+static uint8_t benchmarkDumpNode(benchmarkNode* node)
+{
+	const J1939_statistics* statistics = &node->instance.statistics;
+	J1939_traceDumpHeader header, tailHeader;
+	benchmarkDumpCounters counters;
+	uint32_t opened = 0U, completed = 0U, size, tailSize;
+	char fileName[64];
+	uint8_t passed = 1U;
+	FILE* file;
+
+	size		= J1939_dumpTrace(&node->instance, dump, sizeof(dump));
+	tailSize	= J1939_dumpTrace(&node->instance, tailDump, sizeof(tailDump));
+	memcpy(&header, dump, sizeof(header));
+	memcpy(&tailHeader, tailDump, sizeof(tailHeader));
+
+	snprintf(fileName, sizeof(fileName), "j1939_trace_%s.bin", node->name);
+	if(((file = fopen(fileName, "wb")) == NULL) || (fwrite(dump, 1U, size, file) != size)) passed = 0U;
+	if(file != NULL) fclose(file);
+
+	benchmarkCountRecords(dump, &counters);
+
+	for(uint8_t type = 0U; type < J1939_STATISTICS_SESSION_TYPES; type++)
+	{
+		opened		+= statistics->sessions[type].opened;
+		completed	+= statistics->sessions[type].completed;
+	}
+
+	printf("%-8s %7u %6u %6u %6u %6u %6u %6u %6u  %s\n", node->name, header.records, header.lost_records,
+		   counters.events[J1939_TRACE_FRAME_RX], counters.events[J1939_TRACE_FRAME_TX], counters.events[J1939_TRACE_SESSION_OPEN],
+		   counters.events[J1939_TRACE_SESSION_STATE], counters.events[J1939_TRACE_CTS_SENT] + counters.events[J1939_TRACE_CTS_RECEIVED],
+		   counters.events[J1939_TRACE_SESSION_COMPLETE], fileName);
+
+	// The whole run fits in the ring, so every frame and session is recorded once
+	passed &= (header.magic == J1939_TRACE_MAGIC) && (header.lost_records == 0U) && (counters.ordered == 1U);
+	passed &= (counters.events[J1939_TRACE_FRAME_RX] == statistics->frames_received);
+	passed &= (counters.events[J1939_TRACE_FRAME_TX] == statistics->frames_sent);
+	passed &= (counters.events[J1939_TRACE_SESSION_OPEN] == opened);
+	passed &= (counters.events[J1939_TRACE_SESSION_CLOSE] == opened);
+	passed &= (counters.events[J1939_TRACE_SESSION_COMPLETE] == completed);
+
+	// A small buffer gets the latest records
+	passed &= (tailSize == sizeof(tailDump)) && (tailHeader.records == BENCHMARK_TAIL_RECORDS) && \
+			  (tailHeader.lost_records == (header.records - BENCHMARK_TAIL_RECORDS)) && \
+			  (memcmp(&tailDump[sizeof(J1939_traceDumpHeader)],
+					  &dump[sizeof(J1939_traceDumpHeader) + ((header.records - BENCHMARK_TAIL_RECORDS) * sizeof(J1939_traceRecord))],
+					  BENCHMARK_TAIL_RECORDS * sizeof(J1939_traceRecord)) == 0);
+
+	return passed;
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	uint32_t time = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCHMARK_DEFAULT_TIME;
+	J1939_TP_session* session;
+	uint32_t nextPTP = 0U, nextBAM = 0U, now;
+	uint32_t sleepTime, receiverSleepTime;
+	uint64_t startTime, eventTime;
+	uint8_t passed = 1U;
+
+	if(time == 0U) time = BENCHMARK_DEFAULT_TIME;
+
+	srand(1939U);
+	for(uint16_t i = 0U; i < BENCHMARK_MAX_MESSAGE_SIZE; i++) message[i] = (uint8_t)rand();
+
+	printf("SAE J1939-21 trace benchmark, %u records of %u bytes per instance\n", J1939_TRACE_SIZE, (unsigned)sizeof(J1939_traceRecord));
+
+	// The cost of an event with the timestamp of the port
+	J1939_hostInit(J1939_HOST_DEFAULT_BITRATE);
+	J1939_initTrace(&ring);
+
+	startTime = benchmarkGetNanoseconds();
+	for(uint32_t i = 0U; i < BENCHMARK_EVENTS; i++)
+	{
+		J1939_traceEvent(&ring, J1939_TRACE_FRAME_RX, 8U, i, (uint8_t)i, 0U);
+	}
+	eventTime = benchmarkGetNanoseconds() - startTime;
+
+	printf("record an event: %.2f ns\n", (double)eventTime / BENCHMARK_EVENTS);
+
+	// RTS/CTS messages every BENCHMARK_PTP_PERIOD and BAM every BENCHMARK_BAM_PERIOD with lost packages
+	J1939_hostInit(J1939_HOST_DEFAULT_BITRATE);
+	J1939_hostSetLossFilter(benchmarkLoseFrame);
+
+	benchmarkAddNode(&sender.instance);
+	benchmarkAddNode(&receiver.instance);
+	J1939_setCurrentECUAddress(&sender.instance, sender.address);
+	J1939_setCurrentECUAddress(&receiver.instance, receiver.address);
+
+	while((now = (uint32_t)(J1939_hostGetTime() / 1000U)) < (time + BENCHMARK_DRAIN_TIME))
+	{
+		if((now >= nextPTP) && (now < time))
+		{
+			session = J1939_fillTPstructures(&sender.instance, message, (uint16_t)(9U + (rand() % (BENCHMARK_MAX_MESSAGE_SIZE - 8U))),
+											 BENCHMARK_PTP_PGN, receiver.address);
+			if(session != NULL) J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_RTS);
+			nextPTP += BENCHMARK_PTP_PERIOD;
+		}
+
+		if((now >= nextBAM) && (now < time))
+		{
+			session = J1939_fillTPstructures(&sender.instance, message, BENCHMARK_BAM_SIZE, BENCHMARK_BAM_PGN, J1939_BROADCAST_ADDRESS);
+			if(session != NULL) J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_BAM);
+			nextBAM += BENCHMARK_BAM_PERIOD;
+		}
+
+		sleepTime			= J1939_processTimers(&sender.instance);
+		receiverSleepTime	= J1939_processTimers(&receiver.instance);
+		if(receiverSleepTime < sleepTime) sleepTime = receiverSleepTime;
+
+		J1939_sendTPpendingPackages(&sender.instance);
+
+		if((J1939_hostProcessBus() > 0U) || (sleepTime == 0U)) continue;
+
+		// The task sleeps until the next deadline, at most until the next message
+		if(sleepTime > 1U) sleepTime = 1U;
+		J1939_hostAdvanceTime(((uint64_t)sleepTime * 1000U) - (J1939_hostGetTime() % 1000U));
+	}
+
+	printf("%-8s %7s %6s %6s %6s %6s %6s %6s %6s  %s\n", "node", "records", "lost", "RX", "TX", "open", "state", "CTS",
+		   "done", "dump");
+	passed &= benchmarkDumpNode(&sender);
+	passed &= benchmarkDumpNode(&receiver);
+
+	printf("decode: j1939_trace_decoder j1939_trace_sender.bin\n");
+	printf("%s\n", (passed == 1U) ? "PASSED" : "FAILED");
+
+	return (passed == 1U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
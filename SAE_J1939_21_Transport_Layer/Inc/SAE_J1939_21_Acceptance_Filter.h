@@ -0,0 +1,107 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Acceptance_Filter.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the hardware acceptance filter generation. The
+  * 		 filters of the CAN controller are made from the PGNs registered
+  * 		 in the dispatcher and the current ECU address, so the frames which
+  * 		 would be dropped by the dispatcher don't reach the RX interrupt.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_21_ACCEPTANCE_FILTER_H
+#define __SAE_J1939_21_ACCEPTANCE_FILTER_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Dispatcher.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+
+// The maximum number of filters loaded into the CAN controller and whether ETP.CM and ETP.DT frames
+// addressed to the ECU are accepted. They can be redefined in the compiler options.
+#ifndef J1939_MAX_FILTER_BANKS
+#define J1939_MAX_FILTER_BANKS					(28U)
+#endif
+
+#ifndef J1939_FILTER_ACCEPT_ETP
+#define J1939_FILTER_ACCEPT_ETP					(1U)
+#endif
+
+// Every handler gives up to two filters (the ECU address and the global address) plus the fixed filters:
+// TP.CM, TP.DT, the address claim and the request (4 x 2), ETP.CM and ETP.DT (2), multi-PG, FD.TP.CM
+// and FD.TP.DT (3 x 2). A filter added to the full array is merged with another one.
+#define J1939_FILTER_FIXED_PATTERNS				(16U)
+
+#if (((J1939_MAX_PGN_HANDLERS * 2U) + J1939_FILTER_FIXED_PATTERNS) > 255U)
+#define J1939_FILTER_MAX_PATTERNS				(255U)
+#else
+#define J1939_FILTER_MAX_PATTERNS				((J1939_MAX_PGN_HANDLERS * 2U) + J1939_FILTER_FIXED_PATTERNS)
+#endif
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief Acceptance filters of an instance.
+ */
+typedef struct
+{
+	J1939_PGNregistration registrations[J1939_MAX_PGN_HANDLERS];	/* Registrations read from the dispatcher */
+	J1939_acceptanceFilter patterns[J1939_FILTER_MAX_PATTERNS];		/* Filters being made */
+	J1939_acceptanceFilter loaded_filters[J1939_MAX_FILTER_BANKS];	/* Filters loaded into the CAN controller */
+	uint8_t enabled;												/* 1 - the hardware filtering is on */
+} J1939_acceptanceFilters;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to make the acceptance filters. They accept the registered PGNs with
+ * 			their address filters, TP.CM, TP.DT, address claims and requests addressed to the ECU or to all ECUs,
+ * 			with the CAN FD data link also multi-PG, FD.TP.CM and FD.TP.DT.
+ * 			If there are more PGNs than filters, the filters with the fewest extra accepted IDs
+ * 			are merged.
+ * @param	instance - A pointer to the instance.
+ * @param	filters - A pointer to store the filters.
+ * @param	maxFilters - The maximum number of filters.
+ * @param	address - The ECU address.
+ * @retval	The number of filters. 0 - all frames must be received.
+ */
+uint8_t J1939_makeAcceptanceFilters(J1939_instance* instance, J1939_acceptanceFilter* filters, uint8_t maxFilters, uint8_t address);
+
+/**
+ * @brief 	This function is used to start the hardware filtering. The filters are loaded at once and
+ * 			made again when a PGN handler is registered or unregistered, the ECU address or the data link
+ * 			is changed.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_enableAcceptanceFilters(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to stop the hardware filtering, all frames are received.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_disableAcceptanceFilters(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to make and load the acceptance filters if the filtering is enabled.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_refreshAcceptanceFilters(J1939_instance* instance);
+
+#endif /* __SAE_J1939_21_ACCEPTANCE_FILTER_H */
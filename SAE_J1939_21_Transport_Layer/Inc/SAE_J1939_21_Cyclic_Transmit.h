@@ -0,0 +1,180 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Cyclic_Transmit.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the cyclic PGN transmission. The PGNs are
+  * 		 registered with a period, a phase and a payload provider, their
+  * 		 CAN IDs are made once and one timer of the wheel sends the due
+  * 		 frames in deadline order. Payloads above 8 bytes are broadcast
+  * 		 by BAM.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_21_CYCLIC_TRANSMIT_H
+#define __SAE_J1939_21_CYCLIC_TRANSMIT_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Timer_Wheel.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+
+// The number of cyclic PGNs and the time after which a frame not queued for the lack of a TX slot
+// or a BAM session is sent again, ms. They can be redefined in the compiler options.
+#ifndef J1939_MAX_CYCLIC_PGNS
+#define J1939_MAX_CYCLIC_PGNS					(32U)
+#endif
+
+#ifndef J1939_CYCLIC_RETRY_TIME
+#define J1939_CYCLIC_RETRY_TIME					(1U)
+#endif
+
+#if (J1939_MAX_CYCLIC_PGNS > 254U)
+	#error "J1939_MAX_CYCLIC_PGNS must be less than 255"
+#endif
+
+#define J1939_CYCLIC_AUTO_PHASE					(0xFFFFFFFFU)	// The phase is chosen by the library
+
+#define J1939_CYCLIC_OK							(0U)
+#define J1939_CYCLIC_NO_SLOT					(1U)
+#define J1939_CYCLIC_INVALID					(2U)
+#define J1939_CYCLIC_BUSY						(3U)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A function called when the cyclic PGN is due to write its payload. It returns the payload size,
+ * 		  0 - the cycle is skipped.
+ */
+typedef uint16_t (*J1939_cyclicProvider)(void* context, uint32_t PGN, uint8_t* data, uint16_t maxSize);
+
+/**
+ * @brief A cyclic PGN.
+ */
+typedef struct
+{
+	uint32_t PGN;									/* The PGN */
+	uint32_t can_id;								/* The CAN ID made for the current ECU address */
+	uint32_t period;								/* Transmission period, ms */
+	uint32_t phase;									/* Offset of the deadlines from the common start, ms */
+	uint32_t deadline;								/* The nominal time of the next transmission, ms */
+	uint32_t due_time;								/* The time of the next attempt, ms. Later than deadline if deferred */
+	J1939_cyclicProvider provider;					/* Writes the payload. NULL - the data set by J1939_setCyclicData */
+	void* context;									/* A user pointer passed to the provider */
+	uint8_t* buffer;								/* The payload above 8 bytes sent by BAM. NULL - single frames only */
+	uint16_t buffer_size;							/* The size of the buffer */
+	uint16_t size;									/* The size of the data set by J1939_setCyclicData */
+	uint8_t data[8];								/* The payload of the single frame */
+	uint8_t priority;								/* The priority of the single frame */
+	uint8_t in_use;									/* 1 - the PGN is registered, 0 - the slot is free */
+} J1939_cyclicPGN;
+
+/**
+ * @brief Cyclic transmission statistics.
+ */
+typedef struct
+{
+	uint32_t frames;								/* Single frames queued */
+	uint32_t BAM_messages;							/* BAM sessions opened */
+	uint32_t skipped;								/* Cycles skipped by the providers or without an address */
+	uint32_t missed_cycles;							/* Deadlines passed without a transmission */
+	uint32_t deferred;								/* Attempts put off for the lack of a TX slot or a BAM session */
+	uint32_t total_lateness;						/* Sum of the times from the deadlines to the transmissions, ms */
+	uint32_t max_lateness;							/* The longest time from the deadline to the transmission, ms */
+	uint8_t max_batch;								/* The largest number of PGNs sent by one timer expiration */
+} J1939_cyclicStatistics;
+
+/**
+ * @brief Cyclic transmission of an instance.
+ */
+typedef struct
+{
+	J1939_cyclicPGN PGNs[J1939_MAX_CYCLIC_PGNS];
+	uint8_t heap[J1939_MAX_CYCLIC_PGNS];			/* Registered PGNs, a binary min-heap by due_time */
+	uint8_t heap_size;								/* The number of registered PGNs */
+	uint8_t address;								/* The ECU address the CAN IDs are made for */
+	uint8_t started;								/* 1 - start_time is set, 0 - isn't */
+	uint32_t start_time;							/* The common start of the phases, ms */
+	J1939_timer timer;								/* Expires at the earliest due_time */
+	J1939_cyclicStatistics statistics;
+} J1939_cyclicTransmit;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to register a cyclic PGN or to change the registration of the PGN. The
+ * 			transmissions are made by J1939_processTimers. The frames of PDU1 PGNs go to the global address.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	priority - The priority from 0 to 7.
+ * @param	period - Transmission period, ms.
+ * @param	phase - Offset of the deadlines, ms. J1939_CYCLIC_AUTO_PHASE - the offset with the fewest
+ * 			coincident deadlines of the registered PGNs, so the bus load is spread.
+ * @param	provider - A function to write the payload before each transmission. NULL - the data set
+ * 			by J1939_setCyclicData is sent.
+ * @param	context - A user pointer passed to the provider.
+ * @retval	J1939_CYCLIC_OK, J1939_CYCLIC_NO_SLOT if there are no free slots or J1939_CYCLIC_INVALID.
+ */
+uint8_t J1939_registerCyclicPGN(J1939_instance* instance, uint32_t PGN, uint8_t priority, uint32_t period, uint32_t phase,
+								J1939_cyclicProvider provider, void* context);
+
+/**
+ * @brief 	This function is used to stop the transmissions of the PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @retval	None.
+ */
+void J1939_unregisterCyclicPGN(J1939_instance* instance, uint32_t PGN);
+
+/**
+ * @brief 	This function is used to give the cyclic PGN a buffer for payloads above 8 bytes. Such payloads
+ * 			are broadcast by BAM straight from the buffer, so it mustn't be changed by the application.
+ * 			A transmission is put off while another BAM session is open.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	buffer - The buffer. NULL - single frames only.
+ * @param	bufferSize - The size of the buffer, up to 1785 bytes.
+ * @retval	J1939_CYCLIC_OK, J1939_CYCLIC_INVALID or J1939_CYCLIC_BUSY if the buffer is being sent.
+ */
+uint8_t J1939_setCyclicBuffer(J1939_instance* instance, uint32_t PGN, uint8_t* buffer, uint16_t bufferSize);
+
+/**
+ * @brief 	This function is used to set the payload of the cyclic PGN without a provider. The payload
+ * 			up to 8 bytes is kept with the CAN ID, a larger one is copied into the buffer of the PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	data - A pointer to the payload.
+ * @param	size - The payload size. 0 - the PGN isn't sent until the payload is set.
+ * @retval	J1939_CYCLIC_OK, J1939_CYCLIC_INVALID or J1939_CYCLIC_BUSY if the buffer is being sent.
+ */
+uint8_t J1939_setCyclicData(J1939_instance* instance, uint32_t PGN, const uint8_t* data, uint16_t size);
+
+/**
+ * @brief 	This function is used to get the cyclic transmission statistics.
+ * @param	instance - A pointer to the instance.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getCyclicStatistics(J1939_instance* instance, J1939_cyclicStatistics* statistics);
+
+/**
+ * @brief 	This function is used to reset the cyclic transmission statistics.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetCyclicStatistics(J1939_instance* instance);
+
+#endif /* __SAE_J1939_21_CYCLIC_TRANSMIT_H */
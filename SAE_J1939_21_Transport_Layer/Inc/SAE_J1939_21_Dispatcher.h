@@ -0,0 +1,175 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Dispatcher.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the SAE J1939-21 receive dispatcher. Received
+  * 		 frames are routed to the handlers of their PGN by a direct-indexed
+  * 		 table, TP and ETP frames are routed into the transport layer.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_21_DISPATCHER_H
+#define __SAE_J1939_21_DISPATCHER_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Transport_Layer.h"
+#include "SAE_J1939_21_Frame_Ring.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+
+// The number of handlers and the number of PDU2 groups (PDU format from 240 to 255 with any data page)
+// with registered PGNs at a time, a group is freed when its last handler is unregistered. Every group takes
+// J1939_NUMBER_OF_ADDRESSES bytes. They can be redefined in the compiler options.
+#ifndef J1939_MAX_PGN_HANDLERS
+#define J1939_MAX_PGN_HANDLERS					(32U)
+#endif
+
+#ifndef J1939_MAX_PDU2_GROUPS
+#define J1939_MAX_PDU2_GROUPS					(4U)
+#endif
+
+#if ((J1939_MAX_PGN_HANDLERS > 254U) || (J1939_MAX_PDU2_GROUPS > 254U))
+	#error "J1939_MAX_PGN_HANDLERS and J1939_MAX_PDU2_GROUPS must be less than 255"
+#endif
+
+// 1 - TP and ETP frames are accepted only from the claimed addresses. It can be redefined in the compiler options.
+#ifndef J1939_TP_CLAIMED_SOURCES_ONLY
+#define J1939_TP_CLAIMED_SOURCES_ONLY			(0U)
+#endif
+
+#define J1939_ANY_ADDRESS						(0xFFFFU)	// The address filter accepts any address
+
+#define J1939_DISPATCH_OK						(0U)
+#define J1939_DISPATCH_NO_SLOT					(1U)
+
+#define J1939_NUMBER_OF_GROUPS					(1024U)		// EDP, DP and PDU format
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A function called with a received message of the PGN: a single frame or a complete multi-packet
+ * 		  message. data is NULL for a multi-packet message streamed to a TP sink.
+ */
+typedef void (*J1939_PGNhandler)(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+								 const uint8_t* data, uint16_t size);
+
+/**
+ * @brief The PGN and the address filters of a registered handler.
+ */
+typedef struct
+{
+	uint32_t PGN;											/* The PGN */
+	uint16_t source_address;								/* The source address filter */
+	uint16_t destination_address;							/* The destination address filter */
+} J1939_PGNregistration;
+
+/**
+ * @brief A registered handler of the PGN.
+ */
+typedef struct
+{
+	uint32_t PGN;											/* The PGN */
+	uint16_t source_address;								/* The source address filter */
+	uint16_t destination_address;							/* The destination address filter */
+	J1939_PGNhandler handler;								/* NULL - the slot is free */
+	void* context;											/* A user pointer passed to the handler */
+	uint8_t next;											/* The next handler of the PGN + 1. 0 - the last one */
+} J1939_PGNhandlerSlot;
+
+/**
+ * @brief PGN dispatcher of an instance.
+ */
+typedef struct
+{
+	J1939_PGNhandlerSlot handlers[J1939_MAX_PGN_HANDLERS];
+	uint8_t groups[J1939_NUMBER_OF_GROUPS];					/* PDU1 group - the first handler + 1,
+															   PDU2 group - the PDU2 group table + 1 */
+	uint8_t PDU2groups[J1939_MAX_PDU2_GROUPS][J1939_NUMBER_OF_ADDRESSES];	/* The first handler + 1 by the PDU specific */
+	uint8_t PDU2group_handlers[J1939_MAX_PDU2_GROUPS];		/* Handlers registered in the PDU2 group, 0 - the group is free */
+} J1939_dispatcher;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to register a handler of the PGN. A PGN can have several handlers
+ * 			with different address filters.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	sourceAddress - The source address filter. J1939_ANY_ADDRESS - any address.
+ * @param	destinationAddress - The destination address filter. J1939_ANY_ADDRESS - any address.
+ * @param	handler - A function to process the messages.
+ * @param	context - A user pointer passed to the handler.
+ * @retval	J1939_DISPATCH_OK or J1939_DISPATCH_NO_SLOT if there are no free handler slots or PDU2 groups.
+ */
+uint8_t J1939_registerPGNhandler(J1939_instance* instance, uint32_t PGN, uint16_t sourceAddress, uint16_t destinationAddress,
+								 J1939_PGNhandler handler, void* context);
+
+/**
+ * @brief 	This function is used to remove all registrations of the handler for the PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	handler - The function registered for the PGN.
+ * @retval	None.
+ */
+void J1939_unregisterPGNhandler(J1939_instance* instance, uint32_t PGN, J1939_PGNhandler handler);
+
+/**
+ * @brief 	This function is used to get the registrations of the handlers, e.g. to make acceptance filters.
+ * @param	instance - A pointer to the instance.
+ * @param	registrations - A pointer to store the registrations.
+ * @param	maxRegistrations - The maximum number of registrations to store.
+ * @retval	The number of stored registrations.
+ */
+uint8_t J1939_getPGNregistrations(J1939_instance* instance, J1939_PGNregistration* registrations, uint8_t maxRegistrations);
+
+/**
+ * @brief 	This function is used to route a received frame. Frames addressed to other ECUs are dropped,
+ * 			TP.CM, TP.DT, ETP.CM and ETP.DT frames are processed by the transport layer, multi-PG, FD.TP.CM and FD.TP.DT frames
+ * 			by the CAN FD data link of the instance, address claims and requests for
+ * 			them by the network management layer, requests for the PGNs with a provider by the request
+ * 			responder. The other frames and the requests are passed to the handlers of their PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	None.
+ */
+void J1939_dispatchFrame(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t dlc);
+
+/**
+ * @brief 	This function is used to pass a message to the handlers of its PGN, e.g. a C-PG of a multi-PG
+ * 			frame or a message received by FD.TP.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN of the message.
+ * @param	sourceAddress - The source address of the message.
+ * @param	destinationAddress - The destination address of the message.
+ * @param	data - A pointer to the message.
+ * @param	size - The size of the message.
+ * @retval	None.
+ */
+void J1939_dispatchMessage(J1939_instance* instance, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+						   const uint8_t* data, uint16_t size);
+
+/**
+ * @brief 	This function is used to route a frame of the receive ring. It can be passed to J1939_processFrames.
+ * @param	context - A pointer to the instance which receives the frame.
+ * @param	frame - A pointer to the frame.
+ * @retval	None.
+ */
+void J1939_dispatchRingFrame(void* context, const J1939_frame* frame);
+
+#endif /* __SAE_J1939_21_DISPATCHER_H */
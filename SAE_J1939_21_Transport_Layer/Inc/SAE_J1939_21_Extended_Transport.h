@@ -0,0 +1,301 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Extended_Transport.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of SAE J1939-21 Extended Transport Protocol (ETP).
+  * 		 Messages above 1785 bytes are streamed through a bounded window
+  * 		 buffer: the sender reads the message by a source callback, the
+  * 		 receiver passes it on by a sink callback.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_21_EXTENDED_TRANSPORT_H
+#define __SAE_J1939_21_EXTENDED_TRANSPORT_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Transport_Layer.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_ETP_CONNECTION_MANAGEMENT			(0xC8U)
+#define J1939_ETP_DATA_TRANSFER					(0xC7U)
+
+#define J1939_ETP_MIN_LENGTH_MESSAGE			(1786UL)		// The shorter messages are sent by TP
+#define J1939_ETP_MAX_LENGTH_MESSAGE			(117440505UL)	// 16777215 packages of 7 bytes
+
+// The number of packages in one CTS window. The window buffer of each session holds that many packages.
+// It can be redefined in the compiler options.
+#ifndef J1939_ETP_WINDOW_PACKAGES
+#define J1939_ETP_WINDOW_PACKAGES				(64U)
+#endif
+
+#if ((J1939_ETP_WINDOW_PACKAGES == 0U) || (J1939_ETP_WINDOW_PACKAGES > 255U))
+	#error "J1939_ETP_WINDOW_PACKAGES must be from 1 to 255"
+#endif
+
+#define J1939_ETP_WINDOW_SIZE					(J1939_ETP_WINDOW_PACKAGES * 7U)
+
+// The number of sessions of each type which can be opened at the same time.
+// It can be redefined in the compiler options.
+#ifndef J1939_MAX_ETP_RX_SESSIONS
+#define J1939_MAX_ETP_RX_SESSIONS				(1U)
+#endif
+
+#ifndef J1939_MAX_ETP_TX_SESSIONS
+#define J1939_MAX_ETP_TX_SESSIONS				(1U)
+#endif
+
+// The number of PGNs received by ETP sinks. It can be redefined in the compiler options.
+#ifndef J1939_MAX_ETP_SINKS
+#define J1939_MAX_ETP_SINKS						(4U)
+#endif
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief J1939 extended transport protocol session types.
+ */
+typedef enum
+{
+	J1939_ETP_SESSION_RX,			/* Receiving a multi-packet message */
+	J1939_ETP_SESSION_TX,			/* Sending a multi-packet message */
+	J1939_ETP_SESSION_TYPES			/* The number of session types */
+} J1939_ETPsessionTypes;
+
+/**
+ * @brief A function called to read the sent message: size bytes from the offset must be copied to data.
+ */
+typedef void (*J1939_ETPsourceCallback)(void* context, uint32_t offset, uint8_t* data, uint16_t size);
+
+/**
+ * @brief A function called to pass on the received message: size bytes at the offset. The parts of
+ * 		  the message are passed in order, each window once.
+ */
+typedef void (*J1939_ETPsinkCallback)(void* context, uint32_t offset, const uint8_t* data, uint16_t size);
+
+/**
+ * @brief PGN 0x00C800/0x00C700 - Extended Transport Protocol session.
+ */
+typedef struct
+{
+	J1939_ETPsessionTypes type;						/* Session type */
+	J1939_states state;								/* Current state of the session */
+	uint8_t source_address;							/* Originator of the multi-packet message */
+	uint8_t destination_address;					/* Recipient of the multi-packet message */
+	uint8_t in_use;									/* 1 - session is open, 0 - session slot is free */
+
+	uint32_t message_size;							/* Total bytes of the message - up to 117440505 */
+	uint32_t total_number_of_packages;				/* Number of packages to send a message */
+	uint32_t PGN_of_the_multipacket_message;		/* A PGN that activated the multi-packet transfer */
+
+	uint32_t next_package;							/* The next package to send or to request */
+	uint32_t window_first;							/* The first package of the window buffer */
+	uint8_t window_packages;						/* The number of packages in the window buffer */
+	uint32_t data_packet_offset;					/* The offset of the package sequence numbers set by DPO */
+	uint8_t DPO_packages;							/* The number of packages the offset applies to */
+	uint8_t DPO_pending;							/* 1 - DPO must be sent before the packages */
+	uint8_t remaining_packages_from_CTS;			/* It remains to send packets from the last CTS */
+	uint8_t CTS_available_message;					/* 1 allows to process CTS messages, 0 - doesn't */
+
+	uint8_t received_packages;						/* The number of received packages of the window */
+	uint8_t received_packages_map[(J1939_ETP_WINDOW_PACKAGES + 7U) / 8U];	/* Bit per received package */
+	uint8_t retransmit_packages;					/* The number of lost packages to request by the next CTS */
+	uint32_t retransmitted_package;					/* The lost package requested again */
+	uint8_t retransmissions;						/* How many times the lost package has been requested */
+
+	J1939_abortReasons abort_reason;				/* Connection abort reason */
+
+	J1939_ETPsourceCallback source;					/* Reads the sent message */
+	J1939_ETPsinkCallback sink;						/* Passes on the received message */
+	void* context;									/* A user pointer passed to the callbacks */
+
+	uint8_t window[J1939_ETP_WINDOW_SIZE];			/* The window buffer */
+	uint32_t open_time;								/* Time when the session was opened, ms */
+	uint32_t wait_time;								/* Time when the session started to wait for CTS or its packages, ms */
+	uint8_t waiting;								/* 1 - the wait for CTS or its packages is timed */
+	J1939_timer timer;								/* Timeout of the session */
+	J1939_instance* instance;						/* The instance which owns the session */
+} J1939_ETP_session;
+
+/**
+ * @brief A function called by J1939_processTimers when the library closes an ETP session itself
+ * 		  (the abort message has already been sent): J1939_ERROR_TIMEOUT - the session has timed out,
+ * 		  J1939_ERROR_MISSING_PACKAGES - the lost packages have been requested J1939_TP_MAX_RETRANSMISSIONS
+ * 		  times. The session is closed after the function returns.
+ */
+typedef void (*J1939_ETPcallback)(J1939_ETP_session* session, J1939_status status);
+
+/**
+ * @brief Table of the ETP sessions of the same type.
+ */
+typedef struct
+{
+	J1939_ETP_session* sessions;							/* Session slots */
+	uint8_t number_of_sessions;								/* The number of session slots */
+	uint8_t index[J1939_NUMBER_OF_ADDRESSES];				/* The session slot number + 1 by the peer address.
+															   0 - there is no session with the peer */
+} J1939_ETP_sessionTable;
+
+/**
+ * @brief A sink of the PGN set to the RX sessions opened by RTS.
+ */
+typedef struct
+{
+	uint32_t PGN;											/* A PGN of the multi-packet messages */
+	J1939_ETPsinkCallback sink;								/* Receives the message. NULL - the slot is free */
+	void* context;											/* A user pointer passed to the sink */
+} J1939_ETP_sink;
+
+/**
+ * @brief Extended transport protocol of an instance.
+ */
+typedef struct
+{
+	J1939_ETP_session rx_sessions[J1939_MAX_ETP_RX_SESSIONS];
+	J1939_ETP_session tx_sessions[J1939_MAX_ETP_TX_SESSIONS];
+	J1939_ETP_sessionTable session_tables[J1939_ETP_SESSION_TYPES];
+	J1939_ETP_sink sinks[J1939_MAX_ETP_SINKS];
+	J1939_ETPcallback callback;								/* Called when the library closes a session itself */
+} J1939_extendedTransport;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to bind the session tables of the instance to its sessions.
+ * 			It is called by J1939_initInstance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initExtendedTransport(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to read extended transport protocol connection management messages.
+ * 			RTS opens a new session, other messages are routed to the already opened session of the sender.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the received message.
+ * @param	data - A pointer to the receiving data.
+ * @param	session - A pointer to store the session of the message. NULL if there is no session.
+ * @retval	J1939 status. J1939_STATUS_GOT_RTS_MESSAGE - CTS must be sent. The sink registered for the PGN
+ * 			is set to the session, another one can be set by J1939_setETPsink.
+ */
+J1939_status J1939_readETP_connectionManagement(J1939_instance* instance, uint32_t canId, const uint8_t* data, J1939_ETP_session** session);
+
+/**
+ * @brief	This function is used to send extended transport protocol connection management messages:
+ * 			RTS, CTS, EOM or ABORT. DPO is sent by J1939_sendETP_dataTransferBurst.
+ * @param	session - A pointer to the ETP session.
+ * @param	type - A type of the connection management message.
+ * @retval	None.
+ */
+void J1939_sendETP_connectionManagement(J1939_ETP_session* session, J1939_TPcmTypes type);
+
+/**
+ * @brief	This function is used to send the extended transport protocol abort message.
+ * @param	instance - A pointer to the instance.
+ * @param	destinationAddress - ECU address to send the message to.
+ * @param	PGN - A PGN of the multipacket message.
+ * @param	abortReason - The abort reason.
+ * @retval	None.
+ */
+void J1939_sendETP_abort(J1939_instance* instance, uint8_t destinationAddress, uint32_t PGN, J1939_abortReasons abortReason);
+
+/**
+ * @brief 	This function is used to read extended transport protocol data transfer messages.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the received message.
+ * @param	data - A pointer to the receiving data.
+ * @param	session - A pointer to store the session of the message. NULL if there is no session.
+ * @retval	J1939 status. J1939_STATUS_CTS - the next CTS must be sent, J1939_STATUS_DATA_FINISHED - EOM.
+ */
+J1939_status J1939_readETP_dataTransfer(J1939_instance* instance, uint32_t canId, const uint8_t* data, J1939_ETP_session** session);
+
+/**
+ * @brief	This function is used to send DPO and the packages of the CTS window, limited by the free TX slots
+ * 			of the CAN controller. The packages are read from the source by the whole window.
+ * @param	session - A pointer to the ETP session.
+ * @param	sentPackages - A pointer to store the number of queued packages.
+ * @return	J1939 status. J1939_STATUS_CTS if the window is over and the next CTS must be waited.
+ */
+J1939_status J1939_sendETP_dataTransferBurst(J1939_ETP_session* session, uint8_t* sentPackages);
+
+/**
+ * @brief	This function is used to continue the CTS windows of all TX sessions which have been limited
+ * 			by the free TX slots. It is called when TX slots of the CAN controller are released.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of queued packages.
+ */
+uint16_t J1939_sendETPpendingPackages(J1939_instance* instance);
+
+/**
+ * @brief	This function used to open an ETP TX session. The message isn't stored, it is read by the source.
+ * @param	instance - A pointer to the instance.
+ * @param 	messageSize - A size of the message.
+ * @param 	PGN - A PGN of the multipacket message.
+ * @param 	destinationAddress - ECU address to send data to.
+ * @param	source - A function to read the message.
+ * @param	context - A user pointer passed to the source.
+ * @retval	A pointer to the TX session. NULL if a session to the destination address is
+ * 			already opened, there is no free session or the message size is out of
+ * 			J1939_ETP_MIN_LENGTH_MESSAGE to J1939_ETP_MAX_LENGTH_MESSAGE.
+ */
+J1939_ETP_session* J1939_fillETPstructures(J1939_instance* instance, uint32_t messageSize, uint32_t PGN, uint8_t destinationAddress,
+										   J1939_ETPsourceCallback source, void* context);
+
+/**
+ * @brief	This function is used to clean ETP structures and close the session.
+ * @param	session - A pointer to the ETP session.
+ * @retval	None.
+ */
+void J1939_clearETPstructures(J1939_ETP_session* session);
+
+/**
+ * @brief 	This function is used to set the function which receives the message of the RX session.
+ * @param	session - A pointer to the ETP session.
+ * @param	sink - A function to pass on the message.
+ * @param	context - A user pointer passed to the sink.
+ * @retval	None.
+ */
+void J1939_setETPsink(J1939_ETP_session* session, J1939_ETPsinkCallback sink, void* context);
+
+/**
+ * @brief 	This function is used to set the abort reason sent by J1939_sendETP_connectionManagement.
+ * @param	session - A pointer to the ETP session.
+ * @param 	abortReason - The abort reason.
+ * @retval	None.
+ */
+void J1939_setETPabortReason(J1939_ETP_session* session, J1939_abortReasons abortReason);
+
+/**
+ * @brief 	This function is used to set the function called when the library closes an ETP session itself.
+ * @param	instance - A pointer to the instance.
+ * @param	callback - A pointer to the function. NULL - no function.
+ * @retval	None.
+ */
+void J1939_setETPcallback(J1939_instance* instance, J1939_ETPcallback callback);
+
+/**
+ * @brief 	This function is used to set the sink of the messages of the PGN received by the RX sessions
+ * 			opened later, e.g. when the frames are routed by J1939_dispatchFrame. Sessions opened before
+ * 			the call aren't affected.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - A PGN of the multi-packet messages.
+ * @param	sink - A function to pass on the message. NULL - remove the sink of the PGN.
+ * @param	context - A user pointer passed to the sink.
+ * @retval	0 - the sink is registered, 1 - there is no free sink slot (J1939_MAX_ETP_SINKS).
+ */
+uint8_t J1939_registerETPsink(J1939_instance* instance, uint32_t PGN, J1939_ETPsinkCallback sink, void* context);
+
+#endif /* __SAE_J1939_21_EXTENDED_TRANSPORT_H */
@@ -0,0 +1,130 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Frame_Ring.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the lock-free ring of received CAN frames. The CAN
+  * 		 RX interrupt is the only producer and the J1939 task is the only
+  * 		 consumer, so no interrupt masking is required.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_21_FRAME_RING_H
+#define __SAE_J1939_21_FRAME_RING_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_Port.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+
+// The number of frame slots, must be a power of two. It can be redefined in the compiler options.
+#ifndef J1939_FRAME_RING_SIZE
+#define J1939_FRAME_RING_SIZE					(64U)
+#endif
+
+#if ((J1939_FRAME_RING_SIZE & (J1939_FRAME_RING_SIZE - 1U)) != 0U)
+	#error "J1939_FRAME_RING_SIZE must be a power of two"
+#endif
+
+#define J1939_FRAME_MAX_DLC						(8U)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A received CAN frame.
+ */
+typedef struct
+{
+	uint32_t can_id;								/* 29-bit CAN ID */
+	uint32_t timestamp;								/* Reception time */
+	uint8_t dlc;									/* The number of data bytes */
+	uint8_t data[J1939_FRAME_MAX_DLC];				/* Frame data */
+} J1939_frame;
+
+/**
+ * @brief Single-producer/single-consumer ring of received CAN frames. The indexes run freely and
+ * 		  are reduced to a slot number by the mask.
+ */
+typedef struct
+{
+	volatile uint32_t head;							/* Next slot to write. Written by the producer only */
+	volatile uint32_t tail;							/* Next slot to read. Written by the consumer only */
+	uint32_t overflows;								/* Frames dropped because the ring was full */
+	uint32_t max_pending;							/* High-water mark of pending frames */
+	J1939_frame frames[J1939_FRAME_RING_SIZE];		/* Frame slots */
+} J1939_frameRing;
+
+/**
+ * @brief A function called by J1939_processFrames for each pending frame.
+ */
+typedef void (*J1939_frameHandler)(void* context, const J1939_frame* frame);
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to reset the ring. It mustn't be called while the producer is active.
+ * @param	ring - A pointer to the ring.
+ * @retval	None.
+ */
+void J1939_initFrameRing(J1939_frameRing* ring);
+
+/**
+ * @brief 	This function is used to get the next free slot to fill it in place. The slot is published
+ * 			by J1939_commitFrame. Called by the producer only.
+ * @param	ring - A pointer to the ring.
+ * @retval	A pointer to the free slot. NULL if the ring is full.
+ */
+J1939_frame* J1939_getFreeFrameSlot(J1939_frameRing* ring);
+
+/**
+ * @brief 	This function is used to publish the slot filled after J1939_getFreeFrameSlot.
+ * 			Called by the producer only.
+ * @param	ring - A pointer to the ring.
+ * @retval	None.
+ */
+void J1939_commitFrame(J1939_frameRing* ring);
+
+/**
+ * @brief 	This function is used to copy a received frame into the ring. Called by the producer only.
+ * @param	ring - A pointer to the ring.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @param	timestamp - The reception time.
+ * @retval	1 - the frame is queued, 0 - the ring is full and the frame is dropped.
+ */
+uint8_t J1939_pushFrame(J1939_frameRing* ring, uint32_t canId, const uint8_t* data, uint8_t dlc, uint32_t timestamp);
+
+/**
+ * @brief 	This function is used to pass all pending frames to the handler in one pass. The frames are
+ * 			handed over in place and their slots are released together after the last one.
+ * 			Called by the consumer only.
+ * @param	ring - A pointer to the ring.
+ * @param	handler - A function to process a frame.
+ * @param	context - A user pointer passed to the handler.
+ * @param	maxFrames - The maximum number of frames to process. 0 - no limit.
+ * @retval	The number of processed frames.
+ */
+uint32_t J1939_processFrames(J1939_frameRing* ring, J1939_frameHandler handler, void* context, uint32_t maxFrames);
+
+/**
+ * @brief 	This function is used to get the number of pending frames.
+ * @param	ring - A pointer to the ring.
+ * @retval	The number of pending frames.
+ */
+uint32_t J1939_getPendingFrames(J1939_frameRing* ring);
+
+#endif /* __SAE_J1939_21_FRAME_RING_H */
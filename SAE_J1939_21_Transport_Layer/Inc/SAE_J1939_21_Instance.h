@@ -0,0 +1,199 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Instance.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the SAE J1939 stack instance. An instance holds
+  * 		 the state of all layers for one CAN channel: the ECU address,
+  * 		 the session tables, the dispatcher, the filters, the memory pool,
+  * 		 the message queue, the timers, the cyclic PGNs, the request
+  * 		 responses, the diagnostic messages, the statistics and the TX
+  * 		 hooks. Instances share no state, so each channel can be serviced
+  * 		 by its own task or core without locks. An instance sends its
+  * 		 messages over the classic CAN data link or over CAN FD per
+  * 		 SAE J1939-22.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_21_INSTANCE_H
+#define __SAE_J1939_21_INSTANCE_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Transport_Layer.h"
+#include "SAE_J1939_21_Extended_Transport.h"
+#include "SAE_J1939_21_Dispatcher.h"
+#include "SAE_J1939_21_Acceptance_Filter.h"
+#include "SAE_J1939_21_Memory_Pool.h"
+#include "SAE_J1939_21_Message_Queue.h"
+#include "SAE_J1939_21_Timer_Wheel.h"
+#include "SAE_J1939_21_TX_Scheduler.h"
+#include "SAE_J1939_21_Cyclic_Transmit.h"
+#include "SAE_J1939_21_Request_Responder.h"
+#include "SAE_J1939_21_Statistics.h"
+#include "SAE_J1939_21_Trace.h"
+#include "SAE_J1939_22_FD_Transport.h"
+#include "SAE_J1939_22_Multi_PG.h"
+#include "SAE_J1939_73_Diagnostics.h"
+#include "SAE_J1939_81_Network_Management_Layer.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_SEND_OK							(0U)
+#define J1939_SEND_BUSY							(1U)	// No free session or TX slot
+#define J1939_SEND_INVALID						(2U)	// Wrong size or priority
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief Data links of an instance.
+ */
+typedef enum
+{
+	J1939_DATA_LINK_CLASSIC,						/* SAE J1939-21: 8-byte frames, TP and ETP */
+	J1939_DATA_LINK_FD								/* SAE J1939-22: CAN FD frames, multi-PG and FD.TP */
+} J1939_dataLinks;
+
+/**
+ * @brief A function called to queue a frame of the instance for transmission.
+ */
+typedef uint8_t (*J1939_sendFrameHook)(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t dlc);
+
+/**
+ * @brief A function called to get the number of free TX slots of the channel of the instance.
+ */
+typedef uint8_t (*J1939_freeTxSlotsHook)(uint8_t channel);
+
+/**
+ * @brief A function called to queue a CAN FD frame of the instance for transmission.
+ */
+typedef uint8_t (*J1939_sendFDFrameHook)(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t length);
+
+/**
+ * @brief The SAE J1939 stack of one CAN channel.
+ */
+struct J1939_instance
+{
+	uint8_t channel;								/* The CAN channel passed to the port and the TX hooks */
+	J1939_sendFrameHook send_frame;					/* Queues a frame, J1939_portSendFrame by default */
+	J1939_freeTxSlotsHook get_free_tx_slots;		/* Free TX slots, J1939_portGetFreeTxSlots by default */
+	J1939_sendFDFrameHook send_fd_frame;			/* Queues a CAN FD frame, J1939_portSendFDFrame by default */
+	J1939_dataLinks data_link;						/* The data link of the messages sent by J1939_sendPGN */
+
+	J1939_networkManagement NM;						/* The ECU address, the address claim and the NAME table */
+	J1939_transportLayer TP;						/* TP sessions and sinks */
+	J1939_extendedTransport ETP;					/* ETP sessions */
+	J1939_FDtransport FDTP;							/* FD.TP sessions */
+	J1939_multiPG multi_PG;							/* Multi-PG frames being packed */
+	J1939_dispatcher dispatcher;					/* PGN handlers */
+	J1939_acceptanceFilters filters;				/* Hardware acceptance filters */
+	J1939_memoryPool pool;							/* TP receive buffers */
+	J1939_messageQueue message_queue;				/* Completed messages handed to the consumer task */
+	J1939_timerWheel timer_wheel;					/* Session and address claim timers */
+	J1939_txScheduler tx_scheduler;					/* Priority queues in front of the TX hooks */
+	J1939_cyclicTransmit cyclic;					/* Cyclic PGNs */
+	J1939_requestResponder responder;				/* Responses to the Request PGN */
+	J1939_diagnostics diagnostics;					/* DTCs of the ECU, DM1 and DM2, DM1s of other ECUs */
+	J1939_statistics statistics;					/* Frame and session counters */
+#if (J1939_TRACE_ENABLE == 1U)
+	J1939_traceRing trace;							/* The latest protocol events */
+#endif
+};
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to initialize the instance of the CAN channel. All layers are reset,
+ * 			the frames are sent by the port functions. It mustn't be called while the instance is in use.
+ * @param	instance - A pointer to the instance.
+ * @param	channel - The CAN channel.
+ * @retval	None.
+ */
+void J1939_initInstance(J1939_instance* instance, uint8_t channel);
+
+/**
+ * @brief 	This function is used to replace the functions which send the frames of the instance,
+ * 			e.g. to put a TX queue or a trace between the stack and the port.
+ * @param	instance - A pointer to the instance.
+ * @param	sendFrame - A function to queue a frame. NULL - J1939_portSendFrame.
+ * @param	getFreeTxSlots - A function to get the number of free TX slots. NULL - J1939_portGetFreeTxSlots.
+ * @retval	None.
+ */
+void J1939_setTxHooks(J1939_instance* instance, J1939_sendFrameHook sendFrame, J1939_freeTxSlotsHook getFreeTxSlots);
+
+/**
+ * @brief 	This function is used to replace the function which sends the CAN FD frames of the instance.
+ * @param	instance - A pointer to the instance.
+ * @param	sendFDFrame - A function to queue a CAN FD frame. NULL - J1939_portSendFDFrame.
+ * @retval	None.
+ */
+void J1939_setFDTxHook(J1939_instance* instance, J1939_sendFDFrameHook sendFDFrame);
+
+/**
+ * @brief 	This function is used to select the data link of the instance. The frames of both data links are
+ * 			received, the multi-PG and FD.TP frames only by an instance with the CAN FD data link.
+ * @param	instance - A pointer to the instance.
+ * @param	dataLink - J1939_DATA_LINK_CLASSIC (by default) or J1939_DATA_LINK_FD.
+ * @retval	None.
+ */
+void J1939_setDataLink(J1939_instance* instance, J1939_dataLinks dataLink);
+
+/**
+ * @brief 	This function is used to queue a frame of the instance for transmission. If the TX scheduler
+ * 			is enabled, the frame waits in the queue of its priority.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_sendFrame(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t dlc);
+
+/**
+ * @brief 	This function is used to queue a CAN FD frame of the instance for transmission. CAN FD frames
+ * 			don't wait in the TX scheduler, whose entries hold 8 bytes.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	length - The number of data bytes: 0 to 8, 12, 16, 20, 24, 32, 48 or 64.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_sendFDFrame(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t length);
+
+/**
+ * @brief 	This function is used to send a message by the data link of the instance. Classic: up to 8 bytes
+ * 			in a frame, longer messages by TP (BAM or RTS/CTS). CAN FD: up to J1939_MULTI_PG_MAX_PAYLOAD
+ * 			bytes as a C-PG of a multi-PG frame, longer messages by FD.TP. A multi-packet message isn't
+ * 			copied, it mustn't be changed until its session is closed.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	priority - The priority of a single frame or a C-PG from 0 (the highest) to 7. Multi-packet
+ * 			messages are sent with the priority of TP.
+ * @param	destinationAddress - ECU address to send data to. 255 - broadcast.
+ * @param	data - A pointer to the data.
+ * @param	size - The size of the data.
+ * @retval	J1939_SEND_OK, J1939_SEND_BUSY or J1939_SEND_INVALID.
+ */
+uint8_t J1939_sendPGN(J1939_instance* instance, uint32_t PGN, uint8_t priority, uint8_t destinationAddress, uint8_t* data, uint16_t size);
+
+/**
+ * @brief 	This function is used to get the number of frames of the instance that can be queued
+ * 			for transmission without waiting. If the TX scheduler is enabled, it is the number of free
+ * 			entries of its queue left for TP and ETP packages.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of free TX slots.
+ */
+uint8_t J1939_getFreeTxSlots(J1939_instance* instance);
+
+#endif /* __SAE_J1939_21_INSTANCE_H */
@@ -0,0 +1,158 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Memory_Pool.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the fixed-block memory pool for SAE J1939-21
+  * 		 Transport Layer receive buffers.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_21_MEMORY_POOL_H
+#define __SAE_J1939_21_MEMORY_POOL_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_Port.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+
+// Block sizes and the number of blocks of each size class.
+// They can be redefined in the compiler options.
+#ifndef J1939_POOL_SMALL_BLOCK_SIZE
+#define J1939_POOL_SMALL_BLOCK_SIZE				(64U)
+#endif
+
+#ifndef J1939_POOL_SMALL_BLOCKS
+#define J1939_POOL_SMALL_BLOCKS					(8U)
+#endif
+
+#ifndef J1939_POOL_MEDIUM_BLOCK_SIZE
+#define J1939_POOL_MEDIUM_BLOCK_SIZE			(256U)
+#endif
+
+#ifndef J1939_POOL_MEDIUM_BLOCKS
+#define J1939_POOL_MEDIUM_BLOCKS				(4U)
+#endif
+
+#ifndef J1939_POOL_LARGE_BLOCK_SIZE
+#define J1939_POOL_LARGE_BLOCK_SIZE				(1785U)
+#endif
+
+#ifndef J1939_POOL_LARGE_BLOCKS
+#define J1939_POOL_LARGE_BLOCKS					(2U)
+#endif
+
+// 1 - the platform heap is used when there is no free block of a suitable size, 0 - isn't used
+#ifndef J1939_POOL_USE_HEAP_FALLBACK
+#define J1939_POOL_USE_HEAP_FALLBACK			(0U)
+#endif
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief Memory pool size classes enumeration.
+ */
+typedef enum
+{
+	J1939_POOL_CLASS_SMALL,					/* Blocks of J1939_POOL_SMALL_BLOCK_SIZE bytes */
+	J1939_POOL_CLASS_MEDIUM,				/* Blocks of J1939_POOL_MEDIUM_BLOCK_SIZE bytes */
+	J1939_POOL_CLASS_LARGE,					/* Blocks of J1939_POOL_LARGE_BLOCK_SIZE bytes */
+	J1939_POOL_CLASS_HEAP,					/* Blocks allocated from the heap when the pool is exhausted */
+	J1939_POOL_CLASSES						/* The number of size classes */
+} J1939_poolClasses;
+
+/**
+ * @brief Memory pool statistics of a size class.
+ */
+typedef struct
+{
+	uint16_t block_size;					/* Size of a block in bytes. 0 - variable size (heap) */
+	uint16_t number_of_blocks;				/* The number of blocks in the class. 0 - unlimited (heap) */
+	uint16_t used_blocks;					/* The number of allocated blocks */
+	uint16_t max_used_blocks;				/* High-water mark of allocated blocks */
+	uint32_t allocations;					/* The number of successful allocations */
+	uint32_t failures;						/* The number of allocations that fell through this class */
+} J1939_poolStatistics;
+
+/**
+ * @brief Memory pool size class.
+ */
+typedef struct
+{
+	uint8_t* blocks;						/* Storage of the class */
+	uint16_t* next_free;					/* The number of the next free block by the block number */
+	uint16_t free_head;						/* The number of the first free block */
+	J1939_poolStatistics statistics;		/* Statistics of the class */
+} J1939_poolClass;
+
+/**
+ * @brief Memory pool of an instance.
+ */
+typedef struct
+{
+	uint8_t small_blocks[J1939_POOL_SMALL_BLOCKS * J1939_POOL_SMALL_BLOCK_SIZE];
+	uint8_t medium_blocks[J1939_POOL_MEDIUM_BLOCKS * J1939_POOL_MEDIUM_BLOCK_SIZE];
+	uint8_t large_blocks[J1939_POOL_LARGE_BLOCKS * J1939_POOL_LARGE_BLOCK_SIZE];
+	uint16_t small_next_free[J1939_POOL_SMALL_BLOCKS];
+	uint16_t medium_next_free[J1939_POOL_MEDIUM_BLOCKS];
+	uint16_t large_next_free[J1939_POOL_LARGE_BLOCKS];
+	J1939_poolClass classes[J1939_POOL_CLASSES];
+} J1939_memoryPool;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to link all blocks of each size class of the instance into the free lists.
+ * 			It is called by J1939_initInstance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initPool(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to allocate a block of the smallest size class that fits the requested
+ * 			size. If the class is exhausted, larger classes and then the heap (if enabled) are used.
+ * @param	instance - A pointer to the instance.
+ * @param	size - The requested size in bytes.
+ * @retval	A pointer to the allocated block. NULL if there is no free block.
+ */
+void* J1939_poolAllocate(J1939_instance* instance, uint16_t size);
+
+/**
+ * @brief 	This function is used to return a block to the pool.
+ * @param	instance - A pointer to the instance which allocated the block.
+ * @param	block - A pointer to the block allocated by J1939_poolAllocate. NULL is ignored.
+ * @retval	None.
+ */
+void J1939_poolFree(J1939_instance* instance, void* block);
+
+/**
+ * @brief 	This function is used to get the statistics of a size class.
+ * @param	instance - A pointer to the instance.
+ * @param	poolClass - The size class.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getPoolStatistics(J1939_instance* instance, J1939_poolClasses poolClass, J1939_poolStatistics* statistics);
+
+/**
+ * @brief 	This function is used to reset the high-water marks and the counters of all size classes.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetPoolStatistics(J1939_instance* instance);
+
+#endif /* __SAE_J1939_21_MEMORY_POOL_H */
@@ -0,0 +1,185 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Message_Queue.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the queue of completed multi-packet messages. A
+  * 		 message received by TP or FD.TP is handed to the queue with its
+  * 		 receive buffer, so the session is closed at once and the next
+  * 		 message of the peer is accepted while the consumer task still
+  * 		 works on the previous ones. The consumer takes the messages with
+  * 		 their buffers and releases the buffers, which the stack returns
+  * 		 to the pool. The task of the instance is the only producer and
+  * 		 the consumer task the only consumer, so no lock is required.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_21_MESSAGE_QUEUE_H
+#define __SAE_J1939_21_MESSAGE_QUEUE_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Transport_Layer.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+
+// The number of messages queued or held by the consumer, must be a power of two.
+// It can be redefined in the compiler options.
+#ifndef J1939_MESSAGE_QUEUE_SIZE
+#define J1939_MESSAGE_QUEUE_SIZE				(8U)
+#endif
+
+#if ((J1939_MESSAGE_QUEUE_SIZE & (J1939_MESSAGE_QUEUE_SIZE - 1U)) != 0U) || (J1939_MESSAGE_QUEUE_SIZE > 128U)
+	#error "J1939_MESSAGE_QUEUE_SIZE must be a power of two up to 128"
+#endif
+
+#define J1939_QUEUE_OK							(0U)
+#define J1939_QUEUE_FULL						(1U)
+#define J1939_QUEUE_INVALID						(2U)	// The queue is disabled or the message has no buffer
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A completed message. The buffer is owned by the consumer from J1939_getQueuedMessage
+ * 		  to J1939_releaseMessage.
+ */
+typedef struct
+{
+	uint32_t PGN;									/* The PGN of the message */
+	uint32_t time;									/* The completion time, ms */
+	uint8_t* data;									/* The receive buffer of the session */
+	uint16_t size;									/* The message size */
+	uint8_t source_address;							/* The originator */
+	uint8_t destination_address;					/* The recipient. 255 - broadcast */
+} J1939_receivedMessage;
+
+/**
+ * @brief Message queue statistics.
+ */
+typedef struct
+{
+	uint32_t queued;								/* Messages handed to the queue */
+	uint32_t dropped;								/* Messages dropped because the queue was full */
+	uint32_t max_pending;							/* The most messages queued and held at the same time */
+} J1939_messageQueueStatistics;
+
+/**
+ * @brief Message queue of an instance. The indexes run freely and are reduced to a slot number by the mask.
+ * 		  A message occupies its slot from J1939_queueMessage until its buffer is reclaimed, so the released
+ * 		  ring can't overflow.
+ */
+typedef struct
+{
+	volatile uint32_t head;							/* Messages queued. Written by the stack only */
+	volatile uint32_t tail;							/* Messages taken. Written by the consumer only */
+	volatile uint32_t released;						/* Messages released. Written by the consumer only */
+	uint32_t reclaimed;								/* Buffers returned to the pool. Written by the stack only */
+	uint8_t depth;									/* The most messages queued and held. 0 - the queue is disabled */
+	J1939_receivedMessage messages[J1939_MESSAGE_QUEUE_SIZE];			/* Queued messages */
+	J1939_receivedMessage released_messages[J1939_MESSAGE_QUEUE_SIZE];	/* Released messages to reclaim */
+	J1939_messageQueueStatistics statistics;
+} J1939_messageQueue;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to reset the queue. It is called by J1939_initInstance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initMessageQueue(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to hand the messages completed by the dispatcher to the queue after their
+ * 			handlers. A message is dropped while depth messages are queued or held by the consumer.
+ * 			It must be called by the task of the instance.
+ * @param	instance - A pointer to the instance.
+ * @param	depth - The most messages queued and held, up to J1939_MESSAGE_QUEUE_SIZE. 0 - disable the queue,
+ * 			the messages are freed after their handlers.
+ * @retval	None.
+ */
+void J1939_enableMessageQueue(J1939_instance* instance, uint8_t depth);
+
+/**
+ * @brief 	This function is used to hand a completed message with its buffer allocated from the pool to the queue.
+ * 			Called by the task of the instance only.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN of the message.
+ * @param	sourceAddress - The originator.
+ * @param	destinationAddress - The recipient.
+ * @param	data - The buffer allocated by J1939_poolAllocate. It is owned by the queue if J1939_QUEUE_OK is returned.
+ * @param	size - The message size.
+ * @retval	J1939_QUEUE_OK, J1939_QUEUE_FULL or J1939_QUEUE_INVALID.
+ */
+uint8_t J1939_queueMessage(J1939_instance* instance, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+						   uint8_t* data, uint16_t size);
+
+/**
+ * @brief 	This function is used to hand the message of a TP session which has returned J1939_STATUS_DATA_FINISHED
+ * 			to the queue. The buffer is taken from the session, so it can be closed at once.
+ * 			Called by the task of the instance only.
+ * @param	session - A pointer to the TP session.
+ * @retval	J1939_QUEUE_OK, J1939_QUEUE_FULL or J1939_QUEUE_INVALID. The session keeps the buffer if not J1939_QUEUE_OK.
+ */
+uint8_t J1939_queueReceivedMessage(J1939_TP_session* session);
+
+/**
+ * @brief 	This function is used to take the oldest queued message. Called by the consumer only.
+ * @param	instance - A pointer to the instance.
+ * @param	message - A pointer to store the message. Its buffer must be given back by J1939_releaseMessage.
+ * @retval	1 - a message is taken, 0 - the queue is empty.
+ */
+uint8_t J1939_getQueuedMessage(J1939_instance* instance, J1939_receivedMessage* message);
+
+/**
+ * @brief 	This function is used to give back the buffer of a taken message. The buffer is returned to the pool
+ * 			by the task of the instance. Called by the consumer only.
+ * @param	instance - A pointer to the instance.
+ * @param	message - A pointer to the message taken by J1939_getQueuedMessage.
+ * @retval	None.
+ */
+void J1939_releaseMessage(J1939_instance* instance, const J1939_receivedMessage* message);
+
+/**
+ * @brief 	This function is used to return the buffers of the released messages to the pool. It is called before
+ * 			a receive buffer is allocated and a message is queued. Called by the task of the instance only.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_reclaimMessages(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to get the number of queued messages.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of messages waiting for the consumer.
+ */
+uint32_t J1939_getQueuedMessages(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to get the message queue statistics.
+ * @param	instance - A pointer to the instance.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getMessageQueueStatistics(J1939_instance* instance, J1939_messageQueueStatistics* statistics);
+
+/**
+ * @brief 	This function is used to reset the message queue statistics.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetMessageQueueStatistics(J1939_instance* instance);
+
+#endif /* __SAE_J1939_21_MESSAGE_QUEUE_H */
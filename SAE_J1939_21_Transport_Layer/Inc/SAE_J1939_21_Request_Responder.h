@@ -0,0 +1,192 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Request_Responder.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the responder to the Request PGN (0xEA00). The
+  * 		 requested PGNs are answered from the response encoded by their
+  * 		 provider, which is kept until the application marks it dirty.
+  * 		 The requests received within one response window are answered
+  * 		 together: the duplicates of a requester are dropped and a global
+  * 		 request is answered once for all requesters.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_21_REQUEST_RESPONDER_H
+#define __SAE_J1939_21_REQUEST_RESPONDER_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Timer_Wheel.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+
+// The number of PGNs answered by the responder, the number of requesters kept per PGN before the
+// response is broadcast, the time the requests are collected before the response and the time after
+// which a response not queued for the lack of a TX slot or a TP session is sent again, ms.
+// They can be redefined in the compiler options.
+#ifndef J1939_MAX_REQUESTED_PGNS
+#define J1939_MAX_REQUESTED_PGNS				(16U)
+#endif
+
+#ifndef J1939_REQUEST_MAX_REQUESTERS
+#define J1939_REQUEST_MAX_REQUESTERS			(4U)
+#endif
+
+#ifndef J1939_REQUEST_RESPONSE_WINDOW
+#define J1939_REQUEST_RESPONSE_WINDOW			(10U)	// Far below the 200 ms response time of J1939-21
+#endif
+
+#ifndef J1939_REQUEST_RETRY_TIME
+#define J1939_REQUEST_RETRY_TIME				(1U)
+#endif
+
+// 1 - the requests addressed to the ECU for PGNs without a provider are answered by NACK, as J1939-21
+// requires. 0 - they are left to the handlers of the Request PGN. It can be redefined in the compiler options.
+#ifndef J1939_REQUEST_NACK_UNKNOWN
+#define J1939_REQUEST_NACK_UNKNOWN				(0U)
+#endif
+
+#if (J1939_MAX_REQUESTED_PGNS > 254U) || (J1939_REQUEST_MAX_REQUESTERS == 0U)
+	#error "J1939_MAX_REQUESTED_PGNS must be less than 255 and J1939_REQUEST_MAX_REQUESTERS above 0"
+#endif
+
+#define J1939_REQUEST_OK						(0U)
+#define J1939_REQUEST_NO_SLOT					(1U)
+#define J1939_REQUEST_INVALID					(2U)
+#define J1939_REQUEST_BUSY						(3U)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A function called to encode the response to a requested PGN. It returns the response size,
+ * 		  0 - the PGN isn't available and the requests addressed to the ECU are answered by NACK.
+ */
+typedef uint16_t (*J1939_requestProvider)(void* context, uint32_t PGN, uint8_t* data, uint16_t maxSize);
+
+/**
+ * @brief A PGN answered by the responder.
+ */
+typedef struct
+{
+	uint32_t PGN;									/* The PGN */
+	J1939_requestProvider provider;					/* Encodes the response. NULL - the slot is free */
+	void* context;									/* A user pointer passed to the provider */
+	uint8_t* buffer;								/* The response above 8 bytes sent by TP. NULL - single frames only */
+	uint16_t buffer_size;							/* The size of the buffer */
+	uint16_t size;									/* The size of the encoded response */
+	uint8_t data[8];								/* The encoded response up to 8 bytes */
+	uint8_t priority;								/* The priority of the single frame */
+	uint8_t dirty;									/* 1 - the response is encoded again before it is sent */
+	uint8_t global_request;							/* 1 - a request to all ECUs is waiting for the response */
+	uint8_t number_of_requesters;					/* The number of requests addressed to the ECU waiting */
+	uint8_t requesters[J1939_REQUEST_MAX_REQUESTERS];	/* Their source addresses */
+} J1939_requestedPGN;
+
+/**
+ * @brief Request responder statistics.
+ */
+typedef struct
+{
+	uint32_t requests;								/* Requests for the PGNs of the responder */
+	uint32_t coalesced;								/* Requests answered by a response already waiting */
+	uint32_t responses;								/* Single frames, BAM and RTS/CTS sessions sent */
+	uint32_t encodings;								/* Calls of the providers */
+	uint32_t cache_hits;							/* Responses sent without calling the provider */
+	uint32_t NACKs;									/* Negative acknowledgements sent */
+	uint32_t deferred;								/* Attempts to respond put off for the lack of a TX slot or a TP session */
+} J1939_requestStatistics;
+
+/**
+ * @brief Request responder of an instance.
+ */
+typedef struct
+{
+	J1939_requestedPGN PGNs[J1939_MAX_REQUESTED_PGNS];
+	J1939_timer timer;								/* Expires at the end of the response window */
+	J1939_requestStatistics statistics;
+} J1939_requestResponder;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to register the provider of a requested PGN or to replace it. The response
+ * 			is encoded at the first request and kept until J1939_markResponseDirty is called.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	priority - The priority of the single frame response from 0 to 7.
+ * @param	provider - A function to encode the response.
+ * @param	context - A user pointer passed to the provider.
+ * @retval	J1939_REQUEST_OK, J1939_REQUEST_NO_SLOT if there are no free slots or J1939_REQUEST_INVALID.
+ */
+uint8_t J1939_registerRequestedPGN(J1939_instance* instance, uint32_t PGN, uint8_t priority,
+								   J1939_requestProvider provider, void* context);
+
+/**
+ * @brief 	This function is used to stop answering the requests for the PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @retval	None.
+ */
+void J1939_unregisterRequestedPGN(J1939_instance* instance, uint32_t PGN);
+
+/**
+ * @brief 	This function is used to give the requested PGN a buffer for responses above 8 bytes. They are sent
+ * 			by RTS/CTS to each requester or by BAM straight from the buffer, so it mustn't be changed
+ * 			by the application.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	buffer - The buffer. NULL - single frames only.
+ * @param	bufferSize - The size of the buffer, up to 1785 bytes.
+ * @retval	J1939_REQUEST_OK, J1939_REQUEST_INVALID or J1939_REQUEST_BUSY if the buffer is being sent.
+ */
+uint8_t J1939_setResponseBuffer(J1939_instance* instance, uint32_t PGN, uint8_t* buffer, uint16_t bufferSize);
+
+/**
+ * @brief 	This function is used to tell that the data of the PGN has been changed, so its response is encoded
+ * 			again by the provider before it is sent next time.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @retval	None.
+ */
+void J1939_markResponseDirty(J1939_instance* instance, uint32_t PGN);
+
+/**
+ * @brief 	This function is used to read a request. It is called by the dispatcher, the response is sent by
+ * 			J1939_processTimers at the end of the response window.
+ * @param	instance - A pointer to the instance.
+ * @param	sourceAddress - The address of the requester.
+ * @param	destinationAddress - The destination address of the request.
+ * @param	PGN - The requested PGN.
+ * @retval	None.
+ */
+void J1939_readRequest(J1939_instance* instance, uint8_t sourceAddress, uint8_t destinationAddress, uint32_t PGN);
+
+/**
+ * @brief 	This function is used to get the request responder statistics.
+ * @param	instance - A pointer to the instance.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getRequestStatistics(J1939_instance* instance, J1939_requestStatistics* statistics);
+
+/**
+ * @brief 	This function is used to reset the request responder statistics.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetRequestStatistics(J1939_instance* instance);
+
+#endif /* __SAE_J1939_21_REQUEST_RESPONDER_H */
@@ -0,0 +1,208 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Statistics.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the runtime statistics of the SAE J1939 stack.
+  * 		 The frames of the instance and the TP and ETP sessions of each
+  * 		 type are counted where they are processed, the CTS round trips
+  * 		 and the transfer times are kept in histograms. The counters can
+  * 		 be published on a proprietary PGN.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_21_STATISTICS_H
+#define __SAE_J1939_21_STATISTICS_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Transport_Layer.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+
+// The number of histogram bins. Bin 0 counts the times below 1 ms, bin n - the times from 2^(n-1)
+// to 2^n - 1 ms, the last bin - all longer times. It can be redefined in the compiler options.
+#ifndef J1939_STATISTICS_HISTOGRAM_BINS
+#define J1939_STATISTICS_HISTOGRAM_BINS			(12U)
+#endif
+
+#if (J1939_STATISTICS_HISTOGRAM_BINS < 2U) || (J1939_STATISTICS_HISTOGRAM_BINS > 32U)
+	#error "J1939_STATISTICS_HISTOGRAM_BINS must be from 2 to 32"
+#endif
+
+// The version of the layout of the published message
+#define J1939_STATISTICS_LAYOUT_VERSION			(2U)
+
+// The published message: the layout version, the number of session types, the frames received, sent and
+// not queued, the peak of the TP receive buffers (4 bytes each) and 25 bytes per session type: opened,
+// completed, aborted, busy, allocation failures, retransmitted packages (4 bytes each) and the most
+// concurrent sessions. All values are little-endian.
+#define J1939_STATISTICS_SESSION_RECORD_SIZE	(25U)
+#define J1939_STATISTICS_MESSAGE_SIZE			(18U + (J1939_STATISTICS_SESSION_TYPES * J1939_STATISTICS_SESSION_RECORD_SIZE))
+
+#define J1939_STATISTICS_OK						(0U)
+#define J1939_STATISTICS_INVALID				(1U)
+#define J1939_STATISTICS_NO_SLOT				(2U)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief Session types counted by the statistics.
+ */
+typedef enum
+{
+	J1939_STATISTICS_TP_BAM_RX,				/* Broadcast multi-packet messages received */
+	J1939_STATISTICS_TP_PTP_RX,				/* RTS/CTS multi-packet messages received */
+	J1939_STATISTICS_TP_BAM_TX,				/* Broadcast multi-packet messages sent */
+	J1939_STATISTICS_TP_PTP_TX,				/* RTS/CTS multi-packet messages sent */
+	J1939_STATISTICS_ETP_RX,				/* Extended transport messages received */
+	J1939_STATISTICS_ETP_TX,				/* Extended transport messages sent */
+	J1939_STATISTICS_FD_TP_RX,				/* FD transport messages received (BAM and RTS/CTS) */
+	J1939_STATISTICS_FD_TP_TX,				/* FD transport messages sent (BAM and RTS/CTS) */
+	J1939_STATISTICS_SESSION_TYPES			/* The number of session types */
+} J1939_statisticsSessionTypes;
+
+/**
+ * @brief Abort reasons counted by the statistics.
+ */
+typedef enum
+{
+	J1939_ABORT_SLOT_BUSY,					/* J1939_REASON_BUSY */
+	J1939_ABORT_SLOT_TIMEOUT,				/* J1939_REASON_TIMEOUT, also the broadcast messages timed out */
+	J1939_ABORT_SLOT_RETRANSMIT_LIMIT,		/* J1939_REASON_RETRANSMIT_LIMIT, also the broadcast messages with lost packages */
+	J1939_ABORT_SLOT_TOO_BIG_MESSAGE,		/* J1939_REASON_TOO_BIG_MESSAGE */
+	J1939_ABORT_SLOT_MEMORY_ALLOCATION,		/* J1939_REASON_MEMORY_ALLOCATION_ERROR */
+	J1939_ABORT_SLOT_OTHER,					/* Other reasons of the peers, also the broadcast messages replaced by a new one */
+	J1939_ABORT_SLOTS						/* The number of abort slots */
+} J1939_abortSlots;
+
+/**
+ * @brief Statistics of the sessions of one type.
+ */
+typedef struct
+{
+	uint32_t opened;											/* Sessions opened */
+	uint32_t completed;											/* Messages transferred completely */
+	uint32_t aborts[J1939_ABORT_SLOTS];							/* Sessions aborted or lost by the reason */
+	uint32_t peer_aborts;										/* Aborts among them sent by the peers */
+	uint32_t busy;												/* Sessions not opened: no free slot or a session
+																   with the peer is open */
+	uint32_t allocation_failures;								/* Receive buffers not allocated */
+	uint32_t retransmitted_packages;							/* Packages requested by CTS again */
+	uint8_t active;												/* Sessions open now */
+	uint8_t max_active;											/* The most sessions open at the same time */
+	uint32_t CTS_round_trip[J1939_STATISTICS_HISTOGRAM_BINS];	/* From CTS to its first package (RX) or from RTS
+																   or the end of the window to CTS (TX), ms */
+	uint32_t transfer_time[J1939_STATISTICS_HISTOGRAM_BINS];	/* From the opening to the completion, ms */
+} J1939_sessionStatistics;
+
+/**
+ * @brief Statistics of an instance. Every counter is written only by the task of the instance, so it can be
+ * 		  read without a lock, a 32-bit counter at once.
+ */
+typedef struct
+{
+	uint32_t frames_received;						/* Frames passed to J1939_dispatchFrame */
+	uint32_t frames_sent;							/* Frames queued by J1939_sendFrame */
+	uint32_t frames_not_sent;						/* Frames J1939_sendFrame couldn't queue */
+	uint32_t buffer_bytes;							/* Bytes of the TP receive buffers allocated now */
+	uint32_t max_buffer_bytes;						/* The most bytes of the TP receive buffers allocated */
+	J1939_sessionStatistics sessions[J1939_STATISTICS_SESSION_TYPES];
+	uint8_t message[J1939_STATISTICS_MESSAGE_SIZE];	/* The published message */
+} J1939_statistics;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to copy the statistics of the instance.
+ * @param	instance - A pointer to the instance.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getStatistics(J1939_instance* instance, J1939_statistics* statistics);
+
+/**
+ * @brief 	This function is used to reset the counters and the histograms of the instance. The sessions open now
+ * 			and the allocated buffers are kept. It must be called by the task of the instance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetStatistics(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to publish the statistics as a cyclic PGN, by BAM (J1939_STATISTICS_MESSAGE_SIZE).
+ * 			The histograms aren't published.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - Proprietary A (0xEF00) or Proprietary B (0xFF00 to 0xFFFF) PGN.
+ * @param	period - Transmission period, ms. 0 - the publication is stopped.
+ * @retval	J1939_STATISTICS_OK, J1939_STATISTICS_INVALID or J1939_STATISTICS_NO_SLOT if there are no free cyclic PGNs.
+ */
+uint8_t J1939_publishStatistics(J1939_instance* instance, uint32_t PGN, uint32_t period);
+
+/**
+ * @brief 	This function is used to count an opened session. It is called by the transport layers.
+ * @param	instance - A pointer to the instance.
+ * @param	type - The session type.
+ * @retval	None.
+ */
+void J1939_countSessionOpened(J1939_instance* instance, J1939_statisticsSessionTypes type);
+
+/**
+ * @brief 	This function is used to count a closed session. It is called by the transport layers.
+ * @param	instance - A pointer to the instance.
+ * @param	type - The session type.
+ * @retval	None.
+ */
+void J1939_countSessionClosed(J1939_instance* instance, J1939_statisticsSessionTypes type);
+
+/**
+ * @brief 	This function is used to count a completely transferred message. It is called by the transport layers.
+ * @param	instance - A pointer to the instance.
+ * @param	type - The session type.
+ * @param	openTime - The time the session was opened, ms.
+ * @retval	None.
+ */
+void J1939_countSessionCompleted(J1939_instance* instance, J1939_statisticsSessionTypes type, uint32_t openTime);
+
+/**
+ * @brief 	This function is used to count an aborted session. It is called by the transport layers.
+ * @param	instance - A pointer to the instance.
+ * @param	type - The session type.
+ * @param	reason - The abort reason.
+ * @param	peer - 1 - the abort has been sent by the peer, 0 - by the instance.
+ * @retval	None.
+ */
+void J1939_countSessionAbort(J1939_instance* instance, J1939_statisticsSessionTypes type, uint8_t reason, uint8_t peer);
+
+/**
+ * @brief 	This function is used to count a CTS round trip. It is called by the transport layers.
+ * @param	instance - A pointer to the instance.
+ * @param	type - The session type.
+ * @param	startTime - The time CTS, RTS or the last package of the window was sent, ms.
+ * @retval	None.
+ */
+void J1939_countCTSroundTrip(J1939_instance* instance, J1939_statisticsSessionTypes type, uint32_t startTime);
+
+/**
+ * @brief 	This function is used to count the allocation or the release of a TP receive buffer.
+ * 			It is called by the transport layer.
+ * @param	instance - A pointer to the instance.
+ * @param	size - The size of the buffer.
+ * @param	allocated - 1 - the buffer has been allocated, 0 - released.
+ * @retval	None.
+ */
+void J1939_countBufferUsage(J1939_instance* instance, uint16_t size, uint8_t allocated);
+
+#endif /* __SAE_J1939_21_STATISTICS_H */
@@ -0,0 +1,166 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_TX_Scheduler.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the priority-aware TX scheduler. The frames of the
+  * 		 instance wait in a queue per J1939 priority and the free TX
+  * 		 mailboxes are always given to the frame of the highest priority,
+  * 		 so a long TP transfer can't delay single-frame control messages.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_21_TX_SCHEDULER_H
+#define __SAE_J1939_21_TX_SCHEDULER_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_Port.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+
+// The number of frames waiting for a TX mailbox and the number of them kept for frames other than
+// TP and ETP packages. They can be redefined in the compiler options.
+#ifndef J1939_TX_QUEUE_SIZE
+#define J1939_TX_QUEUE_SIZE						(32U)
+#endif
+
+#ifndef J1939_TX_RESERVED_ENTRIES
+#define J1939_TX_RESERVED_ENTRIES				(4U)
+#endif
+
+#if (J1939_TX_QUEUE_SIZE > 254U) || (J1939_TX_RESERVED_ENTRIES >= J1939_TX_QUEUE_SIZE)
+	#error "J1939_TX_QUEUE_SIZE must be below 255 and above J1939_TX_RESERVED_ENTRIES"
+#endif
+
+#define J1939_NUMBER_OF_PRIORITIES				(8U)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A frame waiting for a TX mailbox.
+ */
+typedef struct
+{
+	uint32_t can_id;							/* 29-bit CAN ID */
+	uint32_t queued_time;						/* The time the frame was queued, ms */
+	uint8_t dlc;								/* The number of data bytes */
+	uint8_t data[8];							/* Frame data */
+	uint8_t next;								/* The next frame of the same priority or the next free entry */
+} J1939_txQueueEntry;
+
+/**
+ * @brief TX scheduler statistics of a priority.
+ */
+typedef struct
+{
+	uint32_t frames;							/* Frames passed to the CAN controller */
+	uint32_t dropped;							/* Frames not queued because the queue was full */
+	uint32_t total_latency;						/* Sum of the times from queuing to the controller, ms */
+	uint32_t max_latency;						/* The longest time from queuing to the controller, ms */
+	uint8_t queued;								/* Frames waiting now */
+	uint8_t max_queued;							/* High-water mark of waiting frames */
+} J1939_txStatistics;
+
+/**
+ * @brief TX scheduler of an instance.
+ */
+typedef struct
+{
+	J1939_txQueueEntry entries[J1939_TX_QUEUE_SIZE];
+	uint8_t heads[J1939_NUMBER_OF_PRIORITIES];					/* The oldest frame of each priority */
+	uint8_t tails[J1939_NUMBER_OF_PRIORITIES];					/* The newest frame of each priority */
+	uint8_t free_head;											/* The first free entry */
+	uint8_t free_entries;										/* The number of free entries */
+	uint8_t pending_priorities;									/* Bit per priority, set if its queue isn't empty */
+	uint8_t enabled;											/* 1 - the frames of the instance are scheduled */
+	J1939_txStatistics statistics[J1939_NUMBER_OF_PRIORITIES];
+} J1939_txScheduler;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to link all entries of the TX queue into the free list. It is called
+ * 			by J1939_initInstance, the scheduler is disabled.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initTxScheduler(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to start scheduling the frames of the instance. J1939_sendFrame queues
+ * 			the frames by their priority and J1939_getFreeTxSlots reports the free entries of the queue
+ * 			except J1939_TX_RESERVED_ENTRIES, so the TP and ETP bursts leave room for other frames.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_enableTxScheduler(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to send the frames of the instance straight to the CAN controller again.
+ * 			The queued frames are still sent by J1939_processTxQueue.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_disableTxScheduler(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to queue a frame by the priority of its CAN ID. The frame is passed to
+ * 			the CAN controller at once if it has a free TX mailbox and no frame of the same or a higher
+ * 			priority is waiting.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_scheduleFrame(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t dlc);
+
+/**
+ * @brief 	This function is used to pass the queued frames to the free TX mailboxes, the highest
+ * 			priority first. It should be called by the task which sends the frames of the instance when
+ * 			a TX mailbox is released, e.g. notified by the TX mailbox empty interrupt, followed by
+ * 			J1939_sendTPpendingPackages to refill the queue.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of frames passed to the CAN controller.
+ */
+uint32_t J1939_processTxQueue(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to get the number of entries of the TX queue which can be used by
+ * 			TP and ETP packages.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of free entries.
+ */
+uint8_t J1939_getFreeTxQueueEntries(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to get the statistics of a priority.
+ * @param	instance - A pointer to the instance.
+ * @param	priority - The priority from 0 to 7.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getTxStatistics(J1939_instance* instance, uint8_t priority, J1939_txStatistics* statistics);
+
+/**
+ * @brief 	This function is used to reset the statistics of all priorities. The high-water marks are
+ * 			set to the frames waiting now.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetTxStatistics(J1939_instance* instance);
+
+#endif /* __SAE_J1939_21_TX_SCHEDULER_H */
@@ -0,0 +1,115 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Timer_Wheel.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the hashed timer wheel used for the SAE J1939-21
+  * 		 transport protocol timeouts and the BAM package gaps.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_21_TIMER_WHEEL_H
+#define __SAE_J1939_21_TIMER_WHEEL_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_Port.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+
+// The number of wheel slots (a power of two) and the time covered by one slot, ms.
+// They can be redefined in the compiler options.
+#ifndef J1939_TIMER_WHEEL_SLOTS
+#define J1939_TIMER_WHEEL_SLOTS					(64U)
+#endif
+
+#ifndef J1939_TIMER_WHEEL_RESOLUTION
+#define J1939_TIMER_WHEEL_RESOLUTION			(10U)
+#endif
+
+#if ((J1939_TIMER_WHEEL_SLOTS & (J1939_TIMER_WHEEL_SLOTS - 1U)) != 0U)
+	#error "J1939_TIMER_WHEEL_SLOTS must be a power of two"
+#endif
+
+#define J1939_TIMER_NO_DEADLINE					(0xFFFFFFFFU)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A function called when the timer expires.
+ */
+typedef void (*J1939_timerCallback)(void* context);
+
+/**
+ * @brief A timer of the wheel. It is embedded in the structure it belongs to.
+ */
+typedef struct J1939_timer
+{
+	struct J1939_timer* next;				/* The next timer in the slot */
+	struct J1939_timer* prev;				/* The previous timer in the slot */
+	uint32_t deadline;						/* Expiration time, ms */
+	J1939_timerCallback callback;			/* A function called on expiration */
+	void* context;							/* A user pointer passed to the callback */
+	uint16_t slot;							/* The wheel slot of the timer */
+	uint8_t armed;							/* 1 - the timer is in the wheel, 0 - isn't */
+} J1939_timer;
+
+/**
+ * @brief Timer wheel of an instance.
+ */
+typedef struct
+{
+	J1939_timer* slots[J1939_TIMER_WHEEL_SLOTS];	/* Timers by the deadline tick */
+	uint32_t current_tick;							/* The first tick to process */
+	uint32_t now_tick;								/* Ticks counted from the start of the wheel, they don't jump
+													   when the platform time wraps */
+	uint32_t tick_time;								/* The start of now_tick, ms */
+	uint32_t next_deadline;							/* The earliest deadline, valid if next_deadline_valid is 1 */
+	uint16_t armed_timers;							/* The number of armed timers */
+	uint8_t next_deadline_valid;					/* 1 - next_deadline is up to date, 0 - must be recalculated */
+	uint8_t started;								/* 1 - the ticks are counted, 0 - aren't */
+} J1939_timerWheel;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to start or restart the timer.
+ * @param	instance - A pointer to the instance whose wheel holds the timer.
+ * @param	timer - A pointer to the timer.
+ * @param	timeout - The time to expiration, ms.
+ * @param	callback - A function called on expiration.
+ * @param	context - A user pointer passed to the callback.
+ * @retval	None.
+ */
+void J1939_armTimer(J1939_instance* instance, J1939_timer* timer, uint32_t timeout, J1939_timerCallback callback, void* context);
+
+/**
+ * @brief 	This function is used to stop the timer. Stopping a stopped timer has no effect.
+ * @param	instance - A pointer to the instance whose wheel holds the timer.
+ * @param	timer - A pointer to the timer.
+ * @retval	None.
+ */
+void J1939_cancelTimer(J1939_instance* instance, J1939_timer* timer);
+
+/**
+ * @brief 	This function is used to call the callbacks of the expired timers. It is the single tick
+ * 			function of the instance and is called from the task which services it.
+ * @param	instance - A pointer to the instance.
+ * @retval	The time until the next deadline, ms. J1939_TIMER_NO_DEADLINE if no timer is armed,
+ * 			so the task can sleep until the next frame.
+ */
+uint32_t J1939_processTimers(J1939_instance* instance);
+
+#endif /* __SAE_J1939_21_TIMER_WHEEL_H */
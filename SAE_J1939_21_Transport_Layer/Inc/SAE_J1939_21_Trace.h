@@ -0,0 +1,184 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Trace.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the binary trace of the SAE J1939 stack. The frames,
+  * 		 the TP and ETP session states, CTS, aborts and receive buffers of
+  * 		 an instance are recorded as fixed-size records with the time of
+  * 		 the trace clock into a ring which keeps the latest records. The
+  * 		 trace is compiled only with J1939_TRACE_ENABLE set to 1.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_21_TRACE_H
+#define __SAE_J1939_21_TRACE_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_Port.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+
+// 1 - the events are recorded, 0 - the trace isn't compiled. It can be redefined in the compiler options.
+#ifndef J1939_TRACE_ENABLE
+#define J1939_TRACE_ENABLE						(0U)
+#endif
+
+// The number of records of the ring, must be a power of two. It can be redefined in the compiler options.
+#ifndef J1939_TRACE_SIZE
+#define J1939_TRACE_SIZE						(256U)
+#endif
+
+#if ((J1939_TRACE_SIZE & (J1939_TRACE_SIZE - 1U)) != 0U)
+	#error "J1939_TRACE_SIZE must be a power of two"
+#endif
+
+// The dump: the header followed by the records from the oldest one, in the byte order of the platform
+#define J1939_TRACE_MAGIC						(0x4A545243UL)	// "JTRC"
+#define J1939_TRACE_LAYOUT_VERSION				(1U)
+#define J1939_TRACE_DUMP_SIZE					(sizeof(J1939_traceDumpHeader) + (J1939_TRACE_SIZE * sizeof(J1939_traceRecord)))
+
+// Records an event of the instance, nothing if the trace isn't compiled
+#if (J1939_TRACE_ENABLE == 1U)
+	#define J1939_TRACE(instance, event, detail, value, argument0, argument1) \
+			J1939_traceEvent(&(instance)->trace, (event), (detail), (value), (argument0), (argument1))
+#else
+	#define J1939_TRACE(instance, event, detail, value, argument0, argument1)	((void)0)
+#endif
+
+// Records a frame event with the first two data bytes
+#define J1939_TRACE_FRAME(instance, event, canId, data, dlc) \
+		J1939_TRACE((instance), (event), (dlc), (canId), ((dlc) > 0U) ? (data)[0] : 0U, ((dlc) > 1U) ? (data)[1] : 0U)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief Events of the trace. A session is identified by its PGN, originator and recipient.
+ */
+typedef enum
+{
+	J1939_TRACE_FRAME_RX,					/* value - CAN ID, detail - DLC, arguments - data[0] and data[1] */
+	J1939_TRACE_FRAME_TX,					/* The same for a frame queued by J1939_sendFrame */
+	J1939_TRACE_FRAME_NOT_SENT,				/* The same for a frame J1939_sendFrame couldn't queue */
+	J1939_TRACE_SESSION_OPEN,				/* value - PGN, detail - J1939_statisticsSessionTypes,
+											   arguments - originator and recipient */
+	J1939_TRACE_SESSION_STATE,				/* The same, detail - the new J1939_states */
+	J1939_TRACE_SESSION_COMPLETE,			/* The same, detail - J1939_statisticsSessionTypes */
+	J1939_TRACE_SESSION_CLOSE,				/* The same, detail - J1939_statisticsSessionTypes */
+	J1939_TRACE_CTS_SENT,					/* The same, detail - the number of packages granted */
+	J1939_TRACE_CTS_RECEIVED,				/* The same, detail - the number of packages granted */
+	J1939_TRACE_ABORT_SENT,					/* The same, detail - the abort reason */
+	J1939_TRACE_ABORT_RECEIVED,				/* The same, detail - the abort reason */
+	J1939_TRACE_TIMEOUT,					/* The same, detail - the state timed out */
+	J1939_TRACE_BUFFER_ALLOCATED,			/* value - the size, arguments - originator and recipient */
+	J1939_TRACE_BUFFER_NOT_ALLOCATED,		/* The same */
+	J1939_TRACE_BUFFER_RELEASED,			/* The same */
+	J1939_TRACE_EVENTS						/* The number of events */
+} J1939_traceEvents;
+
+/**
+ * @brief A record of the trace.
+ */
+typedef struct
+{
+	uint32_t timestamp;						/* The time of the trace clock */
+	uint32_t value;							/* CAN ID, PGN or size */
+	uint8_t event;							/* J1939_traceEvents */
+	uint8_t detail;							/* DLC, state, session type, packages or reason */
+	uint8_t arguments[2];					/* Frame data or session addresses */
+} J1939_traceRecord;
+
+/**
+ * @brief The ring of the trace records. It is written only by the task of the instance: the oldest
+ * 		  records are overwritten, the index runs freely and is reduced to a record by the mask.
+ */
+typedef struct
+{
+	volatile uint32_t head;									/* The number of records written */
+	uint32_t frequency;										/* The frequency of the trace clock, Hz */
+	J1939_traceRecord records[J1939_TRACE_SIZE];			/* Records */
+} J1939_traceRing;
+
+/**
+ * @brief The header of a dump of the ring.
+ */
+typedef struct
+{
+	uint32_t magic;							/* J1939_TRACE_MAGIC */
+	uint8_t version;						/* J1939_TRACE_LAYOUT_VERSION */
+	uint8_t record_size;					/* sizeof(J1939_traceRecord) */
+	uint16_t reserved;
+	uint32_t frequency;						/* The frequency of the trace clock, Hz */
+	uint32_t records;						/* The number of records following the header */
+	uint32_t lost_records;					/* Records overwritten before the dump */
+} J1939_traceDumpHeader;
+
+#if (J1939_TRACE_ENABLE == 1U)
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to reset the ring and to start the trace clock.
+ * @param	ring - A pointer to the ring.
+ * @retval	None.
+ */
+void J1939_initTrace(J1939_traceRing* ring);
+
+/**
+ * @brief 	This function is used to copy the records of the instance into a dump. It can be called
+ * 			by another task while the instance runs: the records overwritten during the copy are dropped.
+ * @param	instance - A pointer to the instance.
+ * @param	buffer - A pointer to the dump, J1939_TRACE_DUMP_SIZE bytes hold the whole ring.
+ * @param	size - The size of the buffer. The latest records fitting in it are copied.
+ * @retval	The size of the dump. 0 - the buffer can't hold the header.
+ */
+uint32_t J1939_dumpTrace(J1939_instance* instance, uint8_t* buffer, uint32_t size);
+
+//---------------------------------------------------------------------------
+// Inline functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to record an event. It is called by J1939_TRACE from the task of the instance.
+ * @param	ring - A pointer to the ring.
+ * @param	event - J1939_traceEvents.
+ * @param	detail - The detail of the event.
+ * @param	value - The CAN ID, the PGN or the size.
+ * @param	argument0 - The first data byte or the originator.
+ * @param	argument1 - The second data byte or the recipient.
+ * @retval	None.
+ */
+static inline void J1939_traceEvent(J1939_traceRing* ring, uint8_t event, uint8_t detail, uint32_t value,
+									uint8_t argument0, uint8_t argument1)
+{
+	uint32_t head = ring->head;
+	J1939_traceRecord* record = &ring->records[head & (J1939_TRACE_SIZE - 1U)];
+
+	record->timestamp		= J1939_PORT_GET_TRACE_TIME();
+	record->value			= value;
+	record->event			= event;
+	record->detail			= detail;
+	record->arguments[0]	= argument0;
+	record->arguments[1]	= argument1;
+
+	// The record must be written before a dump can see the new head
+	J1939_PORT_COMPILER_BARRIER();
+	ring->head = head + 1U;
+}
+
+#endif /* J1939_TRACE_ENABLE */
+
+#endif /* __SAE_J1939_21_TRACE_H */
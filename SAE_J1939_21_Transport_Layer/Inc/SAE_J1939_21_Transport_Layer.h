@@ -18,7 +18,8 @@
 //---------------------------------------------------------------------------
 // Includes
 //---------------------------------------------------------------------------
-#include "stm32f4xx.h"
+#include "SAE_J1939_Port.h"
+#include "SAE_J1939_21_Timer_Wheel.h"
 
 //---------------------------------------------------------------------------
 // Defines
@@ -26,6 +27,47 @@
 #define J1939_MESSAGE_PACKET_FREQ				(50U) // from 50 to 200 ms
 #define J1939_MESSAGE_DATA_TIMEOUT				(750U)
 #define J1939_MESSAGE_CM_TIMEOUT				(1250U)
+#define J1939_MESSAGE_HOLD_TIMEOUT				(1050U)
+
+// CTS window parameters. They can be redefined in the compiler options.
+#ifndef J1939_TX_MAX_NUMBER_PACKAGES_IN_CTS
+#define J1939_TX_MAX_NUMBER_PACKAGES_IN_CTS		(255U)	// Sent in RTS, 255 - no limit
+#endif
+
+#ifndef J1939_RX_MAX_NUMBER_PACKAGES_IN_CTS
+#define J1939_RX_MAX_NUMBER_PACKAGES_IN_CTS		(255U)	// The largest window requested by CTS
+#endif
+
+#ifndef J1939_STANDART_NUMBER_PACKAGES_IN_CTS
+#define J1939_STANDART_NUMBER_PACKAGES_IN_CTS	(2U)	// The first window requested by CTS
+#endif
+
+#ifndef J1939_CTS_WINDOW_TARGET_TIME
+#define J1939_CTS_WINDOW_TARGET_TIME			(200U)	// A window received faster (ms) is doubled, slower - halved
+#endif
+
+#ifndef J1939_CTS_BUS_LOAD_THRESHOLD
+#define J1939_CTS_BUS_LOAD_THRESHOLD			(50U)	// Bus load (%) above which the windows are reduced
+#endif
+
+// The number of times the same lost package is requested again by CTS
+#ifndef J1939_TP_MAX_RETRANSMISSIONS
+#define J1939_TP_MAX_RETRANSMISSIONS			(2U)
+#endif
+
+#define J1939_MAX_NUMBER_OF_PACKAGES			(255U)
+
+// Gap between the packages of the broadcast message sent in the burst mode, ms
+#ifndef J1939_BAM_PACKAGE_GAP
+#define J1939_BAM_PACKAGE_GAP					(J1939_MESSAGE_PACKET_FREQ)
+#endif
+
+// The priority of TP and ETP frames until J1939_setTPpriority is called. It can be redefined in the compiler options.
+#ifndef J1939_TP_DEFAULT_PRIORITY
+#define J1939_TP_DEFAULT_PRIORITY				(7U)
+#endif
+
+#define J1939_LOWEST_PRIORITY					(7U)
 
 #define J1939_BROADCAST_ADDRESS					(255U)
 #define J1939_USE_CURRENT_DA					(1U)
@@ -33,6 +75,27 @@
 #define J1939_CONNECTION_MANAGEMENT				(0xECU)
 #define J1939_DATA_TRANSFER						(0xEBU)
 
+#define J1939_NUMBER_OF_ADDRESSES				(256U)
+
+// The number of sessions of each type which can be opened at the same time.
+// It can be redefined in the compiler options.
+#ifndef J1939_MAX_TP_BAM_RX_SESSIONS
+#define J1939_MAX_TP_BAM_RX_SESSIONS			(4U)
+#endif
+
+#ifndef J1939_MAX_TP_PTP_RX_SESSIONS
+#define J1939_MAX_TP_PTP_RX_SESSIONS			(2U)
+#endif
+
+#ifndef J1939_MAX_TP_TX_SESSIONS
+#define J1939_MAX_TP_TX_SESSIONS				(2U)
+#endif
+
+// The number of PGNs received by streaming sinks. It can be redefined in the compiler options.
+#ifndef J1939_MAX_TP_SINKS
+#define J1939_MAX_TP_SINKS						(8U)
+#endif
+
 //---------------------------------------------------------------------------
 // Structures and enumerations
 //---------------------------------------------------------------------------
@@ -66,7 +129,7 @@ typedef enum
 	J1939_NO_STATUS,					/* Used to initialize a status variable */
 	J1939_ERROR_BUSY,					/* Status to alert TP session already open */
 	J1939_ERROR_MEMORY_ALLOCATION,		/* Status error memory allocation */
-	J1939_ERROR_TOO_BIG_MESSAGE,		/* Status too big message */
+	J1939_ERROR_TOO_BIG_MESSAGE,		/* Status too big message, or its size and number of packages are invalid */
 	J1939_STATUS_GOT_BAM_MESSAGE,		/* Got BAM message */
 	J1939_STATUS_GOT_RTS_MESSAGE,		/* Got RTS message */
 	J1939_STATUS_GOT_CTS_MESSAGE,		/* Got CTS message */
@@ -74,8 +137,11 @@ typedef enum
 	J1939_STATUS_GOT_ABORT_SESSION,		/* Got ABORT message */
 	J1939_STATUS_DATA_FINISHED,			/* Sending/receiving data finished */
 	J1939_STATUS_DATA_CONTINUE,			/* Sending/receiving data continue */
-	J1939_STATUS_CTS					/* Used in PTP mode to notify that the number of packets specified
+	J1939_STATUS_CTS,					/* Used in PTP mode to notify that the number of packets specified
 										   in the CTS message is completed and it's necessary to wait for the next */
+	J1939_ERROR_TIMEOUT,				/* The session has been closed by a timeout */
+	J1939_ERROR_MISSING_PACKAGES		/* Lost packages can't be received: the broadcast message is over or
+										   the retransmission limit is reached */
 } J1939_status;
 
 /**
@@ -98,6 +164,10 @@ typedef enum
 	J1939_CONTROL_BYTE_TP_CM_RTS			= 16U,		/* Control byte for RTS (Request to Send) */
 	J1939_CONTROL_BYTE_TP_CM_CTS			= 17U,		/* Control byte for CTS (Clear to Send) */
 	J1939_CONTROL_BYTE_TP_CM_EndOfMsgACK	= 19U,		/* Control byte for EndOfMsgACK (End of Message Acknowledgment) */
+	J1939_CONTROL_BYTE_ETP_CM_RTS			= 20U,		/* Control byte for ETP RTS (Request to Send) */
+	J1939_CONTROL_BYTE_ETP_CM_CTS			= 21U,		/* Control byte for ETP CTS (Clear to Send) */
+	J1939_CONTROL_BYTE_ETP_CM_DPO			= 22U,		/* Control byte for ETP DPO (Data Packet Offset) */
+	J1939_CONTROL_BYTE_ETP_CM_EndOfMsgACK	= 23U,		/* Control byte for ETP EndOfMsgACK (End of Message Acknowledgment) */
 	J1939_CONTROL_BYTE_TP_CM_BAM			= 32U,		/* Control byte for BAM (Broadcast Announce Message) */
 	J1939_CONTROL_BYTE_TP_CM_Abort			= 255U		/* Control byte for Connection Abort */
 } J1939_controlBytes;
@@ -111,6 +181,7 @@ typedef enum
 								   	   	   	   	   	   	   cannot support another */
 	J1939_REASON_TIMEOUT 					= 3, 		/* A timeout occurred, and this is the connection abort
 										   	   	   	   	   to close the session. */
+	J1939_REASON_RETRANSMIT_LIMIT			= 5,		/* Maximum retransmit request limit reached */
 	J1939_REASON_TOO_BIG_MESSAGE			= 9,		/* “Total Message Size” is greater than 1785 bytes */
 	J1939_REASON_MEMORY_ALLOCATION_ERROR	= 250U,		/* Memory allocation error for receiving message */
 } J1939_abortReasons;
@@ -129,6 +200,15 @@ typedef struct
 	uint8_t remaining_packages_from_CTS;			/* It remains to accept packets from the last CTS. */
 	uint8_t next_package;							/* A next package. */
 	uint8_t CTS_available_message;					/* 1 allows to process CTS messages, 0 - doesn't */
+	uint8_t CTS_window;								/* Adaptive number of packages requested by CTS */
+	uint8_t CTS_window_limit;						/* Max. number of packages requested by CTS */
+	uint32_t CTS_time;								/* Time when the last CTS was sent, ms */
+	uint8_t window_first;							/* The first package requested by the last CTS */
+	uint8_t window_last;							/* The last package requested by the last CTS */
+	uint8_t last_requested_package;					/* The highest package requested by CTS so far */
+	uint8_t retransmit_packages;					/* The number of lost packages to request by the next CTS */
+	uint8_t retransmitted_package;					/* The lost package requested again */
+	uint8_t retransmissions;						/* How many times the lost package has been requested */
 
 	uint8_t destination_address;					/* ECU address to send data to. 255 - broadcast */
 
@@ -136,6 +216,13 @@ typedef struct
 	uint8_t destination_address_abort;				/* The address of the ECU to which the ABORT message must be sent */
 } J1939_TP_CM;
 
+/**
+ * @brief A function called with each received package of a streamed multi-packet message: size bytes
+ * 		  at the offset of the message. Packages are passed as they arrive, each once, lost packages
+ * 		  come later with their offset.
+ */
+typedef void (*J1939_TPsinkCallback)(void* context, uint8_t sourceAddress, uint16_t offset, const uint8_t* data, uint8_t size);
+
 /**
  * @brief PGN 0x00EB00 - Transport Protocol Data Transfer.
  */
@@ -146,80 +233,283 @@ typedef struct
 	uint16_t data_size;				/* From 9 to MAX_DT_SIZE */
 	uint16_t sent_bytes;			/* A flag of waiting message */
 	uint16_t received_bytes;
+	uint8_t received_packages;		/* The number of received packages */
+	uint8_t received_packages_map[(J1939_MAX_NUMBER_OF_PACKAGES + 7U) / 8U];	/* Bit per received package */
 	uint8_t memory_allocated;		/* 1 - memory allocated, 0 - no memory allocated */
+	J1939_TPsinkCallback sink;		/* Receives the streamed message instead of the buffer. NULL - no sink */
+	void* sink_context;				/* A user pointer passed to the sink */
+	uint32_t package_time;			/* Time when the last package (or BAM) was sent, ms */
 } J1939_TP_DT;
 
+/**
+ * @brief J1939 transport protocol session types.
+ */
+typedef enum
+{
+	J1939_TP_SESSION_BAM_RX,		/* Receiving a broadcast multi-packet message */
+	J1939_TP_SESSION_PTP_RX,		/* Receiving a peer-to-peer (RTS/CTS) multi-packet message */
+	J1939_TP_SESSION_TX,			/* Sending a multi-packet message (BAM or RTS/CTS) */
+	J1939_TP_SESSION_TYPES			/* The number of session types */
+} J1939_TPsessionTypes;
+
+/**
+ * @brief J1939 transport protocol session. A session is identified by the originator address,
+ * 		  the recipient address and the PGN of the multi-packet message.
+ */
+typedef struct
+{
+	J1939_TP_CM connectManagement;					/* Connection management of the session */
+	J1939_TP_DT dataTransfer;						/* Data transfer of the session */
+	J1939_TPsessionTypes type;						/* Session type */
+	J1939_states state;								/* Current state of the session */
+	uint8_t source_address;							/* Originator of the multi-packet message */
+	uint8_t destination_address;					/* Recipient of the multi-packet message. 255 - broadcast */
+	uint8_t in_use;									/* 1 - session is open, 0 - session slot is free */
+	uint32_t open_time;								/* Time when the session was opened, ms */
+	uint32_t wait_time;								/* Time when the session started to wait for CTS or its packages, ms */
+	uint8_t waiting;								/* 1 - the wait for CTS or its packages is timed */
+	J1939_timer timer;								/* Timeout of the session or the gap between BAM packages */
+	J1939_instance* instance;						/* The instance which owns the session */
+} J1939_TP_session;
+
+/**
+ * @brief A function called by J1939_processTimers when the library closes a session itself:
+ * 		  J1939_ERROR_TIMEOUT - the session has timed out (the abort message has already been sent),
+ * 		  J1939_ERROR_MISSING_PACKAGES - the lost packages have been requested J1939_TP_MAX_RETRANSMISSIONS
+ * 		  times (the abort message has already been sent),
+ * 		  J1939_STATUS_DATA_FINISHED - the last package of the broadcast message has been sent.
+ * 		  The session is closed after the function returns.
+ */
+typedef void (*J1939_TPcallback)(J1939_TP_session* session, J1939_status status);
+
+/**
+ * @brief Table of the TP sessions of the same type.
+ */
+typedef struct
+{
+	J1939_TP_session* sessions;								/* Session slots */
+	uint8_t number_of_sessions;								/* The number of session slots */
+	uint8_t index[J1939_NUMBER_OF_ADDRESSES];				/* The session slot number + 1 by the peer address.
+															   0 - there is no session with the peer */
+} J1939_TP_sessionTable;
+
+/**
+ * @brief A streaming sink of the PGN.
+ */
+typedef struct
+{
+	uint32_t PGN;											/* A PGN of the multi-packet messages */
+	J1939_TPsinkCallback sink;								/* Receives the packages. NULL - the slot is free */
+	void* context;											/* A user pointer passed to the sink */
+} J1939_TP_sink;
+
+/**
+ * @brief Transport protocol of an instance.
+ */
+typedef struct
+{
+	J1939_TP_session bam_rx_sessions[J1939_MAX_TP_BAM_RX_SESSIONS];
+	J1939_TP_session ptp_rx_sessions[J1939_MAX_TP_PTP_RX_SESSIONS];
+	J1939_TP_session tx_sessions[J1939_MAX_TP_TX_SESSIONS];
+	J1939_TP_sessionTable session_tables[J1939_TP_SESSION_TYPES];
+	J1939_TP_sink sinks[J1939_MAX_TP_SINKS];
+	J1939_TPcallback callback;								/* Called when the library closes a session itself */
+	uint8_t bus_load;										/* The measured bus load, % */
+	uint8_t priority;										/* The priority of TP and ETP frames */
+} J1939_transportLayer;
+
 //---------------------------------------------------------------------------
 // External function prototypes
 //---------------------------------------------------------------------------
 
+/**
+ * @brief 	This function is used to bind the session tables of the instance to its sessions.
+ * 			It is called by J1939_initInstance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initTransportLayer(J1939_instance* instance);
+
 /**
  * @brief 	This function is used to read transport protocol connection management messages.
+ * 			BAM and RTS messages open a new session, other messages are routed to the already
+ * 			opened session of the sender.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the received message.
  * @param	data - A pointer to the receiving data.
+ * @param	session - A pointer to store the session of the message. NULL if there is no session.
  * @retval	J1939 status.
  */
-J1939_status J1939_readTP_connectionManagement(uint8_t* data);
+J1939_status J1939_readTP_connectionManagement(J1939_instance* instance, uint32_t canId, const uint8_t* data, J1939_TP_session** session);
 
 /**
  * @brief	This function is used to send transport protocol connection management messages.
+ * 			After BAM the data transfer packages are sent by J1939_processTimers with J1939_BAM_PACKAGE_GAP.
+ * @param	session - A pointer to the TP session.
  * @param	type - A type of the transport protocol connection management message.
  * @retval	None.
  */
-void J1939_sendTP_connectionManagement(J1939_TPcmTypes type);
+void J1939_sendTP_connectionManagement(J1939_TP_session* session, J1939_TPcmTypes type);
+
+/**
+ * @brief	This function is used to send the connection abort message without an opened session.
+ * @param	instance - A pointer to the instance.
+ * @param	destinationAddress - ECU address to send the abort message to.
+ * @param	PGN - A PGN of the multipacket message.
+ * @param	abortReason - The abort reason.
+ * @retval	None.
+ */
+void J1939_sendTP_abort(J1939_instance* instance, uint8_t destinationAddress, uint32_t PGN, J1939_abortReasons abortReason);
 
 /**
  * @brief 	This function is used to read transport protocol data transfer messages.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the received message.
  * @param	data - A pointer to the receiving data.
+ * @param	session - A pointer to store the session of the message. NULL if there is no session.
  * @retval	J1939 status.
  */
-J1939_status J1939_readTP_dataTransfer(uint8_t* data);
+J1939_status J1939_readTP_dataTransfer(J1939_instance* instance, uint32_t canId, const uint8_t* data, J1939_TP_session** session);
 
 /**
  * @brief	This function is used to send the data transfer packages.
+ * @param	session - A pointer to the TP session.
  * @return	J1939 status.
  */
-J1939_status J1939_sendTP_dataTransfer(void);
+J1939_status J1939_sendTP_dataTransfer(J1939_TP_session* session);
+
+/**
+ * @brief	This function is used to send as many data transfer packages as allowed in one call: the rest of
+ * 			the CTS window in the peer-to-peer mode or one package per J1939_BAM_PACKAGE_GAP in the broadcast
+ * 			mode, limited by the free TX slots of the CAN controller.
+ * @param	session - A pointer to the TP session.
+ * @param	sentPackages - A pointer to store the number of queued packages.
+ * @return	J1939 status. J1939_STATUS_CTS if the window is over and the next CTS must be waited.
+ */
+J1939_status J1939_sendTP_dataTransferBurst(J1939_TP_session* session, uint8_t* sentPackages);
+
+/**
+ * @brief	This function is used to continue the CTS windows of all TX sessions which have been limited
+ * 			by the free TX slots. It is called when TX slots of the CAN controller are released.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of queued packages.
+ */
+uint16_t J1939_sendTPpendingPackages(J1939_instance* instance);
 
 /**
- * @brief	This function used to fill TP structures.
+ * @brief	This function used to open a TX session and fill its TP structures.
+ * @param	instance - A pointer to the instance.
  * @param 	data - A pointer to the sending data.
  * @param 	dataSize - A size of the sending data.
  * @param 	PGN - A PGN of the multipacket message.
  * @param 	destinationAddress - ECU address to send data to.
- * @retval	None.
+ * @retval	A pointer to the TX session. NULL if a session to the destination address is
+ * 			already opened or there is no free session.
  */
-void J1939_fillTPstructures(uint8_t* data, uint16_t dataSize, uint32_t PGN, uint8_t destinationAddress);
+J1939_TP_session* J1939_fillTPstructures(J1939_instance* instance, uint8_t* data, uint16_t dataSize, uint32_t PGN, uint8_t destinationAddress);
 
 /**
- * @brief	This function is used to clean TP structures.
+ * @brief	This function is used to clean TP structures and close the session.
+ * @param	session - A pointer to the TP session.
  * @retval	None.
  */
-void J1939_clearTPstructures(void);
+void J1939_clearTPstructures(J1939_TP_session* session);
 
 /**
  * @brief 	This function is used to free allocated memory.
+ * @param	session - A pointer to the TP session.
  * @retval	None.
  */
-void J1939_freeAllocatedMemory(void);
+void J1939_freeAllocatedMemory(J1939_TP_session* session);
 
 /**
  * @brief 	This function is used to set the abort reason.
+ * @param	session - A pointer to the TP session.
  * @param 	abortReason - The abort reason.
  * @param	abortAddress - The address of the ECU to which the ABORT message must be sent.
  * @retval	None.
  */
-void J1939_setAbortReason(J1939_abortReasons abortReason, uint8_t abortAddress);
+void J1939_setAbortReason(J1939_TP_session* session, J1939_abortReasons abortReason, uint8_t abortAddress);
 
 /**
- * @brief 	This function is used to get the pointer to received data.
- * @retval	A pointer to received data.
+ * @brief 	This function is used to get the pointer to received data. It is valid until the session is closed,
+ * 			J1939_queueReceivedMessage hands it over to the consumer task instead.
+ * @param	session - A pointer to the TP session.
+ * @retval	A pointer to received data. NULL if the message is streamed to a sink or has been queued.
  */
-uint8_t* J1939_getReceivedMessage(void);
+uint8_t* J1939_getReceivedMessage(J1939_TP_session* session);
+
+/**
+ * @brief 	This function is used to check whether the data is sent by an open TX session, so it mustn't be changed.
+ * @param	instance - A pointer to the instance.
+ * @param	data - A pointer to the data passed to J1939_fillTPstructures.
+ * @retval	1 - the data is being sent, 0 - isn't.
+ */
+uint8_t J1939_isTXdataInUse(J1939_instance* instance, const uint8_t* data);
 
 /**
  * @brief 	This function is used to safe the destination address in the connection management structure.
- * @retval	destinationAddress - The DA from the received messages.
+ * @param	session - A pointer to the TP session.
+ * @param	destinationAddress - The DA from the received messages.
+ * @retval	None.
+ */
+void J1939_setDestinationAddress(J1939_TP_session* session, uint8_t destinationAddress);
+
+/**
+ * @brief 	This function is used to limit the number of packages in one CTS window of the session.
+ * 			For a TX session the limit is sent in RTS and caps the peer's grants, so it must be set before RTS.
+ * 			For a PTP RX session it caps the adaptive window of the CTS messages.
+ * @param	session - A pointer to the TP session.
+ * @param	limit - The maximum number of packages from 1 to 255.
+ * @retval	None.
+ */
+void J1939_setCTSwindowLimit(J1939_TP_session* session, uint8_t limit);
+
+/**
+ * @brief 	This function is used to set the measured bus load. Above J1939_CTS_BUS_LOAD_THRESHOLD the CTS
+ * 			windows are reduced in proportion to the load.
+ * @param	instance - A pointer to the instance.
+ * @param	load - The bus load in percent.
+ * @retval	None.
+ */
+void J1939_setBusLoad(J1939_instance* instance, uint8_t load);
+
+/**
+ * @brief 	This function is used to set the priority of the TP.CM, TP.DT, ETP.CM and ETP.DT frames
+ * 			sent by the instance.
+ * @param	instance - A pointer to the instance.
+ * @param	priority - The priority from 0 (the highest) to 7.
+ * @retval	None.
+ */
+void J1939_setTPpriority(J1939_instance* instance, uint8_t priority);
+
+/**
+ * @brief 	This function is used to set the function called when the library closes a session itself.
+ * @param	instance - A pointer to the instance.
+ * @param	callback - A pointer to the function. NULL - no function.
+ * @retval	None.
+ */
+void J1939_setTPcallback(J1939_instance* instance, J1939_TPcallback callback);
+
+/**
+ * @brief 	This function is used to stream the multi-packet messages of the PGN to a sink. The packages are
+ * 			passed to the sink as they arrive and no buffer is allocated for the message. Sessions opened
+ * 			before the call aren't affected.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - A PGN of the multi-packet messages.
+ * @param	sink - A function to receive the packages. NULL - stop streaming the PGN.
+ * @param	context - A user pointer passed to the sink.
+ * @retval	0 - the sink is registered, 1 - there is no free sink slot (J1939_MAX_TP_SINKS).
+ */
+uint8_t J1939_registerTPsink(J1939_instance* instance, uint32_t PGN, J1939_TPsinkCallback sink, void* context);
+
+/**
+ * @brief 	This function is used to find the opened session by the CAN ID of a TP.CM or TP.DT message.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the message.
+ * @param	type - A type of the session.
+ * @retval	A pointer to the session. NULL if there is no session.
  */
-void J1939_setDestinationAddress(uint8_t destinationAddress);
+J1939_TP_session* J1939_findTPsession(J1939_instance* instance, uint32_t canId, J1939_TPsessionTypes type);
 
 #endif /* __SAE_J1939_21_TRANSPORT_LAYER_H */
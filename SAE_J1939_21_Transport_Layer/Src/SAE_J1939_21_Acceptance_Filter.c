@@ -0,0 +1,337 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Acceptance_Filter.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the hardware acceptance
+  * 		 filter generation. Every accepted PGN and address gives an exact
+  * 		 filter with the priority bits ignored. While there are more filters
+  * 		 than banks, the pair whose merged filter adds the fewest accepted
+  * 		 IDs is merged: the bits they differ in are ignored.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_FILTER_ID_BITS					(29U)
+#define J1939_FILTER_ID_MASK					(0x1FFFFFFFUL)
+#define J1939_FILTER_PGN_MASK					(0x03FFFF00UL)	// EDP, DP, PDU format and PDU specific
+#define J1939_FILTER_SOURCE_MASK				(0x000000FFUL)
+#define J1939_FILTER_PDU_SPECIFIC_POS			(8U)
+#define J1939_FILTER_PDU2_FORMAT				(240U)
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static uint8_t J1939_addPattern(J1939_acceptanceFilter* patterns, uint8_t numberOfPatterns, uint32_t PGN,
+								uint8_t destinationAddress, uint16_t sourceAddress);
+static uint8_t J1939_removeCoveredPatterns(J1939_acceptanceFilter* patterns, uint8_t numberOfPatterns, uint8_t cover);
+static uint8_t J1939_isPatternCovered(const J1939_acceptanceFilter* pattern, const J1939_acceptanceFilter* cover);
+static J1939_acceptanceFilter J1939_mergePatterns(const J1939_acceptanceFilter* first,
+												  const J1939_acceptanceFilter* second);
+static int64_t J1939_getAcceptedIds(const J1939_acceptanceFilter* filter);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to make the acceptance filters. They accept the registered PGNs with
+ * 			their address filters, TP.CM, TP.DT, address claims and requests addressed to the ECU or to all ECUs,
+ * 			with the CAN FD data link also multi-PG, FD.TP.CM and FD.TP.DT.
+ * 			If there are more PGNs than filters, the filters with the fewest extra accepted IDs
+ * 			are merged.
+ * @param	instance - A pointer to the instance.
+ * @param	filters - A pointer to store the filters.
+ * @param	maxFilters - The maximum number of filters.
+ * @param	address - The ECU address.
+ * @retval	The number of filters. 0 - all frames must be received.
+ */
+uint8_t J1939_makeAcceptanceFilters(J1939_instance* instance, J1939_acceptanceFilter* filters, uint8_t maxFilters, uint8_t address)
+{
+	J1939_PGNregistration* registrations = instance->filters.registrations;
+	J1939_acceptanceFilter* patterns = instance->filters.patterns;
+	uint8_t numberOfRegistrations = J1939_getPGNregistrations(instance, registrations, J1939_MAX_PGN_HANDLERS);
+	uint8_t numberOfPatterns = 0U;
+
+	if(maxFilters == 0U) return 0U;
+
+	// The transport protocol is processed by the dispatcher for any PGN
+	numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_CONNECTION_MANAGEMENT << 8U, address, J1939_ANY_ADDRESS);
+	numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_CONNECTION_MANAGEMENT << 8U, J1939_BROADCAST_ADDRESS, J1939_ANY_ADDRESS);
+	numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_DATA_TRANSFER << 8U, address, J1939_ANY_ADDRESS);
+	numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_DATA_TRANSFER << 8U, J1939_BROADCAST_ADDRESS, J1939_ANY_ADDRESS);
+
+	// The address claim is processed by the network management layer
+	numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, J1939_ADDRESS_CLAIMED_PGN, address, J1939_ANY_ADDRESS);
+	numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, J1939_ADDRESS_CLAIMED_PGN, J1939_BROADCAST_ADDRESS, J1939_ANY_ADDRESS);
+	numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_REQUEST << 8U, address, J1939_ANY_ADDRESS);
+	numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_REQUEST << 8U, J1939_BROADCAST_ADDRESS, J1939_ANY_ADDRESS);
+
+#if (J1939_FILTER_ACCEPT_ETP == 1U)
+	numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_ETP_CONNECTION_MANAGEMENT << 8U, address, J1939_ANY_ADDRESS);
+	numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_ETP_DATA_TRANSFER << 8U, address, J1939_ANY_ADDRESS);
+#endif
+
+	// The multi-PG and FD.TP frames carry the PGNs of the instance with the CAN FD data link
+	if(instance->data_link == J1939_DATA_LINK_FD)
+	{
+		numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_MULTI_PG << 8U, address, J1939_ANY_ADDRESS);
+		numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_MULTI_PG << 8U, J1939_BROADCAST_ADDRESS, J1939_ANY_ADDRESS);
+		numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_FD_CONNECTION_MANAGEMENT << 8U, address, J1939_ANY_ADDRESS);
+		numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_FD_CONNECTION_MANAGEMENT << 8U, J1939_BROADCAST_ADDRESS, J1939_ANY_ADDRESS);
+		numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_FD_DATA_TRANSFER << 8U, address, J1939_ANY_ADDRESS);
+		numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, (uint32_t)J1939_FD_DATA_TRANSFER << 8U, J1939_BROADCAST_ADDRESS, J1939_ANY_ADDRESS);
+	}
+
+	for(uint8_t i = 0U; i < numberOfRegistrations; i++)
+	{
+		uint32_t PGN = registrations[i].PGN;
+		uint16_t destination = registrations[i].destination_address;
+
+		if((uint8_t)(PGN >> 8U) >= J1939_FILTER_PDU2_FORMAT)
+		{
+			// PDU2 messages are sent to all ECUs
+			if((destination == J1939_ANY_ADDRESS) || (destination == J1939_BROADCAST_ADDRESS))
+			{
+				numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, PGN, (uint8_t)PGN, registrations[i].source_address);
+			}
+
+			continue;
+		}
+
+		// The dispatcher drops PDU1 messages addressed to other ECUs
+		if((destination == J1939_ANY_ADDRESS) || (destination == address))
+		{
+			numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, PGN, address, registrations[i].source_address);
+		}
+
+		if((destination == J1939_ANY_ADDRESS) || (destination == J1939_BROADCAST_ADDRESS))
+		{
+			numberOfPatterns = J1939_addPattern(patterns, numberOfPatterns, PGN, J1939_BROADCAST_ADDRESS, registrations[i].source_address);
+		}
+	}
+
+	while(numberOfPatterns > maxFilters)
+	{
+		int64_t bestCost = INT64_MAX;
+		uint8_t bestFirst = 0U;
+		uint8_t bestSecond = 1U;
+
+		for(uint8_t first = 0U; first < numberOfPatterns; first++)
+		{
+			for(uint8_t second = first + 1U; second < numberOfPatterns; second++)
+			{
+				J1939_acceptanceFilter merged = J1939_mergePatterns(&patterns[first], &patterns[second]);
+				int64_t cost = J1939_getAcceptedIds(&merged) - J1939_getAcceptedIds(&patterns[first]) - \
+							   J1939_getAcceptedIds(&patterns[second]);
+
+				if(cost < bestCost)
+				{
+					bestCost	= cost;
+					bestFirst	= first;
+					bestSecond	= second;
+				}
+			}
+		}
+
+		patterns[bestFirst] = J1939_mergePatterns(&patterns[bestFirst], &patterns[bestSecond]);
+		patterns[bestSecond] = patterns[--numberOfPatterns];
+
+		numberOfPatterns = J1939_removeCoveredPatterns(patterns, numberOfPatterns, bestFirst);
+	}
+
+	for(uint8_t i = 0U; i < numberOfPatterns; i++) filters[i] = patterns[i];
+
+	return numberOfPatterns;
+}
+
+/**
+ * @brief 	This function is used to start the hardware filtering. The filters are loaded at once and
+ * 			made again when a PGN handler is registered or unregistered, the ECU address or the data link
+ * 			is changed.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_enableAcceptanceFilters(J1939_instance* instance)
+{
+	instance->filters.enabled = 1U;
+
+	J1939_refreshAcceptanceFilters(instance);
+}
+
+/**
+ * @brief 	This function is used to stop the hardware filtering, all frames are received.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_disableAcceptanceFilters(J1939_instance* instance)
+{
+	instance->filters.enabled = 0U;
+
+	J1939_portSetAcceptanceFilters(instance->channel, NULL, 0U);
+}
+
+/**
+ * @brief 	This function is used to make and load the acceptance filters if the filtering is enabled.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_refreshAcceptanceFilters(J1939_instance* instance)
+{
+	J1939_acceptanceFilter* loadedFilters = instance->filters.loaded_filters;
+	uint8_t numberOfBanks = J1939_portGetFilterBanks(instance->channel);
+	uint8_t numberOfFilters;
+
+	if(instance->filters.enabled == 0U) return;
+
+	if(numberOfBanks > J1939_MAX_FILTER_BANKS) numberOfBanks = J1939_MAX_FILTER_BANKS;
+
+	numberOfFilters = J1939_makeAcceptanceFilters(instance, loadedFilters, numberOfBanks, J1939_getCurrentECUAddress(instance));
+	J1939_portSetAcceptanceFilters(instance->channel, loadedFilters, numberOfFilters);
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to add an exact filter of the PGN, the priority bits are ignored.
+ * 			The filter isn't added if another filter accepts its IDs, the filters it accepts the IDs of
+ * 			are removed. If the array is full, the filter is merged with the filter which adds
+ * 			the fewest accepted IDs.
+ * @param	patterns - A pointer to the filters.
+ * @param	numberOfPatterns - The number of filters added before.
+ * @param	PGN - The PGN. The PDU specific of PDU1 PGNs is replaced by the destination address.
+ * @param	destinationAddress - The destination address of PDU1 PGNs.
+ * @param	sourceAddress - The source address filter. J1939_ANY_ADDRESS - any address.
+ * @retval	The number of filters.
+ */
+static uint8_t J1939_addPattern(J1939_acceptanceFilter* patterns, uint8_t numberOfPatterns, uint32_t PGN,
+								uint8_t destinationAddress, uint16_t sourceAddress)
+{
+	J1939_acceptanceFilter pattern;
+
+	if((uint8_t)(PGN >> 8U) < J1939_FILTER_PDU2_FORMAT) PGN = (PGN & 0x3FF00UL) | destinationAddress;
+
+	pattern.id		= (PGN << J1939_FILTER_PDU_SPECIFIC_POS) & J1939_FILTER_PGN_MASK;
+	pattern.mask	= J1939_FILTER_PGN_MASK;
+
+	if(sourceAddress != J1939_ANY_ADDRESS)
+	{
+		pattern.id		|= (uint8_t)sourceAddress;
+		pattern.mask	|= J1939_FILTER_SOURCE_MASK;
+	}
+
+	for(uint8_t i = 0U; i < numberOfPatterns; i++)
+	{
+		if(J1939_isPatternCovered(&pattern, &patterns[i]) == 1U) return numberOfPatterns;
+	}
+
+	// If there is no room, the filter is merged with the one which adds the fewest accepted IDs
+	if(numberOfPatterns == J1939_FILTER_MAX_PATTERNS)
+	{
+		int64_t bestCost = INT64_MAX;
+		uint8_t best = 0U;
+
+		for(uint8_t i = 0U; i < numberOfPatterns; i++)
+		{
+			J1939_acceptanceFilter merged = J1939_mergePatterns(&pattern, &patterns[i]);
+			int64_t cost = J1939_getAcceptedIds(&merged) - J1939_getAcceptedIds(&patterns[i]);
+
+			if(cost < bestCost)
+			{
+				bestCost	= cost;
+				best		= i;
+			}
+		}
+
+		patterns[best] = J1939_mergePatterns(&pattern, &patterns[best]);
+
+		return J1939_removeCoveredPatterns(patterns, numberOfPatterns, best);
+	}
+
+	patterns[numberOfPatterns] = pattern;
+
+	return J1939_removeCoveredPatterns(patterns, numberOfPatterns + 1U, numberOfPatterns);
+}
+
+/**
+ * @brief 	This function is used to remove the filters which accept no IDs beyond the cover filter.
+ * @param	patterns - A pointer to the filters.
+ * @param	numberOfPatterns - The number of filters.
+ * @param	cover - The number of the cover filter.
+ * @retval	The number of filters.
+ */
+static uint8_t J1939_removeCoveredPatterns(J1939_acceptanceFilter* patterns, uint8_t numberOfPatterns, uint8_t cover)
+{
+	uint8_t i = 0U;
+
+	while(i < numberOfPatterns)
+	{
+		if((i != cover) && (J1939_isPatternCovered(&patterns[i], &patterns[cover]) == 1U))
+		{
+			// The last filter takes the place of the removed one
+			patterns[i] = patterns[--numberOfPatterns];
+			if(cover == numberOfPatterns) cover = i;
+		} else
+		{
+			i++;
+		}
+	}
+
+	return numberOfPatterns;
+}
+
+/**
+ * @brief 	This function is used to check if all IDs accepted by the filter are accepted by the cover filter.
+ * @param	pattern - A pointer to the filter.
+ * @param	cover - A pointer to the cover filter.
+ * @retval	1 if the filter is covered, 0 otherwise.
+ */
+static uint8_t J1939_isPatternCovered(const J1939_acceptanceFilter* pattern, const J1939_acceptanceFilter* cover)
+{
+	if((cover->mask & ~pattern->mask) != 0U) return 0U;
+
+	return (((pattern->id ^ cover->id) & cover->mask) == 0U) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is used to make the narrowest filter which accepts the IDs of both filters.
+ * @param	first - A pointer to the first filter.
+ * @param	second - A pointer to the second filter.
+ * @retval	The merged filter.
+ */
+static J1939_acceptanceFilter J1939_mergePatterns(const J1939_acceptanceFilter* first,
+												  const J1939_acceptanceFilter* second)
+{
+	J1939_acceptanceFilter merged;
+
+	merged.mask	= first->mask & second->mask & ~(first->id ^ second->id);
+	merged.id	= first->id & merged.mask;
+
+	return merged;
+}
+
+/**
+ * @brief 	This function is used to get the number of 29-bit IDs accepted by the filter.
+ * @param	filter - A pointer to the filter.
+ * @retval	The number of IDs.
+ */
+static int64_t J1939_getAcceptedIds(const J1939_acceptanceFilter* filter)
+{
+	uint32_t mask = filter->mask & J1939_FILTER_ID_MASK;
+	uint8_t ignoredBits = J1939_FILTER_ID_BITS;
+
+	for(; mask != 0U; mask &= mask - 1U) ignoredBits--;
+
+	return (int64_t)1 << ignoredBits;
+}
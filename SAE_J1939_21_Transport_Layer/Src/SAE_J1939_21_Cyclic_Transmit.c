@@ -0,0 +1,578 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Cyclic_Transmit.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the cyclic PGN
+  * 		 transmission. The registered PGNs form a binary min-heap by the
+  * 		 time of their next transmission, the timer of the wheel is armed
+  * 		 for the root, so a batch of due PGNs costs O(log n) per PGN.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_PGN_PRIOTITY_POS					(26U)
+#define J1939_PDU_FORMAT_POS					(16U)
+#define J1939_PDU_SPECIFIC_POS					(8U)
+#define J1939_PDU2_FORMAT						(240U)
+#define J1939_MAX_PGN							(0x3FFFFUL)
+#define J1939_MAX_BAM_SIZE						(1785U)
+#define J1939_SINGLE_FRAME_SIZE					(8U)
+
+#define J1939_CYCLIC_NO_PGN						(0xFFU)
+#define J1939_CYCLIC_IS_DUE(time, now)			((int32_t)((time) - (now)) <= 0)
+#define J1939_CYCLIC_IS_EARLIER(time1, time2)	((int32_t)((time1) - (time2)) < 0)
+
+// The weight of a pair of PGNs is the number of their coincident deadlines in 2^32 ms
+#define J1939_CYCLIC_COINCIDENCE_SCALE			(0x100000000ULL)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief Results of a transmission attempt.
+ */
+typedef enum
+{
+	J1939_CYCLIC_SENT,					/* The frame is queued or the BAM session is opened */
+	J1939_CYCLIC_SKIPPED,				/* There is no payload or no address, the cycle is over */
+	J1939_CYCLIC_NO_BAM_SESSION,		/* A BAM session is open, the PGN is tried again later */
+	J1939_CYCLIC_NO_TX_SLOT				/* The frame isn't queued, the batch is tried again later */
+} J1939_cyclicResult;
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static void J1939_sendDueCyclicPGNs(void* context);
+static J1939_cyclicResult J1939_sendCyclicPGN(J1939_instance* instance, J1939_cyclicPGN* cyclicPGN);
+static void J1939_updateCyclicAddress(J1939_instance* instance);
+static uint32_t J1939_chooseCyclicPhase(J1939_cyclicTransmit* cyclic, uint32_t period);
+static uint8_t J1939_findCyclicPGN(J1939_cyclicTransmit* cyclic, uint32_t PGN);
+static void J1939_armCyclicTimer(J1939_instance* instance, uint32_t now);
+static void J1939_removeFromHeap(J1939_cyclicTransmit* cyclic, uint8_t slot);
+static void J1939_siftUp(J1939_cyclicTransmit* cyclic, uint8_t position);
+static void J1939_siftDown(J1939_cyclicTransmit* cyclic, uint8_t position);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to register a cyclic PGN or to change the registration of the PGN. The
+ * 			transmissions are made by J1939_processTimers. The frames of PDU1 PGNs go to the global address.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	priority - The priority from 0 to 7.
+ * @param	period - Transmission period, ms.
+ * @param	phase - Offset of the deadlines, ms. J1939_CYCLIC_AUTO_PHASE - the offset with the fewest
+ * 			coincident deadlines of the registered PGNs, so the bus load is spread.
+ * @param	provider - A function to write the payload before each transmission. NULL - the data set
+ * 			by J1939_setCyclicData is sent.
+ * @param	context - A user pointer passed to the provider.
+ * @retval	J1939_CYCLIC_OK, J1939_CYCLIC_NO_SLOT if there are no free slots or J1939_CYCLIC_INVALID.
+ */
+uint8_t J1939_registerCyclicPGN(J1939_instance* instance, uint32_t PGN, uint8_t priority, uint32_t period, uint32_t phase,
+								J1939_cyclicProvider provider, void* context)
+{
+	J1939_cyclicTransmit* cyclic = &instance->cyclic;
+	uint32_t now = J1939_portGetTime();
+	J1939_cyclicPGN* cyclicPGN;
+	uint8_t slot;
+
+	if((period == 0U) || (priority > J1939_LOWEST_PRIORITY) || (PGN > J1939_MAX_PGN)) return J1939_CYCLIC_INVALID;
+
+	slot = J1939_findCyclicPGN(cyclic, PGN);
+
+	if(slot != J1939_CYCLIC_NO_PGN)
+	{
+		// The payload and the buffer are kept, the PGN is scheduled again
+		J1939_removeFromHeap(cyclic, slot);
+	} else
+	{
+		for(slot = 0U; slot < J1939_MAX_CYCLIC_PGNS; slot++)
+		{
+			if(cyclic->PGNs[slot].in_use == 0U) break;
+		}
+
+		if(slot == J1939_MAX_CYCLIC_PGNS) return J1939_CYCLIC_NO_SLOT;
+
+		memset(&cyclic->PGNs[slot], 0, sizeof(J1939_cyclicPGN));
+	}
+
+	if(cyclic->started == 0U)
+	{
+		cyclic->start_time	= now;
+		cyclic->address		= J1939_getCurrentECUAddress(instance);
+		cyclic->started		= 1U;
+	}
+
+	cyclicPGN = &cyclic->PGNs[slot];
+
+	cyclicPGN->PGN		= PGN;
+	cyclicPGN->period	= period;
+	cyclicPGN->phase	= (phase == J1939_CYCLIC_AUTO_PHASE) ? J1939_chooseCyclicPhase(cyclic, period) : (phase % period);
+	cyclicPGN->provider	= provider;
+	cyclicPGN->context	= context;
+	cyclicPGN->priority	= priority;
+	cyclicPGN->in_use	= 1U;
+
+	// The frames of PDU1 PGNs are addressed to all ECUs
+	cyclicPGN->can_id = ((uint32_t)priority << J1939_PGN_PRIOTITY_POS) | ((PGN & 0x3FF00UL) << J1939_PDU_SPECIFIC_POS);
+	cyclicPGN->can_id |= (((PGN >> J1939_PDU_SPECIFIC_POS) & 0xFFU) < J1939_PDU2_FORMAT) ? \
+						 ((uint32_t)J1939_BROADCAST_ADDRESS << J1939_PDU_SPECIFIC_POS) : ((PGN & 0xFFU) << J1939_PDU_SPECIFIC_POS);
+	cyclicPGN->can_id |= cyclic->address;
+
+	// The first deadline is the nearest time of the phase counted from the common start
+	cyclicPGN->deadline	= now + ((cyclicPGN->phase + period - ((now - cyclic->start_time) % period)) % period);
+	cyclicPGN->due_time	= cyclicPGN->deadline;
+
+	cyclic->heap[cyclic->heap_size] = slot;
+	J1939_siftUp(cyclic, cyclic->heap_size++);
+
+	J1939_updateCyclicAddress(instance);
+	J1939_armCyclicTimer(instance, now);
+
+	return J1939_CYCLIC_OK;
+}
+
+/**
+ * @brief 	This function is used to stop the transmissions of the PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @retval	None.
+ */
+void J1939_unregisterCyclicPGN(J1939_instance* instance, uint32_t PGN)
+{
+	J1939_cyclicTransmit* cyclic = &instance->cyclic;
+	uint8_t slot = J1939_findCyclicPGN(cyclic, PGN);
+
+	if(slot == J1939_CYCLIC_NO_PGN) return;
+
+	J1939_removeFromHeap(cyclic, slot);
+	cyclic->PGNs[slot].in_use = 0U;
+
+	J1939_armCyclicTimer(instance, J1939_portGetTime());
+}
+
+/**
+ * @brief 	This function is used to give the cyclic PGN a buffer for payloads above 8 bytes. Such payloads
+ * 			are broadcast by BAM straight from the buffer, so it mustn't be changed by the application.
+ * 			A transmission is put off while another BAM session is open.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	buffer - The buffer. NULL - single frames only.
+ * @param	bufferSize - The size of the buffer, up to 1785 bytes.
+ * @retval	J1939_CYCLIC_OK, J1939_CYCLIC_INVALID or J1939_CYCLIC_BUSY if the buffer is being sent.
+ */
+uint8_t J1939_setCyclicBuffer(J1939_instance* instance, uint32_t PGN, uint8_t* buffer, uint16_t bufferSize)
+{
+	J1939_cyclicTransmit* cyclic = &instance->cyclic;
+	uint8_t slot = J1939_findCyclicPGN(cyclic, PGN);
+	J1939_cyclicPGN* cyclicPGN;
+
+	if((slot == J1939_CYCLIC_NO_PGN) || (bufferSize > J1939_MAX_BAM_SIZE)) return J1939_CYCLIC_INVALID;
+
+	cyclicPGN = &cyclic->PGNs[slot];
+
+	if((cyclicPGN->buffer != NULL) && (J1939_isTXdataInUse(instance, cyclicPGN->buffer) == 1U)) return J1939_CYCLIC_BUSY;
+
+	cyclicPGN->buffer		= buffer;
+	cyclicPGN->buffer_size	= (buffer != NULL) ? bufferSize : 0U;
+
+	// The payload set for the old buffer isn't sent
+	if(cyclicPGN->size > J1939_SINGLE_FRAME_SIZE) cyclicPGN->size = 0U;
+
+	return J1939_CYCLIC_OK;
+}
+
+/**
+ * @brief 	This function is used to set the payload of the cyclic PGN without a provider. The payload
+ * 			up to 8 bytes is kept with the CAN ID, a larger one is copied into the buffer of the PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	data - A pointer to the payload.
+ * @param	size - The payload size. 0 - the PGN isn't sent until the payload is set.
+ * @retval	J1939_CYCLIC_OK, J1939_CYCLIC_INVALID or J1939_CYCLIC_BUSY if the buffer is being sent.
+ */
+uint8_t J1939_setCyclicData(J1939_instance* instance, uint32_t PGN, const uint8_t* data, uint16_t size)
+{
+	J1939_cyclicTransmit* cyclic = &instance->cyclic;
+	uint8_t slot = J1939_findCyclicPGN(cyclic, PGN);
+	J1939_cyclicPGN* cyclicPGN;
+
+	if(slot == J1939_CYCLIC_NO_PGN) return J1939_CYCLIC_INVALID;
+
+	cyclicPGN = &cyclic->PGNs[slot];
+
+	if(size <= J1939_SINGLE_FRAME_SIZE)
+	{
+		memcpy(cyclicPGN->data, data, size);
+	} else
+	{
+		if(size > cyclicPGN->buffer_size) return J1939_CYCLIC_INVALID;
+		if(J1939_isTXdataInUse(instance, cyclicPGN->buffer) == 1U) return J1939_CYCLIC_BUSY;
+
+		memcpy(cyclicPGN->buffer, data, size);
+	}
+
+	cyclicPGN->size = size;
+
+	return J1939_CYCLIC_OK;
+}
+
+/**
+ * @brief 	This function is used to get the cyclic transmission statistics.
+ * @param	instance - A pointer to the instance.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getCyclicStatistics(J1939_instance* instance, J1939_cyclicStatistics* statistics)
+{
+	*statistics = instance->cyclic.statistics;
+}
+
+/**
+ * @brief 	This function is used to reset the cyclic transmission statistics.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetCyclicStatistics(J1939_instance* instance)
+{
+	memset(&instance->cyclic.statistics, 0, sizeof(J1939_cyclicStatistics));
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is the timer callback: the due PGNs are sent in deadline order and the timer is
+ * 			armed for the next one.
+ * @param	context - A pointer to the instance.
+ * @retval	None.
+ */
+static void J1939_sendDueCyclicPGNs(void* context)
+{
+	J1939_instance* instance = (J1939_instance*)context;
+	J1939_cyclicTransmit* cyclic = &instance->cyclic;
+	J1939_cyclicStatistics* statistics = &cyclic->statistics;
+	uint32_t now = J1939_portGetTime();
+	uint8_t batch = 0U;
+
+	J1939_updateCyclicAddress(instance);
+
+	while(cyclic->heap_size > 0U)
+	{
+		J1939_cyclicPGN* cyclicPGN = &cyclic->PGNs[cyclic->heap[0]];
+		J1939_cyclicResult result;
+		uint32_t lateness;
+
+		if(J1939_CYCLIC_IS_DUE(cyclicPGN->due_time, now) == 0) break;
+
+		result = J1939_sendCyclicPGN(instance, cyclicPGN);
+
+		if(result == J1939_CYCLIC_NO_TX_SLOT)
+		{
+			// The frames of the next PGNs wouldn't be queued either
+			statistics->deferred++;
+			if(batch > statistics->max_batch) statistics->max_batch = batch;
+			J1939_armTimer(instance, &cyclic->timer, J1939_CYCLIC_RETRY_TIME, J1939_sendDueCyclicPGNs, instance);
+			return;
+		}
+
+		if(result == J1939_CYCLIC_NO_BAM_SESSION)
+		{
+			// The deadline is kept, the single frames of the next PGNs go on
+			statistics->deferred++;
+			cyclicPGN->due_time = now + J1939_CYCLIC_RETRY_TIME;
+			J1939_siftDown(cyclic, 0U);
+			continue;
+		}
+
+		if(result == J1939_CYCLIC_SENT)
+		{
+			lateness = now - cyclicPGN->deadline;
+			statistics->total_lateness += lateness;
+			if(lateness > statistics->max_lateness) statistics->max_lateness = lateness;
+			batch++;
+		} else
+		{
+			statistics->skipped++;
+		}
+
+		// The deadlines don't drift, the passed ones are counted as missed
+		cyclicPGN->deadline += cyclicPGN->period;
+		if(J1939_CYCLIC_IS_DUE(cyclicPGN->deadline, now))
+		{
+			uint32_t missedCycles = ((now - cyclicPGN->deadline) / cyclicPGN->period) + 1U;
+
+			cyclicPGN->deadline += missedCycles * cyclicPGN->period;
+			statistics->missed_cycles += missedCycles;
+		}
+
+		cyclicPGN->due_time = cyclicPGN->deadline;
+		J1939_siftDown(cyclic, 0U);
+	}
+
+	if(batch > statistics->max_batch) statistics->max_batch = batch;
+
+	J1939_armCyclicTimer(instance, now);
+}
+
+/**
+ * @brief 	This function is used to send the payload of the cyclic PGN: a single frame with the made
+ * 			CAN ID or BAM if the payload is above 8 bytes.
+ * @param	instance - A pointer to the instance.
+ * @param	cyclicPGN - A pointer to the cyclic PGN.
+ * @retval	The result of the attempt.
+ */
+static J1939_cyclicResult J1939_sendCyclicPGN(J1939_instance* instance, J1939_cyclicPGN* cyclicPGN)
+{
+	uint8_t* data = cyclicPGN->data;
+	uint16_t size = cyclicPGN->size;
+	J1939_TP_session* session;
+
+	// Only the address claim can be sent without an address
+	if(instance->cyclic.address == J1939_NULL_ADDRESS) return J1939_CYCLIC_SKIPPED;
+
+	// The previous BAM is still sent from the buffer
+	if((cyclicPGN->buffer != NULL) && (J1939_isTXdataInUse(instance, cyclicPGN->buffer) == 1U)) return J1939_CYCLIC_NO_BAM_SESSION;
+
+	if(cyclicPGN->provider != NULL)
+	{
+		uint16_t maxSize = (cyclicPGN->buffer != NULL) ? cyclicPGN->buffer_size : J1939_SINGLE_FRAME_SIZE;
+
+		if(cyclicPGN->buffer != NULL) data = cyclicPGN->buffer;
+
+		size = cyclicPGN->provider(cyclicPGN->context, cyclicPGN->PGN, data, maxSize);
+		if(size > maxSize) size = maxSize;
+	} else if(size > J1939_SINGLE_FRAME_SIZE)
+	{
+		data = cyclicPGN->buffer;
+	}
+
+	if(size == 0U) return J1939_CYCLIC_SKIPPED;
+
+	if(size <= J1939_SINGLE_FRAME_SIZE)
+	{
+		if(J1939_sendFrame(instance, cyclicPGN->can_id, data, (uint8_t)size) != J1939_PORT_FRAME_QUEUED) return J1939_CYCLIC_NO_TX_SLOT;
+
+		instance->cyclic.statistics.frames++;
+		return J1939_CYCLIC_SENT;
+	}
+
+	// Only one broadcast session can be open
+	session = J1939_fillTPstructures(instance, data, size, cyclicPGN->PGN, J1939_BROADCAST_ADDRESS);
+	if(session == NULL) return J1939_CYCLIC_NO_BAM_SESSION;
+
+	J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_BAM);
+
+	instance->cyclic.statistics.BAM_messages++;
+	return J1939_CYCLIC_SENT;
+}
+
+/**
+ * @brief 	This function is used to make the CAN IDs again if the ECU address has been changed.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+static void J1939_updateCyclicAddress(J1939_instance* instance)
+{
+	J1939_cyclicTransmit* cyclic = &instance->cyclic;
+	uint8_t address = J1939_getCurrentECUAddress(instance);
+
+	if(address == cyclic->address) return;
+
+	for(uint8_t slot = 0U; slot < J1939_MAX_CYCLIC_PGNS; slot++)
+	{
+		cyclic->PGNs[slot].can_id = (cyclic->PGNs[slot].can_id & 0xFFFFFF00UL) | address;
+	}
+
+	cyclic->address = address;
+}
+
+/**
+ * @brief 	This function is used to choose the phase of a new PGN with the fewest coincident deadlines
+ * 			of the registered PGNs. The deadlines of two PGNs coincide if their phases are equal modulo
+ * 			the GCD of the periods, once per LCM of the periods.
+ * @param	cyclic - A pointer to the cyclic transmission.
+ * @param	period - The period of the new PGN, ms.
+ * @retval	The phase, ms.
+ */
+static uint32_t J1939_chooseCyclicPhase(J1939_cyclicTransmit* cyclic, uint32_t period)
+{
+	uint32_t divisors[J1939_MAX_CYCLIC_PGNS];
+	uint32_t residues[J1939_MAX_CYCLIC_PGNS];
+	uint64_t weights[J1939_MAX_CYCLIC_PGNS];
+	uint64_t bestCost = UINT64_MAX;
+	uint32_t bestPhase = 0U;
+
+	for(uint8_t i = 0U; i < cyclic->heap_size; i++)
+	{
+		J1939_cyclicPGN* cyclicPGN = &cyclic->PGNs[cyclic->heap[i]];
+		uint32_t a = period, b = cyclicPGN->period;
+		uint64_t lcm;
+
+		while(b != 0U)
+		{
+			uint32_t remainder = a % b;
+
+			a = b;
+			b = remainder;
+		}
+
+		lcm = ((uint64_t)period / a) * cyclicPGN->period;
+
+		divisors[i]	= a;
+		residues[i]	= cyclicPGN->phase % a;
+		weights[i]	= (lcm < J1939_CYCLIC_COINCIDENCE_SCALE) ? (J1939_CYCLIC_COINCIDENCE_SCALE / lcm) : 1U;
+	}
+
+	for(uint32_t phase = 0U; phase < period; phase++)
+	{
+		uint64_t cost = 0U;
+
+		for(uint8_t i = 0U; (i < cyclic->heap_size) && (cost < bestCost); i++)
+		{
+			if((phase % divisors[i]) == residues[i]) cost += weights[i];
+		}
+
+		if(cost < bestCost)
+		{
+			bestCost	= cost;
+			bestPhase	= phase;
+			if(cost == 0U) break;
+		}
+	}
+
+	return bestPhase;
+}
+
+/**
+ * @brief 	This function is used to find the slot of the registered PGN.
+ * @param	cyclic - A pointer to the cyclic transmission.
+ * @param	PGN - The PGN.
+ * @retval	The slot. J1939_CYCLIC_NO_PGN if the PGN isn't registered.
+ */
+static uint8_t J1939_findCyclicPGN(J1939_cyclicTransmit* cyclic, uint32_t PGN)
+{
+	for(uint8_t slot = 0U; slot < J1939_MAX_CYCLIC_PGNS; slot++)
+	{
+		if((cyclic->PGNs[slot].in_use == 1U) && (cyclic->PGNs[slot].PGN == PGN)) return slot;
+	}
+
+	return J1939_CYCLIC_NO_PGN;
+}
+
+/**
+ * @brief 	This function is used to arm the timer for the earliest due time or to stop it if no PGN is registered.
+ * @param	instance - A pointer to the instance.
+ * @param	now - The current time, ms.
+ * @retval	None.
+ */
+static void J1939_armCyclicTimer(J1939_instance* instance, uint32_t now)
+{
+	J1939_cyclicTransmit* cyclic = &instance->cyclic;
+	uint32_t dueTime;
+
+	if(cyclic->heap_size == 0U)
+	{
+		J1939_cancelTimer(instance, &cyclic->timer);
+		return;
+	}
+
+	dueTime = cyclic->PGNs[cyclic->heap[0]].due_time;
+
+	J1939_armTimer(instance, &cyclic->timer, J1939_CYCLIC_IS_DUE(dueTime, now) ? 0U : (dueTime - now),
+				   J1939_sendDueCyclicPGNs, instance);
+}
+
+/**
+ * @brief 	This function is used to remove the PGN from the heap.
+ * @param	cyclic - A pointer to the cyclic transmission.
+ * @param	slot - The slot of the PGN.
+ * @retval	None.
+ */
+static void J1939_removeFromHeap(J1939_cyclicTransmit* cyclic, uint8_t slot)
+{
+	for(uint8_t position = 0U; position < cyclic->heap_size; position++)
+	{
+		if(cyclic->heap[position] != slot) continue;
+
+		// The last PGN takes the place and is moved up or down
+		cyclic->heap[position] = cyclic->heap[--cyclic->heap_size];
+
+		if(position < cyclic->heap_size)
+		{
+			J1939_siftDown(cyclic, position);
+			J1939_siftUp(cyclic, position);
+		}
+
+		return;
+	}
+}
+
+/**
+ * @brief 	This function is used to move the PGN towards the root while it is due earlier than its parent.
+ * @param	cyclic - A pointer to the cyclic transmission.
+ * @param	position - The heap position of the PGN.
+ * @retval	None.
+ */
+static void J1939_siftUp(J1939_cyclicTransmit* cyclic, uint8_t position)
+{
+	uint8_t slot = cyclic->heap[position];
+	uint32_t dueTime = cyclic->PGNs[slot].due_time;
+
+	while(position > 0U)
+	{
+		uint8_t parent = (uint8_t)((position - 1U) / 2U);
+
+		if(!J1939_CYCLIC_IS_EARLIER(dueTime, cyclic->PGNs[cyclic->heap[parent]].due_time)) break;
+
+		cyclic->heap[position] = cyclic->heap[parent];
+		position = parent;
+	}
+
+	cyclic->heap[position] = slot;
+}
+
+/**
+ * @brief 	This function is used to move the PGN towards the leaves while a child is due earlier.
+ * @param	cyclic - A pointer to the cyclic transmission.
+ * @param	position - The heap position of the PGN.
+ * @retval	None.
+ */
+static void J1939_siftDown(J1939_cyclicTransmit* cyclic, uint8_t position)
+{
+	uint8_t slot = cyclic->heap[position];
+	uint32_t dueTime = cyclic->PGNs[slot].due_time;
+
+	for(;;)
+	{
+		uint16_t child = (uint16_t)((2U * position) + 1U);
+
+		if(child >= cyclic->heap_size) break;
+
+		if(((child + 1U) < cyclic->heap_size) && \
+		   J1939_CYCLIC_IS_EARLIER(cyclic->PGNs[cyclic->heap[child + 1U]].due_time, cyclic->PGNs[cyclic->heap[child]].due_time)) child++;
+
+		if(!J1939_CYCLIC_IS_EARLIER(cyclic->PGNs[cyclic->heap[child]].due_time, dueTime)) break;
+
+		cyclic->heap[position] = cyclic->heap[child];
+		position = (uint8_t)child;
+	}
+
+	cyclic->heap[position] = slot;
+}
@@ -0,0 +1,704 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Dispatcher.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the SAE J1939-21 receive
+  * 		 dispatcher. The PGN of a frame is found by two array lookups:
+  * 		 the data page and the PDU format select a PDU1 handler chain or
+  * 		 a PDU2 group, the PDU specific selects the chain in the group.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_PDU_FORMAT_POS					(16U)
+#define J1939_PDU_SPECIFIC_POS					(8U)
+#define J1939_PDU2_FORMAT						(240U)
+
+#define J1939_GET_SOURCE_ADDRESS(canId)			((uint8_t)(canId))
+#define J1939_GET_PDU_SPECIFIC(canId)			((uint8_t)((canId) >> J1939_PDU_SPECIFIC_POS))
+#define J1939_GET_PDU_FORMAT(canId)				((uint8_t)((canId) >> J1939_PDU_FORMAT_POS))
+
+// EDP, DP and PDU format of the CAN ID or of the PGN
+#define J1939_GET_GROUP_FROM_ID(canId)			(((canId) >> J1939_PDU_FORMAT_POS) & 0x3FFU)
+#define J1939_GET_GROUP_FROM_PGN(PGN)			(((PGN) >> 8U) & 0x3FFU)
+#define J1939_IS_PDU2_PGN(PGN)					((uint8_t)((PGN) >> 8U) >= J1939_PDU2_FORMAT)
+
+#define J1939_REQUEST_DLC						(3U)
+#define J1939_GET_REQUESTED_PGN(data)			(((uint32_t)(data)[2] << 16U) | ((uint32_t)(data)[1] << 8U) | (data)[0])
+
+#define J1939_NO_ENTRY							(0U)
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static uint8_t* J1939_getPGNentry(J1939_dispatcher* dispatcher, uint32_t PGN, uint8_t create);
+static void J1939_callHandlers(J1939_dispatcher* dispatcher, uint8_t entry, uint32_t PGN, uint8_t sourceAddress,
+							   uint8_t destinationAddress, const uint8_t* data, uint16_t size);
+static void J1939_routeTP_connectionManagement(J1939_instance* instance, uint32_t canId, const uint8_t* data);
+static void J1939_routeTP_dataTransfer(J1939_instance* instance, uint32_t canId, const uint8_t* data);
+static void J1939_closeTPsession(J1939_TP_session* session);
+static void J1939_routeETP_connectionManagement(J1939_instance* instance, uint32_t canId, const uint8_t* data);
+static void J1939_routeETP_dataTransfer(J1939_instance* instance, uint32_t canId, const uint8_t* data);
+static void J1939_routeFDTP_connectionManagement(J1939_instance* instance, uint32_t canId, const uint8_t* data);
+static void J1939_routeFDTP_dataTransfer(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t length);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to register a handler of the PGN. A PGN can have several handlers
+ * 			with different address filters.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	sourceAddress - The source address filter. J1939_ANY_ADDRESS - any address.
+ * @param	destinationAddress - The destination address filter. J1939_ANY_ADDRESS - any address.
+ * @param	handler - A function to process the messages.
+ * @param	context - A user pointer passed to the handler.
+ * @retval	J1939_DISPATCH_OK or J1939_DISPATCH_NO_SLOT if there are no free handler slots or PDU2 groups.
+ */
+uint8_t J1939_registerPGNhandler(J1939_instance* instance, uint32_t PGN, uint16_t sourceAddress, uint16_t destinationAddress,
+								 J1939_PGNhandler handler, void* context)
+{
+	J1939_PGNhandlerSlot* handlers = instance->dispatcher.handlers;
+	uint8_t* entry;
+	uint8_t slot;
+
+	if(handler == NULL) return J1939_DISPATCH_NO_SLOT;
+
+	for(slot = 0U; slot < J1939_MAX_PGN_HANDLERS; slot++)
+	{
+		if(handlers[slot].handler == NULL) break;
+	}
+
+	if(slot == J1939_MAX_PGN_HANDLERS) return J1939_DISPATCH_NO_SLOT;
+
+	entry = J1939_getPGNentry(&instance->dispatcher, PGN, 1U);
+	if(entry == NULL) return J1939_DISPATCH_NO_SLOT;
+
+	// The handler becomes the head of the chain of the PGN
+	handlers[slot].PGN					= PGN;
+	handlers[slot].source_address		= sourceAddress;
+	handlers[slot].destination_address	= destinationAddress;
+	handlers[slot].handler				= handler;
+	handlers[slot].context				= context;
+	handlers[slot].next					= *entry;
+
+	*entry = slot + 1U;
+
+	if(J1939_IS_PDU2_PGN(PGN))
+	{
+		instance->dispatcher.PDU2group_handlers[instance->dispatcher.groups[J1939_GET_GROUP_FROM_PGN(PGN)] - 1U]++;
+	}
+
+	J1939_refreshAcceptanceFilters(instance);
+
+	return J1939_DISPATCH_OK;
+}
+
+/**
+ * @brief 	This function is used to remove all registrations of the handler for the PGN. The PDU2 group
+ * 			of the PGN is freed when its last handler is removed.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	handler - The function registered for the PGN.
+ * @retval	None.
+ */
+void J1939_unregisterPGNhandler(J1939_instance* instance, uint32_t PGN, J1939_PGNhandler handler)
+{
+	J1939_dispatcher* dispatcher = &instance->dispatcher;
+	J1939_PGNhandlerSlot* handlers = dispatcher->handlers;
+	uint8_t* link = J1939_getPGNentry(dispatcher, PGN, 0U);
+	uint8_t removedHandlers = 0U;
+
+	if(link == NULL) return;
+
+	// Unlink the matching handlers from the chain
+	while(*link != J1939_NO_ENTRY)
+	{
+		J1939_PGNhandlerSlot* slot = &handlers[*link - 1U];
+
+		if((slot->handler == handler) && (slot->PGN == PGN))
+		{
+			*link = slot->next;
+			*slot = (J1939_PGNhandlerSlot){0};
+			removedHandlers++;
+		} else
+		{
+			link = &slot->next;
+		}
+	}
+
+	// All chains of the group are empty after its last handler is removed
+	if(J1939_IS_PDU2_PGN(PGN) && (removedHandlers > 0U))
+	{
+		uint8_t* group = &dispatcher->groups[J1939_GET_GROUP_FROM_PGN(PGN)];
+
+		dispatcher->PDU2group_handlers[*group - 1U] -= removedHandlers;
+		if(dispatcher->PDU2group_handlers[*group - 1U] == 0U) *group = J1939_NO_ENTRY;
+	}
+
+	J1939_refreshAcceptanceFilters(instance);
+}
+
+/**
+ * @brief 	This function is used to get the registrations of the handlers, e.g. to make acceptance filters.
+ * @param	instance - A pointer to the instance.
+ * @param	registrations - A pointer to store the registrations.
+ * @param	maxRegistrations - The maximum number of registrations to store.
+ * @retval	The number of stored registrations.
+ */
+uint8_t J1939_getPGNregistrations(J1939_instance* instance, J1939_PGNregistration* registrations, uint8_t maxRegistrations)
+{
+	J1939_PGNhandlerSlot* handlers = instance->dispatcher.handlers;
+	uint8_t numberOfRegistrations = 0U;
+
+	for(uint8_t slot = 0U; (slot < J1939_MAX_PGN_HANDLERS) && (numberOfRegistrations < maxRegistrations); slot++)
+	{
+		if(handlers[slot].handler == NULL) continue;
+
+		registrations[numberOfRegistrations].PGN					= handlers[slot].PGN;
+		registrations[numberOfRegistrations].source_address		= handlers[slot].source_address;
+		registrations[numberOfRegistrations].destination_address	= handlers[slot].destination_address;
+		numberOfRegistrations++;
+	}
+
+	return numberOfRegistrations;
+}
+
+/**
+ * @brief 	This function is used to route a received frame. Frames addressed to other ECUs are dropped,
+ * 			TP.CM, TP.DT, ETP.CM and ETP.DT frames are processed by the transport layer, multi-PG, FD.TP.CM and FD.TP.DT frames
+ * 			by the CAN FD data link of the instance, address claims and requests for
+ * 			them by the network management layer, requests for the PGNs with a provider by the request
+ * 			responder. The other frames and the requests are passed to the handlers of their PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	None.
+ */
+void J1939_dispatchFrame(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	J1939_dispatcher* dispatcher = &instance->dispatcher;
+	uint8_t PDUformat = J1939_GET_PDU_FORMAT(canId);
+	uint8_t destinationAddress = J1939_BROADCAST_ADDRESS;
+	uint32_t group = J1939_GET_GROUP_FROM_ID(canId);
+	uint32_t PGN;
+	uint8_t entry;
+
+	instance->statistics.frames_received++;
+	J1939_TRACE_FRAME(instance, J1939_TRACE_FRAME_RX, canId, data, dlc);
+
+	if(PDUformat < J1939_PDU2_FORMAT)
+	{
+		// The PDU specific of PDU1 is the destination address
+		destinationAddress = J1939_GET_PDU_SPECIFIC(canId);
+
+		if((destinationAddress != J1939_BROADCAST_ADDRESS) && (destinationAddress != J1939_getCurrentECUAddress(instance))) return;
+
+#if (J1939_TP_CLAIMED_SOURCES_ONLY == 1U)
+		// Transport sessions are opened only with the ECUs which have claimed their addresses
+		if(((PDUformat == J1939_CONNECTION_MANAGEMENT) || (PDUformat == J1939_DATA_TRANSFER) || \
+			(PDUformat == J1939_ETP_CONNECTION_MANAGEMENT) || (PDUformat == J1939_ETP_DATA_TRANSFER)) && \
+		   (J1939_isAddressClaimed(instance, J1939_GET_SOURCE_ADDRESS(canId)) == 0U)) return;
+#endif
+
+		// The address claim messages are also passed to the handlers of their PGNs
+		if(PDUformat == J1939_ADDRESS_CLAIM)
+		{
+			if(dlc >= J1939_FRAME_MAX_DLC) J1939_readAddressClaimed(instance, J1939_GET_SOURCE_ADDRESS(canId), data);
+		} else if((PDUformat == J1939_REQUEST) && (dlc >= J1939_REQUEST_DLC))
+		{
+			if(J1939_GET_REQUESTED_PGN(data) == J1939_ADDRESS_CLAIMED_PGN)
+			{
+				J1939_readRequestForAddressClaimed(instance);
+			} else
+			{
+				J1939_readRequest(instance, J1939_GET_SOURCE_ADDRESS(canId), destinationAddress, J1939_GET_REQUESTED_PGN(data));
+			}
+		}
+
+		if(PDUformat == J1939_CONNECTION_MANAGEMENT)
+		{
+			if(dlc >= J1939_FRAME_MAX_DLC) J1939_routeTP_connectionManagement(instance, canId, data);
+			return;
+		}
+
+		if(PDUformat == J1939_DATA_TRANSFER)
+		{
+			if(dlc >= J1939_FRAME_MAX_DLC) J1939_routeTP_dataTransfer(instance, canId, data);
+			return;
+		}
+
+		if(PDUformat == J1939_ETP_CONNECTION_MANAGEMENT)
+		{
+			if(dlc >= J1939_FRAME_MAX_DLC) J1939_routeETP_connectionManagement(instance, canId, data);
+			return;
+		}
+
+		if(PDUformat == J1939_ETP_DATA_TRANSFER)
+		{
+			if(dlc >= J1939_FRAME_MAX_DLC) J1939_routeETP_dataTransfer(instance, canId, data);
+			return;
+		}
+
+		// The frames of SAE J1939-22 are processed by an instance with the CAN FD data link
+		if(instance->data_link == J1939_DATA_LINK_FD)
+		{
+			if(PDUformat == J1939_MULTI_PG)
+			{
+				J1939_readMultiPG(instance, canId, data, dlc);
+				return;
+			}
+
+			if(PDUformat == J1939_FD_CONNECTION_MANAGEMENT)
+			{
+				if(dlc >= J1939_FD_TP_CM_LENGTH) J1939_routeFDTP_connectionManagement(instance, canId, data);
+				return;
+			}
+
+			if(PDUformat == J1939_FD_DATA_TRANSFER)
+			{
+				J1939_routeFDTP_dataTransfer(instance, canId, data, dlc);
+				return;
+			}
+		}
+
+		PGN		= group << 8U;
+		entry	= dispatcher->groups[group];
+	} else
+	{
+		PGN		= (group << 8U) | J1939_GET_PDU_SPECIFIC(canId);
+		entry	= (dispatcher->groups[group] == J1939_NO_ENTRY) ? J1939_NO_ENTRY : \
+				  dispatcher->PDU2groups[dispatcher->groups[group] - 1U][J1939_GET_PDU_SPECIFIC(canId)];
+	}
+
+	J1939_callHandlers(dispatcher, entry, PGN, J1939_GET_SOURCE_ADDRESS(canId), destinationAddress, data, dlc);
+}
+
+/**
+ * @brief 	This function is used to pass a message to the handlers of its PGN, e.g. a C-PG of a multi-PG
+ * 			frame or a message received by FD.TP.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN of the message.
+ * @param	sourceAddress - The source address of the message.
+ * @param	destinationAddress - The destination address of the message.
+ * @param	data - A pointer to the message.
+ * @param	size - The size of the message.
+ * @retval	None.
+ */
+void J1939_dispatchMessage(J1939_instance* instance, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+						   const uint8_t* data, uint16_t size)
+{
+	uint8_t* entry = J1939_getPGNentry(&instance->dispatcher, PGN, 0U);
+
+	if(entry != NULL) J1939_callHandlers(&instance->dispatcher, *entry, PGN, sourceAddress, destinationAddress, data, size);
+}
+
+/**
+ * @brief 	This function is used to route a frame of the receive ring. It can be passed to J1939_processFrames.
+ * @param	context - A pointer to the instance which receives the frame.
+ * @param	frame - A pointer to the frame.
+ * @retval	None.
+ */
+void J1939_dispatchRingFrame(void* context, const J1939_frame* frame)
+{
+	J1939_dispatchFrame((J1939_instance*)context, frame->can_id, frame->data, frame->dlc);
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to find the entry of the table which holds the first handler of the PGN.
+ * @param	dispatcher - A pointer to the dispatcher.
+ * @param	PGN - The PGN.
+ * @param	create - 1 - a PDU2 group is taken for the PGN if it has none, 0 - isn't.
+ * @retval	A pointer to the entry. NULL if the PGN has no entry and it can't be created.
+ */
+static uint8_t* J1939_getPGNentry(J1939_dispatcher* dispatcher, uint32_t PGN, uint8_t create)
+{
+	uint32_t group = J1939_GET_GROUP_FROM_PGN(PGN);
+
+	if((uint8_t)group < J1939_PDU2_FORMAT) return &dispatcher->groups[group];
+
+	if(dispatcher->groups[group] == J1939_NO_ENTRY)
+	{
+		uint8_t freeGroup;
+
+		if(create == 0U) return NULL;
+
+		// A group without handlers is free
+		for(freeGroup = 0U; freeGroup < J1939_MAX_PDU2_GROUPS; freeGroup++)
+		{
+			if(dispatcher->PDU2group_handlers[freeGroup] == 0U) break;
+		}
+
+		if(freeGroup == J1939_MAX_PDU2_GROUPS) return NULL;
+
+		dispatcher->groups[group] = freeGroup + 1U;
+	}
+
+	return &dispatcher->PDU2groups[dispatcher->groups[group] - 1U][(uint8_t)PGN];
+}
+
+/**
+ * @brief 	This function is used to pass the message to the handlers of the chain which accept its addresses.
+ * @param	dispatcher - A pointer to the dispatcher.
+ * @param	entry - The first handler of the PGN + 1.
+ * @param	PGN - The PGN of the message.
+ * @param	sourceAddress - The source address of the message.
+ * @param	destinationAddress - The destination address of the message.
+ * @param	data - A pointer to the message.
+ * @param	size - The size of the message.
+ * @retval	None.
+ */
+static void J1939_callHandlers(J1939_dispatcher* dispatcher, uint8_t entry, uint32_t PGN, uint8_t sourceAddress,
+							   uint8_t destinationAddress, const uint8_t* data, uint16_t size)
+{
+	while(entry != J1939_NO_ENTRY)
+	{
+		J1939_PGNhandlerSlot* slot = &dispatcher->handlers[entry - 1U];
+
+		if(((slot->source_address == J1939_ANY_ADDRESS) || (slot->source_address == sourceAddress)) && \
+		   ((slot->destination_address == J1939_ANY_ADDRESS) || (slot->destination_address == destinationAddress)))
+		{
+			slot->handler(slot->context, PGN, sourceAddress, destinationAddress, data, size);
+		}
+
+		entry = slot->next;
+	}
+}
+
+/**
+ * @brief 	This function is used to process a TP.CM frame as the application does: RTS is answered by CTS,
+ * 			CTS by the data transfer packages, errors by the abort message.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @retval	None.
+ */
+static void J1939_routeTP_connectionManagement(J1939_instance* instance, uint32_t canId, const uint8_t* data)
+{
+	J1939_TP_session* session = NULL;
+	J1939_status status = J1939_readTP_connectionManagement(instance, canId, data, &session);
+	uint8_t sentPackages;
+
+	switch(status)
+	{
+		case J1939_STATUS_GOT_RTS_MESSAGE:
+			J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_CTS);
+			break;
+
+		case J1939_STATUS_GOT_CTS_MESSAGE:
+			J1939_sendTP_dataTransferBurst(session, &sentPackages);
+			break;
+
+		case J1939_STATUS_GOT_EOM_MESSAGE:
+		case J1939_STATUS_GOT_ABORT_SESSION:
+			J1939_closeTPsession(session);
+			break;
+
+		case J1939_ERROR_BUSY:
+			// The new peer-to-peer message can't be received
+			if((session == NULL) && (data[0] == J1939_CONTROL_BYTE_TP_CM_RTS))
+			{
+				J1939_sendTP_abort(instance, J1939_GET_SOURCE_ADDRESS(canId), (((uint32_t)data[7] << 16U) | \
+								   ((uint32_t)data[6] << 8U) | data[5]), J1939_REASON_BUSY);
+			}
+			break;
+
+		case J1939_ERROR_MEMORY_ALLOCATION:
+		case J1939_ERROR_TOO_BIG_MESSAGE:
+			if(session->type == J1939_TP_SESSION_PTP_RX)
+			{
+				J1939_setAbortReason(session, (status == J1939_ERROR_TOO_BIG_MESSAGE) ? J1939_REASON_TOO_BIG_MESSAGE : \
+											  J1939_REASON_MEMORY_ALLOCATION_ERROR, J1939_USE_CURRENT_DA);
+				J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_ABORT);
+			}
+
+			J1939_closeTPsession(session);
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief 	This function is used to process a TP.DT frame as the application does: the complete message
+ * 			is acknowledged and passed to the handlers of its PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @retval	None.
+ */
+static void J1939_routeTP_dataTransfer(J1939_instance* instance, uint32_t canId, const uint8_t* data)
+{
+	J1939_TP_session* session = NULL;
+	J1939_status status = J1939_readTP_dataTransfer(instance, canId, data, &session);
+	uint8_t* entry;
+
+	switch(status)
+	{
+		case J1939_STATUS_CTS:
+			J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_CTS);
+			break;
+
+		case J1939_STATUS_DATA_FINISHED:
+			if(session->type == J1939_TP_SESSION_PTP_RX)
+			{
+				J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_END_OF_MSG);
+			}
+
+			entry = J1939_getPGNentry(&instance->dispatcher, session->connectManagement.PGN_of_the_multipacket_message, 0U);
+
+			if(entry != NULL)
+			{
+				J1939_callHandlers(&instance->dispatcher, *entry, session->connectManagement.PGN_of_the_multipacket_message,
+								   session->source_address, session->destination_address,
+								   J1939_getReceivedMessage(session), session->connectManagement.message_size);
+			}
+
+			// The buffer goes to the consumer task with the message if the queue is enabled
+			J1939_queueReceivedMessage(session);
+			J1939_closeTPsession(session);
+			break;
+
+		case J1939_ERROR_MISSING_PACKAGES:
+			if(session->type == J1939_TP_SESSION_PTP_RX)
+			{
+				J1939_setAbortReason(session, J1939_REASON_RETRANSMIT_LIMIT, J1939_USE_CURRENT_DA);
+				J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_ABORT);
+			}
+
+			J1939_closeTPsession(session);
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief 	This function is used to free the message buffer of the session and to close it.
+ * @param	session - A pointer to the TP session.
+ * @retval	None.
+ */
+static void J1939_closeTPsession(J1939_TP_session* session)
+{
+	J1939_freeAllocatedMemory(session);
+	J1939_clearTPstructures(session);
+}
+
+/**
+ * @brief 	This function is used to process an ETP.CM frame as the application does: RTS is answered by CTS,
+ * 			CTS by DPO and the data transfer packages, errors by the abort message. The message is passed
+ * 			on by the sink registered by J1939_registerETPsink, RTS of a PGN without a sink is aborted.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @retval	None.
+ */
+static void J1939_routeETP_connectionManagement(J1939_instance* instance, uint32_t canId, const uint8_t* data)
+{
+	J1939_ETP_session* session = NULL;
+	J1939_status status = J1939_readETP_connectionManagement(instance, canId, data, &session);
+	uint8_t sentPackages;
+
+	switch(status)
+	{
+		case J1939_STATUS_GOT_RTS_MESSAGE:
+			if(session->sink != NULL)
+			{
+				J1939_sendETP_connectionManagement(session, J1939_TP_TYPE_CTS);
+				break;
+			}
+
+			// There is no one to pass the message on
+			J1939_setETPabortReason(session, J1939_REASON_MEMORY_ALLOCATION_ERROR);
+			J1939_sendETP_connectionManagement(session, J1939_TP_TYPE_ABORT);
+			J1939_clearETPstructures(session);
+			break;
+
+		case J1939_STATUS_GOT_CTS_MESSAGE:
+			J1939_sendETP_dataTransferBurst(session, &sentPackages);
+			break;
+
+		case J1939_STATUS_GOT_EOM_MESSAGE:
+		case J1939_STATUS_GOT_ABORT_SESSION:
+			J1939_clearETPstructures(session);
+			break;
+
+		case J1939_ERROR_BUSY:
+			// The new message can't be received
+			J1939_sendETP_abort(instance, J1939_GET_SOURCE_ADDRESS(canId), (((uint32_t)data[7] << 16U) | \
+								((uint32_t)data[6] << 8U) | data[5]), J1939_REASON_BUSY);
+			break;
+
+		case J1939_ERROR_TOO_BIG_MESSAGE:
+			J1939_setETPabortReason(session, J1939_REASON_TOO_BIG_MESSAGE);
+			J1939_sendETP_connectionManagement(session, J1939_TP_TYPE_ABORT);
+			J1939_clearETPstructures(session);
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief 	This function is used to process an ETP.DT frame as the application does: the complete window
+ * 			is answered by the next CTS, the last one by the end of message acknowledgment.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @retval	None.
+ */
+static void J1939_routeETP_dataTransfer(J1939_instance* instance, uint32_t canId, const uint8_t* data)
+{
+	J1939_ETP_session* session = NULL;
+	J1939_status status = J1939_readETP_dataTransfer(instance, canId, data, &session);
+
+	switch(status)
+	{
+		case J1939_STATUS_CTS:
+			J1939_sendETP_connectionManagement(session, J1939_TP_TYPE_CTS);
+			break;
+
+		case J1939_STATUS_DATA_FINISHED:
+			J1939_sendETP_connectionManagement(session, J1939_TP_TYPE_END_OF_MSG);
+			J1939_clearETPstructures(session);
+			break;
+
+		case J1939_ERROR_MISSING_PACKAGES:
+			J1939_setETPabortReason(session, J1939_REASON_RETRANSMIT_LIMIT);
+			J1939_sendETP_connectionManagement(session, J1939_TP_TYPE_ABORT);
+			J1939_clearETPstructures(session);
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief 	This function is used to process an FD.TP.CM frame as the application does: RTS is answered by CTS,
+ * 			CTS by the segments, the end of message status by the acknowledgment and the complete message
+ * 			is passed to the handlers of its PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @retval	None.
+ */
+static void J1939_routeFDTP_connectionManagement(J1939_instance* instance, uint32_t canId, const uint8_t* data)
+{
+	J1939_FDTP_session* session = NULL;
+	J1939_status status = J1939_readFDTP_connectionManagement(instance, canId, data, &session);
+	uint8_t sentSegments;
+
+	switch(status)
+	{
+		case J1939_STATUS_GOT_RTS_MESSAGE:
+		case J1939_STATUS_CTS:
+			J1939_sendFDTP_connectionManagement(session, J1939_TP_TYPE_CTS);
+			break;
+
+		case J1939_STATUS_GOT_CTS_MESSAGE:
+			J1939_sendFDTP_dataTransferBurst(session, &sentSegments);
+			break;
+
+		case J1939_STATUS_DATA_FINISHED:
+			J1939_sendFDTP_connectionManagement(session, J1939_TP_TYPE_END_OF_MSG);
+			J1939_dispatchMessage(instance, session->PGN_of_the_multipacket_message, session->source_address,
+								  session->destination_address, session->data, session->message_size);
+			J1939_queueReceivedFDTPmessage(session);
+			J1939_clearFDTPstructures(session);
+			break;
+
+		case J1939_STATUS_GOT_EOM_MESSAGE:
+		case J1939_STATUS_GOT_ABORT_SESSION:
+			J1939_clearFDTPstructures(session);
+			break;
+
+		case J1939_ERROR_BUSY:
+			// The new peer-to-peer message can't be received
+			if((data[0] & 0x0FU) == J1939_FD_CONTROL_RTS)
+			{
+				J1939_sendFDTP_abort(instance, J1939_GET_SOURCE_ADDRESS(canId), (uint8_t)(data[0] >> 4U),
+									 (((uint32_t)data[10] << 16U) | ((uint32_t)data[9] << 8U) | data[8]), J1939_REASON_BUSY);
+			}
+			break;
+
+		case J1939_ERROR_MEMORY_ALLOCATION:
+		case J1939_ERROR_TOO_BIG_MESSAGE:
+		case J1939_ERROR_MISSING_PACKAGES:
+			if(session->type == J1939_FD_TP_SESSION_PTP_RX)
+			{
+				J1939_setFDTPabortReason(session, (status == J1939_ERROR_TOO_BIG_MESSAGE) ? J1939_REASON_TOO_BIG_MESSAGE : \
+												  (status == J1939_ERROR_MEMORY_ALLOCATION) ? J1939_REASON_MEMORY_ALLOCATION_ERROR : \
+												  J1939_REASON_RETRANSMIT_LIMIT);
+				J1939_sendFDTP_connectionManagement(session, J1939_TP_TYPE_ABORT);
+			}
+
+			J1939_clearFDTPstructures(session);
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief 	This function is used to process an FD.TP.DT frame as the application does: the end of the window
+ * 			and a gap are answered by CTS, the complete broadcast message is passed to the handlers of its PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	length - The number of data bytes.
+ * @retval	None.
+ */
+static void J1939_routeFDTP_dataTransfer(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t length)
+{
+	J1939_FDTP_session* session = NULL;
+	J1939_status status = J1939_readFDTP_dataTransfer(instance, canId, data, length, &session);
+
+	switch(status)
+	{
+		case J1939_STATUS_CTS:
+			J1939_sendFDTP_connectionManagement(session, J1939_TP_TYPE_CTS);
+			break;
+
+		case J1939_STATUS_DATA_FINISHED:
+			J1939_dispatchMessage(instance, session->PGN_of_the_multipacket_message, session->source_address,
+								  session->destination_address, session->data, session->message_size);
+			J1939_queueReceivedFDTPmessage(session);
+			J1939_clearFDTPstructures(session);
+			break;
+
+		case J1939_ERROR_MISSING_PACKAGES:
+			if(session->type == J1939_FD_TP_SESSION_PTP_RX)
+			{
+				J1939_setFDTPabortReason(session, J1939_REASON_RETRANSMIT_LIMIT);
+				J1939_sendFDTP_connectionManagement(session, J1939_TP_TYPE_ABORT);
+			}
+
+			J1939_clearFDTPstructures(session);
+			break;
+
+		default:
+			break;
+	}
+}
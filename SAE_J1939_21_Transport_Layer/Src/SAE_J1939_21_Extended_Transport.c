@@ -0,0 +1,946 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Extended_Transport.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the SAE J1939-21 Extended
+  * 		 Transport Protocol. A session keeps only one CTS window of the
+  * 		 message, so the RAM doesn't depend on the message size.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_MAX_LENGTH_ETP_MODE_PACKAGE		(7U)
+
+#define J1939_PGN_PRIOTITY_POS					(26U)
+#define J1939_PDU_FORMAT_POS					(16U)
+#define J1939_PDU_SPECIFIC_POS					(8U)
+
+#define J1939_GET_SOURCE_ADDRESS(canId)			((uint8_t)(canId))
+#define J1939_GET_PDU_SPECIFIC(canId)			((uint8_t)((canId) >> J1939_PDU_SPECIFIC_POS))
+#define J1939_GET_24_BITS(data)					(((uint32_t)(data)[2] << 16U) | ((uint32_t)(data)[1] << 8U) | (data)[0])
+#define J1939_GET_32_BITS(data)					(((uint32_t)(data)[3] << 24U) | J1939_GET_24_BITS(data))
+
+#define J1939_NO_SESSION						(0U)
+#define J1939_CAN_DLC							(8U)
+#define J1939_PADDING_BYTE						(0xFFU)
+
+#define J1939_IS_PACKAGE_RECEIVED(session, i)	(((session)->received_packages_map[(i) >> 3U] >> ((i) & 7U)) & 1U)
+#define J1939_SET_PACKAGE_RECEIVED(session, i)	((session)->received_packages_map[(i) >> 3U] |= (uint8_t)(1U << ((i) & 7U)))
+
+#define J1939_GET_STATISTICS_TYPE(session)		(((session)->type == J1939_ETP_SESSION_TX) ? J1939_STATISTICS_ETP_TX : J1939_STATISTICS_ETP_RX)
+
+// Records an event of the session in the trace
+#define J1939_TRACE_ETP_SESSION(session, event, detail) \
+		J1939_TRACE((session)->instance, (event), (detail), (session)->PGN_of_the_multipacket_message, \
+					(session)->source_address, (session)->destination_address)
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static uint8_t J1939_getETPpeerAddress(J1939_ETP_session* session);
+static J1939_ETP_session* J1939_getETPsession(J1939_instance* instance, J1939_ETPsessionTypes type, uint8_t peerAddress);
+static J1939_ETP_sink* J1939_findETPsink(J1939_instance* instance, uint32_t PGN);
+static J1939_ETP_session* J1939_openETPsession(J1939_instance* instance, J1939_ETPsessionTypes type, uint8_t sourceAddress, uint8_t destinationAddress,
+											   uint32_t PGN);
+static uint32_t J1939_getETPid(J1939_instance* instance, uint8_t PDUformat, uint8_t destinationAddress);
+static uint16_t J1939_getETPbytes(J1939_ETP_session* session, uint32_t firstPackage, uint32_t packages);
+static J1939_status J1939_prepareETPretransmission(J1939_ETP_session* session);
+static J1939_status J1939_sendETP_package(J1939_ETP_session* session, uint32_t canId);
+static void J1939_ETPsessionTimeout(void* context);
+static void J1939_startETPpeerWait(J1939_ETP_session* session);
+static void J1939_stopETPpeerWait(J1939_ETP_session* session);
+static void J1939_setETPsessionState(J1939_ETP_session* session, J1939_states state);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to bind the session tables of the instance to its sessions.
+ * 			It is called by J1939_initInstance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initExtendedTransport(J1939_instance* instance)
+{
+	J1939_extendedTransport* ETP = &instance->ETP;
+
+	ETP->session_tables[J1939_ETP_SESSION_RX]	= (J1939_ETP_sessionTable){ETP->rx_sessions,	J1939_MAX_ETP_RX_SESSIONS,	{0}};
+	ETP->session_tables[J1939_ETP_SESSION_TX]	= (J1939_ETP_sessionTable){ETP->tx_sessions,	J1939_MAX_ETP_TX_SESSIONS,	{0}};
+
+	for(uint8_t type = 0U; type < J1939_ETP_SESSION_TYPES; type++)
+	{
+		J1939_ETP_sessionTable* table = &ETP->session_tables[type];
+
+		for(uint8_t slot = 0U; slot < table->number_of_sessions; slot++)
+		{
+			table->sessions[slot].type		= (J1939_ETPsessionTypes)type;
+			table->sessions[slot].instance	= instance;
+		}
+	}
+}
+
+/**
+ * @brief 	This function is used to read extended transport protocol connection management messages.
+ * 			RTS opens a new session, other messages are routed to the already opened session of the sender.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the received message.
+ * @param	data - A pointer to the receiving data.
+ * @param	session - A pointer to store the session of the message. NULL if there is no session.
+ * @retval	J1939 status. J1939_STATUS_GOT_RTS_MESSAGE - CTS must be sent. The sink registered for the PGN
+ * 			is set to the session, another one can be set by J1939_setETPsink.
+ */
+J1939_status J1939_readETP_connectionManagement(J1939_instance* instance, uint32_t canId, const uint8_t* data, J1939_ETP_session** session)
+{
+	J1939_status status = J1939_NO_STATUS;
+	J1939_ETP_session* currentSession = NULL;
+	J1939_ETP_sink* sink;
+	uint8_t sourceAddress = J1939_GET_SOURCE_ADDRESS(canId);
+	uint32_t PGN = J1939_GET_24_BITS(&data[5]);
+
+	switch(data[0])
+	{
+		case J1939_CONTROL_BYTE_ETP_CM_RTS:
+			// Only one session can be opened with the same ECU
+			if(J1939_getETPsession(instance, J1939_ETP_SESSION_RX, sourceAddress) == NULL)
+			{
+				currentSession = J1939_openETPsession(instance, J1939_ETP_SESSION_RX, sourceAddress, J1939_GET_PDU_SPECIFIC(canId), PGN);
+			}
+
+			if(currentSession == NULL)
+			{
+				instance->statistics.sessions[J1939_STATISTICS_ETP_RX].busy++;
+				status = J1939_ERROR_BUSY;
+				break;
+			}
+
+			currentSession->message_size					= J1939_GET_32_BITS(&data[1]);
+			currentSession->total_number_of_packages		= (currentSession->message_size + \
+															   (J1939_MAX_LENGTH_ETP_MODE_PACKAGE - 1U)) / \
+															  J1939_MAX_LENGTH_ETP_MODE_PACKAGE;
+			currentSession->PGN_of_the_multipacket_message	= PGN;
+			currentSession->next_package					= 1U;
+			J1939_setETPsessionState(currentSession, J1939_STATE_TP_RX_PTP_CTS);
+
+			if((sink = J1939_findETPsink(instance, PGN)) != NULL)
+			{
+				currentSession->sink	= sink->sink;
+				currentSession->context	= sink->context;
+			}
+
+			// The messages which fit TP must be sent by TP
+			if((currentSession->message_size < J1939_ETP_MIN_LENGTH_MESSAGE) || \
+			   (currentSession->message_size > J1939_ETP_MAX_LENGTH_MESSAGE))
+			{
+				status = J1939_ERROR_TOO_BIG_MESSAGE;
+			} else
+			{
+				// The session is closed if CTS isn't sent in time
+				J1939_armTimer(instance, &currentSession->timer, J1939_MESSAGE_CM_TIMEOUT, J1939_ETPsessionTimeout, currentSession);
+				status = J1939_STATUS_GOT_RTS_MESSAGE;
+			}
+			break;
+
+		case J1939_CONTROL_BYTE_ETP_CM_CTS:
+			currentSession = J1939_getETPsession(instance, J1939_ETP_SESSION_TX, sourceAddress);
+
+			if((currentSession != NULL) && (currentSession->CTS_available_message == 1U))
+			{
+				uint32_t nextPackage = J1939_GET_24_BITS(&data[2]);
+				uint32_t packages = data[1];
+
+				if((nextPackage == 0U) || (nextPackage > currentSession->total_number_of_packages)) break;
+
+				J1939_stopETPpeerWait(currentSession);
+				J1939_TRACE_ETP_SESSION(currentSession, J1939_TRACE_CTS_RECEIVED, data[1]);
+
+				// The packages already sent and requested again are counted as retransmitted
+				if(nextPackage < currentSession->next_package)
+				{
+					instance->statistics.sessions[J1939_STATISTICS_ETP_TX].retransmitted_packages += \
+						(packages < (currentSession->next_package - nextPackage)) ? packages : (currentSession->next_package - nextPackage);
+				}
+
+				// The window is limited by the window buffer and by the end of the message
+				if(packages > J1939_ETP_WINDOW_PACKAGES) packages = J1939_ETP_WINDOW_PACKAGES;
+				if(packages > (currentSession->total_number_of_packages - nextPackage + 1U))
+				{
+					packages = currentSession->total_number_of_packages - nextPackage + 1U;
+				}
+
+				if(packages > 0U)
+				{
+					// Read the whole window from the source, DPO is sent before its packages
+					currentSession->next_package				= nextPackage;
+					currentSession->window_first				= nextPackage;
+					currentSession->window_packages				= (uint8_t)packages;
+					currentSession->data_packet_offset			= nextPackage - 1U;
+					currentSession->remaining_packages_from_CTS	= (uint8_t)packages;
+					currentSession->DPO_pending					= 1U;
+					currentSession->CTS_available_message		= 0U;
+					J1939_setETPsessionState(currentSession, J1939_STATE_TP_TX_PTP_DATA);
+
+					currentSession->source(currentSession->context,
+										   (nextPackage - 1U) * J1939_MAX_LENGTH_ETP_MODE_PACKAGE,
+										   currentSession->window, J1939_getETPbytes(currentSession, nextPackage, packages));
+
+					J1939_cancelTimer(instance, &currentSession->timer);
+				} else
+				{
+					// CTS with zero packages holds the connection open, the next CTS is waited
+					J1939_armTimer(instance, &currentSession->timer, J1939_MESSAGE_HOLD_TIMEOUT, J1939_ETPsessionTimeout, currentSession);
+				}
+
+				status = J1939_STATUS_GOT_CTS_MESSAGE;
+			}
+			break;
+
+		case J1939_CONTROL_BYTE_ETP_CM_DPO:
+			currentSession = J1939_getETPsession(instance, J1939_ETP_SESSION_RX, sourceAddress);
+
+			if((currentSession != NULL) && (currentSession->state == J1939_STATE_TP_RX_PTP_DATA))
+			{
+				// The sequence numbers of the following packages are counted from the offset
+				currentSession->DPO_packages		= data[1];
+				currentSession->data_packet_offset	= J1939_GET_24_BITS(&data[2]);
+
+				J1939_armTimer(instance, &currentSession->timer, J1939_MESSAGE_DATA_TIMEOUT, J1939_ETPsessionTimeout, currentSession);
+			}
+			break;
+
+		case J1939_CONTROL_BYTE_ETP_CM_EndOfMsgACK:
+			currentSession = J1939_getETPsession(instance, J1939_ETP_SESSION_TX, sourceAddress);
+
+			if(currentSession != NULL)
+			{
+				J1939_cancelTimer(instance, &currentSession->timer);
+				J1939_countSessionCompleted(instance, J1939_STATISTICS_ETP_TX, currentSession->open_time);
+				J1939_TRACE_ETP_SESSION(currentSession, J1939_TRACE_SESSION_COMPLETE, J1939_STATISTICS_ETP_TX);
+				status = J1939_STATUS_GOT_EOM_MESSAGE;
+			}
+			break;
+
+		case J1939_CONTROL_BYTE_TP_CM_Abort:
+			// The abort message can be sent by both sides of the session
+			currentSession = J1939_getETPsession(instance, J1939_ETP_SESSION_TX, sourceAddress);
+
+			if((currentSession == NULL) || (currentSession->PGN_of_the_multipacket_message != PGN))
+			{
+				currentSession = J1939_getETPsession(instance, J1939_ETP_SESSION_RX, sourceAddress);
+			}
+
+			if(currentSession != NULL)
+			{
+				J1939_cancelTimer(instance, &currentSession->timer);
+				J1939_countSessionAbort(instance, J1939_GET_STATISTICS_TYPE(currentSession), data[1], 1U);
+				J1939_TRACE_ETP_SESSION(currentSession, J1939_TRACE_ABORT_RECEIVED, data[1]);
+				status = J1939_STATUS_GOT_ABORT_SESSION;
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	*session = currentSession;
+
+	return status;
+}
+
+/**
+ * @brief	This function is used to send extended transport protocol connection management messages:
+ * 			RTS, CTS, EOM or ABORT. DPO is sent by J1939_sendETP_dataTransferBurst.
+ * @param	session - A pointer to the ETP session.
+ * @param	type - A type of the connection management message.
+ * @retval	None.
+ */
+void J1939_sendETP_connectionManagement(J1939_ETP_session* session, J1939_TPcmTypes type)
+{
+	uint8_t peerAddress = J1939_getETPpeerAddress(session);
+	uint8_t data[8] = {0};
+	uint32_t packages;
+
+	// The abort message isn't bound to the state of the session
+	if(type == J1939_TP_TYPE_ABORT)
+	{
+		J1939_sendETP_abort(session->instance, peerAddress, session->PGN_of_the_multipacket_message, session->abort_reason);
+		J1939_countSessionAbort(session->instance, J1939_GET_STATISTICS_TYPE(session), session->abort_reason, 0U);
+		J1939_TRACE_ETP_SESSION(session, J1939_TRACE_ABORT_SENT, session->abort_reason);
+		session->abort_reason = 0U;
+		return;
+	}
+
+	// Fill in bytes that are the same for all messages
+	data[5] = (uint8_t)session->PGN_of_the_multipacket_message;
+	data[6] = (uint8_t)(session->PGN_of_the_multipacket_message >> 8U);
+	data[7] = (uint8_t)(session->PGN_of_the_multipacket_message >> 16U);
+
+	switch(type)
+	{
+		case J1939_TP_TYPE_RTS:
+		case J1939_TP_TYPE_END_OF_MSG:
+			data[0] = (type == J1939_TP_TYPE_RTS) ? J1939_CONTROL_BYTE_ETP_CM_RTS : J1939_CONTROL_BYTE_ETP_CM_EndOfMsgACK;
+			data[1] = (uint8_t)session->message_size;
+			data[2] = (uint8_t)(session->message_size >> 8U);
+			data[3] = (uint8_t)(session->message_size >> 16U);
+			data[4] = (uint8_t)(session->message_size >> 24U);
+
+			if(type == J1939_TP_TYPE_RTS)
+			{
+				session->CTS_available_message = 1U;
+				J1939_setETPsessionState(session, J1939_STATE_TP_TX_PTP_CTS);
+				J1939_startETPpeerWait(session);
+				J1939_armTimer(session->instance, &session->timer, J1939_MESSAGE_CM_TIMEOUT, J1939_ETPsessionTimeout, session);
+			} else
+			{
+				J1939_setETPsessionState(session, J1939_STATE_TP_RX_PTP_EOM);
+				J1939_cancelTimer(session->instance, &session->timer);
+			}
+			break;
+
+		case J1939_TP_TYPE_CTS:
+			if(session->retransmit_packages > 0U)
+			{
+				// Lost packages are requested again, the window buffer keeps the received ones
+				packages = session->retransmit_packages;
+				session->retransmit_packages = 0U;
+			} else
+			{
+				// A new window starts at the next package
+				packages = session->total_number_of_packages - session->next_package + 1U;
+				if(packages > J1939_ETP_WINDOW_PACKAGES) packages = J1939_ETP_WINDOW_PACKAGES;
+
+				session->window_first		= session->next_package;
+				session->window_packages	= (uint8_t)packages;
+				session->received_packages	= 0U;
+
+				for(uint8_t i = 0U; i < sizeof(session->received_packages_map); i++) session->received_packages_map[i] = 0U;
+			}
+
+			data[0] = J1939_CONTROL_BYTE_ETP_CM_CTS;
+			data[1] = (uint8_t)packages;
+			data[2] = (uint8_t)session->next_package;
+			data[3] = (uint8_t)(session->next_package >> 8U);
+			data[4] = (uint8_t)(session->next_package >> 16U);
+
+			// The packages are accepted after DPO
+			session->DPO_packages = 0U;
+			J1939_setETPsessionState(session, J1939_STATE_TP_RX_PTP_DATA);
+			J1939_TRACE_ETP_SESSION(session, J1939_TRACE_CTS_SENT, data[1]);
+			J1939_startETPpeerWait(session);
+			J1939_armTimer(session->instance, &session->timer, J1939_MESSAGE_DATA_TIMEOUT, J1939_ETPsessionTimeout, session);
+			break;
+
+		default:
+			return;
+	}
+
+	J1939_sendFrame(session->instance, J1939_getETPid(session->instance, J1939_ETP_CONNECTION_MANAGEMENT, peerAddress), data, J1939_CAN_DLC);
+}
+
+/**
+ * @brief	This function is used to send the extended transport protocol abort message.
+ * @param	instance - A pointer to the instance.
+ * @param	destinationAddress - ECU address to send the message to.
+ * @param	PGN - A PGN of the multipacket message.
+ * @param	abortReason - The abort reason.
+ * @retval	None.
+ */
+void J1939_sendETP_abort(J1939_instance* instance, uint8_t destinationAddress, uint32_t PGN, J1939_abortReasons abortReason)
+{
+	uint8_t data[8] = {0};
+
+	data[0] = J1939_CONTROL_BYTE_TP_CM_Abort;
+	data[1] = (uint8_t)abortReason;
+	data[2] = 0xFFU;
+	data[3] = 0xFFU;
+	data[4] = 0xFFU;
+	data[5] = (uint8_t)PGN;
+	data[6] = (uint8_t)(PGN >> 8U);
+	data[7] = (uint8_t)(PGN >> 16U);
+
+	J1939_sendFrame(instance, J1939_getETPid(instance, J1939_ETP_CONNECTION_MANAGEMENT, destinationAddress), data, J1939_CAN_DLC);
+}
+
+/**
+ * @brief 	This function is used to read extended transport protocol data transfer messages.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the received message.
+ * @param	data - A pointer to the receiving data.
+ * @param	session - A pointer to store the session of the message. NULL if there is no session.
+ * @retval	J1939 status. J1939_STATUS_CTS - the next CTS must be sent, J1939_STATUS_DATA_FINISHED - EOM.
+ */
+J1939_status J1939_readETP_dataTransfer(J1939_instance* instance, uint32_t canId, const uint8_t* data, J1939_ETP_session** session)
+{
+	J1939_status status = J1939_STATUS_DATA_CONTINUE;
+	J1939_ETP_session* currentSession = J1939_getETPsession(instance, J1939_ETP_SESSION_RX, J1939_GET_SOURCE_ADDRESS(canId));
+	uint8_t sequenceNumber = data[0];
+	uint32_t package;
+	uint8_t index;
+
+	*session = currentSession;
+
+	if((currentSession == NULL) || (currentSession->state != J1939_STATE_TP_RX_PTP_DATA)) return J1939_NO_STATUS;
+
+	// Packages out of DPO or out of the window buffer are ignored
+	if((sequenceNumber == 0U) || (sequenceNumber > currentSession->DPO_packages)) return status;
+
+	package = currentSession->data_packet_offset + sequenceNumber;
+	if((package < currentSession->window_first) || \
+	   (package >= (currentSession->window_first + currentSession->window_packages))) return status;
+
+	J1939_stopETPpeerWait(currentSession);
+
+	// Place the package by its number, a repeated package is written once
+	index = (uint8_t)(package - currentSession->window_first);
+
+	if(J1939_IS_PACKAGE_RECEIVED(currentSession, index) == 0U)
+	{
+		J1939_portCopy(&currentSession->window[(uint16_t)index * J1939_MAX_LENGTH_ETP_MODE_PACKAGE], &data[1],
+					   J1939_getETPbytes(currentSession, package, 1U));
+
+		J1939_SET_PACKAGE_RECEIVED(currentSession, index);
+		currentSession->received_packages++;
+	}
+
+	if(currentSession->received_packages == currentSession->window_packages)
+	{
+		// The window is complete, it is passed on and the next one is requested
+		if(currentSession->sink != NULL)
+		{
+			currentSession->sink(currentSession->context,
+								 (currentSession->window_first - 1U) * J1939_MAX_LENGTH_ETP_MODE_PACKAGE, currentSession->window,
+								 J1939_getETPbytes(currentSession, currentSession->window_first, currentSession->window_packages));
+		}
+
+		currentSession->next_package	= currentSession->window_first + currentSession->window_packages;
+		currentSession->retransmissions	= 0U;
+		J1939_setETPsessionState(currentSession, J1939_STATE_TP_RX_PTP_CTS);
+
+		status = (currentSession->next_package > currentSession->total_number_of_packages) ? J1939_STATUS_DATA_FINISHED : \
+																							 J1939_STATUS_CTS;
+
+		if(status == J1939_STATUS_DATA_FINISHED)
+		{
+			J1939_countSessionCompleted(instance, J1939_STATISTICS_ETP_RX, currentSession->open_time);
+			J1939_TRACE_ETP_SESSION(currentSession, J1939_TRACE_SESSION_COMPLETE, J1939_STATISTICS_ETP_RX);
+		}
+	} else if(sequenceNumber == currentSession->DPO_packages)
+	{
+		// The last package of DPO has been received, but the window has gaps
+		status = J1939_prepareETPretransmission(currentSession);
+	}
+
+	if(status == J1939_STATUS_DATA_CONTINUE)
+	{
+		J1939_armTimer(instance, &currentSession->timer, J1939_MESSAGE_DATA_TIMEOUT, J1939_ETPsessionTimeout, currentSession);
+	} else if(status != J1939_STATUS_CTS)
+	{
+		J1939_cancelTimer(instance, &currentSession->timer);
+	}
+
+	return status;
+}
+
+/**
+ * @brief	This function is used to send DPO and the packages of the CTS window, limited by the free TX slots
+ * 			of the CAN controller. The packages are read from the source by the whole window.
+ * @param	session - A pointer to the ETP session.
+ * @param	sentPackages - A pointer to store the number of queued packages.
+ * @return	J1939 status. J1939_STATUS_CTS if the window is over and the next CTS must be waited.
+ */
+J1939_status J1939_sendETP_dataTransferBurst(J1939_ETP_session* session, uint8_t* sentPackages)
+{
+	J1939_status status = J1939_STATUS_DATA_CONTINUE;
+	uint32_t canId = J1939_getETPid(session->instance, J1939_ETP_DATA_TRANSFER, session->destination_address);
+	uint8_t budget = J1939_getFreeTxSlots(session->instance);
+	uint8_t packages = 0U;
+	uint8_t data[8] = {0};
+
+	*sentPackages = 0U;
+
+	// The window is over, the next packages must be requested by CTS
+	if(session->CTS_available_message == 1U) return J1939_STATUS_CTS;
+
+	if(session->DPO_pending == 1U)
+	{
+		if(budget == 0U) return status;
+
+		data[0] = J1939_CONTROL_BYTE_ETP_CM_DPO;
+		data[1] = session->remaining_packages_from_CTS;
+		data[2] = (uint8_t)session->data_packet_offset;
+		data[3] = (uint8_t)(session->data_packet_offset >> 8U);
+		data[4] = (uint8_t)(session->data_packet_offset >> 16U);
+		data[5] = (uint8_t)session->PGN_of_the_multipacket_message;
+		data[6] = (uint8_t)(session->PGN_of_the_multipacket_message >> 8U);
+		data[7] = (uint8_t)(session->PGN_of_the_multipacket_message >> 16U);
+
+		// DPO is sent again by the next call if it hasn't been queued
+		if(J1939_sendFrame(session->instance, J1939_getETPid(session->instance, J1939_ETP_CONNECTION_MANAGEMENT, session->destination_address),
+						   data, J1939_CAN_DLC) != J1939_PORT_FRAME_QUEUED) return status;
+
+		session->DPO_pending = 0U;
+		budget--;
+	}
+
+	if(budget > session->remaining_packages_from_CTS) budget = session->remaining_packages_from_CTS;
+
+	while((packages < budget) && (status == J1939_STATUS_DATA_CONTINUE))
+	{
+		status = J1939_sendETP_package(session, canId);
+		packages++;
+	}
+
+	*sentPackages = packages;
+
+	return status;
+}
+
+/**
+ * @brief	This function is used to continue the CTS windows of all TX sessions which have been limited
+ * 			by the free TX slots. It is called when TX slots of the CAN controller are released.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of queued packages.
+ */
+uint16_t J1939_sendETPpendingPackages(J1939_instance* instance)
+{
+	J1939_ETP_session* txSessions = instance->ETP.tx_sessions;
+	uint16_t packages = 0U;
+	uint8_t sentPackages;
+
+	for(uint8_t slot = 0U; slot < J1939_MAX_ETP_TX_SESSIONS; slot++)
+	{
+		if((txSessions[slot].in_use == 1U) && (txSessions[slot].state == J1939_STATE_TP_TX_PTP_DATA))
+		{
+			J1939_sendETP_dataTransferBurst(&txSessions[slot], &sentPackages);
+			packages += sentPackages;
+		}
+	}
+
+	return packages;
+}
+
+/**
+ * @brief	This function used to open an ETP TX session. The message isn't stored, it is read by the source.
+ * @param	instance - A pointer to the instance.
+ * @param 	messageSize - A size of the message.
+ * @param 	PGN - A PGN of the multipacket message.
+ * @param 	destinationAddress - ECU address to send data to.
+ * @param	source - A function to read the message.
+ * @param	context - A user pointer passed to the source.
+ * @retval	A pointer to the TX session. NULL if a session to the destination address is
+ * 			already opened, there is no free session or the message size is out of
+ * 			J1939_ETP_MIN_LENGTH_MESSAGE to J1939_ETP_MAX_LENGTH_MESSAGE.
+ */
+J1939_ETP_session* J1939_fillETPstructures(J1939_instance* instance, uint32_t messageSize, uint32_t PGN, uint8_t destinationAddress,
+										   J1939_ETPsourceCallback source, void* context)
+{
+	J1939_ETP_session* session;
+
+	if((messageSize < J1939_ETP_MIN_LENGTH_MESSAGE) || (messageSize > J1939_ETP_MAX_LENGTH_MESSAGE) || (source == NULL) || \
+	   (destinationAddress == J1939_BROADCAST_ADDRESS)) return NULL;
+
+	// Only one session can be opened with the same ECU
+	session = (J1939_getETPsession(instance, J1939_ETP_SESSION_TX, destinationAddress) == NULL) ? \
+			  J1939_openETPsession(instance, J1939_ETP_SESSION_TX, J1939_getCurrentECUAddress(instance), destinationAddress, PGN) : NULL;
+
+	if(session == NULL)
+	{
+		instance->statistics.sessions[J1939_STATISTICS_ETP_TX].busy++;
+		return NULL;
+	}
+
+	session->message_size					= messageSize;
+	session->total_number_of_packages		= (messageSize + (J1939_MAX_LENGTH_ETP_MODE_PACKAGE - 1U)) / \
+											  J1939_MAX_LENGTH_ETP_MODE_PACKAGE;
+	session->PGN_of_the_multipacket_message	= PGN;
+	session->next_package					= 1U;
+	session->source							= source;
+	session->context						= context;
+	J1939_setETPsessionState(session, J1939_STATE_TP_TX_PTP_CTS);
+
+	return session;
+}
+
+/**
+ * @brief	This function is used to clean ETP structures and close the session.
+ * @param	session - A pointer to the ETP session.
+ * @retval	None.
+ */
+void J1939_clearETPstructures(J1939_ETP_session* session)
+{
+	J1939_ETP_sessionTable* table = &session->instance->ETP.session_tables[session->type];
+	uint8_t peerAddress = J1939_getETPpeerAddress(session);
+	J1939_ETPsessionTypes type = session->type;
+	J1939_instance* instance = session->instance;
+
+	J1939_cancelTimer(session->instance, &session->timer);
+
+	if(session->in_use == 1U)
+	{
+		J1939_countSessionClosed(instance, J1939_GET_STATISTICS_TYPE(session));
+		J1939_TRACE_ETP_SESSION(session, J1939_TRACE_SESSION_CLOSE, J1939_GET_STATISTICS_TYPE(session));
+	}
+
+	// Remove the session from the index if it still belongs to this session
+	if((table->index[peerAddress] != J1939_NO_SESSION) && (&table->sessions[table->index[peerAddress] - 1U] == session))
+	{
+		table->index[peerAddress] = J1939_NO_SESSION;
+	}
+
+	*session = (J1939_ETP_session){0};
+	session->type		= type;
+	session->instance	= instance;
+}
+
+/**
+ * @brief 	This function is used to set the function which receives the message of the RX session.
+ * @param	session - A pointer to the ETP session.
+ * @param	sink - A function to pass on the message.
+ * @param	context - A user pointer passed to the sink.
+ * @retval	None.
+ */
+void J1939_setETPsink(J1939_ETP_session* session, J1939_ETPsinkCallback sink, void* context)
+{
+	session->sink		= sink;
+	session->context	= context;
+}
+
+/**
+ * @brief 	This function is used to set the abort reason sent by J1939_sendETP_connectionManagement.
+ * @param	session - A pointer to the ETP session.
+ * @param 	abortReason - The abort reason.
+ * @retval	None.
+ */
+void J1939_setETPabortReason(J1939_ETP_session* session, J1939_abortReasons abortReason)
+{
+	session->abort_reason = abortReason;
+}
+
+/**
+ * @brief 	This function is used to set the function called when the library closes an ETP session itself.
+ * @param	instance - A pointer to the instance.
+ * @param	callback - A pointer to the function. NULL - no function.
+ * @retval	None.
+ */
+void J1939_setETPcallback(J1939_instance* instance, J1939_ETPcallback callback)
+{
+	instance->ETP.callback = callback;
+}
+
+/**
+ * @brief 	This function is used to set the sink of the messages of the PGN received by the RX sessions
+ * 			opened later, e.g. when the frames are routed by J1939_dispatchFrame. Sessions opened before
+ * 			the call aren't affected.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - A PGN of the multi-packet messages.
+ * @param	sink - A function to pass on the message. NULL - remove the sink of the PGN.
+ * @param	context - A user pointer passed to the sink.
+ * @retval	0 - the sink is registered, 1 - there is no free sink slot (J1939_MAX_ETP_SINKS).
+ */
+uint8_t J1939_registerETPsink(J1939_instance* instance, uint32_t PGN, J1939_ETPsinkCallback sink, void* context)
+{
+	J1939_ETP_sink* slot = J1939_findETPsink(instance, PGN);
+
+	// A new PGN takes a free slot
+	if(slot == NULL)
+	{
+		if(sink == NULL) return 0U;
+
+		for(uint8_t i = 0U; i < J1939_MAX_ETP_SINKS; i++)
+		{
+			if(instance->ETP.sinks[i].sink == NULL)
+			{
+				slot = &instance->ETP.sinks[i];
+				break;
+			}
+		}
+
+		if(slot == NULL) return 1U;
+	}
+
+	slot->PGN		= PGN;
+	slot->sink		= sink;
+	slot->context	= context;
+
+	return 0U;
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to get the address of the ECU on the other side of the session.
+ * @param	session - A pointer to the ETP session.
+ * @retval	The peer address.
+ */
+static uint8_t J1939_getETPpeerAddress(J1939_ETP_session* session)
+{
+	return (session->type == J1939_ETP_SESSION_TX) ? session->destination_address : session->source_address;
+}
+
+/**
+ * @brief 	This function is used to get the opened session with the peer.
+ * @param	instance - A pointer to the instance.
+ * @param	type - A type of the session.
+ * @param	peerAddress - The address of the ECU on the other side of the session.
+ * @retval	A pointer to the session. NULL if there is no session.
+ */
+static J1939_ETP_session* J1939_getETPsession(J1939_instance* instance, J1939_ETPsessionTypes type, uint8_t peerAddress)
+{
+	J1939_ETP_sessionTable* table = &instance->ETP.session_tables[type];
+	uint8_t slot = table->index[peerAddress];
+
+	return (slot == J1939_NO_SESSION) ? NULL : &table->sessions[slot - 1U];
+}
+
+/**
+ * @brief 	This function is used to find the sink of the PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - A PGN of the multi-packet message.
+ * @retval	A pointer to the sink. NULL if the PGN has no sink.
+ */
+static J1939_ETP_sink* J1939_findETPsink(J1939_instance* instance, uint32_t PGN)
+{
+	J1939_ETP_sink* sinks = instance->ETP.sinks;
+
+	for(uint8_t i = 0U; i < J1939_MAX_ETP_SINKS; i++)
+	{
+		if((sinks[i].sink != NULL) && (sinks[i].PGN == PGN)) return &sinks[i];
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief 	This function is used to take a free session slot and bind it to the peer.
+ * @param	instance - A pointer to the instance.
+ * @param	type - A type of the session.
+ * @param	sourceAddress - Originator of the multi-packet message.
+ * @param	destinationAddress - Recipient of the multi-packet message.
+ * @param	PGN - A PGN of the multi-packet message.
+ * @retval	A pointer to the session. NULL if there is no free session.
+ */
+static J1939_ETP_session* J1939_openETPsession(J1939_instance* instance, J1939_ETPsessionTypes type, uint8_t sourceAddress, uint8_t destinationAddress,
+											   uint32_t PGN)
+{
+	J1939_ETP_sessionTable* table = &instance->ETP.session_tables[type];
+	J1939_ETP_session* session = NULL;
+
+	for(uint8_t slot = 0U; slot < table->number_of_sessions; slot++)
+	{
+		if(table->sessions[slot].in_use == 0U)
+		{
+			session = &table->sessions[slot];
+
+			*session = (J1939_ETP_session){0};
+			session->type					= type;
+			session->source_address			= sourceAddress;
+			session->destination_address	= destinationAddress;
+			session->in_use					= 1U;
+			session->instance				= instance;
+			session->open_time				= J1939_portGetTime();
+			session->PGN_of_the_multipacket_message = PGN;
+
+			table->index[J1939_getETPpeerAddress(session)] = slot + 1U;
+			J1939_countSessionOpened(instance, J1939_GET_STATISTICS_TYPE(session));
+			J1939_TRACE_ETP_SESSION(session, J1939_TRACE_SESSION_OPEN, J1939_GET_STATISTICS_TYPE(session));
+			break;
+		}
+	}
+
+	return session;
+}
+
+/**
+ * @brief 	This function is used to build the CAN ID of the ETP messages.
+ * @param	instance - A pointer to the instance.
+ * @param	PDUformat - J1939_ETP_CONNECTION_MANAGEMENT or J1939_ETP_DATA_TRANSFER.
+ * @param	destinationAddress - ECU address to send the message to.
+ * @retval	The CAN ID.
+ */
+static uint32_t J1939_getETPid(J1939_instance* instance, uint8_t PDUformat, uint8_t destinationAddress)
+{
+	// ETP frames are sent with the priority of TP
+	return (((uint32_t)instance->TP.priority << J1939_PGN_PRIOTITY_POS) | ((uint32_t)PDUformat << J1939_PDU_FORMAT_POS) | \
+			((uint32_t)destinationAddress << J1939_PDU_SPECIFIC_POS) | J1939_getCurrentECUAddress(instance));
+}
+
+/**
+ * @brief 	This function is used to get the number of message bytes in the packages.
+ * @param	session - A pointer to the ETP session.
+ * @param	firstPackage - The first package number.
+ * @param	packages - The number of packages.
+ * @retval	The number of bytes, the last package of the message can be shorter.
+ */
+static uint16_t J1939_getETPbytes(J1939_ETP_session* session, uint32_t firstPackage, uint32_t packages)
+{
+	uint32_t offset = (firstPackage - 1U) * J1939_MAX_LENGTH_ETP_MODE_PACKAGE;
+	uint32_t bytes = packages * J1939_MAX_LENGTH_ETP_MODE_PACKAGE;
+
+	if(bytes > (session->message_size - offset)) bytes = session->message_size - offset;
+
+	return (uint16_t)bytes;
+}
+
+/**
+ * @brief	This function is used to request the first run of the lost packages of the window again.
+ * @param	session - A pointer to the ETP session.
+ * @return	J1939_STATUS_CTS or J1939_ERROR_MISSING_PACKAGES if J1939_TP_MAX_RETRANSMISSIONS of the package are over.
+ */
+static J1939_status J1939_prepareETPretransmission(J1939_ETP_session* session)
+{
+	uint8_t first = 0U;
+	uint8_t last;
+
+	while((first < session->window_packages) && (J1939_IS_PACKAGE_RECEIVED(session, first) == 1U)) first++;
+
+	if(first == session->window_packages) return J1939_STATUS_CTS;
+
+	// The same package is requested again a limited number of times
+	if(session->retransmitted_package != (session->window_first + first))
+	{
+		session->retransmitted_package	= session->window_first + first;
+		session->retransmissions		= 0U;
+	}
+
+	if(session->retransmissions >= J1939_TP_MAX_RETRANSMISSIONS) return J1939_ERROR_MISSING_PACKAGES;
+
+	session->retransmissions++;
+
+	last = first;
+	while((last < session->window_packages) && (J1939_IS_PACKAGE_RECEIVED(session, last) == 0U)) last++;
+
+	session->next_package			= session->window_first + first;
+	session->retransmit_packages	= last - first;
+
+	session->instance->statistics.sessions[J1939_STATISTICS_ETP_RX].retransmitted_packages += session->retransmit_packages;
+
+	return J1939_STATUS_CTS;
+}
+
+/**
+ * @brief	This function is used to send the next data transfer package from the window buffer.
+ * @param	session - A pointer to the ETP session.
+ * @param	canId - The CAN ID of the data transfer packages.
+ * @return	J1939 status.
+ */
+static J1939_status J1939_sendETP_package(J1939_ETP_session* session, uint32_t canId)
+{
+	J1939_status status = J1939_STATUS_DATA_CONTINUE;
+	uint16_t index = (uint16_t)(session->next_package - session->window_first) * J1939_MAX_LENGTH_ETP_MODE_PACKAGE;
+	uint16_t packageBytes = J1939_getETPbytes(session, session->next_package, 1U);
+	uint8_t data[8];
+
+	data[0] = (uint8_t)(session->next_package - session->data_packet_offset);
+	J1939_portCopy(&data[1], &session->window[index], packageBytes);
+
+	for(uint8_t i = packageBytes + 1U; i <= J1939_MAX_LENGTH_ETP_MODE_PACKAGE; i++) data[i] = J1939_PADDING_BYTE;
+
+	J1939_sendFrame(session->instance, canId, data, J1939_CAN_DLC);
+
+	session->next_package++;
+
+	// The next CTS or the end of message acknowledgment is expected within T3
+	if((--session->remaining_packages_from_CTS) == 0U)
+	{
+		session->CTS_available_message = 1U;
+
+		if(session->next_package > session->total_number_of_packages)
+		{
+			status = J1939_STATUS_DATA_FINISHED;
+			J1939_setETPsessionState(session, J1939_STATE_TP_TX_PTP_EOM);
+		} else
+		{
+			status = J1939_STATUS_CTS;
+			J1939_setETPsessionState(session, J1939_STATE_TP_TX_PTP_CTS);
+			J1939_startETPpeerWait(session);
+		}
+
+		J1939_armTimer(session->instance, &session->timer, J1939_MESSAGE_CM_TIMEOUT, J1939_ETPsessionTimeout, session);
+	}
+
+	return status;
+}
+
+/**
+ * @brief	This function is called by the timer wheel when the session has timed out. Lost packages
+ * 			at the end of the window are requested again, otherwise the session is aborted, by the
+ * 			retransmit limit if they have been requested J1939_TP_MAX_RETRANSMISSIONS times, and closed.
+ * @param	context - A pointer to the ETP session.
+ * @return	None.
+ */
+static void J1939_ETPsessionTimeout(void* context)
+{
+	J1939_ETP_session* session = (J1939_ETP_session*)context;
+	J1939_abortReasons abortReason = J1939_REASON_TIMEOUT;
+	J1939_status status = J1939_ERROR_TIMEOUT;
+
+	if((session->type == J1939_ETP_SESSION_RX) && (session->state == J1939_STATE_TP_RX_PTP_DATA) && \
+	   (session->received_packages < session->window_packages))
+	{
+		if(J1939_prepareETPretransmission(session) == J1939_STATUS_CTS)
+		{
+			J1939_sendETP_connectionManagement(session, J1939_TP_TYPE_CTS);
+			return;
+		}
+
+		abortReason	= J1939_REASON_RETRANSMIT_LIMIT;
+		status		= J1939_ERROR_MISSING_PACKAGES;
+	}
+
+	J1939_TRACE_ETP_SESSION(session, J1939_TRACE_TIMEOUT, session->state);
+	J1939_sendETP_abort(session->instance, J1939_getETPpeerAddress(session), session->PGN_of_the_multipacket_message, abortReason);
+	J1939_countSessionAbort(session->instance, J1939_GET_STATISTICS_TYPE(session), abortReason, 0U);
+
+	if(session->instance->ETP.callback != NULL) session->instance->ETP.callback(session, status);
+
+	J1939_clearETPstructures(session);
+}
+
+/**
+ * @brief	This function is used to start timing the wait for CTS or for the packages requested by CTS.
+ * @param	session - A pointer to the ETP session.
+ * @return	None.
+ */
+static void J1939_startETPpeerWait(J1939_ETP_session* session)
+{
+	session->wait_time	= J1939_portGetTime();
+	session->waiting	= 1U;
+}
+
+/**
+ * @brief	This function is used to count the CTS round trip when the reply of the peer has come.
+ * @param	session - A pointer to the ETP session.
+ * @return	None.
+ */
+static void J1939_stopETPpeerWait(J1939_ETP_session* session)
+{
+	if(session->waiting == 0U) return;
+
+	J1939_countCTSroundTrip(session->instance, J1939_GET_STATISTICS_TYPE(session), session->wait_time);
+	session->waiting = 0U;
+}
+
+/**
+ * @brief	This function is used to change the state of the session.
+ * @param	session - A pointer to the ETP session.
+ * @param	state - The new state.
+ * @return	None.
+ */
+static void J1939_setETPsessionState(J1939_ETP_session* session, J1939_states state)
+{
+	session->state = state;
+	J1939_TRACE_ETP_SESSION(session, J1939_TRACE_SESSION_STATE, state);
+}
@@ -0,0 +1,148 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Frame_Ring.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the lock-free ring of
+  * 		 received CAN frames
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Frame_Ring.h"
+
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_FRAME_RING_MASK					(J1939_FRAME_RING_SIZE - 1U)
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to reset the ring. It mustn't be called while the producer is active.
+ * @param	ring - A pointer to the ring.
+ * @retval	None.
+ */
+void J1939_initFrameRing(J1939_frameRing* ring)
+{
+	ring->head			= 0U;
+	ring->tail			= 0U;
+	ring->overflows		= 0U;
+	ring->max_pending	= 0U;
+}
+
+/**
+ * @brief 	This function is used to get the next free slot to fill it in place. The slot is published
+ * 			by J1939_commitFrame. Called by the producer only.
+ * @param	ring - A pointer to the ring.
+ * @retval	A pointer to the free slot. NULL if the ring is full.
+ */
+J1939_frame* J1939_getFreeFrameSlot(J1939_frameRing* ring)
+{
+	uint32_t head = ring->head;
+
+	if((head - ring->tail) >= J1939_FRAME_RING_SIZE)
+	{
+		ring->overflows++;
+		return NULL;
+	}
+
+	return &ring->frames[head & J1939_FRAME_RING_MASK];
+}
+
+/**
+ * @brief 	This function is used to publish the slot filled after J1939_getFreeFrameSlot.
+ * 			Called by the producer only.
+ * @param	ring - A pointer to the ring.
+ * @retval	None.
+ */
+void J1939_commitFrame(J1939_frameRing* ring)
+{
+	uint32_t head = ring->head + 1U;
+	uint32_t pending = head - ring->tail;
+
+	if(pending > ring->max_pending) ring->max_pending = pending;
+
+	// The slot must be written before the consumer can see the new head
+	J1939_PORT_MEMORY_BARRIER();
+	ring->head = head;
+}
+
+/**
+ * @brief 	This function is used to copy a received frame into the ring. Called by the producer only.
+ * @param	ring - A pointer to the ring.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @param	timestamp - The reception time.
+ * @retval	1 - the frame is queued, 0 - the ring is full and the frame is dropped.
+ */
+uint8_t J1939_pushFrame(J1939_frameRing* ring, uint32_t canId, const uint8_t* data, uint8_t dlc, uint32_t timestamp)
+{
+	J1939_frame* frame = J1939_getFreeFrameSlot(ring);
+
+	if(frame == NULL) return 0U;
+
+	if(dlc > J1939_FRAME_MAX_DLC) dlc = J1939_FRAME_MAX_DLC;
+
+	frame->can_id		= canId;
+	frame->timestamp	= timestamp;
+	frame->dlc			= dlc;
+	memcpy(frame->data, data, dlc);
+
+	J1939_commitFrame(ring);
+
+	return 1U;
+}
+
+/**
+ * @brief 	This function is used to pass all pending frames to the handler in one pass. The frames are
+ * 			handed over in place and their slots are released together after the last one.
+ * 			Called by the consumer only.
+ * @param	ring - A pointer to the ring.
+ * @param	handler - A function to process a frame.
+ * @param	context - A user pointer passed to the handler.
+ * @param	maxFrames - The maximum number of frames to process. 0 - no limit.
+ * @retval	The number of processed frames.
+ */
+uint32_t J1939_processFrames(J1939_frameRing* ring, J1939_frameHandler handler, void* context, uint32_t maxFrames)
+{
+	uint32_t tail = ring->tail;
+	uint32_t pending = ring->head - tail;
+
+	if(pending == 0U) return 0U;
+
+	if((maxFrames != 0U) && (pending > maxFrames)) pending = maxFrames;
+
+	// The slots must be read after the head that published them
+	J1939_PORT_MEMORY_BARRIER();
+
+	for(uint32_t i = 0U; i < pending; i++)
+	{
+		handler(context, &ring->frames[(tail + i) & J1939_FRAME_RING_MASK]);
+	}
+
+	// The slots must be read before the producer can reuse them
+	J1939_PORT_MEMORY_BARRIER();
+	ring->tail = tail + pending;
+
+	return pending;
+}
+
+/**
+ * @brief 	This function is used to get the number of pending frames.
+ * @param	ring - A pointer to the ring.
+ * @retval	The number of pending frames.
+ */
+uint32_t J1939_getPendingFrames(J1939_frameRing* ring)
+{
+	return ring->head - ring->tail;
+}
@@ -0,0 +1,235 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Instance.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the SAE J1939 stack
+  * 		 instance of a CAN channel
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_PGN_PRIOTITY_POS					(26U)
+#define J1939_PDU_SPECIFIC_POS					(8U)
+#define J1939_PDU2_FORMAT						(240U)
+#define J1939_FRAME_MAX_SIZE					(8U)
+#define J1939_TP_MAX_SIZE						(1785U)
+#define J1939_PGN_MASK							(0x3FFFFUL)
+
+#define J1939_GET_PGN_FORMAT(PGN)				((uint8_t)((PGN) >> 8U))
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to initialize the instance of the CAN channel. All layers are reset,
+ * 			the frames are sent by the port functions. It mustn't be called while the instance is in use.
+ * @param	instance - A pointer to the instance.
+ * @param	channel - The CAN channel.
+ * @retval	None.
+ */
+void J1939_initInstance(J1939_instance* instance, uint8_t channel)
+{
+	memset(instance, 0, sizeof(J1939_instance));
+
+	instance->channel			= channel;
+	instance->send_frame		= J1939_portSendFrame;
+	instance->get_free_tx_slots	= J1939_portGetFreeTxSlots;
+	instance->send_fd_frame		= J1939_portSendFDFrame;
+	instance->data_link			= J1939_DATA_LINK_CLASSIC;
+
+	J1939_initTransportLayer(instance);
+	J1939_initExtendedTransport(instance);
+	J1939_initFDtransport(instance);
+	J1939_initMultiPG(instance);
+	J1939_initPool(instance);
+	J1939_initMessageQueue(instance);
+	J1939_initTxScheduler(instance);
+	J1939_initDiagnostics(instance);
+#if (J1939_TRACE_ENABLE == 1U)
+	J1939_initTrace(&instance->trace);
+#endif
+}
+
+/**
+ * @brief 	This function is used to replace the functions which send the frames of the instance,
+ * 			e.g. to put a TX queue or a trace between the stack and the port.
+ * @param	instance - A pointer to the instance.
+ * @param	sendFrame - A function to queue a frame. NULL - J1939_portSendFrame.
+ * @param	getFreeTxSlots - A function to get the number of free TX slots. NULL - J1939_portGetFreeTxSlots.
+ * @retval	None.
+ */
+void J1939_setTxHooks(J1939_instance* instance, J1939_sendFrameHook sendFrame, J1939_freeTxSlotsHook getFreeTxSlots)
+{
+	instance->send_frame		= (sendFrame != NULL) ? sendFrame : J1939_portSendFrame;
+	instance->get_free_tx_slots	= (getFreeTxSlots != NULL) ? getFreeTxSlots : J1939_portGetFreeTxSlots;
+}
+
+/**
+ * @brief 	This function is used to replace the function which sends the CAN FD frames of the instance.
+ * @param	instance - A pointer to the instance.
+ * @param	sendFDFrame - A function to queue a CAN FD frame. NULL - J1939_portSendFDFrame.
+ * @retval	None.
+ */
+void J1939_setFDTxHook(J1939_instance* instance, J1939_sendFDFrameHook sendFDFrame)
+{
+	instance->send_fd_frame = (sendFDFrame != NULL) ? sendFDFrame : J1939_portSendFDFrame;
+}
+
+/**
+ * @brief 	This function is used to select the data link of the instance. The frames of both data links are
+ * 			received, the multi-PG and FD.TP frames only by an instance with the CAN FD data link.
+ * @param	instance - A pointer to the instance.
+ * @param	dataLink - J1939_DATA_LINK_CLASSIC (by default) or J1939_DATA_LINK_FD.
+ * @retval	None.
+ */
+void J1939_setDataLink(J1939_instance* instance, J1939_dataLinks dataLink)
+{
+	instance->data_link = dataLink;
+
+	// The multi-PG and FD.TP frames are accepted by the filters of the CAN FD data link only
+	J1939_refreshAcceptanceFilters(instance);
+}
+
+/**
+ * @brief 	This function is used to queue a frame of the instance for transmission. If the TX scheduler
+ * 			is enabled, the frame waits in the queue of its priority.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_sendFrame(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	uint8_t status;
+
+	if(instance->tx_scheduler.enabled != 0U)
+	{
+		status = J1939_scheduleFrame(instance, canId, data, dlc);
+	} else
+	{
+		status = instance->send_frame(instance->channel, canId, data, dlc);
+	}
+
+	(status == J1939_PORT_FRAME_QUEUED) ? instance->statistics.frames_sent++ : instance->statistics.frames_not_sent++;
+	J1939_TRACE_FRAME(instance, (status == J1939_PORT_FRAME_QUEUED) ? J1939_TRACE_FRAME_TX : J1939_TRACE_FRAME_NOT_SENT,
+					  canId, data, dlc);
+
+	return status;
+}
+
+/**
+ * @brief 	This function is used to queue a CAN FD frame of the instance for transmission. CAN FD frames
+ * 			don't wait in the TX scheduler, whose entries hold 8 bytes.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	length - The number of data bytes: 0 to 8, 12, 16, 20, 24, 32, 48 or 64.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_sendFDFrame(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t length)
+{
+	uint8_t status = instance->send_fd_frame(instance->channel, canId, data, length);
+
+	(status == J1939_PORT_FRAME_QUEUED) ? instance->statistics.frames_sent++ : instance->statistics.frames_not_sent++;
+	J1939_TRACE_FRAME(instance, (status == J1939_PORT_FRAME_QUEUED) ? J1939_TRACE_FRAME_TX : J1939_TRACE_FRAME_NOT_SENT,
+					  canId, data, length);
+
+	return status;
+}
+
+/**
+ * @brief 	This function is used to send a message by the data link of the instance. Classic: up to 8 bytes
+ * 			in a frame, longer messages by TP (BAM or RTS/CTS). CAN FD: up to J1939_MULTI_PG_MAX_PAYLOAD
+ * 			bytes as a C-PG of a multi-PG frame, longer messages by FD.TP. A multi-packet message isn't
+ * 			copied, it mustn't be changed until its session is closed.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	priority - The priority of a single frame or a C-PG from 0 (the highest) to 7. Multi-packet
+ * 			messages are sent with the priority of TP.
+ * @param	destinationAddress - ECU address to send data to. 255 - broadcast.
+ * @param	data - A pointer to the data.
+ * @param	size - The size of the data.
+ * @retval	J1939_SEND_OK, J1939_SEND_BUSY or J1939_SEND_INVALID.
+ */
+uint8_t J1939_sendPGN(J1939_instance* instance, uint32_t PGN, uint8_t priority, uint8_t destinationAddress, uint8_t* data, uint16_t size)
+{
+	J1939_FDTP_session* FDsession;
+	J1939_TP_session* session;
+	uint32_t canId;
+	uint8_t status;
+
+	if((size == 0U) || (priority > J1939_LOWEST_PRIORITY)) return J1939_SEND_INVALID;
+
+	// The destination of a PDU2 PGN is the global address
+	if(J1939_GET_PGN_FORMAT(PGN) >= J1939_PDU2_FORMAT) destinationAddress = J1939_BROADCAST_ADDRESS;
+
+	if(instance->data_link == J1939_DATA_LINK_FD)
+	{
+		if(size <= J1939_MULTI_PG_MAX_PAYLOAD)
+		{
+			status = J1939_sendCPG(instance, PGN, priority, destinationAddress, data, (uint8_t)size);
+
+			return (status == J1939_MULTI_PG_OK) ? J1939_SEND_OK : (status == J1939_MULTI_PG_BUSY) ? J1939_SEND_BUSY : J1939_SEND_INVALID;
+		}
+
+		if(size > J1939_FD_TP_MAX_MESSAGE_SIZE) return J1939_SEND_INVALID;
+
+		FDsession = J1939_fillFDTPstructures(instance, data, size, PGN, destinationAddress);
+		if(FDsession == NULL) return J1939_SEND_BUSY;
+
+		J1939_sendFDTP_connectionManagement(FDsession, (destinationAddress == J1939_BROADCAST_ADDRESS) ? J1939_TP_TYPE_BAM : J1939_TP_TYPE_RTS);
+
+		return J1939_SEND_OK;
+	}
+
+	if(size <= J1939_FRAME_MAX_SIZE)
+	{
+		canId = ((uint32_t)priority << J1939_PGN_PRIOTITY_POS) | ((PGN & J1939_PGN_MASK) << J1939_PDU_SPECIFIC_POS) | \
+				J1939_getCurrentECUAddress(instance);
+
+		// The PDU specific of PDU1 is the destination address
+		if(J1939_GET_PGN_FORMAT(PGN) < J1939_PDU2_FORMAT)
+		{
+			canId = (canId & ~(0xFFUL << J1939_PDU_SPECIFIC_POS)) | ((uint32_t)destinationAddress << J1939_PDU_SPECIFIC_POS);
+		}
+
+		return (J1939_sendFrame(instance, canId, data, (uint8_t)size) == J1939_PORT_FRAME_QUEUED) ? J1939_SEND_OK : J1939_SEND_BUSY;
+	}
+
+	if(size > J1939_TP_MAX_SIZE) return J1939_SEND_INVALID;
+
+	session = J1939_fillTPstructures(instance, data, size, PGN, destinationAddress);
+	if(session == NULL) return J1939_SEND_BUSY;
+
+	J1939_sendTP_connectionManagement(session, (destinationAddress == J1939_BROADCAST_ADDRESS) ? J1939_TP_TYPE_BAM : J1939_TP_TYPE_RTS);
+
+	return J1939_SEND_OK;
+}
+
+/**
+ * @brief 	This function is used to get the number of frames of the instance that can be queued
+ * 			for transmission without waiting. If the TX scheduler is enabled, it is the number of free
+ * 			entries of its queue left for TP and ETP packages.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of free TX slots.
+ */
+uint8_t J1939_getFreeTxSlots(J1939_instance* instance)
+{
+	if(instance->tx_scheduler.enabled != 0U) return J1939_getFreeTxQueueEntries(instance);
+
+	return instance->get_free_tx_slots(instance->channel);
+}
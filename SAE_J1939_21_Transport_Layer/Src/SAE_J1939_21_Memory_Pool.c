@@ -0,0 +1,187 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Memory_Pool.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the fixed-block memory
+  * 		 pool. Each size class keeps its free blocks in a singly linked
+  * 		 list of block numbers, so allocation and freeing take constant time.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_POOL_NO_BLOCK						(0xFFFFU)
+#define J1939_POOL_BLOCK_CLASSES				(J1939_POOL_CLASS_HEAP)
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static void J1939_poolCountAllocation(J1939_poolStatistics* statistics);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to link all blocks of each size class of the instance into the free lists.
+ * 			It is called by J1939_initInstance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initPool(J1939_instance* instance)
+{
+	J1939_memoryPool* pool = &instance->pool;
+
+	pool->classes[J1939_POOL_CLASS_SMALL]	= (J1939_poolClass){pool->small_blocks,		pool->small_next_free,	0U, {J1939_POOL_SMALL_BLOCK_SIZE,	J1939_POOL_SMALL_BLOCKS,	0U, 0U, 0U, 0U}};
+	pool->classes[J1939_POOL_CLASS_MEDIUM]	= (J1939_poolClass){pool->medium_blocks,	pool->medium_next_free,	0U, {J1939_POOL_MEDIUM_BLOCK_SIZE,	J1939_POOL_MEDIUM_BLOCKS,	0U, 0U, 0U, 0U}};
+	pool->classes[J1939_POOL_CLASS_LARGE]	= (J1939_poolClass){pool->large_blocks,		pool->large_next_free,	0U, {J1939_POOL_LARGE_BLOCK_SIZE,	J1939_POOL_LARGE_BLOCKS,	0U, 0U, 0U, 0U}};
+	pool->classes[J1939_POOL_CLASS_HEAP]	= (J1939_poolClass){NULL,					NULL,					0U, {0U,							0U,							0U, 0U, 0U, 0U}};
+
+	for(uint8_t i = 0U; i < J1939_POOL_BLOCK_CLASSES; i++)
+	{
+		J1939_poolClass* poolClass = &pool->classes[i];
+		uint16_t numberOfBlocks = poolClass->statistics.number_of_blocks;
+
+		for(uint16_t block = 0U; block < numberOfBlocks; block++)
+		{
+			poolClass->next_free[block] = ((block + 1U) < numberOfBlocks) ? (block + 1U) : J1939_POOL_NO_BLOCK;
+		}
+
+		poolClass->free_head = (numberOfBlocks > 0U) ? 0U : J1939_POOL_NO_BLOCK;
+	}
+}
+
+/**
+ * @brief 	This function is used to allocate a block of the smallest size class that fits the requested
+ * 			size. If the class is exhausted, larger classes and then the heap (if enabled) are used.
+ * @param	instance - A pointer to the instance.
+ * @param	size - The requested size in bytes.
+ * @retval	A pointer to the allocated block. NULL if there is no free block.
+ */
+void* J1939_poolAllocate(J1939_instance* instance, uint16_t size)
+{
+	J1939_poolClass* poolClasses = instance->pool.classes;
+	void* block = NULL;
+
+	for(uint8_t i = 0U; i < J1939_POOL_BLOCK_CLASSES; i++)
+	{
+		J1939_poolClass* poolClass = &poolClasses[i];
+
+		if(size > poolClass->statistics.block_size) continue;
+
+		if(poolClass->free_head == J1939_POOL_NO_BLOCK)
+		{
+			poolClass->statistics.failures++;
+			continue;
+		}
+
+		// Take the first free block
+		block = &poolClass->blocks[(uint32_t)poolClass->free_head * poolClass->statistics.block_size];
+		poolClass->free_head = poolClass->next_free[poolClass->free_head];
+
+		J1939_poolCountAllocation(&poolClass->statistics);
+		return block;
+	}
+
+#if (J1939_POOL_USE_HEAP_FALLBACK == 1U)
+	block = J1939_portAllocate(size);
+
+	(block == NULL) ? (poolClasses[J1939_POOL_CLASS_HEAP].statistics.failures++) : \
+					  (J1939_poolCountAllocation(&poolClasses[J1939_POOL_CLASS_HEAP].statistics));
+#endif
+
+	return block;
+}
+
+/**
+ * @brief 	This function is used to return a block to the pool.
+ * @param	instance - A pointer to the instance which allocated the block.
+ * @param	block - A pointer to the block allocated by J1939_poolAllocate. NULL is ignored.
+ * @retval	None.
+ */
+void J1939_poolFree(J1939_instance* instance, void* block)
+{
+	J1939_poolClass* poolClasses = instance->pool.classes;
+	uint8_t* address = (uint8_t*)block;
+
+	if(block == NULL) return;
+
+	for(uint8_t i = 0U; i < J1939_POOL_BLOCK_CLASSES; i++)
+	{
+		J1939_poolClass* poolClass = &poolClasses[i];
+		uint32_t classSize = (uint32_t)poolClass->statistics.number_of_blocks * poolClass->statistics.block_size;
+
+		if((address >= poolClass->blocks) && (address < (poolClass->blocks + classSize)))
+		{
+			uint16_t blockNumber = (uint16_t)((uint32_t)(address - poolClass->blocks) / poolClass->statistics.block_size);
+
+			// Put the block in front of the free list
+			poolClass->next_free[blockNumber]	= poolClass->free_head;
+			poolClass->free_head				= blockNumber;
+			poolClass->statistics.used_blocks--;
+			return;
+		}
+	}
+
+#if (J1939_POOL_USE_HEAP_FALLBACK == 1U)
+	J1939_portFree(block);
+	poolClasses[J1939_POOL_CLASS_HEAP].statistics.used_blocks--;
+#endif
+}
+
+/**
+ * @brief 	This function is used to get the statistics of a size class.
+ * @param	instance - A pointer to the instance.
+ * @param	poolClass - The size class.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getPoolStatistics(J1939_instance* instance, J1939_poolClasses poolClass, J1939_poolStatistics* statistics)
+{
+	*statistics = instance->pool.classes[poolClass].statistics;
+}
+
+/**
+ * @brief 	This function is used to reset the high-water marks and the counters of all size classes.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetPoolStatistics(J1939_instance* instance)
+{
+	for(uint8_t i = 0U; i < J1939_POOL_CLASSES; i++)
+	{
+		J1939_poolStatistics* statistics = &instance->pool.classes[i].statistics;
+
+		statistics->max_used_blocks	= statistics->used_blocks;
+		statistics->allocations		= 0U;
+		statistics->failures		= 0U;
+	}
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to update the statistics after a successful allocation.
+ * @param	statistics - A pointer to the statistics of the size class.
+ * @retval	None.
+ */
+static void J1939_poolCountAllocation(J1939_poolStatistics* statistics)
+{
+	statistics->allocations++;
+
+	if(++statistics->used_blocks > statistics->max_used_blocks)
+	{
+		statistics->max_used_blocks = statistics->used_blocks;
+	}
+}
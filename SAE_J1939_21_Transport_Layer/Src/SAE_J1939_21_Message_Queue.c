@@ -0,0 +1,235 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Message_Queue.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the queue of completed
+  * 		 multi-packet messages. The buffers are handed over, not copied:
+  * 		 the pool is touched only by the task of the instance, the buffers
+  * 		 released by the consumer wait in a second ring until it reclaims
+  * 		 them.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_MESSAGE_QUEUE_MASK				(J1939_MESSAGE_QUEUE_SIZE - 1U)
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to reset the queue. It is called by J1939_initInstance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initMessageQueue(J1939_instance* instance)
+{
+	memset(&instance->message_queue, 0, sizeof(J1939_messageQueue));
+}
+
+/**
+ * @brief 	This function is used to hand the messages completed by the dispatcher to the queue after their
+ * 			handlers. A message is dropped while depth messages are queued or held by the consumer.
+ * 			It must be called by the task of the instance.
+ * @param	instance - A pointer to the instance.
+ * @param	depth - The most messages queued and held, up to J1939_MESSAGE_QUEUE_SIZE. 0 - disable the queue,
+ * 			the messages are freed after their handlers.
+ * @retval	None.
+ */
+void J1939_enableMessageQueue(J1939_instance* instance, uint8_t depth)
+{
+	instance->message_queue.depth = (depth > J1939_MESSAGE_QUEUE_SIZE) ? J1939_MESSAGE_QUEUE_SIZE : depth;
+}
+
+/**
+ * @brief 	This function is used to hand a completed message with its buffer allocated from the pool to the queue.
+ * 			Called by the task of the instance only.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN of the message.
+ * @param	sourceAddress - The originator.
+ * @param	destinationAddress - The recipient.
+ * @param	data - The buffer allocated by J1939_poolAllocate. It is owned by the queue if J1939_QUEUE_OK is returned.
+ * @param	size - The message size.
+ * @retval	J1939_QUEUE_OK, J1939_QUEUE_FULL or J1939_QUEUE_INVALID.
+ */
+uint8_t J1939_queueMessage(J1939_instance* instance, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+						   uint8_t* data, uint16_t size)
+{
+	J1939_messageQueue* queue = &instance->message_queue;
+	J1939_receivedMessage* message;
+	uint32_t head = queue->head;
+	uint32_t pending;
+
+	if((queue->depth == 0U) || (data == NULL)) return J1939_QUEUE_INVALID;
+
+	J1939_reclaimMessages(instance);
+
+	// A message held by the consumer keeps its slot until its buffer is reclaimed
+	pending = head - queue->reclaimed;
+	if(pending >= queue->depth)
+	{
+		queue->statistics.dropped++;
+		return J1939_QUEUE_FULL;
+	}
+
+	message = &queue->messages[head & J1939_MESSAGE_QUEUE_MASK];
+	message->PGN					= PGN;
+	message->time					= J1939_portGetTime();
+	message->data					= data;
+	message->size					= size;
+	message->source_address			= sourceAddress;
+	message->destination_address	= destinationAddress;
+
+	queue->statistics.queued++;
+	if((pending + 1U) > queue->statistics.max_pending) queue->statistics.max_pending = pending + 1U;
+
+	// The slot must be written before the consumer can see the new head
+	J1939_PORT_MEMORY_BARRIER();
+	queue->head = head + 1U;
+
+	return J1939_QUEUE_OK;
+}
+
+/**
+ * @brief 	This function is used to hand the message of a TP session which has returned J1939_STATUS_DATA_FINISHED
+ * 			to the queue. The buffer is taken from the session, so it can be closed at once.
+ * 			Called by the task of the instance only.
+ * @param	session - A pointer to the TP session.
+ * @retval	J1939_QUEUE_OK, J1939_QUEUE_FULL or J1939_QUEUE_INVALID. The session keeps the buffer if not J1939_QUEUE_OK.
+ */
+uint8_t J1939_queueReceivedMessage(J1939_TP_session* session)
+{
+	J1939_TP_DT* dataTransfer = &session->dataTransfer;
+	uint8_t status;
+
+	if(dataTransfer->memory_allocated == 0U) return J1939_QUEUE_INVALID;
+
+	status = J1939_queueMessage(session->instance, session->connectManagement.PGN_of_the_multipacket_message,
+								session->source_address, session->destination_address,
+								dataTransfer->data, session->connectManagement.message_size);
+
+	if(status == J1939_QUEUE_OK)
+	{
+		dataTransfer->data				= NULL;
+		dataTransfer->memory_allocated	= 0U;
+	}
+
+	return status;
+}
+
+/**
+ * @brief 	This function is used to take the oldest queued message. Called by the consumer only.
+ * @param	instance - A pointer to the instance.
+ * @param	message - A pointer to store the message. Its buffer must be given back by J1939_releaseMessage.
+ * @retval	1 - a message is taken, 0 - the queue is empty.
+ */
+uint8_t J1939_getQueuedMessage(J1939_instance* instance, J1939_receivedMessage* message)
+{
+	J1939_messageQueue* queue = &instance->message_queue;
+	uint32_t tail = queue->tail;
+
+	if(queue->head == tail) return 0U;
+
+	// The slot must be read after the head that published it
+	J1939_PORT_MEMORY_BARRIER();
+	*message = queue->messages[tail & J1939_MESSAGE_QUEUE_MASK];
+
+	J1939_PORT_MEMORY_BARRIER();
+	queue->tail = tail + 1U;
+
+	return 1U;
+}
+
+/**
+ * @brief 	This function is used to give back the buffer of a taken message. The buffer is returned to the pool
+ * 			by the task of the instance. Called by the consumer only.
+ * @param	instance - A pointer to the instance.
+ * @param	message - A pointer to the message taken by J1939_getQueuedMessage.
+ * @retval	None.
+ */
+void J1939_releaseMessage(J1939_instance* instance, const J1939_receivedMessage* message)
+{
+	J1939_messageQueue* queue = &instance->message_queue;
+	uint32_t released = queue->released;
+
+	// Only the taken messages can be released
+	if(released == queue->tail) return;
+
+	queue->released_messages[released & J1939_MESSAGE_QUEUE_MASK] = *message;
+
+	// The slot must be written before the stack can see it
+	J1939_PORT_MEMORY_BARRIER();
+	queue->released = released + 1U;
+}
+
+/**
+ * @brief 	This function is used to return the buffers of the released messages to the pool. It is called before
+ * 			a receive buffer is allocated and a message is queued. Called by the task of the instance only.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_reclaimMessages(J1939_instance* instance)
+{
+	J1939_messageQueue* queue = &instance->message_queue;
+	uint32_t released = queue->released;
+	uint32_t reclaimed = queue->reclaimed;
+
+	if(released == reclaimed) return;
+
+	// The slots must be read after the index that published them
+	J1939_PORT_MEMORY_BARRIER();
+
+	for(; reclaimed != released; reclaimed++)
+	{
+		const J1939_receivedMessage* message = &queue->released_messages[reclaimed & J1939_MESSAGE_QUEUE_MASK];
+
+		J1939_poolFree(instance, message->data);
+		J1939_countBufferUsage(instance, message->size, 0U);
+		J1939_TRACE(instance, J1939_TRACE_BUFFER_RELEASED, 0U, message->size, message->source_address, message->destination_address);
+	}
+
+	queue->reclaimed = reclaimed;
+}
+
+/**
+ * @brief 	This function is used to get the number of queued messages.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of messages waiting for the consumer.
+ */
+uint32_t J1939_getQueuedMessages(J1939_instance* instance)
+{
+	return instance->message_queue.head - instance->message_queue.tail;
+}
+
+/**
+ * @brief 	This function is used to get the message queue statistics.
+ * @param	instance - A pointer to the instance.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getMessageQueueStatistics(J1939_instance* instance, J1939_messageQueueStatistics* statistics)
+{
+	*statistics = instance->message_queue.statistics;
+}
+
+/**
+ * @brief 	This function is used to reset the message queue statistics.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetMessageQueueStatistics(J1939_instance* instance)
+{
+	memset(&instance->message_queue.statistics, 0, sizeof(J1939_messageQueueStatistics));
+}
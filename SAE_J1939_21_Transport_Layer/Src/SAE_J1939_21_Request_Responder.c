@@ -0,0 +1,424 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Request_Responder.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the responder to the
+  * 		 Request PGN. A request only marks its PGN as waiting and arms the
+  * 		 timer of the response window, the responses are sent by the timer,
+  * 		 so the duplicates received in the window cost nothing.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_PGN_PRIOTITY_POS					(26U)
+#define J1939_PDU_SPECIFIC_POS					(8U)
+#define J1939_PDU2_FORMAT						(240U)
+#define J1939_MAX_PGN							(0x3FFFFUL)
+#define J1939_MAX_TP_SIZE						(1785U)
+#define J1939_SINGLE_FRAME_SIZE					(8U)
+
+#define J1939_ACKNOWLEDGEMENT_PGN				(0x00E800UL)
+#define J1939_ACKNOWLEDGEMENT_PRIORITY			(6U)
+#define J1939_CONTROL_BYTE_NACK					(1U)
+
+#define J1939_REQUEST_NO_PGN					(0xFFU)
+#define J1939_IS_PDU1_PGN(PGN)					((((PGN) >> J1939_PDU_SPECIFIC_POS) & 0xFFU) < J1939_PDU2_FORMAT)
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static void J1939_sendResponses(void* context);
+static uint8_t J1939_sendResponse(J1939_instance* instance, J1939_requestedPGN* requestedPGN);
+static uint8_t J1939_sendNACK(J1939_instance* instance, uint32_t PGN, uint8_t requester);
+static uint32_t J1939_getResponseId(J1939_instance* instance, uint32_t PGN, uint8_t priority, uint8_t destinationAddress);
+static uint8_t J1939_findRequestedPGN(J1939_requestResponder* responder, uint32_t PGN);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to register the provider of a requested PGN or to replace it. The response
+ * 			is encoded at the first request and kept until J1939_markResponseDirty is called.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	priority - The priority of the single frame response from 0 to 7.
+ * @param	provider - A function to encode the response.
+ * @param	context - A user pointer passed to the provider.
+ * @retval	J1939_REQUEST_OK, J1939_REQUEST_NO_SLOT if there are no free slots or J1939_REQUEST_INVALID.
+ */
+uint8_t J1939_registerRequestedPGN(J1939_instance* instance, uint32_t PGN, uint8_t priority,
+								   J1939_requestProvider provider, void* context)
+{
+	J1939_requestResponder* responder = &instance->responder;
+	J1939_requestedPGN* requestedPGN;
+	uint8_t slot;
+
+	// The request for the address claimed is answered by the network management layer
+	if((provider == NULL) || (priority > J1939_LOWEST_PRIORITY) || (PGN > J1939_MAX_PGN) || \
+	   (PGN == J1939_ADDRESS_CLAIMED_PGN)) return J1939_REQUEST_INVALID;
+
+	slot = J1939_findRequestedPGN(responder, PGN);
+
+	if(slot == J1939_REQUEST_NO_PGN)
+	{
+		for(slot = 0U; slot < J1939_MAX_REQUESTED_PGNS; slot++)
+		{
+			if(responder->PGNs[slot].provider == NULL) break;
+		}
+
+		if(slot == J1939_MAX_REQUESTED_PGNS) return J1939_REQUEST_NO_SLOT;
+
+		memset(&responder->PGNs[slot], 0, sizeof(J1939_requestedPGN));
+	}
+
+	requestedPGN = &responder->PGNs[slot];
+
+	requestedPGN->PGN		= PGN;
+	requestedPGN->provider	= provider;
+	requestedPGN->context	= context;
+	requestedPGN->priority	= priority;
+	requestedPGN->dirty		= 1U;
+
+	return J1939_REQUEST_OK;
+}
+
+/**
+ * @brief 	This function is used to stop answering the requests for the PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @retval	None.
+ */
+void J1939_unregisterRequestedPGN(J1939_instance* instance, uint32_t PGN)
+{
+	uint8_t slot = J1939_findRequestedPGN(&instance->responder, PGN);
+
+	if(slot != J1939_REQUEST_NO_PGN) instance->responder.PGNs[slot].provider = NULL;
+}
+
+/**
+ * @brief 	This function is used to give the requested PGN a buffer for responses above 8 bytes. They are sent
+ * 			by RTS/CTS to each requester or by BAM straight from the buffer, so it mustn't be changed
+ * 			by the application.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @param	buffer - The buffer. NULL - single frames only.
+ * @param	bufferSize - The size of the buffer, up to 1785 bytes.
+ * @retval	J1939_REQUEST_OK, J1939_REQUEST_INVALID or J1939_REQUEST_BUSY if the buffer is being sent.
+ */
+uint8_t J1939_setResponseBuffer(J1939_instance* instance, uint32_t PGN, uint8_t* buffer, uint16_t bufferSize)
+{
+	uint8_t slot = J1939_findRequestedPGN(&instance->responder, PGN);
+	J1939_requestedPGN* requestedPGN;
+
+	if((slot == J1939_REQUEST_NO_PGN) || (bufferSize > J1939_MAX_TP_SIZE)) return J1939_REQUEST_INVALID;
+
+	requestedPGN = &instance->responder.PGNs[slot];
+
+	if((requestedPGN->buffer != NULL) && (J1939_isTXdataInUse(instance, requestedPGN->buffer) == 1U)) return J1939_REQUEST_BUSY;
+
+	requestedPGN->buffer		= buffer;
+	requestedPGN->buffer_size	= (buffer != NULL) ? bufferSize : 0U;
+	requestedPGN->dirty			= 1U;
+
+	return J1939_REQUEST_OK;
+}
+
+/**
+ * @brief 	This function is used to tell that the data of the PGN has been changed, so its response is encoded
+ * 			again by the provider before it is sent next time.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN.
+ * @retval	None.
+ */
+void J1939_markResponseDirty(J1939_instance* instance, uint32_t PGN)
+{
+	uint8_t slot = J1939_findRequestedPGN(&instance->responder, PGN);
+
+	if(slot != J1939_REQUEST_NO_PGN) instance->responder.PGNs[slot].dirty = 1U;
+}
+
+/**
+ * @brief 	This function is used to read a request. It is called by the dispatcher, the response is sent by
+ * 			J1939_processTimers at the end of the response window.
+ * @param	instance - A pointer to the instance.
+ * @param	sourceAddress - The address of the requester.
+ * @param	destinationAddress - The destination address of the request.
+ * @param	PGN - The requested PGN.
+ * @retval	None.
+ */
+void J1939_readRequest(J1939_instance* instance, uint8_t sourceAddress, uint8_t destinationAddress, uint32_t PGN)
+{
+	J1939_requestResponder* responder = &instance->responder;
+	uint8_t slot = J1939_findRequestedPGN(responder, PGN);
+	J1939_requestedPGN* requestedPGN;
+
+	if(slot == J1939_REQUEST_NO_PGN)
+	{
+#if (J1939_REQUEST_NACK_UNKNOWN == 1U)
+		if((destinationAddress != J1939_BROADCAST_ADDRESS) && (PGN != J1939_ADDRESS_CLAIMED_PGN) && \
+		   (J1939_sendNACK(instance, PGN, sourceAddress) == J1939_PORT_FRAME_QUEUED)) responder->statistics.NACKs++;
+#endif
+		return;
+	}
+
+	requestedPGN = &responder->PGNs[slot];
+	responder->statistics.requests++;
+
+	// The response to the ECU without an address can only be broadcast
+	if((destinationAddress == J1939_BROADCAST_ADDRESS) || (sourceAddress == J1939_NULL_ADDRESS))
+	{
+		if(requestedPGN->global_request == 1U) responder->statistics.coalesced++;
+		requestedPGN->global_request = 1U;
+	} else if((requestedPGN->global_request == 1U) || \
+			  (memchr(requestedPGN->requesters, sourceAddress, requestedPGN->number_of_requesters) != NULL))
+	{
+		responder->statistics.coalesced++;
+	} else if(requestedPGN->number_of_requesters < J1939_REQUEST_MAX_REQUESTERS)
+	{
+		requestedPGN->requesters[requestedPGN->number_of_requesters++] = sourceAddress;
+	} else
+	{
+		requestedPGN->global_request = 1U;
+	}
+
+	if(responder->timer.armed == 0U)
+	{
+		J1939_armTimer(instance, &responder->timer, J1939_REQUEST_RESPONSE_WINDOW, J1939_sendResponses, instance);
+	}
+}
+
+/**
+ * @brief 	This function is used to get the request responder statistics.
+ * @param	instance - A pointer to the instance.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getRequestStatistics(J1939_instance* instance, J1939_requestStatistics* statistics)
+{
+	*statistics = instance->responder.statistics;
+}
+
+/**
+ * @brief 	This function is used to reset the request responder statistics.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetRequestStatistics(J1939_instance* instance)
+{
+	memset(&instance->responder.statistics, 0, sizeof(J1939_requestStatistics));
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is the timer callback: the waiting requests are answered.
+ * @param	context - A pointer to the instance.
+ * @retval	None.
+ */
+static void J1939_sendResponses(void* context)
+{
+	J1939_instance* instance = (J1939_instance*)context;
+	J1939_requestResponder* responder = &instance->responder;
+	uint8_t deferred = 0U;
+
+	for(uint8_t slot = 0U; slot < J1939_MAX_REQUESTED_PGNS; slot++)
+	{
+		J1939_requestedPGN* requestedPGN = &responder->PGNs[slot];
+
+		if((requestedPGN->global_request == 0U) && (requestedPGN->number_of_requesters == 0U)) continue;
+
+		// The requests for an unregistered PGN are dropped
+		if((requestedPGN->provider != NULL) && (J1939_sendResponse(instance, requestedPGN) == 0U))
+		{
+			responder->statistics.deferred++;
+			deferred = 1U;
+			continue;
+		}
+
+		requestedPGN->global_request		= 0U;
+		requestedPGN->number_of_requesters	= 0U;
+	}
+
+	if(deferred == 1U) J1939_armTimer(instance, &responder->timer, J1939_REQUEST_RETRY_TIME, J1939_sendResponses, instance);
+}
+
+/**
+ * @brief 	This function is used to answer the waiting requests for the PGN. The response is encoded if it is
+ * 			dirty. If a request was global, the response is sent once to all ECUs by a single frame or BAM,
+ * 			otherwise it goes to every requester by a single frame or RTS/CTS. The single frame of a PDU2
+ * 			PGN is always sent once.
+ * @param	instance - A pointer to the instance.
+ * @param	requestedPGN - A pointer to the requested PGN.
+ * @retval	1 - all requests are answered, 0 - some are left for the next attempt.
+ */
+static uint8_t J1939_sendResponse(J1939_instance* instance, J1939_requestedPGN* requestedPGN)
+{
+	J1939_requestStatistics* statistics = &instance->responder.statistics;
+	uint8_t* data = (requestedPGN->buffer != NULL) ? requestedPGN->buffer : requestedPGN->data;
+	uint8_t cached = 1U;
+	J1939_TP_session* session;
+
+	// Only the address claim can be sent without an address
+	if(J1939_getCurrentECUAddress(instance) == J1939_NULL_ADDRESS) return 1U;
+
+	if(requestedPGN->dirty == 1U)
+	{
+		uint16_t maxSize = (requestedPGN->buffer != NULL) ? requestedPGN->buffer_size : J1939_SINGLE_FRAME_SIZE;
+
+		// The buffer can't be encoded again while a session sends it
+		if((requestedPGN->buffer != NULL) && (J1939_isTXdataInUse(instance, requestedPGN->buffer) == 1U)) return 0U;
+
+		requestedPGN->size	= requestedPGN->provider(requestedPGN->context, requestedPGN->PGN, data, maxSize);
+		if(requestedPGN->size > maxSize) requestedPGN->size = maxSize;
+		requestedPGN->dirty	= 0U;
+
+		statistics->encodings++;
+		cached = 0U;
+	}
+
+	// The PGN isn't available, only the requests addressed to the ECU are answered
+	if(requestedPGN->size == 0U)
+	{
+		while(requestedPGN->number_of_requesters > 0U)
+		{
+			if(J1939_sendNACK(instance, requestedPGN->PGN, requestedPGN->requesters[requestedPGN->number_of_requesters - 1U]) != \
+			   J1939_PORT_FRAME_QUEUED) return 0U;
+
+			requestedPGN->number_of_requesters--;
+			statistics->NACKs++;
+		}
+
+		return 1U;
+	}
+
+	if(requestedPGN->size <= J1939_SINGLE_FRAME_SIZE)
+	{
+		if((requestedPGN->global_request == 1U) || !J1939_IS_PDU1_PGN(requestedPGN->PGN))
+		{
+			if(J1939_sendFrame(instance, J1939_getResponseId(instance, requestedPGN->PGN, requestedPGN->priority, J1939_BROADCAST_ADDRESS),
+							   data, (uint8_t)requestedPGN->size) != J1939_PORT_FRAME_QUEUED) return 0U;
+
+			statistics->responses++;
+			statistics->cache_hits += cached;
+			return 1U;
+		}
+
+		while(requestedPGN->number_of_requesters > 0U)
+		{
+			uint8_t requester = requestedPGN->requesters[requestedPGN->number_of_requesters - 1U];
+
+			if(J1939_sendFrame(instance, J1939_getResponseId(instance, requestedPGN->PGN, requestedPGN->priority, requester),
+							   data, (uint8_t)requestedPGN->size) != J1939_PORT_FRAME_QUEUED) return 0U;
+
+			requestedPGN->number_of_requesters--;
+			statistics->responses++;
+			statistics->cache_hits += cached;
+			cached = 1U;
+		}
+
+		return 1U;
+	}
+
+	if(requestedPGN->global_request == 1U)
+	{
+		// One broadcast serves all requesters
+		session = J1939_fillTPstructures(instance, data, requestedPGN->size, requestedPGN->PGN, J1939_BROADCAST_ADDRESS);
+		if(session == NULL) return 0U;
+
+		J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_BAM);
+
+		statistics->responses++;
+		statistics->cache_hits += cached;
+		return 1U;
+	}
+
+	// The sessions with different requesters are open at the same time, unlike BAM
+	while(requestedPGN->number_of_requesters > 0U)
+	{
+		uint8_t requester = requestedPGN->requesters[requestedPGN->number_of_requesters - 1U];
+
+		session = J1939_fillTPstructures(instance, data, requestedPGN->size, requestedPGN->PGN, requester);
+		if(session == NULL) return 0U;
+
+		J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_RTS);
+
+		requestedPGN->number_of_requesters--;
+		statistics->responses++;
+		statistics->cache_hits += cached;
+		cached = 1U;
+	}
+
+	return 1U;
+}
+
+/**
+ * @brief 	This function is used to send the negative acknowledgement of a request to all ECUs.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The requested PGN.
+ * @param	requester - The address of the requester.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+static uint8_t J1939_sendNACK(J1939_instance* instance, uint32_t PGN, uint8_t requester)
+{
+	uint8_t data[J1939_SINGLE_FRAME_SIZE];
+
+	data[0] = J1939_CONTROL_BYTE_NACK;
+	data[1] = 0xFFU;								// Group function value
+	data[2] = 0xFFU;
+	data[3] = 0xFFU;
+	data[4] = requester;
+	data[5] = (uint8_t)PGN;
+	data[6] = (uint8_t)(PGN >> 8U);
+	data[7] = (uint8_t)(PGN >> 16U);
+
+	return J1939_sendFrame(instance, J1939_getResponseId(instance, J1939_ACKNOWLEDGEMENT_PGN, J1939_ACKNOWLEDGEMENT_PRIORITY,
+														  J1939_BROADCAST_ADDRESS), data, J1939_SINGLE_FRAME_SIZE);
+}
+
+/**
+ * @brief 	This function is used to make the CAN ID of a response.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN of the response.
+ * @param	priority - The priority.
+ * @param	destinationAddress - The destination address, used by PDU1 PGNs only.
+ * @retval	The CAN ID.
+ */
+static uint32_t J1939_getResponseId(J1939_instance* instance, uint32_t PGN, uint8_t priority, uint8_t destinationAddress)
+{
+	uint32_t canId = ((uint32_t)priority << J1939_PGN_PRIOTITY_POS) | ((PGN & 0x3FF00UL) << J1939_PDU_SPECIFIC_POS);
+
+	canId |= J1939_IS_PDU1_PGN(PGN) ? ((uint32_t)destinationAddress << J1939_PDU_SPECIFIC_POS) : ((PGN & 0xFFU) << J1939_PDU_SPECIFIC_POS);
+
+	return canId | J1939_getCurrentECUAddress(instance);
+}
+
+/**
+ * @brief 	This function is used to find the slot of the requested PGN.
+ * @param	responder - A pointer to the responder.
+ * @param	PGN - The PGN.
+ * @retval	The slot. J1939_REQUEST_NO_PGN if the PGN isn't registered.
+ */
+static uint8_t J1939_findRequestedPGN(J1939_requestResponder* responder, uint32_t PGN)
+{
+	for(uint8_t slot = 0U; slot < J1939_MAX_REQUESTED_PGNS; slot++)
+	{
+		if((responder->PGNs[slot].provider != NULL) && (responder->PGNs[slot].PGN == PGN)) return slot;
+	}
+
+	return J1939_REQUEST_NO_PGN;
+}
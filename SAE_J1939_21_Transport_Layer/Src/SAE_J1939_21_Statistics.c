@@ -0,0 +1,307 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Statistics.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the runtime statistics
+  * 		 of the SAE J1939 stack. The counters are plain fields of the
+  * 		 instance incremented by its task, there are no locks on the
+  * 		 paths of the frames.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_PROPRIETARY_A_PGN					(0x00EF00UL)
+#define J1939_PROPRIETARY_A2_PGN				(0x01EF00UL)
+#define J1939_PROPRIETARY_B_GROUP				(0x00FF00UL)
+#define J1939_PGN_GROUP_MASK					(0x03FF00UL)
+
+// The priority of the published message. It can be redefined in the compiler options.
+#ifndef J1939_STATISTICS_PRIORITY
+#define J1939_STATISTICS_PRIORITY				(6U)
+#endif
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static uint16_t J1939_encodeStatistics(void* context, uint32_t PGN, uint8_t* data, uint16_t maxSize);
+static uint8_t* J1939_putCounter(uint8_t* data, uint32_t counter);
+static void J1939_countTime(uint32_t* histogram, uint32_t startTime);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to copy the statistics of the instance.
+ * @param	instance - A pointer to the instance.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getStatistics(J1939_instance* instance, J1939_statistics* statistics)
+{
+	*statistics = instance->statistics;
+}
+
+/**
+ * @brief 	This function is used to reset the counters and the histograms of the instance. The sessions open now
+ * 			and the allocated buffers are kept. It must be called by the task of the instance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetStatistics(J1939_instance* instance)
+{
+	J1939_statistics* statistics = &instance->statistics;
+	uint8_t active[J1939_STATISTICS_SESSION_TYPES];
+
+	for(uint8_t type = 0U; type < J1939_STATISTICS_SESSION_TYPES; type++) active[type] = statistics->sessions[type].active;
+
+	statistics->frames_received		= 0U;
+	statistics->frames_sent			= 0U;
+	statistics->frames_not_sent		= 0U;
+	statistics->max_buffer_bytes	= statistics->buffer_bytes;
+
+	memset(statistics->sessions, 0, sizeof(statistics->sessions));
+
+	// The high-water marks start from the sessions open now
+	for(uint8_t type = 0U; type < J1939_STATISTICS_SESSION_TYPES; type++)
+	{
+		statistics->sessions[type].active		= active[type];
+		statistics->sessions[type].max_active	= active[type];
+	}
+}
+
+/**
+ * @brief 	This function is used to publish the statistics as a cyclic PGN, by BAM (J1939_STATISTICS_MESSAGE_SIZE).
+ * 			The histograms aren't published.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - Proprietary A (0xEF00) or Proprietary B (0xFF00 to 0xFFFF) PGN.
+ * @param	period - Transmission period, ms. 0 - the publication is stopped.
+ * @retval	J1939_STATISTICS_OK, J1939_STATISTICS_INVALID or J1939_STATISTICS_NO_SLOT if there are no free cyclic PGNs.
+ */
+uint8_t J1939_publishStatistics(J1939_instance* instance, uint32_t PGN, uint32_t period)
+{
+	if((PGN != J1939_PROPRIETARY_A_PGN) && (PGN != J1939_PROPRIETARY_A2_PGN) && \
+	   ((PGN & J1939_PGN_GROUP_MASK) != J1939_PROPRIETARY_B_GROUP)) return J1939_STATISTICS_INVALID;
+
+	if(period == 0U)
+	{
+		J1939_unregisterCyclicPGN(instance, PGN);
+		return J1939_STATISTICS_OK;
+	}
+
+	// The message is encoded into its buffer before each transmission
+	switch(J1939_registerCyclicPGN(instance, PGN, J1939_STATISTICS_PRIORITY, period, J1939_CYCLIC_AUTO_PHASE,
+								   J1939_encodeStatistics, instance))
+	{
+		case J1939_CYCLIC_OK:		break;
+		case J1939_CYCLIC_NO_SLOT:	return J1939_STATISTICS_NO_SLOT;
+		default:					return J1939_STATISTICS_INVALID;
+	}
+
+	// The buffer of the message being sent is kept
+	J1939_setCyclicBuffer(instance, PGN, instance->statistics.message, J1939_STATISTICS_MESSAGE_SIZE);
+
+	return J1939_STATISTICS_OK;
+}
+
+/**
+ * @brief 	This function is used to count an opened session. It is called by the transport layers.
+ * @param	instance - A pointer to the instance.
+ * @param	type - The session type.
+ * @retval	None.
+ */
+void J1939_countSessionOpened(J1939_instance* instance, J1939_statisticsSessionTypes type)
+{
+	J1939_sessionStatistics* statistics = &instance->statistics.sessions[type];
+
+	statistics->opened++;
+	statistics->active++;
+
+	if(statistics->active > statistics->max_active) statistics->max_active = statistics->active;
+}
+
+/**
+ * @brief 	This function is used to count a closed session. It is called by the transport layers.
+ * @param	instance - A pointer to the instance.
+ * @param	type - The session type.
+ * @retval	None.
+ */
+void J1939_countSessionClosed(J1939_instance* instance, J1939_statisticsSessionTypes type)
+{
+	J1939_sessionStatistics* statistics = &instance->statistics.sessions[type];
+
+	if(statistics->active > 0U) statistics->active--;
+}
+
+/**
+ * @brief 	This function is used to count a completely transferred message. It is called by the transport layers.
+ * @param	instance - A pointer to the instance.
+ * @param	type - The session type.
+ * @param	openTime - The time the session was opened, ms.
+ * @retval	None.
+ */
+void J1939_countSessionCompleted(J1939_instance* instance, J1939_statisticsSessionTypes type, uint32_t openTime)
+{
+	J1939_sessionStatistics* statistics = &instance->statistics.sessions[type];
+
+	statistics->completed++;
+	J1939_countTime(statistics->transfer_time, openTime);
+}
+
+/**
+ * @brief 	This function is used to count an aborted session. It is called by the transport layers.
+ * @param	instance - A pointer to the instance.
+ * @param	type - The session type.
+ * @param	reason - The abort reason.
+ * @param	peer - 1 - the abort has been sent by the peer, 0 - by the instance.
+ * @retval	None.
+ */
+void J1939_countSessionAbort(J1939_instance* instance, J1939_statisticsSessionTypes type, uint8_t reason, uint8_t peer)
+{
+	J1939_sessionStatistics* statistics = &instance->statistics.sessions[type];
+	J1939_abortSlots slot;
+
+	switch(reason)
+	{
+		case J1939_REASON_BUSY:						slot = J1939_ABORT_SLOT_BUSY;				break;
+		case J1939_REASON_TIMEOUT:					slot = J1939_ABORT_SLOT_TIMEOUT;			break;
+		case J1939_REASON_RETRANSMIT_LIMIT:			slot = J1939_ABORT_SLOT_RETRANSMIT_LIMIT;	break;
+		case J1939_REASON_TOO_BIG_MESSAGE:			slot = J1939_ABORT_SLOT_TOO_BIG_MESSAGE;	break;
+		case J1939_REASON_MEMORY_ALLOCATION_ERROR:	slot = J1939_ABORT_SLOT_MEMORY_ALLOCATION;	break;
+		default:									slot = J1939_ABORT_SLOT_OTHER;				break;
+	}
+
+	statistics->aborts[slot]++;
+	statistics->peer_aborts += peer;
+}
+
+/**
+ * @brief 	This function is used to count a CTS round trip. It is called by the transport layers.
+ * @param	instance - A pointer to the instance.
+ * @param	type - The session type.
+ * @param	startTime - The time CTS, RTS or the last package of the window was sent, ms.
+ * @retval	None.
+ */
+void J1939_countCTSroundTrip(J1939_instance* instance, J1939_statisticsSessionTypes type, uint32_t startTime)
+{
+	J1939_countTime(instance->statistics.sessions[type].CTS_round_trip, startTime);
+}
+
+/**
+ * @brief 	This function is used to count the allocation or the release of a TP receive buffer.
+ * 			It is called by the transport layer.
+ * @param	instance - A pointer to the instance.
+ * @param	size - The size of the buffer.
+ * @param	allocated - 1 - the buffer has been allocated, 0 - released.
+ * @retval	None.
+ */
+void J1939_countBufferUsage(J1939_instance* instance, uint16_t size, uint8_t allocated)
+{
+	J1939_statistics* statistics = &instance->statistics;
+
+	if(allocated == 1U)
+	{
+		statistics->buffer_bytes += size;
+		if(statistics->buffer_bytes > statistics->max_buffer_bytes) statistics->max_buffer_bytes = statistics->buffer_bytes;
+	} else
+	{
+		statistics->buffer_bytes = (statistics->buffer_bytes > size) ? (statistics->buffer_bytes - size) : 0U;
+	}
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is the provider of the published message: the counters are written in the order
+ * 			described by J1939_STATISTICS_MESSAGE_SIZE.
+ * @param	context - A pointer to the instance.
+ * @param	PGN - The PGN of the message.
+ * @param	data - A pointer to the message buffer.
+ * @param	maxSize - The size of the buffer.
+ * @retval	The message size.
+ */
+static uint16_t J1939_encodeStatistics(void* context, uint32_t PGN, uint8_t* data, uint16_t maxSize)
+{
+	J1939_statistics* statistics = &((J1939_instance*)context)->statistics;
+	uint8_t* position = data;
+
+	(void)PGN;
+
+	if(maxSize < J1939_STATISTICS_MESSAGE_SIZE) return 0U;
+
+	*position++	= J1939_STATISTICS_LAYOUT_VERSION;
+	*position++	= J1939_STATISTICS_SESSION_TYPES;
+	position	= J1939_putCounter(position, statistics->frames_received);
+	position	= J1939_putCounter(position, statistics->frames_sent);
+	position	= J1939_putCounter(position, statistics->frames_not_sent);
+	position	= J1939_putCounter(position, statistics->max_buffer_bytes);
+
+	for(uint8_t type = 0U; type < J1939_STATISTICS_SESSION_TYPES; type++)
+	{
+		J1939_sessionStatistics* sessions = &statistics->sessions[type];
+		uint32_t aborts = 0U;
+
+		for(uint8_t slot = 0U; slot < J1939_ABORT_SLOTS; slot++) aborts += sessions->aborts[slot];
+
+		position	= J1939_putCounter(position, sessions->opened);
+		position	= J1939_putCounter(position, sessions->completed);
+		position	= J1939_putCounter(position, aborts);
+		position	= J1939_putCounter(position, sessions->busy);
+		position	= J1939_putCounter(position, sessions->allocation_failures);
+		position	= J1939_putCounter(position, sessions->retransmitted_packages);
+		*position++	= sessions->max_active;
+	}
+
+	return J1939_STATISTICS_MESSAGE_SIZE;
+}
+
+/**
+ * @brief 	This function is used to write a little-endian counter.
+ * @param	data - A pointer to write the counter to.
+ * @param	counter - The counter.
+ * @retval	A pointer to the byte after the counter.
+ */
+static uint8_t* J1939_putCounter(uint8_t* data, uint32_t counter)
+{
+	data[0] = (uint8_t)counter;
+	data[1] = (uint8_t)(counter >> 8U);
+	data[2] = (uint8_t)(counter >> 16U);
+	data[3] = (uint8_t)(counter >> 24U);
+
+	return &data[4];
+}
+
+/**
+ * @brief 	This function is used to count the time from the start to now in the histogram.
+ * @param	histogram - A pointer to the histogram of J1939_STATISTICS_HISTOGRAM_BINS bins.
+ * @param	startTime - The start time, ms.
+ * @retval	None.
+ */
+static void J1939_countTime(uint32_t* histogram, uint32_t startTime)
+{
+	uint32_t time = J1939_portGetTime() - startTime;
+	uint8_t bin = 0U;
+
+	// The bin is the number of significant bits of the time
+	while((time > 0U) && (bin < (J1939_STATISTICS_HISTOGRAM_BINS - 1U)))
+	{
+		time >>= 1U;
+		bin++;
+	}
+
+	histogram[bin]++;
+}
@@ -0,0 +1,273 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_TX_Scheduler.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the priority-aware TX
+  * 		 scheduler. The queue of each priority is a singly linked list of
+  * 		 entries, the free entries form one more list, so queuing and
+  * 		 sending take constant time.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_TX_NO_ENTRY						(0xFFU)
+#define J1939_PGN_PRIOTITY_POS					(26U)
+#define J1939_GET_PRIORITY(canId)				((uint8_t)(((canId) >> J1939_PGN_PRIOTITY_POS) & 0x07U))
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static void J1939_countSentFrame(J1939_txStatistics* statistics, uint32_t latency);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to link all entries of the TX queue into the free list. It is called
+ * 			by J1939_initInstance, the scheduler is disabled.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initTxScheduler(J1939_instance* instance)
+{
+	J1939_txScheduler* scheduler = &instance->tx_scheduler;
+
+	memset(scheduler, 0, sizeof(J1939_txScheduler));
+
+	for(uint8_t entry = 0U; entry < J1939_TX_QUEUE_SIZE; entry++)
+	{
+		scheduler->entries[entry].next = ((entry + 1U) < J1939_TX_QUEUE_SIZE) ? (entry + 1U) : J1939_TX_NO_ENTRY;
+	}
+
+	for(uint8_t priority = 0U; priority < J1939_NUMBER_OF_PRIORITIES; priority++)
+	{
+		scheduler->heads[priority] = J1939_TX_NO_ENTRY;
+		scheduler->tails[priority] = J1939_TX_NO_ENTRY;
+	}
+
+	scheduler->free_head	= 0U;
+	scheduler->free_entries	= J1939_TX_QUEUE_SIZE;
+}
+
+/**
+ * @brief 	This function is used to start scheduling the frames of the instance. J1939_sendFrame queues
+ * 			the frames by their priority and J1939_getFreeTxSlots reports the free entries of the queue
+ * 			except J1939_TX_RESERVED_ENTRIES, so the TP and ETP bursts leave room for other frames.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_enableTxScheduler(J1939_instance* instance)
+{
+	instance->tx_scheduler.enabled = 1U;
+}
+
+/**
+ * @brief 	This function is used to send the frames of the instance straight to the CAN controller again.
+ * 			The queued frames are still sent by J1939_processTxQueue.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_disableTxScheduler(J1939_instance* instance)
+{
+	instance->tx_scheduler.enabled = 0U;
+}
+
+/**
+ * @brief 	This function is used to queue a frame by the priority of its CAN ID. The frame is passed to
+ * 			the CAN controller at once if it has a free TX mailbox and no frame of the same or a higher
+ * 			priority is waiting.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_scheduleFrame(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	J1939_txScheduler* scheduler = &instance->tx_scheduler;
+	uint8_t priority = J1939_GET_PRIORITY(canId);
+	J1939_txStatistics* statistics = &scheduler->statistics[priority];
+	J1939_txQueueEntry* queueEntry;
+	uint8_t entry;
+
+	// Nothing waits before the frame, it doesn't need to be copied
+	if(((scheduler->pending_priorities & ((2U << priority) - 1U)) == 0U) && (instance->get_free_tx_slots(instance->channel) > 0U))
+	{
+		if(instance->send_frame(instance->channel, canId, data, dlc) == J1939_PORT_FRAME_QUEUED)
+		{
+			J1939_countSentFrame(statistics, 0U);
+			return J1939_PORT_FRAME_QUEUED;
+		}
+	}
+
+	if(scheduler->free_head == J1939_TX_NO_ENTRY)
+	{
+		statistics->dropped++;
+		return J1939_PORT_FRAME_NOT_QUEUED;
+	}
+
+	entry		= scheduler->free_head;
+	queueEntry	= &scheduler->entries[entry];
+
+	scheduler->free_head = queueEntry->next;
+	scheduler->free_entries--;
+
+	if(dlc > sizeof(queueEntry->data)) dlc = sizeof(queueEntry->data);
+
+	queueEntry->can_id		= canId;
+	queueEntry->queued_time	= J1939_portGetTime();
+	queueEntry->dlc			= dlc;
+	queueEntry->next		= J1939_TX_NO_ENTRY;
+	memcpy(queueEntry->data, data, dlc);
+
+	// The frame is appended to the queue of its priority
+	if(scheduler->heads[priority] == J1939_TX_NO_ENTRY)
+	{
+		scheduler->heads[priority] = entry;
+		scheduler->pending_priorities |= (uint8_t)(1U << priority);
+	} else
+	{
+		scheduler->entries[scheduler->tails[priority]].next = entry;
+	}
+
+	scheduler->tails[priority] = entry;
+
+	statistics->queued++;
+	if(statistics->queued > statistics->max_queued) statistics->max_queued = statistics->queued;
+
+	return J1939_PORT_FRAME_QUEUED;
+}
+
+/**
+ * @brief 	This function is used to pass the queued frames to the free TX mailboxes, the highest
+ * 			priority first. It should be called by the task which sends the frames of the instance when
+ * 			a TX mailbox is released, e.g. notified by the TX mailbox empty interrupt, followed by
+ * 			J1939_sendTPpendingPackages to refill the queue.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of frames passed to the CAN controller.
+ */
+uint32_t J1939_processTxQueue(J1939_instance* instance)
+{
+	J1939_txScheduler* scheduler = &instance->tx_scheduler;
+	uint32_t sentFrames = 0U;
+	uint8_t freeSlots;
+
+	if(scheduler->pending_priorities == 0U) return 0U;
+
+	freeSlots = instance->get_free_tx_slots(instance->channel);
+
+	while((freeSlots > 0U) && (scheduler->pending_priorities != 0U))
+	{
+		uint8_t priority = 0U;
+		uint8_t entry;
+		J1939_txQueueEntry* queueEntry;
+
+		while(((scheduler->pending_priorities >> priority) & 1U) == 0U) priority++;
+
+		entry		= scheduler->heads[priority];
+		queueEntry	= &scheduler->entries[entry];
+
+		if(instance->send_frame(instance->channel, queueEntry->can_id, queueEntry->data, queueEntry->dlc) != J1939_PORT_FRAME_QUEUED) break;
+
+		J1939_countSentFrame(&scheduler->statistics[priority], J1939_portGetTime() - queueEntry->queued_time);
+		scheduler->statistics[priority].queued--;
+
+		// The entry goes back to the free list
+		scheduler->heads[priority] = queueEntry->next;
+		if(scheduler->heads[priority] == J1939_TX_NO_ENTRY)
+		{
+			scheduler->tails[priority] = J1939_TX_NO_ENTRY;
+			scheduler->pending_priorities &= (uint8_t)~(1U << priority);
+		}
+
+		queueEntry->next		= scheduler->free_head;
+		scheduler->free_head	= entry;
+		scheduler->free_entries++;
+
+		freeSlots--;
+		sentFrames++;
+	}
+
+	return sentFrames;
+}
+
+/**
+ * @brief 	This function is used to get the number of entries of the TX queue which can be used by
+ * 			TP and ETP packages.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of free entries.
+ */
+uint8_t J1939_getFreeTxQueueEntries(J1939_instance* instance)
+{
+	uint8_t freeEntries = instance->tx_scheduler.free_entries;
+
+	return (freeEntries > J1939_TX_RESERVED_ENTRIES) ? (uint8_t)(freeEntries - J1939_TX_RESERVED_ENTRIES) : 0U;
+}
+
+/**
+ * @brief 	This function is used to get the statistics of a priority.
+ * @param	instance - A pointer to the instance.
+ * @param	priority - The priority from 0 to 7.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getTxStatistics(J1939_instance* instance, uint8_t priority, J1939_txStatistics* statistics)
+{
+	if(priority >= J1939_NUMBER_OF_PRIORITIES)
+	{
+		memset(statistics, 0, sizeof(J1939_txStatistics));
+		return;
+	}
+
+	*statistics = instance->tx_scheduler.statistics[priority];
+}
+
+/**
+ * @brief 	This function is used to reset the statistics of all priorities. The high-water marks are
+ * 			set to the frames waiting now.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetTxStatistics(J1939_instance* instance)
+{
+	for(uint8_t priority = 0U; priority < J1939_NUMBER_OF_PRIORITIES; priority++)
+	{
+		J1939_txStatistics* statistics = &instance->tx_scheduler.statistics[priority];
+		uint8_t queued = statistics->queued;
+
+		memset(statistics, 0, sizeof(J1939_txStatistics));
+
+		statistics->queued		= queued;
+		statistics->max_queued	= queued;
+	}
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to count a frame passed to the CAN controller.
+ * @param	statistics - A pointer to the statistics of the priority.
+ * @param	latency - The time from queuing to the controller, ms.
+ * @retval	None.
+ */
+static void J1939_countSentFrame(J1939_txStatistics* statistics, uint32_t latency)
+{
+	statistics->frames++;
+	statistics->total_latency += latency;
+	if(latency > statistics->max_latency) statistics->max_latency = latency;
+}
@@ -0,0 +1,246 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Timer_Wheel.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the hashed timer wheel.
+  * 		 A timer is linked into the slot of its deadline tick, so arming
+  * 		 and cancelling take constant time. Timers due after more than one
+  * 		 revolution stay in their slot until their deadline is reached.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_TIMER_WHEEL_MASK					(J1939_TIMER_WHEEL_SLOTS - 1U)
+#define J1939_TIMER_IS_DUE(deadline, now)		((int32_t)((deadline) - (now)) <= 0)
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static void J1939_advanceWheel(J1939_timerWheel* timerWheel, uint32_t now);
+static void J1939_unlinkTimer(J1939_timerWheel* timerWheel, J1939_timer* timer);
+static uint32_t J1939_findNextDeadline(J1939_timerWheel* timerWheel);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to start or restart the timer.
+ * @param	instance - A pointer to the instance whose wheel holds the timer.
+ * @param	timer - A pointer to the timer.
+ * @param	timeout - The time to expiration, ms.
+ * @param	callback - A function called on expiration.
+ * @param	context - A user pointer passed to the callback.
+ * @retval	None.
+ */
+void J1939_armTimer(J1939_instance* instance, J1939_timer* timer, uint32_t timeout, J1939_timerCallback callback, void* context)
+{
+	J1939_timerWheel* timerWheel = &instance->timer_wheel;
+	uint32_t now = J1939_portGetTime();
+	uint32_t tick;
+	J1939_timer** slot;
+
+	if(timer->armed == 1U) J1939_unlinkTimer(timerWheel, timer);
+
+	J1939_advanceWheel(timerWheel, now);
+
+	timer->deadline	= now + timeout;
+	timer->callback	= callback;
+	timer->context	= context;
+	timer->armed	= 1U;
+
+	// A deadline in an already processed tick goes to the next processed slot
+	tick = timerWheel->now_tick + (((now - timerWheel->tick_time) + timeout) / J1939_TIMER_WHEEL_RESOLUTION);
+	if((int32_t)(tick - timerWheel->current_tick) < 0) tick = timerWheel->current_tick;
+
+	timer->slot = (uint16_t)(tick & J1939_TIMER_WHEEL_MASK);
+	slot = &timerWheel->slots[timer->slot];
+
+	timer->prev = NULL;
+	timer->next = *slot;
+	if(*slot != NULL) (*slot)->prev = timer;
+	*slot = timer;
+
+	if(timerWheel->armed_timers++ == 0U)
+	{
+		timerWheel->next_deadline		= timer->deadline;
+		timerWheel->next_deadline_valid	= 1U;
+	} else if((timerWheel->next_deadline_valid == 1U) && !J1939_TIMER_IS_DUE(timerWheel->next_deadline, timer->deadline))
+	{
+		timerWheel->next_deadline = timer->deadline;
+	}
+}
+
+/**
+ * @brief 	This function is used to stop the timer. Stopping a stopped timer has no effect.
+ * @param	instance - A pointer to the instance whose wheel holds the timer.
+ * @param	timer - A pointer to the timer.
+ * @retval	None.
+ */
+void J1939_cancelTimer(J1939_instance* instance, J1939_timer* timer)
+{
+	if(timer->armed == 1U) J1939_unlinkTimer(&instance->timer_wheel, timer);
+}
+
+/**
+ * @brief 	This function is used to call the callbacks of the expired timers. It is the single tick
+ * 			function of the instance and is called from the task which services it.
+ * @param	instance - A pointer to the instance.
+ * @retval	The time until the next deadline, ms. J1939_TIMER_NO_DEADLINE if no timer is armed,
+ * 			so the task can sleep until the next frame.
+ */
+uint32_t J1939_processTimers(J1939_instance* instance)
+{
+	J1939_timerWheel* timerWheel = &instance->timer_wheel;
+	uint32_t now = J1939_portGetTime();
+	uint32_t nowTick;
+	uint32_t steps;
+	J1939_timer* expired = NULL;
+
+	J1939_advanceWheel(timerWheel, now);
+	nowTick = timerWheel->now_tick;
+
+	steps = ((int32_t)(nowTick - timerWheel->current_tick) >= 0) ? (nowTick - timerWheel->current_tick + 1U) : 0U;
+	if(steps > J1939_TIMER_WHEEL_SLOTS) steps = J1939_TIMER_WHEEL_SLOTS;
+
+	// Collect the expired timers first, so the callbacks can arm and cancel timers freely
+	for(uint32_t i = 0U; i < steps; i++)
+	{
+		J1939_timer* timer = timerWheel->slots[(timerWheel->current_tick + i) & J1939_TIMER_WHEEL_MASK];
+
+		while(timer != NULL)
+		{
+			J1939_timer* next = timer->next;
+
+			if(J1939_TIMER_IS_DUE(timer->deadline, now))
+			{
+				J1939_unlinkTimer(timerWheel, timer);
+				timer->next = expired;
+				expired = timer;
+			}
+
+			timer = next;
+		}
+	}
+
+	// The current tick is processed again by the next call, its timers can be due later in the tick
+	if(steps > 0U) timerWheel->current_tick = nowTick;
+
+	while(expired != NULL)
+	{
+		J1939_timer* timer = expired;
+
+		expired = timer->next;
+		timer->next = NULL;
+		timer->callback(timer->context);
+	}
+
+	if(timerWheel->armed_timers == 0U) return J1939_TIMER_NO_DEADLINE;
+
+	if(timerWheel->next_deadline_valid == 0U)
+	{
+		timerWheel->next_deadline		= J1939_findNextDeadline(timerWheel);
+		timerWheel->next_deadline_valid	= 1U;
+	}
+
+	now = J1939_portGetTime();
+
+	return J1939_TIMER_IS_DUE(timerWheel->next_deadline, now) ? 0U : (timerWheel->next_deadline - now);
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to count the ticks passed since the last call. The ticks are counted
+ * 			from the elapsed time, so they go on when the platform time wraps. The wheel is bound
+ * 			to the platform time on the first use.
+ * @param	timerWheel - A pointer to the wheel.
+ * @param	now - The current time, ms.
+ * @retval	None.
+ */
+static void J1939_advanceWheel(J1939_timerWheel* timerWheel, uint32_t now)
+{
+	uint32_t ticks;
+
+	if(timerWheel->started == 0U)
+	{
+		timerWheel->current_tick	= 0U;
+		timerWheel->now_tick		= 0U;
+		timerWheel->tick_time		= now;
+		timerWheel->started			= 1U;
+		return;
+	}
+
+	// The rest of the elapsed time is carried to the next call
+	ticks = (now - timerWheel->tick_time) / J1939_TIMER_WHEEL_RESOLUTION;
+
+	timerWheel->now_tick	+= ticks;
+	timerWheel->tick_time	+= ticks * J1939_TIMER_WHEEL_RESOLUTION;
+}
+
+/**
+ * @brief 	This function is used to remove the armed timer from its slot.
+ * @param	timerWheel - A pointer to the wheel.
+ * @param	timer - A pointer to the timer.
+ * @retval	None.
+ */
+static void J1939_unlinkTimer(J1939_timerWheel* timerWheel, J1939_timer* timer)
+{
+	if(timer->prev != NULL)
+	{
+		timer->prev->next = timer->next;
+	} else
+	{
+		timerWheel->slots[timer->slot] = timer->next;
+	}
+
+	if(timer->next != NULL) timer->next->prev = timer->prev;
+
+	timer->next		= NULL;
+	timer->prev		= NULL;
+	timer->armed	= 0U;
+
+	timerWheel->armed_timers--;
+
+	if((timerWheel->next_deadline_valid == 1U) && (timer->deadline == timerWheel->next_deadline))
+	{
+		timerWheel->next_deadline_valid = 0U;
+	}
+}
+
+/**
+ * @brief 	This function is used to find the earliest deadline of the armed timers.
+ * @param	timerWheel - A pointer to the wheel.
+ * @retval	The earliest deadline, ms.
+ */
+static uint32_t J1939_findNextDeadline(J1939_timerWheel* timerWheel)
+{
+	uint32_t nextDeadline = 0U;
+	uint8_t found = 0U;
+
+	for(uint32_t i = 0U; i < J1939_TIMER_WHEEL_SLOTS; i++)
+	{
+		for(J1939_timer* timer = timerWheel->slots[i]; timer != NULL; timer = timer->next)
+		{
+			if((found == 0U) || J1939_TIMER_IS_DUE(timer->deadline, nextDeadline))
+			{
+				nextDeadline	= timer->deadline;
+				found			= 1U;
+			}
+		}
+	}
+
+	return nextDeadline;
+}
@@ -0,0 +1,98 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_21_Trace.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the binary trace of the
+  * 		 SAE J1939 stack
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+#if (J1939_TRACE_ENABLE == 1U)
+
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_TRACE_MASK						(J1939_TRACE_SIZE - 1U)
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to reset the ring and to start the trace clock.
+ * @param	ring - A pointer to the ring.
+ * @retval	None.
+ */
+void J1939_initTrace(J1939_traceRing* ring)
+{
+	ring->head		= 0U;
+	ring->frequency	= J1939_portStartTraceClock();
+}
+
+/**
+ * @brief 	This function is used to copy the records of the instance into a dump. It can be called
+ * 			by another task while the instance runs: the records overwritten during the copy are dropped.
+ * @param	instance - A pointer to the instance.
+ * @param	buffer - A pointer to the dump, J1939_TRACE_DUMP_SIZE bytes hold the whole ring.
+ * @param	size - The size of the buffer. The latest records fitting in it are copied.
+ * @retval	The size of the dump. 0 - the buffer can't hold the header.
+ */
+uint32_t J1939_dumpTrace(J1939_instance* instance, uint8_t* buffer, uint32_t size)
+{
+	J1939_traceRing* ring = &instance->trace;
+	uint8_t* records = &buffer[sizeof(J1939_traceDumpHeader)];
+	J1939_traceDumpHeader header = {0};
+	uint32_t capacity, head, first, count, slot, part, overwritten;
+
+	if(size < sizeof(J1939_traceDumpHeader)) return 0U;
+
+	capacity = (size - (uint32_t)sizeof(J1939_traceDumpHeader)) / (uint32_t)sizeof(J1939_traceRecord);
+	if(capacity > J1939_TRACE_SIZE) capacity = J1939_TRACE_SIZE;
+
+	head	= ring->head;
+	count	= (head < capacity) ? head : capacity;
+	first	= head - count;
+
+	// The records are copied from the oldest one in up to two parts of the ring
+	slot	= first & J1939_TRACE_MASK;
+	part	= ((J1939_TRACE_SIZE - slot) < count) ? (J1939_TRACE_SIZE - slot) : count;
+	memcpy(records, &ring->records[slot], part * sizeof(J1939_traceRecord));
+	memcpy(&records[part * sizeof(J1939_traceRecord)], ring->records, (count - part) * sizeof(J1939_traceRecord));
+
+	// The records must be read before the head that tells which of them were overwritten meanwhile.
+	// The slot of the record being written is the slot of the record J1939_TRACE_SIZE before it.
+	J1939_PORT_COMPILER_BARRIER();
+	overwritten = ring->head - first;
+
+	if(overwritten >= J1939_TRACE_SIZE)
+	{
+		overwritten -= J1939_TRACE_SIZE - 1U;
+		if(overwritten > count) overwritten = count;
+
+		memmove(records, &records[overwritten * sizeof(J1939_traceRecord)], (count - overwritten) * sizeof(J1939_traceRecord));
+		first += overwritten;
+		count -= overwritten;
+	}
+
+	header.magic		= J1939_TRACE_MAGIC;
+	header.version		= J1939_TRACE_LAYOUT_VERSION;
+	header.record_size	= (uint8_t)sizeof(J1939_traceRecord);
+	header.frequency	= ring->frequency;
+	header.records		= count;
+	header.lost_records	= first;
+	memcpy(buffer, &header, sizeof(J1939_traceDumpHeader));
+
+	return (uint32_t)sizeof(J1939_traceDumpHeader) + (count * (uint32_t)sizeof(J1939_traceRecord));
+}
+
+#endif /* J1939_TRACE_ENABLE */
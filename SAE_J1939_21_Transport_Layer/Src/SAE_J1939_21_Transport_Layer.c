@@ -13,30 +13,14 @@
 //---------------------------------------------------------------------------
 // Includes
 //---------------------------------------------------------------------------
-#include "SAE_J1939_21_Transport_Layer.h"
-#include "SAE_J1939_81_Network_Management_Layer.h"
-
-// for NULL and pvPortMalloc function
-#include "projdefs.h"
-#include "FreeRTOSConfig.h"
-#include <stddef.h>
-#include "portable.h"
-
-//---------------------------------------------------------------------------
-// Configuration section
-//---------------------------------------------------------------------------
-#if defined(STM32F429xx)
-	#define CAN_USED							(CAN1)
-#elif defined(STM32F407xx)
-	#define CAN_USED							(CAN2)
-#endif
+#include "SAE_J1939_21_Instance.h"
 
 //---------------------------------------------------------------------------
 // Defines
 //---------------------------------------------------------------------------
 #define J1939_MAX_LENGTH_TP_MODE_PACKAGE		(7U)
-#define J1939_MAX_NUMBER_PACKAGES_IN_CTS		(4U)
-#define J1939_STANDART_NUMBER_PACKAGES_IN_CTS	(2U)
+#define J1939_NO_LIMIT_PACKAGES_IN_CTS			(0xFFU)
+#define J1939_PERCENT							(100U)
 
 #define J1939_PGN_PRIOTITY_POS					(26U)
 #define J1939_PDU_FORMAT_POS					(16U)
@@ -47,111 +31,221 @@
 #define J1939_DP_0								(0U)
 #define J1939_DP_1								(1 << 24U)
 
+#define J1939_MIN_LENGTH_MESSAGE				(9U)
 #define J1939_MAX_LENGTH_MESSAGE				(1785U)
+#define J1939_GET_NUMBER_OF_PACKAGES(size)		(((size) + J1939_MAX_LENGTH_TP_MODE_PACKAGE - 1U) / J1939_MAX_LENGTH_TP_MODE_PACKAGE)
+
+#define J1939_GET_SOURCE_ADDRESS(canId)			((uint8_t)(canId))
+#define J1939_GET_PDU_SPECIFIC(canId)			((uint8_t)((canId) >> J1939_PDU_SPECIFIC_POS))
+
+#define J1939_NO_SESSION						(0U)
+#define J1939_CAN_DLC							(8U)
+
+#define J1939_IS_PACKAGE_RECEIVED(dt, package)	(((dt)->received_packages_map[((package) - 1U) >> 3U] >> (((package) - 1U) & 7U)) & 1U)
+#define J1939_SET_PACKAGE_RECEIVED(dt, package)	((dt)->received_packages_map[((package) - 1U) >> 3U] |= (uint8_t)(1U << (((package) - 1U) & 7U)))
+#define J1939_PADDING_BYTE						(0xFFU)
+
+// Records an event of the session in the trace
+#define J1939_TRACE_SESSION(session, event, detail) \
+		J1939_TRACE((session)->instance, (event), (detail), (session)->connectManagement.PGN_of_the_multipacket_message, \
+					(session)->source_address, (session)->destination_address)
 
 //---------------------------------------------------------------------------
-// Structure definitions
+// Static function prototypes
 //---------------------------------------------------------------------------
-static J1939_TP_CM connectManagement 	= {0};
-static J1939_TP_DT dataTransfer 		= {0};
+static uint8_t J1939_getPeerAddress(J1939_TP_session* session);
+static J1939_statisticsSessionTypes J1939_getStatisticsType(J1939_TP_session* session);
+static void J1939_startPeerWait(J1939_TP_session* session, uint32_t time);
+static void J1939_stopPeerWait(J1939_TP_session* session);
+static void J1939_setSessionState(J1939_TP_session* session, J1939_states state);
+static J1939_TP_session* J1939_getSession(J1939_instance* instance, J1939_TPsessionTypes type, uint8_t peerAddress);
+static J1939_TP_session* J1939_openSession(J1939_instance* instance, J1939_TPsessionTypes type, uint8_t sourceAddress, uint8_t destinationAddress,
+										   uint32_t PGN);
+static J1939_status J1939_readTP_multipacketParameters(J1939_TP_session* session, const uint8_t* data);
+static J1939_TP_sink* J1939_findTPsink(J1939_instance* instance, uint32_t PGN);
+static uint32_t J1939_getDataTransferID(J1939_TP_session* session);
+static uint8_t J1939_getCTSwindow(J1939_TP_session* session);
+static void J1939_adaptCTSwindow(J1939_TP_session* session);
+static uint16_t J1939_findMissingPackage(J1939_TP_session* session);
+static J1939_status J1939_prepareNextWindow(J1939_TP_session* session);
+static void J1939_armSessionTimeout(J1939_TP_session* session, uint32_t timeout);
+static void J1939_sessionTimeout(void* context);
+static void J1939_sendNextBAMpackage(void* context);
+static J1939_status J1939_sendTP_package(J1939_TP_session* session, uint32_t canId);
 
 //---------------------------------------------------------------------------
 // Library Functions
 //---------------------------------------------------------------------------
 
+/**
+ * @brief 	This function is used to bind the session tables of the instance to its sessions.
+ * 			It is called by J1939_initInstance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initTransportLayer(J1939_instance* instance)
+{
+	J1939_transportLayer* TP = &instance->TP;
+
+	TP->priority = J1939_TP_DEFAULT_PRIORITY;
+
+	TP->session_tables[J1939_TP_SESSION_BAM_RX]	= (J1939_TP_sessionTable){TP->bam_rx_sessions,	J1939_MAX_TP_BAM_RX_SESSIONS,	{0}};
+	TP->session_tables[J1939_TP_SESSION_PTP_RX]	= (J1939_TP_sessionTable){TP->ptp_rx_sessions,	J1939_MAX_TP_PTP_RX_SESSIONS,	{0}};
+	TP->session_tables[J1939_TP_SESSION_TX]		= (J1939_TP_sessionTable){TP->tx_sessions,		J1939_MAX_TP_TX_SESSIONS,		{0}};
+
+	for(uint8_t type = 0U; type < J1939_TP_SESSION_TYPES; type++)
+	{
+		J1939_TP_sessionTable* table = &TP->session_tables[type];
+
+		for(uint8_t slot = 0U; slot < table->number_of_sessions; slot++)
+		{
+			table->sessions[slot].type		= (J1939_TPsessionTypes)type;
+			table->sessions[slot].instance	= instance;
+		}
+	}
+}
+
 /**
  * @brief 	This function is used to read transport protocol connection management messages.
+ * 			BAM and RTS messages open a new session, other messages are routed to the already
+ * 			opened session of the sender.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the received message.
  * @param	data - A pointer to the receiving data.
+ * @param	session - A pointer to store the session of the message. NULL if there is no session.
  * @retval	J1939 status.
  */
-J1939_status J1939_readTP_connectionManagement(uint8_t* data)
+J1939_status J1939_readTP_connectionManagement(J1939_instance* instance, uint32_t canId, const uint8_t* data, J1939_TP_session** session)
 {
 	J1939_status status = J1939_NO_STATUS;
-
-	// Read only the control byte
-	connectManagement.control_byte = data[0];
+	J1939_TP_session* currentSession = NULL;
+	uint8_t sourceAddress = J1939_GET_SOURCE_ADDRESS(canId);
+	uint8_t destinationAddress = J1939_GET_PDU_SPECIFIC(canId);
+	uint32_t PGN = (((uint32_t)data[7] << 16U) | ((uint32_t)data[6] << 8U) | data[5]);
 
 	// Check the control byte
-	switch(connectManagement.control_byte)
+	switch(data[0])
 	{
 		case J1939_CONTROL_BYTE_TP_CM_BAM:
-			status = J1939_STATUS_GOT_BAM_MESSAGE;
-
-			if(dataTransfer.memory_allocated == 0)
+			// A new broadcast message of the originator replaces its unfinished one, which is counted as aborted
+			currentSession = J1939_getSession(instance, J1939_TP_SESSION_BAM_RX, sourceAddress);
+			if(currentSession != NULL)
 			{
-				// Read the multi-packet message's parameters
-				connectManagement.message_size 						= ((uint16_t)data[2] << 8U) | data[1];
-				connectManagement.total_number_of_packages 			= data[3];
-				connectManagement.PGN_of_the_multipacket_message 	= (((uint32_t)data[7] << 16U) | \
-																	   ((uint32_t)data[6] << 8U) | data[5]);
+				instance->statistics.sessions[J1939_STATISTICS_TP_BAM_RX].aborts[J1939_ABORT_SLOT_OTHER]++;
+				J1939_freeAllocatedMemory(currentSession);
+				J1939_clearTPstructures(currentSession);
+			}
 
-				if(connectManagement.message_size > J1939_MAX_LENGTH_MESSAGE)
-				{
-					status = J1939_ERROR_TOO_BIG_MESSAGE;
-				} else
-				{
-					// Memory allocation for the message (used from FreeRTOS)
-					dataTransfer.data = (uint8_t*)pvPortMalloc(connectManagement.message_size * sizeof(uint8_t));
+			currentSession = J1939_openSession(instance, J1939_TP_SESSION_BAM_RX, sourceAddress, destinationAddress, PGN);
 
-					// Check memory allocation
-					(dataTransfer.data == NULL) ? (status = J1939_ERROR_MEMORY_ALLOCATION) : (dataTransfer.memory_allocated = 1);
-				}
+			if(currentSession != NULL)
+			{
+				J1939_setSessionState(currentSession, J1939_STATE_TP_RX_BROADCAST);
+				status = J1939_readTP_multipacketParameters(currentSession, data);
+				J1939_armSessionTimeout(currentSession, J1939_MESSAGE_DATA_TIMEOUT);
 			} else
 			{
+				instance->statistics.sessions[J1939_STATISTICS_TP_BAM_RX].busy++;
 				status = J1939_ERROR_BUSY;
 			}
 			break;
 
 		case J1939_CONTROL_BYTE_TP_CM_Abort:
-			status = J1939_STATUS_GOT_ABORT_SESSION;
+			// The abort message can close both the session to the sender and the session from the sender
+			currentSession = J1939_getSession(instance, J1939_TP_SESSION_TX, sourceAddress);
+
+			if((currentSession == NULL) || (currentSession->connectManagement.PGN_of_the_multipacket_message != PGN))
+			{
+				currentSession = J1939_getSession(instance, J1939_TP_SESSION_PTP_RX, sourceAddress);
+			}
+
+			if(currentSession != NULL)
+			{
+				J1939_cancelTimer(instance, &currentSession->timer);
+				J1939_countSessionAbort(instance, J1939_getStatisticsType(currentSession), data[1], 1U);
+				J1939_TRACE_SESSION(currentSession, J1939_TRACE_ABORT_RECEIVED, data[1]);
+				status = J1939_STATUS_GOT_ABORT_SESSION;
+			}
 			break;
 
 		case J1939_CONTROL_BYTE_TP_CM_CTS:
+			currentSession = J1939_getSession(instance, J1939_TP_SESSION_TX, sourceAddress);
 
-			if(connectManagement.CTS_available_message == 1U)
+			if((currentSession != NULL) && (currentSession->connectManagement.CTS_available_message == 1U))
 			{
-				connectManagement.remaining_packages_from_CTS = data[1];
+				J1939_TP_CM* connectManagement = &currentSession->connectManagement;
 
-				if(connectManagement.remaining_packages_from_CTS > connectManagement.total_number_of_packages_in_CTS)
+				J1939_stopPeerWait(currentSession);
+				J1939_TRACE_SESSION(currentSession, J1939_TRACE_CTS_RECEIVED, data[1]);
+
+				// The packages already sent and requested again are counted as retransmitted
+				if((data[2] >= 1U) && (data[2] < connectManagement->next_package))
 				{
-					connectManagement.remaining_packages_from_CTS = connectManagement.total_number_of_packages_in_CTS;
+					uint8_t sentPackages = connectManagement->next_package - data[2];
+
+					instance->statistics.sessions[J1939_STATISTICS_TP_PTP_TX].retransmitted_packages += \
+						(data[1] < sentPackages) ? data[1] : sentPackages;
 				}
 
-				connectManagement.CTS_available_message = 0U;
+				// The peer grants the number of packages and the package to continue from
+				connectManagement->remaining_packages_from_CTS = data[1];
+
+				if(connectManagement->remaining_packages_from_CTS > connectManagement->total_number_of_packages_in_CTS)
+				{
+					connectManagement->remaining_packages_from_CTS = connectManagement->total_number_of_packages_in_CTS;
+				}
+
+				if((data[2] >= 1U) && (data[2] <= connectManagement->total_number_of_packages))
+				{
+					connectManagement->next_package = data[2];
+				}
+
+				// CTS with zero packages holds the connection open, the next CTS is waited
+				if(connectManagement->remaining_packages_from_CTS > 0U)
+				{
+					connectManagement->CTS_available_message = 0U;
+					J1939_setSessionState(currentSession, J1939_STATE_TP_TX_PTP_DATA);
+					J1939_cancelTimer(instance, &currentSession->timer);
+				} else
+				{
+					J1939_armSessionTimeout(currentSession, J1939_MESSAGE_HOLD_TIMEOUT);
+				}
 
 				status = J1939_STATUS_GOT_CTS_MESSAGE;
 			}
 			break;
 
 		case J1939_CONTROL_BYTE_TP_CM_EndOfMsgACK:
-			status = J1939_STATUS_GOT_EOM_MESSAGE;
+			currentSession = J1939_getSession(instance, J1939_TP_SESSION_TX, sourceAddress);
+
+			if(currentSession != NULL)
+			{
+				J1939_cancelTimer(instance, &currentSession->timer);
+				J1939_countSessionCompleted(instance, J1939_STATISTICS_TP_PTP_TX, currentSession->open_time);
+				J1939_TRACE_SESSION(currentSession, J1939_TRACE_SESSION_COMPLETE, J1939_STATISTICS_TP_PTP_TX);
+				status = J1939_STATUS_GOT_EOM_MESSAGE;
+			}
 			break;
 
 		case J1939_CONTROL_BYTE_TP_CM_RTS:
-			status = J1939_STATUS_GOT_RTS_MESSAGE;
-
-			if(dataTransfer.memory_allocated == 0)
+			if(J1939_getSession(instance, J1939_TP_SESSION_PTP_RX, sourceAddress) == NULL)
 			{
-				// Read the multi-packet message's parameters
-				connectManagement.message_size 						= ((uint16_t)data[2] << 8U) | data[1];
-				connectManagement.total_number_of_packages 			= data[3];
-				connectManagement.total_number_of_packages_in_CTS	= data[4];
-				connectManagement.PGN_of_the_multipacket_message 	= (((uint32_t)data[7] << 16U) | \
-																	   ((uint32_t)data[6] << 8U) | data[5]);
-
-				if(connectManagement.message_size > J1939_MAX_LENGTH_MESSAGE)
-				{
-					status = J1939_ERROR_TOO_BIG_MESSAGE;
-				} else
-				{
-					// Memory allocation for the message (used from FreeRTOS)
-					dataTransfer.data = (uint8_t*)pvPortMalloc(connectManagement.message_size * sizeof(uint8_t));
+				currentSession = J1939_openSession(instance, J1939_TP_SESSION_PTP_RX, sourceAddress, destinationAddress, PGN);
+			}
 
-					// Check memory allocation
-					(dataTransfer.data == NULL) ? (status = J1939_ERROR_MEMORY_ALLOCATION) : (dataTransfer.memory_allocated = 1);
-				}
+			if(currentSession != NULL)
+			{
+				// Replies to the RTS message are sent to the originator
+				currentSession->connectManagement.destination_address				= sourceAddress;
+				currentSession->connectManagement.total_number_of_packages_in_CTS	= data[4];
+				currentSession->connectManagement.CTS_window						= J1939_STANDART_NUMBER_PACKAGES_IN_CTS;
+				currentSession->connectManagement.CTS_window_limit					= J1939_RX_MAX_NUMBER_PACKAGES_IN_CTS;
+				J1939_setSessionState(currentSession, J1939_STATE_TP_RX_PTP_CTS);
+				status = J1939_readTP_multipacketParameters(currentSession, data);
+				J1939_armSessionTimeout(currentSession, J1939_MESSAGE_CM_TIMEOUT);
 			} else
 			{
+				instance->statistics.sessions[J1939_STATISTICS_TP_PTP_RX].busy++;
 				status = J1939_ERROR_BUSY;
 			}
 			break;
@@ -160,132 +254,239 @@ J1939_status J1939_readTP_connectionManagement(uint8_t* data)
 			break;
 	}
 
+	*session = currentSession;
+
 	return status;
 }
 
 /**
  * @brief	This function is used to send transport protocol connection management messages.
+ * 			After BAM the data transfer packages are sent by J1939_processTimers with J1939_BAM_PACKAGE_GAP.
+ * @param	session - A pointer to the TP session.
  * @param	type - A type of the transport protocol connection management message.
  * @retval	None.
  */
-void J1939_sendTP_connectionManagement(J1939_TPcmTypes type)
+void J1939_sendTP_connectionManagement(J1939_TP_session* session, J1939_TPcmTypes type)
 {
-	USH_CAN_txHeaderTypeDef txMessage = {0};
-	uint8_t currentECUAddress = J1939_getCurrentECUAddress();
+	J1939_TP_CM* connectManagement = &session->connectManagement;
+	uint8_t currentECUAddress = J1939_getCurrentECUAddress(session->instance);
+	uint32_t canId;
 	uint8_t data[8] = {0};
 
-	// Fill in CAN ID
+	// The abort message isn't bound to the state of the session
 	if(type == J1939_TP_TYPE_ABORT)
 	{
-		txMessage.ExtId = (((uint32_t)7U << J1939_PGN_PRIOTITY_POS) | \
-							(J1939_CONNECTION_MANAGEMENT << J1939_PDU_FORMAT_POS) | \
-							(connectManagement.destination_address_abort << J1939_PDU_SPECIFIC_POS) | currentECUAddress);
-	} else
-	{
-		txMessage.ExtId = (((uint32_t)7U << J1939_PGN_PRIOTITY_POS) | \
-							(J1939_CONNECTION_MANAGEMENT << J1939_PDU_FORMAT_POS) | \
-							(connectManagement.destination_address << J1939_PDU_SPECIFIC_POS) | currentECUAddress);
+		J1939_sendTP_abort(session->instance, connectManagement->destination_address_abort, connectManagement->PGN_of_the_multipacket_message,
+						   connectManagement->abort_reason);
+		J1939_countSessionAbort(session->instance, J1939_getStatisticsType(session), connectManagement->abort_reason, 0U);
+		J1939_TRACE_SESSION(session, J1939_TRACE_ABORT_SENT, connectManagement->abort_reason);
+
+		connectManagement->destination_address_abort 	= 0U;
+		connectManagement->abort_reason 				= 0U;
+		return;
 	}
 
-	txMessage.IDE 	= CAN_ID_EXT;
-	txMessage.RTR 	= CAN_RTR_DATA;
-	txMessage.DLC 	= 8U;
+	// Fill in CAN ID
+	canId = (((uint32_t)session->instance->TP.priority << J1939_PGN_PRIOTITY_POS) | \
+			 (J1939_CONNECTION_MANAGEMENT << J1939_PDU_FORMAT_POS) | \
+			 (connectManagement->destination_address << J1939_PDU_SPECIFIC_POS) | currentECUAddress);
 
 	// Fill in bytes that are the same for all messages
-	data[5] = (uint8_t)connectManagement.PGN_of_the_multipacket_message;
-	data[6] = (uint8_t)(connectManagement.PGN_of_the_multipacket_message >> 8U);
-	data[7] = (uint8_t)(connectManagement.PGN_of_the_multipacket_message >> 16U);
+	data[5] = (uint8_t)connectManagement->PGN_of_the_multipacket_message;
+	data[6] = (uint8_t)(connectManagement->PGN_of_the_multipacket_message >> 8U);
+	data[7] = (uint8_t)(connectManagement->PGN_of_the_multipacket_message >> 16U);
 
 	// Fill in the rest of the bytes according to the message type
 	switch(type)
 	{
 		case J1939_TP_TYPE_BAM:
 			data[0] = J1939_CONTROL_BYTE_TP_CM_BAM;
-			data[1] = (uint8_t)connectManagement.message_size;
-			data[2] = (uint8_t)(connectManagement.message_size >> 8U);
-			data[3] = connectManagement.total_number_of_packages;
+			data[1] = (uint8_t)connectManagement->message_size;
+			data[2] = (uint8_t)(connectManagement->message_size >> 8U);
+			data[3] = connectManagement->total_number_of_packages;
 			data[4] = 0xFFU;
+
+			session->dataTransfer.package_time = J1939_portGetTime();
+			J1939_armTimer(session->instance, &session->timer, J1939_BAM_PACKAGE_GAP, J1939_sendNextBAMpackage, session);
 			break;
 
 		case J1939_TP_TYPE_RTS:
 			data[0] = J1939_CONTROL_BYTE_TP_CM_RTS;
-			data[1] = (uint8_t)connectManagement.message_size;
-			data[2] = (uint8_t)(connectManagement.message_size >> 8U);
-			data[3] = connectManagement.total_number_of_packages;
-			data[4] = connectManagement.total_number_of_packages_in_CTS;
-
-			connectManagement.CTS_available_message = 1U;
+			data[1] = (uint8_t)connectManagement->message_size;
+			data[2] = (uint8_t)(connectManagement->message_size >> 8U);
+			data[3] = connectManagement->total_number_of_packages;
+			data[4] = connectManagement->total_number_of_packages_in_CTS;
+
+			connectManagement->CTS_available_message = 1U;
+			J1939_setSessionState(session, J1939_STATE_TP_TX_PTP_CTS);
+			J1939_startPeerWait(session, J1939_portGetTime());
+			J1939_armSessionTimeout(session, J1939_MESSAGE_CM_TIMEOUT);
 			break;
 
 		case J1939_TP_TYPE_END_OF_MSG:
 			data[0] = J1939_CONTROL_BYTE_TP_CM_EndOfMsgACK;
-			data[1] = (uint8_t)connectManagement.message_size;
-			data[2] = (uint8_t)(connectManagement.message_size >> 8U);
-			data[3] = connectManagement.total_number_of_packages;
+			data[1] = (uint8_t)connectManagement->message_size;
+			data[2] = (uint8_t)(connectManagement->message_size >> 8U);
+			data[3] = connectManagement->total_number_of_packages;
 			data[4] = 0xFFU;
+
+			J1939_setSessionState(session, J1939_STATE_TP_RX_PTP_EOM);
+			J1939_cancelTimer(session->instance, &session->timer);
 			break;
 
 		case J1939_TP_TYPE_CTS:
 			data[0] = J1939_CONTROL_BYTE_TP_CM_CTS;
-			data[1] = ((connectManagement.total_number_of_packages - connectManagement.next_package) >= J1939_STANDART_NUMBER_PACKAGES_IN_CTS) ? \
-					  (J1939_STANDART_NUMBER_PACKAGES_IN_CTS) : ((connectManagement.total_number_of_packages - connectManagement.next_package) + 1U);
-			data[2] = connectManagement.next_package;
+			data[1] = (connectManagement->retransmit_packages > 0U) ? connectManagement->retransmit_packages : \
+																	  J1939_getCTSwindow(session);
+			data[2] = connectManagement->next_package;
 			data[3] = 0xFFU;
 			data[4] = 0xFFU;
 
-			connectManagement.remaining_packages_from_CTS = J1939_STANDART_NUMBER_PACKAGES_IN_CTS;
-			break;
+			// Remember the requested window to place and check the packages
+			connectManagement->window_first					= data[2];
+			connectManagement->window_last					= data[2] + data[1] - 1U;
+			connectManagement->retransmit_packages			= 0U;
+			connectManagement->remaining_packages_from_CTS	= data[1];
+			connectManagement->CTS_time						= J1939_portGetTime();
+			J1939_TRACE_SESSION(session, J1939_TRACE_CTS_SENT, data[1]);
 
-		case J1939_TP_TYPE_ABORT:
-			data[0] = J1939_CONTROL_BYTE_TP_CM_Abort;
-			data[1] = (uint8_t)connectManagement.abort_reason;
-			data[2] = 0xFFU;
-			data[3] = 0xFFU;
-			data[4] = 0xFFU;
-
-			connectManagement.destination_address_abort 	= 0U;
-			connectManagement.abort_reason 					= 0U;
+			if(connectManagement->window_last > connectManagement->last_requested_package)
+			{
+				connectManagement->last_requested_package = connectManagement->window_last;
+			}
+			// Lost packages are requested within T1, before the sender closes the session by T3
+			J1939_setSessionState(session, J1939_STATE_TP_RX_PTP_DATA);
+			J1939_startPeerWait(session, connectManagement->CTS_time);
+			J1939_armSessionTimeout(session, J1939_MESSAGE_DATA_TIMEOUT);
 			break;
 
 		default:
 			break;
 	}
 
-	CAN_addTxMessage(CAN_USED, &txMessage, data);
+	J1939_sendFrame(session->instance, canId, data, J1939_CAN_DLC);
+}
+
+/**
+ * @brief	This function is used to send the connection abort message without an opened session.
+ * @param	instance - A pointer to the instance.
+ * @param	destinationAddress - ECU address to send the abort message to.
+ * @param	PGN - A PGN of the multipacket message.
+ * @param	abortReason - The abort reason.
+ * @retval	None.
+ */
+void J1939_sendTP_abort(J1939_instance* instance, uint8_t destinationAddress, uint32_t PGN, J1939_abortReasons abortReason)
+{
+	uint8_t currentECUAddress = J1939_getCurrentECUAddress(instance);
+	uint32_t canId;
+	uint8_t data[8] = {0};
+
+	// Fill in CAN ID
+	canId = (((uint32_t)instance->TP.priority << J1939_PGN_PRIOTITY_POS) | \
+			 (J1939_CONNECTION_MANAGEMENT << J1939_PDU_FORMAT_POS) | \
+			 ((uint32_t)destinationAddress << J1939_PDU_SPECIFIC_POS) | currentECUAddress);
+
+	data[0] = J1939_CONTROL_BYTE_TP_CM_Abort;
+	data[1] = (uint8_t)abortReason;
+	data[2] = 0xFFU;
+	data[3] = 0xFFU;
+	data[4] = 0xFFU;
+	data[5] = (uint8_t)PGN;
+	data[6] = (uint8_t)(PGN >> 8U);
+	data[7] = (uint8_t)(PGN >> 16U);
+
+	J1939_sendFrame(instance, canId, data, J1939_CAN_DLC);
 }
 
 /**
  * @brief 	This function is used to read transport protocol data transfer messages.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the received message.
  * @param	data - A pointer to the receiving data.
+ * @param	session - A pointer to store the session of the message. NULL if there is no session.
  * @retval	J1939 status.
  */
-J1939_status J1939_readTP_dataTransfer(uint8_t* data)
+J1939_status J1939_readTP_dataTransfer(J1939_instance* instance, uint32_t canId, const uint8_t* data, J1939_TP_session** session)
 {
 	J1939_status status = J1939_STATUS_DATA_CONTINUE;
+	J1939_TP_session* currentSession = NULL;
+	J1939_TP_CM* connectManagement;
+	J1939_TP_DT* dataTransfer;
+	uint8_t sequenceNumber = data[0];
+	uint8_t peerToPeer;
+	uint16_t offset;
+	uint16_t packageBytes;
+
+	// Find the session of the sender
+	currentSession = (J1939_GET_PDU_SPECIFIC(canId) == J1939_BROADCAST_ADDRESS) ? \
+					 J1939_getSession(instance, J1939_TP_SESSION_BAM_RX, J1939_GET_SOURCE_ADDRESS(canId)) : \
+					 J1939_getSession(instance, J1939_TP_SESSION_PTP_RX, J1939_GET_SOURCE_ADDRESS(canId));
+
+	*session = currentSession;
+
+	if((currentSession == NULL) || \
+	   ((currentSession->dataTransfer.memory_allocated == 0U) && (currentSession->dataTransfer.sink == NULL))) return J1939_NO_STATUS;
+
+	connectManagement	= &currentSession->connectManagement;
+	dataTransfer		= &currentSession->dataTransfer;
+	peerToPeer			= (currentSession->type == J1939_TP_SESSION_PTP_RX) ? 1U : 0U;
+
+	// Packages out of the message or out of the requested window are ignored
+	if((sequenceNumber == 0U) || (sequenceNumber > connectManagement->total_number_of_packages)) return status;
+
+	if((peerToPeer == 1U) && ((sequenceNumber < connectManagement->window_first) || \
+							  (sequenceNumber > connectManagement->window_last))) return status;
 
-	// Read the multi-packet message
-	dataTransfer.sequence_number = data[0];
+	dataTransfer->sequence_number = sequenceNumber;
 
-	for(uint8_t i = 1U; i <= J1939_MAX_LENGTH_TP_MODE_PACKAGE; i++)
+	if(peerToPeer == 1U) J1939_stopPeerWait(currentSession);
+
+	// Place the package by its sequence number, a repeated package is written once
+	offset = (uint16_t)(sequenceNumber - 1U) * J1939_MAX_LENGTH_TP_MODE_PACKAGE;
+	if(offset >= connectManagement->message_size) return status;
+
+	if(J1939_IS_PACKAGE_RECEIVED(dataTransfer, sequenceNumber) == 0U)
 	{
-		if(dataTransfer.received_bytes < connectManagement.message_size)
+		packageBytes	= connectManagement->message_size - offset;
+		if(packageBytes > J1939_MAX_LENGTH_TP_MODE_PACKAGE) packageBytes = J1939_MAX_LENGTH_TP_MODE_PACKAGE;
+
+		// A streamed package is passed on from the frame without copying
+		if(dataTransfer->sink != NULL)
+		{
+			dataTransfer->sink(dataTransfer->sink_context, currentSession->source_address, offset, &data[1], (uint8_t)packageBytes);
+		} else
 		{
-			dataTransfer.data[dataTransfer.received_bytes++] = data[i];
+			J1939_portCopy(&dataTransfer->data[offset], &data[1], packageBytes);
 		}
+
+		J1939_SET_PACKAGE_RECEIVED(dataTransfer, sequenceNumber);
+		dataTransfer->received_bytes += packageBytes;
+		dataTransfer->received_packages++;
 	}
 
-	// Check the last package in CTS message
-	if(connectManagement.control_byte != J1939_CONTROL_BYTE_TP_CM_BAM)
+	// Check the last package of the message, of the CTS window or of the broadcast message
+	if(dataTransfer->received_packages == connectManagement->total_number_of_packages)
 	{
-		--connectManagement.remaining_packages_from_CTS;
-
-		if(connectManagement.remaining_packages_from_CTS == 0U) status = J1939_STATUS_CTS;
+		status = J1939_STATUS_DATA_FINISHED;
+		J1939_countSessionCompleted(instance, J1939_getStatisticsType(currentSession), currentSession->open_time);
+		J1939_TRACE_SESSION(currentSession, J1939_TRACE_SESSION_COMPLETE, J1939_getStatisticsType(currentSession));
+	} else if((peerToPeer == 1U) && (sequenceNumber == connectManagement->window_last))
+	{
+		status = J1939_prepareNextWindow(currentSession);
+	} else if((peerToPeer == 0U) && (sequenceNumber == connectManagement->total_number_of_packages))
+	{
+		// Lost packages of the broadcast message can't be requested again
+		status = J1939_ERROR_MISSING_PACKAGES;
+		J1939_countSessionAbort(instance, J1939_STATISTICS_TP_BAM_RX, J1939_REASON_RETRANSMIT_LIMIT, 0U);
 	}
 
-	// Check the last package
-	if(connectManagement.total_number_of_packages == dataTransfer.sequence_number)
+	// The next package is expected within T1, the end of the window is followed by CTS
+	if(status == J1939_STATUS_DATA_CONTINUE)
 	{
-		status = J1939_STATUS_DATA_FINISHED;
+		J1939_armSessionTimeout(currentSession, J1939_MESSAGE_DATA_TIMEOUT);
+	} else if(status != J1939_STATUS_CTS)
+	{
+		J1939_cancelTimer(instance, &currentSession->timer);
 	}
 
 	return status;
@@ -293,158 +494,854 @@ J1939_status J1939_readTP_dataTransfer(uint8_t* data)
 
 /**
  * @brief	This function is used to send the data transfer packages.
+ * @param	session - A pointer to the TP session.
  * @return	J1939 status.
  */
-J1939_status J1939_sendTP_dataTransfer(void)
+J1939_status J1939_sendTP_dataTransfer(J1939_TP_session* session)
 {
-	J1939_status status = J1939_STATUS_DATA_CONTINUE;
-	USH_CAN_txHeaderTypeDef txMessage = {0};
-	uint8_t currentECUAddress = J1939_getCurrentECUAddress();
-	uint8_t data[8] = {0};
+	return J1939_sendTP_package(session, J1939_getDataTransferID(session));
+}
 
-	// Build CAN ID FRAME, where 7 is the default priority
-	txMessage.ExtId		= (((uint32_t)7U << J1939_PGN_PRIOTITY_POS) | J1939_EDP_0 | J1939_DP_0 | \
-		      	  	  	   (J1939_DATA_TRANSFER << J1939_PDU_FORMAT_POS) | \
-						   (connectManagement.destination_address << J1939_PDU_SPECIFIC_POS) | currentECUAddress);
-	txMessage.IDE		= CAN_ID_EXT;
-	txMessage.RTR		= CAN_RTR_DATA;
-	txMessage.DLC		= 8U;
+/**
+ * @brief	This function is used to send as many data transfer packages as allowed in one call: the rest of
+ * 			the CTS window in the peer-to-peer mode or one package per J1939_BAM_PACKAGE_GAP in the broadcast
+ * 			mode, limited by the free TX slots of the CAN controller.
+ * @param	session - A pointer to the TP session.
+ * @param	sentPackages - A pointer to store the number of queued packages.
+ * @return	J1939 status. J1939_STATUS_CTS if the window is over and the next CTS must be waited.
+ */
+J1939_status J1939_sendTP_dataTransferBurst(J1939_TP_session* session, uint8_t* sentPackages)
+{
+	J1939_status status = J1939_STATUS_DATA_CONTINUE;
+	J1939_TP_CM* connectManagement = &session->connectManagement;
+	uint32_t canId = J1939_getDataTransferID(session);
+	uint8_t freeSlots = J1939_getFreeTxSlots(session->instance);
+	uint8_t packages = 0U;
+	uint8_t budget;
 
-	// Fill in the data field of the sent message, taking into account the type of transfer
-	if(connectManagement.destination_address == J1939_BROADCAST_ADDRESS)
+	if(connectManagement->destination_address == J1939_BROADCAST_ADDRESS)
 	{
-		data[0] = ++dataTransfer.sequence_number;
-
-		for(uint8_t i = 1U; i <= J1939_MAX_LENGTH_TP_MODE_PACKAGE; i++)
-		{
-			(dataTransfer.sent_bytes < dataTransfer.data_size) ? (data[i] = dataTransfer.data[dataTransfer.sent_bytes++]) : \
-																		    (data[i] = 0xFFU);
-		}
+		// Packages of the broadcast message are separated by the fixed gap
+		budget = ((J1939_portGetTime() - session->dataTransfer.package_time) >= J1939_BAM_PACKAGE_GAP) ? 1U : 0U;
+	} else if(connectManagement->CTS_available_message == 1U)
+	{
+		// The window is over, the next packages must be requested by CTS
+		*sentPackages = 0U;
+		return J1939_STATUS_CTS;
 	} else
 	{
-		dataTransfer.sequence_number 	= connectManagement.next_package;
-		dataTransfer.sent_bytes 		= (connectManagement.next_package - 1U) * J1939_MAX_LENGTH_TP_MODE_PACKAGE;
+		budget = connectManagement->remaining_packages_from_CTS;
+	}
 
-		data[0] = connectManagement.next_package++;
+	if(budget > freeSlots) budget = freeSlots;
 
-		for(uint8_t i = 1U; i <= J1939_MAX_LENGTH_TP_MODE_PACKAGE; i++)
-		{
-			(dataTransfer.sent_bytes < connectManagement.message_size) ? (data[i] = dataTransfer.data[dataTransfer.sent_bytes++]) : \
-																		 (data[i] = 0xFFU);
-		}
+	while((packages < budget) && (status == J1939_STATUS_DATA_CONTINUE))
+	{
+		status = J1939_sendTP_package(session, canId);
+		packages++;
+	}
 
-		if((--connectManagement.remaining_packages_from_CTS) == 0U)
+	*sentPackages = packages;
+
+	return status;
+}
+
+/**
+ * @brief	This function is used to continue the CTS windows of all TX sessions which have been limited
+ * 			by the free TX slots. It is called when TX slots of the CAN controller are released.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of queued packages.
+ */
+uint16_t J1939_sendTPpendingPackages(J1939_instance* instance)
+{
+	J1939_TP_session* txSessions = instance->TP.tx_sessions;
+	uint16_t packages = 0U;
+	uint8_t sentPackages;
+
+	for(uint8_t slot = 0U; slot < J1939_MAX_TP_TX_SESSIONS; slot++)
+	{
+		if((txSessions[slot].in_use == 1U) && (txSessions[slot].state == J1939_STATE_TP_TX_PTP_DATA))
 		{
-			status = J1939_STATUS_CTS;
-			connectManagement.CTS_available_message = 1U;
+			J1939_sendTP_dataTransferBurst(&txSessions[slot], &sentPackages);
+			packages += sentPackages;
 		}
 	}
 
-	// Send the data package
-	CAN_addTxMessage(CAN_USED, &txMessage, data);
-
-	// Check if the message has been sent
-	if(dataTransfer.sent_bytes >= dataTransfer.data_size) status = J1939_STATUS_DATA_FINISHED;
-
-	return status;
+	return packages;
 }
 
 /**
- * @brief	This function used to fill TP structures.
+ * @brief	This function used to open a TX session and fill its TP structures.
+ * @param	instance - A pointer to the instance.
  * @param 	data - A pointer to the sending data.
  * @param 	dataSize - A size of the sending data.
  * @param 	PGN - A PGN of the multipacket message.
  * @param 	destinationAddress - ECU address to send data to.
- * @retval	None.
+ * @retval	A pointer to the TX session. NULL if a session to the destination address is
+ * 			already opened or there is no free session.
  */
-void J1939_fillTPstructures(uint8_t* data, uint16_t dataSize, uint32_t PGN, uint8_t destinationAddress)
+J1939_TP_session* J1939_fillTPstructures(J1939_instance* instance, uint8_t* data, uint16_t dataSize, uint32_t PGN, uint8_t destinationAddress)
 {
+	J1939_TP_session* session;
+	J1939_TP_CM* connectManagement;
 	uint8_t remainder = dataSize % J1939_MAX_LENGTH_TP_MODE_PACKAGE;
 
+	// Only one session can be opened with the same ECU
+	session = (J1939_getSession(instance, J1939_TP_SESSION_TX, destinationAddress) == NULL) ? \
+			  J1939_openSession(instance, J1939_TP_SESSION_TX, J1939_getCurrentECUAddress(instance), destinationAddress, PGN) : NULL;
+
+	if(session == NULL)
+	{
+		instance->statistics.sessions[(destinationAddress == J1939_BROADCAST_ADDRESS) ? J1939_STATISTICS_TP_BAM_TX : \
+																						J1939_STATISTICS_TP_PTP_TX].busy++;
+		return NULL;
+	}
+
+	connectManagement = &session->connectManagement;
+
 	// Fill the connection management structure
 	if(destinationAddress != J1939_BROADCAST_ADDRESS)
 	{
-		connectManagement.total_number_of_packages_in_CTS  	= J1939_MAX_NUMBER_PACKAGES_IN_CTS;
-		connectManagement.next_package						= 1U;
+		connectManagement->total_number_of_packages_in_CTS  	= J1939_TX_MAX_NUMBER_PACKAGES_IN_CTS;
+		connectManagement->next_package							= 1U;
+		J1939_setSessionState(session, J1939_STATE_TP_TX_PTP_CTS);
+	} else
+	{
+		J1939_setSessionState(session, J1939_STATE_TP_TX_BROADCAST);
 	}
 
-	connectManagement.message_size 						= dataSize;
-	connectManagement.total_number_of_packages			= (remainder > 0U) ? ((dataSize / J1939_MAX_LENGTH_TP_MODE_PACKAGE) + 1) : \
-																			  (dataSize / J1939_MAX_LENGTH_TP_MODE_PACKAGE);
-	connectManagement.PGN_of_the_multipacket_message	= PGN;
-	connectManagement.destination_address				= destinationAddress;
+	connectManagement->message_size 						= dataSize;
+	connectManagement->total_number_of_packages				= (remainder > 0U) ? ((dataSize / J1939_MAX_LENGTH_TP_MODE_PACKAGE) + 1) : \
+																				  (dataSize / J1939_MAX_LENGTH_TP_MODE_PACKAGE);
+	connectManagement->PGN_of_the_multipacket_message		= PGN;
+	connectManagement->destination_address					= destinationAddress;
 
 	// Fill the data transfer structure
-	dataTransfer.data 									= data;
-	dataTransfer.data_size 								= dataSize;
+	session->dataTransfer.data 								= data;
+	session->dataTransfer.data_size 						= dataSize;
+
+	return session;
 }
 
 /**
- * @brief	This function is used to clean TP structures.
+ * @brief	This function is used to clean TP structures and close the session.
+ * @param	session - A pointer to the TP session.
  * @retval	None.
  */
-void J1939_clearTPstructures(void)
+void J1939_clearTPstructures(J1939_TP_session* session)
 {
-	// Clean the connection management structure
-	connectManagement.control_byte						= 0U;
-	connectManagement.message_size						= 0U;
-	connectManagement.total_number_of_packages			= 0U;
-	connectManagement.total_number_of_packages_in_CTS	= 0U;
-	connectManagement.next_package						= 0U;
-	connectManagement.PGN_of_the_multipacket_message	= 0U;
-	connectManagement.destination_address				= 0U;
-	connectManagement.PGN_of_the_multipacket_message	= 0U;
+	J1939_TP_sessionTable* table = &session->instance->TP.session_tables[session->type];
+	uint8_t peerAddress = J1939_getPeerAddress(session);
+	J1939_TPsessionTypes type = session->type;
+	J1939_instance* instance = session->instance;
+
+	J1939_cancelTimer(session->instance, &session->timer);
 
-	// Clean the data transfer structure
-	dataTransfer.sequence_number						= 0U;
-	dataTransfer.data									= 0U;
-	dataTransfer.data_size								= 0U;
-	dataTransfer.sent_bytes								= 0U;
-	dataTransfer.memory_allocated						= 0U;
+	if(session->in_use == 1U)
+	{
+		J1939_countSessionClosed(instance, J1939_getStatisticsType(session));
+		J1939_TRACE_SESSION(session, J1939_TRACE_SESSION_CLOSE, J1939_getStatisticsType(session));
+	}
+
+	// Remove the session from the index if it still belongs to this session
+	if((table->index[peerAddress] != J1939_NO_SESSION) && (&table->sessions[table->index[peerAddress] - 1U] == session))
+	{
+		table->index[peerAddress] = J1939_NO_SESSION;
+	}
+
+	// Clean the connection management and the data transfer structures
+	*session = (J1939_TP_session){0};
+	session->type		= type;
+	session->instance	= instance;
 }
 
 /**
  * @brief 	This function is used to free allocated memory.
+ * @param	session - A pointer to the TP session.
  * @retval	None.
  */
-void J1939_freeAllocatedMemory(void)
+void J1939_freeAllocatedMemory(J1939_TP_session* session)
 {
-	vPortFree(dataTransfer.data);
+	if(session->dataTransfer.memory_allocated == 0U) return;
+
+	J1939_poolFree(session->instance, session->dataTransfer.data);
+	J1939_countBufferUsage(session->instance, session->connectManagement.message_size, 0U);
+	J1939_TRACE(session->instance, J1939_TRACE_BUFFER_RELEASED, 0U, session->connectManagement.message_size,
+				session->source_address, session->destination_address);
+
+	session->dataTransfer.data				= NULL;
+	session->dataTransfer.memory_allocated	= 0U;
 }
 
 /**
  * @brief 	This function is used to set the abort reason.
+ * @param	session - A pointer to the TP session.
  * @param 	abortReason - The abort reason.
  * @param	abortAddress - The address of the ECU to which the ABORT message must be sent.
  * @retval	None.
  */
-void J1939_setAbortReason(J1939_abortReasons abortReason, uint8_t abortAddress)
+void J1939_setAbortReason(J1939_TP_session* session, J1939_abortReasons abortReason, uint8_t abortAddress)
 {
-	connectManagement.abort_reason = abortReason;
+	J1939_TP_CM* connectManagement = &session->connectManagement;
+
+	connectManagement->abort_reason = abortReason;
 
 	if(abortAddress == J1939_USE_CURRENT_DA)
 	{
-		connectManagement.destination_address_abort = connectManagement.destination_address;
+		connectManagement->destination_address_abort = connectManagement->destination_address;
 	} else
 	{
-		connectManagement.destination_address_abort = abortAddress;
+		connectManagement->destination_address_abort = abortAddress;
 	}
 }
 
 /**
- * @brief 	This function is used to get the pointer to received data.
- * @retval	A pointer to received data.
+ * @brief 	This function is used to get the pointer to received data. It is valid until the session is closed,
+ * 			J1939_queueReceivedMessage hands it over to the consumer task instead.
+ * @param	session - A pointer to the TP session.
+ * @retval	A pointer to received data. NULL if the message is streamed to a sink or has been queued.
  */
-uint8_t* J1939_getReceivedMessage(void)
+uint8_t* J1939_getReceivedMessage(J1939_TP_session* session)
 {
-	return dataTransfer.data;
+	return session->dataTransfer.data;
+}
+
+/**
+ * @brief 	This function is used to check whether the data is sent by an open TX session, so it mustn't be changed.
+ * @param	instance - A pointer to the instance.
+ * @param	data - A pointer to the data passed to J1939_fillTPstructures.
+ * @retval	1 - the data is being sent, 0 - isn't.
+ */
+uint8_t J1939_isTXdataInUse(J1939_instance* instance, const uint8_t* data)
+{
+	for(uint8_t i = 0U; i < J1939_MAX_TP_TX_SESSIONS; i++)
+	{
+		J1939_TP_session* session = &instance->TP.tx_sessions[i];
+
+		if((session->in_use == 1U) && (session->dataTransfer.data == data)) return 1U;
+	}
+
+	return 0U;
 }
 
 /**
  * @brief 	This function is used to safe the destination address in the connection management structure.
- * @retval	destinationAddress - The DA from the received messages.
+ * @param	session - A pointer to the TP session.
+ * @param	destinationAddress - The DA from the received messages.
+ * @retval	None.
+ */
+void J1939_setDestinationAddress(J1939_TP_session* session, uint8_t destinationAddress)
+{
+	session->connectManagement.destination_address = destinationAddress;
+}
+
+/**
+ * @brief 	This function is used to find the opened session by the CAN ID of a TP.CM or TP.DT message.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the message.
+ * @param	type - A type of the session.
+ * @retval	A pointer to the session. NULL if there is no session.
+ */
+J1939_TP_session* J1939_findTPsession(J1939_instance* instance, uint32_t canId, J1939_TPsessionTypes type)
+{
+	// Messages of the TX session are sent by the recipient, messages of the RX sessions - by the originator
+	return J1939_getSession(instance, type, J1939_GET_SOURCE_ADDRESS(canId));
+}
+
+/**
+ * @brief 	This function is used to limit the number of packages in one CTS window of the session.
+ * 			For a TX session the limit is sent in RTS and caps the peer's grants, so it must be set before RTS.
+ * 			For a PTP RX session it caps the adaptive window of the CTS messages.
+ * @param	session - A pointer to the TP session.
+ * @param	limit - The maximum number of packages from 1 to 255.
+ * @retval	None.
+ */
+void J1939_setCTSwindowLimit(J1939_TP_session* session, uint8_t limit)
+{
+	if(limit == 0U) limit = 1U;
+
+	if(session->type == J1939_TP_SESSION_TX)
+	{
+		session->connectManagement.total_number_of_packages_in_CTS = limit;
+	} else
+	{
+		session->connectManagement.CTS_window_limit = limit;
+	}
+}
+
+/**
+ * @brief 	This function is used to set the measured bus load. Above J1939_CTS_BUS_LOAD_THRESHOLD the CTS
+ * 			windows are reduced in proportion to the load.
+ * @param	instance - A pointer to the instance.
+ * @param	load - The bus load in percent.
+ * @retval	None.
+ */
+void J1939_setBusLoad(J1939_instance* instance, uint8_t load)
+{
+	instance->TP.bus_load = (load > J1939_PERCENT) ? J1939_PERCENT : load;
+}
+
+/**
+ * @brief 	This function is used to set the priority of the TP.CM, TP.DT, ETP.CM and ETP.DT frames
+ * 			sent by the instance.
+ * @param	instance - A pointer to the instance.
+ * @param	priority - The priority from 0 (the highest) to 7.
+ * @retval	None.
+ */
+void J1939_setTPpriority(J1939_instance* instance, uint8_t priority)
+{
+	instance->TP.priority = (priority > J1939_LOWEST_PRIORITY) ? J1939_LOWEST_PRIORITY : priority;
+}
+
+/**
+ * @brief 	This function is used to set the function called when the library closes a session itself.
+ * @param	instance - A pointer to the instance.
+ * @param	callback - A pointer to the function. NULL - no function.
+ * @retval	None.
+ */
+void J1939_setTPcallback(J1939_instance* instance, J1939_TPcallback callback)
+{
+	instance->TP.callback = callback;
+}
+
+/**
+ * @brief 	This function is used to stream the multi-packet messages of the PGN to a sink. The packages are
+ * 			passed to the sink as they arrive and no buffer is allocated for the message. Sessions opened
+ * 			before the call aren't affected.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - A PGN of the multi-packet messages.
+ * @param	sink - A function to receive the packages. NULL - stop streaming the PGN.
+ * @param	context - A user pointer passed to the sink.
+ * @retval	0 - the sink is registered, 1 - there is no free sink slot (J1939_MAX_TP_SINKS).
+ */
+uint8_t J1939_registerTPsink(J1939_instance* instance, uint32_t PGN, J1939_TPsinkCallback sink, void* context)
+{
+	J1939_TP_sink* slot = J1939_findTPsink(instance, PGN);
+
+	// A new PGN takes a free slot
+	if(slot == NULL)
+	{
+		if(sink == NULL) return 0U;
+
+		for(uint8_t i = 0U; i < J1939_MAX_TP_SINKS; i++)
+		{
+			if(instance->TP.sinks[i].sink == NULL)
+			{
+				slot = &instance->TP.sinks[i];
+				break;
+			}
+		}
+
+		if(slot == NULL) return 1U;
+	}
+
+	slot->PGN		= PGN;
+	slot->sink		= sink;
+	slot->context	= context;
+
+	return 0U;
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to find the streaming sink of the PGN.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - A PGN of the multi-packet message.
+ * @retval	A pointer to the sink. NULL if the PGN isn't streamed.
+ */
+static J1939_TP_sink* J1939_findTPsink(J1939_instance* instance, uint32_t PGN)
+{
+	J1939_TP_sink* sinks = instance->TP.sinks;
+
+	for(uint8_t i = 0U; i < J1939_MAX_TP_SINKS; i++)
+	{
+		if((sinks[i].sink != NULL) && (sinks[i].PGN == PGN)) return &sinks[i];
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief 	This function is used to get the address of the ECU on the other side of the session.
+ * @param	session - A pointer to the TP session.
+ * @retval	The peer address.
+ */
+static uint8_t J1939_getPeerAddress(J1939_TP_session* session)
+{
+	return (session->type == J1939_TP_SESSION_TX) ? session->destination_address : session->source_address;
+}
+
+/**
+ * @brief 	This function is used to get the type of the session counted by the statistics.
+ * @param	session - A pointer to the TP session.
+ * @retval	The statistics session type.
+ */
+static J1939_statisticsSessionTypes J1939_getStatisticsType(J1939_TP_session* session)
+{
+	switch(session->type)
+	{
+		case J1939_TP_SESSION_BAM_RX:	return J1939_STATISTICS_TP_BAM_RX;
+		case J1939_TP_SESSION_PTP_RX:	return J1939_STATISTICS_TP_PTP_RX;
+		default:						return (session->destination_address == J1939_BROADCAST_ADDRESS) ? \
+											   J1939_STATISTICS_TP_BAM_TX : J1939_STATISTICS_TP_PTP_TX;
+	}
+}
+
+/**
+ * @brief 	This function is used to start timing the wait for CTS or for the packages requested by CTS.
+ * @param	session - A pointer to the TP session.
+ * @param	time - The time RTS, CTS or the last package of the window was sent, ms.
+ * @retval	None.
+ */
+static void J1939_startPeerWait(J1939_TP_session* session, uint32_t time)
+{
+	session->wait_time	= time;
+	session->waiting	= 1U;
+}
+
+/**
+ * @brief 	This function is used to count the CTS round trip when the reply of the peer has come.
+ * @param	session - A pointer to the TP session.
+ * @retval	None.
+ */
+static void J1939_stopPeerWait(J1939_TP_session* session)
+{
+	if(session->waiting == 0U) return;
+
+	J1939_countCTSroundTrip(session->instance, J1939_getStatisticsType(session), session->wait_time);
+	session->waiting = 0U;
+}
+
+/**
+ * @brief 	This function is used to change the state of the session.
+ * @param	session - A pointer to the TP session.
+ * @param	state - The new state.
+ * @retval	None.
+ */
+static void J1939_setSessionState(J1939_TP_session* session, J1939_states state)
+{
+	session->state = state;
+	J1939_TRACE_SESSION(session, J1939_TRACE_SESSION_STATE, state);
+}
+
+/**
+ * @brief 	This function is used to get the opened session with the peer.
+ * @param	instance - A pointer to the instance.
+ * @param	type - A type of the session.
+ * @param	peerAddress - The address of the ECU on the other side of the session.
+ * @retval	A pointer to the session. NULL if there is no session.
+ */
+static J1939_TP_session* J1939_getSession(J1939_instance* instance, J1939_TPsessionTypes type, uint8_t peerAddress)
+{
+	J1939_TP_sessionTable* table = &instance->TP.session_tables[type];
+	uint8_t slot = table->index[peerAddress];
+
+	return (slot == J1939_NO_SESSION) ? NULL : &table->sessions[slot - 1U];
+}
+
+/**
+ * @brief 	This function is used to take a free session slot and bind it to the peer.
+ * @param	instance - A pointer to the instance.
+ * @param	type - A type of the session.
+ * @param	sourceAddress - Originator of the multi-packet message.
+ * @param	destinationAddress - Recipient of the multi-packet message.
+ * @param	PGN - A PGN of the multi-packet message.
+ * @retval	A pointer to the session. NULL if there is no free session.
+ */
+static J1939_TP_session* J1939_openSession(J1939_instance* instance, J1939_TPsessionTypes type, uint8_t sourceAddress, uint8_t destinationAddress,
+										   uint32_t PGN)
+{
+	J1939_TP_sessionTable* table = &instance->TP.session_tables[type];
+	J1939_TP_session* session = NULL;
+
+	for(uint8_t slot = 0U; slot < table->number_of_sessions; slot++)
+	{
+		if(table->sessions[slot].in_use == 0U)
+		{
+			session = &table->sessions[slot];
+
+			*session = (J1939_TP_session){0};
+			session->type					= type;
+			session->source_address			= sourceAddress;
+			session->destination_address	= destinationAddress;
+			session->in_use					= 1U;
+			session->instance				= instance;
+			session->open_time				= J1939_portGetTime();
+			session->connectManagement.PGN_of_the_multipacket_message = PGN;
+
+			table->index[J1939_getPeerAddress(session)] = slot + 1U;
+			J1939_countSessionOpened(instance, J1939_getStatisticsType(session));
+			J1939_TRACE_SESSION(session, J1939_TRACE_SESSION_OPEN, J1939_getStatisticsType(session));
+			break;
+		}
+	}
+
+	return session;
+}
+
+/**
+ * @brief 	This function is used to read the parameters of BAM and RTS messages and to allocate memory
+ * 			for the multi-packet message.
+ * @param	session - A pointer to the TP session.
+ * @param	data - A pointer to the receiving data.
+ * @retval	J1939 status.
+ */
+static J1939_status J1939_readTP_multipacketParameters(J1939_TP_session* session, const uint8_t* data)
+{
+	J1939_status status = (data[0] == J1939_CONTROL_BYTE_TP_CM_BAM) ? J1939_STATUS_GOT_BAM_MESSAGE : J1939_STATUS_GOT_RTS_MESSAGE;
+	J1939_TP_CM* connectManagement = &session->connectManagement;
+	J1939_TP_sink* sink;
+
+	// Read the multi-packet message's parameters
+	connectManagement->control_byte						= data[0];
+	connectManagement->message_size 					= ((uint16_t)data[2] << 8U) | data[1];
+	connectManagement->total_number_of_packages 		= data[3];
+	connectManagement->PGN_of_the_multipacket_message 	= (((uint32_t)data[7] << 16U) | \
+														   ((uint32_t)data[6] << 8U) | data[5]);
+	connectManagement->next_package						= 1U;
+
+	// A multi-packet message takes 9 to 1785 bytes in exactly as many packages as the size needs
+	if((connectManagement->message_size < J1939_MIN_LENGTH_MESSAGE) || \
+	   (connectManagement->message_size > J1939_MAX_LENGTH_MESSAGE) || \
+	   (connectManagement->total_number_of_packages != J1939_GET_NUMBER_OF_PACKAGES(connectManagement->message_size)))
+	{
+		status = J1939_ERROR_TOO_BIG_MESSAGE;
+
+		// The peer-to-peer session is counted when it is aborted, the broadcast one isn't aborted
+		if(session->type == J1939_TP_SESSION_BAM_RX)
+		{
+			J1939_countSessionAbort(session->instance, J1939_STATISTICS_TP_BAM_RX, J1939_REASON_TOO_BIG_MESSAGE, 0U);
+		}
+	} else if((sink = J1939_findTPsink(session->instance, connectManagement->PGN_of_the_multipacket_message)) != NULL)
+	{
+		// The message is streamed to the sink, there is no buffer
+		session->dataTransfer.sink			= sink->sink;
+		session->dataTransfer.sink_context	= sink->context;
+	} else
+	{
+		// Memory allocation for the message from the TP buffer pool, the buffers of the consumed messages come back first
+		J1939_reclaimMessages(session->instance);
+		session->dataTransfer.data = (uint8_t*)J1939_poolAllocate(session->instance, connectManagement->message_size * sizeof(uint8_t));
+
+		// Check memory allocation
+		if(session->dataTransfer.data == NULL)
+		{
+			status = J1939_ERROR_MEMORY_ALLOCATION;
+			session->instance->statistics.sessions[J1939_getStatisticsType(session)].allocation_failures++;
+			J1939_TRACE(session->instance, J1939_TRACE_BUFFER_NOT_ALLOCATED, 0U, connectManagement->message_size,
+						session->source_address, session->destination_address);
+
+			if(session->type == J1939_TP_SESSION_BAM_RX)
+			{
+				J1939_countSessionAbort(session->instance, J1939_STATISTICS_TP_BAM_RX, J1939_REASON_MEMORY_ALLOCATION_ERROR, 0U);
+			}
+		} else
+		{
+			session->dataTransfer.memory_allocated = 1;
+			J1939_countBufferUsage(session->instance, connectManagement->message_size, 1U);
+			J1939_TRACE(session->instance, J1939_TRACE_BUFFER_ALLOCATED, 0U, connectManagement->message_size,
+						session->source_address, session->destination_address);
+		}
+	}
+
+	return status;
+}
+
+/**
+ * @brief 	This function is used to build the CAN ID of the data transfer packages of the session.
+ * @param	session - A pointer to the TP session.
+ * @retval	The CAN ID.
+ */
+static uint32_t J1939_getDataTransferID(J1939_TP_session* session)
+{
+	return (((uint32_t)session->instance->TP.priority << J1939_PGN_PRIOTITY_POS) | J1939_EDP_0 | J1939_DP_0 | \
+			(J1939_DATA_TRANSFER << J1939_PDU_FORMAT_POS) | \
+			(session->connectManagement.destination_address << J1939_PDU_SPECIFIC_POS) | J1939_getCurrentECUAddress(session->instance));
+}
+
+/**
+ * @brief	This function is used to send the next data transfer package.
+ * @param	session - A pointer to the TP session.
+ * @param	canId - The CAN ID of the data transfer packages.
+ * @return	J1939 status.
+ */
+static J1939_status J1939_sendTP_package(J1939_TP_session* session, uint32_t canId)
+{
+	J1939_status status = J1939_STATUS_DATA_CONTINUE;
+	J1939_TP_CM* connectManagement = &session->connectManagement;
+	J1939_TP_DT* dataTransfer = &session->dataTransfer;
+	uint16_t packageBytes;
+	uint8_t data[8] = {0};
+
+	// Fill in the data field of the sent message, taking into account the type of transfer
+	if(connectManagement->destination_address == J1939_BROADCAST_ADDRESS)
+	{
+		data[0] = ++dataTransfer->sequence_number;
+	} else
+	{
+		dataTransfer->sequence_number 	= connectManagement->next_package;
+		dataTransfer->sent_bytes 		= (connectManagement->next_package - 1U) * J1939_MAX_LENGTH_TP_MODE_PACKAGE;
+
+		data[0] = connectManagement->next_package++;
+	}
+
+	// Copy the package and fill the unused bytes of the last package
+	packageBytes = (dataTransfer->sent_bytes < dataTransfer->data_size) ? (uint16_t)(dataTransfer->data_size - dataTransfer->sent_bytes) : 0U;
+	if(packageBytes > J1939_MAX_LENGTH_TP_MODE_PACKAGE) packageBytes = J1939_MAX_LENGTH_TP_MODE_PACKAGE;
+
+	J1939_portCopy(&data[1], &dataTransfer->data[dataTransfer->sent_bytes], packageBytes);
+	dataTransfer->sent_bytes += packageBytes;
+
+	for(uint8_t i = packageBytes + 1U; i <= J1939_MAX_LENGTH_TP_MODE_PACKAGE; i++) data[i] = J1939_PADDING_BYTE;
+
+	// Check the last package in CTS message
+	if(connectManagement->destination_address != J1939_BROADCAST_ADDRESS)
+	{
+		if((--connectManagement->remaining_packages_from_CTS) == 0U)
+		{
+			status = J1939_STATUS_CTS;
+			connectManagement->CTS_available_message = 1U;
+			J1939_setSessionState(session, J1939_STATE_TP_TX_PTP_CTS);
+			J1939_startPeerWait(session, J1939_portGetTime());
+		}
+	}
+
+	// Send the data package
+	J1939_sendFrame(session->instance, canId, data, J1939_CAN_DLC);
+	dataTransfer->package_time = J1939_portGetTime();
+
+	// Check if the message has been sent
+	if(dataTransfer->sent_bytes >= dataTransfer->data_size)
+	{
+		status = J1939_STATUS_DATA_FINISHED;
+
+		// The receiver can still request lost packages by CTS
+		if(connectManagement->destination_address != J1939_BROADCAST_ADDRESS)
+		{
+			connectManagement->CTS_available_message = 1U;
+			J1939_setSessionState(session, J1939_STATE_TP_TX_PTP_EOM);
+		}
+	}
+
+	// The next CTS or the end of message acknowledgment is expected within T3
+	if((status != J1939_STATUS_DATA_CONTINUE) && (connectManagement->destination_address != J1939_BROADCAST_ADDRESS))
+	{
+		J1939_armSessionTimeout(session, J1939_MESSAGE_CM_TIMEOUT);
+	}
+
+	return status;
+}
+
+/**
+ * @brief	This function is used to calculate the number of packages requested by the next CTS message.
+ * @param	session - A pointer to the TP session.
+ * @return	The number of packages from 1 to 255.
+ */
+static uint8_t J1939_getCTSwindow(J1939_TP_session* session)
+{
+	J1939_TP_CM* connectManagement = &session->connectManagement;
+	uint16_t remainingPackages = (uint16_t)(connectManagement->total_number_of_packages - connectManagement->next_package) + 1U;
+	uint32_t window = connectManagement->CTS_window;
+
+	// Leave a share of the bus to other traffic when it is loaded
+	if(session->instance->TP.bus_load > J1939_CTS_BUS_LOAD_THRESHOLD)
+	{
+		window = (window * (J1939_PERCENT - session->instance->TP.bus_load)) / (J1939_PERCENT - J1939_CTS_BUS_LOAD_THRESHOLD);
+	}
+
+	if(window > connectManagement->CTS_window_limit) window = connectManagement->CTS_window_limit;
+
+	// The limit of the sender from the RTS message
+	if((connectManagement->total_number_of_packages_in_CTS != J1939_NO_LIMIT_PACKAGES_IN_CTS) && \
+	   (window > connectManagement->total_number_of_packages_in_CTS))
+	{
+		window = connectManagement->total_number_of_packages_in_CTS;
+	}
+
+	// Only the packages that fit in the free space of the buffer are requested
+	if(window > remainingPackages) window = remainingPackages;
+	if(window == 0U) window = 1U;
+
+	return (uint8_t)window;
+}
+
+/**
+ * @brief	This function is used to adapt the CTS window to the sender responsiveness after the window has been
+ * 			received: it is doubled if the window took less than J1939_CTS_WINDOW_TARGET_TIME and halved otherwise.
+ * @param	session - A pointer to the TP session.
+ * @return	None.
+ */
+static void J1939_adaptCTSwindow(J1939_TP_session* session)
+{
+	J1939_TP_CM* connectManagement = &session->connectManagement;
+	uint32_t windowTime = J1939_portGetTime() - connectManagement->CTS_time;
+	uint16_t window = connectManagement->CTS_window;
+
+	if(windowTime <= J1939_CTS_WINDOW_TARGET_TIME)
+	{
+		window = (uint16_t)(window * 2U);
+		if(window > J1939_NO_LIMIT_PACKAGES_IN_CTS) window = J1939_NO_LIMIT_PACKAGES_IN_CTS;
+	} else
+	{
+		window = (uint16_t)(window / 2U);
+		if(window == 0U) window = 1U;
+	}
+
+	connectManagement->CTS_window = (uint8_t)window;
+}
+
+/**
+ * @brief	This function is used to restart the timeout of the session.
+ * @param	session - A pointer to the TP session.
+ * @param	timeout - The timeout, ms.
+ * @return	None.
+ */
+static void J1939_armSessionTimeout(J1939_TP_session* session, uint32_t timeout)
+{
+	J1939_armTimer(session->instance, &session->timer, timeout, J1939_sessionTimeout, session);
+}
+
+/**
+ * @brief	This function is called by the timer wheel when the session has timed out. The peer-to-peer
+ * 			session is aborted, by the retransmit limit if the lost packages have been requested
+ * 			J1939_TP_MAX_RETRANSMISSIONS times, then the session is closed.
+ * @param	context - A pointer to the TP session.
+ * @return	None.
+ */
+static void J1939_sessionTimeout(void* context)
+{
+	J1939_TP_session* session = (J1939_TP_session*)context;
+	J1939_abortReasons abortReason = J1939_REASON_TIMEOUT;
+	J1939_status status = J1939_ERROR_TIMEOUT;
+
+	// Lost packages at the end of the window are requested again instead of closing the session
+	if((session->type == J1939_TP_SESSION_PTP_RX) && (session->state == J1939_STATE_TP_RX_PTP_DATA))
+	{
+		if(J1939_prepareNextWindow(session) == J1939_STATUS_CTS)
+		{
+			J1939_sendTP_connectionManagement(session, J1939_TP_TYPE_CTS);
+			return;
+		}
+
+		abortReason	= J1939_REASON_RETRANSMIT_LIMIT;
+		status		= J1939_ERROR_MISSING_PACKAGES;
+	}
+
+	J1939_TRACE_SESSION(session, J1939_TRACE_TIMEOUT, session->state);
+
+	if(session->destination_address != J1939_BROADCAST_ADDRESS)
+	{
+		J1939_sendTP_abort(session->instance, session->connectManagement.destination_address,
+						   session->connectManagement.PGN_of_the_multipacket_message, abortReason);
+	}
+
+	J1939_countSessionAbort(session->instance, J1939_getStatisticsType(session), abortReason, 0U);
+
+	if(session->instance->TP.callback != NULL) session->instance->TP.callback(session, status);
+
+	J1939_freeAllocatedMemory(session);
+	J1939_clearTPstructures(session);
+}
+
+/**
+ * @brief	This function is called by the timer wheel at the end of the gap between the broadcast packages.
+ * 			It sends the next package and closes the session after the last one.
+ * @param	context - A pointer to the TP session.
+ * @return	None.
+ */
+static void J1939_sendNextBAMpackage(void* context)
+{
+	J1939_TP_session* session = (J1939_TP_session*)context;
+	uint8_t sentPackages;
+
+	if(J1939_sendTP_dataTransferBurst(session, &sentPackages) == J1939_STATUS_DATA_FINISHED)
+	{
+		J1939_countSessionCompleted(session->instance, J1939_STATISTICS_TP_BAM_TX, session->open_time);
+		J1939_TRACE_SESSION(session, J1939_TRACE_SESSION_COMPLETE, J1939_STATISTICS_TP_BAM_TX);
+
+		if(session->instance->TP.callback != NULL) session->instance->TP.callback(session, J1939_STATUS_DATA_FINISHED);
+
+		J1939_clearTPstructures(session);
+		return;
+	}
+
+	// Retry at the next tick if the CAN controller had no free TX slot
+	J1939_armTimer(session->instance, &session->timer, (sentPackages > 0U) ? J1939_BAM_PACKAGE_GAP : J1939_TIMER_WHEEL_RESOLUTION,
+				   J1939_sendNextBAMpackage, session);
+}
+
+/**
+ * @brief	This function is used to find the first package of the message that hasn't been received yet.
+ * @param	session - A pointer to the TP session.
+ * @return	The package number. total_number_of_packages + 1 if all packages have been received.
  */
-void J1939_setDestinationAddress(uint8_t destinationAddress)
+static uint16_t J1939_findMissingPackage(J1939_TP_session* session)
 {
-	connectManagement.destination_address = destinationAddress;
+	J1939_TP_DT* dataTransfer = &session->dataTransfer;
+	uint16_t totalPackages = session->connectManagement.total_number_of_packages;
+	uint16_t package = 1U;
+
+	// Skip the completely received bytes of the map
+	while((package <= totalPackages) && (dataTransfer->received_packages_map[(package - 1U) >> 3U] == 0xFFU))
+	{
+		package += 8U;
+	}
+
+	while((package <= totalPackages) && (J1939_IS_PACKAGE_RECEIVED(dataTransfer, package) == 1U))
+	{
+		package++;
+	}
+
+	return (package > totalPackages) ? (totalPackages + 1U) : package;
+}
+
+/**
+ * @brief	This function is used to choose the packages requested by the next CTS message after the window is over.
+ * 			If packages of the requested windows are missing, only the first run of them is requested again.
+ * @param	session - A pointer to the TP session.
+ * @return	J1939_STATUS_CTS or J1939_ERROR_MISSING_PACKAGES if J1939_TP_MAX_RETRANSMISSIONS of the package are over.
+ */
+static J1939_status J1939_prepareNextWindow(J1939_TP_session* session)
+{
+	J1939_TP_CM* connectManagement = &session->connectManagement;
+	uint16_t missingPackage = J1939_findMissingPackage(session);
+	uint16_t package = missingPackage;
+
+	if(missingPackage > connectManagement->last_requested_package)
+	{
+		// All requested packages have been received, the next window continues the message
+		connectManagement->next_package				= (uint8_t)missingPackage;
+		connectManagement->retransmit_packages		= 0U;
+		connectManagement->retransmissions			= 0U;
+		J1939_adaptCTSwindow(session);
+
+		return J1939_STATUS_CTS;
+	}
+
+	// The same package is requested again a limited number of times
+	if(connectManagement->retransmitted_package != missingPackage)
+	{
+		connectManagement->retransmitted_package	= (uint8_t)missingPackage;
+		connectManagement->retransmissions			= 0U;
+	}
+
+	if(connectManagement->retransmissions >= J1939_TP_MAX_RETRANSMISSIONS) return J1939_ERROR_MISSING_PACKAGES;
+
+	connectManagement->retransmissions++;
+
+	while((package <= connectManagement->last_requested_package) && \
+		  (J1939_IS_PACKAGE_RECEIVED(&session->dataTransfer, package) == 0U))
+	{
+		package++;
+	}
+
+	connectManagement->next_package			= (uint8_t)missingPackage;
+	connectManagement->retransmit_packages	= (uint8_t)(package - missingPackage);
+
+	session->instance->statistics.sessions[J1939_STATISTICS_TP_PTP_RX].retransmitted_packages += connectManagement->retransmit_packages;
+
+	return J1939_STATUS_CTS;
 }
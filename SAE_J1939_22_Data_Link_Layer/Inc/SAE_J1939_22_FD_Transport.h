@@ -0,0 +1,294 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_22_FD_Transport.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of SAE J1939-22 FD Transport Protocol (FD.TP).
+  * 		 Multi-packet messages are sent over CAN FD in segments of 60
+  * 		 bytes, by RTS/CTS to one ECU or by BAM to all. A session is
+  * 		 identified by the peer address and its session number, so several
+  * 		 sessions with the same ECU can be open at the same time.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_22_FD_TRANSPORT_H
+#define __SAE_J1939_22_FD_TRANSPORT_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Transport_Layer.h"
+#include "SAE_J1939_21_Memory_Pool.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_FD_CONNECTION_MANAGEMENT			(0x4DU)
+#define J1939_FD_DATA_TRANSFER					(0x4EU)
+
+#define J1939_FD_TP_CM_LENGTH					(12U)	// The length of the FD.TP.CM frames
+#define J1939_FD_TP_DT_HEADER					(4U)	// Session number and segment number of FD.TP.DT
+#define J1939_FD_TP_SEGMENT_SIZE				(60U)	// Message bytes in one FD.TP.DT frame
+#define J1939_FD_TP_SESSION_NUMBERS				(16U)
+#define J1939_FD_PADDING_BYTE					(0xAAU)	// Fills the frame up to a valid CAN FD length
+
+// The largest message. The receive buffers are taken from the memory pool, so it can't exceed 65535 bytes.
+// It can be redefined in the compiler options.
+#ifndef J1939_FD_TP_MAX_MESSAGE_SIZE
+#define J1939_FD_TP_MAX_MESSAGE_SIZE			(J1939_POOL_LARGE_BLOCK_SIZE)
+#endif
+
+#if ((J1939_FD_TP_MAX_MESSAGE_SIZE <= J1939_FD_TP_SEGMENT_SIZE) || (J1939_FD_TP_MAX_MESSAGE_SIZE > 65535U))
+	#error "J1939_FD_TP_MAX_MESSAGE_SIZE must be from 61 to 65535"
+#endif
+
+// The largest number of segments requested by one CTS. It can be redefined in the compiler options.
+#ifndef J1939_FD_TP_RX_MAX_SEGMENTS_IN_CTS
+#define J1939_FD_TP_RX_MAX_SEGMENTS_IN_CTS		(16U)
+#endif
+
+#if ((J1939_FD_TP_RX_MAX_SEGMENTS_IN_CTS == 0U) || (J1939_FD_TP_RX_MAX_SEGMENTS_IN_CTS > 255U))
+	#error "J1939_FD_TP_RX_MAX_SEGMENTS_IN_CTS must be from 1 to 255"
+#endif
+
+// Gap between the segments of the broadcast message, ms. It can be redefined in the compiler options.
+#ifndef J1939_FD_TP_BAM_SEGMENT_GAP
+#define J1939_FD_TP_BAM_SEGMENT_GAP				(J1939_BAM_PACKAGE_GAP)
+#endif
+
+// The number of sessions of each type which can be opened at the same time.
+// It can be redefined in the compiler options.
+#ifndef J1939_MAX_FD_TP_BAM_RX_SESSIONS
+#define J1939_MAX_FD_TP_BAM_RX_SESSIONS			(2U)
+#endif
+
+#ifndef J1939_MAX_FD_TP_PTP_RX_SESSIONS
+#define J1939_MAX_FD_TP_PTP_RX_SESSIONS			(2U)
+#endif
+
+#ifndef J1939_MAX_FD_TP_TX_SESSIONS
+#define J1939_MAX_FD_TP_TX_SESSIONS				(2U)
+#endif
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief SAE J1939-22 FD.TP connection management control values (the low nibble of the first byte,
+ * 		  the high nibble is the session number).
+ */
+typedef enum
+{
+	J1939_FD_CONTROL_RTS					= 0U,		/* Request to send */
+	J1939_FD_CONTROL_CTS					= 1U,		/* Clear to send */
+	J1939_FD_CONTROL_EOM_STATUS				= 2U,		/* End of message status, sent after the last segment */
+	J1939_FD_CONTROL_EOM_ACK				= 3U,		/* End of message acknowledgment */
+	J1939_FD_CONTROL_BAM					= 4U,		/* Broadcast announce message */
+	J1939_FD_CONTROL_ABORT					= 15U		/* Connection abort */
+} J1939_FDcontrolValues;
+
+/**
+ * @brief J1939 FD transport protocol session types.
+ */
+typedef enum
+{
+	J1939_FD_TP_SESSION_BAM_RX,		/* Receiving a broadcast multi-segment message */
+	J1939_FD_TP_SESSION_PTP_RX,		/* Receiving a peer-to-peer (RTS/CTS) multi-segment message */
+	J1939_FD_TP_SESSION_TX,			/* Sending a multi-segment message (BAM or RTS/CTS) */
+	J1939_FD_TP_SESSION_TYPES		/* The number of session types */
+} J1939_FDTPsessionTypes;
+
+/**
+ * @brief PGN 0x004D00/0x004E00 - FD Transport Protocol session.
+ */
+typedef struct
+{
+	J1939_FDTPsessionTypes type;					/* Session type */
+	J1939_states state;								/* Current state of the session */
+	uint8_t source_address;							/* Originator of the multi-segment message */
+	uint8_t destination_address;					/* Recipient of the multi-segment message. 255 - broadcast */
+	uint8_t session_number;							/* From 0 to 15, chosen by the originator */
+	uint8_t in_use;									/* 1 - session is open, 0 - session slot is free */
+
+	uint16_t message_size;							/* Total bytes of the message */
+	uint16_t total_number_of_segments;				/* Number of segments to send a message */
+	uint32_t PGN_of_the_multipacket_message;		/* A PGN that activated the multi-segment transfer */
+	uint8_t max_segments_in_CTS;					/* Max. number of segments in response to CTS. 0xFF - No limit */
+
+	uint16_t next_segment;							/* The next segment to send or to receive */
+	uint16_t last_segment;							/* The last segment of the CTS window */
+	uint8_t CTS_available_message;					/* 1 allows to process CTS messages, 0 - doesn't */
+	uint16_t retransmitted_segment;					/* The lost segment requested again */
+	uint8_t retransmissions;						/* How many times the lost segment has been requested */
+
+	uint8_t* data;									/* The message */
+	uint8_t memory_allocated;						/* 1 - the receive buffer is allocated from the pool */
+	uint32_t segment_time;							/* Time when the last broadcast segment was sent, ms */
+
+	J1939_abortReasons abort_reason;				/* Connection abort reason */
+	uint32_t open_time;								/* Time when the session was opened, ms */
+	uint32_t wait_time;								/* Time when the session started to wait for CTS or its segments, ms */
+	uint8_t waiting;								/* 1 - the wait for CTS or its segments is timed */
+	J1939_timer timer;								/* Timeout of the session or the gap between BAM segments */
+	J1939_instance* instance;						/* The instance which owns the session */
+} J1939_FDTP_session;
+
+/**
+ * @brief A function called by J1939_processTimers when the library closes an FD.TP session itself:
+ * 		  J1939_ERROR_TIMEOUT - the session has timed out (the abort message has already been sent),
+ * 		  J1939_STATUS_DATA_FINISHED - the last segment of the broadcast message has been sent.
+ * 		  The session is closed after the function returns.
+ */
+typedef void (*J1939_FDTPcallback)(J1939_FDTP_session* session, J1939_status status);
+
+/**
+ * @brief FD transport protocol of an instance.
+ */
+typedef struct
+{
+	J1939_FDTP_session bam_rx_sessions[J1939_MAX_FD_TP_BAM_RX_SESSIONS];
+	J1939_FDTP_session ptp_rx_sessions[J1939_MAX_FD_TP_PTP_RX_SESSIONS];
+	J1939_FDTP_session tx_sessions[J1939_MAX_FD_TP_TX_SESSIONS];
+	J1939_FDTPcallback callback;							/* Called when the library closes a session itself */
+	uint8_t next_session_number;							/* The session number of the next TX session */
+} J1939_FDtransport;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to bind the sessions of the instance. It is called by J1939_initInstance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initFDtransport(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to read FD transport protocol connection management messages.
+ * 			BAM and RTS messages open a new session, other messages are routed to the already
+ * 			opened session of the sender with the same session number.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the received message.
+ * @param	data - A pointer to the receiving data, J1939_FD_TP_CM_LENGTH bytes.
+ * @param	session - A pointer to store the session of the message. NULL if there is no session.
+ * @retval	J1939 status. J1939_STATUS_DATA_FINISHED - the message has been received completely, EOMA must be sent.
+ * 			J1939_STATUS_CTS - lost segments must be requested again by CTS.
+ */
+J1939_status J1939_readFDTP_connectionManagement(J1939_instance* instance, uint32_t canId, const uint8_t* data, J1939_FDTP_session** session);
+
+/**
+ * @brief	This function is used to send FD transport protocol connection management messages:
+ * 			RTS, BAM, CTS, END_OF_MSG (EOMA of the receiver) or ABORT. After BAM the segments are sent
+ * 			by J1939_processTimers with J1939_FD_TP_BAM_SEGMENT_GAP.
+ * @param	session - A pointer to the FD.TP session.
+ * @param	type - A type of the connection management message.
+ * @retval	None.
+ */
+void J1939_sendFDTP_connectionManagement(J1939_FDTP_session* session, J1939_TPcmTypes type);
+
+/**
+ * @brief	This function is used to send the FD transport protocol abort message without an opened session.
+ * @param	instance - A pointer to the instance.
+ * @param	destinationAddress - ECU address to send the message to.
+ * @param	sessionNumber - The session number.
+ * @param	PGN - A PGN of the multi-segment message.
+ * @param	abortReason - The abort reason.
+ * @retval	None.
+ */
+void J1939_sendFDTP_abort(J1939_instance* instance, uint8_t destinationAddress, uint8_t sessionNumber, uint32_t PGN,
+						  J1939_abortReasons abortReason);
+
+/**
+ * @brief 	This function is used to read FD transport protocol data transfer messages. The segments are
+ * 			accepted in order, a segment after a gap is dropped and the gap is requested again.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the received message.
+ * @param	data - A pointer to the receiving data.
+ * @param	length - The number of data bytes.
+ * @param	session - A pointer to store the session of the message. NULL if there is no session.
+ * @retval	J1939 status. J1939_STATUS_CTS - the next CTS must be sent, J1939_STATUS_DATA_FINISHED - the broadcast
+ * 			message has been received, J1939_ERROR_MISSING_PACKAGES - lost segments can't be received.
+ */
+J1939_status J1939_readFDTP_dataTransfer(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t length,
+										 J1939_FDTP_session** session);
+
+/**
+ * @brief	This function is used to send the segments of the CTS window and the end of message status after
+ * 			the last one, limited by the free TX slots of the CAN controller. A broadcast session sends one
+ * 			segment per J1939_FD_TP_BAM_SEGMENT_GAP.
+ * @param	session - A pointer to the FD.TP session.
+ * @param	sentSegments - A pointer to store the number of queued segments.
+ * @return	J1939 status. J1939_STATUS_CTS if the window is over and the next CTS must be waited,
+ * 			J1939_STATUS_DATA_FINISHED if the last segment has been sent.
+ */
+J1939_status J1939_sendFDTP_dataTransferBurst(J1939_FDTP_session* session, uint8_t* sentSegments);
+
+/**
+ * @brief	This function is used to continue the CTS windows of all TX sessions which have been limited
+ * 			by the free TX slots. It is called when TX slots of the CAN controller are released.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of queued segments.
+ */
+uint16_t J1939_sendFDTPpendingSegments(J1939_instance* instance);
+
+/**
+ * @brief	This function used to open an FD.TP TX session. The data isn't copied, it mustn't be changed
+ * 			until the session is closed.
+ * @param	instance - A pointer to the instance.
+ * @param 	data - A pointer to the sending data.
+ * @param 	dataSize - A size of the sending data, from 1 to J1939_FD_TP_MAX_MESSAGE_SIZE.
+ * @param 	PGN - A PGN of the multi-segment message.
+ * @param 	destinationAddress - ECU address to send data to. 255 - broadcast.
+ * @retval	A pointer to the TX session. NULL if there is no free session or the size is wrong.
+ */
+J1939_FDTP_session* J1939_fillFDTPstructures(J1939_instance* instance, uint8_t* data, uint16_t dataSize, uint32_t PGN,
+											 uint8_t destinationAddress);
+
+/**
+ * @brief	This function is used to free the receive buffer of the session and to close it.
+ * @param	session - A pointer to the FD.TP session.
+ * @retval	None.
+ */
+void J1939_clearFDTPstructures(J1939_FDTP_session* session);
+
+/**
+ * @brief 	This function is used to hand the message of an FD.TP session which has returned J1939_STATUS_DATA_FINISHED
+ * 			to the message queue. The buffer is taken from the session, so it can be closed at once.
+ * 			Called by the task of the instance only.
+ * @param	session - A pointer to the FD.TP session.
+ * @retval	J1939_QUEUE_OK, J1939_QUEUE_FULL or J1939_QUEUE_INVALID. The session keeps the buffer if not J1939_QUEUE_OK.
+ */
+uint8_t J1939_queueReceivedFDTPmessage(J1939_FDTP_session* session);
+
+/**
+ * @brief 	This function is used to set the abort reason sent by J1939_sendFDTP_connectionManagement.
+ * @param	session - A pointer to the FD.TP session.
+ * @param 	abortReason - The abort reason.
+ * @retval	None.
+ */
+void J1939_setFDTPabortReason(J1939_FDTP_session* session, J1939_abortReasons abortReason);
+
+/**
+ * @brief 	This function is used to set the function called when the library closes an FD.TP session itself.
+ * @param	instance - A pointer to the instance.
+ * @param	callback - A pointer to the function. NULL - no function.
+ * @retval	None.
+ */
+void J1939_setFDTPcallback(J1939_instance* instance, J1939_FDTPcallback callback);
+
+/**
+ * @brief 	This function is used to fill the frame up to the nearest valid CAN FD length with J1939_FD_PADDING_BYTE.
+ * @param	data - A pointer to the frame data, J1939_PORT_FD_MAX_LENGTH bytes.
+ * @param	size - The number of meaningful bytes.
+ * @retval	The CAN FD length of the frame.
+ */
+uint8_t J1939_padFDframe(uint8_t* data, uint8_t size);
+
+#endif /* __SAE_J1939_22_FD_TRANSPORT_H */
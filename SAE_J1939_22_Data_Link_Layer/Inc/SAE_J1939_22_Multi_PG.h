@@ -0,0 +1,124 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_22_Multi_PG.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of SAE J1939-22 multi-PG. Small PGNs sent to the same
+  * 		 destination are packed as contained parameter groups (C-PG) into
+  * 		 one CAN FD frame of up to 64 bytes. A frame is sent when it is
+  * 		 full or J1939_MULTI_PG_MAX_DELAY after its first C-PG.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_22_MULTI_PG_H
+#define __SAE_J1939_22_MULTI_PG_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Transport_Layer.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_MULTI_PG							(0x25U)
+
+// C-PG header: the C-PGN (bits 0-17), the trailer format (bits 18-20) and the type of service (bits 21-23)
+// in three little-endian bytes, then the payload length
+#define J1939_MULTI_PG_HEADER					(4U)
+#define J1939_MULTI_PG_MAX_PAYLOAD				(J1939_PORT_FD_MAX_LENGTH - J1939_MULTI_PG_HEADER)
+#define J1939_MULTI_PG_TOS_NO_ASSURANCE			(2U)	// The C-PG has no assurance data
+#define J1939_MULTI_PG_TF_NONE					(0U)	// The C-PG has no trailer
+
+// The number of destinations whose C-PGs are packed at the same time. It can be redefined in the compiler options.
+#ifndef J1939_MULTI_PG_BUFFERS
+#define J1939_MULTI_PG_BUFFERS					(2U)
+#endif
+
+// The longest time a C-PG waits for others, ms. It can be redefined in the compiler options.
+#ifndef J1939_MULTI_PG_MAX_DELAY
+#define J1939_MULTI_PG_MAX_DELAY				(J1939_TIMER_WHEEL_RESOLUTION)
+#endif
+
+#define J1939_MULTI_PG_OK						(0U)
+#define J1939_MULTI_PG_INVALID					(1U)
+#define J1939_MULTI_PG_BUSY						(2U)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A multi-PG frame being packed for one destination.
+ */
+typedef struct
+{
+	uint8_t in_use;									/* 1 - the frame holds C-PGs, 0 - the buffer is free */
+	uint8_t destination_address;					/* The destination of the C-PGs. 255 - broadcast */
+	uint8_t priority;								/* The highest priority of the packed C-PGs */
+	uint8_t size;									/* The number of packed bytes */
+	uint8_t data[J1939_PORT_FD_MAX_LENGTH];			/* The packed C-PGs */
+	J1939_timer timer;								/* Sends the frame after J1939_MULTI_PG_MAX_DELAY */
+	J1939_instance* instance;						/* The instance which owns the buffer */
+} J1939_multiPGbuffer;
+
+/**
+ * @brief Multi-PG of an instance.
+ */
+typedef struct
+{
+	J1939_multiPGbuffer buffers[J1939_MULTI_PG_BUFFERS];
+	uint32_t packed_PGs;							/* C-PGs packed into the frames */
+	uint32_t frames;								/* Multi-PG frames queued */
+} J1939_multiPG;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to bind the buffers of the instance. It is called by J1939_initInstance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initMultiPG(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to pack a PGN into the multi-PG frame of its destination. A full frame
+ * 			is sent at once, the others wait up to J1939_MULTI_PG_MAX_DELAY for more C-PGs.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN. The destination of a PDU2 PGN is the global address.
+ * @param	priority - The priority from 0 (the highest) to 7.
+ * @param	destinationAddress - ECU address to send data to. 255 - broadcast.
+ * @param	data - A pointer to the data, it is copied.
+ * @param	size - The size of the data, up to J1939_MULTI_PG_MAX_PAYLOAD bytes.
+ * @retval	J1939_MULTI_PG_OK, J1939_MULTI_PG_INVALID or J1939_MULTI_PG_BUSY if a full frame couldn't be queued.
+ */
+uint8_t J1939_sendCPG(J1939_instance* instance, uint32_t PGN, uint8_t priority, uint8_t destinationAddress, const uint8_t* data,
+					  uint8_t size);
+
+/**
+ * @brief 	This function is used to send all waiting multi-PG frames at once.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of queued frames.
+ */
+uint8_t J1939_flushMultiPG(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to pass the C-PGs of a received multi-PG frame to the handlers of their PGNs.
+ * 			Parsing stops at the padding, at an unsupported type of service or trailer and at a C-PG which
+ * 			doesn't fit in the frame.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	length - The number of data bytes.
+ * @retval	The number of C-PGs passed on.
+ */
+uint8_t J1939_readMultiPG(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t length);
+
+#endif /* __SAE_J1939_22_MULTI_PG_H */
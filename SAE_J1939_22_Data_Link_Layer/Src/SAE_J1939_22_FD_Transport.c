@@ -0,0 +1,1028 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_22_FD_Transport.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the SAE J1939-22 FD
+  * 		 Transport Protocol. A receive session accepts the segments in
+  * 		 order into a buffer of the memory pool, a gap is requested again
+  * 		 by CTS from the first lost segment.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_PGN_PRIOTITY_POS					(26U)
+#define J1939_PDU_FORMAT_POS					(16U)
+#define J1939_PDU_SPECIFIC_POS					(8U)
+
+#define J1939_GET_SOURCE_ADDRESS(canId)			((uint8_t)(canId))
+#define J1939_GET_PDU_SPECIFIC(canId)			((uint8_t)((canId) >> J1939_PDU_SPECIFIC_POS))
+#define J1939_GET_24_BITS(data)					(((uint32_t)(data)[2] << 16U) | ((uint32_t)(data)[1] << 8U) | (data)[0])
+#define J1939_SET_24_BITS(data, value)			do { (data)[0] = (uint8_t)(value); (data)[1] = (uint8_t)((value) >> 8U); \
+													 (data)[2] = (uint8_t)((value) >> 16U); } while(0)
+
+#define J1939_FD_GET_CONTROL(data)				((data)[0] & 0x0FU)
+#define J1939_FD_GET_SESSION_NUMBER(data)		((uint8_t)((data)[0] >> 4U))
+#define J1939_FD_SESSION_BYTE(number, control)	((uint8_t)(((number) << 4U) | (control)))
+
+#define J1939_NO_LIMIT_SEGMENTS_IN_CTS			(0xFFU)
+#define J1939_RESERVED_BYTE						(0xFFU)
+
+#define J1939_GET_STATISTICS_TYPE(session)		(((session)->type == J1939_FD_TP_SESSION_TX) ? J1939_STATISTICS_FD_TP_TX : \
+																							   J1939_STATISTICS_FD_TP_RX)
+
+// Records an event of the session in the trace
+#define J1939_TRACE_FD_SESSION(session, event, detail) \
+		J1939_TRACE((session)->instance, (event), (detail), (session)->PGN_of_the_multipacket_message, \
+					(session)->source_address, (session)->destination_address)
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static J1939_FDTP_session* J1939_getFDTPsessions(J1939_instance* instance, J1939_FDTPsessionTypes type, uint8_t* numberOfSessions);
+static uint8_t J1939_getFDTPpeerAddress(J1939_FDTP_session* session);
+static J1939_FDTP_session* J1939_getFDTPsession(J1939_instance* instance, J1939_FDTPsessionTypes type, uint8_t peerAddress,
+												uint8_t sessionNumber);
+static J1939_FDTP_session* J1939_openFDTPsession(J1939_instance* instance, J1939_FDTPsessionTypes type, uint8_t sourceAddress,
+												 uint8_t destinationAddress, uint8_t sessionNumber, uint32_t PGN);
+static J1939_status J1939_readFDTP_multipacketParameters(J1939_FDTP_session* session, const uint8_t* data);
+static uint32_t J1939_getFDTPid(J1939_instance* instance, uint8_t PDUformat, uint8_t destinationAddress);
+static void J1939_sendFDTP_segment(J1939_FDTP_session* session, uint32_t canId);
+static J1939_status J1939_prepareFDTPretransmission(J1939_FDTP_session* session);
+static void J1939_FDTPsessionTimeout(void* context);
+static void J1939_sendNextFDTPbroadcastSegment(void* context);
+static void J1939_startFDTPpeerWait(J1939_FDTP_session* session);
+static void J1939_stopFDTPpeerWait(J1939_FDTP_session* session);
+static void J1939_setFDTPsessionState(J1939_FDTP_session* session, J1939_states state);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to bind the sessions of the instance. It is called by J1939_initInstance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initFDtransport(J1939_instance* instance)
+{
+	for(uint8_t type = 0U; type < J1939_FD_TP_SESSION_TYPES; type++)
+	{
+		uint8_t numberOfSessions;
+		J1939_FDTP_session* sessions = J1939_getFDTPsessions(instance, (J1939_FDTPsessionTypes)type, &numberOfSessions);
+
+		for(uint8_t slot = 0U; slot < numberOfSessions; slot++)
+		{
+			sessions[slot].type		= (J1939_FDTPsessionTypes)type;
+			sessions[slot].instance	= instance;
+		}
+	}
+}
+
+/**
+ * @brief 	This function is used to read FD transport protocol connection management messages.
+ * 			BAM and RTS messages open a new session, other messages are routed to the already
+ * 			opened session of the sender with the same session number.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the received message.
+ * @param	data - A pointer to the receiving data, J1939_FD_TP_CM_LENGTH bytes.
+ * @param	session - A pointer to store the session of the message. NULL if there is no session.
+ * @retval	J1939 status. J1939_STATUS_DATA_FINISHED - the message has been received completely, EOMA must be sent.
+ * 			J1939_STATUS_CTS - lost segments must be requested again by CTS.
+ */
+J1939_status J1939_readFDTP_connectionManagement(J1939_instance* instance, uint32_t canId, const uint8_t* data, J1939_FDTP_session** session)
+{
+	J1939_status status = J1939_NO_STATUS;
+	J1939_FDTP_session* currentSession = NULL;
+	uint8_t sourceAddress = J1939_GET_SOURCE_ADDRESS(canId);
+	uint8_t sessionNumber = J1939_FD_GET_SESSION_NUMBER(data);
+	uint32_t PGN = J1939_GET_24_BITS(&data[8]);
+	J1939_FDTPsessionTypes type;
+
+	switch(J1939_FD_GET_CONTROL(data))
+	{
+		case J1939_FD_CONTROL_BAM:
+		case J1939_FD_CONTROL_RTS:
+			type = (J1939_FD_GET_CONTROL(data) == J1939_FD_CONTROL_BAM) ? J1939_FD_TP_SESSION_BAM_RX : J1939_FD_TP_SESSION_PTP_RX;
+
+			// The announcement of a session number in use replaces the old session of the originator
+			currentSession = J1939_getFDTPsession(instance, type, sourceAddress, sessionNumber);
+			if(currentSession != NULL) J1939_clearFDTPstructures(currentSession);
+
+			currentSession = J1939_openFDTPsession(instance, type, sourceAddress, J1939_GET_PDU_SPECIFIC(canId), sessionNumber, PGN);
+
+			if(currentSession == NULL)
+			{
+				instance->statistics.sessions[J1939_STATISTICS_FD_TP_RX].busy++;
+				status = J1939_ERROR_BUSY;
+				break;
+			}
+
+			status = J1939_readFDTP_multipacketParameters(currentSession, data);
+
+			if(status == J1939_STATUS_GOT_BAM_MESSAGE)
+			{
+				J1939_setFDTPsessionState(currentSession, J1939_STATE_TP_RX_BROADCAST);
+				J1939_armTimer(instance, &currentSession->timer, J1939_MESSAGE_DATA_TIMEOUT, J1939_FDTPsessionTimeout, currentSession);
+			} else if(status == J1939_STATUS_GOT_RTS_MESSAGE)
+			{
+				// The session is closed if CTS isn't sent in time
+				J1939_setFDTPsessionState(currentSession, J1939_STATE_TP_RX_PTP_CTS);
+				J1939_armTimer(instance, &currentSession->timer, J1939_MESSAGE_CM_TIMEOUT, J1939_FDTPsessionTimeout, currentSession);
+			}
+			break;
+
+		case J1939_FD_CONTROL_CTS:
+			currentSession = J1939_getFDTPsession(instance, J1939_FD_TP_SESSION_TX, sourceAddress, sessionNumber);
+
+			if((currentSession != NULL) && (currentSession->CTS_available_message == 1U))
+			{
+				uint16_t nextSegment = (uint16_t)J1939_GET_24_BITS(&data[2]);
+				uint16_t segments = data[1];
+
+				if((nextSegment == 0U) || (nextSegment > currentSession->total_number_of_segments)) break;
+
+				J1939_stopFDTPpeerWait(currentSession);
+				J1939_TRACE_FD_SESSION(currentSession, J1939_TRACE_CTS_RECEIVED, data[1]);
+
+				// The segments already sent and requested again are counted as retransmitted
+				if(nextSegment < currentSession->next_segment)
+				{
+					instance->statistics.sessions[J1939_STATISTICS_FD_TP_TX].retransmitted_packages += \
+						(segments < (currentSession->next_segment - nextSegment)) ? segments : (currentSession->next_segment - nextSegment);
+				}
+
+				if(segments > (currentSession->total_number_of_segments - nextSegment + 1U))
+				{
+					segments = currentSession->total_number_of_segments - nextSegment + 1U;
+				}
+
+				if(segments > 0U)
+				{
+					currentSession->next_segment			= nextSegment;
+					currentSession->last_segment			= nextSegment + segments - 1U;
+					currentSession->CTS_available_message	= 0U;
+					J1939_setFDTPsessionState(currentSession, J1939_STATE_TP_TX_PTP_DATA);
+					J1939_cancelTimer(instance, &currentSession->timer);
+				} else
+				{
+					// CTS with zero segments holds the connection open, the next CTS is waited
+					J1939_armTimer(instance, &currentSession->timer, J1939_MESSAGE_HOLD_TIMEOUT, J1939_FDTPsessionTimeout, currentSession);
+				}
+
+				status = J1939_STATUS_GOT_CTS_MESSAGE;
+			}
+			break;
+
+		case J1939_FD_CONTROL_EOM_STATUS:
+			currentSession = J1939_getFDTPsession(instance, J1939_FD_TP_SESSION_PTP_RX, sourceAddress, sessionNumber);
+
+			if((currentSession != NULL) && ((currentSession->state == J1939_STATE_TP_RX_PTP_DATA) || \
+											(currentSession->state == J1939_STATE_TP_RX_PTP_EOM)))
+			{
+				// The status sent before the segments requested by the last CTS is ignored
+				if(currentSession->waiting == 1U)
+				{
+					status = J1939_NO_STATUS;
+					break;
+				}
+
+
+				if(currentSession->next_segment > currentSession->total_number_of_segments)
+				{
+					J1939_cancelTimer(instance, &currentSession->timer);
+					J1939_countSessionCompleted(instance, J1939_STATISTICS_FD_TP_RX, currentSession->open_time);
+					J1939_TRACE_FD_SESSION(currentSession, J1939_TRACE_SESSION_COMPLETE, J1939_STATISTICS_FD_TP_RX);
+					status = J1939_STATUS_DATA_FINISHED;
+				} else
+				{
+					// The last segments have been lost
+					currentSession->last_segment = currentSession->total_number_of_segments;
+					status = J1939_prepareFDTPretransmission(currentSession);
+				}
+			}
+			break;
+
+		case J1939_FD_CONTROL_EOM_ACK:
+			currentSession = J1939_getFDTPsession(instance, J1939_FD_TP_SESSION_TX, sourceAddress, sessionNumber);
+
+			if((currentSession != NULL) && (currentSession->state == J1939_STATE_TP_TX_PTP_EOM))
+			{
+				J1939_stopFDTPpeerWait(currentSession);
+				J1939_cancelTimer(instance, &currentSession->timer);
+				J1939_countSessionCompleted(instance, J1939_STATISTICS_FD_TP_TX, currentSession->open_time);
+				J1939_TRACE_FD_SESSION(currentSession, J1939_TRACE_SESSION_COMPLETE, J1939_STATISTICS_FD_TP_TX);
+				status = J1939_STATUS_GOT_EOM_MESSAGE;
+			}
+			break;
+
+		case J1939_FD_CONTROL_ABORT:
+			// The abort message can be sent by both sides of the session
+			currentSession = J1939_getFDTPsession(instance, J1939_FD_TP_SESSION_TX, sourceAddress, sessionNumber);
+
+			if((currentSession == NULL) || (currentSession->PGN_of_the_multipacket_message != PGN))
+			{
+				currentSession = J1939_getFDTPsession(instance, J1939_FD_TP_SESSION_PTP_RX, sourceAddress, sessionNumber);
+			}
+
+			if(currentSession != NULL)
+			{
+				J1939_cancelTimer(instance, &currentSession->timer);
+				J1939_countSessionAbort(instance, J1939_GET_STATISTICS_TYPE(currentSession), data[1], 1U);
+				J1939_TRACE_FD_SESSION(currentSession, J1939_TRACE_ABORT_RECEIVED, data[1]);
+				status = J1939_STATUS_GOT_ABORT_SESSION;
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	*session = currentSession;
+
+	return status;
+}
+
+/**
+ * @brief	This function is used to send FD transport protocol connection management messages:
+ * 			RTS, BAM, CTS, END_OF_MSG (EOMA of the receiver) or ABORT. After BAM the segments are sent
+ * 			by J1939_processTimers with J1939_FD_TP_BAM_SEGMENT_GAP.
+ * @param	session - A pointer to the FD.TP session.
+ * @param	type - A type of the connection management message.
+ * @retval	None.
+ */
+void J1939_sendFDTP_connectionManagement(J1939_FDTP_session* session, J1939_TPcmTypes type)
+{
+	uint8_t peerAddress = J1939_getFDTPpeerAddress(session);
+	uint8_t data[J1939_FD_TP_CM_LENGTH];
+	uint16_t segments;
+
+	// The abort message isn't bound to the state of the session
+	if(type == J1939_TP_TYPE_ABORT)
+	{
+		J1939_sendFDTP_abort(session->instance, peerAddress, session->session_number, session->PGN_of_the_multipacket_message,
+							 session->abort_reason);
+		J1939_countSessionAbort(session->instance, J1939_GET_STATISTICS_TYPE(session), session->abort_reason, 0U);
+		J1939_TRACE_FD_SESSION(session, J1939_TRACE_ABORT_SENT, session->abort_reason);
+		session->abort_reason = 0U;
+		return;
+	}
+
+	// Fill in bytes that are the same for all messages
+	for(uint8_t i = 0U; i < J1939_FD_TP_CM_LENGTH; i++) data[i] = J1939_RESERVED_BYTE;
+	J1939_SET_24_BITS(&data[8], session->PGN_of_the_multipacket_message);
+
+	switch(type)
+	{
+		case J1939_TP_TYPE_RTS:
+		case J1939_TP_TYPE_BAM:
+		case J1939_TP_TYPE_END_OF_MSG:
+			data[0] = J1939_FD_SESSION_BYTE(session->session_number, (type == J1939_TP_TYPE_RTS) ? J1939_FD_CONTROL_RTS : \
+											(type == J1939_TP_TYPE_BAM) ? J1939_FD_CONTROL_BAM : J1939_FD_CONTROL_EOM_ACK);
+			J1939_SET_24_BITS(&data[1], session->message_size);
+			J1939_SET_24_BITS(&data[4], session->total_number_of_segments);
+
+			if(type == J1939_TP_TYPE_RTS)
+			{
+				data[7] = J1939_NO_LIMIT_SEGMENTS_IN_CTS;
+				session->CTS_available_message = 1U;
+				J1939_setFDTPsessionState(session, J1939_STATE_TP_TX_PTP_CTS);
+				J1939_startFDTPpeerWait(session);
+				J1939_armTimer(session->instance, &session->timer, J1939_MESSAGE_CM_TIMEOUT, J1939_FDTPsessionTimeout, session);
+			} else if(type == J1939_TP_TYPE_BAM)
+			{
+				// The first segment follows BAM after the gap
+				session->segment_time = J1939_portGetTime();
+				J1939_setFDTPsessionState(session, J1939_STATE_TP_TX_BROADCAST);
+				J1939_armTimer(session->instance, &session->timer, J1939_FD_TP_BAM_SEGMENT_GAP, J1939_sendNextFDTPbroadcastSegment, session);
+			} else
+			{
+				J1939_setFDTPsessionState(session, J1939_STATE_TP_RX_PTP_EOM);
+				J1939_cancelTimer(session->instance, &session->timer);
+			}
+			break;
+
+		case J1939_TP_TYPE_CTS:
+			// The window starts at the next expected segment, also after a gap
+			segments = session->total_number_of_segments - session->next_segment + 1U;
+			if(segments > J1939_FD_TP_RX_MAX_SEGMENTS_IN_CTS) segments = J1939_FD_TP_RX_MAX_SEGMENTS_IN_CTS;
+			if(segments > session->max_segments_in_CTS) segments = session->max_segments_in_CTS;
+
+			session->last_segment = session->next_segment + segments - 1U;
+
+			data[0] = J1939_FD_SESSION_BYTE(session->session_number, J1939_FD_CONTROL_CTS);
+			data[1] = (uint8_t)segments;
+			J1939_SET_24_BITS(&data[2], session->next_segment);
+
+			J1939_setFDTPsessionState(session, J1939_STATE_TP_RX_PTP_DATA);
+			J1939_TRACE_FD_SESSION(session, J1939_TRACE_CTS_SENT, data[1]);
+			J1939_startFDTPpeerWait(session);
+			J1939_armTimer(session->instance, &session->timer, J1939_MESSAGE_DATA_TIMEOUT, J1939_FDTPsessionTimeout, session);
+			break;
+
+		default:
+			return;
+	}
+
+	J1939_sendFDFrame(session->instance, J1939_getFDTPid(session->instance, J1939_FD_CONNECTION_MANAGEMENT, peerAddress),
+					  data, J1939_FD_TP_CM_LENGTH);
+}
+
+/**
+ * @brief	This function is used to send the FD transport protocol abort message without an opened session.
+ * @param	instance - A pointer to the instance.
+ * @param	destinationAddress - ECU address to send the message to.
+ * @param	sessionNumber - The session number.
+ * @param	PGN - A PGN of the multi-segment message.
+ * @param	abortReason - The abort reason.
+ * @retval	None.
+ */
+void J1939_sendFDTP_abort(J1939_instance* instance, uint8_t destinationAddress, uint8_t sessionNumber, uint32_t PGN,
+						  J1939_abortReasons abortReason)
+{
+	uint8_t data[J1939_FD_TP_CM_LENGTH];
+
+	for(uint8_t i = 0U; i < J1939_FD_TP_CM_LENGTH; i++) data[i] = J1939_RESERVED_BYTE;
+
+	data[0] = J1939_FD_SESSION_BYTE(sessionNumber, J1939_FD_CONTROL_ABORT);
+	data[1] = (uint8_t)abortReason;
+	J1939_SET_24_BITS(&data[8], PGN);
+
+	J1939_sendFDFrame(instance, J1939_getFDTPid(instance, J1939_FD_CONNECTION_MANAGEMENT, destinationAddress), data, J1939_FD_TP_CM_LENGTH);
+}
+
+/**
+ * @brief 	This function is used to read FD transport protocol data transfer messages. The segments are
+ * 			accepted in order, a segment after a gap is dropped and the gap is requested again.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the received message.
+ * @param	data - A pointer to the receiving data.
+ * @param	length - The number of data bytes.
+ * @param	session - A pointer to store the session of the message. NULL if there is no session.
+ * @retval	J1939 status. J1939_STATUS_CTS - the next CTS must be sent, J1939_STATUS_DATA_FINISHED - the broadcast
+ * 			message has been received, J1939_ERROR_MISSING_PACKAGES - lost segments can't be received.
+ */
+J1939_status J1939_readFDTP_dataTransfer(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t length,
+										 J1939_FDTP_session** session)
+{
+	J1939_status status = J1939_STATUS_DATA_CONTINUE;
+	uint8_t broadcast = (J1939_GET_PDU_SPECIFIC(canId) == J1939_BROADCAST_ADDRESS) ? 1U : 0U;
+	J1939_FDTP_session* currentSession;
+	uint16_t segment, offset, segmentBytes;
+
+	*session = NULL;
+
+	// The header is read only from a segment which holds it
+	if(length <= J1939_FD_TP_DT_HEADER) return J1939_NO_STATUS;
+
+	currentSession	= J1939_getFDTPsession(instance, (broadcast == 1U) ? J1939_FD_TP_SESSION_BAM_RX : J1939_FD_TP_SESSION_PTP_RX,
+										   J1939_GET_SOURCE_ADDRESS(canId), J1939_FD_GET_SESSION_NUMBER(data));
+	segment			= (uint16_t)J1939_GET_24_BITS(&data[1]);
+
+	*session = currentSession;
+
+	if(currentSession == NULL) return J1939_NO_STATUS;
+
+	if(currentSession->state != ((broadcast == 1U) ? J1939_STATE_TP_RX_BROADCAST : J1939_STATE_TP_RX_PTP_DATA)) return J1939_NO_STATUS;
+
+	J1939_stopFDTPpeerWait(currentSession);
+
+	offset			= (uint16_t)((segment - 1U) * J1939_FD_TP_SEGMENT_SIZE);
+	segmentBytes	= currentSession->message_size - offset;
+	if(segmentBytes > J1939_FD_TP_SEGMENT_SIZE) segmentBytes = J1939_FD_TP_SEGMENT_SIZE;
+
+	if(segment != currentSession->next_segment)
+	{
+		// A repeated segment is ignored, a segment after a gap is dropped
+		if((segment > currentSession->next_segment) && (segment <= currentSession->total_number_of_segments))
+		{
+			if(broadcast == 1U)
+			{
+				// The lost segments of the broadcast message can't be requested
+				J1939_countSessionAbort(instance, J1939_STATISTICS_FD_TP_RX, J1939_REASON_RETRANSMIT_LIMIT, 0U);
+				status = J1939_ERROR_MISSING_PACKAGES;
+			} else if(segment >= currentSession->last_segment)
+			{
+				status = J1939_prepareFDTPretransmission(currentSession);
+			}
+		}
+	} else if((length - J1939_FD_TP_DT_HEADER) >= segmentBytes)
+	{
+		J1939_portCopy(&currentSession->data[offset], &data[J1939_FD_TP_DT_HEADER], segmentBytes);
+		currentSession->next_segment++;
+
+		if(currentSession->next_segment > currentSession->total_number_of_segments)
+		{
+			if(broadcast == 1U)
+			{
+				J1939_countSessionCompleted(instance, J1939_STATISTICS_FD_TP_RX, currentSession->open_time);
+				J1939_TRACE_FD_SESSION(currentSession, J1939_TRACE_SESSION_COMPLETE, J1939_STATISTICS_FD_TP_RX);
+				status = J1939_STATUS_DATA_FINISHED;
+			} else
+			{
+				// The message is complete when the end of message status comes
+				J1939_setFDTPsessionState(currentSession, J1939_STATE_TP_RX_PTP_EOM);
+			}
+		} else if((broadcast == 0U) && (segment == currentSession->last_segment))
+		{
+			currentSession->retransmissions = 0U;
+			status = J1939_STATUS_CTS;
+		}
+	}
+
+	if(status == J1939_STATUS_DATA_CONTINUE)
+	{
+		J1939_armTimer(instance, &currentSession->timer, J1939_MESSAGE_DATA_TIMEOUT, J1939_FDTPsessionTimeout, currentSession);
+	} else if(status != J1939_STATUS_CTS)
+	{
+		J1939_cancelTimer(instance, &currentSession->timer);
+	}
+
+	return status;
+}
+
+/**
+ * @brief	This function is used to send the segments of the CTS window and the end of message status after
+ * 			the last one, limited by the free TX slots of the CAN controller. A broadcast session sends one
+ * 			segment per J1939_FD_TP_BAM_SEGMENT_GAP.
+ * @param	session - A pointer to the FD.TP session.
+ * @param	sentSegments - A pointer to store the number of queued segments.
+ * @return	J1939 status. J1939_STATUS_CTS if the window is over and the next CTS must be waited,
+ * 			J1939_STATUS_DATA_FINISHED if the last segment has been sent.
+ */
+J1939_status J1939_sendFDTP_dataTransferBurst(J1939_FDTP_session* session, uint8_t* sentSegments)
+{
+	J1939_instance* instance = session->instance;
+	uint32_t canId = J1939_getFDTPid(instance, J1939_FD_DATA_TRANSFER, session->destination_address);
+	uint8_t budget = instance->get_free_tx_slots(instance->channel);
+	uint8_t segments = 0U;
+	uint8_t data[J1939_FD_TP_CM_LENGTH];
+
+	*sentSegments = 0U;
+
+	if(session->state == J1939_STATE_TP_TX_BROADCAST)
+	{
+		if((J1939_portGetTime() - session->segment_time) < J1939_FD_TP_BAM_SEGMENT_GAP) budget = 0U;
+		if(budget > 1U) budget = 1U;
+	} else if(session->state != J1939_STATE_TP_TX_PTP_DATA)
+	{
+		// The window is over, the next segments must be requested by CTS
+		return (session->CTS_available_message == 1U) ? J1939_STATUS_CTS : J1939_STATUS_DATA_CONTINUE;
+	}
+
+	while((segments < budget) && (session->next_segment <= session->last_segment))
+	{
+		J1939_sendFDTP_segment(session, canId);
+		segments++;
+	}
+
+	*sentSegments = segments;
+
+	if(session->next_segment <= session->last_segment) return J1939_STATUS_DATA_CONTINUE;
+
+	if(session->state == J1939_STATE_TP_TX_BROADCAST) return J1939_STATUS_DATA_FINISHED;
+
+	if(session->last_segment < session->total_number_of_segments)
+	{
+		session->CTS_available_message = 1U;
+		J1939_setFDTPsessionState(session, J1939_STATE_TP_TX_PTP_CTS);
+	} else
+	{
+		// The end of message status follows the last segment in the same burst if there is a free TX slot
+		if(segments >= budget) return J1939_STATUS_DATA_CONTINUE;
+
+		for(uint8_t i = 0U; i < J1939_FD_TP_CM_LENGTH; i++) data[i] = J1939_RESERVED_BYTE;
+
+		data[0] = J1939_FD_SESSION_BYTE(session->session_number, J1939_FD_CONTROL_EOM_STATUS);
+		J1939_SET_24_BITS(&data[1], session->message_size);
+		J1939_SET_24_BITS(&data[4], session->total_number_of_segments);
+		J1939_SET_24_BITS(&data[8], session->PGN_of_the_multipacket_message);
+
+		if(J1939_sendFDFrame(instance, J1939_getFDTPid(instance, J1939_FD_CONNECTION_MANAGEMENT, session->destination_address),
+							 data, J1939_FD_TP_CM_LENGTH) != J1939_PORT_FRAME_QUEUED) return J1939_STATUS_DATA_CONTINUE;
+
+		// CTS is still accepted to send the segments lost by the receiver again
+		session->CTS_available_message = 1U;
+		J1939_setFDTPsessionState(session, J1939_STATE_TP_TX_PTP_EOM);
+	}
+
+	// The next CTS or the end of message acknowledgment is expected within T3
+	J1939_startFDTPpeerWait(session);
+	J1939_armTimer(instance, &session->timer, J1939_MESSAGE_CM_TIMEOUT, J1939_FDTPsessionTimeout, session);
+
+	return (session->state == J1939_STATE_TP_TX_PTP_EOM) ? J1939_STATUS_DATA_FINISHED : J1939_STATUS_CTS;
+}
+
+/**
+ * @brief	This function is used to continue the CTS windows of all TX sessions which have been limited
+ * 			by the free TX slots. It is called when TX slots of the CAN controller are released.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of queued segments.
+ */
+uint16_t J1939_sendFDTPpendingSegments(J1939_instance* instance)
+{
+	J1939_FDTP_session* txSessions = instance->FDTP.tx_sessions;
+	uint16_t segments = 0U;
+	uint8_t sentSegments;
+
+	for(uint8_t slot = 0U; slot < J1939_MAX_FD_TP_TX_SESSIONS; slot++)
+	{
+		if((txSessions[slot].in_use == 1U) && (txSessions[slot].state == J1939_STATE_TP_TX_PTP_DATA))
+		{
+			J1939_sendFDTP_dataTransferBurst(&txSessions[slot], &sentSegments);
+			segments += sentSegments;
+		}
+	}
+
+	return segments;
+}
+
+/**
+ * @brief	This function used to open an FD.TP TX session. The data isn't copied, it mustn't be changed
+ * 			until the session is closed.
+ * @param	instance - A pointer to the instance.
+ * @param 	data - A pointer to the sending data.
+ * @param 	dataSize - A size of the sending data, from 1 to J1939_FD_TP_MAX_MESSAGE_SIZE.
+ * @param 	PGN - A PGN of the multi-segment message.
+ * @param 	destinationAddress - ECU address to send data to. 255 - broadcast.
+ * @retval	A pointer to the TX session. NULL if there is no free session or the size is wrong.
+ */
+J1939_FDTP_session* J1939_fillFDTPstructures(J1939_instance* instance, uint8_t* data, uint16_t dataSize, uint32_t PGN,
+											 uint8_t destinationAddress)
+{
+	J1939_FDtransport* FDTP = &instance->FDTP;
+	J1939_FDTP_session* session = NULL;
+	uint8_t sessionNumber;
+
+	if((dataSize == 0U) || (dataSize > J1939_FD_TP_MAX_MESSAGE_SIZE) || (data == NULL)) return NULL;
+
+	// The session number mustn't be used by another TX session
+	for(uint8_t attempt = 0U; attempt < J1939_FD_TP_SESSION_NUMBERS; attempt++)
+	{
+		sessionNumber = FDTP->next_session_number;
+		FDTP->next_session_number = (FDTP->next_session_number + 1U) % J1939_FD_TP_SESSION_NUMBERS;
+
+		if(J1939_getFDTPsession(instance, J1939_FD_TP_SESSION_TX, destinationAddress, sessionNumber) == NULL)
+		{
+			session = J1939_openFDTPsession(instance, J1939_FD_TP_SESSION_TX, J1939_getCurrentECUAddress(instance), destinationAddress,
+											sessionNumber, PGN);
+			break;
+		}
+	}
+
+	if(session == NULL)
+	{
+		instance->statistics.sessions[J1939_STATISTICS_FD_TP_TX].busy++;
+		return NULL;
+	}
+
+	session->message_size				= dataSize;
+	session->total_number_of_segments	= (uint16_t)((dataSize + (J1939_FD_TP_SEGMENT_SIZE - 1U)) / J1939_FD_TP_SEGMENT_SIZE);
+	session->max_segments_in_CTS		= J1939_NO_LIMIT_SEGMENTS_IN_CTS;
+	session->next_segment				= 1U;
+	session->data						= data;
+
+	if(destinationAddress == J1939_BROADCAST_ADDRESS)
+	{
+		// All segments of the broadcast message make one window
+		session->last_segment = session->total_number_of_segments;
+		J1939_setFDTPsessionState(session, J1939_STATE_TP_TX_BROADCAST);
+	} else
+	{
+		J1939_setFDTPsessionState(session, J1939_STATE_TP_TX_PTP_CTS);
+	}
+
+	return session;
+}
+
+/**
+ * @brief	This function is used to free the receive buffer of the session and to close it.
+ * @param	session - A pointer to the FD.TP session.
+ * @retval	None.
+ */
+void J1939_clearFDTPstructures(J1939_FDTP_session* session)
+{
+	J1939_FDTPsessionTypes type = session->type;
+	J1939_instance* instance = session->instance;
+
+	J1939_cancelTimer(instance, &session->timer);
+
+	if(session->memory_allocated == 1U)
+	{
+		J1939_poolFree(instance, session->data);
+		J1939_countBufferUsage(instance, session->message_size, 0U);
+		J1939_TRACE(instance, J1939_TRACE_BUFFER_RELEASED, 0U, session->message_size, session->source_address, session->destination_address);
+	}
+
+	if(session->in_use == 1U)
+	{
+		J1939_countSessionClosed(instance, J1939_GET_STATISTICS_TYPE(session));
+		J1939_TRACE_FD_SESSION(session, J1939_TRACE_SESSION_CLOSE, J1939_GET_STATISTICS_TYPE(session));
+	}
+
+	*session = (J1939_FDTP_session){0};
+	session->type		= type;
+	session->instance	= instance;
+}
+
+/**
+ * @brief 	This function is used to hand the message of an FD.TP session which has returned J1939_STATUS_DATA_FINISHED
+ * 			to the message queue. The buffer is taken from the session, so it can be closed at once.
+ * 			Called by the task of the instance only.
+ * @param	session - A pointer to the FD.TP session.
+ * @retval	J1939_QUEUE_OK, J1939_QUEUE_FULL or J1939_QUEUE_INVALID. The session keeps the buffer if not J1939_QUEUE_OK.
+ */
+uint8_t J1939_queueReceivedFDTPmessage(J1939_FDTP_session* session)
+{
+	uint8_t status;
+
+	if(session->memory_allocated == 0U) return J1939_QUEUE_INVALID;
+
+	status = J1939_queueMessage(session->instance, session->PGN_of_the_multipacket_message, session->source_address,
+								session->destination_address, session->data, session->message_size);
+
+	if(status == J1939_QUEUE_OK)
+	{
+		session->data				= NULL;
+		session->memory_allocated	= 0U;
+	}
+
+	return status;
+}
+
+/**
+ * @brief 	This function is used to set the abort reason sent by J1939_sendFDTP_connectionManagement.
+ * @param	session - A pointer to the FD.TP session.
+ * @param 	abortReason - The abort reason.
+ * @retval	None.
+ */
+void J1939_setFDTPabortReason(J1939_FDTP_session* session, J1939_abortReasons abortReason)
+{
+	session->abort_reason = abortReason;
+}
+
+/**
+ * @brief 	This function is used to set the function called when the library closes an FD.TP session itself.
+ * @param	instance - A pointer to the instance.
+ * @param	callback - A pointer to the function. NULL - no function.
+ * @retval	None.
+ */
+void J1939_setFDTPcallback(J1939_instance* instance, J1939_FDTPcallback callback)
+{
+	instance->FDTP.callback = callback;
+}
+
+/**
+ * @brief 	This function is used to fill the frame up to the nearest valid CAN FD length with J1939_FD_PADDING_BYTE.
+ * @param	data - A pointer to the frame data, J1939_PORT_FD_MAX_LENGTH bytes.
+ * @param	size - The number of meaningful bytes.
+ * @retval	The CAN FD length of the frame.
+ */
+uint8_t J1939_padFDframe(uint8_t* data, uint8_t size)
+{
+	static const uint8_t lengths[] = {8U, 12U, 16U, 20U, 24U, 32U, 48U, J1939_PORT_FD_MAX_LENGTH};
+	uint8_t length = J1939_PORT_FD_MAX_LENGTH;
+
+	if(size <= lengths[0]) return size;
+
+	for(uint8_t i = 0U; i < sizeof(lengths); i++)
+	{
+		if(size <= lengths[i])
+		{
+			length = lengths[i];
+			break;
+		}
+	}
+
+	for(uint8_t i = size; i < length; i++) data[i] = J1939_FD_PADDING_BYTE;
+
+	return length;
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to get the session slots of the type.
+ * @param	instance - A pointer to the instance.
+ * @param	type - A type of the sessions.
+ * @param	numberOfSessions - A pointer to store the number of session slots.
+ * @retval	A pointer to the first session slot.
+ */
+static J1939_FDTP_session* J1939_getFDTPsessions(J1939_instance* instance, J1939_FDTPsessionTypes type, uint8_t* numberOfSessions)
+{
+	switch(type)
+	{
+		case J1939_FD_TP_SESSION_BAM_RX:
+			*numberOfSessions = J1939_MAX_FD_TP_BAM_RX_SESSIONS;
+			return instance->FDTP.bam_rx_sessions;
+
+		case J1939_FD_TP_SESSION_PTP_RX:
+			*numberOfSessions = J1939_MAX_FD_TP_PTP_RX_SESSIONS;
+			return instance->FDTP.ptp_rx_sessions;
+
+		default:
+			*numberOfSessions = J1939_MAX_FD_TP_TX_SESSIONS;
+			return instance->FDTP.tx_sessions;
+	}
+}
+
+/**
+ * @brief 	This function is used to get the address of the ECU on the other side of the session.
+ * @param	session - A pointer to the FD.TP session.
+ * @retval	The peer address.
+ */
+static uint8_t J1939_getFDTPpeerAddress(J1939_FDTP_session* session)
+{
+	return (session->type == J1939_FD_TP_SESSION_TX) ? session->destination_address : session->source_address;
+}
+
+/**
+ * @brief 	This function is used to get the opened session with the peer. There are a few session slots
+ * 			of each type, so they are searched linearly.
+ * @param	instance - A pointer to the instance.
+ * @param	type - A type of the session.
+ * @param	peerAddress - The address of the ECU on the other side of the session.
+ * @param	sessionNumber - The session number.
+ * @retval	A pointer to the session. NULL if there is no session.
+ */
+static J1939_FDTP_session* J1939_getFDTPsession(J1939_instance* instance, J1939_FDTPsessionTypes type, uint8_t peerAddress,
+												uint8_t sessionNumber)
+{
+	uint8_t numberOfSessions;
+	J1939_FDTP_session* sessions = J1939_getFDTPsessions(instance, type, &numberOfSessions);
+
+	for(uint8_t slot = 0U; slot < numberOfSessions; slot++)
+	{
+		if((sessions[slot].in_use == 1U) && (sessions[slot].session_number == sessionNumber) && \
+		   (J1939_getFDTPpeerAddress(&sessions[slot]) == peerAddress)) return &sessions[slot];
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief 	This function is used to take a free session slot and bind it to the peer.
+ * @param	instance - A pointer to the instance.
+ * @param	type - A type of the session.
+ * @param	sourceAddress - Originator of the multi-segment message.
+ * @param	destinationAddress - Recipient of the multi-segment message.
+ * @param	sessionNumber - The session number.
+ * @param	PGN - A PGN of the multi-segment message.
+ * @retval	A pointer to the session. NULL if there is no free session.
+ */
+static J1939_FDTP_session* J1939_openFDTPsession(J1939_instance* instance, J1939_FDTPsessionTypes type, uint8_t sourceAddress,
+												 uint8_t destinationAddress, uint8_t sessionNumber, uint32_t PGN)
+{
+	uint8_t numberOfSessions;
+	J1939_FDTP_session* sessions = J1939_getFDTPsessions(instance, type, &numberOfSessions);
+	J1939_FDTP_session* session = NULL;
+
+	for(uint8_t slot = 0U; slot < numberOfSessions; slot++)
+	{
+		if(sessions[slot].in_use == 0U)
+		{
+			session = &sessions[slot];
+
+			*session = (J1939_FDTP_session){0};
+			session->type					= type;
+			session->source_address			= sourceAddress;
+			session->destination_address	= destinationAddress;
+			session->session_number			= sessionNumber;
+			session->in_use					= 1U;
+			session->instance				= instance;
+			session->open_time				= J1939_portGetTime();
+			session->PGN_of_the_multipacket_message = PGN;
+
+			J1939_countSessionOpened(instance, J1939_GET_STATISTICS_TYPE(session));
+			J1939_TRACE_FD_SESSION(session, J1939_TRACE_SESSION_OPEN, J1939_GET_STATISTICS_TYPE(session));
+			break;
+		}
+	}
+
+	return session;
+}
+
+/**
+ * @brief 	This function is used to read the parameters of BAM and RTS messages and to allocate memory
+ * 			for the multi-segment message.
+ * @param	session - A pointer to the FD.TP session.
+ * @param	data - A pointer to the receiving data.
+ * @retval	J1939 status.
+ */
+static J1939_status J1939_readFDTP_multipacketParameters(J1939_FDTP_session* session, const uint8_t* data)
+{
+	J1939_status status = (session->type == J1939_FD_TP_SESSION_BAM_RX) ? J1939_STATUS_GOT_BAM_MESSAGE : J1939_STATUS_GOT_RTS_MESSAGE;
+	uint32_t messageSize = J1939_GET_24_BITS(&data[1]);
+
+	session->next_segment			= 1U;
+	session->max_segments_in_CTS	= (data[7] == 0U) ? J1939_NO_LIMIT_SEGMENTS_IN_CTS : data[7];
+
+	if((messageSize == 0U) || (messageSize > J1939_FD_TP_MAX_MESSAGE_SIZE))
+	{
+		status = J1939_ERROR_TOO_BIG_MESSAGE;
+
+		// The peer-to-peer session is counted when it is aborted, the broadcast one isn't aborted
+		if(session->type == J1939_FD_TP_SESSION_BAM_RX)
+		{
+			J1939_countSessionAbort(session->instance, J1939_STATISTICS_FD_TP_RX, J1939_REASON_TOO_BIG_MESSAGE, 0U);
+		}
+
+		return status;
+	}
+
+	session->message_size				= (uint16_t)messageSize;
+	session->total_number_of_segments	= (uint16_t)((messageSize + (J1939_FD_TP_SEGMENT_SIZE - 1U)) / J1939_FD_TP_SEGMENT_SIZE);
+	session->last_segment				= session->total_number_of_segments;
+
+	// Memory allocation for the message from the buffer pool, the buffers of the consumed messages come back first
+	J1939_reclaimMessages(session->instance);
+	session->data = (uint8_t*)J1939_poolAllocate(session->instance, session->message_size);
+
+	if(session->data == NULL)
+	{
+		status = J1939_ERROR_MEMORY_ALLOCATION;
+		session->instance->statistics.sessions[J1939_STATISTICS_FD_TP_RX].allocation_failures++;
+		J1939_TRACE(session->instance, J1939_TRACE_BUFFER_NOT_ALLOCATED, 0U, session->message_size,
+					session->source_address, session->destination_address);
+
+		if(session->type == J1939_FD_TP_SESSION_BAM_RX)
+		{
+			J1939_countSessionAbort(session->instance, J1939_STATISTICS_FD_TP_RX, J1939_REASON_MEMORY_ALLOCATION_ERROR, 0U);
+		}
+	} else
+	{
+		session->memory_allocated = 1U;
+		J1939_countBufferUsage(session->instance, session->message_size, 1U);
+		J1939_TRACE(session->instance, J1939_TRACE_BUFFER_ALLOCATED, 0U, session->message_size,
+					session->source_address, session->destination_address);
+	}
+
+	return status;
+}
+
+/**
+ * @brief 	This function is used to build the CAN ID of the FD.TP messages.
+ * @param	instance - A pointer to the instance.
+ * @param	PDUformat - J1939_FD_CONNECTION_MANAGEMENT or J1939_FD_DATA_TRANSFER.
+ * @param	destinationAddress - ECU address to send the message to.
+ * @retval	The CAN ID.
+ */
+static uint32_t J1939_getFDTPid(J1939_instance* instance, uint8_t PDUformat, uint8_t destinationAddress)
+{
+	// FD.TP frames are sent with the priority of TP
+	return (((uint32_t)instance->TP.priority << J1939_PGN_PRIOTITY_POS) | ((uint32_t)PDUformat << J1939_PDU_FORMAT_POS) | \
+			((uint32_t)destinationAddress << J1939_PDU_SPECIFIC_POS) | J1939_getCurrentECUAddress(instance));
+}
+
+/**
+ * @brief	This function is used to send the next segment of the message.
+ * @param	session - A pointer to the FD.TP session.
+ * @param	canId - The CAN ID of the data transfer segments.
+ * @return	None.
+ */
+static void J1939_sendFDTP_segment(J1939_FDTP_session* session, uint32_t canId)
+{
+	uint16_t offset = (uint16_t)((session->next_segment - 1U) * J1939_FD_TP_SEGMENT_SIZE);
+	uint16_t segmentBytes = session->message_size - offset;
+	uint8_t data[J1939_PORT_FD_MAX_LENGTH];
+
+	if(segmentBytes > J1939_FD_TP_SEGMENT_SIZE) segmentBytes = J1939_FD_TP_SEGMENT_SIZE;
+
+	data[0] = J1939_FD_SESSION_BYTE(session->session_number, 0U);
+	J1939_SET_24_BITS(&data[1], session->next_segment);
+	J1939_portCopy(&data[J1939_FD_TP_DT_HEADER], &session->data[offset], segmentBytes);
+
+	J1939_sendFDFrame(session->instance, canId, data, J1939_padFDframe(data, (uint8_t)(J1939_FD_TP_DT_HEADER + segmentBytes)));
+
+	session->next_segment++;
+	session->segment_time = J1939_portGetTime();
+}
+
+/**
+ * @brief	This function is used to request the segments from the first lost one again.
+ * @param	session - A pointer to the FD.TP session.
+ * @return	J1939_STATUS_CTS or J1939_ERROR_MISSING_PACKAGES if J1939_TP_MAX_RETRANSMISSIONS of the segment are over.
+ */
+static J1939_status J1939_prepareFDTPretransmission(J1939_FDTP_session* session)
+{
+	// The same segment is requested again a limited number of times
+	if(session->retransmitted_segment != session->next_segment)
+	{
+		session->retransmitted_segment	= session->next_segment;
+		session->retransmissions		= 0U;
+	}
+
+	if(session->retransmissions >= J1939_TP_MAX_RETRANSMISSIONS) return J1939_ERROR_MISSING_PACKAGES;
+
+	session->retransmissions++;
+	session->instance->statistics.sessions[J1939_STATISTICS_FD_TP_RX].retransmitted_packages += \
+		session->last_segment - session->next_segment + 1U;
+
+	return J1939_STATUS_CTS;
+}
+
+/**
+ * @brief	This function is called by the timer wheel when the session has timed out. Lost segments
+ * 			of the window are requested again, otherwise the session is aborted and closed.
+ * @param	context - A pointer to the FD.TP session.
+ * @return	None.
+ */
+static void J1939_FDTPsessionTimeout(void* context)
+{
+	J1939_FDTP_session* session = (J1939_FDTP_session*)context;
+
+	if((session->type == J1939_FD_TP_SESSION_PTP_RX) && (session->state == J1939_STATE_TP_RX_PTP_DATA) && \
+	   (J1939_prepareFDTPretransmission(session) == J1939_STATUS_CTS))
+	{
+		J1939_sendFDTP_connectionManagement(session, J1939_TP_TYPE_CTS);
+		return;
+	}
+
+	J1939_TRACE_FD_SESSION(session, J1939_TRACE_TIMEOUT, session->state);
+
+	if(session->type != J1939_FD_TP_SESSION_BAM_RX)
+	{
+		J1939_sendFDTP_abort(session->instance, J1939_getFDTPpeerAddress(session), session->session_number,
+							 session->PGN_of_the_multipacket_message, J1939_REASON_TIMEOUT);
+	}
+
+	J1939_countSessionAbort(session->instance, J1939_GET_STATISTICS_TYPE(session), J1939_REASON_TIMEOUT, 0U);
+
+	if(session->instance->FDTP.callback != NULL) session->instance->FDTP.callback(session, J1939_ERROR_TIMEOUT);
+
+	J1939_clearFDTPstructures(session);
+}
+
+/**
+ * @brief	This function is called by the timer wheel at the end of the gap between the broadcast segments.
+ * 			It sends the next segment and closes the session after the last one.
+ * @param	context - A pointer to the FD.TP session.
+ * @return	None.
+ */
+static void J1939_sendNextFDTPbroadcastSegment(void* context)
+{
+	J1939_FDTP_session* session = (J1939_FDTP_session*)context;
+	uint8_t sentSegments;
+
+	if(J1939_sendFDTP_dataTransferBurst(session, &sentSegments) == J1939_STATUS_DATA_FINISHED)
+	{
+		J1939_countSessionCompleted(session->instance, J1939_STATISTICS_FD_TP_TX, session->open_time);
+		J1939_TRACE_FD_SESSION(session, J1939_TRACE_SESSION_COMPLETE, J1939_STATISTICS_FD_TP_TX);
+
+		if(session->instance->FDTP.callback != NULL) session->instance->FDTP.callback(session, J1939_STATUS_DATA_FINISHED);
+
+		J1939_clearFDTPstructures(session);
+		return;
+	}
+
+	// Retry at the next tick if the CAN controller had no free TX slot
+	J1939_armTimer(session->instance, &session->timer, (sentSegments > 0U) ? J1939_FD_TP_BAM_SEGMENT_GAP : J1939_TIMER_WHEEL_RESOLUTION,
+				   J1939_sendNextFDTPbroadcastSegment, session);
+}
+
+/**
+ * @brief	This function is used to start timing the wait for CTS or for the segments requested by CTS.
+ * @param	session - A pointer to the FD.TP session.
+ * @return	None.
+ */
+static void J1939_startFDTPpeerWait(J1939_FDTP_session* session)
+{
+	session->wait_time	= J1939_portGetTime();
+	session->waiting	= 1U;
+}
+
+/**
+ * @brief	This function is used to count the CTS round trip when the reply of the peer has come.
+ * @param	session - A pointer to the FD.TP session.
+ * @return	None.
+ */
+static void J1939_stopFDTPpeerWait(J1939_FDTP_session* session)
+{
+	if(session->waiting == 0U) return;
+
+	J1939_countCTSroundTrip(session->instance, J1939_GET_STATISTICS_TYPE(session), session->wait_time);
+	session->waiting = 0U;
+}
+
+/**
+ * @brief	This function is used to change the state of the session.
+ * @param	session - A pointer to the FD.TP session.
+ * @param	state - The new state.
+ * @return	None.
+ */
+static void J1939_setFDTPsessionState(J1939_FDTP_session* session, J1939_states state)
+{
+	session->state = state;
+	J1939_TRACE_FD_SESSION(session, J1939_TRACE_SESSION_STATE, state);
+}
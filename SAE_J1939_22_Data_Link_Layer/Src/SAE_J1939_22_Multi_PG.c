@@ -0,0 +1,239 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_22_Multi_PG.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the SAE J1939-22
+  * 		 multi-PG packing of several parameter groups into one CAN FD frame
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_PGN_PRIOTITY_POS					(26U)
+#define J1939_PDU_FORMAT_POS					(16U)
+#define J1939_PDU_SPECIFIC_POS					(8U)
+#define J1939_PDU2_FORMAT						(240U)
+
+#define J1939_GET_SOURCE_ADDRESS(canId)			((uint8_t)(canId))
+#define J1939_GET_PDU_SPECIFIC(canId)			((uint8_t)((canId) >> J1939_PDU_SPECIFIC_POS))
+#define J1939_GET_PGN_FORMAT(PGN)				((uint8_t)((PGN) >> 8U))
+
+#define J1939_CPGN_MASK							(0x3FFFFUL)
+#define J1939_TF_POS							(18U)
+#define J1939_TOS_POS							(21U)
+#define J1939_GET_CPG_HEADER(data)				(((uint32_t)(data)[2] << 16U) | ((uint32_t)(data)[1] << 8U) | (data)[0])
+
+// The smallest C-PG: the header and one byte
+#define J1939_MULTI_PG_MIN_CPG					(J1939_MULTI_PG_HEADER + 1U)
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static uint8_t J1939_sendMultiPGframe(J1939_multiPGbuffer* buffer);
+static void J1939_multiPGdelayExpired(void* context);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to bind the buffers of the instance. It is called by J1939_initInstance.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initMultiPG(J1939_instance* instance)
+{
+	for(uint8_t i = 0U; i < J1939_MULTI_PG_BUFFERS; i++) instance->multi_PG.buffers[i].instance = instance;
+}
+
+/**
+ * @brief 	This function is used to pack a PGN into the multi-PG frame of its destination. A full frame
+ * 			is sent at once, the others wait up to J1939_MULTI_PG_MAX_DELAY for more C-PGs.
+ * @param	instance - A pointer to the instance.
+ * @param	PGN - The PGN. The destination of a PDU2 PGN is the global address.
+ * @param	priority - The priority from 0 (the highest) to 7.
+ * @param	destinationAddress - ECU address to send data to. 255 - broadcast.
+ * @param	data - A pointer to the data, it is copied.
+ * @param	size - The size of the data, up to J1939_MULTI_PG_MAX_PAYLOAD bytes.
+ * @retval	J1939_MULTI_PG_OK, J1939_MULTI_PG_INVALID or J1939_MULTI_PG_BUSY if a full frame couldn't be queued.
+ */
+uint8_t J1939_sendCPG(J1939_instance* instance, uint32_t PGN, uint8_t priority, uint8_t destinationAddress, const uint8_t* data,
+					  uint8_t size)
+{
+	J1939_multiPGbuffer* buffers = instance->multi_PG.buffers;
+	J1939_multiPGbuffer* buffer = NULL;
+	uint32_t header;
+
+	if((size == 0U) || (size > J1939_MULTI_PG_MAX_PAYLOAD) || (priority > J1939_LOWEST_PRIORITY) || \
+	   ((PGN & ~J1939_CPGN_MASK) != 0U)) return J1939_MULTI_PG_INVALID;
+
+	if(J1939_GET_PGN_FORMAT(PGN) >= J1939_PDU2_FORMAT)
+	{
+		destinationAddress = J1939_BROADCAST_ADDRESS;
+	} else
+	{
+		// The destination of a PDU1 PGN is carried by the multi-PG frame
+		PGN &= ~0xFFUL;
+	}
+
+	for(uint8_t i = 0U; i < J1939_MULTI_PG_BUFFERS; i++)
+	{
+		if((buffers[i].in_use == 1U) && (buffers[i].destination_address == destinationAddress))
+		{
+			buffer = &buffers[i];
+			break;
+		}
+
+		if((buffer == NULL) && (buffers[i].in_use == 0U)) buffer = &buffers[i];
+	}
+
+	if(buffer == NULL)
+	{
+		// All buffers hold other destinations, the fullest frame is sent
+		buffer = &buffers[0];
+
+		for(uint8_t i = 1U; i < J1939_MULTI_PG_BUFFERS; i++)
+		{
+			if(buffers[i].size > buffer->size) buffer = &buffers[i];
+		}
+
+		if(J1939_sendMultiPGframe(buffer) != J1939_PORT_FRAME_QUEUED) return J1939_MULTI_PG_BUSY;
+	} else if((buffer->in_use == 1U) && ((buffer->size + J1939_MULTI_PG_HEADER + size) > J1939_PORT_FD_MAX_LENGTH))
+	{
+		// The C-PG doesn't fit in the frame of its destination
+		if(J1939_sendMultiPGframe(buffer) != J1939_PORT_FRAME_QUEUED) return J1939_MULTI_PG_BUSY;
+	}
+
+	if(buffer->in_use == 0U)
+	{
+		buffer->in_use				= 1U;
+		buffer->destination_address	= destinationAddress;
+		buffer->priority			= priority;
+		buffer->size				= 0U;
+
+		J1939_armTimer(instance, &buffer->timer, J1939_MULTI_PG_MAX_DELAY, J1939_multiPGdelayExpired, buffer);
+	}
+
+	header = PGN | ((uint32_t)J1939_MULTI_PG_TF_NONE << J1939_TF_POS) | ((uint32_t)J1939_MULTI_PG_TOS_NO_ASSURANCE << J1939_TOS_POS);
+
+	buffer->data[buffer->size]		= (uint8_t)header;
+	buffer->data[buffer->size + 1U]	= (uint8_t)(header >> 8U);
+	buffer->data[buffer->size + 2U]	= (uint8_t)(header >> 16U);
+	buffer->data[buffer->size + 3U]	= size;
+	J1939_portCopy(&buffer->data[buffer->size + J1939_MULTI_PG_HEADER], data, size);
+
+	buffer->size += J1939_MULTI_PG_HEADER + size;
+	if(priority < buffer->priority) buffer->priority = priority;
+
+	instance->multi_PG.packed_PGs++;
+
+	// A frame without room for another C-PG is sent at once, a failure is retried by the timer
+	if((J1939_PORT_FD_MAX_LENGTH - buffer->size) < J1939_MULTI_PG_MIN_CPG) J1939_sendMultiPGframe(buffer);
+
+	return J1939_MULTI_PG_OK;
+}
+
+/**
+ * @brief 	This function is used to send all waiting multi-PG frames at once.
+ * @param	instance - A pointer to the instance.
+ * @retval	The number of queued frames.
+ */
+uint8_t J1939_flushMultiPG(J1939_instance* instance)
+{
+	uint8_t frames = 0U;
+
+	for(uint8_t i = 0U; i < J1939_MULTI_PG_BUFFERS; i++)
+	{
+		if((instance->multi_PG.buffers[i].in_use == 1U) && \
+		   (J1939_sendMultiPGframe(&instance->multi_PG.buffers[i]) == J1939_PORT_FRAME_QUEUED)) frames++;
+	}
+
+	return frames;
+}
+
+/**
+ * @brief 	This function is used to pass the C-PGs of a received multi-PG frame to the handlers of their PGNs.
+ * 			Parsing stops at the padding, at an unsupported type of service or trailer and at a C-PG which
+ * 			doesn't fit in the frame.
+ * @param	instance - A pointer to the instance.
+ * @param	canId - The CAN ID of the frame.
+ * @param	data - A pointer to the frame data.
+ * @param	length - The number of data bytes.
+ * @retval	The number of C-PGs passed on.
+ */
+uint8_t J1939_readMultiPG(J1939_instance* instance, uint32_t canId, const uint8_t* data, uint8_t length)
+{
+	uint8_t offset = 0U;
+	uint8_t numberOfPGs = 0U;
+
+	while((offset + J1939_MULTI_PG_HEADER) <= length)
+	{
+		uint32_t header = J1939_GET_CPG_HEADER(&data[offset]);
+		uint8_t size = data[offset + 3U];
+
+		if(((header >> J1939_TOS_POS) != J1939_MULTI_PG_TOS_NO_ASSURANCE) || \
+		   (((header >> J1939_TF_POS) & 0x07U) != J1939_MULTI_PG_TF_NONE) || \
+		   (size == 0U) || ((offset + J1939_MULTI_PG_HEADER + size) > length)) break;
+
+		J1939_dispatchMessage(instance, header & J1939_CPGN_MASK, J1939_GET_SOURCE_ADDRESS(canId), J1939_GET_PDU_SPECIFIC(canId),
+							  &data[offset + J1939_MULTI_PG_HEADER], size);
+
+		offset += J1939_MULTI_PG_HEADER + size;
+		numberOfPGs++;
+	}
+
+	return numberOfPGs;
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to pad the frame of the buffer and to send it. The buffer is freed
+ * 			if the frame has been queued.
+ * @param	buffer - A pointer to the buffer.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+static uint8_t J1939_sendMultiPGframe(J1939_multiPGbuffer* buffer)
+{
+	J1939_instance* instance = buffer->instance;
+	uint32_t canId = ((uint32_t)buffer->priority << J1939_PGN_PRIOTITY_POS) | ((uint32_t)J1939_MULTI_PG << J1939_PDU_FORMAT_POS) | \
+					 ((uint32_t)buffer->destination_address << J1939_PDU_SPECIFIC_POS) | J1939_getCurrentECUAddress(instance);
+	uint8_t status;
+
+	status = J1939_sendFDFrame(instance, canId, buffer->data, J1939_padFDframe(buffer->data, buffer->size));
+	if(status != J1939_PORT_FRAME_QUEUED) return status;
+
+	J1939_cancelTimer(instance, &buffer->timer);
+	buffer->in_use	= 0U;
+	buffer->size	= 0U;
+	instance->multi_PG.frames++;
+
+	return status;
+}
+
+/**
+ * @brief	This function is called by the timer wheel when the first C-PG of the frame has waited
+ * 			J1939_MULTI_PG_MAX_DELAY. The frame is sent, if there is no free TX slot it is retried at the next tick.
+ * @param	context - A pointer to the buffer.
+ * @retval	None.
+ */
+static void J1939_multiPGdelayExpired(void* context)
+{
+	J1939_multiPGbuffer* buffer = (J1939_multiPGbuffer*)context;
+
+	if(J1939_sendMultiPGframe(buffer) != J1939_PORT_FRAME_QUEUED)
+	{
+		J1939_armTimer(buffer->instance, &buffer->timer, J1939_TIMER_WHEEL_RESOLUTION, J1939_multiPGdelayExpired, buffer);
+	}
+}
@@ -0,0 +1,144 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_71_Signals.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the SAE J1939-71 signal decoder and encoder. The
+  * 		 SPNs of a PGN are described by a table of signal definitions
+  * 		 which is compiled once into an extraction plan: the signals are
+  * 		 ordered by their position and grouped into 64-bit words, so a
+  * 		 payload is decoded in one pass with one load per word.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_71_SIGNALS_H
+#define __SAE_J1939_71_SIGNALS_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_Port.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+
+// The start bit of a signal at the 1-based byte and bit position of SAE J1939-71, e.g. 4.1
+#define J1939_SIGNAL_POSITION(byte, bit)		((uint16_t)((((byte) - 1U) * 8U) + ((bit) - 1U)))
+
+#define J1939_SIGNAL_MAX_LENGTH					(32U)		// bits
+
+// Signal definition flags
+#define J1939_SIGNAL_NO_VALIDITY				(0x01U)	// All raw values are valid, e.g. a bit field or an address
+
+// Signal status, the ranges of SAE J1939-71 for the parameters of 2 bits and more
+#define J1939_SIGNAL_VALID						(0U)
+#define J1939_SIGNAL_RESERVED					(1U)	// 0xFB - 0xFD in the most significant byte
+#define J1939_SIGNAL_ERROR						(2U)	// 0xFE in the most significant byte, 10b of 2 bits
+#define J1939_SIGNAL_NOT_AVAILABLE				(3U)	// 0xFF in the most significant byte, all ones below 8 bits
+#define J1939_SIGNAL_MISSING					(4U)	// The payload is too short for the signal
+
+#define J1939_SIGNALS_OK						(0U)
+#define J1939_SIGNALS_INVALID					(1U)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief The definition of a signal (SPN) of a PGN: value = raw * scale + offset.
+ */
+typedef struct
+{
+	uint32_t SPN;									/* Suspect parameter number */
+	uint16_t start_bit;								/* The least significant bit in the payload, see J1939_SIGNAL_POSITION */
+	uint8_t length;									/* The number of bits, 1 to J1939_SIGNAL_MAX_LENGTH */
+	uint8_t flags;									/* J1939_SIGNAL_NO_VALIDITY or 0 */
+	float scale;									/* The resolution, not 0 */
+	float offset;									/* The value of raw 0 */
+} J1939_signalDefinition;
+
+/**
+ * @brief A decoded signal or a signal to encode.
+ */
+typedef struct
+{
+	float value;									/* The physical value, valid with J1939_SIGNAL_VALID */
+	uint32_t raw;									/* The raw value of the payload */
+	uint8_t status;									/* J1939_SIGNAL_VALID ... J1939_SIGNAL_MISSING */
+} J1939_signalValue;
+
+/**
+ * @brief A signal of the extraction plan. The signals of a word are taken from one 64-bit load.
+ */
+typedef struct
+{
+	float scale;									/* The resolution */
+	float inverse_scale;							/* 1 / scale for the encoder */
+	float offset;									/* The value of raw 0 */
+	uint32_t mask;									/* The bits of the signal at bit 0 */
+	uint32_t valid_max;								/* The largest valid raw value */
+	uint32_t error_min;								/* The smallest raw value of the error indicator */
+	uint32_t not_available;							/* The smallest raw value of not available */
+	uint16_t word_byte;								/* The first byte of the word of the signal */
+	uint16_t end_byte;								/* The payload size the signal needs */
+	uint8_t shift;									/* The position of the signal in the word */
+	uint8_t flags;									/* Definition flags and J1939_SIGNAL_NEW_WORD */
+	uint8_t index;									/* The index of the definition and of the value */
+} J1939_compiledSignal;
+
+/**
+ * @brief The extraction plan of a PGN.
+ */
+typedef struct
+{
+	uint32_t PGN;									/* The PGN of the signals */
+	J1939_compiledSignal* signals;					/* The signals ordered by the start bit */
+	uint8_t number_of_signals;						/* The number of signals */
+	uint16_t size;									/* The payload size with all signals */
+} J1939_signalPlan;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to compile the signal definitions of a PGN into an extraction plan.
+ * @param	plan - A pointer to the plan.
+ * @param	PGN - The PGN of the signals.
+ * @param	definitions - A pointer to the signal definitions. The values are stored in the same order.
+ * @param	signals - A pointer to the storage of the compiled signals, numberOfSignals entries.
+ * @param	numberOfSignals - The number of signals, up to 255.
+ * @retval	J1939_SIGNALS_OK or J1939_SIGNALS_INVALID if a definition is wrong.
+ */
+uint8_t J1939_compileSignalPlan(J1939_signalPlan* plan, uint32_t PGN, const J1939_signalDefinition* definitions,
+								J1939_compiledSignal* signals, uint8_t numberOfSignals);
+
+/**
+ * @brief 	This function is used to decode all signals of a payload.
+ * @param	plan - A pointer to the plan of the PGN.
+ * @param	data - A pointer to the payload.
+ * @param	size - The payload size. The signals beyond it are J1939_SIGNAL_MISSING.
+ * @param	values - A pointer to store the signals in the order of the definitions.
+ * @retval	The number of valid signals.
+ */
+uint8_t J1939_decodeSignals(const J1939_signalPlan* plan, const uint8_t* data, uint16_t size, J1939_signalValue* values);
+
+/**
+ * @brief 	This function is used to encode all signals into a payload. The bits without a signal are set to 1.
+ * 			A valid value is rounded to the resolution and limited to the valid range, the other statuses
+ * 			are encoded as the error indicator or not available.
+ * @param	plan - A pointer to the plan of the PGN.
+ * @param	values - A pointer to the signals in the order of the definitions.
+ * @param	data - A pointer to the payload.
+ * @param	size - The payload size. The signals beyond it are skipped.
+ * @retval	The number of encoded signals.
+ */
+uint8_t J1939_encodeSignals(const J1939_signalPlan* plan, const J1939_signalValue* values, uint8_t* data, uint16_t size);
+
+#endif /* __SAE_J1939_71_SIGNALS_H */
@@ -0,0 +1,305 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_71_Signals.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the SAE J1939-71 signal
+  * 		 decoder and encoder
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_71_Signals.h"
+
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_SIGNAL_NEW_WORD					(0x80U)	// The word of the signal must be loaded
+#define J1939_SIGNAL_WORD_SIZE					(8U)	// bytes
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static uint64_t J1939_loadSignalWord(const uint8_t* data, uint16_t byte, uint16_t size);
+static void J1939_storeSignalWord(uint8_t* data, uint16_t byte, uint16_t size, uint64_t word);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to compile the signal definitions of a PGN into an extraction plan.
+ * @param	plan - A pointer to the plan.
+ * @param	PGN - The PGN of the signals.
+ * @param	definitions - A pointer to the signal definitions. The values are stored in the same order.
+ * @param	signals - A pointer to the storage of the compiled signals, numberOfSignals entries.
+ * @param	numberOfSignals - The number of signals, up to 255.
+ * @retval	J1939_SIGNALS_OK or J1939_SIGNALS_INVALID if a definition is wrong.
+ */
+uint8_t J1939_compileSignalPlan(J1939_signalPlan* plan, uint32_t PGN, const J1939_signalDefinition* definitions,
+								J1939_compiledSignal* signals, uint8_t numberOfSignals)
+{
+	uint8_t order[255];
+	uint32_t wordStart = 0U;
+	uint8_t hasWord = 0U;
+
+	plan->PGN				= PGN;
+	plan->signals			= signals;
+	plan->number_of_signals	= 0U;
+	plan->size				= 0U;
+
+	for(uint8_t i = 0U; i < numberOfSignals; i++)
+	{
+		const J1939_signalDefinition* definition = &definitions[i];
+		uint8_t position = i;
+
+		if((definition->length == 0U) || (definition->length > J1939_SIGNAL_MAX_LENGTH) || (definition->scale == 0.0f) || \
+		   (((uint32_t)definition->start_bit + definition->length) > 0xFFFFU)) return J1939_SIGNALS_INVALID;
+
+		// Insertion by the start bit, the plan reads the payload forward
+		while((position > 0U) && (definitions[order[position - 1U]].start_bit > definition->start_bit))
+		{
+			order[position] = order[position - 1U];
+			position--;
+		}
+
+		order[position] = i;
+	}
+
+	for(uint8_t i = 0U; i < numberOfSignals; i++)
+	{
+		const J1939_signalDefinition* definition = &definitions[order[i]];
+		J1939_compiledSignal* signal = &signals[i];
+		uint32_t firstByte = definition->start_bit / 8U;
+		uint32_t lastByte = (definition->start_bit + definition->length - 1U) / 8U;
+		uint8_t length = definition->length;
+
+		signal->scale			= definition->scale;
+		signal->inverse_scale	= 1.0f / definition->scale;
+		signal->offset			= definition->offset;
+		signal->mask			= (length == 32U) ? 0xFFFFFFFFUL : ((1UL << length) - 1U);
+		signal->end_byte		= (uint16_t)(lastByte + 1U);
+		signal->flags			= definition->flags & J1939_SIGNAL_NO_VALIDITY;
+		signal->index			= order[i];
+
+		// A signal which ends in the word of the previous one is taken from the same load
+		if((hasWord == 0U) || (lastByte >= (wordStart + J1939_SIGNAL_WORD_SIZE)))
+		{
+			wordStart		= firstByte;
+			hasWord			= 1U;
+			signal->flags	|= J1939_SIGNAL_NEW_WORD;
+		}
+
+		signal->word_byte	= (uint16_t)wordStart;
+		signal->shift		= (uint8_t)(definition->start_bit - (wordStart * 8U));
+
+		// The ranges of SAE J1939-71 are set by the most significant byte or, below 8 bits, by the top values
+		if(length == 1U) signal->flags |= J1939_SIGNAL_NO_VALIDITY;
+
+		if(length >= 8U)
+		{
+			signal->valid_max		= (0xFBUL << (length - 8U)) - 1U;
+			signal->error_min		= 0xFEUL << (length - 8U);
+			signal->not_available	= 0xFFUL << (length - 8U);
+		} else
+		{
+			signal->valid_max		= signal->mask - 2U;
+			signal->error_min		= signal->mask - 1U;
+			signal->not_available	= signal->mask;
+		}
+
+		if((signal->flags & J1939_SIGNAL_NO_VALIDITY) != 0U) signal->valid_max = signal->mask;
+
+		if(signal->end_byte > plan->size) plan->size = signal->end_byte;
+	}
+
+	plan->number_of_signals = numberOfSignals;
+
+	return J1939_SIGNALS_OK;
+}
+
+/**
+ * @brief 	This function is used to decode all signals of a payload.
+ * @param	plan - A pointer to the plan of the PGN.
+ * @param	data - A pointer to the payload.
+ * @param	size - The payload size. The signals beyond it are J1939_SIGNAL_MISSING.
+ * @param	values - A pointer to store the signals in the order of the definitions.
+ * @retval	The number of valid signals.
+ */
+uint8_t J1939_decodeSignals(const J1939_signalPlan* plan, const uint8_t* data, uint16_t size, J1939_signalValue* values)
+{
+	const J1939_compiledSignal* signal = plan->signals;
+	uint8_t validSignals = 0U;
+	uint64_t word = 0U;
+
+	for(uint8_t i = 0U; i < plan->number_of_signals; i++, signal++)
+	{
+		J1939_signalValue* value = &values[signal->index];
+		uint32_t raw;
+
+		if((signal->flags & J1939_SIGNAL_NEW_WORD) != 0U) word = J1939_loadSignalWord(data, signal->word_byte, size);
+
+		if(signal->end_byte > size)
+		{
+			value->value	= 0.0f;
+			value->raw		= 0U;
+			value->status	= J1939_SIGNAL_MISSING;
+			continue;
+		}
+
+		raw = (uint32_t)(word >> signal->shift) & signal->mask;
+
+		value->raw		= raw;
+		value->value	= ((float)raw * signal->scale) + signal->offset;
+
+		if(raw <= signal->valid_max)
+		{
+			value->status = J1939_SIGNAL_VALID;
+			validSignals++;
+		} else
+		{
+			value->status = (raw >= signal->not_available) ? J1939_SIGNAL_NOT_AVAILABLE : \
+							(raw >= signal->error_min) ? J1939_SIGNAL_ERROR : J1939_SIGNAL_RESERVED;
+		}
+	}
+
+	return validSignals;
+}
+
+/**
+ * @brief 	This function is used to encode all signals into a payload. The bits without a signal are set to 1.
+ * 			A valid value is rounded to the resolution and limited to the valid range, the other statuses
+ * 			are encoded as the error indicator or not available.
+ * @param	plan - A pointer to the plan of the PGN.
+ * @param	values - A pointer to the signals in the order of the definitions.
+ * @param	data - A pointer to the payload.
+ * @param	size - The payload size. The signals beyond it are skipped.
+ * @retval	The number of encoded signals.
+ */
+uint8_t J1939_encodeSignals(const J1939_signalPlan* plan, const J1939_signalValue* values, uint8_t* data, uint16_t size)
+{
+	const J1939_compiledSignal* signal = plan->signals;
+	uint8_t encodedSignals = 0U;
+	uint16_t wordByte = 0U;
+	uint8_t hasWord = 0U;
+	uint64_t word = 0U;
+
+	memset(data, 0xFF, size);
+
+	for(uint8_t i = 0U; i < plan->number_of_signals; i++, signal++)
+	{
+		const J1939_signalValue* value = &values[signal->index];
+		uint32_t raw;
+		float scaled;
+
+		// The word is written back when the next signal needs another one
+		if((signal->flags & J1939_SIGNAL_NEW_WORD) != 0U)
+		{
+			if(hasWord == 1U) J1939_storeSignalWord(data, wordByte, size, word);
+
+			wordByte	= signal->word_byte;
+			word		= J1939_loadSignalWord(data, wordByte, size);
+			hasWord		= 1U;
+		}
+
+		if(signal->end_byte > size) continue;
+
+		if(value->status == J1939_SIGNAL_VALID)
+		{
+			scaled = (value->value - signal->offset) * signal->inverse_scale;
+
+			if(scaled <= 0.0f)
+			{
+				raw = 0U;
+			} else if(scaled >= (float)signal->valid_max)
+			{
+				raw = signal->valid_max;
+			} else
+			{
+				raw = (uint32_t)(scaled + 0.5f);
+				if(raw > signal->valid_max) raw = signal->valid_max;
+			}
+		} else if((value->status == J1939_SIGNAL_ERROR) && ((signal->flags & J1939_SIGNAL_NO_VALIDITY) == 0U))
+		{
+			raw = signal->error_min;
+		} else
+		{
+			raw = signal->mask;
+		}
+
+		word &= ~((uint64_t)signal->mask << signal->shift);
+		word |= (uint64_t)raw << signal->shift;
+		encodedSignals++;
+	}
+
+	if(hasWord == 1U) J1939_storeSignalWord(data, wordByte, size, word);
+
+	return encodedSignals;
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to load the little-endian word of the payload from the given byte.
+ * 			The bytes beyond the payload are read as 0.
+ * @param	data - A pointer to the payload.
+ * @param	byte - The first byte of the word.
+ * @param	size - The payload size.
+ * @retval	The word.
+ */
+static uint64_t J1939_loadSignalWord(const uint8_t* data, uint16_t byte, uint16_t size)
+{
+	uint64_t word = 0U;
+
+	if(((uint32_t)byte + J1939_SIGNAL_WORD_SIZE) <= size)
+	{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+		memcpy(&word, &data[byte], J1939_SIGNAL_WORD_SIZE);
+
+		return word;
+#else
+		size = byte + J1939_SIGNAL_WORD_SIZE;
+#endif
+	}
+
+	for(uint16_t i = size; i > byte; i--) word = (word << 8U) | data[i - 1U];
+
+	return word;
+}
+
+/**
+ * @brief 	This function is used to store the little-endian word into the payload from the given byte.
+ * 			The bytes beyond the payload aren't written.
+ * @param	data - A pointer to the payload.
+ * @param	byte - The first byte of the word.
+ * @param	size - The payload size.
+ * @param	word - The word.
+ * @retval	None.
+ */
+static void J1939_storeSignalWord(uint8_t* data, uint16_t byte, uint16_t size, uint64_t word)
+{
+	if(((uint32_t)byte + J1939_SIGNAL_WORD_SIZE) <= size)
+	{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+		memcpy(&data[byte], &word, J1939_SIGNAL_WORD_SIZE);
+
+		return;
+#else
+		size = byte + J1939_SIGNAL_WORD_SIZE;
+#endif
+	}
+
+	for(uint16_t i = byte; i < size; i++)
+	{
+		data[i] = (uint8_t)word;
+		word >>= 8U;
+	}
+}
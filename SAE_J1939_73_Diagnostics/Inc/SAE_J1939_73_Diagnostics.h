@@ -0,0 +1,240 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_73_Diagnostics.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the SAE J1939-73 diagnostic messages. The DTCs of
+  * 		 the ECU are kept in a table sorted by SPN and FMI, DM1 (active
+  * 		 DTCs) and DM2 (previously active DTCs) are encoded only after the
+  * 		 table or the lamp status has changed and are sent by the cyclic
+  * 		 transmission and the request responder, by a single frame or BAM
+  * 		 as their size requires. The DM1s received from other ECUs update
+  * 		 a DTC table per source address.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_73_DIAGNOSTICS_H
+#define __SAE_J1939_73_DIAGNOSTICS_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_Port.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+
+// The number of DTCs of the ECU, the number of ECUs whose DM1s are kept and the number of DTCs
+// kept per ECU. They can be redefined in the compiler options.
+#ifndef J1939_MAX_DTCS
+#define J1939_MAX_DTCS							(32U)
+#endif
+
+#ifndef J1939_MAX_DM1_SOURCES
+#define J1939_MAX_DM1_SOURCES					(8U)
+#endif
+
+#ifndef J1939_MAX_SOURCE_DTCS
+#define J1939_MAX_SOURCE_DTCS					(16U)
+#endif
+
+#if (J1939_MAX_DTCS == 0U) || (J1939_MAX_DTCS > 254U) || (J1939_MAX_DM1_SOURCES > 254U) || (J1939_MAX_SOURCE_DTCS > 254U)
+	#error "J1939_MAX_DTCS must be from 1 to 254, J1939_MAX_DM1_SOURCES and J1939_MAX_SOURCE_DTCS less than 255"
+#endif
+
+#define J1939_DM1_PGN							(0x00FECAUL)
+#define J1939_DM2_PGN							(0x00FECBUL)
+#define J1939_DM_PRIORITY						(6U)
+
+// The size of DM1 and DM2 with all DTCs of the ECU: the lamp status and 4 bytes per DTC
+#define J1939_DM_MAX_SIZE						(2U + (J1939_MAX_DTCS * 4U))
+
+#define J1939_MAX_SPN							(0x7FFFFUL)
+#define J1939_MAX_FMI							(31U)
+
+// The lamp status byte: the malfunction indicator, red stop, amber warning and protect lamps
+#define J1939_LAMP_MIL(status)					((uint8_t)((status) << 6U))
+#define J1939_LAMP_RSL(status)					((uint8_t)((status) << 4U))
+#define J1939_LAMP_AWL(status)					((uint8_t)((status) << 2U))
+#define J1939_LAMP_PL(status)					((uint8_t)(status))
+
+#define J1939_LAMP_OFF							(0U)
+#define J1939_LAMP_ON							(1U)
+
+// The flash status byte uses the same positions
+#define J1939_FLASH_SLOW						(0U)
+#define J1939_FLASH_FAST						(1U)
+#define J1939_FLASH_OFF							(3U)
+
+#define J1939_DIAGNOSTICS_OK					(0U)
+#define J1939_DIAGNOSTICS_NO_SLOT				(1U)
+#define J1939_DIAGNOSTICS_INVALID				(2U)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A diagnostic trouble code.
+ */
+typedef struct
+{
+	uint32_t SPN;									/* Suspect parameter number, up to J1939_MAX_SPN */
+	uint8_t FMI;									/* Failure mode identifier, up to J1939_MAX_FMI */
+	uint8_t occurrence_count;						/* Transitions to active, 126 at most */
+} J1939_DTC;
+
+/**
+ * @brief A DTC of the ECU.
+ */
+typedef struct
+{
+	uint32_t key;									/* SPN << 5 | FMI, the order of the table */
+	uint8_t occurrence_count;						/* Transitions to active, 126 at most */
+	uint8_t active;									/* 1 - in DM1, 0 - previously active, in DM2 */
+} J1939_DTCentry;
+
+/**
+ * @brief The last DM1 of an ECU.
+ */
+typedef struct
+{
+	uint8_t address;								/* The source address */
+	uint8_t lamp_status;							/* The lamp status byte */
+	uint8_t flash_status;							/* The flash status byte */
+	uint8_t number_of_DTCs;							/* The number of active DTCs */
+	uint32_t time;									/* The time of the last DM1, ms */
+	J1939_DTC DTCs[J1939_MAX_SOURCE_DTCS];			/* The active DTCs in the order of the DM1 */
+} J1939_DM1source;
+
+/**
+ * @brief A function called when a DTC of another ECU becomes active, changes its occurrence count
+ * 		  or stops being active.
+ */
+typedef void (*J1939_DTCchangeCallback)(void* context, uint8_t sourceAddress, const J1939_DTC* DTC, uint8_t active);
+
+/**
+ * @brief Diagnostic message statistics.
+ */
+typedef struct
+{
+	uint32_t encodings;								/* DM1 and DM2 encoded */
+	uint32_t DM1_received;							/* DM1s of other ECUs read */
+	uint32_t DM1_unchanged;							/* DM1s which didn't change the table of their ECU */
+	uint32_t DTC_changes;							/* DTCs of other ECUs added, removed or updated */
+	uint32_t dropped;								/* DTCs and ECUs not kept for the lack of space */
+} J1939_diagnosticsStatistics;
+
+/**
+ * @brief Diagnostic messages of an instance.
+ */
+typedef struct
+{
+	J1939_DTCentry DTCs[J1939_MAX_DTCS];			/* The DTCs of the ECU sorted by the key */
+	uint8_t number_of_DTCs;							/* The number of DTCs in the table */
+	uint8_t number_of_active;						/* The number of active DTCs */
+	uint8_t lamp_status;							/* The lamp status byte of DM1 and DM2 */
+	uint8_t flash_status;							/* The flash status byte of DM1 and DM2 */
+	uint8_t dirty;									/* DM1 and DM2 to encode again */
+	uint16_t DM1_size;								/* The size of the encoded DM1 */
+	uint16_t DM2_size;								/* The size of the encoded DM2 */
+	uint8_t DM1_buffer[J1939_DM_MAX_SIZE];			/* The encoded DM1, sent by the cyclic transmission and the responder */
+	uint8_t DM2_buffer[J1939_DM_MAX_SIZE];			/* The encoded DM2, sent by the responder */
+
+	J1939_DM1source sources[J1939_MAX_DM1_SOURCES];	/* The ECUs whose DM1s have been received */
+	uint8_t number_of_sources;						/* The number of ECUs in the table */
+	J1939_DTCchangeCallback callback;				/* Called with the changes of their DTCs. NULL - none */
+	void* callback_context;							/* A user pointer passed to the callback */
+
+	J1939_diagnosticsStatistics statistics;
+} J1939_diagnostics;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to initialize the diagnostic messages of the instance: no DTCs,
+ * 			the lamps are off and don't flash.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initDiagnostics(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to start sending DM1 periodically and answering the requests for DM1 and DM2.
+ * @param	instance - A pointer to the instance.
+ * @param	DM1period - DM1 transmission period, ms. J1939-73 requires 1000.
+ * @retval	J1939_DIAGNOSTICS_OK or J1939_DIAGNOSTICS_NO_SLOT if there are no free cyclic or requested PGN slots.
+ */
+uint8_t J1939_enableDiagnosticMessages(J1939_instance* instance, uint32_t DM1period);
+
+/**
+ * @brief 	This function is used to set the state of a DTC of the ECU. A DTC which becomes active gets its
+ * 			occurrence count incremented, an inactive one stays in DM2 until the previously active DTCs are
+ * 			cleared. DM1 and DM2 are encoded again only if the state has changed.
+ * @param	instance - A pointer to the instance.
+ * @param	SPN - The SPN.
+ * @param	FMI - The FMI.
+ * @param	active - 1 - the fault is present, 0 - isn't.
+ * @retval	J1939_DIAGNOSTICS_OK, J1939_DIAGNOSTICS_NO_SLOT if the table is full of active DTCs or
+ * 			J1939_DIAGNOSTICS_INVALID.
+ */
+uint8_t J1939_setDTC(J1939_instance* instance, uint32_t SPN, uint8_t FMI, uint8_t active);
+
+/**
+ * @brief 	This function is used to set the lamp status of DM1 and DM2.
+ * @param	instance - A pointer to the instance.
+ * @param	lampStatus - The lamp status byte, e.g. J1939_LAMP_AWL(J1939_LAMP_ON).
+ * @param	flashStatus - The flash status byte, e.g. J1939_LAMP_AWL(J1939_FLASH_SLOW) | J1939_LAMP_MIL(J1939_FLASH_OFF) ...
+ * @retval	None.
+ */
+void J1939_setLampStatus(J1939_instance* instance, uint8_t lampStatus, uint8_t flashStatus);
+
+/**
+ * @brief 	This function is used to clear the previously active DTCs, as DM3 requires. The occurrence
+ * 			counts of the active DTCs are kept.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_clearPreviouslyActiveDTCs(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to start keeping the DM1s of other ECUs.
+ * @param	instance - A pointer to the instance.
+ * @param	callback - A function called with the changes of the DTCs. NULL - none.
+ * @param	context - A user pointer passed to the callback.
+ * @retval	J1939_DIAGNOSTICS_OK or J1939_DIAGNOSTICS_NO_SLOT if there are no free handler slots.
+ */
+uint8_t J1939_enableDM1reception(J1939_instance* instance, J1939_DTCchangeCallback callback, void* context);
+
+/**
+ * @brief 	This function is used to get the last DM1 of an ECU.
+ * @param	instance - A pointer to the instance.
+ * @param	sourceAddress - The address of the ECU.
+ * @retval	A pointer to the DM1 or NULL if no DM1 of the ECU has been received.
+ */
+const J1939_DM1source* J1939_getDM1source(J1939_instance* instance, uint8_t sourceAddress);
+
+/**
+ * @brief 	This function is used to get the diagnostic message statistics.
+ * @param	instance - A pointer to the instance.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getDiagnosticsStatistics(J1939_instance* instance, J1939_diagnosticsStatistics* statistics);
+
+/**
+ * @brief 	This function is used to reset the diagnostic message statistics.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetDiagnosticsStatistics(J1939_instance* instance);
+
+#endif /* __SAE_J1939_73_DIAGNOSTICS_H */
@@ -0,0 +1,532 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_73_Diagnostics.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the SAE J1939-73
+  * 		 diagnostic messages DM1 and DM2. A DTC is found by binary search,
+  * 		 so setting a DTC to its current state costs nothing, and a change
+  * 		 only marks the messages dirty: they are encoded when they are
+  * 		 sent next time.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_DM1_DIRTY							(0x01U)
+#define J1939_DM2_DIRTY							(0x02U)
+
+#define J1939_DTC_SIZE							(4U)
+#define J1939_DM_MIN_SIZE						(8U)
+#define J1939_DM_LAMP_SIZE						(2U)
+#define J1939_FMI_BITS							(5U)
+#define J1939_MAX_OCCURRENCE_COUNT				(126U)	// 127 - not available
+#define J1939_DTC_NOT_FOUND						(0xFFU)
+
+#define J1939_DTC_KEY(SPN, FMI)					(((uint32_t)(SPN) << J1939_FMI_BITS) | (FMI))
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static uint16_t J1939_provideDM(void* context, uint32_t PGN, uint8_t* data, uint16_t maxSize);
+static uint16_t J1939_encodeDM(J1939_diagnostics* diagnostics, uint8_t active, uint8_t* data);
+static void J1939_markDMdirty(J1939_instance* instance, uint8_t dirty);
+static uint8_t J1939_findDTC(J1939_diagnostics* diagnostics, uint32_t key, uint8_t* position);
+static void J1939_readDM1(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+						  const uint8_t* data, uint16_t size);
+static uint8_t J1939_findSourceDTC(const J1939_DTC* DTCs, uint8_t numberOfDTCs, const J1939_DTC* DTC);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to initialize the diagnostic messages of the instance: no DTCs,
+ * 			the lamps are off and don't flash.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_initDiagnostics(J1939_instance* instance)
+{
+	J1939_diagnostics* diagnostics = &instance->diagnostics;
+
+	memset(diagnostics, 0, sizeof(J1939_diagnostics));
+
+	diagnostics->lamp_status	= J1939_LAMP_MIL(J1939_LAMP_OFF) | J1939_LAMP_RSL(J1939_LAMP_OFF) | \
+								  J1939_LAMP_AWL(J1939_LAMP_OFF) | J1939_LAMP_PL(J1939_LAMP_OFF);
+	diagnostics->flash_status	= J1939_LAMP_MIL(J1939_FLASH_OFF) | J1939_LAMP_RSL(J1939_FLASH_OFF) | \
+								  J1939_LAMP_AWL(J1939_FLASH_OFF) | J1939_LAMP_PL(J1939_FLASH_OFF);
+	diagnostics->dirty			= J1939_DM1_DIRTY | J1939_DM2_DIRTY;
+}
+
+/**
+ * @brief 	This function is used to start sending DM1 periodically and answering the requests for DM1 and DM2.
+ * @param	instance - A pointer to the instance.
+ * @param	DM1period - DM1 transmission period, ms. J1939-73 requires 1000.
+ * @retval	J1939_DIAGNOSTICS_OK or J1939_DIAGNOSTICS_NO_SLOT if there are no free cyclic or requested PGN slots.
+ */
+uint8_t J1939_enableDiagnosticMessages(J1939_instance* instance, uint32_t DM1period)
+{
+	J1939_diagnostics* diagnostics = &instance->diagnostics;
+
+	// DM1 is sent by the cyclic transmission and the responder from one buffer, so a change is encoded once
+	if((J1939_registerCyclicPGN(instance, J1939_DM1_PGN, J1939_DM_PRIORITY, DM1period, J1939_CYCLIC_AUTO_PHASE,
+								J1939_provideDM, instance) != J1939_CYCLIC_OK) || \
+	   (J1939_setCyclicBuffer(instance, J1939_DM1_PGN, diagnostics->DM1_buffer, J1939_DM_MAX_SIZE) != J1939_CYCLIC_OK))
+	{
+		J1939_unregisterCyclicPGN(instance, J1939_DM1_PGN);
+		return J1939_DIAGNOSTICS_NO_SLOT;
+	}
+
+	if((J1939_registerRequestedPGN(instance, J1939_DM1_PGN, J1939_DM_PRIORITY, J1939_provideDM, instance) != J1939_REQUEST_OK) || \
+	   (J1939_registerRequestedPGN(instance, J1939_DM2_PGN, J1939_DM_PRIORITY, J1939_provideDM, instance) != J1939_REQUEST_OK))
+	{
+		J1939_unregisterCyclicPGN(instance, J1939_DM1_PGN);
+		J1939_unregisterRequestedPGN(instance, J1939_DM1_PGN);
+		J1939_unregisterRequestedPGN(instance, J1939_DM2_PGN);
+		return J1939_DIAGNOSTICS_NO_SLOT;
+	}
+
+	J1939_setResponseBuffer(instance, J1939_DM1_PGN, diagnostics->DM1_buffer, J1939_DM_MAX_SIZE);
+	J1939_setResponseBuffer(instance, J1939_DM2_PGN, diagnostics->DM2_buffer, J1939_DM_MAX_SIZE);
+
+	return J1939_DIAGNOSTICS_OK;
+}
+
+/**
+ * @brief 	This function is used to set the state of a DTC of the ECU. A DTC which becomes active gets its
+ * 			occurrence count incremented, an inactive one stays in DM2 until the previously active DTCs are
+ * 			cleared. DM1 and DM2 are encoded again only if the state has changed.
+ * @param	instance - A pointer to the instance.
+ * @param	SPN - The SPN.
+ * @param	FMI - The FMI.
+ * @param	active - 1 - the fault is present, 0 - isn't.
+ * @retval	J1939_DIAGNOSTICS_OK, J1939_DIAGNOSTICS_NO_SLOT if the table is full of active DTCs or
+ * 			J1939_DIAGNOSTICS_INVALID.
+ */
+uint8_t J1939_setDTC(J1939_instance* instance, uint32_t SPN, uint8_t FMI, uint8_t active)
+{
+	J1939_diagnostics* diagnostics = &instance->diagnostics;
+	uint32_t key = J1939_DTC_KEY(SPN, FMI);
+	J1939_DTCentry* entry;
+	uint8_t position;
+
+	if((SPN > J1939_MAX_SPN) || (FMI > J1939_MAX_FMI) || (active > 1U)) return J1939_DIAGNOSTICS_INVALID;
+
+	if(J1939_findDTC(diagnostics, key, &position) == 1U)
+	{
+		entry = &diagnostics->DTCs[position];
+
+		if(entry->active == active) return J1939_DIAGNOSTICS_OK;
+
+		entry->active = active;
+
+		if(active == 1U)
+		{
+			if(entry->occurrence_count < J1939_MAX_OCCURRENCE_COUNT) entry->occurrence_count++;
+			diagnostics->number_of_active++;
+		} else
+		{
+			diagnostics->number_of_active--;
+		}
+
+		J1939_markDMdirty(instance, J1939_DM1_DIRTY | J1939_DM2_DIRTY);
+		return J1939_DIAGNOSTICS_OK;
+	}
+
+	// A fault which has never been active isn't a DTC
+	if(active == 0U) return J1939_DIAGNOSTICS_OK;
+
+	if(diagnostics->number_of_DTCs == J1939_MAX_DTCS)
+	{
+		uint8_t evicted = 0U;
+
+		// A previously active DTC gives its place to the active one
+		if(diagnostics->number_of_active == J1939_MAX_DTCS) return J1939_DIAGNOSTICS_NO_SLOT;
+
+		while(diagnostics->DTCs[evicted].active == 1U) evicted++;
+
+		memmove(&diagnostics->DTCs[evicted], &diagnostics->DTCs[evicted + 1U],
+				(size_t)(diagnostics->number_of_DTCs - evicted - 1U) * sizeof(J1939_DTCentry));
+		diagnostics->number_of_DTCs--;
+		if(evicted < position) position--;
+
+		J1939_markDMdirty(instance, J1939_DM2_DIRTY);
+	}
+
+	memmove(&diagnostics->DTCs[position + 1U], &diagnostics->DTCs[position],
+			(size_t)(diagnostics->number_of_DTCs - position) * sizeof(J1939_DTCentry));
+
+	entry = &diagnostics->DTCs[position];
+	entry->key				= key;
+	entry->occurrence_count	= 1U;
+	entry->active			= 1U;
+
+	diagnostics->number_of_DTCs++;
+	diagnostics->number_of_active++;
+
+	J1939_markDMdirty(instance, J1939_DM1_DIRTY);
+	return J1939_DIAGNOSTICS_OK;
+}
+
+/**
+ * @brief 	This function is used to set the lamp status of DM1 and DM2.
+ * @param	instance - A pointer to the instance.
+ * @param	lampStatus - The lamp status byte, e.g. J1939_LAMP_AWL(J1939_LAMP_ON).
+ * @param	flashStatus - The flash status byte, e.g. J1939_LAMP_AWL(J1939_FLASH_SLOW) | J1939_LAMP_MIL(J1939_FLASH_OFF) ...
+ * @retval	None.
+ */
+void J1939_setLampStatus(J1939_instance* instance, uint8_t lampStatus, uint8_t flashStatus)
+{
+	J1939_diagnostics* diagnostics = &instance->diagnostics;
+
+	if((diagnostics->lamp_status == lampStatus) && (diagnostics->flash_status == flashStatus)) return;
+
+	diagnostics->lamp_status	= lampStatus;
+	diagnostics->flash_status	= flashStatus;
+
+	J1939_markDMdirty(instance, J1939_DM1_DIRTY | J1939_DM2_DIRTY);
+}
+
+/**
+ * @brief 	This function is used to clear the previously active DTCs, as DM3 requires. The occurrence
+ * 			counts of the active DTCs are kept.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_clearPreviouslyActiveDTCs(J1939_instance* instance)
+{
+	J1939_diagnostics* diagnostics = &instance->diagnostics;
+	uint8_t kept = 0U;
+
+	if(diagnostics->number_of_DTCs == diagnostics->number_of_active) return;
+
+	for(uint8_t i = 0U; i < diagnostics->number_of_DTCs; i++)
+	{
+		if(diagnostics->DTCs[i].active == 1U) diagnostics->DTCs[kept++] = diagnostics->DTCs[i];
+	}
+
+	diagnostics->number_of_DTCs = kept;
+
+	J1939_markDMdirty(instance, J1939_DM2_DIRTY);
+}
+
+/**
+ * @brief 	This function is used to start keeping the DM1s of other ECUs.
+ * @param	instance - A pointer to the instance.
+ * @param	callback - A function called with the changes of the DTCs. NULL - none.
+ * @param	context - A user pointer passed to the callback.
+ * @retval	J1939_DIAGNOSTICS_OK or J1939_DIAGNOSTICS_NO_SLOT if there are no free handler slots.
+ */
+uint8_t J1939_enableDM1reception(J1939_instance* instance, J1939_DTCchangeCallback callback, void* context)
+{
+	instance->diagnostics.callback			= callback;
+	instance->diagnostics.callback_context	= context;
+
+	// The handler is registered once
+	J1939_unregisterPGNhandler(instance, J1939_DM1_PGN, J1939_readDM1);
+
+	if(J1939_registerPGNhandler(instance, J1939_DM1_PGN, J1939_ANY_ADDRESS, J1939_ANY_ADDRESS,
+								J1939_readDM1, instance) != J1939_DISPATCH_OK) return J1939_DIAGNOSTICS_NO_SLOT;
+
+	return J1939_DIAGNOSTICS_OK;
+}
+
+/**
+ * @brief 	This function is used to get the last DM1 of an ECU.
+ * @param	instance - A pointer to the instance.
+ * @param	sourceAddress - The address of the ECU.
+ * @retval	A pointer to the DM1 or NULL if no DM1 of the ECU has been received.
+ */
+const J1939_DM1source* J1939_getDM1source(J1939_instance* instance, uint8_t sourceAddress)
+{
+	J1939_diagnostics* diagnostics = &instance->diagnostics;
+
+	for(uint8_t i = 0U; i < diagnostics->number_of_sources; i++)
+	{
+		if(diagnostics->sources[i].address == sourceAddress) return &diagnostics->sources[i];
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief 	This function is used to get the diagnostic message statistics.
+ * @param	instance - A pointer to the instance.
+ * @param	statistics - A pointer to store the statistics.
+ * @retval	None.
+ */
+void J1939_getDiagnosticsStatistics(J1939_instance* instance, J1939_diagnosticsStatistics* statistics)
+{
+	*statistics = instance->diagnostics.statistics;
+}
+
+/**
+ * @brief 	This function is used to reset the diagnostic message statistics.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_resetDiagnosticsStatistics(J1939_instance* instance)
+{
+	memset(&instance->diagnostics.statistics, 0, sizeof(J1939_diagnosticsStatistics));
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is the provider of DM1 and DM2 for the cyclic transmission and the responder.
+ * 			The message is encoded into its buffer only if it is dirty, otherwise the buffer is sent as it is.
+ * @param	context - A pointer to the instance.
+ * @param	PGN - J1939_DM1_PGN or J1939_DM2_PGN.
+ * @param	data - A pointer to store the message, the buffer of the message if it is set.
+ * @param	maxSize - The size of data.
+ * @retval	The message size.
+ */
+static uint16_t J1939_provideDM(void* context, uint32_t PGN, uint8_t* data, uint16_t maxSize)
+{
+	J1939_instance* instance = (J1939_instance*)context;
+	J1939_diagnostics* diagnostics = &instance->diagnostics;
+	uint8_t active = (PGN == J1939_DM1_PGN) ? 1U : 0U;
+	uint8_t dirty = (active == 1U) ? J1939_DM1_DIRTY : J1939_DM2_DIRTY;
+	uint8_t* buffer = (active == 1U) ? diagnostics->DM1_buffer : diagnostics->DM2_buffer;
+	uint16_t* size = (active == 1U) ? &diagnostics->DM1_size : &diagnostics->DM2_size;
+
+	// The buffer can't be encoded again while a session sends it, the next call does it
+	if(((diagnostics->dirty & dirty) != 0U) && (J1939_isTXdataInUse(instance, buffer) == 0U))
+	{
+		*size = J1939_encodeDM(diagnostics, active, buffer);
+		diagnostics->dirty &= (uint8_t)~dirty;
+		diagnostics->statistics.encodings++;
+	}
+
+	if(data == buffer) return *size;
+
+	if(*size > maxSize) return 0U;
+
+	memcpy(data, buffer, *size);
+
+	return *size;
+}
+
+/**
+ * @brief 	This function is used to encode DM1 or DM2. A message without DTCs carries a zero DTC,
+ * 			a message shorter than a frame is padded with 0xFF.
+ * @param	diagnostics - A pointer to the diagnostic messages.
+ * @param	active - 1 - DM1, the active DTCs. 0 - DM2, the previously active DTCs.
+ * @param	data - A pointer to store the message, J1939_DM_MAX_SIZE bytes.
+ * @retval	The message size.
+ */
+static uint16_t J1939_encodeDM(J1939_diagnostics* diagnostics, uint8_t active, uint8_t* data)
+{
+	uint16_t size = J1939_DM_LAMP_SIZE;
+
+	data[0] = diagnostics->lamp_status;
+	data[1] = diagnostics->flash_status;
+
+	for(uint8_t i = 0U; i < diagnostics->number_of_DTCs; i++)
+	{
+		const J1939_DTCentry* entry = &diagnostics->DTCs[i];
+		uint32_t SPN = entry->key >> J1939_FMI_BITS;
+
+		if(entry->active != active) continue;
+
+		// SPN bits 0-15, SPN bits 16-18 with the FMI, the conversion method 0 with the occurrence count
+		data[size]		= (uint8_t)SPN;
+		data[size + 1U]	= (uint8_t)(SPN >> 8U);
+		data[size + 2U]	= (uint8_t)(((SPN >> 16U) << J1939_FMI_BITS) | (entry->key & J1939_MAX_FMI));
+		data[size + 3U]	= entry->occurrence_count;
+		size += J1939_DTC_SIZE;
+	}
+
+	if(size == J1939_DM_LAMP_SIZE)
+	{
+		memset(&data[size], 0, J1939_DTC_SIZE);
+		size += J1939_DTC_SIZE;
+	}
+
+	if(size < J1939_DM_MIN_SIZE)
+	{
+		memset(&data[size], 0xFF, J1939_DM_MIN_SIZE - size);
+		size = J1939_DM_MIN_SIZE;
+	}
+
+	return size;
+}
+
+/**
+ * @brief 	This function is used to mark DM1 and DM2 to be encoded again before they are sent.
+ * @param	instance - A pointer to the instance.
+ * @param	dirty - J1939_DM1_DIRTY, J1939_DM2_DIRTY or both.
+ * @retval	None.
+ */
+static void J1939_markDMdirty(J1939_instance* instance, uint8_t dirty)
+{
+	instance->diagnostics.dirty |= dirty;
+
+	if((dirty & J1939_DM1_DIRTY) != 0U) J1939_markResponseDirty(instance, J1939_DM1_PGN);
+	if((dirty & J1939_DM2_DIRTY) != 0U) J1939_markResponseDirty(instance, J1939_DM2_PGN);
+}
+
+/**
+ * @brief 	This function is used to find a DTC of the ECU by binary search.
+ * @param	diagnostics - A pointer to the diagnostic messages.
+ * @param	key - The key of the DTC.
+ * @param	position - A pointer to store the position of the DTC or the position to insert it.
+ * @retval	1 - the DTC is found, 0 - isn't.
+ */
+static uint8_t J1939_findDTC(J1939_diagnostics* diagnostics, uint32_t key, uint8_t* position)
+{
+	uint8_t low = 0U, high = diagnostics->number_of_DTCs;
+
+	while(low < high)
+	{
+		uint8_t middle = (uint8_t)((low + high) / 2U);
+
+		if(diagnostics->DTCs[middle].key < key)
+		{
+			low = middle + 1U;
+		} else
+		{
+			high = middle;
+		}
+	}
+
+	*position = low;
+
+	return ((low < diagnostics->number_of_DTCs) && (diagnostics->DTCs[low].key == key)) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is the handler of the DM1s of other ECUs. A DM1 equal to the last one of its ECU
+ * 			is only compared, otherwise the added, removed and updated DTCs are reported to the callback.
+ * @retval	None.
+ */
+static void J1939_readDM1(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+						  const uint8_t* data, uint16_t size)
+{
+	J1939_instance* instance = (J1939_instance*)context;
+	J1939_diagnostics* diagnostics = &instance->diagnostics;
+	J1939_DTC DTCs[J1939_MAX_SOURCE_DTCS];
+	J1939_DM1source* source = NULL;
+	uint8_t numberOfDTCs = 0U;
+	uint8_t changed;
+
+	(void)PGN;
+	(void)destinationAddress;
+
+	// A DM1 streamed to a TP sink isn't kept
+	if((data == NULL) || (size < (J1939_DM_LAMP_SIZE + J1939_DTC_SIZE))) return;
+
+	diagnostics->statistics.DM1_received++;
+
+	for(uint8_t i = 0U; i < diagnostics->number_of_sources; i++)
+	{
+		if(diagnostics->sources[i].address == sourceAddress)
+		{
+			source = &diagnostics->sources[i];
+			break;
+		}
+	}
+
+	if(source == NULL)
+	{
+		if(diagnostics->number_of_sources == J1939_MAX_DM1_SOURCES)
+		{
+			diagnostics->statistics.dropped++;
+			return;
+		}
+
+		source = &diagnostics->sources[diagnostics->number_of_sources++];
+		memset(source, 0, sizeof(J1939_DM1source));
+		source->address = sourceAddress;
+	}
+
+	for(uint16_t i = J1939_DM_LAMP_SIZE; (i + J1939_DTC_SIZE) <= size; i += J1939_DTC_SIZE)
+	{
+		J1939_DTC DTC;
+
+		DTC.SPN					= (uint32_t)data[i] | ((uint32_t)data[i + 1U] << 8U) | ((uint32_t)(data[i + 2U] >> J1939_FMI_BITS) << 16U);
+		DTC.FMI					= data[i + 2U] & J1939_MAX_FMI;
+		DTC.occurrence_count	= data[i + 3U] & 0x7FU;
+
+		// The zero DTC of a message without faults and the padding aren't DTCs
+		if(((DTC.SPN == 0U) && (DTC.FMI == 0U)) || ((DTC.SPN == J1939_MAX_SPN) && (DTC.FMI == J1939_MAX_FMI))) continue;
+
+		// The DTCs past J1939_MAX_SOURCE_DTCS aren't kept
+		if(numberOfDTCs == J1939_MAX_SOURCE_DTCS)
+		{
+			diagnostics->statistics.dropped++;
+			break;
+		}
+
+		DTCs[numberOfDTCs++] = DTC;
+	}
+
+	source->lamp_status		= data[0];
+	source->flash_status	= data[1];
+	source->time			= J1939_portGetTime();
+
+	// An ECU sends the same DTCs in the same order every second
+	changed = (numberOfDTCs != source->number_of_DTCs) ? 1U : 0U;
+	for(uint8_t i = 0U; (changed == 0U) && (i < numberOfDTCs); i++)
+	{
+		changed = ((DTCs[i].SPN != source->DTCs[i].SPN) || (DTCs[i].FMI != source->DTCs[i].FMI) || \
+				   (DTCs[i].occurrence_count != source->DTCs[i].occurrence_count)) ? 1U : 0U;
+	}
+
+	if(changed == 0U)
+	{
+		diagnostics->statistics.DM1_unchanged++;
+		return;
+	}
+
+	for(uint8_t i = 0U; i < source->number_of_DTCs; i++)
+	{
+		if(J1939_findSourceDTC(DTCs, numberOfDTCs, &source->DTCs[i]) != J1939_DTC_NOT_FOUND) continue;
+
+		diagnostics->statistics.DTC_changes++;
+		if(diagnostics->callback != NULL) diagnostics->callback(diagnostics->callback_context, sourceAddress, &source->DTCs[i], 0U);
+	}
+
+	for(uint8_t i = 0U; i < numberOfDTCs; i++)
+	{
+		uint8_t position = J1939_findSourceDTC(source->DTCs, source->number_of_DTCs, &DTCs[i]);
+
+		if((position != J1939_DTC_NOT_FOUND) && (source->DTCs[position].occurrence_count == DTCs[i].occurrence_count)) continue;
+
+		diagnostics->statistics.DTC_changes++;
+		if(diagnostics->callback != NULL) diagnostics->callback(diagnostics->callback_context, sourceAddress, &DTCs[i], 1U);
+	}
+
+	memcpy(source->DTCs, DTCs, numberOfDTCs * sizeof(J1939_DTC));
+	source->number_of_DTCs = numberOfDTCs;
+}
+
+/**
+ * @brief 	This function is used to find a DTC of another ECU by its SPN and FMI.
+ * @param	DTCs - A pointer to the DTCs.
+ * @param	numberOfDTCs - The number of DTCs.
+ * @param	DTC - A pointer to the DTC to find.
+ * @retval	The position of the DTC or J1939_DTC_NOT_FOUND.
+ */
+static uint8_t J1939_findSourceDTC(const J1939_DTC* DTCs, uint8_t numberOfDTCs, const J1939_DTC* DTC)
+{
+	for(uint8_t i = 0U; i < numberOfDTCs; i++)
+	{
+		if((DTCs[i].SPN == DTC->SPN) && (DTCs[i].FMI == DTC->FMI)) return i;
+	}
+
+	return J1939_DTC_NOT_FOUND;
+}
@@ -18,35 +18,161 @@
 //---------------------------------------------------------------------------
 // Includes
 //---------------------------------------------------------------------------
-#include "stm32f4xx.h"
+#include "SAE_J1939_Port.h"
+#include "SAE_J1939_21_Timer_Wheel.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_REQUEST							(0xEAU)
+#define J1939_ADDRESS_CLAIM						(0xEEU)
+#define J1939_ADDRESS_CLAIMED_PGN				(0x00EE00UL)
+
+#define J1939_NULL_ADDRESS						(254U)
+#define J1939_NM_NUMBER_OF_ADDRESSES			(256U)
+
+// The addresses taken by the ECUs which are arbitrary address capable
+#define J1939_FIRST_ARBITRARY_ADDRESS			(128U)
+#define J1939_LAST_ARBITRARY_ADDRESS			(247U)
+
+// The time after the address claim when the contending claims are expected, ms
+#define J1939_ADDRESS_CLAIM_TIMEOUT				(250U)
+
+// The maximum pseudo-random delay of the cannot claim message, ms
+#define J1939_CANNOT_CLAIM_MAX_DELAY			(153U)
+
+#define J1939_NAME_ARBITRARY_ADDRESS_CAPABLE	(0x8000000000000000ULL)
 
 //---------------------------------------------------------------------------
 // Structures and enumerations
 //---------------------------------------------------------------------------
 
+/**
+ * @brief SAE J1939 address claim states enumeration.
+ */
+typedef enum
+{
+	J1939_ADDRESS_FIXED,				/* The address is set by J1939_setCurrentECUAddress without claiming */
+	J1939_ADDRESS_CLAIMING,				/* The address claim is sent, contending claims are expected */
+	J1939_ADDRESS_CLAIMED,				/* The address is claimed, the ECU can send messages */
+	J1939_ADDRESS_CANNOT_CLAIM			/* There is no address for the ECU, the null address is used */
+} J1939_addressClaimState;
+
+/**
+ * @brief A function called when the address claim state is changed.
+ */
+typedef void (*J1939_addressClaimCallback)(J1939_instance* instance, J1939_addressClaimState state, uint8_t address);
+
 /**
  * @brief SAE J1939 the current ECU information.
  */
 typedef struct
 {
 	uint8_t ECUaddress;
+	uint64_t NAME;							/* The NAME used to claim the address */
+	J1939_addressClaimState state;			/* The address claim state */
+	J1939_timer timer;						/* The claim window, the cannot claim delay or the sending retry */
+	uint8_t claim_pending;					/* 1 - the claim is not sent because the TX slots are busy */
 } J1939_informationECU;
 
+/**
+ * @brief Network management of an instance.
+ */
+typedef struct
+{
+	J1939_informationECU ECU;												/* The current ECU */
+	J1939_addressClaimCallback callback;									/* Called when the claim state is changed */
+	uint64_t address_names[J1939_NM_NUMBER_OF_ADDRESSES];					/* The NAMEs by the claimed addresses */
+	uint8_t claimed_addresses[J1939_NM_NUMBER_OF_ADDRESSES / 8U];			/* Bit per address, set if the NAME is valid */
+} J1939_networkManagement;
+
 //---------------------------------------------------------------------------
 // External function prototypes
 //---------------------------------------------------------------------------
 
 /**
  * @brief 	This function is used to get the current ECU address.
+ * @param	instance - A pointer to the instance.
  * @retval	ECU address.
  */
-uint8_t J1939_getCurrentECUAddress(void);
+uint8_t J1939_getCurrentECUAddress(J1939_instance* instance);
 
 /**
- * @brief 	This function is used to set the current ECU address.
+ * @brief 	This function is used to set the current ECU address. The acceptance filters are made
+ * 			again if the address is changed.
+ * @param	instance - A pointer to the instance.
  * @param	address - The current ECU address.
  * @retval	None.
  */
-void J1939_setCurrentECUAddress(uint8_t address);
+void J1939_setCurrentECUAddress(J1939_instance* instance, uint8_t address);
+
+/**
+ * @brief 	This function is used to claim the address. The address is claimed if no ECU with a NAME of
+ * 			the higher priority claims it in J1939_ADDRESS_CLAIM_TIMEOUT. Addresses from 0 to 127 and from
+ * 			248 to 253 are claimed at once. If the address is lost, an arbitrary address capable ECU
+ * 			claims a free address from 128 to 247, other ECUs send the cannot claim message.
+ * @param	instance - A pointer to the instance.
+ * @param	NAME - The NAME of the ECU.
+ * @param	preferredAddress - The address to claim.
+ * @retval	None.
+ */
+void J1939_startAddressClaim(J1939_instance* instance, uint64_t NAME, uint8_t preferredAddress);
+
+/**
+ * @brief 	This function is used to get the address claim state.
+ * @param	instance - A pointer to the instance.
+ * @retval	The state.
+ */
+J1939_addressClaimState J1939_getAddressClaimState(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to set the function called when the address claim state is changed.
+ * @param	instance - A pointer to the instance.
+ * @param	callback - A pointer to the function. NULL - no function.
+ * @retval	None.
+ */
+void J1939_setAddressClaimCallback(J1939_instance* instance, J1939_addressClaimCallback callback);
+
+/**
+ * @brief 	This function is used to read the address claimed message. The NAME is stored in the address
+ * 			table, the claim of the current address is resolved by the NAMEs.
+ * @param	instance - A pointer to the instance.
+ * @param	sourceAddress - The source address of the message.
+ * @param	data - A pointer to the NAME.
+ * @retval	None.
+ */
+void J1939_readAddressClaimed(J1939_instance* instance, uint8_t sourceAddress, const uint8_t* data);
+
+/**
+ * @brief 	This function is used to answer the request for the address claimed message.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_readRequestForAddressClaimed(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to clear the address table and to request the address claimed messages
+ * 			of all ECUs to fill it again.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_requestAddressClaims(J1939_instance* instance);
+
+/**
+ * @brief 	This function is used to check whether the address is claimed by an ECU.
+ * @param	instance - A pointer to the instance.
+ * @param	address - The address.
+ * @retval	1 if the address is claimed, 0 otherwise.
+ */
+uint8_t J1939_isAddressClaimed(J1939_instance* instance, uint8_t address);
+
+/**
+ * @brief 	This function is used to get the NAME of the ECU which claimed the address.
+ * @param	instance - A pointer to the instance.
+ * @param	address - The address.
+ * @param	NAME - A pointer to store the NAME.
+ * @retval	1 if the address is claimed, 0 otherwise.
+ */
+uint8_t J1939_getNameOfAddress(J1939_instance* instance, uint8_t address, uint64_t* NAME);
 
 #endif /* __SAE_J1939_21_NETWORK_MANAGEMENT_LAYER_H */
@@ -5,7 +5,8 @@
   * @version v1.0
   * @date    05 May 2023
   * @brief	 This file contains the implementation of functions for a network
-  * 		 management layer of SAE J1939
+  * 		 management layer of SAE J1939: the address claim and the table of
+  * 		 the NAMEs by the claimed addresses
   *
   ******************************************************************************
   */
@@ -13,12 +14,37 @@
 //---------------------------------------------------------------------------
 // Includes
 //---------------------------------------------------------------------------
-#include "SAE_J1939_81_Network_Management_Layer.h"
+#include "SAE_J1939_21_Instance.h"
 
 //---------------------------------------------------------------------------
-// Structure definitions
+// Defines
 //---------------------------------------------------------------------------
-static J1939_informationECU currentECU = {0};
+#define J1939_PGN_PRIOTITY_POS					(26U)
+#define J1939_PDU_FORMAT_POS					(16U)
+#define J1939_PDU_SPECIFIC_POS					(8U)
+
+#define J1939_ADDRESS_CLAIM_PRIORITY			(6U)
+#define J1939_GLOBAL_ADDRESS					(255U)
+#define J1939_CAN_DLC							(8U)
+#define J1939_REQUEST_DLC						(3U)
+
+#define J1939_IS_ADDRESS_CLAIMED(NM, address)	(((NM)->claimed_addresses[(address) >> 3U] >> ((address) & 7U)) & 1U)
+#define J1939_SET_ADDRESS_CLAIMED(NM, address)	((NM)->claimed_addresses[(address) >> 3U] |= (uint8_t)(1U << ((address) & 7U)))
+
+// Addresses which can be used at once after the claim is sent
+#define J1939_IS_ADDRESS_USED_AT_ONCE(address)	(((address) < J1939_FIRST_ARBITRARY_ADDRESS) || \
+												 ((address) > J1939_LAST_ARBITRARY_ADDRESS))
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static void J1939_claimAddress(J1939_instance* instance, uint8_t address);
+static void J1939_sendAddressClaim(J1939_instance* instance);
+static void J1939_cannotClaimAddress(J1939_instance* instance);
+static void J1939_addressClaimTimeout(void* context);
+static uint8_t J1939_findFreeAddress(J1939_instance* instance, uint8_t lostAddress);
+static uint8_t J1939_sendAddressClaimed(J1939_instance* instance, uint8_t sourceAddress);
+static void J1939_setAddressClaimState(J1939_instance* instance, J1939_addressClaimState state);
 
 //---------------------------------------------------------------------------
 // Library Functions
@@ -26,19 +52,376 @@ static J1939_informationECU currentECU = {0};
 
 /**
  * @brief 	This function is used to get the current ECU address.
+ * @param	instance - A pointer to the instance.
  * @retval	ECU address.
  */
-uint8_t J1939_getCurrentECUAddress(void)
+uint8_t J1939_getCurrentECUAddress(J1939_instance* instance)
 {
-	return currentECU.ECUaddress;
+	return instance->NM.ECU.ECUaddress;
 }
 
 /**
- * @brief 	This function is used to set the current ECU address.
+ * @brief 	This function is used to set the current ECU address. The acceptance filters are made
+ * 			again if the address is changed.
+ * @param	instance - A pointer to the instance.
  * @param	address - The current ECU address.
  * @retval	None.
  */
-void J1939_setCurrentECUAddress(uint8_t address)
+void J1939_setCurrentECUAddress(J1939_instance* instance, uint8_t address)
+{
+	J1939_informationECU* currentECU = &instance->NM.ECU;
+
+	if(currentECU->ECUaddress == address) return;
+
+	currentECU->ECUaddress = address;
+
+	J1939_refreshAcceptanceFilters(instance);
+}
+
+/**
+ * @brief 	This function is used to claim the address. The address is claimed if no ECU with a NAME of
+ * 			the higher priority claims it in J1939_ADDRESS_CLAIM_TIMEOUT. Addresses from 0 to 127 and from
+ * 			248 to 253 are claimed at once. If the address is lost, an arbitrary address capable ECU
+ * 			claims a free address from 128 to 247, other ECUs send the cannot claim message.
+ * @param	instance - A pointer to the instance.
+ * @param	NAME - The NAME of the ECU.
+ * @param	preferredAddress - The address to claim.
+ * @retval	None.
+ */
+void J1939_startAddressClaim(J1939_instance* instance, uint64_t NAME, uint8_t preferredAddress)
+{
+	J1939_informationECU* currentECU = &instance->NM.ECU;
+
+	currentECU->NAME = NAME;
+
+	if(preferredAddress >= J1939_NULL_ADDRESS)
+	{
+		J1939_cannotClaimAddress(instance);
+		return;
+	}
+
+	J1939_claimAddress(instance, preferredAddress);
+}
+
+/**
+ * @brief 	This function is used to get the address claim state.
+ * @param	instance - A pointer to the instance.
+ * @retval	The state.
+ */
+J1939_addressClaimState J1939_getAddressClaimState(J1939_instance* instance)
+{
+	return instance->NM.ECU.state;
+}
+
+/**
+ * @brief 	This function is used to set the function called when the address claim state is changed.
+ * @param	instance - A pointer to the instance.
+ * @param	callback - A pointer to the function. NULL - no function.
+ * @retval	None.
+ */
+void J1939_setAddressClaimCallback(J1939_instance* instance, J1939_addressClaimCallback callback)
+{
+	instance->NM.callback = callback;
+}
+
+/**
+ * @brief 	This function is used to read the address claimed message. The NAME is stored in the address
+ * 			table, the claim of the current address is resolved by the NAMEs.
+ * @param	instance - A pointer to the instance.
+ * @param	sourceAddress - The source address of the message.
+ * @param	data - A pointer to the NAME.
+ * @retval	None.
+ */
+void J1939_readAddressClaimed(J1939_instance* instance, uint8_t sourceAddress, const uint8_t* data)
+{
+	J1939_informationECU* currentECU = &instance->NM.ECU;
+	uint64_t NAME = 0U;
+	uint8_t newAddress;
+
+	// The cannot claim message of other ECU doesn't take an address
+	if(sourceAddress >= J1939_NULL_ADDRESS) return;
+
+	for(uint8_t i = 0U; i < J1939_CAN_DLC; i++) NAME |= (uint64_t)data[i] << (8U * i);
+
+	if(((currentECU->state == J1939_ADDRESS_CLAIMING) || (currentECU->state == J1939_ADDRESS_CLAIMED)) && \
+	   (sourceAddress == currentECU->ECUaddress) && (NAME != currentECU->NAME))
+	{
+		// The NAME with the lower value has the higher priority
+		if(currentECU->NAME < NAME)
+		{
+			J1939_sendAddressClaimed(instance, sourceAddress);
+			return;
+		}
+
+		instance->NM.address_names[sourceAddress] = NAME;
+		J1939_SET_ADDRESS_CLAIMED(&instance->NM, sourceAddress);
+
+		// The address is lost, another one is claimed
+		J1939_cancelTimer(instance, &currentECU->timer);
+		newAddress = J1939_findFreeAddress(instance, sourceAddress);
+
+		if(newAddress == J1939_NULL_ADDRESS)
+		{
+			J1939_cannotClaimAddress(instance);
+		} else
+		{
+			J1939_claimAddress(instance, newAddress);
+		}
+
+		return;
+	}
+
+	instance->NM.address_names[sourceAddress] = NAME;
+	J1939_SET_ADDRESS_CLAIMED(&instance->NM, sourceAddress);
+}
+
+/**
+ * @brief 	This function is used to answer the request for the address claimed message.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_readRequestForAddressClaimed(J1939_instance* instance)
+{
+	J1939_informationECU* currentECU = &instance->NM.ECU;
+
+	switch(currentECU->state)
+	{
+		case J1939_ADDRESS_CLAIMING:
+		case J1939_ADDRESS_CLAIMED:
+			J1939_sendAddressClaimed(instance, currentECU->ECUaddress);
+			break;
+
+		case J1939_ADDRESS_CANNOT_CLAIM:
+			J1939_cannotClaimAddress(instance);
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief 	This function is used to clear the address table and to request the address claimed messages
+ * 			of all ECUs to fill it again.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+void J1939_requestAddressClaims(J1939_instance* instance)
+{
+	J1939_informationECU* currentECU = &instance->NM.ECU;
+	uint32_t canId;
+	uint8_t data[J1939_REQUEST_DLC];
+
+	for(uint8_t i = 0U; i < sizeof(instance->NM.claimed_addresses); i++) instance->NM.claimed_addresses[i] = 0U;
+
+	if((currentECU->state == J1939_ADDRESS_CLAIMING) || (currentECU->state == J1939_ADDRESS_CLAIMED))
+	{
+		instance->NM.address_names[currentECU->ECUaddress] = currentECU->NAME;
+		J1939_SET_ADDRESS_CLAIMED(&instance->NM, currentECU->ECUaddress);
+	}
+
+	canId = (((uint32_t)J1939_ADDRESS_CLAIM_PRIORITY << J1939_PGN_PRIOTITY_POS) | \
+			 ((uint32_t)J1939_REQUEST << J1939_PDU_FORMAT_POS) | \
+			 ((uint32_t)J1939_GLOBAL_ADDRESS << J1939_PDU_SPECIFIC_POS) | currentECU->ECUaddress);
+
+	data[0] = (uint8_t)J1939_ADDRESS_CLAIMED_PGN;
+	data[1] = (uint8_t)(J1939_ADDRESS_CLAIMED_PGN >> 8U);
+	data[2] = (uint8_t)(J1939_ADDRESS_CLAIMED_PGN >> 16U);
+
+	J1939_sendFrame(instance, canId, data, J1939_REQUEST_DLC);
+}
+
+/**
+ * @brief 	This function is used to check whether the address is claimed by an ECU.
+ * @param	instance - A pointer to the instance.
+ * @param	address - The address.
+ * @retval	1 if the address is claimed, 0 otherwise.
+ */
+uint8_t J1939_isAddressClaimed(J1939_instance* instance, uint8_t address)
+{
+	return J1939_IS_ADDRESS_CLAIMED(&instance->NM, address);
+}
+
+/**
+ * @brief 	This function is used to get the NAME of the ECU which claimed the address.
+ * @param	instance - A pointer to the instance.
+ * @param	address - The address.
+ * @param	NAME - A pointer to store the NAME.
+ * @retval	1 if the address is claimed, 0 otherwise.
+ */
+uint8_t J1939_getNameOfAddress(J1939_instance* instance, uint8_t address, uint64_t* NAME)
+{
+	if(J1939_IS_ADDRESS_CLAIMED(&instance->NM, address) == 0U) return 0U;
+
+	*NAME = instance->NM.address_names[address];
+
+	return 1U;
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to start the claim of the address.
+ * @param	instance - A pointer to the instance.
+ * @param	address - The address.
+ * @retval	None.
+ */
+static void J1939_claimAddress(J1939_instance* instance, uint8_t address)
 {
-	currentECU.ECUaddress = address;
+	J1939_informationECU* currentECU = &instance->NM.ECU;
+
+	J1939_setCurrentECUAddress(instance, address);
+	J1939_setAddressClaimState(instance, J1939_ADDRESS_CLAIMING);
+
+	instance->NM.address_names[address] = currentECU->NAME;
+	J1939_SET_ADDRESS_CLAIMED(&instance->NM, address);
+
+	J1939_sendAddressClaim(instance);
+}
+
+/**
+ * @brief 	This function is used to send the address claim and to start the claim window.
+ * 			If the TX slots are busy, the sending is retried by the timer.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+static void J1939_sendAddressClaim(J1939_instance* instance)
+{
+	J1939_informationECU* currentECU = &instance->NM.ECU;
+
+	currentECU->claim_pending = (J1939_sendAddressClaimed(instance, currentECU->ECUaddress) == J1939_PORT_FRAME_QUEUED) ? 0U : 1U;
+
+	if(currentECU->claim_pending == 1U)
+	{
+		J1939_armTimer(instance, &currentECU->timer, J1939_TIMER_WHEEL_RESOLUTION, J1939_addressClaimTimeout, instance);
+	} else if(J1939_IS_ADDRESS_USED_AT_ONCE(currentECU->ECUaddress))
+	{
+		J1939_cancelTimer(instance, &currentECU->timer);
+		J1939_setAddressClaimState(instance, J1939_ADDRESS_CLAIMED);
+	} else
+	{
+		J1939_armTimer(instance, &currentECU->timer, J1939_ADDRESS_CLAIM_TIMEOUT, J1939_addressClaimTimeout, instance);
+	}
+}
+
+/**
+ * @brief 	This function is used to give up the address. The cannot claim message is sent after
+ * 			a pseudo-random delay, so the messages of several ECUs don't collide.
+ * @param	instance - A pointer to the instance.
+ * @retval	None.
+ */
+static void J1939_cannotClaimAddress(J1939_instance* instance)
+{
+	J1939_informationECU* currentECU = &instance->NM.ECU;
+	uint32_t delay = (uint32_t)(currentECU->NAME ^ (currentECU->NAME >> 32U)) ^ J1939_portGetTime();
+
+	J1939_setCurrentECUAddress(instance, J1939_NULL_ADDRESS);
+	if(currentECU->state != J1939_ADDRESS_CANNOT_CLAIM) J1939_setAddressClaimState(instance, J1939_ADDRESS_CANNOT_CLAIM);
+
+	currentECU->claim_pending = 1U;
+	J1939_armTimer(instance, &currentECU->timer, delay % (J1939_CANNOT_CLAIM_MAX_DELAY + 1U), J1939_addressClaimTimeout, instance);
+}
+
+/**
+ * @brief 	This function is called by the timer: the pending message is sent or the claim window
+ * 			is closed.
+ * @param	context - A pointer to the instance.
+ * @retval	None.
+ */
+static void J1939_addressClaimTimeout(void* context)
+{
+	J1939_instance* instance = (J1939_instance*)context;
+	J1939_informationECU* currentECU = &instance->NM.ECU;
+
+	switch(currentECU->state)
+	{
+		case J1939_ADDRESS_CLAIMING:
+			if(currentECU->claim_pending == 1U)
+			{
+				J1939_sendAddressClaim(instance);
+			} else
+			{
+				J1939_setAddressClaimState(instance, J1939_ADDRESS_CLAIMED);
+			}
+			break;
+
+		case J1939_ADDRESS_CANNOT_CLAIM:
+			if(J1939_sendAddressClaimed(instance, J1939_NULL_ADDRESS) == J1939_PORT_FRAME_QUEUED)
+			{
+				currentECU->claim_pending = 0U;
+			} else
+			{
+				J1939_armTimer(instance, &currentECU->timer, J1939_TIMER_WHEEL_RESOLUTION, J1939_addressClaimTimeout, instance);
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief 	This function is used to find an address for an arbitrary address capable ECU. The search
+ * 			starts after the lost address, so the ECUs which lost the same address take different ones.
+ * @param	instance - A pointer to the instance.
+ * @param	lostAddress - The lost address.
+ * @retval	The address. J1939_NULL_ADDRESS if the ECU isn't arbitrary address capable or there are
+ * 			no free addresses.
+ */
+static uint8_t J1939_findFreeAddress(J1939_instance* instance, uint8_t lostAddress)
+{
+	J1939_informationECU* currentECU = &instance->NM.ECU;
+	uint8_t numberOfAddresses = J1939_LAST_ARBITRARY_ADDRESS - J1939_FIRST_ARBITRARY_ADDRESS + 1U;
+	uint8_t offset = 0U;
+
+	if((currentECU->NAME & J1939_NAME_ARBITRARY_ADDRESS_CAPABLE) == 0U) return J1939_NULL_ADDRESS;
+
+	if(J1939_IS_ADDRESS_USED_AT_ONCE(lostAddress) == 0U) offset = lostAddress - J1939_FIRST_ARBITRARY_ADDRESS + 1U;
+
+	for(uint8_t i = 0U; i < numberOfAddresses; i++)
+	{
+		uint8_t address = J1939_FIRST_ARBITRARY_ADDRESS + ((offset + i) % numberOfAddresses);
+
+		if(J1939_IS_ADDRESS_CLAIMED(&instance->NM, address) == 0U) return address;
+	}
+
+	return J1939_NULL_ADDRESS;
+}
+
+/**
+ * @brief 	This function is used to send the address claimed message with the NAME of the ECU.
+ * @param	instance - A pointer to the instance.
+ * @param	sourceAddress - The claimed address. J1939_NULL_ADDRESS - the cannot claim message.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+static uint8_t J1939_sendAddressClaimed(J1939_instance* instance, uint8_t sourceAddress)
+{
+	J1939_informationECU* currentECU = &instance->NM.ECU;
+	uint32_t canId;
+	uint8_t data[J1939_CAN_DLC];
+
+	canId = (((uint32_t)J1939_ADDRESS_CLAIM_PRIORITY << J1939_PGN_PRIOTITY_POS) | \
+			 ((uint32_t)J1939_ADDRESS_CLAIM << J1939_PDU_FORMAT_POS) | \
+			 ((uint32_t)J1939_GLOBAL_ADDRESS << J1939_PDU_SPECIFIC_POS) | sourceAddress);
+
+	for(uint8_t i = 0U; i < J1939_CAN_DLC; i++) data[i] = (uint8_t)(currentECU->NAME >> (8U * i));
+
+	return J1939_sendFrame(instance, canId, data, J1939_CAN_DLC);
+}
+
+/**
+ * @brief 	This function is used to change the address claim state and to report it.
+ * @param	instance - A pointer to the instance.
+ * @param	state - The new state.
+ * @retval	None.
+ */
+static void J1939_setAddressClaimState(J1939_instance* instance, J1939_addressClaimState state)
+{
+	J1939_informationECU* currentECU = &instance->NM.ECU;
+
+	currentECU->state = state;
+
+	if(instance->NM.callback != NULL) instance->NM.callback(instance, state, currentECU->ECUaddress);
 }
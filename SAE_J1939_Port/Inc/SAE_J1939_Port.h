@@ -0,0 +1,168 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Port.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the SAE J1939 platform abstraction. The functions
+  * 		 declared here are implemented once per platform: STM32F4 with
+  * 		 FreeRTOS, the host with the virtual CAN bus (J1939_PORT_HOST) or
+  * 		 Linux user space with SocketCAN (J1939_PORT_SOCKETCAN).
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_PORT_H
+#define __SAE_J1939_PORT_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#if defined(J1939_PORT_HOST) || defined(J1939_PORT_SOCKETCAN)
+	#include <stdint.h>
+#else
+	#include "stm32f4xx.h"
+#endif
+
+#include <stddef.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_PORT_FRAME_QUEUED					(1U)
+#define J1939_PORT_FRAME_NOT_QUEUED				(0U)
+
+#define J1939_PORT_FD_MAX_LENGTH				(64U)	// The data bytes of a CAN FD frame
+
+// Orders memory accesses of lock-free structures shared between an interrupt and a task
+#if defined(J1939_PORT_HOST) || defined(J1939_PORT_SOCKETCAN)
+	#define J1939_PORT_MEMORY_BARRIER()			__atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+	#define J1939_PORT_MEMORY_BARRIER()			__DMB()
+#endif
+
+// Orders the stores of a structure written by one task for the readers of the same core
+#define J1939_PORT_COMPILER_BARRIER()			__asm__ volatile("" : : : "memory")
+
+// Reads the free-running clock of the trace: the time of the host or Linux or the DWT cycle counter
+#if defined(J1939_PORT_HOST) || defined(J1939_PORT_SOCKETCAN)
+	#define J1939_PORT_GET_TRACE_TIME()			J1939_portGetTraceTime()
+#else
+	#define J1939_PORT_GET_TRACE_TIME()			(DWT->CYCCNT)
+#endif
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief The stack of one CAN channel, defined in SAE_J1939_21_Instance.h. The protocol layers
+ * 		  take a pointer to it, so several channels run independently.
+ */
+typedef struct J1939_instance J1939_instance;
+
+/**
+ * @brief A hardware acceptance filter in the mask mode. An extended frame is accepted
+ * 		  if (canId & mask) == (id & mask). The bits of the mask and the ID are the 29-bit CAN ID bits.
+ */
+typedef struct
+{
+	uint32_t id;
+	uint32_t mask;
+} J1939_acceptanceFilter;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to queue an extended CAN data frame for transmission.
+ * @param	channel - The CAN channel.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_portSendFrame(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t dlc);
+
+/**
+ * @brief 	This function is used to queue an extended CAN FD data frame with the bit rate switch for transmission.
+ * @param	channel - The CAN channel.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	length - The number of data bytes: 0 to 8, 12, 16, 20, 24, 32, 48 or 64.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_portSendFDFrame(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t length);
+
+/**
+ * @brief 	This function is used to get the number of frames that can be queued for transmission
+ * 			without waiting.
+ * @param	channel - The CAN channel.
+ * @retval	The number of free TX slots.
+ */
+uint8_t J1939_portGetFreeTxSlots(uint8_t channel);
+
+/**
+ * @brief 	This function is used to allocate memory from the platform heap.
+ * @param	size - The requested size in bytes.
+ * @retval	A pointer to the allocated memory. NULL if there is no memory.
+ */
+void* J1939_portAllocate(size_t size);
+
+/**
+ * @brief 	This function is used to return memory to the platform heap.
+ * @param	block - A pointer to the memory allocated by J1939_portAllocate.
+ * @retval	None.
+ */
+void J1939_portFree(void* block);
+
+/**
+ * @brief 	This function is used to get the platform time.
+ * @retval	The time in milliseconds.
+ */
+uint32_t J1939_portGetTime(void);
+
+/**
+ * @brief 	This function is used to start the free-running clock of the trace.
+ * @retval	The frequency of the clock in Hz.
+ */
+uint32_t J1939_portStartTraceClock(void);
+
+/**
+ * @brief 	This function is used to get the time of the trace clock. It wraps around at 2^32 ticks.
+ * @retval	The time in ticks of the trace clock.
+ */
+uint32_t J1939_portGetTraceTime(void);
+
+/**
+ * @brief 	This function is used to copy payload bytes between frames and message buffers.
+ * @param	destination - A pointer to the destination.
+ * @param	source - A pointer to the source.
+ * @param	size - The number of bytes.
+ * @retval	None.
+ */
+void J1939_portCopy(uint8_t* destination, const uint8_t* source, uint16_t size);
+
+/**
+ * @brief 	This function is used to get the number of hardware acceptance filters of the CAN controller.
+ * @param	channel - The CAN channel.
+ * @retval	The number of filters.
+ */
+uint8_t J1939_portGetFilterBanks(uint8_t channel);
+
+/**
+ * @brief 	This function is used to load the hardware acceptance filters. A frame is received if it
+ * 			matches any of them.
+ * @param	channel - The CAN channel.
+ * @param	filters - A pointer to the filters.
+ * @param	numberOfFilters - The number of filters, no more than J1939_portGetFilterBanks.
+ * 			0 - all frames are received.
+ * @retval	None.
+ */
+void J1939_portSetAcceptanceFilters(uint8_t channel, const J1939_acceptanceFilter* filters, uint8_t numberOfFilters);
+
+#endif /* __SAE_J1939_PORT_H */
@@ -0,0 +1,137 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Port_Host.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the SAE J1939 host platform. It provides an
+  * 		 in-process virtual CAN bus with a virtual clock, which allows to
+  * 		 run the stack on a PC for benchmarks and regression tests.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_PORT_HOST_H
+#define __SAE_J1939_PORT_HOST_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_Port.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_HOST_MAX_NODES					(8U)
+#define J1939_HOST_BUS_QUEUE_SIZE				(1024U)
+#define J1939_HOST_DEFAULT_BITRATE				(250000U)
+#define J1939_HOST_DEFAULT_DATA_BITRATE			(2000000U)	// The data phase of the CAN FD frames
+#define J1939_HOST_FILTER_BANKS					(14U)	// As bxCAN of STM32F4 with the banks shared equally
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A callback to deliver a frame from the virtual bus to a node.
+ */
+typedef void (*J1939_hostReceiveCallback)(void* context, uint32_t canId, const uint8_t* data, uint8_t dlc);
+
+/**
+ * @brief A filter to simulate frame loss on the virtual bus. Returns 1 to lose the frame.
+ */
+typedef uint8_t (*J1939_hostLossFilter)(uint32_t canId, const uint8_t* data, uint8_t dlc);
+
+/**
+ * @brief Counters of the host platform.
+ */
+typedef struct
+{
+	uint64_t frames;						/* The number of frames transferred by the bus */
+	uint64_t fd_frames;						/* CAN FD frames among them */
+	uint64_t dropped_frames;				/* The number of frames rejected because the bus queue was full */
+	uint64_t lost_frames;					/* The number of frames transferred but lost by the loss filter */
+	uint64_t filter_accepted_frames;		/* Deliveries to nodes passed by their acceptance filters */
+	uint64_t filter_rejected_frames;		/* Deliveries to nodes rejected by their acceptance filters */
+	uint64_t bus_bits;						/* The number of bits transferred by the bus */
+	uint64_t copied_bytes;					/* Payload bytes copied by J1939_portCopy */
+	uint64_t bus_copied_bytes;				/* Frame data bytes copied into and out of the bus queue */
+	uint64_t heap_allocations;				/* The number of heap allocations */
+	size_t heap_used;						/* Heap bytes in use */
+	size_t heap_peak;						/* High-water mark of heap bytes in use */
+} J1939_hostCounters;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to reset the virtual bus, the virtual clock and the counters.
+ * @param	bitrate - The bus bitrate in bit/s (the nominal bitrate of the CAN FD frames), used to advance the virtual clock.
+ * @retval	None.
+ */
+void J1939_hostInit(uint32_t bitrate);
+
+/**
+ * @brief 	This function is used to set the bitrate of the data phase of the CAN FD frames.
+ * 			It is reset to J1939_HOST_DEFAULT_DATA_BITRATE by J1939_hostInit.
+ * @param	bitrate - The data bitrate in bit/s.
+ * @retval	None.
+ */
+void J1939_hostSetDataBitrate(uint32_t bitrate);
+
+/**
+ * @brief 	This function is used to attach a node to the virtual bus. The node number is the CAN channel
+ * 			of the port functions, the frames sent on the channel come from the node.
+ * @param	callback - A callback to deliver frames sent by other nodes.
+ * @param	context - A user pointer passed to the callback.
+ * @retval	The node number. 0xFF if there are no free nodes.
+ */
+uint8_t J1939_hostAddNode(J1939_hostReceiveCallback callback, void* context);
+
+/**
+ * @brief 	This function is used to set a filter to simulate frame loss. A lost frame occupies the bus
+ * 			but isn't delivered to the nodes.
+ * @param	filter - The loss filter. NULL disables the frame loss.
+ * @retval	None.
+ */
+void J1939_hostSetLossFilter(J1939_hostLossFilter filter);
+
+/**
+ * @brief 	This function is used to deliver queued frames until the bus is idle. Frames sent from
+ * 			the callbacks are queued and delivered in the same call.
+ * @retval	The number of delivered frames.
+ */
+uint32_t J1939_hostProcessBus(void);
+
+/**
+ * @brief 	This function is used to advance the virtual clock.
+ * @param	microseconds - The time interval.
+ * @retval	None.
+ */
+void J1939_hostAdvanceTime(uint64_t microseconds);
+
+/**
+ * @brief 	This function is used to get the virtual clock.
+ * @retval	The time in microseconds.
+ */
+uint64_t J1939_hostGetTime(void);
+
+/**
+ * @brief 	This function is used to get the counters of the host platform.
+ * @param	counters - A pointer to store the counters.
+ * @retval	None.
+ */
+void J1939_hostGetCounters(J1939_hostCounters* counters);
+
+/**
+ * @brief 	This function is used to reset the counters. The heap usage isn't reset,
+ * 			its high-water mark is set to the current usage.
+ * @retval	None.
+ */
+void J1939_hostResetCounters(void);
+
+#endif /* __SAE_J1939_PORT_HOST_H */
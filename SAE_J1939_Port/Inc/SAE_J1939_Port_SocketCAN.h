@@ -0,0 +1,153 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Port_SocketCAN.h
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief   Header file of the SAE J1939 Linux platform. The stack runs in
+  * 		 user space on a CAN_RAW socket: the received frames are read and
+  * 		 the queued frames are written in batches by recvmmsg and sendmmsg,
+  * 		 each frame gets the reception time of the kernel and the
+  * 		 acceptance filters are loaded as CAN_RAW filters. A datagram
+  * 		 socket carrying the same frames, e.g. one end of a socketpair,
+  * 		 can stand in for the CAN interface.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Define to prevent recursive inclusion
+//---------------------------------------------------------------------------
+#ifndef __SAE_J1939_PORT_SOCKETCAN_H
+#define __SAE_J1939_PORT_SOCKETCAN_H
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_Port.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_SOCKETCAN_MAX_CHANNELS			(4U)
+#define J1939_SOCKETCAN_NO_CHANNEL				(0xFFU)
+
+// The most frames read or written by one system call. It can be redefined in the compiler options.
+#ifndef J1939_SOCKETCAN_BATCH_SIZE
+#define J1939_SOCKETCAN_BATCH_SIZE				(32U)
+#endif
+
+#if (J1939_SOCKETCAN_BATCH_SIZE == 0U) || (J1939_SOCKETCAN_BATCH_SIZE > 255U)
+	#error "J1939_SOCKETCAN_BATCH_SIZE must be from 1 to 255"
+#endif
+
+// CAN_RAW takes up to 512 filters, the acceptance filter module loads up to J1939_MAX_FILTER_BANKS
+#define J1939_SOCKETCAN_FILTER_BANKS			(64U)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A callback to deliver a received extended data frame of a channel.
+ * 		  timestamp - the reception time of the kernel on the trace clock, us.
+ */
+typedef void (*J1939_socketCANreceiveCallback)(void* context, uint32_t canId, const uint8_t* data, uint8_t length,
+											   uint32_t timestamp);
+
+/**
+ * @brief Counters of a channel.
+ */
+typedef struct
+{
+	uint64_t rx_frames;						/* Frames delivered to the callback */
+	uint64_t rx_calls;						/* recvmmsg and recvmsg calls */
+	uint64_t rx_filtered_frames;			/* Frames rejected by the filters of a stand-in socket, standard and RTR frames */
+	uint64_t tx_frames;						/* Frames written to the socket */
+	uint64_t tx_calls;						/* sendmmsg and send calls */
+	uint64_t tx_blocked_calls;				/* Calls which found the TX queue of the socket full */
+	uint64_t tx_dropped_frames;				/* Frames discarded after a socket error */
+} J1939_socketCANcounters;
+
+//---------------------------------------------------------------------------
+// External function prototypes
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to open a CAN_RAW socket on the CAN interface. The socket receives
+ * 			CAN FD frames and the kernel reception time of the frames.
+ * @param	interfaceName - The name of the interface, e.g. "can0" or "vcan0".
+ * @param	callback - A callback to deliver the received frames.
+ * @param	context - A user pointer passed to the callback.
+ * @retval	The CAN channel of the port functions. J1939_SOCKETCAN_NO_CHANNEL if the socket can't be opened.
+ */
+uint8_t J1939_socketCANopen(const char* interfaceName, J1939_socketCANreceiveCallback callback, void* context);
+
+/**
+ * @brief 	This function is used to attach a datagram socket which carries struct can_frame and struct canfd_frame
+ * 			as a CAN_RAW socket does, e.g. one end of a socketpair. The acceptance filters of the channel
+ * 			are applied by the port. The socket is owned by the channel.
+ * @param	socketDescriptor - The socket.
+ * @param	callback - A callback to deliver the received frames.
+ * @param	context - A user pointer passed to the callback.
+ * @retval	The CAN channel of the port functions. J1939_SOCKETCAN_NO_CHANNEL if there are no free channels.
+ */
+uint8_t J1939_socketCANattach(int socketDescriptor, J1939_socketCANreceiveCallback callback, void* context);
+
+/**
+ * @brief 	This function is used to close the socket of the channel. The frames not written yet are discarded.
+ * @param	channel - The CAN channel.
+ * @retval	None.
+ */
+void J1939_socketCANclose(uint8_t channel);
+
+/**
+ * @brief 	This function is used to set the most frames read or written by one system call.
+ * 			1 - every frame is read by recvmsg and written by send as soon as it is queued.
+ * @param	channel - The CAN channel.
+ * @param	batchSize - The batch size from 1 to J1939_SOCKETCAN_BATCH_SIZE (by default).
+ * @retval	None.
+ */
+void J1939_socketCANsetBatchSize(uint8_t channel, uint8_t batchSize);
+
+/**
+ * @brief 	This function is used to get the socket of the channel, e.g. to wait for frames by poll.
+ * @param	channel - The CAN channel.
+ * @retval	The socket. -1 if the channel isn't open.
+ */
+int J1939_socketCANgetDescriptor(uint8_t channel);
+
+/**
+ * @brief 	This function is used to read the received frames in batches and pass them to the callback.
+ * 			It doesn't wait for frames. Called by the task of the instance.
+ * @param	channel - The CAN channel.
+ * @param	maxFrames - The maximum number of frames to read. 0 - until no frames are left.
+ * @retval	The number of frames passed to the callback.
+ */
+uint32_t J1939_socketCANreceive(uint8_t channel, uint32_t maxFrames);
+
+/**
+ * @brief 	This function is used to write the queued frames. A batch is written as soon as it is full,
+ * 			the rest must be flushed by the task after the stack is processed. The frames the socket
+ * 			can't take stay queued and take TX slots until the next flush.
+ * @param	channel - The CAN channel.
+ * @retval	The number of frames left queued.
+ */
+uint32_t J1939_socketCANflush(uint8_t channel);
+
+/**
+ * @brief 	This function is used to get the counters of the channel.
+ * @param	channel - The CAN channel.
+ * @param	counters - A pointer to store the counters.
+ * @retval	None.
+ */
+void J1939_socketCANgetCounters(uint8_t channel, J1939_socketCANcounters* counters);
+
+/**
+ * @brief 	This function is used to reset the counters of the channel.
+ * @param	channel - The CAN channel.
+ * @retval	None.
+ */
+void J1939_socketCANresetCounters(uint8_t channel);
+
+#endif /* __SAE_J1939_PORT_SOCKETCAN_H */
@@ -0,0 +1,465 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Port_Host.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the SAE J1939 platform
+  * 		 abstraction for the host: the virtual CAN bus and the virtual clock
+  *
+  ******************************************************************************
+  */
+
+#if defined(J1939_PORT_HOST)
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_Port_Host.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_HOST_NO_NODE						(0xFFU)
+#define J1939_HOST_FRAME_OVERHEAD_BITS			(67U)	// Extended data frame without data and bit stuffing
+#define J1939_HOST_FD_NOMINAL_BITS				(48U)	// Arbitration and end of an extended FD frame at the nominal bitrate
+#define J1939_HOST_FD_DATA_BITS					(27U)	// Control and CRC of an FD frame at the data bitrate
+#define J1939_HOST_FD_LONG_CRC_BITS				(4U)	// The longer CRC of the frames above 16 bytes
+#define J1939_HOST_FD_SHORT_CRC_LENGTH			(16U)
+#define J1939_HOST_HEAP_HEADER					(sizeof(size_t) * 2U)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A frame in the virtual bus queue.
+ */
+typedef struct
+{
+	uint32_t can_id;
+	uint8_t dlc;
+	uint8_t sender;
+	uint8_t fd;								/* 1 - CAN FD frame with the bit rate switch */
+	uint8_t data[J1939_PORT_FD_MAX_LENGTH];
+} J1939_hostFrame;
+
+/**
+ * @brief A node attached to the virtual bus.
+ */
+typedef struct
+{
+	J1939_hostReceiveCallback callback;
+	void* context;
+	J1939_acceptanceFilter filters[J1939_HOST_FILTER_BANKS];	/* The acceptance filters of the node */
+	uint8_t number_of_filters;									/* 0 - all frames are received */
+} J1939_hostNode;
+
+//---------------------------------------------------------------------------
+// Structure definitions
+//---------------------------------------------------------------------------
+static J1939_hostNode nodes[J1939_HOST_MAX_NODES]				= {0};
+static J1939_hostFrame busQueue[J1939_HOST_BUS_QUEUE_SIZE]		= {0};
+static J1939_hostCounters counters								= {0};
+
+static uint32_t busHead				= 0U;
+static uint32_t busTail				= 0U;
+static uint8_t numberOfNodes		= 0U;
+static uint32_t busBitrate			= J1939_HOST_DEFAULT_BITRATE;
+static uint32_t dataBitrate			= J1939_HOST_DEFAULT_DATA_BITRATE;
+static uint64_t virtualTime			= 0U;
+static J1939_hostLossFilter lossFilter	= NULL;
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static uint8_t J1939_hostAcceptFrame(const J1939_hostNode* node, uint32_t canId);
+static uint8_t J1939_hostQueueFrame(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t dlc, uint8_t fd);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to reset the virtual bus, the virtual clock and the counters.
+ * @param	bitrate - The bus bitrate in bit/s (the nominal bitrate of the CAN FD frames), used to advance the virtual clock.
+ * @retval	None.
+ */
+void J1939_hostInit(uint32_t bitrate)
+{
+	size_t heapUsed = counters.heap_used;
+
+	memset(nodes, 0, sizeof(nodes));
+	memset(&counters, 0, sizeof(counters));
+
+	counters.heap_used	= heapUsed;
+	counters.heap_peak	= heapUsed;
+
+	busHead			= 0U;
+	busTail			= 0U;
+	numberOfNodes	= 0U;
+	busBitrate		= (bitrate > 0U) ? bitrate : J1939_HOST_DEFAULT_BITRATE;
+	dataBitrate		= J1939_HOST_DEFAULT_DATA_BITRATE;
+	virtualTime		= 0U;
+	lossFilter		= NULL;
+}
+
+/**
+ * @brief 	This function is used to set the bitrate of the data phase of the CAN FD frames.
+ * 			It is reset to J1939_HOST_DEFAULT_DATA_BITRATE by J1939_hostInit.
+ * @param	bitrate - The data bitrate in bit/s.
+ * @retval	None.
+ */
+void J1939_hostSetDataBitrate(uint32_t bitrate)
+{
+	dataBitrate = (bitrate > 0U) ? bitrate : J1939_HOST_DEFAULT_DATA_BITRATE;
+}
+
+/**
+ * @brief 	This function is used to attach a node to the virtual bus. The node number is the CAN channel
+ * 			of the port functions, the frames sent on the channel come from the node.
+ * @param	callback - A callback to deliver frames sent by other nodes.
+ * @param	context - A user pointer passed to the callback.
+ * @retval	The node number. 0xFF if there are no free nodes.
+ */
+uint8_t J1939_hostAddNode(J1939_hostReceiveCallback callback, void* context)
+{
+	if(numberOfNodes >= J1939_HOST_MAX_NODES) return J1939_HOST_NO_NODE;
+
+	nodes[numberOfNodes].callback	= callback;
+	nodes[numberOfNodes].context	= context;
+
+	return numberOfNodes++;
+}
+
+/**
+ * @brief 	This function is used to set a filter to simulate frame loss. A lost frame occupies the bus
+ * 			but isn't delivered to the nodes.
+ * @param	filter - The loss filter. NULL disables the frame loss.
+ * @retval	None.
+ */
+void J1939_hostSetLossFilter(J1939_hostLossFilter filter)
+{
+	lossFilter = filter;
+}
+
+/**
+ * @brief 	This function is used to deliver queued frames until the bus is idle. Frames sent from
+ * 			the callbacks are queued and delivered in the same call.
+ * @retval	The number of delivered frames.
+ */
+uint32_t J1939_hostProcessBus(void)
+{
+	uint32_t deliveredFrames = 0U;
+
+	while(busHead != busTail)
+	{
+		J1939_hostFrame frame = busQueue[busTail];
+		uint32_t frameBits = J1939_HOST_FRAME_OVERHEAD_BITS + (8U * frame.dlc);
+		uint32_t dataBits;
+
+		busTail = (busTail + 1U) % J1939_HOST_BUS_QUEUE_SIZE;
+
+		// The frame occupies the bus for its transmission time, the data phase of an FD frame at the data bitrate
+		if(frame.fd == 1U)
+		{
+			dataBits	= J1939_HOST_FD_DATA_BITS + (8U * frame.dlc) + \
+						  ((frame.dlc > J1939_HOST_FD_SHORT_CRC_LENGTH) ? J1939_HOST_FD_LONG_CRC_BITS : 0U);
+			frameBits	= J1939_HOST_FD_NOMINAL_BITS + dataBits;
+
+			virtualTime += (((uint64_t)J1939_HOST_FD_NOMINAL_BITS * 1000000U) / busBitrate) + \
+						   (((uint64_t)dataBits * 1000000U) / dataBitrate);
+			counters.fd_frames++;
+		} else
+		{
+			virtualTime += ((uint64_t)frameBits * 1000000U) / busBitrate;
+		}
+
+		counters.frames++;
+		counters.bus_bits += frameBits;
+
+		if((lossFilter != NULL) && (lossFilter(frame.can_id, frame.data, frame.dlc) == 1U))
+		{
+			counters.lost_frames++;
+			continue;
+		}
+
+		for(uint8_t node = 0U; node < numberOfNodes; node++)
+		{
+			if((node == frame.sender) || (nodes[node].callback == NULL)) continue;
+
+			// The frame rejected by the controller never reaches the receive interrupt
+			if(J1939_hostAcceptFrame(&nodes[node], frame.can_id) == 0U)
+			{
+				counters.filter_rejected_frames++;
+				continue;
+			}
+
+			counters.filter_accepted_frames++;
+
+			counters.bus_copied_bytes += frame.dlc;
+			nodes[node].callback(nodes[node].context, frame.can_id, frame.data, frame.dlc);
+		}
+
+		deliveredFrames++;
+	}
+
+	return deliveredFrames;
+}
+
+/**
+ * @brief 	This function is used to advance the virtual clock.
+ * @param	microseconds - The time interval.
+ * @retval	None.
+ */
+void J1939_hostAdvanceTime(uint64_t microseconds)
+{
+	virtualTime += microseconds;
+}
+
+/**
+ * @brief 	This function is used to get the virtual clock.
+ * @retval	The time in microseconds.
+ */
+uint64_t J1939_hostGetTime(void)
+{
+	return virtualTime;
+}
+
+/**
+ * @brief 	This function is used to get the counters of the host platform.
+ * @param	hostCounters - A pointer to store the counters.
+ * @retval	None.
+ */
+void J1939_hostGetCounters(J1939_hostCounters* hostCounters)
+{
+	*hostCounters = counters;
+}
+
+/**
+ * @brief 	This function is used to reset the counters. The heap usage isn't reset,
+ * 			its high-water mark is set to the current usage.
+ * @retval	None.
+ */
+void J1939_hostResetCounters(void)
+{
+	size_t heapUsed = counters.heap_used;
+
+	memset(&counters, 0, sizeof(counters));
+
+	counters.heap_used	= heapUsed;
+	counters.heap_peak	= heapUsed;
+}
+
+/**
+ * @brief 	This function is used to queue an extended CAN data frame for transmission.
+ * @param	channel - The node which sends the frame.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_portSendFrame(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	return J1939_hostQueueFrame(channel, canId, data, (dlc > 8U) ? 8U : dlc, 0U);
+}
+
+/**
+ * @brief 	This function is used to queue an extended CAN FD data frame with the bit rate switch for transmission.
+ * @param	channel - The node which sends the frame.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	length - The number of data bytes: 0 to 8, 12, 16, 20, 24, 32, 48 or 64.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_portSendFDFrame(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t length)
+{
+	return J1939_hostQueueFrame(channel, canId, data, (length > J1939_PORT_FD_MAX_LENGTH) ? J1939_PORT_FD_MAX_LENGTH : length, 1U);
+}
+
+/**
+ * @brief 	This function is used to get the number of frames that can be queued for transmission
+ * 			without waiting. The nodes share the queue of the virtual bus.
+ * @param	channel - Not used.
+ * @retval	The number of free TX slots.
+ */
+uint8_t J1939_portGetFreeTxSlots(uint8_t channel)
+{
+	uint32_t freeSlots = (J1939_HOST_BUS_QUEUE_SIZE - 1U) - ((busHead - busTail + J1939_HOST_BUS_QUEUE_SIZE) % J1939_HOST_BUS_QUEUE_SIZE);
+
+	(void)channel;
+
+	return (freeSlots > 0xFFU) ? 0xFFU : (uint8_t)freeSlots;
+}
+
+/**
+ * @brief 	This function is used to allocate memory from the platform heap.
+ * @param	size - The requested size in bytes.
+ * @retval	A pointer to the allocated memory. NULL if there is no memory.
+ */
+void* J1939_portAllocate(size_t size)
+{
+	// The size is kept in front of the block to track the heap usage
+	uint8_t* block = (uint8_t*)malloc(size + J1939_HOST_HEAP_HEADER);
+
+	if(block == NULL) return NULL;
+
+	*(size_t*)block = size;
+
+	counters.heap_allocations++;
+	counters.heap_used += size;
+	if(counters.heap_used > counters.heap_peak) counters.heap_peak = counters.heap_used;
+
+	return block + J1939_HOST_HEAP_HEADER;
+}
+
+/**
+ * @brief 	This function is used to return memory to the platform heap.
+ * @param	block - A pointer to the memory allocated by J1939_portAllocate.
+ * @retval	None.
+ */
+void J1939_portFree(void* block)
+{
+	uint8_t* header;
+
+	if(block == NULL) return;
+
+	header = (uint8_t*)block - J1939_HOST_HEAP_HEADER;
+	counters.heap_used -= *(size_t*)header;
+
+	free(header);
+}
+
+/**
+ * @brief 	This function is used to get the platform time.
+ * @retval	The time in milliseconds.
+ */
+uint32_t J1939_portGetTime(void)
+{
+	return (uint32_t)(virtualTime / 1000U);
+}
+
+/**
+ * @brief 	This function is used to start the free-running clock of the trace. The trace clock
+ * 			of the host is the virtual bus time.
+ * @retval	The frequency of the clock in Hz.
+ */
+uint32_t J1939_portStartTraceClock(void)
+{
+	return 1000000U;
+}
+
+/**
+ * @brief 	This function is used to get the time of the trace clock. It wraps around at 2^32 ticks.
+ * @retval	The virtual bus time in microseconds.
+ */
+uint32_t J1939_portGetTraceTime(void)
+{
+	return (uint32_t)virtualTime;
+}
+
+/**
+ * @brief 	This function is used to copy payload bytes between frames and message buffers.
+ * @param	destination - A pointer to the destination.
+ * @param	source - A pointer to the source.
+ * @param	size - The number of bytes.
+ * @retval	None.
+ */
+void J1939_portCopy(uint8_t* destination, const uint8_t* source, uint16_t size)
+{
+	memcpy(destination, source, size);
+	counters.copied_bytes += size;
+}
+
+/**
+ * @brief 	This function is used to get the number of hardware acceptance filters of the CAN controller.
+ * @param	channel - Not used, every node has J1939_HOST_FILTER_BANKS.
+ * @retval	The number of filters.
+ */
+uint8_t J1939_portGetFilterBanks(uint8_t channel)
+{
+	(void)channel;
+
+	return J1939_HOST_FILTER_BANKS;
+}
+
+/**
+ * @brief 	This function is used to load the acceptance filters of the node.
+ * @param	channel - The node.
+ * @param	filters - A pointer to the filters.
+ * @param	numberOfFilters - The number of filters, no more than J1939_portGetFilterBanks.
+ * 			0 - all frames are received.
+ * @retval	None.
+ */
+void J1939_portSetAcceptanceFilters(uint8_t channel, const J1939_acceptanceFilter* filters, uint8_t numberOfFilters)
+{
+	J1939_hostNode* node;
+
+	if(channel >= numberOfNodes) return;
+
+	node = &nodes[channel];
+
+	if(numberOfFilters > J1939_HOST_FILTER_BANKS) numberOfFilters = J1939_HOST_FILTER_BANKS;
+	if(numberOfFilters > 0U) memcpy(node->filters, filters, numberOfFilters * sizeof(J1939_acceptanceFilter));
+
+	node->number_of_filters = numberOfFilters;
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to check the frame against the acceptance filters of the node.
+ * @param	node - A pointer to the node.
+ * @param	canId - The CAN ID of the frame.
+ * @retval	1 if the frame is accepted, 0 otherwise.
+ */
+static uint8_t J1939_hostAcceptFrame(const J1939_hostNode* node, uint32_t canId)
+{
+	if(node->number_of_filters == 0U) return 1U;
+
+	for(uint8_t i = 0U; i < node->number_of_filters; i++)
+	{
+		if(((canId ^ node->filters[i].id) & node->filters[i].mask) == 0U) return 1U;
+	}
+
+	return 0U;
+}
+
+/**
+ * @brief 	This function is used to put a frame into the queue of the virtual bus.
+ * @param	channel - The node which sends the frame.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @param	fd - 1 - CAN FD frame, 0 - classic frame.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+static uint8_t J1939_hostQueueFrame(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t dlc, uint8_t fd)
+{
+	uint32_t nextHead = (busHead + 1U) % J1939_HOST_BUS_QUEUE_SIZE;
+	J1939_hostFrame* frame = &busQueue[busHead];
+
+	if(nextHead == busTail)
+	{
+		counters.dropped_frames++;
+		return J1939_PORT_FRAME_NOT_QUEUED;
+	}
+
+	frame->can_id	= canId;
+	frame->dlc		= dlc;
+	frame->sender	= channel;
+	frame->fd		= fd;
+	memcpy(frame->data, data, dlc);
+
+	counters.bus_copied_bytes += dlc;
+	busHead = nextHead;
+
+	return J1939_PORT_FRAME_QUEUED;
+}
+
+#endif /* J1939_PORT_HOST */
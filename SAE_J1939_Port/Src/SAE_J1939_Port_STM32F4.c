@@ -0,0 +1,242 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Port_STM32F4.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the SAE J1939 platform
+  * 		 abstraction for STM32F4 with FreeRTOS
+  *
+  ******************************************************************************
+  */
+
+#if !defined(J1939_PORT_HOST) && !defined(J1939_PORT_SOCKETCAN)
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_Port.h"
+
+// for pvPortMalloc and xTaskGetTickCount functions
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Configuration section
+//---------------------------------------------------------------------------
+
+// The CAN channel of the instance: 0 - CAN1, 1 - CAN2
+#define CAN_CHANNEL_CAN1						(0U)
+#define CAN_CHANNEL_CAN2						(1U)
+#define CAN_CHANNELS							(2U)
+
+// The filter banks are shared by CAN1 and CAN2, the banks of CAN2 start at CAN2SB
+#define CAN_FILTER_BANKS						(28U)
+#define CAN_FILTER_IDE							(0x04U)
+#define CAN_FILTER_RTR							(0x02U)
+#define CAN_FILTER_ID_POS						(3U)
+#define CAN_GET_CAN2_START_BANK()				((uint8_t)((CAN1->FMR & CAN_FMR_CAN2SB) >> CAN_FMR_CAN2SB_Pos))
+
+//---------------------------------------------------------------------------
+// Structure definitions
+//---------------------------------------------------------------------------
+static CAN_TypeDef* const canControllers[CAN_CHANNELS] = {CAN1, CAN2};
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to queue an extended CAN data frame for transmission.
+ * @param	channel - The CAN channel: 0 - CAN1, 1 - CAN2.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_portSendFrame(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	USH_CAN_txHeaderTypeDef txMessage = {0};
+
+	if(channel >= CAN_CHANNELS) return J1939_PORT_FRAME_NOT_QUEUED;
+
+	// The frame is queued only if a transmit mailbox is empty
+	if(J1939_portGetFreeTxSlots(channel) == 0U) return J1939_PORT_FRAME_NOT_QUEUED;
+
+	txMessage.ExtId	= canId;
+	txMessage.IDE	= CAN_ID_EXT;
+	txMessage.RTR	= CAN_RTR_DATA;
+	txMessage.DLC	= dlc;
+
+	CAN_addTxMessage(canControllers[channel], &txMessage, (uint8_t*)data);
+
+	return J1939_PORT_FRAME_QUEUED;
+}
+
+/**
+ * @brief 	This function is used to queue an extended CAN FD data frame for transmission. bxCAN of STM32F4
+ * 			has no CAN FD, so the instances of this port use the classic data link only.
+ * @param	channel - Not used.
+ * @param	canId - Not used.
+ * @param	data - Not used.
+ * @param	length - Not used.
+ * @retval	J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_portSendFDFrame(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t length)
+{
+	(void)channel;
+	(void)canId;
+	(void)data;
+	(void)length;
+
+	return J1939_PORT_FRAME_NOT_QUEUED;
+}
+
+/**
+ * @brief 	This function is used to get the number of frames that can be queued for transmission
+ * 			without waiting.
+ * @param	channel - The CAN channel: 0 - CAN1, 1 - CAN2.
+ * @retval	The number of free TX slots.
+ */
+uint8_t J1939_portGetFreeTxSlots(uint8_t channel)
+{
+	uint32_t tsr;
+
+	if(channel >= CAN_CHANNELS) return 0U;
+
+	tsr = canControllers[channel]->TSR;
+
+	// Each empty transmit mailbox can take one frame
+	return (uint8_t)(((tsr & CAN_TSR_TME0) != 0U) + ((tsr & CAN_TSR_TME1) != 0U) + ((tsr & CAN_TSR_TME2) != 0U));
+}
+
+/**
+ * @brief 	This function is used to allocate memory from the platform heap.
+ * @param	size - The requested size in bytes.
+ * @retval	A pointer to the allocated memory. NULL if there is no memory.
+ */
+void* J1939_portAllocate(size_t size)
+{
+	return pvPortMalloc(size);
+}
+
+/**
+ * @brief 	This function is used to return memory to the platform heap.
+ * @param	block - A pointer to the memory allocated by J1939_portAllocate.
+ * @retval	None.
+ */
+void J1939_portFree(void* block)
+{
+	vPortFree(block);
+}
+
+/**
+ * @brief 	This function is used to get the platform time.
+ * @retval	The time in milliseconds.
+ */
+uint32_t J1939_portGetTime(void)
+{
+	return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+/**
+ * @brief 	This function is used to start the free-running clock of the trace: the DWT cycle counter.
+ * @retval	The frequency of the clock in Hz.
+ */
+uint32_t J1939_portStartTraceClock(void)
+{
+	CoreDebug->DEMCR	|= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT			= 0U;
+	DWT->CTRL			|= DWT_CTRL_CYCCNTENA_Msk;
+
+	return SystemCoreClock;
+}
+
+/**
+ * @brief 	This function is used to get the time of the trace clock. It wraps around at 2^32 ticks.
+ * @retval	The time in CPU cycles.
+ */
+uint32_t J1939_portGetTraceTime(void)
+{
+	return DWT->CYCCNT;
+}
+
+/**
+ * @brief 	This function is used to copy payload bytes between frames and message buffers.
+ * @param	destination - A pointer to the destination.
+ * @param	source - A pointer to the source.
+ * @param	size - The number of bytes.
+ * @retval	None.
+ */
+void J1939_portCopy(uint8_t* destination, const uint8_t* source, uint16_t size)
+{
+	memcpy(destination, source, size);
+}
+
+/**
+ * @brief 	This function is used to get the number of hardware acceptance filters of the CAN controller.
+ * @param	channel - The CAN channel: 0 - CAN1, 1 - CAN2.
+ * @retval	The number of filters.
+ */
+uint8_t J1939_portGetFilterBanks(uint8_t channel)
+{
+	if(channel == CAN_CHANNEL_CAN1) return CAN_GET_CAN2_START_BANK();
+	if(channel == CAN_CHANNEL_CAN2) return (uint8_t)(CAN_FILTER_BANKS - CAN_GET_CAN2_START_BANK());
+
+	return 0U;
+}
+
+/**
+ * @brief 	This function is used to load the hardware acceptance filters. A frame is received if it
+ * 			matches any of them.
+ * @param	channel - The CAN channel: 0 - CAN1, 1 - CAN2.
+ * @param	filters - A pointer to the filters.
+ * @param	numberOfFilters - The number of filters, no more than J1939_portGetFilterBanks.
+ * 			0 - all frames are received.
+ * @retval	None.
+ */
+void J1939_portSetAcceptanceFilters(uint8_t channel, const J1939_acceptanceFilter* filters, uint8_t numberOfFilters)
+{
+	static const J1939_acceptanceFilter acceptAll = {0U, 0U};
+	uint8_t firstBank = (channel == CAN_CHANNEL_CAN2) ? CAN_GET_CAN2_START_BANK() : 0U;
+	uint8_t numberOfBanks = J1939_portGetFilterBanks(channel);
+	uint32_t banks;
+
+	if(numberOfBanks == 0U) return;
+
+	if(numberOfFilters == 0U)
+	{
+		filters			= &acceptAll;
+		numberOfFilters	= 1U;
+	}
+
+	if(numberOfFilters > numberOfBanks) numberOfFilters = numberOfBanks;
+
+	// The filter registers are shared by both channels, their instances can run in different tasks
+	taskENTER_CRITICAL();
+
+	// The filters can be changed in the initialization mode only, the banks of the controller are deactivated
+	CAN1->FMR |= CAN_FMR_FINIT;
+	banks = ((1UL << numberOfBanks) - 1U) << firstBank;
+	CAN1->FA1R &= ~banks;
+
+	// 32-bit mask mode, FIFO 0. Only extended data frames are received
+	banks = ((1UL << numberOfFilters) - 1U) << firstBank;
+	CAN1->FM1R &= ~banks;
+	CAN1->FS1R |= banks;
+	CAN1->FFA1R &= ~banks;
+
+	for(uint8_t i = 0U; i < numberOfFilters; i++)
+	{
+		CAN1->sFilterRegister[firstBank + i].FR1 = (filters[i].id << CAN_FILTER_ID_POS) | CAN_FILTER_IDE;
+		CAN1->sFilterRegister[firstBank + i].FR2 = (filters[i].mask << CAN_FILTER_ID_POS) | CAN_FILTER_IDE | CAN_FILTER_RTR;
+	}
+
+	CAN1->FA1R |= banks;
+	CAN1->FMR &= ~CAN_FMR_FINIT;
+
+	taskEXIT_CRITICAL();
+}
+
+#endif /* !J1939_PORT_HOST && !J1939_PORT_SOCKETCAN */
@@ -0,0 +1,677 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Port_SocketCAN.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 This file contains the implementation of the SAE J1939 platform
+  * 		 abstraction for Linux user space with SocketCAN. The port
+  * 		 functions are called by the task of the instances only, the
+  * 		 channels need no locks.
+  *
+  ******************************************************************************
+  */
+
+#if defined(J1939_PORT_SOCKETCAN)
+
+// for recvmmsg and sendmmsg functions
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_Port_SocketCAN.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <net/if.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define J1939_SOCKETCAN_CONTROL_SIZE			(CMSG_SPACE(sizeof(struct timespec)))
+#define J1939_SOCKETCAN_CLASSIC_MAX_LENGTH		(8U)
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A channel of the port: a CAN_RAW socket or a stand-in socket.
+ */
+typedef struct
+{
+	int socket;														/* -1 - the channel is free */
+	uint8_t kernel_filters;											/* 1 - CAN_RAW filters, 0 - filtered by the port */
+	uint8_t batch_size;												/* The most frames of a system call */
+	uint8_t tx_pending;												/* Frames queued and not written yet */
+	J1939_socketCANreceiveCallback callback;
+	void* context;
+	J1939_acceptanceFilter filters[J1939_SOCKETCAN_FILTER_BANKS];	/* The filters of a stand-in socket */
+	uint8_t number_of_filters;										/* 0 - all frames are received */
+	struct canfd_frame tx_frames[J1939_SOCKETCAN_BATCH_SIZE];
+	struct iovec tx_vectors[J1939_SOCKETCAN_BATCH_SIZE];
+	struct mmsghdr tx_messages[J1939_SOCKETCAN_BATCH_SIZE];
+	struct canfd_frame rx_frames[J1939_SOCKETCAN_BATCH_SIZE];
+	struct iovec rx_vectors[J1939_SOCKETCAN_BATCH_SIZE];
+	struct mmsghdr rx_messages[J1939_SOCKETCAN_BATCH_SIZE];
+	uint8_t rx_control[J1939_SOCKETCAN_BATCH_SIZE][J1939_SOCKETCAN_CONTROL_SIZE];
+	J1939_socketCANcounters counters;
+} J1939_socketCANchannel;
+
+//---------------------------------------------------------------------------
+// Structure definitions
+//---------------------------------------------------------------------------
+static J1939_socketCANchannel channels[J1939_SOCKETCAN_MAX_CHANNELS];
+static uint8_t channelsInitialized = 0U;
+
+//---------------------------------------------------------------------------
+// Static function prototypes
+//---------------------------------------------------------------------------
+static J1939_socketCANchannel* J1939_socketCANgetChannel(uint8_t channel);
+static uint8_t J1939_socketCANaddChannel(int socketDescriptor, uint8_t kernelFilters,
+										 J1939_socketCANreceiveCallback callback, void* context);
+static uint8_t J1939_socketCANqueueFrame(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t length, uint8_t fd);
+static uint8_t J1939_socketCANacceptFrame(const J1939_socketCANchannel* port, uint32_t canId);
+static uint64_t J1939_socketCANgetClock(clockid_t clock);
+
+//---------------------------------------------------------------------------
+// Library Functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to open a CAN_RAW socket on the CAN interface. The socket receives
+ * 			CAN FD frames and the kernel reception time of the frames.
+ * @param	interfaceName - The name of the interface, e.g. "can0" or "vcan0".
+ * @param	callback - A callback to deliver the received frames.
+ * @param	context - A user pointer passed to the callback.
+ * @retval	The CAN channel of the port functions. J1939_SOCKETCAN_NO_CHANNEL if the socket can't be opened.
+ */
+uint8_t J1939_socketCANopen(const char* interfaceName, J1939_socketCANreceiveCallback callback, void* context)
+{
+	struct sockaddr_can address = {0};
+	int enable = 1;
+	uint8_t channel;
+	int socketDescriptor;
+
+	address.can_family	= AF_CAN;
+	address.can_ifindex	= (int)if_nametoindex(interfaceName);
+	if(address.can_ifindex == 0) return J1939_SOCKETCAN_NO_CHANNEL;
+
+	socketDescriptor = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+	if(socketDescriptor < 0) return J1939_SOCKETCAN_NO_CHANNEL;
+
+	// The interfaces without CAN FD refuse the option, their sockets take the classic frames only
+	(void)setsockopt(socketDescriptor, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable));
+
+	if(bind(socketDescriptor, (struct sockaddr*)&address, sizeof(address)) < 0)
+	{
+		close(socketDescriptor);
+		return J1939_SOCKETCAN_NO_CHANNEL;
+	}
+
+	channel = J1939_socketCANaddChannel(socketDescriptor, 1U, callback, context);
+	if(channel == J1939_SOCKETCAN_NO_CHANNEL)
+	{
+		close(socketDescriptor);
+		return J1939_SOCKETCAN_NO_CHANNEL;
+	}
+
+	// Only the extended data frames are received until the acceptance filters are loaded
+	J1939_portSetAcceptanceFilters(channel, NULL, 0U);
+
+	return channel;
+}
+
+/**
+ * @brief 	This function is used to attach a datagram socket which carries struct can_frame and struct canfd_frame
+ * 			as a CAN_RAW socket does, e.g. one end of a socketpair. The acceptance filters of the channel
+ * 			are applied by the port. The socket is owned by the channel.
+ * @param	socketDescriptor - The socket.
+ * @param	callback - A callback to deliver the received frames.
+ * @param	context - A user pointer passed to the callback.
+ * @retval	The CAN channel of the port functions. J1939_SOCKETCAN_NO_CHANNEL if there are no free channels.
+ */
+uint8_t J1939_socketCANattach(int socketDescriptor, J1939_socketCANreceiveCallback callback, void* context)
+{
+	int flags = fcntl(socketDescriptor, F_GETFL);
+
+	if((flags < 0) || (fcntl(socketDescriptor, F_SETFL, flags | O_NONBLOCK) < 0)) return J1939_SOCKETCAN_NO_CHANNEL;
+
+	return J1939_socketCANaddChannel(socketDescriptor, 0U, callback, context);
+}
+
+/**
+ * @brief 	This function is used to close the socket of the channel. The frames not written yet are discarded.
+ * @param	channel - The CAN channel.
+ * @retval	None.
+ */
+void J1939_socketCANclose(uint8_t channel)
+{
+	J1939_socketCANchannel* port = J1939_socketCANgetChannel(channel);
+
+	if(port == NULL) return;
+
+	close(port->socket);
+	port->socket = -1;
+}
+
+/**
+ * @brief 	This function is used to set the most frames read or written by one system call.
+ * 			1 - every frame is read by recvmsg and written by send as soon as it is queued.
+ * @param	channel - The CAN channel.
+ * @param	batchSize - The batch size from 1 to J1939_SOCKETCAN_BATCH_SIZE (by default).
+ * @retval	None.
+ */
+void J1939_socketCANsetBatchSize(uint8_t channel, uint8_t batchSize)
+{
+	J1939_socketCANchannel* port = J1939_socketCANgetChannel(channel);
+
+	if(port == NULL) return;
+
+	if(batchSize == 0U) batchSize = 1U;
+	if(batchSize > J1939_SOCKETCAN_BATCH_SIZE) batchSize = J1939_SOCKETCAN_BATCH_SIZE;
+
+	// The frames queued for the larger batch are written first
+	if(port->tx_pending >= batchSize) (void)J1939_socketCANflush(channel);
+
+	port->batch_size = batchSize;
+}
+
+/**
+ * @brief 	This function is used to get the socket of the channel, e.g. to wait for frames by poll.
+ * @param	channel - The CAN channel.
+ * @retval	The socket. -1 if the channel isn't open.
+ */
+int J1939_socketCANgetDescriptor(uint8_t channel)
+{
+	J1939_socketCANchannel* port = J1939_socketCANgetChannel(channel);
+
+	return (port != NULL) ? port->socket : -1;
+}
+
+/**
+ * @brief 	This function is used to read the received frames in batches and pass them to the callback.
+ * 			It doesn't wait for frames. Called by the task of the instance.
+ * @param	channel - The CAN channel.
+ * @param	maxFrames - The maximum number of frames to read. 0 - until no frames are left.
+ * @retval	The number of frames passed to the callback.
+ */
+uint32_t J1939_socketCANreceive(uint8_t channel, uint32_t maxFrames)
+{
+	J1939_socketCANchannel* port = J1939_socketCANgetChannel(channel);
+	uint32_t deliveredFrames = 0U;
+	uint32_t readFrames = 0U;
+
+	if(port == NULL) return 0U;
+
+	while((maxFrames == 0U) || (readFrames < maxFrames))
+	{
+		uint32_t batchSize = port->batch_size;
+		uint64_t monotonicTime, realTime;
+		int received;
+
+		if((maxFrames != 0U) && ((maxFrames - readFrames) < batchSize)) batchSize = maxFrames - readFrames;
+
+		for(uint32_t i = 0U; i < batchSize; i++)
+		{
+			port->rx_messages[i].msg_hdr.msg_controllen = J1939_SOCKETCAN_CONTROL_SIZE;
+			port->rx_messages[i].msg_hdr.msg_flags		= 0;
+		}
+
+		if(batchSize == 1U)
+		{
+			ssize_t size = recvmsg(port->socket, &port->rx_messages[0].msg_hdr, MSG_DONTWAIT);
+
+			port->rx_messages[0].msg_len = (size > 0) ? (unsigned int)size : 0U;
+			received = (size > 0) ? 1 : -1;
+		} else
+		{
+			received = recvmmsg(port->socket, port->rx_messages, batchSize, MSG_DONTWAIT, NULL);
+		}
+
+		port->counters.rx_calls++;
+		if(received <= 0) break;
+
+		// The kernel stamps the frames by the real time clock, their age moves them to the trace clock
+		monotonicTime	= J1939_socketCANgetClock(CLOCK_MONOTONIC);
+		realTime		= J1939_socketCANgetClock(CLOCK_REALTIME);
+
+		for(int i = 0; i < received; i++)
+		{
+			struct msghdr* header = &port->rx_messages[i].msg_hdr;
+			const struct canfd_frame* frame = &port->rx_frames[i];
+			uint32_t timestamp = (uint32_t)monotonicTime;
+			struct cmsghdr* control;
+			uint8_t length;
+
+			for(control = CMSG_FIRSTHDR(header); control != NULL; control = CMSG_NXTHDR(header, control))
+			{
+				if((control->cmsg_level == SOL_SOCKET) && (control->cmsg_type == SCM_TIMESTAMPNS))
+				{
+					struct timespec time;
+					uint64_t kernelTime;
+
+					memcpy(&time, CMSG_DATA(control), sizeof(time));
+					kernelTime = ((uint64_t)time.tv_sec * 1000000U) + ((uint64_t)time.tv_nsec / 1000U);
+					if(kernelTime < realTime) timestamp = (uint32_t)(monotonicTime - (realTime - kernelTime));
+				}
+			}
+
+			// A frame shorter than struct can_frame isn't a CAN frame
+			if((port->rx_messages[i].msg_len != CAN_MTU) && (port->rx_messages[i].msg_len != CANFD_MTU)) continue;
+
+			length = frame->len;
+			if(length > ((port->rx_messages[i].msg_len == CAN_MTU) ? J1939_SOCKETCAN_CLASSIC_MAX_LENGTH : CANFD_MAX_DLEN))
+			{
+				continue;
+			}
+
+			// J1939 uses the extended data frames only
+			if(((frame->can_id & CAN_EFF_FLAG) == 0U) || ((frame->can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG)) != 0U) || \
+			   ((port->kernel_filters == 0U) && (J1939_socketCANacceptFrame(port, frame->can_id & CAN_EFF_MASK) == 0U)))
+			{
+				port->counters.rx_filtered_frames++;
+				continue;
+			}
+
+			port->counters.rx_frames++;
+			deliveredFrames++;
+
+			if(port->callback != NULL) port->callback(port->context, frame->can_id & CAN_EFF_MASK, frame->data, length, timestamp);
+		}
+
+		readFrames += (uint32_t)received;
+
+		// A short batch has emptied the receive queue of the socket
+		if((uint32_t)received < batchSize) break;
+	}
+
+	return deliveredFrames;
+}
+
+/**
+ * @brief 	This function is used to write the queued frames. A batch is written as soon as it is full,
+ * 			the rest must be flushed by the task after the stack is processed. The frames the socket
+ * 			can't take stay queued and take TX slots until the next flush.
+ * @param	channel - The CAN channel.
+ * @retval	The number of frames left queued.
+ */
+uint32_t J1939_socketCANflush(uint8_t channel)
+{
+	J1939_socketCANchannel* port = J1939_socketCANgetChannel(channel);
+	int sent;
+
+	if(port == NULL) return 0U;
+
+	while(port->tx_pending > 0U)
+	{
+		if(port->tx_pending == 1U)
+		{
+			sent = (send(port->socket, &port->tx_frames[0], port->tx_vectors[0].iov_len, MSG_DONTWAIT) < 0) ? -1 : 1;
+		} else
+		{
+			sent = sendmmsg(port->socket, port->tx_messages, port->tx_pending, MSG_DONTWAIT);
+		}
+
+		port->counters.tx_calls++;
+
+		if(sent <= 0)
+		{
+			// A full TX queue of the interface is reported by ENOBUFS, the frames are written later
+			if((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ENOBUFS))
+			{
+				port->counters.tx_blocked_calls++;
+				break;
+			}
+
+			port->counters.tx_dropped_frames += port->tx_pending;
+			port->tx_pending = 0U;
+			break;
+		}
+
+		port->counters.tx_frames += (uint32_t)sent;
+		port->tx_pending -= (uint8_t)sent;
+
+		// The frames not written yet are moved to the start of the batch
+		for(uint8_t i = 0U; i < port->tx_pending; i++)
+		{
+			port->tx_frames[i]				= port->tx_frames[i + sent];
+			port->tx_vectors[i].iov_len		= port->tx_vectors[i + sent].iov_len;
+		}
+	}
+
+	return port->tx_pending;
+}
+
+/**
+ * @brief 	This function is used to get the counters of the channel.
+ * @param	channel - The CAN channel.
+ * @param	counters - A pointer to store the counters.
+ * @retval	None.
+ */
+void J1939_socketCANgetCounters(uint8_t channel, J1939_socketCANcounters* counters)
+{
+	J1939_socketCANchannel* port = J1939_socketCANgetChannel(channel);
+
+	if(port != NULL) *counters = port->counters;
+}
+
+/**
+ * @brief 	This function is used to reset the counters of the channel.
+ * @param	channel - The CAN channel.
+ * @retval	None.
+ */
+void J1939_socketCANresetCounters(uint8_t channel)
+{
+	J1939_socketCANchannel* port = J1939_socketCANgetChannel(channel);
+
+	if(port != NULL) memset(&port->counters, 0, sizeof(J1939_socketCANcounters));
+}
+
+/**
+ * @brief 	This function is used to queue an extended CAN data frame for transmission.
+ * @param	channel - The CAN channel.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	dlc - The number of data bytes.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_portSendFrame(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	return J1939_socketCANqueueFrame(channel, canId, data, (dlc > J1939_SOCKETCAN_CLASSIC_MAX_LENGTH) ? \
+									 J1939_SOCKETCAN_CLASSIC_MAX_LENGTH : dlc, 0U);
+}
+
+/**
+ * @brief 	This function is used to queue an extended CAN FD data frame with the bit rate switch for transmission.
+ * @param	channel - The CAN channel.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	length - The number of data bytes: 0 to 8, 12, 16, 20, 24, 32, 48 or 64.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+uint8_t J1939_portSendFDFrame(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t length)
+{
+	return J1939_socketCANqueueFrame(channel, canId, data, (length > CANFD_MAX_DLEN) ? CANFD_MAX_DLEN : length, 1U);
+}
+
+/**
+ * @brief 	This function is used to get the number of frames that can be queued for transmission
+ * 			without waiting: the free entries of the batch.
+ * @param	channel - The CAN channel.
+ * @retval	The number of free TX slots.
+ */
+uint8_t J1939_portGetFreeTxSlots(uint8_t channel)
+{
+	J1939_socketCANchannel* port = J1939_socketCANgetChannel(channel);
+
+	if(port == NULL) return 0U;
+
+	// A full batch is written first, the frames it leaves take their slots
+	if(port->tx_pending >= port->batch_size) (void)J1939_socketCANflush(channel);
+
+	return (port->tx_pending < port->batch_size) ? (uint8_t)(port->batch_size - port->tx_pending) : 0U;
+}
+
+/**
+ * @brief 	This function is used to allocate memory from the platform heap.
+ * @param	size - The requested size in bytes.
+ * @retval	A pointer to the allocated memory. NULL if there is no memory.
+ */
+void* J1939_portAllocate(size_t size)
+{
+	return malloc(size);
+}
+
+/**
+ * @brief 	This function is used to return memory to the platform heap.
+ * @param	block - A pointer to the memory allocated by J1939_portAllocate.
+ * @retval	None.
+ */
+void J1939_portFree(void* block)
+{
+	free(block);
+}
+
+/**
+ * @brief 	This function is used to get the platform time.
+ * @retval	The time of the monotonic clock in milliseconds.
+ */
+uint32_t J1939_portGetTime(void)
+{
+	return (uint32_t)(J1939_socketCANgetClock(CLOCK_MONOTONIC) / 1000U);
+}
+
+/**
+ * @brief 	This function is used to start the free-running clock of the trace: the monotonic clock.
+ * @retval	The frequency of the clock in Hz.
+ */
+uint32_t J1939_portStartTraceClock(void)
+{
+	return 1000000U;
+}
+
+/**
+ * @brief 	This function is used to get the time of the trace clock. It wraps around at 2^32 ticks.
+ * @retval	The time of the monotonic clock in microseconds.
+ */
+uint32_t J1939_portGetTraceTime(void)
+{
+	return (uint32_t)J1939_socketCANgetClock(CLOCK_MONOTONIC);
+}
+
+/**
+ * @brief 	This function is used to copy payload bytes between frames and message buffers.
+ * @param	destination - A pointer to the destination.
+ * @param	source - A pointer to the source.
+ * @param	size - The number of bytes.
+ * @retval	None.
+ */
+void J1939_portCopy(uint8_t* destination, const uint8_t* source, uint16_t size)
+{
+	memcpy(destination, source, size);
+}
+
+/**
+ * @brief 	This function is used to get the number of acceptance filters of the channel.
+ * @param	channel - Not used, every channel takes J1939_SOCKETCAN_FILTER_BANKS.
+ * @retval	The number of filters.
+ */
+uint8_t J1939_portGetFilterBanks(uint8_t channel)
+{
+	(void)channel;
+
+	return J1939_SOCKETCAN_FILTER_BANKS;
+}
+
+/**
+ * @brief 	This function is used to load the acceptance filters: the CAN_RAW filters of the socket or
+ * 			the filters applied by the port to the frames of a stand-in socket.
+ * @param	channel - The CAN channel.
+ * @param	filters - A pointer to the filters.
+ * @param	numberOfFilters - The number of filters, no more than J1939_portGetFilterBanks.
+ * 			0 - all frames are received.
+ * @retval	None.
+ */
+void J1939_portSetAcceptanceFilters(uint8_t channel, const J1939_acceptanceFilter* filters, uint8_t numberOfFilters)
+{
+	J1939_socketCANchannel* port = J1939_socketCANgetChannel(channel);
+	struct can_filter rawFilters[J1939_SOCKETCAN_FILTER_BANKS];
+
+	if(port == NULL) return;
+
+	if(numberOfFilters > J1939_SOCKETCAN_FILTER_BANKS) numberOfFilters = J1939_SOCKETCAN_FILTER_BANKS;
+	if(numberOfFilters > 0U) memcpy(port->filters, filters, numberOfFilters * sizeof(J1939_acceptanceFilter));
+
+	port->number_of_filters = numberOfFilters;
+
+	if(port->kernel_filters == 0U) return;
+
+	// The frames are matched in the kernel, before they are copied to the socket. Only extended data frames pass
+	for(uint8_t i = 0U; i < numberOfFilters; i++)
+	{
+		rawFilters[i].can_id	= (filters[i].id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+		rawFilters[i].can_mask	= (filters[i].mask & CAN_EFF_MASK) | CAN_EFF_FLAG | CAN_RTR_FLAG;
+	}
+
+	if(numberOfFilters == 0U)
+	{
+		rawFilters[0].can_id	= CAN_EFF_FLAG;
+		rawFilters[0].can_mask	= CAN_EFF_FLAG | CAN_RTR_FLAG;
+		numberOfFilters			= 1U;
+	}
+
+	(void)setsockopt(port->socket, SOL_CAN_RAW, CAN_RAW_FILTER, rawFilters, numberOfFilters * sizeof(struct can_filter));
+}
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to get an open channel.
+ * @param	channel - The CAN channel.
+ * @retval	A pointer to the channel. NULL if the channel isn't open.
+ */
+static J1939_socketCANchannel* J1939_socketCANgetChannel(uint8_t channel)
+{
+	if((channelsInitialized == 0U) || (channel >= J1939_SOCKETCAN_MAX_CHANNELS) || (channels[channel].socket < 0)) return NULL;
+
+	return &channels[channel];
+}
+
+/**
+ * @brief 	This function is used to take a free channel for the socket and to prepare its batches.
+ * @param	socketDescriptor - The socket.
+ * @param	kernelFilters - 1 - CAN_RAW socket, 0 - stand-in socket filtered by the port.
+ * @param	callback - A callback to deliver the received frames.
+ * @param	context - A user pointer passed to the callback.
+ * @retval	The CAN channel. J1939_SOCKETCAN_NO_CHANNEL if there are no free channels.
+ */
+static uint8_t J1939_socketCANaddChannel(int socketDescriptor, uint8_t kernelFilters,
+										 J1939_socketCANreceiveCallback callback, void* context)
+{
+	J1939_socketCANchannel* port;
+	int enable = 1;
+	uint8_t channel;
+
+	if(channelsInitialized == 0U)
+	{
+		for(channel = 0U; channel < J1939_SOCKETCAN_MAX_CHANNELS; channel++) channels[channel].socket = -1;
+		channelsInitialized = 1U;
+	}
+
+	for(channel = 0U; channel < J1939_SOCKETCAN_MAX_CHANNELS; channel++)
+	{
+		if(channels[channel].socket < 0) break;
+	}
+
+	if(channel >= J1939_SOCKETCAN_MAX_CHANNELS) return J1939_SOCKETCAN_NO_CHANNEL;
+
+	port = &channels[channel];
+	memset(port, 0, sizeof(J1939_socketCANchannel));
+	port->socket			= socketDescriptor;
+	port->kernel_filters	= kernelFilters;
+	port->batch_size		= J1939_SOCKETCAN_BATCH_SIZE;
+	port->callback			= callback;
+	port->context			= context;
+
+	// Every frame of the batches keeps its own buffers, so a batch is passed to the kernel without copies
+	for(uint32_t i = 0U; i < J1939_SOCKETCAN_BATCH_SIZE; i++)
+	{
+		port->tx_vectors[i].iov_base				= &port->tx_frames[i];
+		port->tx_messages[i].msg_hdr.msg_iov		= &port->tx_vectors[i];
+		port->tx_messages[i].msg_hdr.msg_iovlen		= 1U;
+
+		port->rx_vectors[i].iov_base				= &port->rx_frames[i];
+		port->rx_vectors[i].iov_len					= CANFD_MTU;
+		port->rx_messages[i].msg_hdr.msg_iov		= &port->rx_vectors[i];
+		port->rx_messages[i].msg_hdr.msg_iovlen		= 1U;
+		port->rx_messages[i].msg_hdr.msg_control	= port->rx_control[i];
+	}
+
+	(void)setsockopt(socketDescriptor, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+
+	return channel;
+}
+
+/**
+ * @brief 	This function is used to put a frame into the TX batch of the channel. A full batch is written.
+ * @param	channel - The CAN channel.
+ * @param	canId - The 29-bit CAN ID.
+ * @param	data - A pointer to the frame data.
+ * @param	length - The number of data bytes.
+ * @param	fd - 1 - CAN FD frame with the bit rate switch, 0 - classic frame.
+ * @retval	J1939_PORT_FRAME_QUEUED or J1939_PORT_FRAME_NOT_QUEUED.
+ */
+static uint8_t J1939_socketCANqueueFrame(uint8_t channel, uint32_t canId, const uint8_t* data, uint8_t length, uint8_t fd)
+{
+	J1939_socketCANchannel* port = J1939_socketCANgetChannel(channel);
+	struct canfd_frame* frame;
+
+	if(port == NULL) return J1939_PORT_FRAME_NOT_QUEUED;
+
+	if((port->tx_pending >= port->batch_size) && (J1939_socketCANflush(channel) >= port->batch_size))
+	{
+		return J1939_PORT_FRAME_NOT_QUEUED;
+	}
+
+	frame = &port->tx_frames[port->tx_pending];
+	memset(frame, 0, offsetof(struct canfd_frame, data));
+	frame->can_id	= (canId & CAN_EFF_MASK) | CAN_EFF_FLAG;
+	frame->len		= length;
+	frame->flags	= (fd == 1U) ? CANFD_BRS : 0U;
+	memcpy(frame->data, data, length);
+
+	port->tx_vectors[port->tx_pending].iov_len = (fd == 1U) ? CANFD_MTU : CAN_MTU;
+	port->tx_pending++;
+
+	if(port->tx_pending >= port->batch_size) (void)J1939_socketCANflush(channel);
+
+	return J1939_PORT_FRAME_QUEUED;
+}
+
+/**
+ * @brief 	This function is used to check the frame against the acceptance filters of a stand-in socket.
+ * @param	port - A pointer to the channel.
+ * @param	canId - The CAN ID of the frame.
+ * @retval	1 if the frame is accepted, 0 otherwise.
+ */
+static uint8_t J1939_socketCANacceptFrame(const J1939_socketCANchannel* port, uint32_t canId)
+{
+	if(port->number_of_filters == 0U) return 1U;
+
+	for(uint8_t i = 0U; i < port->number_of_filters; i++)
+	{
+		if(((canId ^ port->filters[i].id) & port->filters[i].mask) == 0U) return 1U;
+	}
+
+	return 0U;
+}
+
+/**
+ * @brief 	This function is used to read a clock.
+ * @param	clock - CLOCK_MONOTONIC or CLOCK_REALTIME.
+ * @retval	The time in microseconds.
+ */
+static uint64_t J1939_socketCANgetClock(clockid_t clock)
+{
+	struct timespec time;
+
+	clock_gettime(clock, &time);
+
+	return ((uint64_t)time.tv_sec * 1000000U) + ((uint64_t)time.tv_nsec / 1000U);
+}
+
+#endif /* J1939_PORT_SOCKETCAN */
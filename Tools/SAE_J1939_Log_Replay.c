@@ -0,0 +1,782 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Log_Replay.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Host replay of recorded bus traffic. The frames of a candump or
+  * 		 Vector ASC log are pushed into the receive ring of an instance
+  * 		 which plays the ECU of the given address and are routed by
+  * 		 J1939_dispatchFrame, the virtual clock following the timestamps
+  * 		 of the log. It reports the completed messages by PGN, the TP
+  * 		 sessions and aborts, the time to process a frame and the receive
+  * 		 buffers allocated from the pool and the heap.
+  *
+  * 		 Usage: j1939_log_replay <log|-> [-a address] [-c channel] [-r]
+  * 		 -a - the address of the ECU in hex, the destination of the first
+  * 		      RTS of the log by default. The frames sent by it are skipped,
+  * 		      the instance sends its own CTS and acknowledgements.
+  * 		 -c - only the frames of the interface (candump) or the channel
+  * 		      number (ASC) are replayed.
+  * 		 -r - the frames are replayed at the recorded timing, as fast as
+  * 		      possible by default.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+#include "SAE_J1939_Port_Host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define REPLAY_MAX_LINE							(512U)
+#define REPLAY_MAX_TOKENS						(24U)
+#define REPLAY_MAX_PGNS							(64U)
+#define REPLAY_TIME_BINS						(40U)		// Powers of two nanoseconds
+#define REPLAY_DRAIN_TIME						(2000U)		// ms after the last frame for the sessions to time out
+#define REPLAY_NO_ADDRESS						(0xFFFFU)
+#define REPLAY_CLOCK_SAMPLES					(100000U)
+
+#define REPLAY_EXTENDED_ID_DIGITS				(8U)
+#define REPLAY_CAN_ID_MASK						(0x1FFFFFFFUL)
+
+#define REPLAY_GET_PDU_FORMAT(canId)			((uint8_t)((canId) >> 16U))
+#define REPLAY_GET_PDU_SPECIFIC(canId)			((uint8_t)((canId) >> 8U))
+#define REPLAY_GET_SOURCE_ADDRESS(canId)		((uint8_t)(canId))
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief Results of parsing a line of the log.
+ */
+typedef enum
+{
+	REPLAY_LINE_FRAME,						/* A J1939 frame */
+	REPLAY_LINE_OTHER_FRAME,				/* A standard, remote, error or CAN FD frame */
+	REPLAY_LINE_OTHER_CHANNEL,				/* A frame of a channel not replayed */
+	REPLAY_LINE_HEADER,						/* A header, a comment or an empty line */
+	REPLAY_LINE_INVALID						/* A line not understood */
+} replayLines;
+
+/**
+ * @brief A frame of the log.
+ */
+typedef struct
+{
+	uint64_t time;							/* Microseconds */
+	uint32_t can_id;
+	uint8_t dlc;
+	uint8_t data[J1939_FRAME_MAX_DLC];
+} replayFrame;
+
+/**
+ * @brief The state of the log reader.
+ */
+typedef struct
+{
+	const char* channel;					/* The channel replayed, NULL - all */
+	uint8_t ASC_decimal;					/* 1 - the ASC log is written with "base dec" */
+	uint8_t ASC_relative;					/* 1 - the ASC timestamps are relative to the previous frame */
+	uint64_t ASC_time;						/* The time of the previous ASC frame, us */
+} replayReader;
+
+/**
+ * @brief Completed multi-packet messages of a PGN.
+ */
+typedef struct
+{
+	uint32_t PGN;
+	uint8_t tracked;						/* 0 - no handler slot was left for the PGN */
+	uint32_t messages;
+	uint64_t bytes;
+} replayPGN;
+
+/**
+ * @brief Counters of the replay.
+ */
+typedef struct
+{
+	uint64_t lines;
+	uint64_t frames;						/* J1939 frames of the replayed channels */
+	uint64_t ECU_frames;					/* Frames sent by the ECU, skipped */
+	uint64_t other_frames;
+	uint64_t other_channel_frames;
+	uint64_t invalid_lines;
+	uint64_t dispatched;					/* Frames routed by J1939_dispatchFrame */
+	uint64_t dispatch_time;					/* ns */
+	uint64_t max_dispatch_time;				/* ns */
+	uint64_t dispatch_times[REPLAY_TIME_BINS];
+} replayCounters;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static J1939_instance instance;
+static J1939_frameRing ring;
+static replayReader reader;
+static replayCounters counters;
+static replayPGN PGNs[REPLAY_MAX_PGNS];
+static uint8_t numberOfPGNs = 0U;
+static uint16_t ECUaddress = REPLAY_NO_ADDRESS;
+static uint8_t recordedTiming = 0U;
+static uint64_t wallStartTime;
+
+static const char* typeNames[J1939_STATISTICS_SESSION_TYPES] =
+{
+	"TP BAM RX", "TP PTP RX", "TP BAM TX", "TP PTP TX", "ETP RX", "ETP TX", "FD.TP RX", "FD.TP TX"
+};
+
+static const char* classNames[J1939_POOL_CLASSES] =
+{
+	"small", "medium", "large", "heap"
+};
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to get the monotonic wall clock time.
+ * @retval	The time in nanoseconds.
+ */
+static uint64_t replayGetNanoseconds(void)
+{
+	struct timespec time;
+
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return ((uint64_t)time.tv_sec * 1000000000ULL) + (uint64_t)time.tv_nsec;
+}
+
+/**
+ * @brief 	This function is the RX callback of the node: the instance is the only node of the bus.
+ * @retval	None.
+ */
+static void replayReceive(void* context, uint32_t canId, const uint8_t* data, uint8_t dlc)
+{
+	(void)context;
+	(void)canId;
+	(void)data;
+	(void)dlc;
+}
+
+/**
+ * @brief 	This function is used to count a completed multi-packet message of a tracked PGN.
+ * @retval	None.
+ */
+static void replayCountMessage(void* context, uint32_t PGN, uint8_t sourceAddress, uint8_t destinationAddress,
+							   const uint8_t* data, uint16_t size)
+{
+	replayPGN* entry = (replayPGN*)context;
+
+	(void)PGN;
+	(void)sourceAddress;
+	(void)destinationAddress;
+	(void)data;
+
+	// The single frames of the PGN aren't multi-packet messages
+	if(size <= J1939_FRAME_MAX_DLC) return;
+
+	entry->messages++;
+	entry->bytes += size;
+}
+
+/**
+ * @brief 	This function is used to register a handler counting the completed messages of the PGN
+ * 			when the PGN is announced by RTS or BAM for the first time.
+ * @param	PGN - The PGN of the multi-packet message.
+ * @retval	None.
+ */
+static void replayTrackPGN(uint32_t PGN)
+{
+	replayPGN* entry;
+
+	for(uint8_t i = 0U; i < numberOfPGNs; i++)
+	{
+		if(PGNs[i].PGN == PGN) return;
+	}
+
+	if(numberOfPGNs >= REPLAY_MAX_PGNS) return;
+
+	entry			= &PGNs[numberOfPGNs++];
+	entry->PGN		= PGN;
+	entry->tracked	= (J1939_registerPGNhandler(&instance, PGN, J1939_ANY_ADDRESS, J1939_ANY_ADDRESS,
+												replayCountMessage, entry) == J1939_DISPATCH_OK) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is used to route a frame of the ring and to measure the time it takes.
+ * @param	context - A pointer to the instance.
+ * @param	frame - A pointer to the frame.
+ * @retval	None.
+ */
+static void replayDispatchFrame(void* context, const J1939_frame* frame)
+{
+	uint64_t startTime = replayGetNanoseconds();
+	uint64_t time;
+	uint8_t bin = 0U;
+
+	J1939_dispatchFrame((J1939_instance*)context, frame->can_id, frame->data, frame->dlc);
+	time = replayGetNanoseconds() - startTime;
+
+	while(((time >> bin) > 1U) && (bin < (REPLAY_TIME_BINS - 1U))) bin++;
+
+	counters.dispatched++;
+	counters.dispatch_time += time;
+	counters.dispatch_times[bin]++;
+	if(time > counters.max_dispatch_time) counters.max_dispatch_time = time;
+}
+
+/**
+ * @brief 	This function is used to route the frames of the ring and to send the frames of the instance.
+ * @retval	None.
+ */
+static void replayProcessFrames(void)
+{
+	J1939_processFrames(&ring, replayDispatchFrame, &instance, 0U);
+	J1939_sendTPpendingPackages(&instance);
+	while(J1939_hostProcessBus() > 0U);
+}
+
+/**
+ * @brief 	This function is used to advance the virtual clock to the time, the timers of the instance
+ * 			expiring on the way. At the recorded timing the wall clock is waited for.
+ * @param	time - The virtual time, us.
+ * @retval	None.
+ */
+static void replayAdvanceTime(uint64_t time)
+{
+	uint64_t now, step;
+	uint32_t sleepTime;
+	struct timespec wakeTime;
+
+	if(recordedTiming == 1U)
+	{
+		wakeTime.tv_sec		= (time_t)((wallStartTime + (time * 1000U)) / 1000000000ULL);
+		wakeTime.tv_nsec	= (long)((wallStartTime + (time * 1000U)) % 1000000000ULL);
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTime, NULL);
+	}
+
+	while(1)
+	{
+		sleepTime = J1939_processTimers(&instance);
+		J1939_sendTPpendingPackages(&instance);
+
+		if((J1939_hostProcessBus() > 0U) || (sleepTime == 0U)) continue;
+		if((now = J1939_hostGetTime()) >= time) break;
+
+		// The clock stops at every deadline of the instance
+		step = (sleepTime == J1939_TIMER_NO_DEADLINE) ? (time - now) : (((uint64_t)sleepTime * 1000U) - (now % 1000U));
+		if(step > (time - now)) step = time - now;
+
+		J1939_hostAdvanceTime(step);
+	}
+}
+
+/**
+ * @brief 	This function is used to convert a timestamp of seconds with a fraction to microseconds.
+ * @param	text - The timestamp.
+ * @param	time - A pointer to store the time, us.
+ * @retval	1 - the timestamp is valid, 0 - isn't.
+ */
+static uint8_t replayParseTime(const char* text, uint64_t* time)
+{
+	uint64_t seconds = 0U, fraction = 0U;
+	uint8_t digits = 0U, valid = 0U;
+
+	for(; (*text >= '0') && (*text <= '9'); text++, valid = 1U) seconds = (seconds * 10U) + (uint64_t)(*text - '0');
+
+	if(*text == '.')
+	{
+		for(text++; (*text >= '0') && (*text <= '9'); text++, valid = 1U)
+		{
+			if(digits < 6U)
+			{
+				fraction = (fraction * 10U) + (uint64_t)(*text - '0');
+				digits++;
+			}
+		}
+	}
+
+	for(; digits < 6U; digits++) fraction *= 10U;
+
+	*time = (seconds * 1000000U) + fraction;
+
+	return ((valid == 1U) && ((*text == '\0') || (*text == ')'))) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is used to convert a number of the log.
+ * @param	text - The number.
+ * @param	base - 16 or 10.
+ * @param	limit - The largest valid value.
+ * @param	value - A pointer to store the value.
+ * @retval	1 - the number is valid, 0 - isn't.
+ */
+static uint8_t replayParseNumber(const char* text, int base, uint32_t limit, uint32_t* value)
+{
+	char* end;
+	unsigned long number;
+
+	if(*text == '\0') return 0U;
+
+	number = strtoul(text, &end, base);
+	*value = (uint32_t)number;
+
+	return ((*end == '\0') && (number <= limit)) ? 1U : 0U;
+}
+
+/**
+ * @brief 	This function is used to parse the CAN ID and the data of a candump line: "ID#DATA" of the
+ * 			log format or "ID [DLC] BYTES" of the screen format.
+ * @param	tokens - The tokens after the interface.
+ * @param	numberOfTokens - The number of the tokens.
+ * @param	frame - A pointer to store the frame.
+ * @retval	replayLines.
+ */
+static replayLines replayParseCandumpFrame(char** tokens, uint8_t numberOfTokens, replayFrame* frame)
+{
+	char* separator;
+	uint32_t value;
+	size_t length;
+
+	if(numberOfTokens == 0U) return REPLAY_LINE_INVALID;
+
+	if((separator = strchr(tokens[0], '#')) != NULL)
+	{
+		// CAN FD frames are written with "##", remote frames with "#R"
+		*separator = '\0';
+		if((separator[1] == '#') || (separator[1] == 'R')) return REPLAY_LINE_OTHER_FRAME;
+
+		length = strlen(&separator[1]);
+		if(((length % 2U) != 0U) || (length > (J1939_FRAME_MAX_DLC * 2U))) return REPLAY_LINE_INVALID;
+
+		frame->dlc = (uint8_t)(length / 2U);
+		for(uint8_t i = 0U; i < frame->dlc; i++)
+		{
+			char byte[3] = {separator[1U + (i * 2U)], separator[2U + (i * 2U)], '\0'};
+
+			if(replayParseNumber(byte, 16, 0xFFU, &value) == 0U) return REPLAY_LINE_INVALID;
+			frame->data[i] = (uint8_t)value;
+		}
+	} else
+	{
+		if((numberOfTokens < 2U) || (tokens[1][0] != '[')) return REPLAY_LINE_INVALID;
+
+		// The remote frames are written as "remote request"
+		tokens[1][strcspn(tokens[1], "]")] = '\0';
+		if(replayParseNumber(&tokens[1][1], 10, J1939_FRAME_MAX_DLC, &value) == 0U) return REPLAY_LINE_OTHER_FRAME;
+		if((numberOfTokens < (2U + value)) || ((numberOfTokens > 2U) && (strcmp(tokens[2], "remote") == 0))) return REPLAY_LINE_OTHER_FRAME;
+
+		frame->dlc = (uint8_t)value;
+		for(uint8_t i = 0U; i < frame->dlc; i++)
+		{
+			if(replayParseNumber(tokens[2U + i], 16, 0xFFU, &value) == 0U) return REPLAY_LINE_INVALID;
+			frame->data[i] = (uint8_t)value;
+		}
+	}
+
+	// J1939 uses only the extended IDs
+	if(strlen(tokens[0]) != REPLAY_EXTENDED_ID_DIGITS) return REPLAY_LINE_OTHER_FRAME;
+	if(replayParseNumber(tokens[0], 16, REPLAY_CAN_ID_MASK, &frame->can_id) == 0U) return REPLAY_LINE_INVALID;
+
+	return REPLAY_LINE_FRAME;
+}
+
+/**
+ * @brief 	This function is used to parse a candump line: "(time) interface frame" or "interface frame".
+ * @param	tokens - The tokens of the line.
+ * @param	numberOfTokens - The number of the tokens.
+ * @param	frame - A pointer to store the frame.
+ * @retval	replayLines.
+ */
+static replayLines replayParseCandump(char** tokens, uint8_t numberOfTokens, replayFrame* frame)
+{
+	uint8_t first = 0U;
+
+	frame->time = 0U;
+
+	if(tokens[0][0] == '(')
+	{
+		if(replayParseTime(&tokens[0][1], &frame->time) == 0U) return REPLAY_LINE_INVALID;
+		first = 1U;
+	}
+
+	if(numberOfTokens <= first) return REPLAY_LINE_INVALID;
+	if((reader.channel != NULL) && (strcmp(tokens[first], reader.channel) != 0)) return REPLAY_LINE_OTHER_CHANNEL;
+
+	// The direction written by candump -x
+	for(first++; (first < numberOfTokens) && ((strcmp(tokens[first], "RX") == 0) || (strcmp(tokens[first], "TX") == 0) || \
+											  (strcmp(tokens[first], "-") == 0)); first++);
+
+	return replayParseCandumpFrame(&tokens[first], (uint8_t)(numberOfTokens - first), frame);
+}
+
+/**
+ * @brief 	This function is used to parse an ASC line: "time channel IDx Rx|Tx d DLC BYTES ...".
+ * @param	tokens - The tokens of the line.
+ * @param	numberOfTokens - The number of the tokens.
+ * @param	frame - A pointer to store the frame.
+ * @retval	replayLines.
+ */
+static replayLines replayParseASC(char** tokens, uint8_t numberOfTokens, replayFrame* frame)
+{
+	int base = (reader.ASC_decimal == 1U) ? 10 : 16;
+	uint32_t channel, value;
+	size_t length;
+
+	if(replayParseTime(tokens[0], &frame->time) == 0U) return REPLAY_LINE_INVALID;
+
+	if(reader.ASC_relative == 1U) frame->time += reader.ASC_time;
+	reader.ASC_time = frame->time;
+
+	// CAN FD frames and events as "Start of measurement"
+	if((numberOfTokens < 2U) || (replayParseNumber(tokens[1], 10, 0xFFFFU, &channel) == 0U))
+	{
+		return ((numberOfTokens > 1U) && (strcmp(tokens[1], "CANFD") == 0)) ? REPLAY_LINE_OTHER_FRAME : REPLAY_LINE_HEADER;
+	}
+
+	// Error frames
+	if(numberOfTokens < 6U) return REPLAY_LINE_OTHER_FRAME;
+	if((reader.channel != NULL) && (strcmp(tokens[1], reader.channel) != 0)) return REPLAY_LINE_OTHER_CHANNEL;
+
+	length = strlen(tokens[2]);
+	if((length < 2U) || (tokens[2][length - 1U] != 'x')) return REPLAY_LINE_OTHER_FRAME;
+	tokens[2][length - 1U] = '\0';
+
+	if((strcmp(tokens[4], "d") != 0) || (replayParseNumber(tokens[5], 16, J1939_FRAME_MAX_DLC, &value) == 0U)) return REPLAY_LINE_OTHER_FRAME;
+	if(numberOfTokens < (6U + value)) return REPLAY_LINE_INVALID;
+	if(replayParseNumber(tokens[2], base, REPLAY_CAN_ID_MASK, &frame->can_id) == 0U) return REPLAY_LINE_INVALID;
+
+	frame->dlc = (uint8_t)value;
+	for(uint8_t i = 0U; i < frame->dlc; i++)
+	{
+		if(replayParseNumber(tokens[6U + i], base, 0xFFU, &value) == 0U) return REPLAY_LINE_INVALID;
+		frame->data[i] = (uint8_t)value;
+	}
+
+	return REPLAY_LINE_FRAME;
+}
+
+/**
+ * @brief 	This function is used to parse a line of a candump or ASC log.
+ * @param	line - The line, it is split into tokens in place.
+ * @param	frame - A pointer to store the frame.
+ * @retval	replayLines.
+ */
+static replayLines replayParseLine(char* line, replayFrame* frame)
+{
+	char* tokens[REPLAY_MAX_TOKENS];
+	uint8_t numberOfTokens = 0U;
+	char* context = NULL;
+	char* token;
+
+	for(token = strtok_r(line, " \t\r\n", &context); (token != NULL) && (numberOfTokens < REPLAY_MAX_TOKENS);
+		token = strtok_r(NULL, " \t\r\n", &context))
+	{
+		tokens[numberOfTokens++] = token;
+	}
+
+	if((numberOfTokens == 0U) || (tokens[0][0] == '/') || (tokens[0][0] == '#')) return REPLAY_LINE_HEADER;
+
+	// The ASC header tells the number base and the kind of the timestamps
+	if(strcmp(tokens[0], "base") == 0)
+	{
+		reader.ASC_decimal	= ((numberOfTokens > 1U) && (strcmp(tokens[1], "dec") == 0)) ? 1U : 0U;
+		reader.ASC_relative	= ((numberOfTokens > 3U) && (strcmp(tokens[3], "relative") == 0)) ? 1U : 0U;
+		return REPLAY_LINE_HEADER;
+	}
+
+	if(tokens[0][0] == '(') return replayParseCandump(tokens, numberOfTokens, frame);
+	if((tokens[0][0] >= '0') && (tokens[0][0] <= '9')) return replayParseASC(tokens, numberOfTokens, frame);
+	if((numberOfTokens > 1U) && ((strchr(tokens[1], '#') != NULL) || ((numberOfTokens > 2U) && (tokens[2][0] == '['))))
+	{
+		return replayParseCandump(tokens, numberOfTokens, frame);
+	}
+
+	// The other ASC header lines: date, "Begin Triggerblock", "internal events logged" and so on
+	return REPLAY_LINE_HEADER;
+}
+
+/**
+ * @brief 	This function is used to queue a frame of the log for the instance.
+ * @param	frame - A pointer to the frame.
+ * @param	time - The virtual time of the frame, us.
+ * @retval	None.
+ */
+static void replayPushFrame(const replayFrame* frame, uint64_t time)
+{
+	uint8_t PDUformat = REPLAY_GET_PDU_FORMAT(frame->can_id);
+	uint8_t destinationAddress = REPLAY_GET_PDU_SPECIFIC(frame->can_id);
+
+	if((PDUformat == J1939_CONNECTION_MANAGEMENT) && (frame->dlc == J1939_FRAME_MAX_DLC) && \
+	   ((frame->data[0] == J1939_CONTROL_BYTE_TP_CM_RTS) || (frame->data[0] == J1939_CONTROL_BYTE_TP_CM_BAM)))
+	{
+		// The ECU is the recipient of the first RTS unless it is given
+		if((ECUaddress == REPLAY_NO_ADDRESS) && (frame->data[0] == J1939_CONTROL_BYTE_TP_CM_RTS))
+		{
+			replayProcessFrames();
+			ECUaddress = destinationAddress;
+			J1939_setCurrentECUAddress(&instance, (uint8_t)ECUaddress);
+		}
+
+		if((destinationAddress == ECUaddress) || (destinationAddress == J1939_BROADCAST_ADDRESS))
+		{
+			replayTrackPGN(((uint32_t)frame->data[7] << 16U) | ((uint32_t)frame->data[6] << 8U) | frame->data[5]);
+		}
+	}
+
+	// The instance answers instead of the recorded ECU
+	if(REPLAY_GET_SOURCE_ADDRESS(frame->can_id) == ECUaddress)
+	{
+		counters.ECU_frames++;
+		return;
+	}
+
+	if(J1939_pushFrame(&ring, frame->can_id, frame->data, frame->dlc, (uint32_t)(time / 1000U)) == 0U)
+	{
+		replayProcessFrames();
+		J1939_pushFrame(&ring, frame->can_id, frame->data, frame->dlc, (uint32_t)(time / 1000U));
+	}
+}
+
+/**
+ * @brief 	This function is used to get the upper bound of the bin of the processing times
+ * 			below which the share of the frames lies.
+ * @param	share - The share of the frames.
+ * @retval	The time, ns.
+ */
+static uint64_t replayGetPercentile(double share)
+{
+	uint64_t frames = 0U;
+
+	for(uint8_t bin = 0U; bin < REPLAY_TIME_BINS; bin++)
+	{
+		frames += counters.dispatch_times[bin];
+		if((double)frames >= (share * (double)counters.dispatched)) return 2ULL << bin;
+	}
+
+	return counters.max_dispatch_time;
+}
+
+/**
+ * @brief 	This function is used to print the report of the replay.
+ * @param	name - The name of the log.
+ * @param	logTime - The time from the first to the last frame, us.
+ * @param	wallTime - The time of the replay, ns.
+ * @param	clockTime - The time to read the wall clock, ns.
+ * @retval	None.
+ */
+static void replayPrintReport(const char* name, uint64_t logTime, uint64_t wallTime, double clockTime)
+{
+	J1939_statistics statistics;
+	J1939_poolStatistics pool;
+	J1939_hostCounters host;
+	uint32_t aborts;
+
+	J1939_getStatistics(&instance, &statistics);
+	J1939_hostGetCounters(&host);
+
+	printf("log %s: %llu lines, %llu J1939 frames, %llu frames of the ECU skipped, %llu other frames, "
+		   "%llu frames of other channels, %llu lines not parsed\n", name, (unsigned long long)counters.lines,
+		   (unsigned long long)counters.frames, (unsigned long long)counters.ECU_frames, (unsigned long long)counters.other_frames,
+		   (unsigned long long)counters.other_channel_frames, (unsigned long long)counters.invalid_lines);
+
+	if(ECUaddress == REPLAY_NO_ADDRESS)
+	{
+		printf("ECU address not found: no RTS in the log, only the broadcast messages are received\n");
+	} else
+	{
+		printf("ECU address 0x%02X\n", (unsigned)ECUaddress);
+	}
+
+	printf("log time %.3f s, replayed %s in %.3f s\n", (double)logTime / 1e6,
+		   (recordedTiming == 1U) ? "at the recorded timing" : "as fast as possible", (double)wallTime / 1e9);
+	printf("frames: %u received, %u sent, %u not sent, ring peak %u of %u, %u ring overflows\n",
+		   statistics.frames_received, statistics.frames_sent, statistics.frames_not_sent, ring.max_pending,
+		   J1939_FRAME_RING_SIZE, ring.overflows);
+
+	if(counters.dispatched > 0U)
+	{
+		printf("processing time per frame: mean %.1f ns, p50 < %llu ns, p99 < %llu ns, p99.9 < %llu ns, max %llu ns, "
+			   "%.0f frames/s (wall clock read %.1f ns included)\n",
+			   (double)counters.dispatch_time / (double)counters.dispatched, (unsigned long long)replayGetPercentile(0.5),
+			   (unsigned long long)replayGetPercentile(0.99), (unsigned long long)replayGetPercentile(0.999),
+			   (unsigned long long)counters.max_dispatch_time, ((double)counters.dispatched * 1e9) / (double)counters.dispatch_time,
+			   clockTime);
+	}
+
+	printf("\n%-10s %8s %9s %7s %7s %7s %10s %7s %7s %7s %7s %7s %7s\n", "sessions", "opened", "completed", "busy",
+		   "no mem", "resent", "max active", "aborts", "timeout", "retrans", "too big", "memory", "peer");
+
+	for(uint8_t type = 0U; type < J1939_STATISTICS_SESSION_TYPES; type++)
+	{
+		const J1939_sessionStatistics* session = &statistics.sessions[type];
+
+		aborts = 0U;
+		for(uint8_t slot = 0U; slot < J1939_ABORT_SLOTS; slot++) aborts += session->aborts[slot];
+
+		printf("%-10s %8u %9u %7u %7u %7u %10u %7u %7u %7u %7u %7u %7u\n", typeNames[type], session->opened,
+			   session->completed, session->busy, session->allocation_failures, session->retransmitted_packages,
+			   session->max_active, aborts, session->aborts[J1939_ABORT_SLOT_TIMEOUT],
+			   session->aborts[J1939_ABORT_SLOT_RETRANSMIT_LIMIT], session->aborts[J1939_ABORT_SLOT_TOO_BIG_MESSAGE],
+			   session->aborts[J1939_ABORT_SLOT_MEMORY_ALLOCATION], session->peer_aborts);
+	}
+
+	printf("\nreceive buffers: peak %u bytes, %llu heap allocations, heap peak %llu bytes\n", statistics.max_buffer_bytes,
+		   (unsigned long long)host.heap_allocations, (unsigned long long)host.heap_peak);
+	printf("%-8s %6s %6s %6s %11s %8s\n", "pool", "block", "blocks", "peak", "allocations", "failures");
+
+	for(uint8_t poolClass = 0U; poolClass < J1939_POOL_CLASSES; poolClass++)
+	{
+		J1939_getPoolStatistics(&instance, (J1939_poolClasses)poolClass, &pool);
+		printf("%-8s %6u %6u %6u %11u %8u\n", classNames[poolClass], pool.block_size, pool.number_of_blocks,
+			   pool.max_used_blocks, pool.allocations, pool.failures);
+	}
+
+	printf("\n%-8s %9s %12s\n", "PGN", "completed", "bytes");
+
+	for(uint8_t i = 0U; i < numberOfPGNs; i++)
+	{
+		if(PGNs[i].tracked == 1U)
+		{
+			printf("0x%05X  %9u %12llu\n", PGNs[i].PGN, PGNs[i].messages, (unsigned long long)PGNs[i].bytes);
+		} else
+		{
+			printf("0x%05X  %9s %12s  no handler slot, counted only by the sessions\n", PGNs[i].PGN, "-", "-");
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	char line[REPLAY_MAX_LINE];
+	const char* name = NULL;
+	replayFrame frame;
+	uint64_t firstTime = 0U, lastTime = 0U, time = 0U, queuedTime = 0U, startTime;
+	uint8_t firstFrame = 1U;
+	uint32_t value;
+	double clockTime;
+	FILE* file;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if((strcmp(argv[i], "-a") == 0) && ((i + 1) < argc) && (replayParseNumber(argv[i + 1], 16, 0xFDU, &value) == 1U))
+		{
+			ECUaddress = (uint16_t)value;
+			i++;
+		} else if((strcmp(argv[i], "-c") == 0) && ((i + 1) < argc))
+		{
+			reader.channel = argv[++i];
+		} else if(strcmp(argv[i], "-r") == 0)
+		{
+			recordedTiming = 1U;
+		} else if((name == NULL) && ((argv[i][0] != '-') || (argv[i][1] == '\0')))
+		{
+			name = argv[i];
+		} else
+		{
+			name = NULL;
+			break;
+		}
+	}
+
+	if(name == NULL)
+	{
+		fprintf(stderr, "usage: %s <log|-> [-a address] [-c channel] [-r]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if(strcmp(name, "-") == 0)
+	{
+		file = stdin;
+	} else if((file = fopen(name, "r")) == NULL)
+	{
+		perror(name);
+		return EXIT_FAILURE;
+	}
+
+	// The cost of the wall clock read around every frame
+	startTime = replayGetNanoseconds();
+	for(uint32_t i = 0U; i < REPLAY_CLOCK_SAMPLES; i++) (void)replayGetNanoseconds();
+	clockTime = (double)(replayGetNanoseconds() - startTime) / REPLAY_CLOCK_SAMPLES;
+
+	J1939_hostInit(J1939_HOST_DEFAULT_BITRATE);
+	J1939_initInstance(&instance, J1939_hostAddNode(replayReceive, NULL));
+	J1939_initFrameRing(&ring);
+	if(ECUaddress != REPLAY_NO_ADDRESS) J1939_setCurrentECUAddress(&instance, (uint8_t)ECUaddress);
+
+	wallStartTime = replayGetNanoseconds();
+
+	while(fgets(line, sizeof(line), file) != NULL)
+	{
+		counters.lines++;
+
+		switch(replayParseLine(line, &frame))
+		{
+			case REPLAY_LINE_FRAME:
+				break;
+
+			case REPLAY_LINE_OTHER_FRAME:
+				counters.other_frames++;
+				continue;
+
+			case REPLAY_LINE_OTHER_CHANNEL:
+				counters.other_channel_frames++;
+				continue;
+
+			case REPLAY_LINE_INVALID:
+				counters.invalid_lines++;
+				continue;
+
+			default:
+				continue;
+		}
+
+		counters.frames++;
+
+		if(firstFrame == 1U)
+		{
+			firstTime	= frame.time;
+			firstFrame	= 0U;
+		}
+
+		// The log starts at the virtual time 0, the frames out of order are taken at the time of the last one
+		if(frame.time > lastTime) lastTime = frame.time;
+		time = (lastTime > firstTime) ? (lastTime - firstTime) : 0U;
+
+		// The frames of a millisecond are routed together before the timers of the next one
+		if((time / 1000U) != (queuedTime / 1000U))
+		{
+			replayProcessFrames();
+			replayAdvanceTime(time);
+			queuedTime = time;
+		}
+
+		replayPushFrame(&frame, time);
+	}
+
+	if(file != stdin) fclose(file);
+
+	// The sessions left open time out
+	replayProcessFrames();
+	replayAdvanceTime(time + (REPLAY_DRAIN_TIME * 1000U));
+
+	replayPrintReport(name, time, replayGetNanoseconds() - wallStartTime, clockTime);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,405 @@
+/**
+  ******************************************************************************
+  * @file    SAE_J1939_Trace_Decoder.c
+  * @author  Ulad Shumeika
+  * @version v1.0
+  * @date    16 October 2026
+  * @brief	 Host decoder of the dumps of the SAE J1939 trace. It prints the
+  * 		 timeline of the records with the frames decoded and the time the
+  * 		 TP and ETP sessions spend in each state between state changes
+  * 		 and CTS messages, by session type.
+  *
+  * 		 Usage: j1939_trace_decoder <dump> [-s]
+  * 		 -s - only the time in the states is printed.
+  *
+  ******************************************************************************
+  */
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "SAE_J1939_21_Instance.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define DECODER_MAX_SESSIONS					(64U)
+#define DECODER_STATES							(J1939_STATE_TP_TX_PTP_EOM + 1U)
+
+#define DECODER_GET_PDU_FORMAT(canId)			((uint8_t)((canId) >> 16U))
+#define DECODER_GET_PDU_SPECIFIC(canId)			((uint8_t)((canId) >> 8U))
+#define DECODER_GET_SOURCE_ADDRESS(canId)		((uint8_t)(canId))
+#define DECODER_GET_PGN(canId)					(((canId) >> 8U) & ((DECODER_GET_PDU_FORMAT(canId) < 0xF0U) ? 0x3FF00UL : 0x3FFFFUL))
+
+//---------------------------------------------------------------------------
+// Structures and enumerations
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A session followed by the decoder. It is identified by the originator and the recipient.
+ */
+typedef struct
+{
+	uint8_t in_use;
+	uint8_t type;							/* J1939_statisticsSessionTypes */
+	uint8_t originator;
+	uint8_t recipient;
+	uint8_t state;							/* J1939_states */
+	uint8_t completed;
+	uint64_t open_time;						/* Ticks from the first record */
+	uint64_t state_time;					/* Ticks from the first record */
+} decoderSession;
+
+/**
+ * @brief Time spent in a state.
+ */
+typedef struct
+{
+	uint32_t entries;
+	uint64_t total;							/* Ticks */
+	uint64_t max;							/* Ticks */
+} decoderPhase;
+
+//---------------------------------------------------------------------------
+// Variables
+//---------------------------------------------------------------------------
+static decoderSession sessions[DECODER_MAX_SESSIONS];
+static decoderPhase phases[J1939_STATISTICS_SESSION_TYPES][DECODER_STATES];
+static decoderPhase transfers[J1939_STATISTICS_SESSION_TYPES];
+static uint32_t aborted[J1939_STATISTICS_SESSION_TYPES];
+static uint32_t frequency;
+
+static const char* eventNames[J1939_TRACE_EVENTS] =
+{
+	"RX", "TX", "TX FAILED", "OPEN", "STATE", "COMPLETE", "CLOSE", "CTS SENT", "CTS RECEIVED",
+	"ABORT SENT", "ABORT RECEIVED", "TIMEOUT", "ALLOCATED", "NOT ALLOCATED", "RELEASED"
+};
+
+static const char* typeNames[J1939_STATISTICS_SESSION_TYPES] =
+{
+	"TP BAM RX", "TP PTP RX", "TP BAM TX", "TP PTP TX", "ETP RX", "ETP TX", "FD.TP RX", "FD.TP TX"
+};
+
+static const char* stateNames[DECODER_STATES] =
+{
+	"UNINIT", "NORMAL", "RX_BROADCAST", "TX_BROADCAST", "RX_PTP_CTS", "RX_PTP_DATA", "RX_PTP_EOM",
+	"TX_PTP_CTS", "TX_PTP_DATA", "TX_PTP_EOM"
+};
+
+//---------------------------------------------------------------------------
+// Static functions
+//---------------------------------------------------------------------------
+
+/**
+ * @brief 	This function is used to convert ticks of the trace clock to milliseconds.
+ * @param	ticks - The ticks.
+ * @retval	The time in milliseconds.
+ */
+static double decoderGetMilliseconds(uint64_t ticks)
+{
+	return ((double)ticks * 1000.0) / (double)frequency;
+}
+
+/**
+ * @brief 	This function is used to describe a frame of the trace.
+ * @param	record - A pointer to the record.
+ * @param	text - A pointer to the description.
+ * @param	size - The size of the description.
+ * @retval	None.
+ */
+static void decoderDescribeFrame(const J1939_traceRecord* record, char* text, size_t size)
+{
+	uint32_t canId = record->value;
+	uint8_t PDUformat = DECODER_GET_PDU_FORMAT(canId);
+	const char* control;
+
+	switch(PDUformat)
+	{
+		case J1939_CONNECTION_MANAGEMENT:
+		case J1939_ETP_CONNECTION_MANAGEMENT:
+			switch(record->arguments[0])
+			{
+				case J1939_CONTROL_BYTE_TP_CM_RTS:			control = "TP.CM RTS";		break;
+				case J1939_CONTROL_BYTE_TP_CM_CTS:			control = "TP.CM CTS";		break;
+				case J1939_CONTROL_BYTE_TP_CM_EndOfMsgACK:	control = "TP.CM EOM";		break;
+				case J1939_CONTROL_BYTE_TP_CM_BAM:			control = "TP.CM BAM";		break;
+				case J1939_CONTROL_BYTE_ETP_CM_RTS:			control = "ETP.CM RTS";		break;
+				case J1939_CONTROL_BYTE_ETP_CM_CTS:			control = "ETP.CM CTS";		break;
+				case J1939_CONTROL_BYTE_ETP_CM_DPO:			control = "ETP.CM DPO";		break;
+				case J1939_CONTROL_BYTE_ETP_CM_EndOfMsgACK:	control = "ETP.CM EOM";		break;
+				case J1939_CONTROL_BYTE_TP_CM_Abort:		control = (PDUformat == J1939_CONNECTION_MANAGEMENT) ? "TP.CM ABORT" : \
+																											   "ETP.CM ABORT"; break;
+				default:									control = "CM ?";			break;
+			}
+
+			if((record->arguments[0] == J1939_CONTROL_BYTE_TP_CM_CTS) || (record->arguments[0] == J1939_CONTROL_BYTE_ETP_CM_CTS))
+			{
+				snprintf(text, size, "%s %u packages", control, record->arguments[1]);
+			} else if(record->arguments[0] == J1939_CONTROL_BYTE_TP_CM_Abort)
+			{
+				snprintf(text, size, "%s reason %u", control, record->arguments[1]);
+			} else
+			{
+				snprintf(text, size, "%s", control);
+			}
+			break;
+
+		case J1939_DATA_TRANSFER:
+			snprintf(text, size, "TP.DT %u", record->arguments[0]);
+			break;
+
+		case J1939_ETP_DATA_TRANSFER:
+			snprintf(text, size, "ETP.DT %u", record->arguments[0]);
+			break;
+
+		default:
+			snprintf(text, size, "PGN %05X, %u bytes", (unsigned)DECODER_GET_PGN(canId), record->detail);
+			break;
+	}
+}
+
+/**
+ * @brief 	This function is used to print a record of the timeline.
+ * @param	record - A pointer to the record.
+ * @param	time - The ticks from the first record.
+ * @retval	None.
+ */
+static void decoderPrintRecord(const J1939_traceRecord* record, uint64_t time)
+{
+	char text[64];
+	const char* event = (record->event < J1939_TRACE_EVENTS) ? eventNames[record->event] : "?";
+
+	switch(record->event)
+	{
+		case J1939_TRACE_FRAME_RX:
+		case J1939_TRACE_FRAME_TX:
+		case J1939_TRACE_FRAME_NOT_SENT:
+			decoderDescribeFrame(record, text, sizeof(text));
+			printf("%12.3f  %-14s %08X  %02X -> %02X  %s\n", decoderGetMilliseconds(time), event, (unsigned)record->value,
+				   DECODER_GET_SOURCE_ADDRESS(record->value),
+				   (DECODER_GET_PDU_FORMAT(record->value) < 0xF0U) ? DECODER_GET_PDU_SPECIFIC(record->value) : J1939_BROADCAST_ADDRESS, text);
+			return;
+
+		case J1939_TRACE_SESSION_OPEN:
+		case J1939_TRACE_SESSION_COMPLETE:
+		case J1939_TRACE_SESSION_CLOSE:
+			snprintf(text, sizeof(text), "%s", (record->detail < J1939_STATISTICS_SESSION_TYPES) ? typeNames[record->detail] : "?");
+			break;
+
+		case J1939_TRACE_SESSION_STATE:
+		case J1939_TRACE_TIMEOUT:
+			snprintf(text, sizeof(text), "%s", (record->detail < DECODER_STATES) ? stateNames[record->detail] : "?");
+			break;
+
+		case J1939_TRACE_CTS_SENT:
+		case J1939_TRACE_CTS_RECEIVED:
+			snprintf(text, sizeof(text), "%u packages", record->detail);
+			break;
+
+		case J1939_TRACE_ABORT_SENT:
+		case J1939_TRACE_ABORT_RECEIVED:
+			snprintf(text, sizeof(text), "reason %u", record->detail);
+			break;
+
+		default:
+			snprintf(text, sizeof(text), "%u bytes", (unsigned)record->value);
+			printf("%12.3f  %-14s %8s  %02X -> %02X  %s\n", decoderGetMilliseconds(time), event, "", record->arguments[0],
+				   record->arguments[1], text);
+			return;
+	}
+
+	printf("%12.3f  %-14s %8s  %02X -> %02X  PGN %05X %s\n", decoderGetMilliseconds(time), event, "", record->arguments[0],
+		   record->arguments[1], (unsigned)record->value, text);
+}
+
+/**
+ * @brief 	This function is used to find the session of the record.
+ * @param	record - A pointer to the record.
+ * @retval	A pointer to the session. NULL if the session was opened before the first record.
+ */
+static decoderSession* decoderFindSession(const J1939_traceRecord* record)
+{
+	for(uint8_t i = 0U; i < DECODER_MAX_SESSIONS; i++)
+	{
+		if((sessions[i].in_use == 1U) && (sessions[i].originator == record->arguments[0]) && \
+		   (sessions[i].recipient == record->arguments[1])) return &sessions[i];
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief 	This function is used to add the time of the current state of the session to its phase.
+ * @param	session - A pointer to the session.
+ * @param	time - The ticks from the first record.
+ * @retval	None.
+ */
+static void decoderEndPhase(decoderSession* session, uint64_t time)
+{
+	decoderPhase* phase;
+	uint64_t duration = time - session->state_time;
+
+	if(session->state >= DECODER_STATES) return;
+
+	phase = &phases[session->type][session->state];
+	phase->entries++;
+	phase->total += duration;
+	if(duration > phase->max) phase->max = duration;
+}
+
+/**
+ * @brief 	This function is used to follow the sessions by the records.
+ * @param	record - A pointer to the record.
+ * @param	time - The ticks from the first record.
+ * @retval	None.
+ */
+static void decoderFollowSession(const J1939_traceRecord* record, uint64_t time)
+{
+	decoderSession* session;
+	uint64_t duration;
+
+	if(record->event == J1939_TRACE_SESSION_OPEN)
+	{
+		if(record->detail >= J1939_STATISTICS_SESSION_TYPES) return;
+
+		for(uint8_t i = 0U; i < DECODER_MAX_SESSIONS; i++)
+		{
+			if(sessions[i].in_use == 0U)
+			{
+				sessions[i] = (decoderSession){.in_use = 1U, .type = record->detail, .originator = record->arguments[0],
+											   .recipient = record->arguments[1], .state = DECODER_STATES,
+											   .open_time = time, .state_time = time};
+				return;
+			}
+		}
+		return;
+	}
+
+	if((session = decoderFindSession(record)) == NULL) return;
+
+	switch(record->event)
+	{
+		case J1939_TRACE_SESSION_STATE:
+			// A repeated state continues the phase
+			if(record->detail == session->state) break;
+
+			decoderEndPhase(session, time);
+			session->state		= record->detail;
+			session->state_time	= time;
+			break;
+
+		case J1939_TRACE_CTS_SENT:
+		case J1939_TRACE_CTS_RECEIVED:
+			// Every CTS starts a new phase, also in the same state
+			decoderEndPhase(session, time);
+			session->state_time = time;
+			break;
+
+		case J1939_TRACE_SESSION_COMPLETE:
+			duration = time - session->open_time;
+			session->completed = 1U;
+			transfers[session->type].entries++;
+			transfers[session->type].total += duration;
+			if(duration > transfers[session->type].max) transfers[session->type].max = duration;
+			break;
+
+		case J1939_TRACE_SESSION_CLOSE:
+			decoderEndPhase(session, time);
+			if(session->completed == 0U) aborted[session->type]++;
+			session->in_use = 0U;
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief 	This function is used to print the time spent in the states by session type.
+ * @retval	None.
+ */
+static void decoderPrintPhases(void)
+{
+	printf("\n%-10s %-13s %8s %12s %12s\n", "session", "phase", "entries", "mean, ms", "max, ms");
+
+	for(uint8_t type = 0U; type < J1939_STATISTICS_SESSION_TYPES; type++)
+	{
+		if((transfers[type].entries == 0U) && (aborted[type] == 0U)) continue;
+
+		for(uint8_t state = 0U; state < DECODER_STATES; state++)
+		{
+			const decoderPhase* phase = &phases[type][state];
+
+			if(phase->entries == 0U) continue;
+
+			printf("%-10s %-13s %8u %12.3f %12.3f\n", typeNames[type], stateNames[state], phase->entries,
+				   decoderGetMilliseconds(phase->total) / phase->entries, decoderGetMilliseconds(phase->max));
+		}
+
+		printf("%-10s %-13s %8u %12.3f %12.3f   %u not completed\n", typeNames[type], "transfer", transfers[type].entries,
+			   (transfers[type].entries > 0U) ? decoderGetMilliseconds(transfers[type].total) / transfers[type].entries : 0.0,
+			   decoderGetMilliseconds(transfers[type].max), aborted[type]);
+	}
+}
+
+//---------------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	J1939_traceDumpHeader header;
+	J1939_traceRecord record;
+	uint8_t timeline = ((argc > 2) && (strcmp(argv[2], "-s") == 0)) ? 0U : 1U;
+	uint32_t previousTimestamp = 0U;
+	uint64_t time = 0U;
+	FILE* file;
+
+	if(argc < 2)
+	{
+		fprintf(stderr, "usage: %s <dump> [-s]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if((file = fopen(argv[1], "rb")) == NULL)
+	{
+		perror(argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	if((fread(&header, sizeof(header), 1U, file) != 1U) || (header.magic != J1939_TRACE_MAGIC) || \
+	   (header.version != J1939_TRACE_LAYOUT_VERSION) || (header.record_size != sizeof(J1939_traceRecord)) || (header.frequency == 0U))
+	{
+		fprintf(stderr, "%s: not a trace dump of layout version %u\n", argv[1], J1939_TRACE_LAYOUT_VERSION);
+		fclose(file);
+		return EXIT_FAILURE;
+	}
+
+	frequency = header.frequency;
+	printf("%u records, %u records lost before them, trace clock %u Hz\n", header.records, header.lost_records, header.frequency);
+	if(timeline == 1U) printf("%12s  %-14s %8s  %-8s  %s\n", "time, ms", "event", "CAN ID", "SA -> DA", "");
+
+	for(uint32_t i = 0U; i < header.records; i++)
+	{
+		if(fread(&record, sizeof(record), 1U, file) != 1U)
+		{
+			fprintf(stderr, "%s: the dump is cut at record %u\n", argv[1], i);
+			break;
+		}
+
+		// The clock wraps around, the time is counted from the first record
+		if(i > 0U) time += (uint32_t)(record.timestamp - previousTimestamp);
+		previousTimestamp = record.timestamp;
+
+		if(timeline == 1U) decoderPrintRecord(&record, time);
+		decoderFollowSession(&record, time);
+	}
+
+	fclose(file);
+	decoderPrintPhases();
+
+	return EXIT_SUCCESS;
+}